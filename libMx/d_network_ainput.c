@@ -34,7 +34,9 @@ MX_RECORD_FUNCTION_LIST mxd_network_ainput_record_function_list = {
 MX_ANALOG_INPUT_FUNCTION_LIST mxd_network_ainput_analog_input_function_list = {
 	mxd_network_ainput_read,
 	mxd_network_ainput_get_dark_current,
-	mxd_network_ainput_set_dark_current
+	mxd_network_ainput_set_dark_current,
+	NULL,
+	mxd_network_ainput_read_array
 };
 
 MX_RECORD_FIELD_DEFAULTS mxd_network_ainput_record_field_defaults[] = {
@@ -227,6 +229,75 @@ mxd_network_ainput_read( MX_ANALOG_INPUT *ainput )
 	return mx_status;
 }
 
+/* mxd_network_ainput_read_array() sends the read requests for all of the
+ * analog inputs before waiting for any of the responses.  Requests to the
+ * same MX server are combined into one batch message.  If the batch fails,
+ * the analog inputs are read again one at a time.
+ */
+
+MX_EXPORT mx_status_type
+mxd_network_ainput_read_array( long num_records, MX_RECORD **record_array )
+{
+	static const char fname[] = "mxd_network_ainput_read_array()";
+
+	MX_ANALOG_INPUT *ainput;
+	MX_NETWORK_AINPUT *network_ainput;
+	MX_NETWORK_ASYNC_REQUEST *request_array;
+	long i;
+	mx_status_type mx_status;
+
+	request_array = (MX_NETWORK_ASYNC_REQUEST *)
+		malloc( num_records * sizeof(MX_NETWORK_ASYNC_REQUEST) );
+
+	if ( request_array == (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate %ld network "
+		"requests.", num_records );
+	}
+
+	for ( i = 0; i < num_records; i++ ) {
+		ainput = (MX_ANALOG_INPUT *) record_array[i]->record_class_struct;
+
+		network_ainput = NULL;
+
+		mx_status = mxd_network_ainput_get_pointers(
+					ainput, &network_ainput, fname );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( request_array );
+			return mx_status;
+		}
+
+		mx_status = mx_network_setup_request( &request_array[i],
+					&(network_ainput->value_nf),
+					MXFT_DOUBLE, 0, NULL,
+					&(ainput->raw_value.double_value) );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( request_array );
+			return mx_status;
+		}
+	}
+
+	mx_status = mx_get_array_batch( num_records, request_array );
+
+	mx_free( request_array );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		for ( i = 0; i < num_records; i++ ) {
+			ainput = (MX_ANALOG_INPUT *)
+				record_array[i]->record_class_struct;
+
+			mx_status = mxd_network_ainput_read( ainput );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+		}
+	}
+
+	return mx_status;
+}
+
 MX_EXPORT mx_status_type
 mxd_network_ainput_get_dark_current( MX_ANALOG_INPUT *ainput )
 {
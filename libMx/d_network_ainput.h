@@ -39,6 +39,8 @@ MX_API mx_status_type mxd_network_ainput_get_dark_current(
 						MX_ANALOG_INPUT *ainput );
 MX_API mx_status_type mxd_network_ainput_set_dark_current(
 						MX_ANALOG_INPUT *ainput );
+MX_API mx_status_type mxd_network_ainput_read_array( long num_records,
+						MX_RECORD **record_array );
 
 extern MX_RECORD_FUNCTION_LIST mxd_network_ainput_record_function_list;
 extern MX_ANALOG_INPUT_FUNCTION_LIST
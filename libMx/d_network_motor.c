@@ -25,6 +25,8 @@
 #include "mx_util.h"
 #include "mx_driver.h"
 #include "mx_hrt_debug.h"
+#include "mx_net.h"
+#include "mx_callback.h"
 #include "mx_motor.h"
 #include "d_network_motor.h"
 
@@ -60,7 +62,10 @@ MX_MOTOR_FUNCTION_LIST mxd_network_motor_motor_function_list = {
 	mxd_network_motor_get_extended_status,
 	NULL,
 	mxd_network_motor_setup_triggered_move,
-	mxd_network_motor_trigger_move
+	mxd_network_motor_trigger_move,
+	mxd_network_motor_get_status_array,
+	mxd_network_motor_wait_for_status_event,
+	mxd_network_motor_end_status_events
 };
 
 /* Soft motor data structures. */
@@ -235,6 +240,9 @@ mxd_network_motor_create_record_structures( MX_RECORD *record )
 
 	network_motor->remote_motor_flags = 0;
 
+	network_motor->status_callback = NULL;
+	network_motor->status_changed = FALSE;
+
 	/* If we need the acceleration type later, then we will need
 	 * to explicitly fetch it from the server at that time.
 	 */
@@ -1579,6 +1587,287 @@ mxd_network_motor_get_status( MX_MOTOR *motor )
 	return mx_status;
 }
 
+/* mxd_network_motor_get_status_array() sends the status requests for all
+ * of the motors before waiting for any of the responses.  Requests to the
+ * same MX server are combined into one batch message.  If the batch fails,
+ * the status of each of those motors is read again one motor at a time.
+ */
+
+MX_EXPORT mx_status_type
+mxd_network_motor_get_status_array( long num_motor_records,
+				MX_RECORD **motor_record_array )
+{
+	static const char fname[] = "mxd_network_motor_get_status_array()";
+
+	MX_MOTOR *motor;
+	MX_NETWORK_MOTOR *network_motor;
+	MX_NETWORK_SERVER *network_server;
+	MX_NETWORK_ASYNC_REQUEST *request_array;
+	MX_MOTOR **batch_motor_array;
+	long i, num_requests;
+	mx_status_type mx_status;
+
+	request_array = (MX_NETWORK_ASYNC_REQUEST *)
+		malloc( num_motor_records * sizeof(MX_NETWORK_ASYNC_REQUEST) );
+
+	if ( request_array == (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate %ld network "
+		"requests.", num_motor_records );
+	}
+
+	batch_motor_array = (MX_MOTOR **)
+		malloc( num_motor_records * sizeof(MX_MOTOR *) );
+
+	if ( batch_motor_array == (MX_MOTOR **) NULL ) {
+		mx_free( request_array );
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %ld element "
+		"motor pointer array.", num_motor_records );
+	}
+
+	num_requests = 0;
+
+	for ( i = 0; i < num_motor_records; i++ ) {
+		motor = (MX_MOTOR *) motor_record_array[i]->record_class_struct;
+
+		mx_status = mxd_network_motor_get_pointers( motor,
+							&network_motor, fname );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( request_array );
+			mx_free( batch_motor_array );
+			return mx_status;
+		}
+
+		network_server = (MX_NETWORK_SERVER *)
+			network_motor->server_record->record_class_struct;
+
+		/* Motors that still need to talk to their server before
+		 * their status can be read are handled one at a time.
+		 */
+
+		if ( ( network_server == (MX_NETWORK_SERVER *) NULL )
+		  || network_motor->need_to_get_remote_record_information
+		  || ( network_server->remote_mx_version
+				< MX_VERSION_HAS_MOTOR_GET_STATUS ) )
+		{
+			mx_status = mxd_network_motor_get_status( motor );
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				mx_free( request_array );
+				mx_free( batch_motor_array );
+				return mx_status;
+			}
+
+			continue;
+		}
+
+		mx_status = mx_network_setup_request(
+					&request_array[ num_requests ],
+					&(network_motor->status_nf),
+					MXFT_HEX, 0, NULL,
+					&(motor->status) );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( request_array );
+			mx_free( batch_motor_array );
+			return mx_status;
+		}
+
+		batch_motor_array[ num_requests ] = motor;
+
+		num_requests++;
+	}
+
+	mx_status = mx_get_array_batch( num_requests, request_array );
+
+	mx_free( request_array );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		for ( i = 0; i < num_requests; i++ ) {
+			mx_status = mxd_network_motor_get_status(
+						batch_motor_array[i] );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+		}
+	}
+
+	mx_free( batch_motor_array );
+
+	return mx_status;
+}
+
+static mx_status_type
+mxd_network_motor_status_callback( MX_CALLBACK *callback, void *argument )
+{
+	MX_NETWORK_MOTOR *network_motor;
+
+	network_motor = (MX_NETWORK_MOTOR *) argument;
+
+	network_motor->status_changed = TRUE;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT mx_status_type
+mxd_network_motor_wait_for_status_event( long num_motor_records,
+				MX_RECORD **motor_record_array,
+				double timeout_in_seconds,
+				mx_bool_type *status_changed )
+{
+	static const char fname[] =
+			"mxd_network_motor_wait_for_status_event()";
+
+	MX_MOTOR *motor;
+	MX_NETWORK_MOTOR *network_motor;
+	MX_CALLBACK *callback;
+	MX_RECORD **server_record_array;
+	long i, j, num_servers;
+	mx_status_type mx_status;
+
+	*status_changed = FALSE;
+
+	server_record_array = (MX_RECORD **)
+		malloc( num_motor_records * sizeof(MX_RECORD *) );
+
+	if ( server_record_array == (MX_RECORD **) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %ld element "
+		"server record array.", num_motor_records );
+	}
+
+	num_servers = 0;
+
+	for ( i = 0; i < num_motor_records; i++ ) {
+		motor = (MX_MOTOR *) motor_record_array[i]->record_class_struct;
+
+		mx_status = mxd_network_motor_get_pointers( motor,
+							&network_motor, fname );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( server_record_array );
+			return mx_status;
+		}
+
+		/* Ask the server for value changed callbacks on the
+		 * first call.  If the server does not support them,
+		 * the error is returned and the motor wait functions
+		 * go back to sleeping for the rest of the wait.
+		 */
+
+		if ( network_motor->status_callback == NULL ) {
+			network_motor->status_changed = FALSE;
+
+			mx_status = mx_remote_field_add_callback(
+					&(network_motor->status_nf),
+					MXCBT_VALUE_CHANGED,
+					mxd_network_motor_status_callback,
+					network_motor, &callback );
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				mx_free( server_record_array );
+				return mx_status;
+			}
+
+			network_motor->status_callback = callback;
+		}
+
+		for ( j = 0; j < num_servers; j++ ) {
+			if ( server_record_array[j]
+					== network_motor->server_record )
+			{
+				break;
+			}
+		}
+
+		if ( j >= num_servers ) {
+			server_record_array[ num_servers ]
+					= network_motor->server_record;
+
+			num_servers++;
+		}
+	}
+
+	/* A callback may already have arrived while the status
+	 * of the motors was being read.
+	 */
+
+	for ( i = 0; i < num_motor_records; i++ ) {
+		network_motor = (MX_NETWORK_MOTOR *)
+				motor_record_array[i]->record_type_struct;
+
+		if ( network_motor->status_changed ) {
+			*status_changed = TRUE;
+		}
+	}
+
+	if ( *status_changed == FALSE ) {
+		mx_status = mx_network_wait_for_messages_from_servers(
+					num_servers, server_record_array,
+					timeout_in_seconds );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( server_record_array );
+			return mx_status;
+		}
+	}
+
+	mx_free( server_record_array );
+
+	for ( i = 0; i < num_motor_records; i++ ) {
+		network_motor = (MX_NETWORK_MOTOR *)
+				motor_record_array[i]->record_type_struct;
+
+		if ( network_motor->status_changed ) {
+			*status_changed = TRUE;
+
+			network_motor->status_changed = FALSE;
+		}
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT mx_status_type
+mxd_network_motor_end_status_events( long num_motor_records,
+				MX_RECORD **motor_record_array )
+{
+	MX_NETWORK_MOTOR *network_motor;
+	MX_CALLBACK *callback;
+	long i;
+	mx_status_type mx_status, first_error;
+
+	first_error = MX_SUCCESSFUL_RESULT;
+
+	for ( i = 0; i < num_motor_records; i++ ) {
+		network_motor = (MX_NETWORK_MOTOR *)
+				motor_record_array[i]->record_type_struct;
+
+		if ( network_motor == (MX_NETWORK_MOTOR *) NULL )
+			continue;
+
+		callback = (MX_CALLBACK *) network_motor->status_callback;
+
+		network_motor->status_callback = NULL;
+		network_motor->status_changed = FALSE;
+
+		if ( callback == (MX_CALLBACK *) NULL )
+			continue;
+
+		mx_status = mx_remote_field_delete_callback( callback );
+
+		if ( ( mx_status.code != MXE_SUCCESS )
+		  && ( first_error.code == MXE_SUCCESS ) )
+		{
+			first_error = mx_status;
+		}
+	}
+
+	return first_error;
+}
+
 MX_EXPORT mx_status_type
 mxd_network_motor_get_extended_status( MX_MOTOR *motor )
 {
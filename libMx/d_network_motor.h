@@ -74,6 +74,14 @@ typedef struct {
 
 	unsigned long remote_motor_flags;
 
+	/* Used by the motor wait functions to wake up on value changed
+	 * callbacks for the remote 'status' field.  'status_callback'
+	 * is really an MX_CALLBACK pointer.
+	 */
+
+	void *status_callback;
+	mx_bool_type status_changed;
+
 	MX_NETWORK_FIELD acceleration_distance_nf;
 	MX_NETWORK_FIELD acceleration_feedforward_gain_nf;
 	MX_NETWORK_FIELD acceleration_time_nf;
@@ -151,6 +159,17 @@ MX_API mx_status_type mxd_network_motor_get_parameter( MX_MOTOR *motor );
 MX_API mx_status_type mxd_network_motor_set_parameter( MX_MOTOR *motor );
 MX_API mx_status_type mxd_network_motor_get_status( MX_MOTOR *motor );
 MX_API mx_status_type mxd_network_motor_get_extended_status( MX_MOTOR *motor );
+MX_API mx_status_type mxd_network_motor_get_status_array(
+					long num_motor_records,
+					MX_RECORD **motor_record_array );
+MX_API mx_status_type mxd_network_motor_wait_for_status_event(
+					long num_motor_records,
+					MX_RECORD **motor_record_array,
+					double timeout_in_seconds,
+					mx_bool_type *status_changed );
+MX_API mx_status_type mxd_network_motor_end_status_events(
+					long num_motor_records,
+					MX_RECORD **motor_record_array );
 MX_API mx_status_type mxd_network_motor_setup_triggered_move( MX_MOTOR *motor );
 MX_API mx_status_type mxd_network_motor_trigger_move( MX_MOTOR *motor );
 
@@ -42,7 +42,9 @@ MX_SCALER_FUNCTION_LIST mxd_network_scaler_scaler_function_list = {
 	mxd_network_scaler_start,
 	mxd_network_scaler_stop,
 	mxd_network_scaler_get_parameter,
-	mxd_network_scaler_set_parameter
+	mxd_network_scaler_set_parameter,
+	NULL,
+	mxd_network_scaler_read_array
 };
 
 /* MX network scaler data structures. */
@@ -275,6 +277,75 @@ mxd_network_scaler_read( MX_SCALER *scaler )
 	return mx_status;
 }
 
+/* mxd_network_scaler_read_array() sends the read requests for all of the
+ * scalers before waiting for any of the responses.  Requests to the same
+ * MX server are combined into one batch message.  If the batch fails,
+ * the scalers are read again one at a time.
+ */
+
+MX_EXPORT mx_status_type
+mxd_network_scaler_read_array( long num_records, MX_RECORD **record_array )
+{
+	static const char fname[] = "mxd_network_scaler_read_array()";
+
+	MX_SCALER *scaler;
+	MX_NETWORK_SCALER *network_scaler;
+	MX_NETWORK_ASYNC_REQUEST *request_array;
+	long i;
+	mx_status_type mx_status;
+
+	request_array = (MX_NETWORK_ASYNC_REQUEST *)
+		malloc( num_records * sizeof(MX_NETWORK_ASYNC_REQUEST) );
+
+	if ( request_array == (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate %ld network "
+		"requests.", num_records );
+	}
+
+	for ( i = 0; i < num_records; i++ ) {
+		scaler = (MX_SCALER *) record_array[i]->record_class_struct;
+
+		network_scaler = NULL;
+
+		mx_status = mxd_network_scaler_get_pointers(
+					scaler, &network_scaler, fname );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( request_array );
+			return mx_status;
+		}
+
+		mx_status = mx_network_setup_request( &request_array[i],
+					&(network_scaler->value_nf),
+					MXFT_LONG, 0, NULL,
+					&(scaler->raw_value) );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( request_array );
+			return mx_status;
+		}
+	}
+
+	mx_status = mx_get_array_batch( num_records, request_array );
+
+	mx_free( request_array );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		for ( i = 0; i < num_records; i++ ) {
+			scaler = (MX_SCALER *)
+				record_array[i]->record_class_struct;
+
+			mx_status = mxd_network_scaler_read( scaler );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+		}
+	}
+
+	return mx_status;
+}
+
 MX_EXPORT mx_status_type
 mxd_network_scaler_read_raw( MX_SCALER *scaler )
 {
@@ -45,6 +45,8 @@ MX_API mx_status_type mxd_network_scaler_start( MX_SCALER *scaler );
 MX_API mx_status_type mxd_network_scaler_stop( MX_SCALER *scaler );
 MX_API mx_status_type mxd_network_scaler_get_parameter( MX_SCALER *scaler );
 MX_API mx_status_type mxd_network_scaler_set_parameter( MX_SCALER *scaler );
+MX_API mx_status_type mxd_network_scaler_read_array( long num_records,
+						MX_RECORD **record_array );
 
 extern MX_RECORD_FUNCTION_LIST mxd_network_scaler_record_function_list;
 extern MX_SCALER_FUNCTION_LIST mxd_network_scaler_scaler_function_list;
@@ -417,7 +417,7 @@ mxd_relay_pulser_open( MX_RECORD *record )
 
 	list_head = mx_get_record_list_head_struct( record );
 
-	if ( list_head->callback_pipe == NULL ) {
+	if ( list_head->callback_queue == NULL ) {
 		relay_pulser->use_callback = FALSE;
 	} else {
 		relay_pulser->use_callback = TRUE;
@@ -467,7 +467,7 @@ mxd_relay_pulser_open( MX_RECORD *record )
 	/* Create a one-shot interval timer that will arrange for the
 	 * pulse generator's callback function to be called later.
 	 * 
-	 * We use a one-shot timer here to avoid filling the callback pipe.
+	 * We use a one-shot timer here to avoid filling the callback queue.
 	 */
 
 	mx_status = mx_virtual_timer_create(
@@ -506,7 +506,7 @@ mxd_sis3820_open( MX_RECORD *record )
 			record->name );
 	}
 
-	if ( list_head->callback_pipe == NULL ) {
+	if ( list_head->callback_queue == NULL ) {
 		sis3820->use_callback = FALSE;
 
 		mx_warning("MX callbacks are not enabled for this process.  "
@@ -681,7 +681,7 @@ mxd_sis3820_open( MX_RECORD *record )
 	/* Create a one-shot interval timer that will arrange for the
 	 * MCS's callback function to be called later.
 	 *
-	 * We use a one-shot timer here to avoid filling the callback pipe.
+	 * We use a one-shot timer here to avoid filling the callback queue.
 	 */
 
 	mx_status = mx_virtual_timer_create(
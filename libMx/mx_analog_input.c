@@ -134,34 +134,21 @@ mx_analog_input_finish_record_initialization( MX_RECORD *analog_input_record )
 
 /*=======================================================================*/
 
-MX_EXPORT mx_status_type
-mx_analog_input_read( MX_RECORD *record, double *value_ptr )
-{
-	static const char fname[] = "mx_analog_input_read()";
+/* mx_analog_input_compute_value() turns the raw value that the driver
+ * has just read into the value reported to the caller.  'mx_status' is
+ * the status returned by the driver's read function.
+ */
 
-	MX_ANALOG_INPUT *analog_input = NULL;
-	MX_ANALOG_INPUT_FUNCTION_LIST *function_list = NULL;
+static mx_status_type
+mx_analog_input_compute_value( MX_ANALOG_INPUT *analog_input,
+				mx_status_type mx_status,
+				double *value_ptr )
+{
 	MX_RECORD *timer_record;
 	double value, raw_value;
-	mx_status_type ( *read_fn ) ( MX_ANALOG_INPUT * );
 	long timer_mode;
 	int subtract_dark_current, normalize_to_value_per_second;
 	double normalized_dark_current, last_measurement_time;
-	mx_status_type mx_status;
-
-	mx_status = mx_analog_input_get_pointers( record, &analog_input,
-						&function_list, fname );
-
-	if ( mx_status.code != MXE_SUCCESS )
-		return mx_status;
-
-	read_fn = function_list->read;
-
-	if ( read_fn == NULL ){
-		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-		"read function ptr for MX_ANALOG_INPUT ptr 0x%p is NULL.",
-			analog_input);
-	}
 
 	/* We only subtract a dark current here if the analog input has
 	 * the MXF_AIN_SUBTRACT_DARK_CURRENT flag set.  However the
@@ -205,8 +192,6 @@ mx_analog_input_read( MX_RECORD *record, double *value_ptr )
 		normalize_to_value_per_second = FALSE;
 	}
 
-	mx_status = (*read_fn)( analog_input );
-
 	if ( analog_input->subclass == MXT_AIN_LONG ) {
 		raw_value = (double) analog_input->raw_value.long_value;
 	} else {
@@ -280,6 +265,174 @@ mx_analog_input_read( MX_RECORD *record, double *value_ptr )
 	return mx_status;
 }
 
+MX_EXPORT mx_status_type
+mx_analog_input_read( MX_RECORD *record, double *value_ptr )
+{
+	static const char fname[] = "mx_analog_input_read()";
+
+	MX_ANALOG_INPUT *analog_input = NULL;
+	MX_ANALOG_INPUT_FUNCTION_LIST *function_list = NULL;
+	mx_status_type ( *read_fn ) ( MX_ANALOG_INPUT * );
+	mx_status_type mx_status;
+
+	mx_status = mx_analog_input_get_pointers( record, &analog_input,
+						&function_list, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	read_fn = function_list->read;
+
+	if ( read_fn == NULL ){
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"read function ptr for MX_ANALOG_INPUT ptr 0x%p is NULL.",
+			analog_input);
+	}
+
+	mx_status = (*read_fn)( analog_input );
+
+	mx_status = mx_analog_input_compute_value( analog_input,
+						mx_status, value_ptr );
+
+	return mx_status;
+}
+
+MX_EXPORT mx_status_type
+mx_analog_input_array_read( long num_records,
+			MX_RECORD **record_array,
+			double *value_array )
+{
+	static const char fname[] = "mx_analog_input_array_read()";
+
+	MX_ANALOG_INPUT *analog_input;
+	MX_ANALOG_INPUT_FUNCTION_LIST *function_list;
+	mx_status_type ( *array_fptr )( long, MX_RECORD ** );
+	MX_RECORD **driver_record_array;
+	mx_bool_type *value_read;
+	long i, j, num_driver_records;
+	mx_status_type mx_status, array_status;
+
+	if ( record_array == (MX_RECORD **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The record_array pointer passed was NULL." );
+	}
+
+	if ( num_records <= 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	driver_record_array = (MX_RECORD **)
+			malloc( num_records * sizeof(MX_RECORD *) );
+
+	value_read = (mx_bool_type *)
+			calloc( num_records, sizeof(mx_bool_type) );
+
+	if ( ( driver_record_array == (MX_RECORD **) NULL )
+	  || ( value_read == (mx_bool_type *) NULL ) )
+	{
+		mx_free( driver_record_array );
+		mx_free( value_read );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate arrays for "
+		"%ld analog input records.", num_records );
+	}
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	for ( i = 0; i < num_records; i++ ) {
+
+		if ( value_read[i] )
+			continue;
+
+		mx_status = mx_analog_input_get_pointers( record_array[i],
+					&analog_input, &function_list, fname );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
+
+		array_fptr = function_list->read_array;
+
+		if ( array_fptr == NULL ) {
+			value_read[i] = TRUE;
+
+			mx_status = mx_analog_input_read( record_array[i],
+								NULL );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+
+			continue;
+		}
+
+		/* Gather the rest of the analog inputs that use the same
+		 * read_array() function.
+		 */
+
+		num_driver_records = 0;
+
+		for ( j = i; j < num_records; j++ ) {
+			if ( value_read[j] )
+				continue;
+
+			mx_status = mx_analog_input_get_pointers(
+					record_array[j], &analog_input,
+					&function_list, fname );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+
+			if ( function_list->read_array == array_fptr ) {
+				value_read[j] = TRUE;
+
+				driver_record_array[ num_driver_records ]
+						= record_array[j];
+
+				num_driver_records++;
+			}
+		}
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
+
+		array_status = ( *array_fptr )( num_driver_records,
+						driver_record_array );
+
+		for ( j = 0; j < num_driver_records; j++ ) {
+			analog_input = (MX_ANALOG_INPUT *)
+				driver_record_array[j]->record_class_struct;
+
+			mx_status = mx_analog_input_compute_value(
+					analog_input, array_status, NULL );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+		}
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
+	}
+
+	/* Copy out the value of each analog input.  The same analog input
+	 * may be in the array more than once.
+	 */
+
+	if ( ( mx_status.code == MXE_SUCCESS )
+	  && ( value_array != (double *) NULL ) )
+	{
+		for ( i = 0; i < num_records; i++ ) {
+			analog_input = (MX_ANALOG_INPUT *)
+				record_array[i]->record_class_struct;
+
+			value_array[i] = analog_input->value;
+		}
+	}
+
+	mx_free( driver_record_array );
+	mx_free( value_read );
+
+	return mx_status;
+}
+
 MX_EXPORT mx_status_type
 mx_analog_input_read_raw_long( MX_RECORD *record, long *raw_value )
 {
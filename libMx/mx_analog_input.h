@@ -113,6 +113,14 @@ typedef struct {
 	mx_status_type ( *get_dark_current ) ( MX_ANALOG_INPUT *adc );
 	mx_status_type ( *set_dark_current ) ( MX_ANALOG_INPUT *adc );
 	mx_status_type ( *clear ) ( MX_ANALOG_INPUT *adc );
+
+	/* read_array() is passed only analog inputs that use this driver.
+	 * It must update 'raw_value' for each of them in the same way
+	 * as read(), but may read all of them at the same time.
+	 */
+
+	mx_status_type ( *read_array ) ( long num_records,
+					MX_RECORD **record_array );
 } MX_ANALOG_INPUT_FUNCTION_LIST;
 
 MX_API mx_status_type mx_analog_input_finish_record_initialization(
@@ -121,6 +129,16 @@ MX_API mx_status_type mx_analog_input_finish_record_initialization(
 MX_API mx_status_type mx_analog_input_read( MX_RECORD *adc_record,
 							double *value );
 
+/* mx_analog_input_array_read() reads all of the analog inputs in the
+ * array.  Analog inputs whose drivers have a read_array() function are
+ * read together, so that, for example, the requests for network analog
+ * inputs are all in flight at the same time.  'value_array' may be NULL.
+ */
+
+MX_API mx_status_type mx_analog_input_array_read( long num_records,
+						MX_RECORD **record_array,
+						double *value_array );
+
 MX_API mx_status_type mx_analog_input_read_raw_long( MX_RECORD *adc_record,
 							long *raw_value );
 
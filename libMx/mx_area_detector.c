@@ -7439,7 +7439,7 @@ mx_area_detector_setup_datafile_management( MX_RECORD *record,
 
 	ad->datafile_management_handler = handler_fn;
 
-	/* If we are running in a server with an active callback pipe,
+	/* If we are running in a server with an active callback queue,
 	 * then setup a timer callback with the handler function as the
 	 * callback handler.
 	 */
@@ -7453,13 +7453,13 @@ mx_area_detector_setup_datafile_management( MX_RECORD *record,
 			record->name );
 	}
 
-	if ( list_head->callback_pipe == NULL ) {
-		/* No callback pipe has been created, so we do not need to
+	if ( list_head->callback_queue == NULL ) {
+		/* No callback queue has been created, so we do not need to
 		 * set up a callback.  This means that we are done here.
 		 */
 
 #if MX_AREA_DETECTOR_DEBUG_DATAFILE_AUTOSAVE
-		MX_DEBUG(-2,("%s: No callback pipe, so returning...", fname));
+		MX_DEBUG(-2,("%s: No callback queue, so returning...", fname));
 #endif
 
 		return MX_SUCCESSFUL_RESULT;
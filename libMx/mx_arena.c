@@ -0,0 +1,408 @@
+/*
+ * Name:    mx_arena.c
+ *
+ * Purpose: MX memory arenas.
+ *
+ *--------------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mx_util.h"
+#include "mx_stdint.h"
+#include "mx_arena.h"
+
+/* All allocations are rounded up to a multiple of this. */
+
+#define MXP_ARENA_ALIGNMENT	16
+
+#define MXP_ARENA_ROUND_UP(x) \
+	( ( (x) + MXP_ARENA_ALIGNMENT - 1 ) & ~((size_t) MXP_ARENA_ALIGNMENT - 1) )
+
+typedef struct mxp_arena_block_type {
+	struct mxp_arena_block_type *next_block;
+	size_t block_size;
+	size_t bytes_used;
+
+	/* Keep the data that follows aligned. */
+
+	double padding;
+} MXP_ARENA_BLOCK;
+
+#define MXP_ARENA_HEADER_SIZE	MXP_ARENA_ROUND_UP( sizeof(MXP_ARENA_BLOCK) )
+
+/* Each allocation is preceded by its rounded up size, so that
+ * mx_arena_free() knows which free list it belongs on.
+ */
+
+#define MXP_ARENA_SIZE_PREFIX	MXP_ARENA_ALIGNMENT
+
+/* Freed allocations of one size are chained together through their
+ * first bytes.  There are only a few different sizes in practice,
+ * since records of the same type are all the same size.
+ */
+
+typedef struct mxp_arena_free_list_type {
+	struct mxp_arena_free_list_type *next_list;
+	size_t num_bytes;
+	void *first_free;
+} MXP_ARENA_FREE_LIST;
+
+struct mx_arena_type {
+	size_t block_size;
+
+	/* New memory is taken from the first block in the list.  Blocks
+	 * that were allocated for a single large request are put second
+	 * in the list, so that they do not replace the first block.
+	 */
+
+	MXP_ARENA_BLOCK *block_list;
+
+	/* All of the blocks again, sorted by address,
+	 * for mx_arena_contains().
+	 */
+
+	long num_blocks;
+	long max_blocks;
+	MXP_ARENA_BLOCK **sorted_block_array;
+
+	MXP_ARENA_FREE_LIST *free_lists;
+
+	size_t bytes_allocated;
+	size_t bytes_reserved;
+};
+
+MX_EXPORT mx_status_type
+mx_arena_create( MX_ARENA **arena, size_t block_size )
+{
+	static const char fname[] = "mx_arena_create()";
+
+	MX_ARENA *new_arena;
+
+	if ( arena == (MX_ARENA **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_ARENA pointer passed was NULL." );
+	}
+
+	if ( block_size < 4096 ) {
+		block_size = 4096;
+	}
+
+	new_arena = (MX_ARENA *) calloc( 1, sizeof(MX_ARENA) );
+
+	if ( new_arena == (MX_ARENA *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an MX_ARENA structure." );
+	}
+
+	new_arena->block_size = block_size;
+	new_arena->block_list = NULL;
+	new_arena->free_lists = NULL;
+
+	*arena = new_arena;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT void
+mx_arena_destroy( MX_ARENA *arena )
+{
+	MXP_ARENA_BLOCK *block, *next_block;
+	MXP_ARENA_FREE_LIST *free_list, *next_list;
+
+	if ( arena == (MX_ARENA *) NULL )
+		return;
+
+	free_list = arena->free_lists;
+
+	while ( free_list != (MXP_ARENA_FREE_LIST *) NULL ) {
+		next_list = free_list->next_list;
+
+		free( free_list );
+
+		free_list = next_list;
+	}
+
+	block = arena->block_list;
+
+	while ( block != (MXP_ARENA_BLOCK *) NULL ) {
+		next_block = block->next_block;
+
+		free( block );
+
+		block = next_block;
+	}
+
+	mx_free( arena->sorted_block_array );
+
+	free( arena );
+}
+
+/* Returns the index of the first block in the sorted block array
+ * whose address is greater than 'ptr'.
+ */
+
+static long
+mxp_arena_find_block( MX_ARENA *arena, const void *ptr )
+{
+	long low, high, middle;
+
+	low = 0;
+	high = arena->num_blocks;
+
+	while ( low < high ) {
+		middle = ( low + high ) / 2;
+
+		if ( (const char *) arena->sorted_block_array[middle]
+						<= (const char *) ptr )
+		{
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+static MXP_ARENA_BLOCK *
+mxp_arena_new_block( MX_ARENA *arena, size_t block_size )
+{
+	MXP_ARENA_BLOCK *block, **new_array;
+	long i;
+
+	if ( arena->num_blocks >= arena->max_blocks ) {
+		new_array = (MXP_ARENA_BLOCK **) realloc(
+				arena->sorted_block_array,
+				( arena->max_blocks + 64 )
+					* sizeof(MXP_ARENA_BLOCK *) );
+
+		if ( new_array == (MXP_ARENA_BLOCK **) NULL )
+			return NULL;
+
+		arena->sorted_block_array = new_array;
+		arena->max_blocks += 64;
+	}
+
+	block = (MXP_ARENA_BLOCK *) malloc( MXP_ARENA_HEADER_SIZE + block_size );
+
+	if ( block == (MXP_ARENA_BLOCK *) NULL )
+		return NULL;
+
+	i = mxp_arena_find_block( arena, block );
+
+	memmove( &(arena->sorted_block_array[i+1]),
+		&(arena->sorted_block_array[i]),
+		( arena->num_blocks - i ) * sizeof(MXP_ARENA_BLOCK *) );
+
+	arena->sorted_block_array[i] = block;
+	arena->num_blocks++;
+
+	block->next_block = NULL;
+	block->block_size = block_size;
+	block->bytes_used = 0;
+
+	arena->bytes_reserved += MXP_ARENA_HEADER_SIZE + block_size;
+
+	return block;
+}
+
+static MXP_ARENA_FREE_LIST *
+mxp_arena_find_free_list( MX_ARENA *arena, size_t num_bytes )
+{
+	MXP_ARENA_FREE_LIST *free_list;
+
+	free_list = arena->free_lists;
+
+	while ( free_list != (MXP_ARENA_FREE_LIST *) NULL ) {
+		if ( free_list->num_bytes == num_bytes )
+			break;
+
+		free_list = free_list->next_list;
+	}
+
+	return free_list;
+}
+
+MX_EXPORT void *
+mx_arena_allocate( MX_ARENA *arena, size_t num_bytes )
+{
+	MXP_ARENA_BLOCK *block;
+	MXP_ARENA_FREE_LIST *free_list;
+	size_t total_bytes;
+	char *ptr;
+
+	if ( arena == (MX_ARENA *) NULL )
+		return NULL;
+
+	num_bytes = MXP_ARENA_ROUND_UP( num_bytes );
+
+	if ( num_bytes == 0 ) {
+		num_bytes = MXP_ARENA_ALIGNMENT;
+	}
+
+	/* Reuse a freed allocation of the same size if there is one. */
+
+	free_list = mxp_arena_find_free_list( arena, num_bytes );
+
+	if ( ( free_list != (MXP_ARENA_FREE_LIST *) NULL )
+	  && ( free_list->first_free != NULL ) )
+	{
+		ptr = (char *) free_list->first_free;
+
+		free_list->first_free = *((void **) ptr);
+
+		arena->bytes_allocated += num_bytes;
+
+		memset( ptr, 0, num_bytes );
+
+		return ptr;
+	}
+
+	total_bytes = MXP_ARENA_SIZE_PREFIX + num_bytes;
+
+	block = arena->block_list;
+
+	if ( total_bytes > ( arena->block_size / 4 ) ) {
+
+		/* Large requests get a block of their own, which is put
+		 * behind the current block.
+		 */
+
+		block = mxp_arena_new_block( arena, total_bytes );
+
+		if ( block == (MXP_ARENA_BLOCK *) NULL )
+			return NULL;
+
+		if ( arena->block_list == (MXP_ARENA_BLOCK *) NULL ) {
+			arena->block_list = block;
+		} else {
+			block->next_block = arena->block_list->next_block;
+			arena->block_list->next_block = block;
+		}
+	} else
+	if ( ( block == (MXP_ARENA_BLOCK *) NULL )
+	  || ( ( block->block_size - block->bytes_used ) < total_bytes ) )
+	{
+		block = mxp_arena_new_block( arena, arena->block_size );
+
+		if ( block == (MXP_ARENA_BLOCK *) NULL )
+			return NULL;
+
+		block->next_block = arena->block_list;
+		arena->block_list = block;
+	}
+
+	ptr = (char *) block + MXP_ARENA_HEADER_SIZE + block->bytes_used;
+
+	block->bytes_used += total_bytes;
+
+	arena->bytes_allocated += num_bytes;
+
+	*((size_t *) ptr) = num_bytes;
+
+	ptr += MXP_ARENA_SIZE_PREFIX;
+
+	memset( ptr, 0, num_bytes );
+
+	return ptr;
+}
+
+MX_EXPORT void
+mx_arena_free( MX_ARENA *arena, void *ptr )
+{
+	MXP_ARENA_FREE_LIST *free_list;
+	size_t num_bytes;
+
+	if ( ( arena == (MX_ARENA *) NULL ) || ( ptr == NULL ) )
+		return;
+
+	num_bytes = *((size_t *) ( (char *) ptr - MXP_ARENA_SIZE_PREFIX ));
+
+	free_list = mxp_arena_find_free_list( arena, num_bytes );
+
+	if ( free_list == (MXP_ARENA_FREE_LIST *) NULL ) {
+		free_list = (MXP_ARENA_FREE_LIST *)
+				malloc( sizeof(MXP_ARENA_FREE_LIST) );
+
+		/* If we cannot keep track of the memory, it is simply
+		 * not reused until the arena is destroyed.
+		 */
+
+		if ( free_list == (MXP_ARENA_FREE_LIST *) NULL )
+			return;
+
+		free_list->num_bytes = num_bytes;
+		free_list->first_free = NULL;
+
+		free_list->next_list = arena->free_lists;
+		arena->free_lists = free_list;
+	}
+
+	*((void **) ptr) = free_list->first_free;
+
+	free_list->first_free = ptr;
+
+	arena->bytes_allocated -= num_bytes;
+}
+
+MX_EXPORT mx_bool_type
+mx_arena_contains( MX_ARENA *arena, const void *ptr )
+{
+	MXP_ARENA_BLOCK *block;
+	const char *data;
+	long i;
+
+	if ( ( arena == (MX_ARENA *) NULL ) || ( ptr == NULL ) )
+		return FALSE;
+
+	/* The only block that can contain 'ptr' is the last one
+	 * that starts at or before it.
+	 */
+
+	i = mxp_arena_find_block( arena, ptr );
+
+	if ( i == 0 )
+		return FALSE;
+
+	block = arena->sorted_block_array[i-1];
+
+	data = (const char *) block + MXP_ARENA_HEADER_SIZE;
+
+	if ( ( (const char *) ptr >= data )
+	  && ( (const char *) ptr < ( data + block->bytes_used ) ) )
+	{
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+MX_EXPORT void
+mx_arena_get_statistics( MX_ARENA *arena,
+			size_t *bytes_allocated,
+			size_t *bytes_reserved )
+{
+	if ( arena == (MX_ARENA *) NULL ) {
+		if ( bytes_allocated != NULL )
+			*bytes_allocated = 0;
+		if ( bytes_reserved != NULL )
+			*bytes_reserved = 0;
+
+		return;
+	}
+
+	if ( bytes_allocated != NULL )
+		*bytes_allocated = arena->bytes_allocated;
+	if ( bytes_reserved != NULL )
+		*bytes_reserved = arena->bytes_reserved;
+}
+
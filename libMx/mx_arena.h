@@ -0,0 +1,68 @@
+/*
+ * Name:    mx_arena.h
+ *
+ * Purpose: Header file for MX memory arenas.
+ *
+ *          An MX arena hands out memory from large blocks by advancing
+ *          a pointer.  This makes allocation cheap and keeps objects
+ *          that are allocated together next to each other in memory.
+ *          Individual allocations can be given back to the arena with
+ *          mx_arena_free(), which keeps them on a free list for later
+ *          allocations of the same size.  The memory itself only goes
+ *          back to the system when the arena is destroyed.
+ *
+ *--------------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#ifndef __MX_ARENA_H__
+#define __MX_ARENA_H__
+
+/* Make the header file C++ safe. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mx_arena_type MX_ARENA;
+
+/* 'block_size' is the size of the blocks that the arena gets from
+ * malloc().  Requests larger than a quarter of the block size are
+ * given a block of their own.
+ */
+
+MX_API mx_status_type mx_arena_create( MX_ARENA **arena, size_t block_size );
+
+MX_API void mx_arena_destroy( MX_ARENA *arena );
+
+/* mx_arena_allocate() returns zeroed memory that is suitably aligned for
+ * any MX data type, or NULL if no memory is available.
+ */
+
+MX_API void *mx_arena_allocate( MX_ARENA *arena, size_t num_bytes );
+
+/* 'ptr' must have been returned by mx_arena_allocate() for this arena. */
+
+MX_API void mx_arena_free( MX_ARENA *arena, void *ptr );
+
+MX_API mx_bool_type mx_arena_contains( MX_ARENA *arena, const void *ptr );
+
+/* mx_arena_get_statistics() reports the number of bytes handed out by
+ * the arena and the number of bytes it has obtained from malloc().
+ */
+
+MX_API void mx_arena_get_statistics( MX_ARENA *arena,
+					size_t *bytes_allocated,
+					size_t *bytes_reserved );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MX_ARENA_H__ */
+
@@ -236,6 +236,12 @@ MX_API mx_status_type mx_xdr_data_transfer( int direction,
 		void *destination_buffer, size_t destination_buffer_length,
 		size_t *num_bytes_copied );
 
+/* mx_xdr_set_bulk_transfer() turns the bulk conversion of numeric
+ * XDR arrays on or off.  It is on by default.
+ */
+
+MX_API void mx_xdr_set_bulk_transfer( mx_bool_type use_bulk_transfer );
+
 /*---*/
 
 MX_API mx_status_type mx_convert_and_copy_array_old(
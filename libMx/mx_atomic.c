@@ -7,7 +7,7 @@
  *
  *-------------------------------------------------------------------------
  *
- * Copyright 2009, 2011-2012, 2014, 2016-2018 Illinois Institute of Technology
+ * Copyright 2009, 2011-2012, 2014, 2016-2018, 2026 Illinois Institute of Technology
  *
  * See the file "LICENSE" for information on usage and redistribution
  * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
@@ -15,6 +15,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "mx_util.h"
 #include "mx_stdint.h"
@@ -48,11 +49,26 @@
 
 #define MXP_NEED_GENERIC_WRITE32	FALSE
 
+/* The 64-bit and pointer Interlocked functions first appeared
+ * in Visual C++ 2005.
+ */
+
+#if ( defined(_MSC_VER) && (_MSC_VER >= 1400) ) || defined(__MINGW32__)
+#  define MXP_NEED_GENERIC_ATOMICS	FALSE
+#else
+#  define MXP_NEED_GENERIC_ATOMICS	TRUE
+
+static MX_MUTEX *mxp_atomic_mutex = NULL;
+#endif
+
 #include <windows.h>
 
 MX_EXPORT void
 mx_atomic_initialize( void )
 {
+#if MXP_NEED_GENERIC_ATOMICS
+	(void) mx_mutex_create( &mxp_atomic_mutex );
+#endif
 	return;
 }
 
@@ -244,6 +260,190 @@ mx_atomic_memory_barrier( void )
 
 #endif
 
+/*---*/
+
+#if ( MXP_NEED_GENERIC_ATOMICS == FALSE )
+
+/* The Interlocked functions are all full barriers,
+ * so the requested memory order is not needed.
+ */
+
+MX_EXPORT int32_t
+mx_atomic_load32( int32_t *value_ptr, int memory_order )
+{
+	return InterlockedCompareExchange( (LONG *) value_ptr, 0, 0 );
+}
+
+MX_EXPORT void
+mx_atomic_store32( int32_t *value_ptr, int32_t new_value, int memory_order )
+{
+	(void) InterlockedExchange( (LONG *) value_ptr, new_value );
+}
+
+MX_EXPORT int32_t
+mx_atomic_exchange32( int32_t *value_ptr, int32_t new_value, int memory_order )
+{
+	return InterlockedExchange( (LONG *) value_ptr, new_value );
+}
+
+MX_EXPORT mx_bool_type
+mx_atomic_compare_and_swap32( int32_t *value_ptr,
+				int32_t *expected,
+				int32_t desired,
+				int memory_order )
+{
+	LONG old_value;
+
+	old_value = InterlockedCompareExchange( (LONG *) value_ptr,
+						desired, *expected );
+
+	if ( old_value == *expected ) {
+		return TRUE;
+	}
+
+	*expected = old_value;
+
+	return FALSE;
+}
+
+MX_EXPORT int32_t
+mx_atomic_fetch_add32( int32_t *value_ptr, int32_t increment, int memory_order )
+{
+	return InterlockedExchangeAdd( (LONG *) value_ptr, increment );
+}
+
+/*---*/
+
+/* On 32-bit Windows, InterlockedCompareExchange64() is the only 64-bit
+ * Interlocked function that is available everywhere, so the others are
+ * built on top of it.
+ */
+
+MX_EXPORT int64_t
+mx_atomic_load64( int64_t *value_ptr, int memory_order )
+{
+	return InterlockedCompareExchange64( (LONGLONG *) value_ptr, 0, 0 );
+}
+
+MX_EXPORT int64_t
+mx_atomic_exchange64( int64_t *value_ptr, int64_t new_value, int memory_order )
+{
+	LONGLONG old_value, current_value;
+
+	old_value = *value_ptr;
+
+	for (;;) {
+		current_value = InterlockedCompareExchange64(
+				(LONGLONG *) value_ptr, new_value, old_value );
+
+		if ( current_value == old_value )
+			break;
+
+		old_value = current_value;
+	}
+
+	return old_value;
+}
+
+MX_EXPORT void
+mx_atomic_store64( int64_t *value_ptr, int64_t new_value, int memory_order )
+{
+	(void) mx_atomic_exchange64( value_ptr, new_value, memory_order );
+}
+
+MX_EXPORT mx_bool_type
+mx_atomic_compare_and_swap64( int64_t *value_ptr,
+				int64_t *expected,
+				int64_t desired,
+				int memory_order )
+{
+	LONGLONG old_value;
+
+	old_value = InterlockedCompareExchange64( (LONGLONG *) value_ptr,
+						desired, *expected );
+
+	if ( old_value == *expected ) {
+		return TRUE;
+	}
+
+	*expected = old_value;
+
+	return FALSE;
+}
+
+MX_EXPORT int64_t
+mx_atomic_fetch_add64( int64_t *value_ptr, int64_t increment, int memory_order )
+{
+	LONGLONG old_value, current_value;
+
+	old_value = *value_ptr;
+
+	for (;;) {
+		current_value = InterlockedCompareExchange64(
+				(LONGLONG *) value_ptr,
+				old_value + increment, old_value );
+
+		if ( current_value == old_value )
+			break;
+
+		old_value = current_value;
+	}
+
+	return old_value;
+}
+
+/*---*/
+
+MX_EXPORT void *
+mx_atomic_load_pointer( void **pointer_ptr, int memory_order )
+{
+	return InterlockedCompareExchangePointer( pointer_ptr, NULL, NULL );
+}
+
+MX_EXPORT void
+mx_atomic_store_pointer( void **pointer_ptr, void *new_pointer,
+					int memory_order )
+{
+	(void) InterlockedExchangePointer( pointer_ptr, new_pointer );
+}
+
+MX_EXPORT void *
+mx_atomic_exchange_pointer( void **pointer_ptr, void *new_pointer,
+					int memory_order )
+{
+	return InterlockedExchangePointer( pointer_ptr, new_pointer );
+}
+
+MX_EXPORT mx_bool_type
+mx_atomic_compare_and_swap_pointer( void **pointer_ptr,
+				void **expected,
+				void *desired,
+				int memory_order )
+{
+	void *old_pointer;
+
+	old_pointer = InterlockedCompareExchangePointer( pointer_ptr,
+							desired, *expected );
+
+	if ( old_pointer == *expected ) {
+		return TRUE;
+	}
+
+	*expected = old_pointer;
+
+	return FALSE;
+}
+
+MX_EXPORT void
+mx_atomic_thread_fence( int memory_order )
+{
+	if ( memory_order != MX_ATOMIC_RELAXED ) {
+		mx_atomic_memory_barrier();
+	}
+}
+
+#endif /* MXP_NEED_GENERIC_ATOMICS == FALSE */
+
 /*------------------------------------------------------------------------*/
 
 #elif defined(OS_MACOSX) 
@@ -255,8 +455,9 @@ mx_atomic_memory_barrier( void )
 /* For MacOS x 10.12 and above (or macOS if you insist). */
 
 #define MXP_NEED_GENERIC_WRITE32	TRUE
+#define MXP_NEED_GENERIC_ATOMICS	FALSE
 
-static MX_MUTEX *mxp_atomic_write32_mutex = NULL;
+static MX_MUTEX *mxp_atomic_mutex = NULL;
 
 #include <stdatomic.h>
 #include <libkern/OSAtomic.h>
@@ -264,7 +465,7 @@ static MX_MUTEX *mxp_atomic_write32_mutex = NULL;
 MX_EXPORT void
 mx_atomic_initialize( void )
 {
-	(void) mx_mutex_create( &mxp_atomic_write32_mutex );
+	(void) mx_mutex_create( &mxp_atomic_mutex );
 }
 
 /*---*/
@@ -323,6 +524,202 @@ mx_atomic_memory_barrier( void )
 	return;
 }
 
+/*---*/
+
+static memory_order
+mxp_c11_memory_order( int memory_order )
+{
+	switch( memory_order ) {
+	case MX_ATOMIC_RELAXED:
+		return memory_order_relaxed;
+	case MX_ATOMIC_ACQUIRE:
+		return memory_order_acquire;
+	case MX_ATOMIC_RELEASE:
+		return memory_order_release;
+	case MX_ATOMIC_ACQ_REL:
+		return memory_order_acq_rel;
+	default:
+		return memory_order_seq_cst;
+	}
+}
+
+/* Loads may not use release ordering and stores may not use
+ * acquire ordering.
+ */
+
+static memory_order
+mxp_c11_load_order( int memory_order )
+{
+	switch( memory_order ) {
+	case MX_ATOMIC_RELAXED:
+		return memory_order_relaxed;
+	case MX_ATOMIC_ACQUIRE:
+	case MX_ATOMIC_ACQ_REL:
+		return memory_order_acquire;
+	default:
+		return memory_order_seq_cst;
+	}
+}
+
+static memory_order
+mxp_c11_store_order( int memory_order )
+{
+	switch( memory_order ) {
+	case MX_ATOMIC_RELAXED:
+		return memory_order_relaxed;
+	case MX_ATOMIC_RELEASE:
+	case MX_ATOMIC_ACQ_REL:
+		return memory_order_release;
+	default:
+		return memory_order_seq_cst;
+	}
+}
+
+/* The order used when a compare and swap fails, which is a load. */
+
+static memory_order
+mxp_c11_failure_order( int memory_order )
+{
+	switch( memory_order ) {
+	case MX_ATOMIC_RELAXED:
+	case MX_ATOMIC_RELEASE:
+		return memory_order_relaxed;
+	case MX_ATOMIC_ACQUIRE:
+	case MX_ATOMIC_ACQ_REL:
+		return memory_order_acquire;
+	default:
+		return memory_order_seq_cst;
+	}
+}
+
+MX_EXPORT int32_t
+mx_atomic_load32( int32_t *value_ptr, int memory_order )
+{
+	return atomic_load_explicit( (_Atomic int32_t *) value_ptr,
+				mxp_c11_load_order( memory_order ) );
+}
+
+MX_EXPORT void
+mx_atomic_store32( int32_t *value_ptr, int32_t new_value, int memory_order )
+{
+	atomic_store_explicit( (_Atomic int32_t *) value_ptr, new_value,
+				mxp_c11_store_order( memory_order ) );
+}
+
+MX_EXPORT int32_t
+mx_atomic_exchange32( int32_t *value_ptr, int32_t new_value, int memory_order )
+{
+	return atomic_exchange_explicit( (_Atomic int32_t *) value_ptr,
+				new_value, mxp_c11_memory_order( memory_order ) );
+}
+
+MX_EXPORT mx_bool_type
+mx_atomic_compare_and_swap32( int32_t *value_ptr,
+				int32_t *expected,
+				int32_t desired,
+				int memory_order )
+{
+	return atomic_compare_exchange_strong_explicit(
+				(_Atomic int32_t *) value_ptr,
+				expected, desired,
+				mxp_c11_memory_order( memory_order ),
+				mxp_c11_failure_order( memory_order ) );
+}
+
+MX_EXPORT int32_t
+mx_atomic_fetch_add32( int32_t *value_ptr, int32_t increment, int memory_order )
+{
+	return atomic_fetch_add_explicit( (_Atomic int32_t *) value_ptr,
+				increment, mxp_c11_memory_order( memory_order ) );
+}
+
+/*---*/
+
+MX_EXPORT int64_t
+mx_atomic_load64( int64_t *value_ptr, int memory_order )
+{
+	return atomic_load_explicit( (_Atomic int64_t *) value_ptr,
+				mxp_c11_load_order( memory_order ) );
+}
+
+MX_EXPORT void
+mx_atomic_store64( int64_t *value_ptr, int64_t new_value, int memory_order )
+{
+	atomic_store_explicit( (_Atomic int64_t *) value_ptr, new_value,
+				mxp_c11_store_order( memory_order ) );
+}
+
+MX_EXPORT int64_t
+mx_atomic_exchange64( int64_t *value_ptr, int64_t new_value, int memory_order )
+{
+	return atomic_exchange_explicit( (_Atomic int64_t *) value_ptr,
+				new_value, mxp_c11_memory_order( memory_order ) );
+}
+
+MX_EXPORT mx_bool_type
+mx_atomic_compare_and_swap64( int64_t *value_ptr,
+				int64_t *expected,
+				int64_t desired,
+				int memory_order )
+{
+	return atomic_compare_exchange_strong_explicit(
+				(_Atomic int64_t *) value_ptr,
+				expected, desired,
+				mxp_c11_memory_order( memory_order ),
+				mxp_c11_failure_order( memory_order ) );
+}
+
+MX_EXPORT int64_t
+mx_atomic_fetch_add64( int64_t *value_ptr, int64_t increment, int memory_order )
+{
+	return atomic_fetch_add_explicit( (_Atomic int64_t *) value_ptr,
+				increment, mxp_c11_memory_order( memory_order ) );
+}
+
+/*---*/
+
+MX_EXPORT void *
+mx_atomic_load_pointer( void **pointer_ptr, int memory_order )
+{
+	return atomic_load_explicit( (_Atomic(void *) *) pointer_ptr,
+				mxp_c11_load_order( memory_order ) );
+}
+
+MX_EXPORT void
+mx_atomic_store_pointer( void **pointer_ptr, void *new_pointer,
+					int memory_order )
+{
+	atomic_store_explicit( (_Atomic(void *) *) pointer_ptr, new_pointer,
+				mxp_c11_store_order( memory_order ) );
+}
+
+MX_EXPORT void *
+mx_atomic_exchange_pointer( void **pointer_ptr, void *new_pointer,
+					int memory_order )
+{
+	return atomic_exchange_explicit( (_Atomic(void *) *) pointer_ptr,
+			new_pointer, mxp_c11_memory_order( memory_order ) );
+}
+
+MX_EXPORT mx_bool_type
+mx_atomic_compare_and_swap_pointer( void **pointer_ptr,
+				void **expected,
+				void *desired,
+				int memory_order )
+{
+	return atomic_compare_exchange_strong_explicit(
+				(_Atomic(void *) *) pointer_ptr,
+				expected, desired,
+				mxp_c11_memory_order( memory_order ),
+				mxp_c11_failure_order( memory_order ) );
+}
+
+MX_EXPORT void
+mx_atomic_thread_fence( int memory_order )
+{
+	atomic_thread_fence( mxp_c11_memory_order( memory_order ) );
+}
+
 /*-----*/
 
 #  elif defined(MX_MACOSX_HAVE_OSATOMIC)
@@ -330,15 +727,16 @@ mx_atomic_memory_barrier( void )
 /* For MacOS X 10.4 and above. */
 
 #define MXP_NEED_GENERIC_WRITE32	TRUE
+#define MXP_NEED_GENERIC_ATOMICS	TRUE
 
-static MX_MUTEX *mxp_atomic_write32_mutex = NULL;
+static MX_MUTEX *mxp_atomic_mutex = NULL;
 
 #include <libkern/OSAtomic.h>
 
 MX_EXPORT void
 mx_atomic_initialize( void )
 {
-	(void) mx_mutex_create( &mxp_atomic_write32_mutex );
+	(void) mx_mutex_create( &mxp_atomic_mutex );
 }
 
 /*---*/
@@ -389,15 +787,16 @@ mx_atomic_memory_barrier( void )
 /* For Solaris 10 and above. */
 
 #define MXP_NEED_GENERIC_WRITE32	TRUE
+#define MXP_NEED_GENERIC_ATOMICS	TRUE
 
-static MX_MUTEX *mxp_atomic_write32_mutex = NULL;
+static MX_MUTEX *mxp_atomic_mutex = NULL;
 
 #include <atomic.h>
 
 MX_EXPORT void
 mx_atomic_initialize( void )
 {
-	(void) mx_mutex_create( &mxp_atomic_write32_mutex );
+	(void) mx_mutex_create( &mxp_atomic_mutex );
 }
 
 /*---*/
@@ -455,6 +854,9 @@ mx_atomic_memory_barrier( void )
 #elif defined(OS_IRIX)
 
 #define MXP_NEED_GENERIC_WRITE32	FALSE
+#define MXP_NEED_GENERIC_ATOMICS	TRUE
+
+static MX_MUTEX *mxp_atomic_mutex = NULL;
 
 #include <sgidefs.h>
 #include <mutex.h>
@@ -462,7 +864,7 @@ mx_atomic_memory_barrier( void )
 MX_EXPORT void
 mx_atomic_initialize( void )
 {
-	return;
+	(void) mx_mutex_create( &mxp_atomic_mutex );
 }
 
 /*---*/
@@ -538,8 +940,9 @@ mx_atomic_memory_barrier( void )
 #elif defined(OS_QNX)
 
 #define MXP_NEED_GENERIC_WRITE32	TRUE
+#define MXP_NEED_GENERIC_ATOMICS	TRUE
 
-static MX_MUTEX *mxp_atomic_write32_mutex = NULL;
+static MX_MUTEX *mxp_atomic_mutex = NULL;
 
 #include <atomic.h>
 #include <pthread.h>
@@ -547,7 +950,7 @@ static MX_MUTEX *mxp_atomic_write32_mutex = NULL;
 MX_EXPORT void
 mx_atomic_initialize( void )
 {
-	(void) mx_mutex_create( &mxp_atomic_write32_mutex );
+	(void) mx_mutex_create( &mxp_atomic_mutex );
 }
 
 /*---*/
@@ -641,15 +1044,16 @@ mx_atomic_memory_barrier( void )
 #elif defined(OS_VMS) && !defined(__VAX)
 
 #define MXP_NEED_GENERIC_WRITE32	TRUE
+#define MXP_NEED_GENERIC_ATOMICS	TRUE
 
-static MX_MUTEX *mxp_atomic_write32_mutex = NULL;
+static MX_MUTEX *mxp_atomic_mutex = NULL;
 
 #include <builtins.h>
 
 MX_EXPORT void
 mx_atomic_initialize( void )
 {
-	(void) mx_mutex_create( &mxp_atomic_write32_mutex );
+	(void) mx_mutex_create( &mxp_atomic_mutex );
 }
 
 /*---*/
@@ -694,24 +1098,268 @@ mx_atomic_memory_barrier( void )
 
 /*------------------------------------------------------------------------*/
 
+#elif defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+
+/* For GCC 4.7 and above and for Clang, which provide the C11 style
+ * __atomic builtins.  This is what Linux uses on all architectures.
+ */
+
+#define MXP_NEED_GENERIC_WRITE32	FALSE
+#define MXP_NEED_GENERIC_ATOMICS	FALSE
+
+MX_EXPORT void
+mx_atomic_initialize( void )
+{
+	return;
+}
+
+/* The __atomic builtins only honor memory orders that are compile time
+ * constants.  A variable order is silently treated as __ATOMIC_SEQ_CST,
+ * so the following macros pick one of the constant orders instead.
+ */
+
+#define MXP_GCC_LOAD( ptr, order ) \
+	( ( (order) == MX_ATOMIC_RELAXED ) \
+		? __atomic_load_n( (ptr), __ATOMIC_RELAXED ) \
+	: ( ( (order) == MX_ATOMIC_ACQUIRE ) \
+	    || ( (order) == MX_ATOMIC_ACQ_REL ) ) \
+		? __atomic_load_n( (ptr), __ATOMIC_ACQUIRE ) \
+	: __atomic_load_n( (ptr), __ATOMIC_SEQ_CST ) )
+
+#define MXP_GCC_STORE( ptr, value, order ) \
+	do { \
+		if ( (order) == MX_ATOMIC_RELAXED ) { \
+			__atomic_store_n( (ptr), (value), __ATOMIC_RELAXED ); \
+		} else \
+		if ( ( (order) == MX_ATOMIC_RELEASE ) \
+		  || ( (order) == MX_ATOMIC_ACQ_REL ) ) \
+		{ \
+			__atomic_store_n( (ptr), (value), __ATOMIC_RELEASE ); \
+		} else { \
+			__atomic_store_n( (ptr), (value), __ATOMIC_SEQ_CST ); \
+		} \
+	} while (0)
+
+/* For __atomic_exchange_n() and __atomic_fetch_add(). */
+
+#define MXP_GCC_RMW( op, ptr, value, order ) \
+	( ( (order) == MX_ATOMIC_RELAXED ) \
+		? op( (ptr), (value), __ATOMIC_RELAXED ) \
+	: ( (order) == MX_ATOMIC_ACQUIRE ) \
+		? op( (ptr), (value), __ATOMIC_ACQUIRE ) \
+	: ( (order) == MX_ATOMIC_RELEASE ) \
+		? op( (ptr), (value), __ATOMIC_RELEASE ) \
+	: ( (order) == MX_ATOMIC_ACQ_REL ) \
+		? op( (ptr), (value), __ATOMIC_ACQ_REL ) \
+	: op( (ptr), (value), __ATOMIC_SEQ_CST ) )
+
+/* The order used when a compare and swap fails is a load order,
+ * so it may not be stronger than the success order and may not
+ * include release semantics.
+ */
+
+#define MXP_GCC_CAS( ptr, expected, desired, order ) \
+	( ( (order) == MX_ATOMIC_RELAXED ) \
+		? __atomic_compare_exchange_n( (ptr), (expected), (desired), \
+			0, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) \
+	: ( (order) == MX_ATOMIC_ACQUIRE ) \
+		? __atomic_compare_exchange_n( (ptr), (expected), (desired), \
+			0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE ) \
+	: ( (order) == MX_ATOMIC_RELEASE ) \
+		? __atomic_compare_exchange_n( (ptr), (expected), (desired), \
+			0, __ATOMIC_RELEASE, __ATOMIC_RELAXED ) \
+	: ( (order) == MX_ATOMIC_ACQ_REL ) \
+		? __atomic_compare_exchange_n( (ptr), (expected), (desired), \
+			0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) \
+	: __atomic_compare_exchange_n( (ptr), (expected), (desired), \
+			0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) )
+
+/*---*/
+
+MX_EXPORT int32_t
+mx_atomic_add32( int32_t *value_ptr, int32_t increment )
+{
+	return __atomic_add_fetch( value_ptr, increment, __ATOMIC_SEQ_CST );
+}
+
+MX_EXPORT int32_t
+mx_atomic_decrement32( int32_t *value_ptr )
+{
+	return __atomic_sub_fetch( value_ptr, 1, __ATOMIC_SEQ_CST );
+}
+
+MX_EXPORT int32_t
+mx_atomic_increment32( int32_t *value_ptr )
+{
+	return __atomic_add_fetch( value_ptr, 1, __ATOMIC_SEQ_CST );
+}
+
+MX_EXPORT int32_t
+mx_atomic_read32( int32_t *value_ptr )
+{
+	return __atomic_load_n( value_ptr, __ATOMIC_SEQ_CST );
+}
+
+MX_EXPORT void
+mx_atomic_write32( int32_t *value_ptr, int32_t new_value )
+{
+	__atomic_store_n( value_ptr, new_value, __ATOMIC_SEQ_CST );
+}
+
+MX_EXPORT void
+mx_atomic_memory_barrier( void )
+{
+	__atomic_thread_fence( __ATOMIC_SEQ_CST );
+}
+
+/*---*/
+
+MX_EXPORT int32_t
+mx_atomic_load32( int32_t *value_ptr, int memory_order )
+{
+	return MXP_GCC_LOAD( value_ptr, memory_order );
+}
+
+MX_EXPORT void
+mx_atomic_store32( int32_t *value_ptr, int32_t new_value, int memory_order )
+{
+	MXP_GCC_STORE( value_ptr, new_value, memory_order );
+}
+
+MX_EXPORT int32_t
+mx_atomic_exchange32( int32_t *value_ptr, int32_t new_value, int memory_order )
+{
+	return MXP_GCC_RMW( __atomic_exchange_n,
+				value_ptr, new_value, memory_order );
+}
+
+MX_EXPORT mx_bool_type
+mx_atomic_compare_and_swap32( int32_t *value_ptr,
+				int32_t *expected,
+				int32_t desired,
+				int memory_order )
+{
+	return MXP_GCC_CAS( value_ptr, expected, desired, memory_order );
+}
+
+MX_EXPORT int32_t
+mx_atomic_fetch_add32( int32_t *value_ptr, int32_t increment, int memory_order )
+{
+	return MXP_GCC_RMW( __atomic_fetch_add,
+				value_ptr, increment, memory_order );
+}
+
+/*---*/
+
+MX_EXPORT int64_t
+mx_atomic_load64( int64_t *value_ptr, int memory_order )
+{
+	return MXP_GCC_LOAD( value_ptr, memory_order );
+}
+
+MX_EXPORT void
+mx_atomic_store64( int64_t *value_ptr, int64_t new_value, int memory_order )
+{
+	MXP_GCC_STORE( value_ptr, new_value, memory_order );
+}
+
+MX_EXPORT int64_t
+mx_atomic_exchange64( int64_t *value_ptr, int64_t new_value, int memory_order )
+{
+	return MXP_GCC_RMW( __atomic_exchange_n,
+				value_ptr, new_value, memory_order );
+}
+
+MX_EXPORT mx_bool_type
+mx_atomic_compare_and_swap64( int64_t *value_ptr,
+				int64_t *expected,
+				int64_t desired,
+				int memory_order )
+{
+	return MXP_GCC_CAS( value_ptr, expected, desired, memory_order );
+}
+
+MX_EXPORT int64_t
+mx_atomic_fetch_add64( int64_t *value_ptr, int64_t increment, int memory_order )
+{
+	return MXP_GCC_RMW( __atomic_fetch_add,
+				value_ptr, increment, memory_order );
+}
+
+/*---*/
+
+MX_EXPORT void *
+mx_atomic_load_pointer( void **pointer_ptr, int memory_order )
+{
+	return MXP_GCC_LOAD( pointer_ptr, memory_order );
+}
+
+MX_EXPORT void
+mx_atomic_store_pointer( void **pointer_ptr, void *new_pointer,
+					int memory_order )
+{
+	MXP_GCC_STORE( pointer_ptr, new_pointer, memory_order );
+}
+
+MX_EXPORT void *
+mx_atomic_exchange_pointer( void **pointer_ptr, void *new_pointer,
+					int memory_order )
+{
+	return MXP_GCC_RMW( __atomic_exchange_n,
+				pointer_ptr, new_pointer, memory_order );
+}
+
+MX_EXPORT mx_bool_type
+mx_atomic_compare_and_swap_pointer( void **pointer_ptr,
+				void **expected,
+				void *desired,
+				int memory_order )
+{
+	return MXP_GCC_CAS( pointer_ptr, expected, desired, memory_order );
+}
+
+MX_EXPORT void
+mx_atomic_thread_fence( int memory_order )
+{
+	switch( memory_order ) {
+	case MX_ATOMIC_RELAXED:
+		break;
+	case MX_ATOMIC_ACQUIRE:
+		__atomic_thread_fence( __ATOMIC_ACQUIRE );
+		break;
+	case MX_ATOMIC_RELEASE:
+		__atomic_thread_fence( __ATOMIC_RELEASE );
+		break;
+	case MX_ATOMIC_ACQ_REL:
+		__atomic_thread_fence( __ATOMIC_ACQ_REL );
+		break;
+	default:
+		__atomic_thread_fence( __ATOMIC_SEQ_CST );
+		break;
+	}
+}
+
+/*------------------------------------------------------------------------*/
+
 #elif defined( MX_CLANG_VERSION) || \
       ( defined(__GNUC__) && (MX_GNUC_VERSION >= 4001000L) && \
 	( defined(__i486__) || defined(__i586__) || \
 	  defined(__i686__) || defined(__MMX__) ) )
 
-/* For GCC 4.1 and above.
+/* For GCC 4.1 through 4.6.
  *
  * On x86, the atomic builtins are not available if we use march=i386.
  */
 
 #define MXP_NEED_GENERIC_WRITE32	TRUE
+#define MXP_NEED_GENERIC_ATOMICS	TRUE
 
-static MX_MUTEX *mxp_atomic_write32_mutex = NULL;
+static MX_MUTEX *mxp_atomic_mutex = NULL;
 
 MX_EXPORT void
 mx_atomic_initialize( void )
 {
-	(void) mx_mutex_create( &mxp_atomic_write32_mutex );
+	(void) mx_mutex_create( &mxp_atomic_mutex );
 }
 
 /*---*/
@@ -765,6 +1413,7 @@ mx_atomic_memory_barrier( void )
 	|| defined(OS_VMS) || defined(OS_UNIXWARE)
 
 #define MXP_NEED_GENERIC_WRITE32	FALSE
+#define MXP_NEED_GENERIC_ATOMICS	TRUE
 
 static MX_MUTEX *mxp_atomic_mutex = NULL;
 
@@ -878,14 +1527,329 @@ mx_atomic_memory_barrier( void )
 MX_EXPORT void
 mx_atomic_write32( int32_t *value_ptr, int32_t new_value )
 {
-	mx_mutex_lock( mxp_atomic_write32_mutex );
+	mx_mutex_lock( mxp_atomic_mutex );
 
 	*value_ptr = new_value;
 
-	mx_mutex_unlock( mxp_atomic_write32_mutex );
+	mx_mutex_unlock( mxp_atomic_mutex );
 
 	return;
 }
 
 #endif /* MXP_NEED_GENERIC_WRITE32 */
 
+/*------------------------------------------------------------------------*/
+
+/* The following are lock-based versions of the operations that take an
+ * explicit memory order, for platforms that do not have intrinsic versions
+ * of them.  Since every operation goes through the same mutex, they are
+ * sequentially consistent whatever order is requested.
+ *
+ * The mutex is created exactly once by mx_atomic_initialize(), which is
+ * called by mx_initialize_runtime() before the program creates any other
+ * threads.  Creating it here on first use instead would race when two
+ * threads get here at the same time, so a missing mutex is treated as
+ * a fatal error.
+ */
+
+#if MXP_NEED_GENERIC_ATOMICS
+
+static void
+mxp_atomic_lock( void )
+{
+	if ( mxp_atomic_mutex == (MX_MUTEX *) NULL ) {
+		(void) mx_error( MXE_INITIALIZATION_ERROR, "mxp_atomic_lock()",
+		"The mutex used for emulating atomic operations does not "
+		"exist.  Either mx_initialize_runtime() was not called "
+		"before the first atomic operation or the mutex could "
+		"not be created.  This is fatal." );
+
+		mx_force_core_dump();
+
+		exit(1);	/* Should not get here. */
+	}
+
+	mx_mutex_lock( mxp_atomic_mutex );
+}
+
+static void
+mxp_atomic_unlock( void )
+{
+	mx_mutex_unlock( mxp_atomic_mutex );
+}
+
+/*---*/
+
+MX_EXPORT int32_t
+mx_atomic_load32( int32_t *value_ptr, int memory_order )
+{
+	int32_t result;
+
+	mxp_atomic_lock();
+
+	result = *value_ptr;
+
+	mxp_atomic_unlock();
+
+	return result;
+}
+
+MX_EXPORT void
+mx_atomic_store32( int32_t *value_ptr, int32_t new_value, int memory_order )
+{
+	mxp_atomic_lock();
+
+	*value_ptr = new_value;
+
+	mxp_atomic_unlock();
+}
+
+MX_EXPORT int32_t
+mx_atomic_exchange32( int32_t *value_ptr, int32_t new_value, int memory_order )
+{
+	int32_t old_value;
+
+	mxp_atomic_lock();
+
+	old_value = *value_ptr;
+	*value_ptr = new_value;
+
+	mxp_atomic_unlock();
+
+	return old_value;
+}
+
+MX_EXPORT mx_bool_type
+mx_atomic_compare_and_swap32( int32_t *value_ptr,
+				int32_t *expected,
+				int32_t desired,
+				int memory_order )
+{
+	mx_bool_type swapped;
+
+	mxp_atomic_lock();
+
+	if ( *value_ptr == *expected ) {
+		*value_ptr = desired;
+		swapped = TRUE;
+	} else {
+		*expected = *value_ptr;
+		swapped = FALSE;
+	}
+
+	mxp_atomic_unlock();
+
+	return swapped;
+}
+
+MX_EXPORT int32_t
+mx_atomic_fetch_add32( int32_t *value_ptr, int32_t increment, int memory_order )
+{
+	int32_t old_value;
+
+	mxp_atomic_lock();
+
+	old_value = *value_ptr;
+	*value_ptr = old_value + increment;
+
+	mxp_atomic_unlock();
+
+	return old_value;
+}
+
+/*---*/
+
+MX_EXPORT int64_t
+mx_atomic_load64( int64_t *value_ptr, int memory_order )
+{
+	int64_t result;
+
+	mxp_atomic_lock();
+
+	result = *value_ptr;
+
+	mxp_atomic_unlock();
+
+	return result;
+}
+
+MX_EXPORT void
+mx_atomic_store64( int64_t *value_ptr, int64_t new_value, int memory_order )
+{
+	mxp_atomic_lock();
+
+	*value_ptr = new_value;
+
+	mxp_atomic_unlock();
+}
+
+MX_EXPORT int64_t
+mx_atomic_exchange64( int64_t *value_ptr, int64_t new_value, int memory_order )
+{
+	int64_t old_value;
+
+	mxp_atomic_lock();
+
+	old_value = *value_ptr;
+	*value_ptr = new_value;
+
+	mxp_atomic_unlock();
+
+	return old_value;
+}
+
+MX_EXPORT mx_bool_type
+mx_atomic_compare_and_swap64( int64_t *value_ptr,
+				int64_t *expected,
+				int64_t desired,
+				int memory_order )
+{
+	mx_bool_type swapped;
+
+	mxp_atomic_lock();
+
+	if ( *value_ptr == *expected ) {
+		*value_ptr = desired;
+		swapped = TRUE;
+	} else {
+		*expected = *value_ptr;
+		swapped = FALSE;
+	}
+
+	mxp_atomic_unlock();
+
+	return swapped;
+}
+
+MX_EXPORT int64_t
+mx_atomic_fetch_add64( int64_t *value_ptr, int64_t increment, int memory_order )
+{
+	int64_t old_value;
+
+	mxp_atomic_lock();
+
+	old_value = *value_ptr;
+	*value_ptr = old_value + increment;
+
+	mxp_atomic_unlock();
+
+	return old_value;
+}
+
+/*---*/
+
+MX_EXPORT void *
+mx_atomic_load_pointer( void **pointer_ptr, int memory_order )
+{
+	void *result;
+
+	mxp_atomic_lock();
+
+	result = *pointer_ptr;
+
+	mxp_atomic_unlock();
+
+	return result;
+}
+
+MX_EXPORT void
+mx_atomic_store_pointer( void **pointer_ptr, void *new_pointer,
+					int memory_order )
+{
+	mxp_atomic_lock();
+
+	*pointer_ptr = new_pointer;
+
+	mxp_atomic_unlock();
+}
+
+MX_EXPORT void *
+mx_atomic_exchange_pointer( void **pointer_ptr, void *new_pointer,
+					int memory_order )
+{
+	void *old_pointer;
+
+	mxp_atomic_lock();
+
+	old_pointer = *pointer_ptr;
+	*pointer_ptr = new_pointer;
+
+	mxp_atomic_unlock();
+
+	return old_pointer;
+}
+
+MX_EXPORT mx_bool_type
+mx_atomic_compare_and_swap_pointer( void **pointer_ptr,
+				void **expected,
+				void *desired,
+				int memory_order )
+{
+	mx_bool_type swapped;
+
+	mxp_atomic_lock();
+
+	if ( *pointer_ptr == *expected ) {
+		*pointer_ptr = desired;
+		swapped = TRUE;
+	} else {
+		*expected = *pointer_ptr;
+		swapped = FALSE;
+	}
+
+	mxp_atomic_unlock();
+
+	return swapped;
+}
+
+MX_EXPORT void
+mx_atomic_thread_fence( int memory_order )
+{
+	if ( memory_order != MX_ATOMIC_RELAXED ) {
+		mx_atomic_memory_barrier();
+	}
+}
+
+#endif /* MXP_NEED_GENERIC_ATOMICS */
+
+/*------------------------------------------------------------------------*/
+
+/* The 64-bit counterparts of mx_atomic_add32() and friends are the same
+ * on all platforms.
+ */
+
+MX_EXPORT int64_t
+mx_atomic_add64( int64_t *value_ptr, int64_t increment )
+{
+	int64_t old_value;
+
+	old_value = mx_atomic_fetch_add64( value_ptr, increment,
+						MX_ATOMIC_SEQ_CST );
+
+	return old_value + increment;
+}
+
+MX_EXPORT int64_t
+mx_atomic_decrement64( int64_t *value_ptr )
+{
+	return mx_atomic_add64( value_ptr, -1 );
+}
+
+MX_EXPORT int64_t
+mx_atomic_increment64( int64_t *value_ptr )
+{
+	return mx_atomic_add64( value_ptr, 1 );
+}
+
+MX_EXPORT int64_t
+mx_atomic_read64( int64_t *value_ptr )
+{
+	return mx_atomic_load64( value_ptr, MX_ATOMIC_SEQ_CST );
+}
+
+MX_EXPORT void
+mx_atomic_write64( int64_t *value_ptr, int64_t new_value )
+{
+	mx_atomic_store64( value_ptr, new_value, MX_ATOMIC_SEQ_CST );
+}
+
@@ -7,7 +7,7 @@
  *
  *-------------------------------------------------------------------------
  *
- * Copyright 2009, 2018 Illinois Institute of Technology
+ * Copyright 2009, 2018, 2026 Illinois Institute of Technology
  *
  * See the file "LICENSE" for information on usage and redistribution
  * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
@@ -41,6 +41,100 @@ MX_API void mx_atomic_write32( int32_t *, int32_t );
 
 MX_API void mx_atomic_memory_barrier( void );
 
+/*---*/
+
+/* The following functions take an explicit memory order argument.  The
+ * orders have the same meaning as the corresponding C11 memory_order values.
+ * An order that is not valid for a given operation, such as MX_ATOMIC_ACQUIRE
+ * for a store, is replaced by a stronger order that is.
+ */
+
+#define MX_ATOMIC_RELAXED	0
+#define MX_ATOMIC_ACQUIRE	1
+#define MX_ATOMIC_RELEASE	2
+#define MX_ATOMIC_ACQ_REL	3
+#define MX_ATOMIC_SEQ_CST	4
+
+/* The compare and swap functions store 'desired' in '*value_ptr' if it
+ * currently contains '*expected' and then return TRUE.  Otherwise, they
+ * copy the current contents of '*value_ptr' to '*expected' and return FALSE.
+ *
+ * The exchange and fetch_add functions return the value that was in
+ * '*value_ptr' before the operation.
+ *
+ * 64-bit values must be aligned on an 8 byte boundary, even on 32-bit
+ * platforms where the compiler does not do this by default.
+ *
+ * On platforms without native support for them, these functions are
+ * emulated with a mutex.  There, the 32-bit read-modify-write functions
+ * below are only atomic with respect to each other and not with respect
+ * to mx_atomic_add32() and friends.
+ */
+
+MX_API int32_t mx_atomic_load32( int32_t *value_ptr, int memory_order );
+
+MX_API void mx_atomic_store32( int32_t *value_ptr, int32_t new_value,
+						int memory_order );
+
+MX_API int32_t mx_atomic_exchange32( int32_t *value_ptr, int32_t new_value,
+						int memory_order );
+
+MX_API mx_bool_type mx_atomic_compare_and_swap32( int32_t *value_ptr,
+						int32_t *expected,
+						int32_t desired,
+						int memory_order );
+
+MX_API int32_t mx_atomic_fetch_add32( int32_t *value_ptr, int32_t increment,
+						int memory_order );
+
+/*---*/
+
+MX_API int64_t mx_atomic_add64( int64_t *, int64_t );
+
+MX_API int64_t mx_atomic_decrement64( int64_t * );
+
+MX_API int64_t mx_atomic_increment64( int64_t * );
+
+MX_API int64_t mx_atomic_read64( int64_t * );
+
+MX_API void mx_atomic_write64( int64_t *, int64_t );
+
+MX_API int64_t mx_atomic_load64( int64_t *value_ptr, int memory_order );
+
+MX_API void mx_atomic_store64( int64_t *value_ptr, int64_t new_value,
+						int memory_order );
+
+MX_API int64_t mx_atomic_exchange64( int64_t *value_ptr, int64_t new_value,
+						int memory_order );
+
+MX_API mx_bool_type mx_atomic_compare_and_swap64( int64_t *value_ptr,
+						int64_t *expected,
+						int64_t desired,
+						int memory_order );
+
+MX_API int64_t mx_atomic_fetch_add64( int64_t *value_ptr, int64_t increment,
+						int memory_order );
+
+/*---*/
+
+MX_API void *mx_atomic_load_pointer( void **pointer_ptr, int memory_order );
+
+MX_API void mx_atomic_store_pointer( void **pointer_ptr, void *new_pointer,
+						int memory_order );
+
+MX_API void *mx_atomic_exchange_pointer( void **pointer_ptr,
+						void *new_pointer,
+						int memory_order );
+
+MX_API mx_bool_type mx_atomic_compare_and_swap_pointer( void **pointer_ptr,
+						void **expected,
+						void *desired,
+						int memory_order );
+
+/*---*/
+
+MX_API void mx_atomic_thread_fence( int memory_order );
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,6 +16,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "mx_util.h"
 
@@ -84,6 +85,479 @@
 
 /*------------------------------------------------------------------------*/
 
+/* Callback messages are sent by virtual timer handlers, which may run in
+ * a signal handler, and by driver threads.  Where GCC atomic builtins and
+ * eventfd() are available, the callback queue is a bounded lock-free ring
+ * of message pointers with multiple senders and a single receiver, based
+ * on Dmitry Vyukov's bounded queue.  A sender claims a slot with a
+ * compare-and-swap and then publishes the message in it, so sending does
+ * not need a system call.  The receiver is woken up by an eventfd, which
+ * is only written by the first sender after the receiver last started
+ * to empty the queue.
+ *
+ * Elsewhere, the message pointers are written to a non-blocking MX pipe.
+ */
+
+#if defined(OS_LINUX) && defined(__GNUC__) && defined(__ATOMIC_ACQUIRE) \
+	&& defined(MX_GLIBC_VERSION) && ( MX_GLIBC_VERSION >= 2008000L )
+#  define MXP_LOCK_FREE_CALLBACK_QUEUE	TRUE
+#else
+#  define MXP_LOCK_FREE_CALLBACK_QUEUE	FALSE
+#endif
+
+/* The largest number of messages handled by one call
+ * to mx_process_callbacks().
+ */
+
+#define MXP_CALLBACK_BATCH_SIZE		256
+
+#if MXP_LOCK_FREE_CALLBACK_QUEUE
+
+#include <errno.h>
+#include <sys/eventfd.h>
+
+/* MXP_CALLBACK_QUEUE_SIZE must be a power of 2. */
+
+#define MXP_CALLBACK_QUEUE_SIZE		8192
+
+typedef struct {
+	unsigned long sequence;
+	MX_CALLBACK_MESSAGE *message;
+} MXP_CALLBACK_QUEUE_SLOT;
+
+struct mx_callback_queue_type {
+	MXP_CALLBACK_QUEUE_SLOT slot_array[MXP_CALLBACK_QUEUE_SIZE];
+
+	/* The send and receive positions are kept in different cache lines,
+	 * so that senders and the receiver do not fight over them.
+	 */
+
+	char send_padding[64];
+	unsigned long send_position;
+	int wakeup_pending;
+
+	char receive_padding[64];
+	unsigned long receive_position;
+	int event_fd;
+
+	unsigned long num_dropped_messages;
+};
+
+static void
+mxp_callback_queue_wakeup( MX_CALLBACK_QUEUE *queue )
+{
+	uint64_t one = 1;
+	int saved_errno;
+
+	if ( __atomic_exchange_n( &(queue->wakeup_pending), 1,
+					__ATOMIC_ACQ_REL ) != 0 )
+	{
+		/* The receiver has already been woken up and has not yet
+		 * started to empty the queue, so it will see our message.
+		 */
+
+		return;
+	}
+
+	/* We may be running in a signal handler, so errno must be
+	 * left the way that we found it.
+	 */
+
+	saved_errno = errno;
+
+	while ( write( queue->event_fd, &one, sizeof(one) ) < 0 ) {
+		if ( errno != EINTR )
+			break;
+	}
+
+	errno = saved_errno;
+}
+
+/* The receiver calls mxp_callback_queue_acknowledge() before it starts
+ * to empty the queue.  The eventfd is reset before 'wakeup_pending' is
+ * cleared, so a sender that finds 'wakeup_pending' clear always writes
+ * to the eventfd after the reset and the wakeup is not lost.
+ */
+
+static void
+mxp_callback_queue_acknowledge( MX_CALLBACK_QUEUE *queue )
+{
+	uint64_t count;
+
+	while ( read( queue->event_fd, &count, sizeof(count) ) < 0 ) {
+		if ( errno != EINTR )
+			break;
+	}
+
+	(void) __atomic_exchange_n( &(queue->wakeup_pending), 0,
+					__ATOMIC_ACQ_REL );
+}
+
+static mx_bool_type
+mxp_callback_queue_receive( MX_CALLBACK_QUEUE *queue,
+				MX_CALLBACK_MESSAGE **callback_message )
+{
+	MXP_CALLBACK_QUEUE_SLOT *slot;
+	unsigned long position, sequence;
+
+	position = queue->receive_position;
+
+	slot = &(queue->slot_array[ position & (MXP_CALLBACK_QUEUE_SIZE - 1) ]);
+
+	sequence = __atomic_load_n( &(slot->sequence), __ATOMIC_ACQUIRE );
+
+	if ( sequence != ( position + 1 ) ) {
+		/* The slot is empty or a sender has claimed it
+		 * but has not yet published its message.
+		 */
+
+		return FALSE;
+	}
+
+	*callback_message = slot->message;
+
+	/* Give the slot back to the senders for the next time around. */
+
+	__atomic_store_n( &(slot->sequence),
+			position + MXP_CALLBACK_QUEUE_SIZE, __ATOMIC_RELEASE );
+
+	queue->receive_position = position + 1;
+
+	return TRUE;
+}
+
+MX_EXPORT mx_status_type
+mx_callback_queue_create( MX_CALLBACK_QUEUE **queue )
+{
+	static const char fname[] = "mx_callback_queue_create()";
+
+	MX_CALLBACK_QUEUE *new_queue;
+	unsigned long i;
+	int saved_errno;
+
+	if ( queue == (MX_CALLBACK_QUEUE **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_CALLBACK_QUEUE pointer passed was NULL." );
+	}
+
+	new_queue = (MX_CALLBACK_QUEUE *) calloc( 1, sizeof(MX_CALLBACK_QUEUE) );
+
+	if ( new_queue == (MX_CALLBACK_QUEUE *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an MX_CALLBACK_QUEUE." );
+	}
+
+	for ( i = 0; i < MXP_CALLBACK_QUEUE_SIZE; i++ ) {
+		new_queue->slot_array[i].sequence = i;
+	}
+
+	new_queue->event_fd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+
+	if ( new_queue->event_fd < 0 ) {
+		saved_errno = errno;
+
+		mx_free( new_queue );
+
+		return mx_error( MXE_OPERATING_SYSTEM_ERROR, fname,
+		"The attempt to create an eventfd for the callback queue "
+		"failed.  Errno = %d, error message = '%s'",
+			saved_errno, strerror(saved_errno) );
+	}
+
+	*queue = new_queue;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT void
+mx_callback_queue_destroy( MX_CALLBACK_QUEUE *queue )
+{
+	if ( queue == (MX_CALLBACK_QUEUE *) NULL )
+		return;
+
+	(void) close( queue->event_fd );
+
+	mx_free( queue );
+}
+
+MX_EXPORT mx_bool_type
+mx_callback_queue_send( MX_CALLBACK_QUEUE *queue,
+			MX_CALLBACK_MESSAGE *callback_message )
+{
+	MXP_CALLBACK_QUEUE_SLOT *slot;
+	unsigned long position, sequence;
+	long difference;
+
+	if ( queue == (MX_CALLBACK_QUEUE *) NULL )
+		return FALSE;
+
+	position = __atomic_load_n( &(queue->send_position), __ATOMIC_RELAXED );
+
+	for (;;) {
+		slot = &(queue->slot_array[
+				position & (MXP_CALLBACK_QUEUE_SIZE - 1) ]);
+
+		sequence = __atomic_load_n( &(slot->sequence),
+						__ATOMIC_ACQUIRE );
+
+		difference = (long) ( sequence - position );
+
+		if ( difference == 0 ) {
+			/* The slot is free, so try to claim it. */
+
+			if ( __atomic_compare_exchange_n(
+					&(queue->send_position),
+					&position, position + 1, TRUE,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+			{
+				break;
+			}
+		} else
+		if ( difference < 0 ) {
+			/* The receiver has not yet emptied this slot
+			 * from the last time around, so the queue is full.
+			 */
+
+			(void) __atomic_add_fetch(
+					&(queue->num_dropped_messages),
+					1, __ATOMIC_RELAXED );
+
+			return FALSE;
+		} else {
+			/* Another sender got the slot first. */
+
+			position = __atomic_load_n( &(queue->send_position),
+							__ATOMIC_RELAXED );
+		}
+	}
+
+	slot->message = callback_message;
+
+	__atomic_store_n( &(slot->sequence), position + 1, __ATOMIC_RELEASE );
+
+	mxp_callback_queue_wakeup( queue );
+
+	return TRUE;
+}
+
+MX_EXPORT mx_bool_type
+mx_callback_queue_is_empty( MX_CALLBACK_QUEUE *queue )
+{
+	MXP_CALLBACK_QUEUE_SLOT *slot;
+	unsigned long position;
+
+	if ( queue == (MX_CALLBACK_QUEUE *) NULL )
+		return TRUE;
+
+	position = queue->receive_position;
+
+	slot = &(queue->slot_array[ position & (MXP_CALLBACK_QUEUE_SIZE - 1) ]);
+
+	if ( __atomic_load_n( &(slot->sequence), __ATOMIC_ACQUIRE )
+						== ( position + 1 ) )
+	{
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+MX_EXPORT mx_status_type
+mx_callback_queue_get_fd( MX_CALLBACK_QUEUE *queue, int *fd )
+{
+	static const char fname[] = "mx_callback_queue_get_fd()";
+
+	if ( ( queue == (MX_CALLBACK_QUEUE *) NULL ) || ( fd == (int *) NULL ) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the arguments passed was NULL." );
+	}
+
+	*fd = queue->event_fd;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+#else /* not MXP_LOCK_FREE_CALLBACK_QUEUE */
+
+struct mx_callback_queue_type {
+	MX_PIPE *pipe;
+};
+
+static void
+mxp_callback_queue_wakeup( MX_CALLBACK_QUEUE *queue )
+{
+	/* The pipe stays readable while anything is left in it. */
+
+	return;
+}
+
+static void
+mxp_callback_queue_acknowledge( MX_CALLBACK_QUEUE *queue )
+{
+	return;
+}
+
+static mx_bool_type
+mxp_callback_queue_receive( MX_CALLBACK_QUEUE *queue,
+				MX_CALLBACK_MESSAGE **callback_message )
+{
+	size_t num_bytes_available, bytes_read;
+	mx_status_type mx_status;
+
+	mx_status = mx_pipe_num_bytes_available( queue->pipe,
+						&num_bytes_available );
+
+	if ( ( mx_status.code != MXE_SUCCESS )
+	  || ( num_bytes_available < sizeof(MX_CALLBACK_MESSAGE *) ) )
+	{
+		return FALSE;
+	}
+
+	mx_status = mx_pipe_read( queue->pipe,
+				(char *) callback_message,
+				sizeof(MX_CALLBACK_MESSAGE *),
+				&bytes_read );
+
+	if ( ( mx_status.code != MXE_SUCCESS )
+	  || ( bytes_read != sizeof(MX_CALLBACK_MESSAGE *) ) )
+	{
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+MX_EXPORT mx_status_type
+mx_callback_queue_create( MX_CALLBACK_QUEUE **queue )
+{
+	static const char fname[] = "mx_callback_queue_create()";
+
+	MX_CALLBACK_QUEUE *new_queue;
+	mx_status_type mx_status;
+
+	if ( queue == (MX_CALLBACK_QUEUE **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_CALLBACK_QUEUE pointer passed was NULL." );
+	}
+
+	new_queue = (MX_CALLBACK_QUEUE *) calloc( 1, sizeof(MX_CALLBACK_QUEUE) );
+
+	if ( new_queue == (MX_CALLBACK_QUEUE *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an MX_CALLBACK_QUEUE." );
+	}
+
+	mx_status = mx_pipe_open( &(new_queue->pipe) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_free( new_queue );
+		return mx_status;
+	}
+
+	mx_status = mx_pipe_set_blocking_mode( new_queue->pipe,
+					MXF_PIPE_READ | MXF_PIPE_WRITE, FALSE );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		(void) mx_pipe_close( new_queue->pipe,
+					MXF_PIPE_READ | MXF_PIPE_WRITE );
+		mx_free( new_queue );
+		return mx_status;
+	}
+
+	*queue = new_queue;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT void
+mx_callback_queue_destroy( MX_CALLBACK_QUEUE *queue )
+{
+	if ( queue == (MX_CALLBACK_QUEUE *) NULL )
+		return;
+
+	(void) mx_pipe_close( queue->pipe, MXF_PIPE_READ | MXF_PIPE_WRITE );
+
+	mx_free( queue );
+}
+
+/* Please note that the only system calls used by normal execution
+ * of mx_pipe_write() are the write() call on Linux/Unix and
+ * WriteFile() on Win32.  Thus, mx_pipe_write() should be safe
+ * to invoke from a signal handler.
+ */
+
+MX_EXPORT mx_bool_type
+mx_callback_queue_send( MX_CALLBACK_QUEUE *queue,
+			MX_CALLBACK_MESSAGE *callback_message )
+{
+	mx_status_type mx_status;
+
+	if ( queue == (MX_CALLBACK_QUEUE *) NULL )
+		return FALSE;
+
+	mx_status = mx_pipe_write( queue->pipe,
+				(char *) &callback_message,
+				sizeof(MX_CALLBACK_MESSAGE *) );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return FALSE;
+
+	return TRUE;
+}
+
+MX_EXPORT mx_bool_type
+mx_callback_queue_is_empty( MX_CALLBACK_QUEUE *queue )
+{
+	size_t num_bytes_available;
+	mx_status_type mx_status;
+
+	if ( queue == (MX_CALLBACK_QUEUE *) NULL )
+		return TRUE;
+
+	mx_status = mx_pipe_num_bytes_available( queue->pipe,
+						&num_bytes_available );
+
+	if ( ( mx_status.code != MXE_SUCCESS ) || ( num_bytes_available == 0 ) )
+		return TRUE;
+
+	return FALSE;
+}
+
+MX_EXPORT mx_status_type
+mx_callback_queue_get_fd( MX_CALLBACK_QUEUE *queue, int *fd )
+{
+	static const char fname[] = "mx_callback_queue_get_fd()";
+
+	if ( queue == (MX_CALLBACK_QUEUE *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_CALLBACK_QUEUE pointer passed was NULL." );
+	}
+
+	return mx_pipe_get_read_fd( queue->pipe, fd );
+}
+
+#endif /* not MXP_LOCK_FREE_CALLBACK_QUEUE */
+
+MX_EXPORT mx_bool_type
+mx_send_callback_message( MX_CALLBACK_MESSAGE *callback_message )
+{
+	MX_LIST_HEAD *list_head;
+
+	if ( callback_message == (MX_CALLBACK_MESSAGE *) NULL )
+		return FALSE;
+
+	list_head = callback_message->list_head;
+
+	if ( list_head == (MX_LIST_HEAD *) NULL )
+		return FALSE;
+
+	return mx_callback_queue_send( list_head->callback_queue,
+					callback_message );
+}
+
+/*------------------------------------------------------------------------*/
+
 #if MX_CALLBACK_DEBUG_WITHOUT_TIMER
 
 /* WARNING: Compiling with MX_CALLBACK_DEBUG_WITHOUT_TIMER is only meant
@@ -106,7 +580,7 @@ void mxp_poll_callback( int );
 void mxp_stop_master_timer( MX_INTERVAL_TIMER * );
 
 static MX_CALLBACK_MESSAGE *mxp_poll_callback_message = NULL;
-static MX_PIPE *mxp_callback_pipe = NULL;
+static MX_CALLBACK_QUEUE *mxp_callback_queue = NULL;
 static MX_LIST_HEAD *mxp_list_head = NULL;
 
 MX_EXPORT mx_status_type
@@ -166,7 +640,7 @@ mx_initialize_callback_support( MX_RECORD *record )
 
 	/* Initialize data structures for the manual poll callback. */
 
-	mxp_callback_pipe = list_head->callback_pipe;
+	mxp_callback_queue = list_head->callback_queue;
 
 	mxp_poll_callback_message = malloc( sizeof(MX_CALLBACK_MESSAGE) );
 
@@ -203,9 +677,8 @@ mx_initialize_callback_support( MX_RECORD *record )
 void
 mxp_poll_callback( int signal_number )
 {
-	(void) mx_pipe_write( mxp_callback_pipe,
-				(char *) &mxp_poll_callback_message,
-				sizeof(MX_CALLBACK_MESSAGE *) );
+	(void) mx_callback_queue_send( mxp_callback_queue,
+					mxp_poll_callback_message );
 	return;
 }
 
@@ -226,14 +699,14 @@ mxp_stop_master_timer( MX_INTERVAL_TIMER *itimer )
 /*** This is the normal callback setup that uses virtual timers. ***/
 
 /* NOTE: The only job of mx_request_value_changed_poll() is to send a message
- *       through the callback pipe to the main thread to ask for the value
+ *       through the callback queue to the main thread to ask for the value
  *       changed handlers to be polled.
  *
  *       On some platforms, this function will be invoked in a signal handler
  *       context, so the function must only do things that are signal handler
  *       safe.  In particular, you cannot allocate memory with malloc()
- *       here or write a pointer for a structure on this function's stack
- *       to the pipe.
+ *       here or send a pointer for a structure on this function's stack
+ *       to the queue.
  *
  *       The solution, in this case, is to malloc() the necessary data
  *       structure in advance in the mx_initialize_callback_support()
@@ -248,7 +721,7 @@ mx_request_value_changed_poll( MX_VIRTUAL_TIMER *callback_timer,
 
 	MX_CALLBACK_MESSAGE *poll_callback_message;
 	MX_LIST_HEAD *list_head;
-	MX_PIPE *mx_pipe;
+	MX_CALLBACK_QUEUE *callback_queue;
 
 #if MX_CALLBACK_DEBUG_REQUEST_VALUE_CHANGED_POLL
 	MX_CLOCK_TICK current_clock_tick;
@@ -272,24 +745,19 @@ mx_request_value_changed_poll( MX_VIRTUAL_TIMER *callback_timer,
 
 	list_head = poll_callback_message->list_head;
 
-	mx_pipe = list_head->callback_pipe;
+	callback_queue = list_head->callback_queue;
 
-	if ( mx_pipe == NULL ) {
+	if ( callback_queue == NULL ) {
 #if MX_CALLBACK_DEBUG_REQUEST_VALUE_CHANGED_POLL
 		MX_DEBUG(-2,
-		("%s: callback_pipe == NULL.  Returning...", fname));
+		("%s: callback_queue == NULL.  Returning...", fname));
 #endif
 		return;
 	}
 
-	/* Write the address of the callback message to the callback pipe.
-	 * The callback message will be read and handled by the server
-	 * main loop.
-	 *
-	 * Please note that the only system calls used by normal execution
-	 * of mx_pipe_write() are the write() call on Linux/Unix and
-	 * WriteFile() on Win32.  Thus, mx_pipe_write() should be safe
-	 * to invoke from a signal handler.
+	/* Send the address of the callback message to the callback queue.
+	 * The callback message will be handled by the server main loop.
+	 * mx_callback_queue_send() is safe to invoke from a signal handler.
 	 */
 
 #if MX_CALLBACK_DEBUG
@@ -297,9 +765,7 @@ mx_request_value_changed_poll( MX_VIRTUAL_TIMER *callback_timer,
 		fname, poll_callback_message));
 #endif
 
-	(void) mx_pipe_write( mx_pipe,
-				(char *) &poll_callback_message,
-				sizeof(MX_CALLBACK_MESSAGE *) );
+	(void) mx_callback_queue_send( callback_queue, poll_callback_message );
 
 	return;
 }
@@ -430,7 +896,7 @@ mx_initialize_callback_support( MX_RECORD *record )
 		MX_CALLBACK_MESSAGE *poll_callback_message;
 
 		/* The callback timer will need a structure pointer
-		 * to write to the callback pipe telling the main
+		 * to write to the callback queue telling the main
 		 * thread that it is time to poll the value changed
 		 * handlers.  We must malloc() that structure here,
 		 * since it is unsafe to do it in the context of the
@@ -455,8 +921,8 @@ mx_initialize_callback_support( MX_RECORD *record )
 		 * callback function is expected to restart the timer
 		 * at the beginning of that function.  This ensures
 		 * that there is, at most, one poll callback message
-		 * in the callback pipe at any given time and prevents
-		 * the callback pipe from filling up with a multitude
+		 * in the callback queue at any given time and prevents
+		 * the callback queue from filling up with a multitude
 		 * of poll callbacks if the callback function is slow.
 		 */
 
@@ -505,12 +971,13 @@ mx_initialize_callback_support( MX_RECORD *record )
 /*------------------------------------------------------------------------*/
 
 MX_EXPORT mx_status_type
-mx_setup_callback_pipe( MX_RECORD *record_list, MX_PIPE **callback_pipe )
+mx_setup_callback_queue( MX_RECORD *record_list,
+			MX_CALLBACK_QUEUE **callback_queue )
 {
-	static const char fname[] = "mx_setup_callback_pipe()";
+	static const char fname[] = "mx_setup_callback_queue()";
 
 	MX_LIST_HEAD *list_head;
-	MX_PIPE *callback_pipe_ptr;
+	MX_CALLBACK_QUEUE *callback_queue_ptr;
 	MX_INTERVAL_TIMER *master_timer;
 	mx_status_type mx_status;
 
@@ -527,18 +994,12 @@ mx_setup_callback_pipe( MX_RECORD *record_list, MX_PIPE **callback_pipe )
 			record_list );
 	}
 
-	mx_status = mx_pipe_open( &callback_pipe_ptr );
+	mx_status = mx_callback_queue_create( &callback_queue_ptr );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-	list_head->callback_pipe = callback_pipe_ptr;
-
-	mx_status = mx_pipe_set_blocking_mode( list_head->callback_pipe,
-					MXF_PIPE_READ | MXF_PIPE_WRITE, FALSE );
-
-	if ( mx_status.code != MXE_SUCCESS )
-		return mx_status;
+	list_head->callback_queue = callback_queue_ptr;
 
 	/* If necessary, create a master timer with a timer period
 	 * of 100 milliseconds.
@@ -554,8 +1015,8 @@ mx_setup_callback_pipe( MX_RECORD *record_list, MX_PIPE **callback_pipe )
 		list_head->master_timer = master_timer;
 	}
 
-	if ( callback_pipe != (MX_PIPE **) NULL ) {
-		*callback_pipe = callback_pipe_ptr;
+	if ( callback_queue != (MX_CALLBACK_QUEUE **) NULL ) {
+		*callback_queue = callback_queue_ptr;
 	}
 
 	return MX_SUCCESSFUL_RESULT;
@@ -850,6 +1311,7 @@ mx_remote_field_add_callback( MX_NETWORK_FIELD *nf,
 	callback_ptr->callback_id       = callback_id;
 	callback_ptr->active            = FALSE;
 	callback_ptr->usage_count	= 0;	/* Not used for remote cb. */
+	callback_ptr->poll_wheel_entry	= NULL;
 	callback_ptr->callback_function = callback_function;
 	callback_ptr->callback_argument = callback_argument;
 	callback_ptr->u.network_field   = nf;
@@ -1592,6 +2054,7 @@ mx_local_field_add_new_callback( MX_RECORD_FIELD *record_field,
 	callback_ptr->get_new_value	= FALSE;
 	callback_ptr->first_callback    = TRUE;
 	callback_ptr->timer_interval	= record_field->timer_interval;
+	callback_ptr->poll_wheel_entry	= NULL;
 	callback_ptr->callback_function = callback_function;
 	callback_ptr->callback_argument = callback_argument;
 	callback_ptr->u.record_field    = record_field;
@@ -1636,6 +2099,13 @@ mx_local_field_add_new_callback( MX_RECORD_FIELD *record_field,
 
 	callback_ptr->callback_id |= MX_NETWORK_MESSAGE_IS_CALLBACK;
 
+	/* Schedule the callback to be polled. */
+
+	mx_status = mx_poll_callback_add( list_head, callback_ptr );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
 	/* Add this callback to the record field's callback list. */
 
 	mx_status = mx_list_entry_create( &list_entry, callback_ptr, NULL );
@@ -2016,7 +2486,7 @@ mx_function_add_callback( MX_RECORD *record_list,
 		"This should not be able to happen.", record_list );
 	}
 
-	if ( list_head->callback_pipe == NULL ) {
+	if ( list_head->callback_queue == NULL ) {
 		/* We are not configured to handle callbacks, so we
 		 * must return an error.
 		 */
@@ -2329,59 +2799,21 @@ mx_delete_callback( MX_CALLBACK *callback )
 
 /*--------------------------------------------------------------------------*/
 
-mx_status_type
-mx_process_callbacks( MX_RECORD *record_list, MX_PIPE *callback_pipe )
+MX_EXPORT mx_status_type
+mx_process_callback_message( MX_CALLBACK_MESSAGE *callback_message )
 {
-	static const char fname[] = "mx_process_callbacks()";
+	static const char fname[] = "mx_process_callback_message()";
 
-	MX_LIST_HEAD *list_head;
-	MX_CALLBACK_MESSAGE *callback_message;
 	mx_status_type (*cb_function)( MX_CALLBACK_MESSAGE *);
-	size_t bytes_read;
 	mx_status_type mx_status;
 
-#if MX_CALLBACK_DEBUG_PROCESS_CALLBACKS_TIMING
-	MX_HRT_TIMING total_processing_time_measurement;
-
-	MX_HRT_START( total_processing_time_measurement );
-#endif
-
-#if MX_CALLBACK_DEBUG
-	MX_DEBUG(-2,("%s invoked for %p.", fname, record_list));
-#endif
-	/* You can actually pass any record to this function and not just
-	 * the list head record, since mx_get_record_list_head_struct()
-	 * will do the work of finding the real list head record.
-	 */
-
-	list_head = mx_get_record_list_head_struct( record_list );
-
-	MXW_UNUSED( list_head );
-
-	/* Read the next message from the callback pipe. */
-
-	mx_status = mx_pipe_read( callback_pipe,
-				(char *) &callback_message,
-				sizeof(MX_CALLBACK_MESSAGE *),
-				&bytes_read );
-
-	if ( mx_status.code != MXE_SUCCESS )
-		return mx_status;
-
-	if ( bytes_read != sizeof(MX_CALLBACK_MESSAGE *) ) {
-		return mx_error( MXE_IPC_IO_ERROR, fname,
-		"An attempt to read an MX_CALLBACK_MESSAGE pointer from "
-		"MX callback pipe %p failed, since the number of bytes "
-		"read (%ld) is less than the expected size of %ld.",
-			callback_pipe, (long) bytes_read,
-			(long) sizeof(MX_CALLBACK_MESSAGE *) );
-	}
-
 #if MX_CALLBACK_DEBUG_PROCESS
 	MX_DEBUG(-2,("%s: type = %ld, message = %p",
 		fname, callback_message->callback_type, callback_message ));
 #endif
 
+	mx_status = MX_SUCCESSFUL_RESULT;
+
 	/* We do different things depending on the type of callback message. */
 
 	switch( callback_message->callback_type ) {
@@ -2389,15 +2821,9 @@ mx_process_callbacks( MX_RECORD *record_list, MX_PIPE *callback_pipe )
 		/* Poll all value changed callback handlers. */
 
 		mx_status = mx_poll_callback_handler( callback_message );
-
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
 		break;
 	case MXCBT_MOTOR_BACKLASH:
 		mx_status = mx_motor_backlash_callback( callback_message );
-
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
 		break;
 	case MXCBT_FUNCTION:
 		cb_function = callback_message->u.function.callback_function;
@@ -2416,6 +2842,89 @@ mx_process_callbacks( MX_RECORD *record_list, MX_PIPE *callback_pipe )
 		break;
 	}
 
+	return mx_status;
+}
+
+mx_status_type
+mx_process_callbacks( MX_RECORD *record_list,
+			MX_CALLBACK_QUEUE *callback_queue )
+{
+	static const char fname[] = "mx_process_callbacks()";
+
+	MX_LIST_HEAD *list_head;
+	MX_CALLBACK_MESSAGE *callback_message;
+	unsigned long num_messages;
+	mx_status_type mx_status, first_error_status;
+
+#if MX_CALLBACK_DEBUG_PROCESS_CALLBACKS_TIMING
+	MX_HRT_TIMING total_processing_time_measurement;
+
+	MX_HRT_START( total_processing_time_measurement );
+#endif
+
+#if MX_CALLBACK_DEBUG
+	MX_DEBUG(-2,("%s invoked for %p.", fname, record_list));
+#endif
+	if ( callback_queue == (MX_CALLBACK_QUEUE *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_CALLBACK_QUEUE pointer passed was NULL." );
+	}
+
+	/* You can actually pass any record to this function and not just
+	 * the list head record, since mx_get_record_list_head_struct()
+	 * will do the work of finding the real list head record.
+	 */
+
+	list_head = mx_get_record_list_head_struct( record_list );
+
+	if ( list_head == (MX_LIST_HEAD *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_LIST_HEAD pointer for the record list is NULL." );
+	}
+
+	mxp_callback_queue_acknowledge( callback_queue );
+
+	/* Handle the messages that are waiting in the queue.  An error
+	 * from one callback does not stop the rest from being handled.
+	 */
+
+	first_error_status = MX_SUCCESSFUL_RESULT;
+
+	for ( num_messages = 0;
+	    num_messages < MXP_CALLBACK_BATCH_SIZE;
+	    num_messages++ )
+	{
+		if ( mxp_callback_queue_receive( callback_queue,
+					&callback_message ) == FALSE )
+		{
+			break;
+		}
+
+		if ( list_head->callback_message_handler != NULL ) {
+			mx_status = (*(list_head->callback_message_handler))(
+							callback_message );
+		} else {
+			mx_status = mx_process_callback_message(
+							callback_message );
+		}
+
+		if ( ( mx_status.code != MXE_SUCCESS )
+		  && ( first_error_status.code == MXE_SUCCESS ) )
+		{
+			first_error_status = mx_status;
+		}
+	}
+
+	/* If we stopped because of the batch limit, make sure that
+	 * we are called again for the messages that are left.
+	 */
+
+	if ( ( num_messages >= MXP_CALLBACK_BATCH_SIZE )
+	  && ( mx_callback_queue_is_empty( callback_queue ) == FALSE ) )
+	{
+		mxp_callback_queue_wakeup( callback_queue );
+	}
+
 #if MX_CALLBACK_DEBUG_PROCESS_CALLBACKS_TIMING
 	MX_HRT_END( total_processing_time_measurement );
 
@@ -2423,7 +2932,7 @@ mx_process_callbacks( MX_RECORD *record_list, MX_PIPE *callback_pipe )
 		fname, "total processing time" );
 #endif
 
-	return MX_SUCCESSFUL_RESULT;
+	return first_error_status;
 }
 
 /*--------------------------------------------------------------------------*/
@@ -2480,29 +2989,188 @@ mx_callback_standard_vtimer_handler( MX_VIRTUAL_TIMER *vtimer, void *args )
 
 	list_head = callback_message->list_head;
 
-	if ( list_head->callback_pipe == (MX_PIPE *) NULL ) {
+	if ( list_head->callback_queue == (MX_CALLBACK_QUEUE *) NULL ) {
 		(void) mx_error( MXE_IPC_IO_ERROR, fname,
-		"The callback pipe for this process has not been created." );
+		"The callback queue for this process has not been created." );
 
 		return;
 	}
 
 #if MX_CALLBACK_DEBUG
-	MX_DEBUG(-2,("%s: writing vtimer %p callback_message %p to MX pipe %p",
-		fname, vtimer, callback_message, list_head->callback_pipe));
+	MX_DEBUG(-2,
+	("%s: sending vtimer %p callback_message %p to callback queue %p",
+		fname, vtimer, callback_message, list_head->callback_queue));
 #endif
 
-	(void) mx_pipe_write( list_head->callback_pipe,
-				(char *) &callback_message,
-				sizeof(MX_CALLBACK_MESSAGE *) );
+	(void) mx_callback_queue_send( list_head->callback_queue,
+					callback_message );
 
 	return;
 }
 
 /*--------------------------------------------------------------------------*/
 
-/* mx_poll_callback_handler() polls all record fields that
- * currently have value changed callback handlers.
+/* Server callbacks are polled on the basis of a hashed timing wheel.
+ * A callback with a timer interval of N is due on every poll whose
+ * number is a multiple of N, and one with no timer interval is due on
+ * every poll.  Each callback is kept in the wheel slot for the next poll
+ * on which it is due, so a poll only has to look at the callbacks in one
+ * slot.  Callbacks whose next poll is more than one turn of the wheel
+ * away are skipped until the wheel comes around to them.
+ */
+
+#define MXP_POLL_WHEEL_SIZE	64	/* Must be a power of 2. */
+
+typedef struct mxp_poll_wheel_entry_type {
+	MX_CALLBACK *callback;
+	unsigned long due_poll;
+
+	struct mxp_poll_wheel_entry_type *next_entry;
+	struct mxp_poll_wheel_entry_type **previous_link;
+} MXP_POLL_WHEEL_ENTRY;
+
+typedef struct {
+	MXP_POLL_WHEEL_ENTRY *slot[MXP_POLL_WHEEL_SIZE];
+
+	/* 'next_entry_to_visit' lets callbacks be removed from the wheel
+	 * by a callback that mx_poll_callback_handler() is running.
+	 */
+
+	MXP_POLL_WHEEL_ENTRY *next_entry_to_visit;
+} MXP_POLL_WHEEL;
+
+static void
+mxp_poll_wheel_link( MXP_POLL_WHEEL *wheel, MXP_POLL_WHEEL_ENTRY *entry )
+{
+	MXP_POLL_WHEEL_ENTRY **slot;
+
+	slot = &(wheel->slot[ entry->due_poll & (MXP_POLL_WHEEL_SIZE - 1) ]);
+
+	entry->next_entry = *slot;
+	entry->previous_link = slot;
+
+	if ( *slot != (MXP_POLL_WHEEL_ENTRY *) NULL ) {
+		(*slot)->previous_link = &(entry->next_entry);
+	}
+
+	*slot = entry;
+}
+
+static void
+mxp_poll_wheel_unlink( MXP_POLL_WHEEL *wheel, MXP_POLL_WHEEL_ENTRY *entry )
+{
+	if ( wheel->next_entry_to_visit == entry ) {
+		wheel->next_entry_to_visit = entry->next_entry;
+	}
+
+	*(entry->previous_link) = entry->next_entry;
+
+	if ( entry->next_entry != (MXP_POLL_WHEEL_ENTRY *) NULL ) {
+		entry->next_entry->previous_link = entry->previous_link;
+	}
+
+	entry->next_entry = NULL;
+	entry->previous_link = NULL;
+}
+
+/* Returns the first poll after 'current_poll' on which the callback is due. */
+
+static unsigned long
+mxp_poll_wheel_next_poll( MX_CALLBACK *callback, unsigned long current_poll )
+{
+	unsigned long interval;
+
+	if ( callback->timer_interval <= 0 )
+		return ( current_poll + 1 );
+
+	interval = (unsigned long) callback->timer_interval;
+
+	return ( ( current_poll / interval ) + 1 ) * interval;
+}
+
+MX_EXPORT mx_status_type
+mx_poll_callback_add( MX_LIST_HEAD *list_head, MX_CALLBACK *callback )
+{
+	static const char fname[] = "mx_poll_callback_add()";
+
+	MXP_POLL_WHEEL *wheel;
+	MXP_POLL_WHEEL_ENTRY *entry;
+
+	if ( list_head == (MX_LIST_HEAD *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_LIST_HEAD pointer passed was NULL." );
+	}
+	if ( callback == (MX_CALLBACK *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_CALLBACK pointer passed was NULL." );
+	}
+
+	if ( callback->poll_wheel_entry != NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	wheel = list_head->callback_poll_wheel;
+
+	if ( wheel == (MXP_POLL_WHEEL *) NULL ) {
+		wheel = calloc( 1, sizeof(MXP_POLL_WHEEL) );
+
+		if ( wheel == (MXP_POLL_WHEEL *) NULL ) {
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate "
+			"the callback poll wheel." );
+		}
+
+		list_head->callback_poll_wheel = wheel;
+	}
+
+	entry = malloc( sizeof(MXP_POLL_WHEEL_ENTRY) );
+
+	if ( entry == (MXP_POLL_WHEEL_ENTRY *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to schedule callback %p.", callback );
+	}
+
+	entry->callback = callback;
+	entry->due_poll = mxp_poll_wheel_next_poll( callback,
+					list_head->num_poll_callbacks );
+
+	mxp_poll_wheel_link( wheel, entry );
+
+	callback->poll_wheel_entry = entry;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT void
+mx_poll_callback_remove( MX_LIST_HEAD *list_head, MX_CALLBACK *callback )
+{
+	MXP_POLL_WHEEL_ENTRY *entry;
+
+	if ( ( list_head == (MX_LIST_HEAD *) NULL )
+	  || ( callback == (MX_CALLBACK *) NULL ) )
+	{
+		return;
+	}
+
+	entry = callback->poll_wheel_entry;
+
+	if ( ( entry == (MXP_POLL_WHEEL_ENTRY *) NULL )
+	  || ( list_head->callback_poll_wheel == NULL ) )
+	{
+		return;
+	}
+
+	mxp_poll_wheel_unlink( list_head->callback_poll_wheel, entry );
+
+	free( entry );
+
+	callback->poll_wheel_entry = NULL;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* mx_poll_callback_handler() polls the record fields that have value
+ * changed callback handlers that are due on this poll.
  */
 
 MX_EXPORT mx_status_type
@@ -2511,15 +3179,13 @@ mx_poll_callback_handler( MX_CALLBACK_MESSAGE *callback_message )
 	static const char fname[] = "mx_poll_callback_handler()";
 
 	MX_LIST_HEAD *list_head;
-	MX_HANDLE_TABLE *handle_table;
-	MX_HANDLE_STRUCT *handle_struct;
-	signed long handle;
+	MXP_POLL_WHEEL *wheel;
+	MXP_POLL_WHEEL_ENTRY *entry;
 	MX_CALLBACK *callback;
 	MX_RECORD_FIELD *record_field;
 	MX_RECORD *record;
-	mx_bool_type get_new_value, send_value_changed_callback;
-	unsigned long i, array_size;
-	long interval;
+	mx_bool_type get_new_value;
+	unsigned long num_polls;
 	mx_status_type mx_status;
 
 #if MX_CALLBACK_DEBUG_POLL_CALLBACK_HANDLER
@@ -2597,10 +3263,10 @@ mx_poll_callback_handler( MX_CALLBACK_MESSAGE *callback_message )
 	 * sure that the timer is restarted, since a failure later on in
 	 * this callback function might otherwise prevent the timer from
 	 * being restarted.  Since this poll callback is executed in the
-	 * main thread and the callback pipe is read in the main thread,
+	 * main thread and the callback queue is read in the main thread,
 	 * there is no danger of multiple copies of this callback being
 	 * run at the same time.  In addition, there is no danger of the
-	 * callback pipe filling up with poll callback messages.
+	 * callback queue filling up with poll callback messages.
 	 */
 
 	mx_status = mx_virtual_timer_restart( list_head->callback_timer );
@@ -2615,84 +3281,48 @@ mx_poll_callback_handler( MX_CALLBACK_MESSAGE *callback_message )
 
 	/*---*/
 
-	handle_table = list_head->server_callback_handle_table;
+	wheel = list_head->callback_poll_wheel;
 
-	if ( handle_table == (MX_HANDLE_TABLE *) NULL ) {
+	if ( wheel == (MXP_POLL_WHEEL *) NULL ) {
 #if MX_CALLBACK_DEBUG
 		MX_DEBUG(-2,
-		("%s: No callback handle table installed.", fname));
+		("%s: No callbacks have been scheduled.", fname));
 #endif
 
 		return MX_SUCCESSFUL_RESULT;
 	}
 
-	if ( handle_table->handle_struct_array
-			== (MX_HANDLE_STRUCT *) NULL )
-	{
-		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-		"handle_struct_array pointer for callback handle "
-		"table is NULL." );
-	}
-
-	array_size = handle_table->block_size
-			* handle_table->num_blocks;
+	num_polls = list_head->num_poll_callbacks;
 
-	for ( i = 0; i < array_size; i++ ) {
-	    handle_struct = &(handle_table->handle_struct_array[i]);
-
-#if MX_CALLBACK_PROTECT_VM_HANDLE_TABLE
-	    mx_callback_handle_table_change_permissions( handle_table, R_OK );
-#endif
-
-	    handle   = handle_struct->handle;
-	    callback = handle_struct->pointer;
-
-#if MX_CALLBACK_PROTECT_VM_HANDLE_TABLE
-	    mx_callback_handle_table_change_permissions( handle_table, 0 );
-#endif
+	for ( entry = wheel->slot[ num_polls & (MXP_POLL_WHEEL_SIZE - 1) ];
+	      entry != (MXP_POLL_WHEEL_ENTRY *) NULL;
+	      entry = wheel->next_entry_to_visit )
+	{
+	    wheel->next_entry_to_visit = entry->next_entry;
 
-	    if ( ( handle == MX_ILLEGAL_HANDLE )
-	      || ( callback == NULL ) )
-	    {
-		/* Skip unused handles. */
+	    if ( entry->due_poll > num_polls ) {
+		/* This callback is not due until a later turn of the wheel. */
 
 		continue;
 	    }
 
-#if 0
-	    MX_DEBUG(-2,
-    ("%s: handle_struct_array[%lu] = %p, handle = %ld, callback = %p",
-			fname, i, handle_struct, handle, callback));
-#endif
+	    callback = entry->callback;
 
-	    /* If this callback has a timer interval,
-	     * check to see if this is the right time
-	     * to invoke the callback.
+	    /* Move the callback to the slot for the next time it is due
+	     * before running it, in case running it removes the callback.
 	     */
 
-	    interval = callback->timer_interval;
+	    mxp_poll_wheel_unlink( wheel, entry );
 
-	    if ( interval > 0 ) {
-		unsigned long num_polls;
+	    entry->due_poll = mxp_poll_wheel_next_poll( callback, num_polls );
 
-		num_polls = list_head->num_poll_callbacks;
-#if 1
-		MX_DEBUG(-2,
-		("%s: callback = %p, interval = %ld, num_polls = %lu",
-				fname, callback, interval, num_polls));
-#endif
-		if ( (num_polls % interval) != 0 ) {
-		    /* This is the wrong time,
-		     * so skip this callback.
-		     */
+	    mxp_poll_wheel_link( wheel, entry );
 
-		    continue;
-		}
-#if 1
-		MX_DEBUG(-2,("%s: will perform callback %p",
-				fname, callback));
+#if MX_CALLBACK_DEBUG_POLL_CALLBACK_HANDLER
+	    MX_DEBUG(-2,("%s: will perform callback %p, interval = %ld, "
+		"num_polls = %lu", fname, callback,
+		callback->timer_interval, num_polls));
 #endif
-	    }
 
 #if 0
 	    MX_DEBUG(-2,("%s: callback->callback_function = %p",
@@ -2761,66 +3391,87 @@ mx_poll_callback_handler( MX_CALLBACK_MESSAGE *callback_message )
 		    get_new_value = FALSE;
 		}
 
-		/* Do we need to get a new field value? */
+		/* Hand the callback to the dispatcher if there is one. */
 
-		if ( get_new_value ) {
+		if ( list_head->poll_callback_dispatcher != NULL ) {
+			mx_status = (*(list_head->poll_callback_dispatcher))(
+						callback, get_new_value );
+		} else {
+			mx_status = mx_poll_callback_field( callback,
+							get_new_value );
+		}
 
-			/* Process the record field to get the new value.
-			 *
-			 * mx_process_record_field() will automatically
-			 * send out any value changed messages that are
-			 * necessary.
-			 */
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	    }
+	}
 
-			record = record_field->record;
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT mx_status_type
+mx_poll_callback_field( MX_CALLBACK *callback, mx_bool_type get_new_value )
+{
+	static const char fname[] = "mx_poll_callback_field()";
+
+	MX_RECORD_FIELD *record_field;
+	mx_bool_type send_value_changed_callback;
+	mx_status_type mx_status;
+
+	if ( callback == (MX_CALLBACK *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_CALLBACK pointer passed was NULL." );
+	}
+
+	record_field = callback->u.record_field;
+
+	if ( get_new_value ) {
+
+		/* Process the record field to get the new value.
+		 *
+		 * mx_process_record_field() will automatically
+		 * send out any value changed messages that are
+		 * necessary.
+		 */
 
 #if 0
-			MX_DEBUG(-2,("%s: Processing '%s.%s'",
-			fname, record->name, record_field->name));
+		MX_DEBUG(-2,("%s: Processing '%s.%s'",
+		fname, record_field->record->name, record_field->name));
 #endif
-			mx_status = mx_process_record_field(
-						record, record_field, NULL,
-						MX_PROCESS_GET, NULL );
+		mx_status = mx_process_record_field( record_field->record,
+					record_field, NULL, MX_PROCESS_GET, NULL );
+	} else {
+		/* We do _not_ process the record field, but we _do_ 
+		 * check to see if the contents of the field have 
+		 * changed since the last time that we looked.
+		 */
 
-			if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
-		} else {
-			/* We do _not_ process the record field, but we _do_ 
-			 * check to see if the contents of the field have 
-			 * changed since the last time that we looked.
-			 */
-					
-			mx_status = mx_test_for_value_changed( record_field,
+		mx_status = mx_test_for_value_changed( record_field,
 						MX_PROCESS_GET,
 						&send_value_changed_callback );
 
-			if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 #if 0
-			MX_DEBUG(-2,
-			("%s: '%s.%s' send_value_changed_callback = %d",
-				fname, record->name, record_field->name,
-				send_value_changed_callback));
+		MX_DEBUG(-2,
+		("%s: '%s.%s' send_value_changed_callback = %d",
+			fname, record_field->record->name, record_field->name,
+			send_value_changed_callback));
 #endif
 
-			if ( send_value_changed_callback ) {
-
-				/* mx_test_for_value_changed() does _not_
-				 * automatically send out any value changed
-				 * messages, so we must explicitly do that
-				 * here.
-				 */
+		if ( send_value_changed_callback ) {
 
-				mx_status = mx_invoke_callback( callback,
-						MXCBT_VALUE_CHANGED, FALSE );
+			/* mx_test_for_value_changed() does _not_
+			 * automatically send out any value changed
+			 * messages, so we must explicitly do that
+			 * here.
+			 */
 
-				if ( mx_status.code != MXE_SUCCESS )
-					return mx_status;
-			}
+			mx_status = mx_invoke_callback( callback,
+					MXCBT_VALUE_CHANGED, FALSE );
 		}
-	    }
 	}
 
-	return MX_SUCCESSFUL_RESULT;
+	return mx_status;
 }
 
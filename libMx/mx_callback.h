@@ -54,6 +54,7 @@ typedef struct mx_callback_type {
 	mx_bool_type get_new_value;
 	mx_bool_type first_callback;
 	long timer_interval;
+	void *poll_wheel_entry;
 	mx_status_type ( *callback_function )
 				( struct mx_callback_type *, void * );
 	void *callback_argument;
@@ -108,6 +109,40 @@ typedef struct mx_callback_message_type{
 	} u;
 } MX_CALLBACK_MESSAGE;
 
+/*--- Callback message queue ---*/
+
+/* Callback messages are passed to the thread that runs mx_process_callbacks()
+ * through an MX_CALLBACK_QUEUE.  mx_callback_queue_send() may be called
+ * from any thread and from signal handlers.  It returns FALSE if the queue
+ * is full, in which case the message is dropped.  The other functions must
+ * only be called by the thread that processes the callbacks.
+ *
+ * mx_callback_queue_get_fd() returns a file descriptor that becomes
+ * readable when messages are waiting, so that the queue can be watched
+ * by a select(), poll() or epoll() event loop.
+ */
+
+typedef struct mx_callback_queue_type MX_CALLBACK_QUEUE;
+
+MX_API mx_status_type mx_callback_queue_create( MX_CALLBACK_QUEUE **queue );
+
+MX_API void mx_callback_queue_destroy( MX_CALLBACK_QUEUE *queue );
+
+MX_API mx_bool_type mx_callback_queue_send( MX_CALLBACK_QUEUE *queue,
+					MX_CALLBACK_MESSAGE *callback_message );
+
+MX_API mx_bool_type mx_callback_queue_is_empty( MX_CALLBACK_QUEUE *queue );
+
+MX_API mx_status_type mx_callback_queue_get_fd( MX_CALLBACK_QUEUE *queue,
+						int *fd );
+
+/* mx_send_callback_message() sends the message to the callback queue
+ * of the message's list head.
+ */
+
+MX_API mx_bool_type mx_send_callback_message(
+					MX_CALLBACK_MESSAGE *callback_message );
+
 /*--- Standard callbacks ---*/
 
 MX_API void mx_request_value_changed_poll( MX_VIRTUAL_TIMER *callback_timer,
@@ -117,8 +152,8 @@ MX_API void mx_request_value_changed_poll( MX_VIRTUAL_TIMER *callback_timer,
 
 MX_API mx_status_type mx_initialize_callback_support( MX_RECORD *record_list );
 
-MX_API mx_status_type mx_setup_callback_pipe( MX_RECORD *record_list,
-						MX_PIPE **callback_pipe );
+MX_API mx_status_type mx_setup_callback_queue( MX_RECORD *record_list,
+					MX_CALLBACK_QUEUE **callback_queue );
 
 MX_API mx_status_type mx_remote_field_add_callback( MX_NETWORK_FIELD *nf,
 					unsigned long supported_callback_types,
@@ -179,8 +214,15 @@ MX_API mx_status_type mx_invoke_callback( MX_CALLBACK *cb,
 
 MX_API mx_status_type mx_delete_callback( MX_CALLBACK *cb );
 
+/* mx_process_callbacks() handles the messages that are waiting in the
+ * callback queue, up to a limit on the number handled in one call.
+ */
+
 MX_API mx_status_type mx_process_callbacks( MX_RECORD *record_list,
-					MX_PIPE *callback_pipe );
+					MX_CALLBACK_QUEUE *callback_queue );
+
+MX_API mx_status_type mx_process_callback_message(
+					MX_CALLBACK_MESSAGE *callback_message );
 
 /*---*/
 
@@ -198,6 +240,27 @@ MX_API void mx_callback_standard_vtimer_handler( MX_VIRTUAL_TIMER *vtimer,
 
 MX_API mx_status_type mx_poll_callback_handler(MX_CALLBACK_MESSAGE *message);
 
+/* mx_poll_callback_field() does the work of mx_poll_callback_handler()
+ * for a single callback that is due.  If 'get_new_value' is TRUE, the
+ * field is read from the hardware and all of its callbacks are invoked
+ * if the value has changed.  Otherwise, only 'callback' is checked.
+ */
+
+MX_API mx_status_type mx_poll_callback_field( MX_CALLBACK *callback,
+					mx_bool_type get_new_value );
+
+/* Server field callbacks are polled by mx_poll_callback_handler() only
+ * after they have been added to the poll schedule of the list head with
+ * mx_poll_callback_add().  They must be removed with mx_poll_callback_remove()
+ * before they are deleted.
+ */
+
+MX_API_PRIVATE mx_status_type mx_poll_callback_add( MX_LIST_HEAD *list_head,
+							MX_CALLBACK *callback );
+
+MX_API_PRIVATE void mx_poll_callback_remove( MX_LIST_HEAD *list_head,
+							MX_CALLBACK *callback );
+
 MX_API mx_status_type mx_motor_backlash_callback(MX_CALLBACK_MESSAGE *message);
 
 /*---*/
@@ -7,7 +7,7 @@
  *
  *-------------------------------------------------------------------------
  *
- * Copyright 2012-2013 Illinois Institute of Technology
+ * Copyright 2012-2013, 2026 Illinois Institute of Technology
  *
  * See the file "LICENSE" for information on usage and redistribution
  * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
@@ -16,16 +16,204 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "mx_util.h"
 #include "mx_mutex.h"
+#include "mx_atomic.h"
 #include "mx_circular_buffer.h"
 
+/* 'bytes_read' and 'bytes_written' are always loaded with acquire ordering
+ * and stored with release ordering, so that the data bytes themselves are
+ * visible before the counter that covers them.  This is what makes the
+ * MXF_CIRCULAR_BUFFER_SPSC mode safe without a mutex.
+ */
+
+#if defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+
+#define MXP_LOAD_ACQUIRE(ptr) \
+		__atomic_load_n( (ptr), __ATOMIC_ACQUIRE )
+
+#define MXP_STORE_RELEASE(ptr,value) \
+		__atomic_store_n( (ptr), (value), __ATOMIC_RELEASE )
+
+#else
+
+static unsigned long
+mxp_load_acquire( unsigned long *ptr )
+{
+	unsigned long value;
+
+	value = *((volatile unsigned long *) ptr);
+
+	mx_atomic_memory_barrier();
+
+	return value;
+}
+
+static void
+mxp_store_release( unsigned long *ptr, unsigned long value )
+{
+	mx_atomic_memory_barrier();
+
+	*((volatile unsigned long *) ptr) = value;
+}
+
+#define MXP_LOAD_ACQUIRE(ptr)		mxp_load_acquire( (ptr) )
+
+#define MXP_STORE_RELEASE(ptr,value)	mxp_store_release( (ptr), (value) )
+
+#endif
+
+static mx_status_type
+mxp_circular_buffer_lock( MX_CIRCULAR_BUFFER *buffer, const char *fname )
+{
+	long mx_status_code;
+
+	if ( buffer->flags & MXF_CIRCULAR_BUFFER_SPSC )
+		return MX_SUCCESSFUL_RESULT;
+
+	mx_status_code = mx_mutex_lock( buffer->mutex );
+
+	if ( mx_status_code != MXE_SUCCESS ) {
+		return mx_error( mx_status_code, fname,
+		"The attempt to lock MX_CIRCULAR_BUFFER %p failed.",
+			buffer );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+static mx_status_type
+mxp_circular_buffer_unlock( MX_CIRCULAR_BUFFER *buffer, const char *fname )
+{
+	long mx_status_code;
+
+	if ( buffer->flags & MXF_CIRCULAR_BUFFER_SPSC )
+		return MX_SUCCESSFUL_RESULT;
+
+	mx_status_code = mx_mutex_unlock( buffer->mutex );
+
+	if ( mx_status_code != MXE_SUCCESS ) {
+		return mx_error( mx_status_code, fname,
+		"The attempt to unlock MX_CIRCULAR_BUFFER %p failed.",
+			buffer );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* mxp_circular_buffer_find_spans() splits the 'length' bytes that start
+ * at byte count 'start' into the part before the end of the data array
+ * and the part that wraps around to the start of the data array.
+ */
+
+static void
+mxp_circular_buffer_find_spans( MX_CIRCULAR_BUFFER *buffer,
+				unsigned long start,
+				unsigned long length,
+				char **first_span,
+				unsigned long *first_span_length,
+				char **second_span,
+				unsigned long *second_span_length )
+{
+	unsigned long start_modulo, bytes_until_end_of_buffer;
+
+	start_modulo = start % ( buffer->buffer_size );
+
+	bytes_until_end_of_buffer = buffer->buffer_size - start_modulo;
+
+	*first_span = buffer->data_array + start_modulo;
+	*second_span = buffer->data_array;
+
+	if ( length <= bytes_until_end_of_buffer ) {
+		*first_span_length = length;
+		*second_span_length = 0;
+	} else {
+		*first_span_length = bytes_until_end_of_buffer;
+		*second_span_length = length - bytes_until_end_of_buffer;
+	}
+}
+
+/* mxp_circular_buffer_copy_out() does the work of peeking at the buffer.
+ * The caller must hold the mutex, if there is one.
+ */
+
+static void
+mxp_circular_buffer_copy_out( MX_CIRCULAR_BUFFER *buffer,
+				char *data_destination,
+				unsigned long max_bytes_to_peek,
+				unsigned long *num_bytes_peeked )
+{
+	static const char fname[] = "mxp_circular_buffer_copy_out()";
+
+	unsigned long bytes_read, num_bytes_in_use, num_bytes_to_peek;
+	unsigned long first_span_length, second_span_length;
+	char *first_span, *second_span;
+
+	/* How many bytes are available to peek from the buffer?
+	 *
+	 * If bytes_read > bytes_written due to bytes_written wrapping
+	 * around at ULONG_MAX, then the underflow due to the subtraction
+	 * will still produce the correct value of num_bytes_in_use
+	 * as long as buffer overrun has not happened.  This relies on
+	 * the fact that mx_circular_buffer_write() is designed to
+	 * prevent buffer overrun from happening.
+	 */
+
+	bytes_read = buffer->bytes_read;
+
+	num_bytes_in_use = MXP_LOAD_ACQUIRE( &(buffer->bytes_written) )
+				- bytes_read;
+
+	if ( num_bytes_in_use > buffer->buffer_size ) {
+		mx_warning( "%s: Buffer overrun detected for circular "
+		"buffer %p.  %lu bytes in use, but buffer is %lu bytes.",
+			fname, buffer, num_bytes_in_use,
+			buffer->buffer_size );
+
+		num_bytes_in_use = buffer->buffer_size;
+	}
+
+	if ( num_bytes_in_use >= max_bytes_to_peek ) {
+		num_bytes_to_peek = max_bytes_to_peek;
+	} else {
+		num_bytes_to_peek = num_bytes_in_use;
+	}
+
+	/* If the region we need to read from wraps around to the start
+	 * of the buffer, then the copy is done in two parts.
+	 */
+
+	mxp_circular_buffer_find_spans( buffer, bytes_read, num_bytes_to_peek,
+					&first_span, &first_span_length,
+					&second_span, &second_span_length );
+
+	memcpy( data_destination, first_span, first_span_length );
+
+	if ( second_span_length > 0 ) {
+		memcpy( data_destination + first_span_length,
+				second_span, second_span_length );
+	}
+
+	*num_bytes_peeked = num_bytes_to_peek;
+}
+
+/*--------------------------------------------------------------------------*/
+
 MX_EXPORT mx_status_type
 mx_circular_buffer_create( MX_CIRCULAR_BUFFER **buffer,
 			unsigned long buffer_size )
 {
-	static const char fname[] = "mx_circular_buffer_create()";
+	return mx_circular_buffer_create_with_flags( buffer, buffer_size, 0 );
+}
+
+MX_EXPORT mx_status_type
+mx_circular_buffer_create_with_flags( MX_CIRCULAR_BUFFER **buffer,
+				unsigned long buffer_size,
+				unsigned long flags )
+{
+	static const char fname[] = "mx_circular_buffer_create_with_flags()";
 
 	mx_status_type mx_status;
 
@@ -48,6 +236,8 @@ mx_circular_buffer_create( MX_CIRCULAR_BUFFER **buffer,
 		"MX_CIRCULAR_BUFFER structure." );
 	}
 
+	(*buffer)->mutex         = NULL;
+	(*buffer)->flags         = flags;
 	(*buffer)->buffer_size   = buffer_size;
 	(*buffer)->bytes_written = 0;
 	(*buffer)->bytes_read    = 0;
@@ -65,15 +255,19 @@ mx_circular_buffer_create( MX_CIRCULAR_BUFFER **buffer,
 			buffer_size );
 	}
 
-	/* Create a mutex to control access to the buffer. */
+	/* Create a mutex to control access to the buffer, unless there
+	 * is only a single reader and a single writer.
+	 */
 
-	mx_status = mx_mutex_create( &((*buffer)->mutex) );
+	if ( ( flags & MXF_CIRCULAR_BUFFER_SPSC ) == 0 ) {
+		mx_status = mx_mutex_create( &((*buffer)->mutex) );
 
-	if ( mx_status.code != MXE_SUCCESS ) {
-		mx_free( (*buffer)->data_array );
-		mx_free( (*buffer) );
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( (*buffer)->data_array );
+			mx_free( (*buffer) );
 
-		return mx_status;
+			return mx_status;
+		}
 	}
 
 	return MX_SUCCESSFUL_RESULT;
@@ -93,10 +287,12 @@ mx_circular_buffer_destroy( MX_CIRCULAR_BUFFER *buffer )
 
 	/* First, we destroy the mutex. */
 
-	mx_status = mx_mutex_destroy( buffer->mutex );
+	if ( buffer->mutex != (MX_MUTEX *) NULL ) {
+		mx_status = mx_mutex_destroy( buffer->mutex );
 
-	if ( mx_status.code != MXE_SUCCESS )
-		return mx_status;
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
 
 	/* Then, we free the allocated memory. */
 
@@ -115,48 +311,37 @@ mx_circular_buffer_read( MX_CIRCULAR_BUFFER *buffer,
 	static const char fname[] = "mx_circular_buffer_read()";
 
 	unsigned long num_bytes_peeked;
-	long mx_status_code;
 	mx_status_type mx_status;
 
-	/* Lock the mutex. */
-
-	mx_status_code = mx_mutex_lock( buffer->mutex );
-
-	if ( mx_status_code != MXE_SUCCESS ) {
-		return mx_error( mx_status_code, fname,
-		"The attempt to lock MX_CIRCULAR_BUFFER %p failed.",
-			buffer );
+	if ( buffer == (MX_CIRCULAR_BUFFER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_CIRCULAR_BUFFER pointer passed was NULL." );
+	}
+	if ( data_destination == (char *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The data_destination pointer passed was NULL." );
 	}
 
-	/* Copy the data from the buffer. */
-
-	mx_status = mx_circular_buffer_peek( buffer,
-					data_destination,
-					max_bytes_to_read,
-					&num_bytes_peeked );
+	mx_status = mxp_circular_buffer_lock( buffer, fname );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-	/* Mark the data as read. */
+	/* Copy the data from the buffer. */
 
-	mx_status = mx_circular_buffer_increment_bytes_read( buffer,
-							num_bytes_peeked );
+	mxp_circular_buffer_copy_out( buffer, data_destination,
+				max_bytes_to_read, &num_bytes_peeked );
 
-	if ( mx_status.code != MXE_SUCCESS )
-		return mx_status;
-
-	/* Unlock the mutex. */
+	/* Mark the data as read. */
 
-	mx_status_code = mx_mutex_unlock( buffer->mutex );
+	MXP_STORE_RELEASE( &(buffer->bytes_read),
+				buffer->bytes_read + num_bytes_peeked );
 
-	if ( mx_status_code != MXE_SUCCESS ) {
-		return mx_error( mx_status_code, fname,
-		"The attempt to unlock MX_CIRCULAR_BUFFER %p failed.",
-			buffer );
+	if ( num_bytes_read != (unsigned long *) NULL ) {
+		*num_bytes_read = num_bytes_peeked;
 	}
 
-	return MX_SUCCESSFUL_RESULT;
+	return mxp_circular_buffer_unlock( buffer, fname );
 }
 
 MX_EXPORT mx_status_type
@@ -167,13 +352,8 @@ mx_circular_buffer_peek( MX_CIRCULAR_BUFFER *buffer,
 {
 	static const char fname[] = "mx_circular_buffer_peek()";
 
-	unsigned long num_bytes_in_use, num_bytes_to_peek;
-	unsigned long bytes_read_modulo;
-	unsigned long future_value_of_bytes_read;
-	unsigned long future_value_of_bytes_read_modulo;
-	unsigned long bytes_until_end_of_buffer;
-	char *peek_ptr;
-	long mx_status_code;
+	unsigned long num_bytes_copied;
+	mx_status_type mx_status;
 
 	if ( buffer == (MX_CIRCULAR_BUFFER *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
@@ -184,107 +364,19 @@ mx_circular_buffer_peek( MX_CIRCULAR_BUFFER *buffer,
 		"The data_destination pointer passed was NULL." );
 	}
 
-#if 0
-	if ( max_bytes_to_peek > buffer->buffer_size ) {
-		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
-		"Attempted to get %lu bytes from circular buffer %p, "
-		"but the circular buffer can only hold %lu bytes.",
-			max_bytes_to_peek, buffer,
-			buffer->buffer_size );
-	}
-#else
-	if ( max_bytes_to_peek > buffer->buffer_size ) {
-		max_bytes_to_peek = buffer->buffer_size;
-	}
-#endif
-
-	/* Lock the mutex. */
-
-	mx_status_code = mx_mutex_lock( buffer->mutex );
-
-	if ( mx_status_code != MXE_SUCCESS ) {
-		return mx_error( mx_status_code, fname,
-		"The attempt to lock MX_CIRCULAR_BUFFER %p failed.",
-			buffer );
-	}
-
-	/* How many bytes are available to peek from the buffer?
-	 *
-	 * If bytes_read > bytes_written due to bytes_written wrapping
-	 * around at ULONG_MAX, then the underflow due to the subtraction
-	 * will still produce the correct value of num_bytes_in_use
-	 * as long as buffer overrun has not happened.  This relies on
-	 * the fact that mx_circular_buffer_write() is designed to
-	 * prevent buffer overrun from happening.
-	 */
-
-	num_bytes_in_use = buffer->bytes_written - buffer->bytes_read;
-
-	if ( num_bytes_in_use >= max_bytes_to_peek ) {
-		num_bytes_to_peek = max_bytes_to_peek;
-	} else {
-		num_bytes_to_peek = num_bytes_in_use;
-	}
-
-	if ( num_bytes_in_use > buffer->buffer_size ) {
-		mx_warning( "%s: Buffer overrun detected for circular "
-		"buffer %p.  %lu bytes in use, but buffer is %lu bytes.",
-			fname, buffer, num_bytes_in_use,
-			buffer->buffer_size );
-	}
-
-	bytes_read_modulo = buffer->bytes_read % ( buffer->buffer_size );
-
-	/* Does the region we need to read from wrap around to the start
-	 * of the buffer?  If so, then we must break up the data copy
-	 * operation into two separate copies.
-	 */
-
-	future_value_of_bytes_read = buffer->bytes_read + num_bytes_to_peek;
-
-	future_value_of_bytes_read_modulo
-		= future_value_of_bytes_read % ( buffer->buffer_size );
-
-	if ( future_value_of_bytes_read_modulo >= bytes_read_modulo ) {
-		/* This case we can do as one copy. */
-
-		peek_ptr = buffer->data_array + bytes_read_modulo;
-
-		memcpy( data_destination, peek_ptr, num_bytes_to_peek );
-	} else {
-		/* This case must be split into two copies. */
-
-		peek_ptr = buffer->data_array + bytes_read_modulo;
-
-		bytes_until_end_of_buffer
-			= buffer->buffer_size - bytes_read_modulo;
+	mx_status = mxp_circular_buffer_lock( buffer, fname );
 
-		/* This is the part at the end of the buffer. */
-
-		memcpy( data_destination, peek_ptr, bytes_until_end_of_buffer );
-
-		/* This is the remaining part that has wrapped around
-		 * back to the beginning of the buffer.
-		 */
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-		memcpy( data_destination + bytes_until_end_of_buffer,
-				buffer->data_array,
-				future_value_of_bytes_read_modulo );
-	}
+	mxp_circular_buffer_copy_out( buffer, data_destination,
+				max_bytes_to_peek, &num_bytes_copied );
 
 	if ( num_bytes_peeked != (unsigned long *) NULL ) {
-		*num_bytes_peeked = num_bytes_to_peek;
+		*num_bytes_peeked = num_bytes_copied;
 	}
 
-	mx_status_code = mx_mutex_unlock( buffer->mutex );
-
-	if ( mx_status_code != MXE_SUCCESS ) {
-		return mx_error( mx_status_code, fname,
-		"The attempt to unlock MX_CIRCULAR_BUFFER %p failed.",
-			buffer );
-	}
-
-	return MX_SUCCESSFUL_RESULT;
+	return mxp_circular_buffer_unlock( buffer, fname );
 }
 
 MX_EXPORT mx_status_type
@@ -295,14 +387,11 @@ mx_circular_buffer_write( MX_CIRCULAR_BUFFER *buffer,
 {
 	static const char fname[] = "mx_circular_buffer_write()";
 
-	unsigned long num_bytes_in_use, num_unused_bytes;
+	unsigned long bytes_written, num_bytes_in_use, num_unused_bytes;
 	unsigned long num_bytes_to_write;
-	unsigned long bytes_written_modulo;
-	unsigned long future_value_of_bytes_written;
-	unsigned long future_value_of_bytes_written_modulo;
-	unsigned long bytes_until_end_of_buffer;
-	char *write_ptr;
-	long mx_status_code;
+	unsigned long first_span_length, second_span_length;
+	char *first_span, *second_span;
+	mx_status_type mx_status;
 
 	if ( buffer == (MX_CIRCULAR_BUFFER *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
@@ -313,15 +402,6 @@ mx_circular_buffer_write( MX_CIRCULAR_BUFFER *buffer,
 		"The data_source pointer passed was NULL." );
 	}
 
-#if 0
-	if ( max_bytes_to_write > buffer->buffer_size ) {
-		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
-		"Attempted to write %lu bytes to circular buffer %p, "
-		"but the circular buffer can only hold %lu bytes.",
-			max_bytes_to_write, buffer,
-			buffer->buffer_size );
-	}
-#else
 	if ( max_bytes_to_write > buffer->buffer_size ) {
 		mx_warning(
 		"%s: Attempted to write %lu bytes to circular buffer %p, "
@@ -333,22 +413,19 @@ mx_circular_buffer_write( MX_CIRCULAR_BUFFER *buffer,
 
 		max_bytes_to_write = buffer->buffer_size;
 	}
-#endif
 
-	/* Lock the mutex. */
+	mx_status = mxp_circular_buffer_lock( buffer, fname );
 
-	mx_status_code = mx_mutex_lock( buffer->mutex );
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-	if ( mx_status_code != MXE_SUCCESS ) {
-		return mx_error( mx_status_code, fname,
-		"The attempt to lock MX_CIRCULAR_BUFFER %p failed.",
-			buffer );
-	}
+	bytes_written = buffer->bytes_written;
 
-	num_bytes_in_use = buffer->bytes_written - buffer->bytes_read;
+	num_bytes_in_use = bytes_written
+				- MXP_LOAD_ACQUIRE( &(buffer->bytes_read) );
 
 	if ( num_bytes_in_use > buffer->buffer_size ) {
-		(void) mx_mutex_unlock( buffer->mutex );
+		(void) mxp_circular_buffer_unlock( buffer, fname );
 
 		return mx_error( MXE_LIMIT_WAS_EXCEEDED, fname,
 		"Buffer overrun for MX_CIRCULAR_BUFFER %p.  "
@@ -358,8 +435,8 @@ mx_circular_buffer_write( MX_CIRCULAR_BUFFER *buffer,
 		"This should not be able to happen.",
 			buffer,
 			num_bytes_in_use,
-			buffer->bytes_written,
-			buffer->bytes_read,
+			bytes_written,
+			bytes_written - num_bytes_in_use,
 			buffer->buffer_size );
 	}
 
@@ -377,61 +454,30 @@ mx_circular_buffer_write( MX_CIRCULAR_BUFFER *buffer,
 		fname, max_bytes_to_write - num_bytes_to_write, buffer );
 	}
 
-	bytes_written_modulo = buffer->bytes_written % ( buffer->buffer_size );
-
-	/* Does the region we need to write to wrap around to the start
-	 * of the buffer?  If so, then we must break up the data copy
-	 * operation into two separate copies.
+	/* If the region we need to write to wraps around to the start
+	 * of the buffer, then the copy is done in two parts.
 	 */
 
-	future_value_of_bytes_written
-		= buffer->bytes_written + num_bytes_to_write;
-
-	future_value_of_bytes_written_modulo
-		= future_value_of_bytes_written % ( buffer->buffer_size );
-
-	if ( future_value_of_bytes_written_modulo >= bytes_written_modulo ) {
-		/* This case we can do as one copy. */
-
-		write_ptr = buffer->data_array + bytes_written_modulo;
+	mxp_circular_buffer_find_spans( buffer,
+					bytes_written, num_bytes_to_write,
+					&first_span, &first_span_length,
+					&second_span, &second_span_length );
 
-		memcpy( write_ptr, data_source, num_bytes_to_write );
-	} else {
-		/* This case must be split into two copies. */
-
-		write_ptr = buffer->data_array + bytes_written_modulo;
-
-		bytes_until_end_of_buffer
-			= buffer->buffer_size - bytes_written_modulo;
-
-		/* This is the part at the end of the buffer. */
-
-		memcpy( write_ptr, data_source, bytes_until_end_of_buffer );
-
-		/* This is the remaining part that has wrapped around
-		 * back to the beginning of the buffer.
-		 */
+	memcpy( first_span, data_source, first_span_length );
 
-		memcpy( buffer->data_array,
-				data_source + bytes_until_end_of_buffer,
-				future_value_of_bytes_written_modulo );
+	if ( second_span_length > 0 ) {
+		memcpy( second_span, data_source + first_span_length,
+				second_span_length );
 	}
 
-	buffer->bytes_written = future_value_of_bytes_written;
+	MXP_STORE_RELEASE( &(buffer->bytes_written),
+				bytes_written + num_bytes_to_write );
 
 	if ( num_bytes_written != (unsigned long *) NULL ) {
 		*num_bytes_written = num_bytes_to_write;
 	}
 
-	mx_status_code = mx_mutex_unlock( buffer->mutex );
-
-	if ( mx_status_code != MXE_SUCCESS ) {
-		return mx_error( mx_status_code, fname,
-		"The attempt to unlock MX_CIRCULAR_BUFFER %p failed.",
-			buffer );
-	}
-
-	return MX_SUCCESSFUL_RESULT;
+	return mxp_circular_buffer_unlock( buffer, fname );
 }
 
 MX_EXPORT mx_status_type
@@ -440,8 +486,8 @@ mx_circular_buffer_num_bytes_available( MX_CIRCULAR_BUFFER *buffer,
 {
 	static const char fname[] = "mx_circular_buffer_num_bytes_available()";
 
-	unsigned long num_bytes_in_use;
-	long mx_status_code;
+	unsigned long bytes_read;
+	mx_status_type mx_status;
 
 	if ( buffer == (MX_CIRCULAR_BUFFER *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
@@ -452,110 +498,209 @@ mx_circular_buffer_num_bytes_available( MX_CIRCULAR_BUFFER *buffer,
 		"The num_bytes_available pointer passed was NULL." );
 	}
 
-	/* Lock the mutex */
+	mx_status = mxp_circular_buffer_lock( buffer, fname );
 
-	mx_status_code = mx_mutex_lock( buffer->mutex );
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-	if ( mx_status_code != MXE_SUCCESS ) {
-		return mx_error( mx_status_code, fname,
-		"The attempt to lock MX_CIRCULAR_BUFFER %p failed.",
-			buffer );
-	}
+	bytes_read = MXP_LOAD_ACQUIRE( &(buffer->bytes_read) );
 
-	num_bytes_in_use = buffer->bytes_written - buffer->bytes_read;
+	*num_bytes_available = MXP_LOAD_ACQUIRE( &(buffer->bytes_written) )
+					- bytes_read;
 
-	/* Unlock the mutex */
+	return mxp_circular_buffer_unlock( buffer, fname );
+}
 
-	mx_status_code = mx_mutex_unlock( buffer->mutex );
+MX_EXPORT mx_status_type
+mx_circular_buffer_increment_bytes_read( MX_CIRCULAR_BUFFER *buffer,
+					unsigned long num_bytes_to_increment )
+{
+	static const char fname[] = "mx_circular_buffer_increment_bytes_read()";
 
-	if ( mx_status_code != MXE_SUCCESS ) {
-		return mx_error( mx_status_code, fname,
-		"The attempt to unlock MX_CIRCULAR_BUFFER %p failed.",
-			buffer );
+	mx_status_type mx_status;
+
+	if ( buffer == (MX_CIRCULAR_BUFFER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_CIRCULAR_BUFFER pointer passed was NULL." );
 	}
 
-	*num_bytes_available = num_bytes_in_use;
+	mx_status = mxp_circular_buffer_lock( buffer, fname );
 
-	return MX_SUCCESSFUL_RESULT;
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	MXP_STORE_RELEASE( &(buffer->bytes_read),
+				buffer->bytes_read + num_bytes_to_increment );
+
+	return mxp_circular_buffer_unlock( buffer, fname );
 }
 
 MX_EXPORT mx_status_type
-mx_circular_buffer_increment_bytes_read( MX_CIRCULAR_BUFFER *buffer,
-					unsigned long num_bytes_to_increment )
+mx_circular_buffer_discard_available_bytes( MX_CIRCULAR_BUFFER *buffer )
 {
-	static const char fname[] = "mx_circular_buffer_increment_bytes_read()";
+	static const char fname[] =
+		"mx_circular_buffer_discard_available_bytes()";
 
-	long mx_status_code;
+	mx_status_type mx_status;
 
 	if ( buffer == (MX_CIRCULAR_BUFFER *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
 		"The MX_CIRCULAR_BUFFER pointer passed was NULL." );
 	}
 
-	/* Lock the mutex */
+	mx_status = mxp_circular_buffer_lock( buffer, fname );
 
-	mx_status_code = mx_mutex_lock( buffer->mutex );
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-	if ( mx_status_code != MXE_SUCCESS ) {
-		return mx_error( mx_status_code, fname,
-		"The attempt to lock MX_CIRCULAR_BUFFER %p failed.",
-			buffer );
+	/* All we need to do here is to declare all of the unread bytes
+	 * as read.  This is done by the reader, so that it also works
+	 * for single reader, single writer buffers.
+	 */
+
+	MXP_STORE_RELEASE( &(buffer->bytes_read),
+			MXP_LOAD_ACQUIRE( &(buffer->bytes_written) ) );
+
+	return mxp_circular_buffer_unlock( buffer, fname );
+}
+
+MX_EXPORT mx_status_type
+mx_circular_buffer_get_read_spans( MX_CIRCULAR_BUFFER *buffer,
+				char **first_span,
+				unsigned long *first_span_length,
+				char **second_span,
+				unsigned long *second_span_length )
+{
+	static const char fname[] = "mx_circular_buffer_get_read_spans()";
+
+	unsigned long bytes_read, num_bytes_in_use;
+	mx_status_type mx_status;
+
+	if ( buffer == (MX_CIRCULAR_BUFFER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_CIRCULAR_BUFFER pointer passed was NULL." );
+	}
+	if ( ( first_span == (char **) NULL )
+	  || ( first_span_length == (unsigned long *) NULL )
+	  || ( second_span == (char **) NULL )
+	  || ( second_span_length == (unsigned long *) NULL ) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the span pointers passed was NULL." );
 	}
 
-	buffer->bytes_read += num_bytes_to_increment;
+	mx_status = mxp_circular_buffer_lock( buffer, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-	/* Unlock the mutex */
+	bytes_read = buffer->bytes_read;
 
-	mx_status_code = mx_mutex_unlock( buffer->mutex );
+	num_bytes_in_use = MXP_LOAD_ACQUIRE( &(buffer->bytes_written) )
+				- bytes_read;
 
-	if ( mx_status_code != MXE_SUCCESS ) {
-		return mx_error( mx_status_code, fname,
-		"The attempt to unlock MX_CIRCULAR_BUFFER %p failed.",
-			buffer );
+	if ( num_bytes_in_use > buffer->buffer_size ) {
+		num_bytes_in_use = buffer->buffer_size;
 	}
 
-	return MX_SUCCESSFUL_RESULT;
+	mxp_circular_buffer_find_spans( buffer, bytes_read, num_bytes_in_use,
+					first_span, first_span_length,
+					second_span, second_span_length );
+
+	return mxp_circular_buffer_unlock( buffer, fname );
 }
 
 MX_EXPORT mx_status_type
-mx_circular_buffer_discard_available_bytes( MX_CIRCULAR_BUFFER *buffer )
+mx_circular_buffer_get_write_spans( MX_CIRCULAR_BUFFER *buffer,
+				char **first_span,
+				unsigned long *first_span_length,
+				char **second_span,
+				unsigned long *second_span_length )
 {
-	static const char fname[] =
-		"mx_circular_buffer_discard_available_bytes()";
+	static const char fname[] = "mx_circular_buffer_get_write_spans()";
 
-	long mx_status_code;
+	unsigned long bytes_written, num_bytes_in_use, num_unused_bytes;
+	mx_status_type mx_status;
 
 	if ( buffer == (MX_CIRCULAR_BUFFER *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
 		"The MX_CIRCULAR_BUFFER pointer passed was NULL." );
 	}
+	if ( ( first_span == (char **) NULL )
+	  || ( first_span_length == (unsigned long *) NULL )
+	  || ( second_span == (char **) NULL )
+	  || ( second_span_length == (unsigned long *) NULL ) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the span pointers passed was NULL." );
+	}
 
-	/* Lock the mutex */
+	mx_status = mxp_circular_buffer_lock( buffer, fname );
 
-	mx_status_code = mx_mutex_lock( buffer->mutex );
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-	if ( mx_status_code != MXE_SUCCESS ) {
-		return mx_error( mx_status_code, fname,
-		"The attempt to lock MX_CIRCULAR_BUFFER %p failed.",
-			buffer );
+	bytes_written = buffer->bytes_written;
+
+	num_bytes_in_use = bytes_written
+				- MXP_LOAD_ACQUIRE( &(buffer->bytes_read) );
+
+	if ( num_bytes_in_use > buffer->buffer_size ) {
+		num_unused_bytes = 0;
+	} else {
+		num_unused_bytes = buffer->buffer_size - num_bytes_in_use;
 	}
 
-	/* All we need to do here is to declare all of the unread bytes
-	 * as read.
-	 */
+	mxp_circular_buffer_find_spans( buffer,
+					bytes_written, num_unused_bytes,
+					first_span, first_span_length,
+					second_span, second_span_length );
 
-	buffer->bytes_written = buffer->bytes_read;
+	return mxp_circular_buffer_unlock( buffer, fname );
+}
 
-	/* Unlock the mutex */
+MX_EXPORT mx_status_type
+mx_circular_buffer_increment_bytes_written( MX_CIRCULAR_BUFFER *buffer,
+					unsigned long num_bytes_to_increment )
+{
+	static const char fname[] =
+		"mx_circular_buffer_increment_bytes_written()";
 
-	mx_status_code = mx_mutex_unlock( buffer->mutex );
+	unsigned long bytes_written, num_bytes_in_use;
+	mx_status_type mx_status;
 
-	if ( mx_status_code != MXE_SUCCESS ) {
-		return mx_error( mx_status_code, fname,
-		"The attempt to unlock MX_CIRCULAR_BUFFER %p failed.",
-			buffer );
+	if ( buffer == (MX_CIRCULAR_BUFFER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_CIRCULAR_BUFFER pointer passed was NULL." );
 	}
 
-	return MX_SUCCESSFUL_RESULT;
+	mx_status = mxp_circular_buffer_lock( buffer, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	bytes_written = buffer->bytes_written;
+
+	num_bytes_in_use = bytes_written
+				- MXP_LOAD_ACQUIRE( &(buffer->bytes_read) );
+
+	if ( ( num_bytes_in_use > buffer->buffer_size )
+	  || ( num_bytes_to_increment
+			> ( buffer->buffer_size - num_bytes_in_use ) ) )
+	{
+		(void) mxp_circular_buffer_unlock( buffer, fname );
+
+		return mx_error( MXE_LIMIT_WAS_EXCEEDED, fname,
+		"Cannot mark %lu bytes as written to MX_CIRCULAR_BUFFER %p, "
+		"since only %lu bytes of the %lu byte buffer are unused.",
+			num_bytes_to_increment, buffer,
+			buffer->buffer_size - num_bytes_in_use,
+			buffer->buffer_size );
+	}
+
+	MXP_STORE_RELEASE( &(buffer->bytes_written),
+				bytes_written + num_bytes_to_increment );
+
+	return mxp_circular_buffer_unlock( buffer, fname );
 }
 
@@ -7,7 +7,7 @@
  *
  *-------------------------------------------------------------------------
  *
- * Copyright 2012-2013 Illinois Institute of Technology
+ * Copyright 2012-2013, 2026 Illinois Institute of Technology
  *
  * See the file "LICENSE" for information on usage and redistribution
  * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
@@ -32,8 +32,18 @@ extern "C" {
  *       even in the presence of wraparound at ULONG_MAX.
  */
 
+/* If MXF_CIRCULAR_BUFFER_SPSC is set, the buffer is only ever written by
+ * one thread and read by one thread (which may be the same thread).  In
+ * that case, no mutex is used.  The writer only changes 'bytes_written'
+ * and the reader only changes 'bytes_read', and each of them is published
+ * to the other side with release and acquire memory ordering.
+ */
+
+#define MXF_CIRCULAR_BUFFER_SPSC	0x1
+
 typedef struct {
 	MX_MUTEX *mutex;
+	unsigned long flags;
 	unsigned long buffer_size;
 	unsigned long bytes_read;
 	unsigned long bytes_written;
@@ -43,6 +53,11 @@ typedef struct {
 MX_API mx_status_type mx_circular_buffer_create( MX_CIRCULAR_BUFFER **buffer,
 						unsigned long buffer_size );
 
+MX_API mx_status_type mx_circular_buffer_create_with_flags(
+					MX_CIRCULAR_BUFFER **buffer,
+					unsigned long buffer_size,
+					unsigned long flags );
+
 MX_API mx_status_type mx_circular_buffer_destroy( MX_CIRCULAR_BUFFER *buffer );
 
 MX_API mx_status_type mx_circular_buffer_read( MX_CIRCULAR_BUFFER *buffer,
@@ -70,7 +85,38 @@ MX_API mx_status_type mx_circular_buffer_increment_bytes_read(
 
 MX_API mx_status_type mx_circular_buffer_discard_available_bytes(
 					MX_CIRCULAR_BUFFER *buffer );
-						
+
+/* The span functions give direct access to the data array, so that data
+ * can be parsed in place or received straight into the buffer without
+ * an extra copy.  The bytes that can be read, or the free space that can
+ * be written, are returned as two spans, since they may wrap around the
+ * end of the data array.  The second span has a length of 0 if they do
+ * not wrap.
+ *
+ * After reading from the read spans, the reader must call
+ * mx_circular_buffer_increment_bytes_read() to release the bytes.
+ * After writing to the write spans, the writer must call
+ * mx_circular_buffer_increment_bytes_written() to make the bytes
+ * visible to the reader.
+ */
+
+MX_API mx_status_type mx_circular_buffer_get_read_spans(
+					MX_CIRCULAR_BUFFER *buffer,
+					char **first_span,
+					unsigned long *first_span_length,
+					char **second_span,
+					unsigned long *second_span_length );
+
+MX_API mx_status_type mx_circular_buffer_get_write_spans(
+					MX_CIRCULAR_BUFFER *buffer,
+					char **first_span,
+					unsigned long *first_span_length,
+					char **second_span,
+					unsigned long *second_span_length );
+
+MX_API mx_status_type mx_circular_buffer_increment_bytes_written(
+					MX_CIRCULAR_BUFFER *buffer,
+					unsigned long num_bytes_to_increment );
 
 #ifdef __cplusplus
 }
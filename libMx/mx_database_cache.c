@@ -0,0 +1,1518 @@
+/*
+ * Name:    mx_database_cache.c
+ *
+ * Purpose: Binary cache of the parsed contents of an MX database file.
+ *
+ *          A cache file consists of an MXP_DATABASE_CACHE_HEADER, a table
+ *          of the drivers used by the cached records and then a sequence
+ *          of entries.  Each entry starts with a one byte entry type:
+ *
+ *            'D' - a directive line, stored as a string.
+ *            'R' - a record, stored as its driver table index, superclass,
+ *                  class and name, followed by the length of its field
+ *                  values and the values of the fields in the record
+ *                  description.
+ *            'E' - the end of the cache.
+ *
+ *          Strings are stored as a 32-bit length, followed by the
+ *          characters and a terminating null byte.  All other values are
+ *          stored in the native format of the machine that wrote them,
+ *          so a cache can only be used on the same kind of machine.
+ *
+ *          The whole cache is checked before any of it is used, since
+ *          directives such as '!load' cannot be undone if loading the
+ *          cache fails part way through.
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#define MX_DATABASE_CACHE_DEBUG		FALSE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mx_osdef.h"
+
+#if defined(OS_UNIX)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "mx_util.h"
+#include "mx_stdint.h"
+#include "mx_record.h"
+#include "mx_driver.h"
+#include "mx_array.h"
+#include "mx_database_cache.h"
+
+#define MXP_DATABASE_CACHE_MAGIC	"MXDBCACH"
+
+#define MXP_DATABASE_CACHE_VERSION	2
+
+#define MXP_DATABASE_CACHE_BYTE_ORDER	0x01020304UL
+
+#define MXP_DATABASE_CACHE_DIRECTIVE	'D'
+#define MXP_DATABASE_CACHE_RECORD	'R'
+#define MXP_DATABASE_CACHE_END		'E'
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t sizeof_long;
+	uint32_t sizeof_pointer;
+	uint64_t database_size;
+	uint64_t database_mtime;
+	uint64_t database_hash;
+	uint64_t cache_length;
+	uint64_t cache_hash;		/* Hash of everything after the header. */
+	uint32_t num_drivers;
+	uint32_t reserved;
+} MXP_DATABASE_CACHE_HEADER;
+
+/* The contents of a file, either memory mapped or read into memory. */
+
+typedef struct {
+	char *data;
+	size_t length;
+	uint64_t mtime;
+	mx_bool_type is_mapped;
+} MXP_DATABASE_CACHE_FILE;
+
+typedef struct {
+	char *data;
+	size_t length;
+	size_t allocated_length;
+	mx_bool_type failed;
+} MXP_DATABASE_CACHE_BUFFER;
+
+typedef struct {
+	const char *data;
+	size_t length;
+	size_t offset;
+	MX_RECORD_FIELD_PARSE_STATUS parse_status;
+} MXP_DATABASE_CACHE_READER;
+
+struct mx_database_cache_writer_type {
+	char cache_filename[MXU_FILENAME_LENGTH+1];
+	MXP_DATABASE_CACHE_HEADER header;
+	mx_bool_type abandoned;
+
+	long num_drivers;
+	long max_drivers;
+	MX_DRIVER **driver_array;
+
+	MXP_DATABASE_CACHE_BUFFER driver_buffer;
+	MXP_DATABASE_CACHE_BUFFER entry_buffer;
+};
+
+typedef mx_status_type MXP_DATABASE_CACHE_LEAF_FUNCTION( MX_RECORD *,
+					MX_RECORD_FIELD *, void *, void * );
+
+/*-------------------------------------------------------------------------*/
+
+/* 64-bit FNV-1a hash. */
+
+#define MXP_DATABASE_CACHE_HASH_SEED	0xcbf29ce484222325ULL
+
+static uint64_t
+mxp_database_cache_hash( uint64_t hash, const void *data, size_t length )
+{
+	const unsigned char *ptr;
+	size_t i;
+
+	ptr = (const unsigned char *) data;
+
+	for ( i = 0; i < length; i++ ) {
+		hash ^= ptr[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+/* The signature of a driver covers everything about its record fields
+ * that the layout of the cached field values depends on.  If a driver is
+ * changed in a way that matters, its signature changes and old caches
+ * that use it are ignored.
+ */
+
+static uint64_t
+mxp_database_cache_driver_signature( MX_DRIVER *driver )
+{
+	MX_RECORD_FIELD_DEFAULTS *defaults_array, *defaults;
+	uint64_t hash;
+	long i, num_fields, num_dimensions;
+
+	hash = mxp_database_cache_hash( MXP_DATABASE_CACHE_HASH_SEED,
+					driver->name, strlen( driver->name ) );
+
+	hash = mxp_database_cache_hash( hash, &(driver->mx_type),
+					sizeof(driver->mx_type) );
+	hash = mxp_database_cache_hash( hash, &(driver->mx_class),
+					sizeof(driver->mx_class) );
+	hash = mxp_database_cache_hash( hash, &(driver->mx_superclass),
+					sizeof(driver->mx_superclass) );
+
+	if ( ( driver->num_record_fields == NULL )
+	  || ( driver->record_field_defaults_ptr == NULL ) )
+	{
+		return hash;
+	}
+
+	num_fields = *(driver->num_record_fields);
+	defaults_array = *(driver->record_field_defaults_ptr);
+
+	hash = mxp_database_cache_hash( hash, &num_fields, sizeof(num_fields) );
+
+	for ( i = 0; i < num_fields; i++ ) {
+		defaults = &defaults_array[i];
+
+		hash = mxp_database_cache_hash( hash, defaults->name,
+						strlen( defaults->name ) );
+
+		hash = mxp_database_cache_hash( hash, &(defaults->datatype),
+						sizeof(defaults->datatype) );
+		hash = mxp_database_cache_hash( hash, &(defaults->flags),
+						sizeof(defaults->flags) );
+		hash = mxp_database_cache_hash( hash,
+					&(defaults->structure_id),
+					sizeof(defaults->structure_id) );
+		hash = mxp_database_cache_hash( hash,
+					&(defaults->structure_offset),
+					sizeof(defaults->structure_offset) );
+
+		num_dimensions = defaults->num_dimensions;
+
+		if ( num_dimensions > MXU_FIELD_MAX_DIMENSIONS ) {
+			num_dimensions = MXU_FIELD_MAX_DIMENSIONS;
+		}
+
+		hash = mxp_database_cache_hash( hash, &num_dimensions,
+						sizeof(num_dimensions) );
+
+		if ( num_dimensions > 0 ) {
+			hash = mxp_database_cache_hash( hash,
+				defaults->dimension,
+				num_dimensions * sizeof(long) );
+			hash = mxp_database_cache_hash( hash,
+				defaults->data_element_size,
+				num_dimensions * sizeof(size_t) );
+		}
+	}
+
+	return hash;
+}
+
+/*-------------------------------------------------------------------------*/
+
+static mx_bool_type
+mxp_database_cache_map_file( const char *filename,
+				MXP_DATABASE_CACHE_FILE *file )
+{
+	struct stat stat_buf;
+
+	memset( file, 0, sizeof(MXP_DATABASE_CACHE_FILE) );
+
+#if defined(OS_UNIX)
+	{
+		void *address;
+		int fd;
+
+		fd = open( filename, O_RDONLY );
+
+		if ( fd < 0 )
+			return FALSE;
+
+		if ( ( fstat( fd, &stat_buf ) != 0 )
+		  || ( stat_buf.st_size <= 0 ) )
+		{
+			close( fd );
+			return FALSE;
+		}
+
+		file->length = (size_t) stat_buf.st_size;
+
+		address = mmap( NULL, file->length,
+				PROT_READ, MAP_PRIVATE, fd, 0 );
+
+		close( fd );
+
+		if ( address == MAP_FAILED )
+			return FALSE;
+
+		file->data = (char *) address;
+		file->is_mapped = TRUE;
+	}
+#else
+	{
+		FILE *stream;
+		size_t bytes_read;
+
+		if ( ( stat( filename, &stat_buf ) != 0 )
+		  || ( stat_buf.st_size <= 0 ) )
+		{
+			return FALSE;
+		}
+
+		file->length = (size_t) stat_buf.st_size;
+
+		file->data = (char *) malloc( file->length );
+
+		if ( file->data == (char *) NULL )
+			return FALSE;
+
+		stream = fopen( filename, "rb" );
+
+		if ( stream == (FILE *) NULL ) {
+			mx_free( file->data );
+			return FALSE;
+		}
+
+		bytes_read = fread( file->data, 1, file->length, stream );
+
+		fclose( stream );
+
+		if ( bytes_read != file->length ) {
+			mx_free( file->data );
+			return FALSE;
+		}
+
+		file->is_mapped = FALSE;
+	}
+#endif
+
+	file->mtime = (uint64_t) stat_buf.st_mtime;
+
+	return TRUE;
+}
+
+static void
+mxp_database_cache_unmap_file( MXP_DATABASE_CACHE_FILE *file )
+{
+	if ( file->data == (char *) NULL )
+		return;
+
+#if defined(OS_UNIX)
+	if ( file->is_mapped ) {
+		(void) munmap( file->data, file->length );
+	} else {
+		mx_free( file->data );
+	}
+#else
+	mx_free( file->data );
+#endif
+
+	file->data = NULL;
+}
+
+/* Fills in the database file part of a cache header. */
+
+static mx_bool_type
+mxp_database_cache_describe_database( const char *database_filename,
+				MXP_DATABASE_CACHE_HEADER *header )
+{
+	MXP_DATABASE_CACHE_FILE database_file;
+
+	if ( mxp_database_cache_map_file( database_filename,
+					&database_file ) == FALSE )
+	{
+		return FALSE;
+	}
+
+	header->database_size = database_file.length;
+	header->database_mtime = database_file.mtime;
+	header->database_hash = mxp_database_cache_hash(
+					MXP_DATABASE_CACHE_HASH_SEED,
+					database_file.data,
+					database_file.length );
+
+	mxp_database_cache_unmap_file( &database_file );
+
+	return TRUE;
+}
+
+static void
+mxp_database_cache_initialize_header( MXP_DATABASE_CACHE_HEADER *header )
+{
+	memset( header, 0, sizeof(MXP_DATABASE_CACHE_HEADER) );
+
+	memcpy( header->magic, MXP_DATABASE_CACHE_MAGIC,
+					sizeof(header->magic) );
+
+	header->version = MXP_DATABASE_CACHE_VERSION;
+	header->byte_order = MXP_DATABASE_CACHE_BYTE_ORDER;
+	header->sizeof_long = sizeof(long);
+	header->sizeof_pointer = sizeof(void *);
+}
+
+static mx_bool_type
+mxp_database_cache_get_cache_filename( const char *database_filename,
+				char *cache_filename, size_t max_length )
+{
+	int length;
+
+	length = snprintf( cache_filename, max_length, "%s%s",
+				database_filename, MX_DATABASE_CACHE_SUFFIX );
+
+	if ( ( length < 0 ) || ( length >= (int) max_length ) )
+		return FALSE;
+
+	return TRUE;
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* The field walker visits the values of a record field in the same order
+ * that mx_parse_record_field_tokens() and mx_parse_array_description()
+ * consume the tokens of a text record description, so the leaf function
+ * sees exactly one call per token.
+ */
+
+static mx_status_type
+mxp_database_cache_walk_array( MX_RECORD *record,
+				MX_RECORD_FIELD *field,
+				void *array_ptr,
+				long dimension_level,
+				MXP_DATABASE_CACHE_LEAF_FUNCTION *leaf_function,
+				void *leaf_arguments )
+{
+	static const char fname[] = "mxp_database_cache_walk_array()";
+
+	char *row_ptr;
+	void *subarray_ptr;
+	long i, n, num_elements;
+	size_t step_size;
+	mx_status_type mx_status;
+
+	n = field->num_dimensions - dimension_level - 1;
+
+	num_elements = field->dimension[n];
+
+	if ( num_elements < 0 ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE | MXE_QUIET, fname,
+		"Field '%s.%s' has a negative dimension %ld.",
+			record->name, field->name, num_elements );
+	}
+
+	if ( num_elements == 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	if ( array_ptr == NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE | MXE_QUIET, fname,
+		"The array for field '%s.%s' has not been allocated.",
+			record->name, field->name );
+	}
+
+	if ( dimension_level == 0 ) {
+		if ( field->datatype == MXFT_STRING ) {
+			return (*leaf_function)( record, field,
+						array_ptr, leaf_arguments );
+		}
+
+		row_ptr = (char *) array_ptr;
+
+		for ( i = 0; i < num_elements; i++ ) {
+			mx_status = (*leaf_function)( record, field,
+						row_ptr, leaf_arguments );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+
+			row_ptr += field->data_element_size[0];
+		}
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	if ( field->flags & MXFF_VARARGS ) {
+		step_size = field->data_element_size[ dimension_level ];
+	} else {
+		step_size = field->data_element_size[0];
+
+		for ( i = field->num_dimensions - 1;
+		    i >= ( field->num_dimensions - dimension_level ); i-- )
+		{
+			step_size *= field->dimension[i];
+		}
+	}
+
+	row_ptr = (char *) array_ptr;
+
+	for ( i = 0; i < num_elements; i++ ) {
+		if ( field->flags & MXFF_VARARGS ) {
+			subarray_ptr =
+			    mx_read_void_pointer_from_memory_location( row_ptr );
+		} else {
+			subarray_ptr = row_ptr;
+		}
+
+		mx_status = mxp_database_cache_walk_array( record, field,
+					subarray_ptr, dimension_level - 1,
+					leaf_function, leaf_arguments );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		row_ptr += step_size;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+static mx_status_type
+mxp_database_cache_walk_field( MX_RECORD *record,
+				MX_RECORD_FIELD *field,
+				void *field_value_ptr,
+				MXP_DATABASE_CACHE_LEAF_FUNCTION *leaf_function,
+				void *leaf_arguments )
+{
+	mx_status_type mx_status;
+
+	if ( ( field->num_dimensions == 0 )
+	  || ( ( field->datatype == MXFT_STRING )
+	    && ( field->num_dimensions == 1 ) ) )
+	{
+		mx_status = (*leaf_function)( record, field,
+					field_value_ptr, leaf_arguments );
+	} else {
+		mx_status = mxp_database_cache_walk_array( record, field,
+					field_value_ptr,
+					field->num_dimensions - 1,
+					leaf_function, leaf_arguments );
+	}
+
+	return mx_status;
+}
+
+/* Returns the number of bytes in a value of a numeric field type,
+ * or zero for the other field types.
+ */
+
+static size_t
+mxp_database_cache_numeric_size( long datatype )
+{
+	switch( datatype ) {
+	case MXFT_CHAR:
+	case MXFT_UCHAR:
+	case MXFT_INT8:
+	case MXFT_UINT8:
+	case MXFT_SHORT:
+	case MXFT_USHORT:
+	case MXFT_INT16:
+	case MXFT_UINT16:
+	case MXFT_BOOL:
+	case MXFT_INT32:
+	case MXFT_UINT32:
+	case MXFT_LONG:
+	case MXFT_ULONG:
+	case MXFT_INT64:
+	case MXFT_UINT64:
+	case MXFT_FLOAT:
+	case MXFT_DOUBLE:
+	case MXFT_HEX:
+		return mx_get_scalar_element_size( datatype,
+						( sizeof(long) == 8 ) );
+	default:
+		return 0;
+	}
+}
+
+/*-------------------------------------------------------------------------*/
+
+static void
+mxp_database_cache_put( MXP_DATABASE_CACHE_BUFFER *buffer,
+			const void *data, size_t length )
+{
+	size_t new_length;
+	char *new_data;
+
+	if ( buffer->failed )
+		return;
+
+	if ( ( buffer->length + length ) > buffer->allocated_length ) {
+		new_length = 2 * buffer->allocated_length;
+
+		if ( new_length < 65536 ) {
+			new_length = 65536;
+		}
+
+		while ( new_length < ( buffer->length + length ) ) {
+			new_length *= 2;
+		}
+
+		new_data = (char *) realloc( buffer->data, new_length );
+
+		if ( new_data == (char *) NULL ) {
+			buffer->failed = TRUE;
+			return;
+		}
+
+		buffer->data = new_data;
+		buffer->allocated_length = new_length;
+	}
+
+	memcpy( buffer->data + buffer->length, data, length );
+
+	buffer->length += length;
+}
+
+static void
+mxp_database_cache_put_uint8( MXP_DATABASE_CACHE_BUFFER *buffer,
+				uint8_t value )
+{
+	mxp_database_cache_put( buffer, &value, sizeof(value) );
+}
+
+static void
+mxp_database_cache_put_uint32( MXP_DATABASE_CACHE_BUFFER *buffer,
+				uint32_t value )
+{
+	mxp_database_cache_put( buffer, &value, sizeof(value) );
+}
+
+static void
+mxp_database_cache_put_string( MXP_DATABASE_CACHE_BUFFER *buffer,
+				const char *string, size_t length )
+{
+	mxp_database_cache_put_uint32( buffer, (uint32_t) length );
+	mxp_database_cache_put( buffer, string, length );
+	mxp_database_cache_put_uint8( buffer, 0 );
+}
+
+static mx_status_type
+mxp_database_cache_save_leaf( MX_RECORD *record,
+				MX_RECORD_FIELD *field,
+				void *value_ptr,
+				void *leaf_arguments )
+{
+	static const char fname[] = "mxp_database_cache_save_leaf()";
+
+	MXP_DATABASE_CACHE_BUFFER *buffer;
+	MX_RECORD *referenced_record;
+	MX_RECORD_FIELD *referenced_field;
+	MX_INTERFACE *interface;
+	char token[MXU_BUFFER_LENGTH+1];
+	const char *end_of_string;
+	size_t length;
+
+	buffer = (MXP_DATABASE_CACHE_BUFFER *) leaf_arguments;
+
+	switch( field->datatype ) {
+	case MXFT_STRING:
+		length = mx_get_max_string_token_length( field );
+
+		end_of_string = memchr( value_ptr, '\0', length );
+
+		if ( end_of_string == NULL ) {
+			return mx_error( MXE_CORRUPT_DATA_STRUCTURE | MXE_QUIET,
+			fname, "String field '%s.%s' is not null terminated.",
+				record->name, field->name );
+		}
+
+		mxp_database_cache_put_string( buffer, (char *) value_ptr,
+					end_of_string - (char *) value_ptr );
+		break;
+
+	case MXFT_RECORD:
+		referenced_record = (MX_RECORD *)
+			mx_read_void_pointer_from_memory_location( value_ptr );
+
+		if ( referenced_record == (MX_RECORD *) NULL ) {
+			return mx_error( MXE_NOT_FOUND | MXE_QUIET, fname,
+			"Record field '%s.%s' does not point to a record.",
+				record->name, field->name );
+		}
+
+		mxp_database_cache_put_string( buffer, referenced_record->name,
+					strlen( referenced_record->name ) );
+		break;
+
+	case MXFT_INTERFACE:
+		interface = (MX_INTERFACE *) value_ptr;
+
+		if ( interface->record == (MX_RECORD *) NULL ) {
+			return mx_error( MXE_NOT_FOUND | MXE_QUIET, fname,
+			"Interface field '%s.%s' does not point to a record.",
+				record->name, field->name );
+		}
+
+		if ( strlen( interface->address_name ) > 0 ) {
+			snprintf( token, sizeof(token), "%s:%s",
+				interface->record->name,
+				interface->address_name );
+		} else {
+			strlcpy( token, interface->record->name,
+						sizeof(token) );
+		}
+
+		mxp_database_cache_put_string( buffer, token, strlen(token) );
+		break;
+
+	case MXFT_RECORD_FIELD:
+		referenced_field = (MX_RECORD_FIELD *)
+			mx_read_void_pointer_from_memory_location( value_ptr );
+
+		if ( ( referenced_field == (MX_RECORD_FIELD *) NULL )
+		  || ( referenced_field->record == (MX_RECORD *) NULL ) )
+		{
+			return mx_error( MXE_NOT_FOUND | MXE_QUIET, fname,
+		"Record field field '%s.%s' does not point to a record field.",
+				record->name, field->name );
+		}
+
+		snprintf( token, sizeof(token), "%s.%s",
+			referenced_field->record->name,
+			referenced_field->name );
+
+		mxp_database_cache_put_string( buffer, token, strlen(token) );
+		break;
+
+	default:
+		length = mxp_database_cache_numeric_size( field->datatype );
+
+		if ( length == 0 ) {
+			return mx_error( MXE_UNSUPPORTED | MXE_QUIET, fname,
+			"Field '%s.%s' of type %ld cannot be cached.",
+				record->name, field->name, field->datatype );
+		}
+
+		mxp_database_cache_put( buffer, value_ptr, length );
+		break;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+static mx_bool_type
+mxp_database_cache_get( MXP_DATABASE_CACHE_READER *reader,
+			void *value, size_t length )
+{
+	if ( length > ( reader->length - reader->offset ) )
+		return FALSE;
+
+	memcpy( value, reader->data + reader->offset, length );
+
+	reader->offset += length;
+
+	return TRUE;
+}
+
+/* Returns a pointer to the string in the cache itself. */
+
+static mx_bool_type
+mxp_database_cache_get_string( MXP_DATABASE_CACHE_READER *reader,
+				const char **string, size_t *string_length )
+{
+	uint32_t length;
+
+	if ( mxp_database_cache_get( reader, &length, sizeof(length) ) == FALSE )
+		return FALSE;
+
+	if ( ( (size_t) length + 1 ) > ( reader->length - reader->offset ) )
+		return FALSE;
+
+	*string = reader->data + reader->offset;
+
+	if ( (*string)[length] != '\0' )
+		return FALSE;
+
+	*string_length = length;
+
+	reader->offset += (size_t) length + 1;
+
+	return TRUE;
+}
+
+static mx_status_type
+mxp_database_cache_load_leaf( MX_RECORD *record,
+				MX_RECORD_FIELD *field,
+				void *value_ptr,
+				void *leaf_arguments )
+{
+	static const char fname[] = "mxp_database_cache_load_leaf()";
+
+	MXP_DATABASE_CACHE_READER *reader;
+	mx_status_type (*token_parser)( void *, char *, MX_RECORD *,
+			MX_RECORD_FIELD *, MX_RECORD_FIELD_PARSE_STATUS * );
+	char token[MXU_BUFFER_LENGTH+1];
+	const char *string;
+	size_t length;
+	mx_status_type mx_status;
+
+	reader = (MXP_DATABASE_CACHE_READER *) leaf_arguments;
+
+	switch( field->datatype ) {
+	case MXFT_STRING:
+		if ( mxp_database_cache_get_string( reader,
+					&string, &length ) == FALSE )
+		{
+			break;
+		}
+
+		strlcpy( (char *) value_ptr, string,
+				mx_get_max_string_token_length( field ) );
+
+		return MX_SUCCESSFUL_RESULT;
+
+	case MXFT_RECORD:
+	case MXFT_INTERFACE:
+	case MXFT_RECORD_FIELD:
+		if ( mxp_database_cache_get_string( reader,
+					&string, &length ) == FALSE )
+		{
+			break;
+		}
+
+		if ( length >= sizeof(token) )
+			break;
+
+		/* The token parsers may modify the token,
+		 * so we give them a copy.
+		 */
+
+		memcpy( token, string, length + 1 );
+
+		mx_status = mx_get_token_parser( field->datatype,
+							&token_parser );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		mx_status = (*token_parser)( value_ptr, token,
+					record, field, &(reader->parse_status) );
+
+		return mx_status;
+
+	default:
+		length = mxp_database_cache_numeric_size( field->datatype );
+
+		if ( length == 0 )
+			break;
+
+		if ( mxp_database_cache_get( reader, value_ptr, length ) )
+			return MX_SUCCESSFUL_RESULT;
+
+		break;
+	}
+
+	return mx_error( MXE_FILE_IO_ERROR | MXE_QUIET, fname,
+		"The cached value of field '%s.%s' is corrupt.",
+			record->name, field->name );
+}
+
+/* mxp_database_cache_load_field_value() is the MX_RECORD_FIELD_VALUE_LOADER
+ * passed to mx_create_record_from_driver().
+ */
+
+static mx_status_type
+mxp_database_cache_load_field_value( MX_RECORD *record,
+				MX_RECORD_FIELD *field,
+				void *field_value_ptr,
+				void *loader_arguments )
+{
+	mx_status_type mx_status;
+
+	mx_status = mxp_database_cache_walk_field( record, field,
+				field_value_ptr, mxp_database_cache_load_leaf,
+				loader_arguments );
+
+	return mx_status;
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* Checks that the entries of a cache are well formed and end with an end
+ * marker, without doing anything with them.  The values of the record
+ * fields can only be checked while the records are created, but they are
+ * protected by the cache hash and the driver signatures.
+ */
+
+static mx_bool_type
+mxp_database_cache_validate_entries( MXP_DATABASE_CACHE_READER *reader,
+					uint32_t num_drivers )
+{
+	uint8_t entry_type;
+	uint32_t driver_index, values_length;
+	int32_t record_superclass, record_class;
+	const char *string;
+	size_t length;
+
+	for (;;) {
+		if ( mxp_database_cache_get( reader,
+				&entry_type, sizeof(entry_type) ) == FALSE )
+		{
+			return FALSE;
+		}
+
+		switch( entry_type ) {
+		case MXP_DATABASE_CACHE_END:
+			return ( reader->offset == reader->length );
+
+		case MXP_DATABASE_CACHE_DIRECTIVE:
+			if ( ( mxp_database_cache_get_string( reader,
+					&string, &length ) == FALSE )
+			  || ( length > MXU_RECORD_DESCRIPTION_LENGTH ) )
+			{
+				return FALSE;
+			}
+			break;
+
+		case MXP_DATABASE_CACHE_RECORD:
+			if ( ( mxp_database_cache_get( reader, &driver_index,
+					sizeof(driver_index) ) == FALSE )
+			  || ( mxp_database_cache_get( reader,
+					&record_superclass,
+					sizeof(record_superclass) ) == FALSE )
+			  || ( mxp_database_cache_get( reader, &record_class,
+					sizeof(record_class) ) == FALSE )
+			  || ( mxp_database_cache_get_string( reader,
+					&string, &length ) == FALSE )
+			  || ( mxp_database_cache_get( reader, &values_length,
+					sizeof(values_length) ) == FALSE )
+			  || ( driver_index >= num_drivers )
+			  || ( length >= MXU_RECORD_NAME_LENGTH )
+			  || ( values_length > ( reader->length
+						- reader->offset ) ) )
+			{
+				return FALSE;
+			}
+
+			reader->offset += values_length;
+			break;
+
+		default:
+			return FALSE;
+		}
+	}
+}
+
+/* Reads the entries of a validated cache into the record list.
+ * 'directives_replayed' is set to TRUE once a directive has been run.
+ */
+
+static mx_status_type
+mxp_database_cache_load_entries( MX_RECORD *record_list,
+				MXP_DATABASE_CACHE_READER *reader,
+				MX_DRIVER **driver_array,
+				uint32_t num_drivers,
+				unsigned long flags,
+				mx_bool_type *directives_replayed )
+{
+	static const char fname[] = "mxp_database_cache_load_entries()";
+
+	MX_RECORD *created_record;
+	MX_DRIVER *driver;
+	uint8_t entry_type;
+	uint32_t driver_index, values_length;
+	size_t values_end;
+	int32_t record_superclass, record_class;
+	const char *string;
+	size_t length;
+	mx_bool_type return_requested;
+	char directive[MXU_RECORD_DESCRIPTION_LENGTH+1];
+	mx_status_type mx_status;
+
+	for (;;) {
+		if ( mxp_database_cache_get( reader,
+				&entry_type, sizeof(entry_type) ) == FALSE )
+		{
+			break;
+		}
+
+		switch( entry_type ) {
+		case MXP_DATABASE_CACHE_END:
+			return MX_SUCCESSFUL_RESULT;
+
+		case MXP_DATABASE_CACHE_DIRECTIVE:
+			if ( mxp_database_cache_get_string( reader,
+					&string, &length ) == FALSE )
+			{
+				break;
+			}
+
+			if ( length >= sizeof(directive) )
+				break;
+
+			memcpy( directive, string, length + 1 );
+
+			*directives_replayed = TRUE;
+
+			mx_status = mx_process_database_directive( record_list,
+					directive, flags, &return_requested );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+
+			if ( return_requested )
+				return MX_SUCCESSFUL_RESULT;
+
+			continue;
+
+		case MXP_DATABASE_CACHE_RECORD:
+			if ( ( mxp_database_cache_get( reader, &driver_index,
+					sizeof(driver_index) ) == FALSE )
+			  || ( mxp_database_cache_get( reader,
+					&record_superclass,
+					sizeof(record_superclass) ) == FALSE )
+			  || ( mxp_database_cache_get( reader, &record_class,
+					sizeof(record_class) ) == FALSE )
+			  || ( mxp_database_cache_get_string( reader,
+					&string, &length ) == FALSE )
+			  || ( mxp_database_cache_get( reader, &values_length,
+					sizeof(values_length) ) == FALSE )
+			  || ( driver_index >= num_drivers )
+			  || ( length >= MXU_RECORD_NAME_LENGTH ) )
+			{
+				break;
+			}
+
+			values_end = reader->offset + values_length;
+
+			driver = driver_array[ driver_index ];
+
+			mx_status = mx_create_record_from_driver( record_list,
+					string, record_superclass, record_class,
+					driver, NULL, flags,
+					mxp_database_cache_load_field_value,
+					reader, &created_record );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+
+			if ( reader->offset != values_end )
+				break;
+
+			continue;
+
+		default:
+			break;
+		}
+
+		break;
+	}
+
+	return mx_error( MXE_FILE_IO_ERROR | MXE_QUIET, fname,
+		"The database cache is corrupt at offset %lu.",
+			(unsigned long) reader->offset );
+}
+
+MX_EXPORT mx_status_type
+mx_database_cache_load( MX_RECORD *record_list,
+			const char *database_filename,
+			unsigned long flags,
+			mx_bool_type *cache_was_loaded )
+{
+	static const char fname[] = "mx_database_cache_load()";
+
+	MXP_DATABASE_CACHE_FILE cache_file;
+	MXP_DATABASE_CACHE_HEADER header, expected_header;
+	MXP_DATABASE_CACHE_READER reader;
+	MX_RECORD *last_old_record;
+	MX_DRIVER **driver_array;
+	const char *driver_name;
+	uint64_t signature;
+	uint32_t i;
+	size_t length, entries_offset;
+	mx_bool_type directives_replayed;
+	char cache_filename[MXU_FILENAME_LENGTH+1];
+	char driver_name_buffer[MXU_DRIVER_NAME_LENGTH+1];
+	mx_status_type mx_status;
+
+	if ( ( record_list == (MX_RECORD *) NULL )
+	  || ( database_filename == (const char *) NULL )
+	  || ( cache_was_loaded == (mx_bool_type *) NULL ) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the arguments passed were NULL." );
+	}
+
+	*cache_was_loaded = FALSE;
+
+	if ( mxp_database_cache_get_cache_filename( database_filename,
+			cache_filename, sizeof(cache_filename) ) == FALSE )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	if ( mxp_database_cache_map_file( cache_filename,
+					&cache_file ) == FALSE )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	/* Is this a cache that we can use for the database file
+	 * as it is now?
+	 */
+
+	mxp_database_cache_initialize_header( &expected_header );
+
+	if ( ( cache_file.length < sizeof(header) )
+	  || ( mxp_database_cache_describe_database( database_filename,
+					&expected_header ) == FALSE ) )
+	{
+		mxp_database_cache_unmap_file( &cache_file );
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	memcpy( &header, cache_file.data, sizeof(header) );
+
+	expected_header.cache_length = cache_file.length;
+	expected_header.cache_hash = mxp_database_cache_hash(
+					MXP_DATABASE_CACHE_HASH_SEED,
+					cache_file.data + sizeof(header),
+					cache_file.length - sizeof(header) );
+	expected_header.num_drivers = header.num_drivers;
+
+	if ( memcmp( &header, &expected_header, sizeof(header) ) != 0 ) {
+
+#if MX_DATABASE_CACHE_DEBUG
+		MX_DEBUG(-2,("%s: The cache '%s' does not match '%s'.",
+			fname, cache_filename, database_filename));
+#endif
+		mxp_database_cache_unmap_file( &cache_file );
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	reader.data = cache_file.data;
+	reader.length = cache_file.length;
+	reader.offset = sizeof(header);
+
+	mx_initialize_parse_status( &(reader.parse_status), NULL, NULL );
+
+	/* Look up the drivers and check that their record fields are
+	 * laid out the same as when the cache was written.
+	 */
+
+	driver_array = (MX_DRIVER **)
+			malloc( ( header.num_drivers + 1 ) * sizeof(MX_DRIVER *) );
+
+	if ( driver_array == (MX_DRIVER **) NULL ) {
+		mxp_database_cache_unmap_file( &cache_file );
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	for ( i = 0; i < header.num_drivers; i++ ) {
+		if ( ( mxp_database_cache_get_string( &reader,
+					&driver_name, &length ) == FALSE )
+		  || ( mxp_database_cache_get( &reader,
+				&signature, sizeof(signature) ) == FALSE )
+		  || ( length >= sizeof(driver_name_buffer) ) )
+		{
+			break;
+		}
+
+		memcpy( driver_name_buffer, driver_name, length + 1 );
+
+		driver_array[i] = mx_get_driver_by_name( driver_name_buffer );
+
+		if ( driver_array[i] == (MX_DRIVER *) NULL )
+			break;
+
+		if ( signature != mxp_database_cache_driver_signature(
+							driver_array[i] ) )
+		{
+#if MX_DATABASE_CACHE_DEBUG
+			MX_DEBUG(-2,("%s: Driver '%s' has changed.",
+				fname, driver_name));
+#endif
+			break;
+		}
+	}
+
+	/* Check all of the entries before we act on any of them. */
+
+	entries_offset = reader.offset;
+
+	if ( ( i < header.num_drivers )
+	  || ( mxp_database_cache_validate_entries( &reader,
+					header.num_drivers ) == FALSE ) )
+	{
+		mx_free( driver_array );
+		mxp_database_cache_unmap_file( &cache_file );
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	reader.offset = entries_offset;
+
+	/* Now load the records.  If anything goes wrong, the records
+	 * that were loaded from the cache are deleted again, so that
+	 * the caller can parse the text database file instead.
+	 */
+
+	last_old_record = record_list->previous_record;
+
+	directives_replayed = FALSE;
+
+	mx_status = mxp_database_cache_load_entries( record_list, &reader,
+				driver_array, header.num_drivers, flags,
+				&directives_replayed );
+
+	mx_free( driver_array );
+	mxp_database_cache_unmap_file( &cache_file );
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		*cache_was_loaded = TRUE;
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	/* Parsing the text file would run the directives a second time,
+	 * so once any of them have run, the failure is returned instead.
+	 */
+
+	if ( directives_replayed ) {
+		return mx_error( mx_status.code, fname,
+		"Loading MX database cache '%s' failed after some of its "
+		"directives had been run.  Remove the cache file to make "
+		"MX parse '%s' instead.", cache_filename, database_filename );
+	}
+
+	mx_warning( "Loading MX database cache '%s' failed.  "
+		"Parsing '%s' instead.", cache_filename, database_filename );
+
+	while ( record_list->previous_record != last_old_record ) {
+		mx_status = mx_delete_record( record_list->previous_record );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_database_cache_create_writer( MX_DATABASE_CACHE_WRITER **writer,
+				const char *database_filename )
+{
+	static const char fname[] = "mx_database_cache_create_writer()";
+
+	MX_DATABASE_CACHE_WRITER *new_writer;
+
+	if ( ( writer == (MX_DATABASE_CACHE_WRITER **) NULL )
+	  || ( database_filename == (const char *) NULL ) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the arguments passed were NULL." );
+	}
+
+	*writer = NULL;
+
+	new_writer = (MX_DATABASE_CACHE_WRITER *)
+			calloc( 1, sizeof(MX_DATABASE_CACHE_WRITER) );
+
+	if ( new_writer == (MX_DATABASE_CACHE_WRITER *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY | MXE_QUIET, fname,
+		"Ran out of memory trying to allocate a database "
+		"cache writer for '%s'.", database_filename );
+	}
+
+	mxp_database_cache_initialize_header( &(new_writer->header) );
+
+	if ( ( mxp_database_cache_get_cache_filename( database_filename,
+				new_writer->cache_filename,
+				sizeof(new_writer->cache_filename) ) == FALSE )
+	  || ( mxp_database_cache_describe_database( database_filename,
+				&(new_writer->header) ) == FALSE ) )
+	{
+		mx_free( new_writer );
+
+		return mx_error( MXE_FILE_IO_ERROR | MXE_QUIET, fname,
+		"Cannot create a database cache for '%s'.",
+			database_filename );
+	}
+
+	*writer = new_writer;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT void
+mx_database_cache_add_directive( MX_DATABASE_CACHE_WRITER *writer,
+				const char *directive )
+{
+	if ( ( writer == (MX_DATABASE_CACHE_WRITER *) NULL )
+	  || writer->abandoned )
+	{
+		return;
+	}
+
+	mxp_database_cache_put_uint8( &(writer->entry_buffer),
+					MXP_DATABASE_CACHE_DIRECTIVE );
+
+	mxp_database_cache_put_string( &(writer->entry_buffer),
+					directive, strlen( directive ) );
+}
+
+MX_EXPORT void
+mx_database_cache_add_record( MX_DATABASE_CACHE_WRITER *writer,
+				MX_RECORD *record )
+{
+	MX_DRIVER *driver, **new_driver_array;
+	MX_RECORD_FIELD *field;
+	void *field_value_ptr;
+	long i, driver_index;
+	uint64_t signature;
+	uint32_t values_length;
+	size_t values_start;
+	mx_status_type mx_status;
+
+	if ( ( writer == (MX_DATABASE_CACHE_WRITER *) NULL )
+	  || writer->abandoned )
+	{
+		return;
+	}
+
+	driver = mx_get_driver_by_type( record->mx_type );
+
+	if ( driver == (MX_DRIVER *) NULL ) {
+		writer->abandoned = TRUE;
+		return;
+	}
+
+	/* Add the driver to the driver table if it is not already there. */
+
+	for ( driver_index = 0; driver_index < writer->num_drivers;
+							driver_index++ )
+	{
+		if ( writer->driver_array[ driver_index ] == driver )
+			break;
+	}
+
+	if ( driver_index == writer->num_drivers ) {
+		if ( writer->num_drivers == writer->max_drivers ) {
+			new_driver_array = (MX_DRIVER **)
+				realloc( writer->driver_array,
+				( writer->max_drivers + 64 ) * sizeof(MX_DRIVER *) );
+
+			if ( new_driver_array == (MX_DRIVER **) NULL ) {
+				writer->abandoned = TRUE;
+				return;
+			}
+
+			writer->driver_array = new_driver_array;
+			writer->max_drivers += 64;
+		}
+
+		writer->driver_array[ driver_index ] = driver;
+		writer->num_drivers++;
+
+		signature = mxp_database_cache_driver_signature( driver );
+
+		mxp_database_cache_put_string( &(writer->driver_buffer),
+					driver->name, strlen( driver->name ) );
+
+		mxp_database_cache_put( &(writer->driver_buffer),
+					&signature, sizeof(signature) );
+	}
+
+	/* Write out the record. */
+
+	mxp_database_cache_put_uint8( &(writer->entry_buffer),
+					MXP_DATABASE_CACHE_RECORD );
+
+	mxp_database_cache_put_uint32( &(writer->entry_buffer),
+					(uint32_t) driver_index );
+
+	mxp_database_cache_put_uint32( &(writer->entry_buffer),
+					(uint32_t) record->mx_superclass );
+
+	mxp_database_cache_put_uint32( &(writer->entry_buffer),
+					(uint32_t) record->mx_class );
+
+	mxp_database_cache_put_string( &(writer->entry_buffer),
+					record->name, strlen( record->name ) );
+
+	/* The length of the field values is filled in afterwards. */
+
+	mxp_database_cache_put_uint32( &(writer->entry_buffer), 0 );
+
+	values_start = writer->entry_buffer.length;
+
+	for ( i = MX_NUM_RECORD_ID_FIELDS; i < record->num_record_fields; i++ )
+	{
+		field = &(record->record_field_array[i]);
+
+		if ( ( field->flags & MXFF_IN_DESCRIPTION ) == 0 )
+			continue;
+
+		if ( field->flags & MXFF_VARARGS ) {
+			field_value_ptr = mx_read_void_pointer_from_memory_location(
+							field->data_pointer );
+		} else {
+			field_value_ptr = field->data_pointer;
+		}
+
+		mx_status = mxp_database_cache_walk_field( record, field,
+				field_value_ptr, mxp_database_cache_save_leaf,
+				&(writer->entry_buffer) );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+#if MX_DATABASE_CACHE_DEBUG
+			MX_DEBUG(-2,("Record '%s' cannot be cached.",
+				record->name));
+#endif
+			writer->abandoned = TRUE;
+			return;
+		}
+	}
+
+	if ( writer->entry_buffer.failed )
+		return;
+
+	values_length = (uint32_t) ( writer->entry_buffer.length - values_start );
+
+	memcpy( writer->entry_buffer.data + values_start - sizeof(values_length),
+				&values_length, sizeof(values_length) );
+}
+
+MX_EXPORT void
+mx_database_cache_abandon( MX_DATABASE_CACHE_WRITER *writer )
+{
+	if ( writer != (MX_DATABASE_CACHE_WRITER *) NULL ) {
+		writer->abandoned = TRUE;
+	}
+}
+
+MX_EXPORT mx_status_type
+mx_database_cache_finish_writer( MX_DATABASE_CACHE_WRITER *writer )
+{
+	static const char fname[] = "mx_database_cache_finish_writer()";
+
+	char temp_filename[MXU_FILENAME_LENGTH+20];
+	FILE *file;
+	uint8_t end_marker;
+	int saved_errno, write_failed;
+	mx_status_type mx_status;
+
+	if ( writer == (MX_DATABASE_CACHE_WRITER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_DATABASE_CACHE_WRITER pointer passed was NULL." );
+	}
+
+	if ( writer->abandoned
+	  || writer->driver_buffer.failed
+	  || writer->entry_buffer.failed )
+	{
+		mx_status = mx_error( MXE_NOT_AVAILABLE | MXE_QUIET, fname,
+		"No database cache was written to '%s'.",
+			writer->cache_filename );
+	} else {
+		end_marker = MXP_DATABASE_CACHE_END;
+
+		writer->header.num_drivers = (uint32_t) writer->num_drivers;
+
+		writer->header.cache_length = sizeof(writer->header)
+					+ writer->driver_buffer.length
+					+ writer->entry_buffer.length
+					+ sizeof(end_marker);
+
+		writer->header.cache_hash = mxp_database_cache_hash(
+					MXP_DATABASE_CACHE_HASH_SEED,
+					writer->driver_buffer.data,
+					writer->driver_buffer.length );
+		writer->header.cache_hash = mxp_database_cache_hash(
+					writer->header.cache_hash,
+					writer->entry_buffer.data,
+					writer->entry_buffer.length );
+		writer->header.cache_hash = mxp_database_cache_hash(
+					writer->header.cache_hash,
+					&end_marker, sizeof(end_marker) );
+
+		/* Write to a temporary file first and then rename it, so that
+		 * other processes never see a partially written cache.
+		 */
+
+		snprintf( temp_filename, sizeof(temp_filename), "%s.%lu",
+			writer->cache_filename, mx_get_process_id() );
+
+		file = fopen( temp_filename, "wb" );
+
+		if ( file == (FILE *) NULL ) {
+			saved_errno = errno;
+
+			mx_status = mx_error( MXE_FILE_IO_ERROR | MXE_QUIET,
+			fname, "Cannot create database cache file '%s'.  "
+			"Errno = %d, error message = '%s'.",
+				temp_filename, saved_errno,
+				strerror( saved_errno ) );
+		} else {
+			write_failed = FALSE;
+
+			if ( fwrite( &(writer->header), sizeof(writer->header),
+					1, file ) != 1 )
+			{
+				write_failed = TRUE;
+			}
+
+			if ( ( writer->driver_buffer.length > 0 )
+			  && ( fwrite( writer->driver_buffer.data,
+				writer->driver_buffer.length, 1, file ) != 1 ) )
+			{
+				write_failed = TRUE;
+			}
+
+			if ( ( writer->entry_buffer.length > 0 )
+			  && ( fwrite( writer->entry_buffer.data,
+				writer->entry_buffer.length, 1, file ) != 1 ) )
+			{
+				write_failed = TRUE;
+			}
+
+			if ( fwrite( &end_marker, 1, 1, file ) != 1 ) {
+				write_failed = TRUE;
+			}
+
+			if ( fclose( file ) != 0 ) {
+				write_failed = TRUE;
+			}
+
+#if defined(OS_WIN32)
+			if ( write_failed == FALSE ) {
+				(void) remove( writer->cache_filename );
+			}
+#endif
+			if ( ( write_failed == FALSE )
+			  && ( rename( temp_filename,
+					writer->cache_filename ) == 0 ) )
+			{
+				mx_status = MX_SUCCESSFUL_RESULT;
+			} else {
+				(void) remove( temp_filename );
+
+				mx_status = mx_error(
+					MXE_FILE_IO_ERROR | MXE_QUIET, fname,
+				"Cannot write database cache file '%s'.",
+					writer->cache_filename );
+			}
+		}
+	}
+
+	mx_free( writer->driver_array );
+	mx_free( writer->driver_buffer.data );
+	mx_free( writer->entry_buffer.data );
+	mx_free( writer );
+
+	return mx_status;
+}
+
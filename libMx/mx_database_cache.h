@@ -0,0 +1,77 @@
+/*
+ * Name:    mx_database_cache.h
+ *
+ * Purpose: Binary cache of the parsed contents of an MX database file.
+ *
+ *----------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#ifndef __MX_DATABASE_CACHE_H__
+#define __MX_DATABASE_CACHE_H__
+
+/* Make the header file C++ safe. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* When mx_read_database_file() is called with MXFC_USE_DATABASE_CACHE,
+ * the records parsed from a database file 'foo.dat' are saved in binary
+ * form to 'foo.dat.cache'.  The cache holds, for each record, its name,
+ * superclass, class and driver, followed by the values of the fields in
+ * the record description stored in their native binary format.  Fields
+ * that refer to other records are stored as record names and resolved
+ * by the same code that handles them in a text database.  Directives
+ * such as '!include' or '!setenv' are stored as text and are carried
+ * out again when the cache is loaded.
+ *
+ * The cache is only used if the size, modification time and the hash of
+ * the contents of the database file all match the values stored in the
+ * cache, if the cache itself passes a checksum, and if the record field
+ * layouts of all of the drivers it uses are unchanged.  Otherwise, the
+ * database file is parsed as text and the cache is rewritten.
+ */
+
+#define MX_DATABASE_CACHE_SUFFIX	".cache"
+
+typedef struct mx_database_cache_writer_type MX_DATABASE_CACHE_WRITER;
+
+MX_API_PRIVATE mx_status_type mx_database_cache_load( MX_RECORD *record_list,
+					const char *database_filename,
+					unsigned long flags,
+					mx_bool_type *cache_was_loaded );
+
+MX_API_PRIVATE mx_status_type mx_database_cache_create_writer(
+					MX_DATABASE_CACHE_WRITER **writer,
+					const char *database_filename );
+
+MX_API_PRIVATE void mx_database_cache_add_directive(
+					MX_DATABASE_CACHE_WRITER *writer,
+					const char *directive );
+
+MX_API_PRIVATE void mx_database_cache_add_record(
+					MX_DATABASE_CACHE_WRITER *writer,
+					MX_RECORD *record );
+
+MX_API_PRIVATE void mx_database_cache_abandon(
+					MX_DATABASE_CACHE_WRITER *writer );
+
+/* mx_database_cache_finish_writer() writes out the cache, unless it has
+ * been abandoned, and then frees the writer.
+ */
+
+MX_API_PRIVATE mx_status_type mx_database_cache_finish_writer(
+					MX_DATABASE_CACHE_WRITER *writer );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MX_DATABASE_CACHE_H__ */
+
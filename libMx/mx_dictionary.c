@@ -2,13 +2,13 @@
  * Name:    mx_dictionary.c
  *
  * Purpose: MX dictionaries are a key-value database where the keys are
- *          found in doubly-linked list.
+ *          found in doubly-linked list, with a hash table index of the keys.
  *
  * Author:  William Lavender
  *
  *---------------------------------------------------------------------------
  *
- * Copyright 2019, 2022 Illinois Institute of Technology
+ * Copyright 2019, 2022, 2026 Illinois Institute of Technology
  *
  * See the file "LICENSE" for information on usage and redistribution
  * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
@@ -25,25 +25,59 @@
 #include "mx_record.h"
 #include "mx_cfn.h"
 #include "mx_array.h"
+#include "mx_hash_table.h"
 #include "mx_dictionary.h"
 
+/* The initial size of the key index of a new empty dictionary. */
+
+#define MX_DICTIONARY_INITIAL_INDEX_SIZE	16
+
+static mx_status_type
+mx_dictionary_create_with_index_size( MX_DICTIONARY **new_dictionary,
+					const char *dictionary_name,
+					MX_RECORD *record,
+					long index_size );
+
 /*--------------------------------------------------------------------------*/
 
 MX_EXPORT mx_status_type
 mx_dictionary_create( MX_DICTIONARY **new_dictionary,
 			const char *dictionary_name,
 			MX_RECORD *record )
+{
+	return mx_dictionary_create_with_index_size( new_dictionary,
+					dictionary_name, record,
+					MX_DICTIONARY_INITIAL_INDEX_SIZE );
+}
+
+static mx_status_type
+mx_dictionary_create_with_index_size( MX_DICTIONARY **new_dictionary,
+					const char *dictionary_name,
+					MX_RECORD *record,
+					long index_size )
 {
 	static const char fname[] = "mx_dictionary_create()";
 
+	MX_HASH_TABLE *key_index = NULL;
+	mx_status_type mx_status;
+
 	if ( new_dictionary == (MX_DICTIONARY **) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
 		"The MX_DICTIONARY pointer passed was NULL." );
 	}
 
+	mx_status = mx_hash_table_create( &key_index,
+					MXU_DICTIONARY_KEY_LENGTH + 1,
+					index_size, NULL );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
 	*new_dictionary = (MX_DICTIONARY *) malloc( sizeof(MX_DICTIONARY) );
 
 	if ( *new_dictionary == (MX_DICTIONARY *) NULL ) {
+		mx_hash_table_destroy( key_index );
+
 		return mx_error( MXE_OUT_OF_MEMORY, fname,
 		"The attempt to create a new MX_DICTIONARY structure failed." );
 	}
@@ -56,6 +90,8 @@ mx_dictionary_create( MX_DICTIONARY **new_dictionary,
 
 	(*new_dictionary)->dictionary_start = NULL;
 
+	(*new_dictionary)->key_index = key_index;
+
 	(*new_dictionary)->record = record;
 	(*new_dictionary)->application_ptr = NULL;
 
@@ -85,11 +121,17 @@ mx_dictionary_destroy( MX_DICTIONARY *dictionary )
 
 	current_dictionary_entry = dictionary->dictionary_start;
 
+	/* The list is circular, so we stop when we get back to the start. */
+
 	while ( current_dictionary_entry != (MX_DICTIONARY_ENTRY *) NULL ) {
 
 		next_dictionary_entry =
 			current_dictionary_entry->next_dictionary_entry;
 
+		if ( next_dictionary_entry == dictionary->dictionary_start ) {
+			next_dictionary_entry = NULL;
+		}
+
 		destructor = current_dictionary_entry->destructor;
 
 		if ( destructor != NULL ) {
@@ -101,6 +143,10 @@ mx_dictionary_destroy( MX_DICTIONARY *dictionary )
 		current_dictionary_entry = next_dictionary_entry;
 	}
 
+	mx_hash_table_destroy( (MX_HASH_TABLE *) dictionary->key_index );
+
+	free( dictionary );
+
 	return;
 }
 
@@ -113,6 +159,8 @@ mx_dictionary_add_entry( MX_DICTIONARY *dictionary,
 	static const char fname[] = "mx_dictionary_add_entry()";
 
 	MX_DICTIONARY_ENTRY *dictionary_start, *end_of_dictionary;
+	void *existing_entry;
+	mx_status_type mx_status;
 
 #if MX_DICTIONARY_DEBUG
 	MX_DEBUG(-2,("%s: Adding %p to dictionary %p",
@@ -128,6 +176,27 @@ mx_dictionary_add_entry( MX_DICTIONARY *dictionary,
 		"The MX_DICTIONARY_ENTRY pointer passed was NULL." );
 	}
 
+	/* Add the key to the index first, since that is the step
+	 * that can fail.
+	 */
+
+	mx_status = mx_hash_table_lookup_key(
+				(MX_HASH_TABLE *) dictionary->key_index,
+				dictionary_entry->key, &existing_entry );
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		return mx_error( MXE_ALREADY_EXISTS, fname,
+		"Key '%s' is already present in dictionary '%s'.",
+			dictionary_entry->key, dictionary->name );
+	}
+
+	mx_status = mx_hash_table_insert_key(
+				(MX_HASH_TABLE *) dictionary->key_index,
+				dictionary_entry->key, dictionary_entry );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
 	dictionary_entry->dictionary = dictionary;
 
 	/* Find the right place to insert the dictionary entry. */
@@ -195,6 +264,7 @@ mx_dictionary_delete_entry( MX_DICTIONARY *dictionary,
 	static const char fname[] = "mx_dictionary_delete_entry()";
 
 	MX_DICTIONARY_ENTRY *previous_dictionary_entry, *next_dictionary_entry;
+	mx_status_type mx_status;
 
 #if MX_DICTIONARY_DEBUG
 	MX_DEBUG(-2,("%s: Deleting %p from dictionary %p",
@@ -216,6 +286,16 @@ mx_dictionary_delete_entry( MX_DICTIONARY *dictionary,
 			dictionary_entry, dictionary );
 	}
 
+	mx_status = mx_hash_table_delete_key(
+				(MX_HASH_TABLE *) dictionary->key_index,
+				dictionary_entry->key );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		return mx_error( MXE_NOT_FOUND, fname,
+		"Dictionary entry '%s' was not found in dictionary '%s'.",
+			dictionary_entry->key, dictionary->name );
+	}
+
 	previous_dictionary_entry = dictionary_entry->previous_dictionary_entry;
 	next_dictionary_entry     = dictionary_entry->next_dictionary_entry;
 
@@ -260,6 +340,161 @@ mx_dictionary_delete_entry( MX_DICTIONARY *dictionary,
 
 /*--------------------------------------------------------------------------*/
 
+MX_EXPORT mx_status_type
+mx_dictionary_find_entry( MX_DICTIONARY *dictionary,
+			const char *entry_key,
+			MX_DICTIONARY_ENTRY **dictionary_entry )
+{
+	static const char fname[] = "mx_dictionary_find_entry()";
+
+	void *value;
+	mx_status_type mx_status;
+
+	if ( dictionary == (MX_DICTIONARY *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_DICTIONARY pointer passed was NULL." );
+	}
+	if ( entry_key == (const char *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The entry_key pointer passed was NULL." );
+	}
+	if ( dictionary_entry == (MX_DICTIONARY_ENTRY **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_DICTIONARY_ENTRY pointer passed was NULL." );
+	}
+
+	*dictionary_entry = NULL;
+
+	if ( strlen( entry_key ) > MXU_DICTIONARY_KEY_LENGTH ) {
+		return mx_error( MXE_NOT_FOUND | MXE_QUIET, fname,
+		"Key '%s' was not found in dictionary '%s'.",
+			entry_key, dictionary->name );
+	}
+
+	mx_status = mx_hash_table_lookup_key(
+				(MX_HASH_TABLE *) dictionary->key_index,
+				entry_key, &value );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		return mx_error( MXE_NOT_FOUND | MXE_QUIET, fname,
+		"Key '%s' was not found in dictionary '%s'.",
+			entry_key, dictionary->name );
+	}
+
+	*dictionary_entry = (MX_DICTIONARY_ENTRY *) value;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*--------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_dictionary_set_value( MX_DICTIONARY *dictionary,
+			const char *entry_key,
+			void *value,
+			void (*destructor)( void * ) )
+{
+	MX_DICTIONARY_ENTRY *dictionary_entry = NULL;
+	mx_status_type mx_status;
+
+	mx_status = mx_dictionary_find_entry( dictionary,
+					entry_key, &dictionary_entry );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( ( dictionary_entry->destructor != NULL )
+	  && ( dictionary_entry->value != value ) )
+	{
+		(*(dictionary_entry->destructor))( dictionary_entry->value );
+	}
+
+	dictionary_entry->value = value;
+	dictionary_entry->destructor = destructor;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*--------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_dictionary_copy( MX_DICTIONARY **new_dictionary,
+			MX_DICTIONARY *old_dictionary,
+			const char *new_dictionary_name )
+{
+	static const char fname[] = "mx_dictionary_copy()";
+
+	MX_DICTIONARY *dictionary = NULL;
+	MX_DICTIONARY_ENTRY *old_entry, *new_entry;
+	mx_status_type mx_status;
+
+	if ( new_dictionary == (MX_DICTIONARY **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The new MX_DICTIONARY pointer passed was NULL." );
+	}
+	if ( old_dictionary == (MX_DICTIONARY *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The old MX_DICTIONARY pointer passed was NULL." );
+	}
+
+	if ( new_dictionary_name == (const char *) NULL ) {
+		new_dictionary_name = old_dictionary->name;
+	}
+
+	/* Size the index of the new dictionary so that it does not
+	 * have to grow while the entries are being copied.
+	 */
+
+	mx_status = mx_dictionary_create_with_index_size( &dictionary,
+			new_dictionary_name, old_dictionary->record,
+			(long) ( 2 * old_dictionary->num_dictionary_entries ) );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	dictionary->application_ptr = old_dictionary->application_ptr;
+
+	old_entry = old_dictionary->dictionary_start;
+
+	while ( old_entry != (MX_DICTIONARY_ENTRY *) NULL ) {
+
+		new_entry = (MX_DICTIONARY_ENTRY *)
+				malloc( sizeof(MX_DICTIONARY_ENTRY) );
+
+		if ( new_entry == (MX_DICTIONARY_ENTRY *) NULL ) {
+			mx_dictionary_destroy( dictionary );
+
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to copy dictionary '%s'.",
+				old_dictionary->name );
+		}
+
+		memcpy( new_entry, old_entry, sizeof(MX_DICTIONARY_ENTRY) );
+
+		new_entry->destructor = NULL;
+
+		mx_status = mx_dictionary_add_entry( dictionary, new_entry );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			free( new_entry );
+			mx_dictionary_destroy( dictionary );
+
+			return mx_status;
+		}
+
+		old_entry = old_entry->next_dictionary_entry;
+
+		if ( old_entry == old_dictionary->dictionary_start )
+			break;
+	}
+
+	*new_dictionary = dictionary;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*--------------------------------------------------------------------------*/
+
 MX_EXPORT mx_status_type
 mx_dictionary_add_entry_from_description( MX_DICTIONARY *dictionary,
 					char *entry_key,
@@ -294,6 +529,10 @@ mx_dictionary_add_entry_from_description( MX_DICTIONARY *dictionary,
 
 	mx_status = mx_dictionary_add_entry( dictionary, dictionary_entry );
 
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_free( dictionary_entry );
+	}
+
 	return mx_status;
 }
 
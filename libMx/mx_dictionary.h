@@ -2,13 +2,15 @@
  * Name:    mx_dictionary.h
  *
  * Purpose: MX dictionaries are a key-value database where the keys are
- *          found in a doubly-linked list.
+ *          found in a doubly-linked list.  The list keeps the entries in
+ *          the order that they were added, while a hash table index of
+ *          the keys is used to look entries up by name.
  *
  * Author:  William Lavender
  *
  *---------------------------------------------------------------------------
  *
- * Copyright 2019 Illinois Institute of Technology
+ * Copyright 2019, 2026 Illinois Institute of Technology
  *
  * See the file "LICENSE" for information on usage and redistribution
  * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
@@ -46,6 +48,12 @@ struct mx_dictionary_type {
 
 	struct mx_dictionary_entry_type *dictionary_start;
 
+	/* 'key_index' is an MX_HASH_TABLE that maps each key to its
+	 * MX_DICTIONARY_ENTRY.  Keys must be unique within a dictionary.
+	 */
+
+	void *key_index;
+
 	MX_RECORD *record;
 
 	void *application_ptr;
@@ -68,6 +76,31 @@ MX_API mx_status_type mx_dictionary_add_entry( MX_DICTIONARY *dictionary,
 MX_API mx_status_type mx_dictionary_delete_entry( MX_DICTIONARY *dictionary,
 					MX_DICTIONARY_ENTRY *dictionary_entry );
 
+MX_API mx_status_type mx_dictionary_find_entry( MX_DICTIONARY *dictionary,
+					const char *entry_key,
+					MX_DICTIONARY_ENTRY **dictionary_entry );
+
+/* mx_dictionary_set_value() calls the destructor of the old value, if any,
+ * before storing the new value and destructor.
+ */
+
+MX_API mx_status_type mx_dictionary_set_value( MX_DICTIONARY *dictionary,
+					const char *entry_key,
+					void *value,
+					void (*destructor)( void * ) );
+
+/* mx_dictionary_copy() creates a dictionary with the same keys, in the same
+ * order, as 'old_dictionary'.  The values of the new entries point to the
+ * values in the old dictionary but are not owned by it, so their destructors
+ * are set to NULL.  This is intended for sequences of image frames whose
+ * headers have the same set of keys, where only some of the values are
+ * replaced with mx_dictionary_set_value() for each frame.
+ */
+
+MX_API mx_status_type mx_dictionary_copy( MX_DICTIONARY **new_dictionary,
+					MX_DICTIONARY *old_dictionary,
+					const char *new_dictionary_name );
+
 MX_API mx_status_type mx_dictionary_add_entry_from_description(
 					MX_DICTIONARY *dictionary,
 					char *entry_key,
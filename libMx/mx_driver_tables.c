@@ -19,11 +19,14 @@
 #define MX_DRIVER_TABLES_DEBUG	FALSE
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "mx_osdef.h"
 #include "mx_stdint.h"
 
 #include "mx_driver.h"
+#include "mx_hash_table.h"
 
 /* -- Define lists that relate types to classes and to function lists. -- */
 
@@ -222,6 +225,99 @@ extern MX_DRIVER mx_type_table[];
 
 static MX_DRIVER *mx_driver_list = NULL;
 
+/* Loaded drivers are also indexed by name and by "mx_type" with two
+ * MX_HASH_TABLEs, so that looking up a driver does not need to walk the
+ * several hundred entries of mx_driver_list.  The "mx_type" table uses
+ * the decimal form of the type as its key.  If either table cannot be
+ * built, mxp_driver_index_is_valid is cleared and the lookup functions
+ * go back to walking the list.  mx_set_driver_index() can also make
+ * them walk the list, so that the two can be compared.
+ */
+
+static MX_HASH_TABLE *mxp_driver_name_index = NULL;
+static MX_HASH_TABLE *mxp_driver_type_index = NULL;
+
+static mx_bool_type mxp_driver_index_is_valid = TRUE;
+
+static mx_bool_type mxp_use_driver_index = TRUE;
+
+#define MXP_DRIVER_INDEX_INITIAL_SIZE	1024
+
+#define MXU_DRIVER_TYPE_KEY_LENGTH	24
+
+static void
+mxp_driver_type_key( long mx_type, char *key )
+{
+	snprintf( key, MXU_DRIVER_TYPE_KEY_LENGTH, "%ld", mx_type );
+}
+
+/* If two drivers have the same key, the first one loaded wins,
+ * just as it does for a list walk.
+ */
+
+static mx_status_type
+mxp_driver_index_add( MX_HASH_TABLE *index, const char *key,
+						MX_DRIVER *driver )
+{
+	void *value;
+	mx_status_type mx_status;
+
+	mx_status = mx_hash_table_lookup_key( index, key, &value );
+
+	if ( mx_status.code == MXE_SUCCESS )
+		return MX_SUCCESSFUL_RESULT;
+
+	return mx_hash_table_insert_key( index, key, driver );
+}
+
+static void
+mxp_driver_index_register( MX_DRIVER *driver )
+{
+	char type_key[MXU_DRIVER_TYPE_KEY_LENGTH];
+	mx_status_type mx_status;
+
+	if ( mxp_driver_index_is_valid == FALSE )
+		return;
+
+	if ( mxp_driver_name_index == (MX_HASH_TABLE *) NULL ) {
+		mx_status = mx_hash_table_create( &mxp_driver_name_index,
+					MXU_DRIVER_NAME_LENGTH + 1,
+					MXP_DRIVER_INDEX_INITIAL_SIZE, NULL );
+
+		if ( mx_status.code == MXE_SUCCESS ) {
+			mx_status = mx_hash_table_create(
+					&mxp_driver_type_index,
+					MXU_DRIVER_TYPE_KEY_LENGTH,
+					MXP_DRIVER_INDEX_INITIAL_SIZE, NULL );
+		}
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mxp_driver_index_is_valid = FALSE;
+			return;
+		}
+	}
+
+	mx_status = mxp_driver_index_add( mxp_driver_name_index,
+						driver->name, driver );
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		mxp_driver_type_key( driver->mx_type, type_key );
+
+		mx_status = mxp_driver_index_add( mxp_driver_type_index,
+						type_key, driver );
+	}
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mxp_driver_index_is_valid = FALSE;
+	}
+}
+
+MX_EXPORT void
+mx_set_driver_index( mx_bool_type use_driver_index )
+{
+	mxp_use_driver_index = use_driver_index;
+}
+
 /*-----*/
 
 /* If, when loaded, an MX driver has an "mx_type" that is less than 0,
@@ -250,6 +346,21 @@ mx_get_driver_by_name( char *driver_name )
 		return mx_driver_list;
 	}
 
+	if ( mxp_use_driver_index && mxp_driver_index_is_valid
+	  && ( mxp_driver_name_index != (MX_HASH_TABLE *) NULL ) )
+	{
+		mx_status_type mx_status;
+		void *value;
+
+		mx_status = mx_hash_table_lookup_key( mxp_driver_name_index,
+							driver_name, &value );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return NULL;
+
+		return (MX_DRIVER *) value;
+	}
+
 	current_driver = mx_driver_list;
 
 	while ( current_driver != (MX_DRIVER *) NULL ) {
@@ -269,6 +380,24 @@ mx_get_driver_by_type( long mx_type )
 {
 	MX_DRIVER *current_driver;
 
+	if ( mxp_use_driver_index && mxp_driver_index_is_valid
+	  && ( mxp_driver_type_index != (MX_HASH_TABLE *) NULL ) )
+	{
+		char type_key[MXU_DRIVER_TYPE_KEY_LENGTH];
+		mx_status_type mx_status;
+		void *value;
+
+		mxp_driver_type_key( mx_type, type_key );
+
+		mx_status = mx_hash_table_lookup_key( mxp_driver_type_index,
+							type_key, &value );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return NULL;
+
+		return (MX_DRIVER *) value;
+	}
+
 	current_driver = mx_driver_list;
 
 	while ( current_driver != (MX_DRIVER *) NULL ) {
@@ -744,6 +873,15 @@ mxp_initialize_driver_entry( MX_DRIVER *driver )
 
 			array_element->field_number = i;
 		}
+
+		/* Build the field name index now that the driver has
+		 * finished adjusting its record field defaults.
+		 */
+
+		mx_status = mx_create_field_name_index( driver );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 	}
 
 	/* If "mx_type" is greater than MX_DYNAMIC_DRIVER_BASE, then
@@ -816,6 +954,8 @@ mx_add_driver_table( MX_DRIVER *driver_table )
 
 		mx_driver_list->next_driver = NULL;
 
+		mxp_driver_index_register( mx_driver_list );
+
 		offset = 1;
 	}
 
@@ -848,6 +988,8 @@ mx_add_driver_table( MX_DRIVER *driver_table )
 		current_driver->next_driver = table_entry;
 
 		current_driver = current_driver->next_driver;
+
+		mxp_driver_index_register( table_entry );
 	}
 
 	/* We are done. */
@@ -28,6 +28,7 @@
 #include "mx_record.h"
 #include "mx_array.h"
 #include "mx_unistd.h"
+#include "mx_hash_table.h"
 
 #include "mx_variable.h"
 
@@ -369,6 +370,191 @@ mx_get_field_type_string( long field_type )
 
 /*=====================================================================*/
 
+/* Every record made by a given driver has the same record field layout,
+ * so each driver gets an MX_HASH_TABLE that maps field names to entries
+ * in its MX_RECORD_FIELD_DEFAULTS array.  Records point to the index of
+ * their driver through 'field_name_index'.  Since records keep that
+ * pointer, the index itself is never freed, but the table inside it is
+ * replaced if the driver's field defaults change.  If the table cannot
+ * be built, field names are found by a linear search instead.
+ */
+
+typedef struct {
+	long num_fields;
+	MX_RECORD_FIELD_DEFAULTS *defaults_array;
+	MX_HASH_TABLE *table;
+} MX_FIELD_NAME_INDEX;
+
+/* Returns the index of the field, or -1 if the name is not there. */
+
+static long
+mx_field_name_index_lookup( MX_FIELD_NAME_INDEX *index, const char *name )
+{
+	void *value;
+	mx_status_type mx_status;
+
+	mx_status = mx_hash_table_lookup_key( index->table, name, &value );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return -1;
+
+	return (long) ( (MX_RECORD_FIELD_DEFAULTS *) value
+					- index->defaults_array );
+}
+
+MX_EXPORT mx_status_type
+mx_create_field_name_index( MX_DRIVER *driver )
+{
+	static const char fname[] = "mx_create_field_name_index()";
+
+	MX_FIELD_NAME_INDEX *index;
+	MX_RECORD_FIELD_DEFAULTS *defaults_array;
+	MX_HASH_TABLE *table;
+	void *value;
+	long i, num_fields;
+	mx_status_type mx_status;
+
+	if ( driver == (MX_DRIVER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_DRIVER pointer passed was NULL." );
+	}
+
+	if ( ( driver->num_record_fields == NULL )
+	  || ( driver->record_field_defaults_ptr == NULL ) )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	num_fields = *(driver->num_record_fields);
+	defaults_array = *(driver->record_field_defaults_ptr);
+
+	if ( ( num_fields <= 0 )
+	  || ( defaults_array == (MX_RECORD_FIELD_DEFAULTS *) NULL ) )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	index = (MX_FIELD_NAME_INDEX *) driver->field_name_index;
+
+	if ( index == (MX_FIELD_NAME_INDEX *) NULL ) {
+		index = (MX_FIELD_NAME_INDEX *)
+				calloc( 1, sizeof(MX_FIELD_NAME_INDEX) );
+
+		if ( index == (MX_FIELD_NAME_INDEX *) NULL ) {
+			mx_warning( "%s: Ran out of memory trying to allocate "
+			"a field name index for driver '%s'.  Its fields "
+			"will be found by a linear search.",
+				fname, driver->name );
+
+			return MX_SUCCESSFUL_RESULT;
+		}
+
+		driver->field_name_index = index;
+	} else
+	if ( ( index->table != (MX_HASH_TABLE *) NULL )
+	  && ( index->num_fields == num_fields )
+	  && ( index->defaults_array == defaults_array ) )
+	{
+		/* The existing table is still correct. */
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	if ( index->table != (MX_HASH_TABLE *) NULL ) {
+		mx_hash_table_destroy( index->table );
+
+		index->table = NULL;
+	}
+
+	index->num_fields = num_fields;
+	index->defaults_array = defaults_array;
+
+	mx_status = mx_hash_table_create( &table, MXU_FIELD_NAME_LENGTH + 1,
+						2 * num_fields, NULL );
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+
+		/* If a name appears more than once, the first one wins,
+		 * just as it would for a linear search.
+		 */
+
+		for ( i = 0; i < num_fields; i++ ) {
+			mx_status = mx_hash_table_lookup_key( table,
+					defaults_array[i].name, &value );
+
+			if ( mx_status.code == MXE_SUCCESS )
+				continue;
+
+			mx_status = mx_hash_table_insert_key( table,
+					defaults_array[i].name,
+					&defaults_array[i] );
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				mx_hash_table_destroy( table );
+				break;
+			}
+		}
+	}
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_warning( "%s: The field name index for driver '%s' could "
+		"not be built.  Its fields will be found by a linear search.",
+			fname, driver->name );
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	index->table = table;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* mx_get_indexed_record_field() looks up a field with the driver's field
+ * name index.  It sets *use_index to FALSE if the record's field array
+ * does not match the index, in which case the caller must search the
+ * field array itself.
+ */
+
+static MX_RECORD_FIELD *
+mx_get_indexed_record_field( MX_RECORD *record, const char *field_name,
+				mx_bool_type *use_index )
+{
+	MX_FIELD_NAME_INDEX *index;
+	MX_RECORD_FIELD *field;
+	long field_index;
+
+	index = (MX_FIELD_NAME_INDEX *) record->field_name_index;
+
+	if ( ( index == (MX_FIELD_NAME_INDEX *) NULL )
+	  || ( index->table == (MX_HASH_TABLE *) NULL )
+	  || ( index->num_fields != record->num_record_fields )
+	  || ( record->record_field_array == (MX_RECORD_FIELD *) NULL ) )
+	{
+		*use_index = FALSE;
+		return NULL;
+	}
+
+	*use_index = TRUE;
+
+	field_index = mx_field_name_index_lookup( index, field_name );
+
+	if ( field_index < 0 )
+		return NULL;
+
+	field = &(record->record_field_array[ field_index ]);
+
+	if ( ( field->name == NULL )
+	  || ( strcmp( field_name, field->name ) != 0 ) )
+	{
+		*use_index = FALSE;
+		return NULL;
+	}
+
+	return field;
+}
+
+/*=====================================================================*/
+
 MX_EXPORT MX_RECORD_FIELD *
 mx_get_record_field( MX_RECORD *record, const char *field_name )
 {
@@ -376,6 +562,7 @@ mx_get_record_field( MX_RECORD *record, const char *field_name )
 
 	MX_RECORD_FIELD *field_array, *field;
 	long i, num_record_fields;
+	mx_bool_type use_index;
 
 	if ( record == NULL ) {
 		return NULL;
@@ -385,6 +572,12 @@ mx_get_record_field( MX_RECORD *record, const char *field_name )
 		return NULL;
 	}
 
+	field = mx_get_indexed_record_field( record, field_name, &use_index );
+
+	if ( use_index ) {
+		return field;
+	}
+
 	num_record_fields = record->num_record_fields;
 
 	if ( num_record_fields <= 0 ) {
@@ -529,6 +722,7 @@ mx_find_record_field( MX_RECORD *record, const char *name_of_field_to_find,
 
 	MX_RECORD_FIELD *field;
 	long i, num_record_fields;
+	mx_bool_type use_index;
 
 	if ( record == NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
@@ -561,7 +755,18 @@ mx_find_record_field( MX_RECORD *record, const char *name_of_field_to_find,
 			record->name );
 	}
 
-	*field_that_was_found = NULL;
+	*field_that_was_found = mx_get_indexed_record_field( record,
+					name_of_field_to_find, &use_index );
+
+	if ( use_index ) {
+		if ( *field_that_was_found == (MX_RECORD_FIELD *) NULL ) {
+			return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"Record field '%s' was not found in record '%s'",
+				name_of_field_to_find, record->name );
+		}
+
+		return MX_SUCCESSFUL_RESULT;
+	}
 
 	for ( i = 0; i < num_record_fields; i++ ) {
 		if ( strcmp( name_of_field_to_find, field[i].name ) == 0 ) {
@@ -625,6 +830,7 @@ mx_find_record_field_defaults_index( MX_DRIVER *driver,
 	static const char fname[] = "mx_find_record_field_defaults_index()";
 
 	MX_RECORD_FIELD_DEFAULTS *record_field_defaults_array;
+	MX_FIELD_NAME_INDEX *index;
 	long i, num_record_fields;
 
 	if ( driver == (MX_DRIVER *) NULL) {
@@ -665,6 +871,26 @@ mx_find_record_field_defaults_index( MX_DRIVER *driver,
 
 	*index_of_field_that_was_found = -1;
 
+	index = (MX_FIELD_NAME_INDEX *) driver->field_name_index;
+
+	if ( ( index != (MX_FIELD_NAME_INDEX *) NULL )
+	  && ( index->table != (MX_HASH_TABLE *) NULL )
+	  && ( index->num_fields == num_record_fields )
+	  && ( index->defaults_array == record_field_defaults_array ) )
+	{
+		i = mx_field_name_index_lookup( index, name_of_field_to_find );
+
+		if ( i < 0 ) {
+			return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"Record field '%s' was not found for driver '%s'.",
+				name_of_field_to_find, driver->name );
+		}
+
+		*index_of_field_that_was_found = i;
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
 	for ( i = 0; i < num_record_fields; i++ ) {
 		if ( strcmp( name_of_field_to_find,
 				record_field_defaults_array[i].name ) == 0 ) {
@@ -850,15 +1076,10 @@ mx_create_record_from_description(
 {
 	static const char fname[] = "mx_create_record_from_description()";
 
-	MX_RECORD *current_record;
-	MX_RECORD *record;
-	MX_RECORD_FUNCTION_LIST *record_function_list;
 	MX_DRIVER *superclass_driver;
 	MX_DRIVER *class_driver, *type_driver;
-	MX_RECORD_FIELD_DEFAULTS *record_field_defaults_array;
 	MX_RECORD_FIELD_PARSE_STATUS parse_status;
 	char token[4][MXU_BUFFER_LENGTH + 1];
-	mx_status_type (*fptr)( MX_RECORD * );
 	mx_status_type mx_status;
 	int i, record_name_length;
 	char separators[] = MX_RECORD_FIELD_SEPARATORS;
@@ -912,9 +1133,94 @@ mx_create_record_from_description(
 			MXU_RECORD_NAME_LENGTH - 1 );
 	}
 
+	/* === Figure out what record SUPERCLASS this is. === */
+
+	superclass_driver = mx_get_superclass_driver_by_name( token[1] );
+
+	if ( superclass_driver == (MX_DRIVER *) NULL ) {
+		return mx_error( MXE_UNPARSEABLE_STRING, fname,
+		"Record superclass '%s' is unrecognizable on line '%s'.",
+			token[1], description );
+	}
+
+	/* === Figure out what record CLASS this is. === */
+
+	class_driver = mx_get_class_driver_by_name( token[2] );
+
+	if ( class_driver == (MX_DRIVER *) NULL ) {
+		return mx_error( MXE_UNPARSEABLE_STRING, fname,
+			"Record class '%s' is unrecognizable on line '%s'",
+					token[2], description );
+	}
+
+	/* === Figure out what record TYPE this is. === */
+
+	type_driver = mx_get_driver_by_name( token[3] );
+
+	if ( type_driver == (MX_DRIVER *) NULL ) {
+		return mx_error( MXE_UNPARSEABLE_STRING, fname,
+			"Record type '%s' is unrecognizable on line '%s'",
+					token[3], description );
+	}
+
+	/* Create the record and parse the rest of the tokens
+	 * into its record fields.
+	 */
+
+	mx_status = mx_create_record_from_driver( record_list, token[0],
+				superclass_driver->mx_superclass,
+				class_driver->mx_class,
+				type_driver, description, flags,
+				mx_parse_record_field_tokens, &parse_status,
+				created_record );
+
+	return mx_status;
+}
+
+/*---------------------------------------------------------------------*/
+
+/* mx_create_record_from_driver() does the work of creating a record once
+ * the drivers for the record have been found.  The values of the fields
+ * that appear in the record description are filled in by the function
+ * 'field_value_loader'.  For records read from a database file, this is
+ * mx_parse_record_field_tokens(), while the binary database cache uses
+ * a loader of its own.  The 'description' argument is only used in error
+ * messages and may be NULL.
+ */
+
+MX_EXPORT mx_status_type
+mx_create_record_from_driver( MX_RECORD *record_list,
+		const char *record_name,
+		long mx_superclass,
+		long mx_class,
+		MX_DRIVER *type_driver,
+		const char *description,
+		unsigned long flags,
+		MX_RECORD_FIELD_VALUE_LOADER *field_value_loader,
+		void *loader_arguments,
+		MX_RECORD **created_record )
+{
+	static const char fname[] = "mx_create_record_from_driver()";
+
+	MX_RECORD *current_record;
+	MX_RECORD *record;
+	MX_RECORD_FUNCTION_LIST *record_function_list;
+	MX_RECORD_FIELD_DEFAULTS *record_field_defaults_array;
+	long num_record_fields;
+	mx_status_type (*fptr)( MX_RECORD * );
+	mx_status_type mx_status;
+
+	/* Null this out in case we return with an error. */
+
+	*created_record = NULL;
+
+	if ( description == (const char *) NULL ) {
+		description = record_name;
+	}
+
 	/* The first field is the name of this record.  It should be unique. */
 
-	record = mx_get_record( record_list, token[0] );
+	record = mx_get_record( record_list, record_name );
 
 	if ( record != (MX_RECORD *) NULL ) {
 
@@ -933,7 +1239,7 @@ mx_create_record_from_description(
 	"Preexisting record '%s' is not a scan record and may not be deleted.",
 					record->name );
 
-			} else if ( strcmp( token[1], "scan" ) != 0 ) {
+			} else if ( mx_superclass != MXR_SCAN ) {
 
 				return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
 	"Scan record '%s' may not be replaced by non-scan description '%s'",
@@ -948,73 +1254,45 @@ mx_create_record_from_description(
 		} else {
 			return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
 		"The record name '%s' is already in use in record list %p",
-				token[0], record_list );
+				record_name, record_list );
 		}
 	}
 
 	/* Create a new record in the record list and copy the record
-	 * name into it.  Since the record list is circular, inserting
+	 * name into it.  The record field array is allocated together
+	 * with the record.  Since the record list is circular, inserting
 	 * the record before the first record is equivalent to inserting
 	 * it after the last record.
 	 */
 
-	current_record = mx_create_record();
+	if ( type_driver->num_record_fields == NULL ) {
+		num_record_fields = 0;
+	} else {
+		num_record_fields = *(type_driver->num_record_fields);
+	}
+
+	current_record = mx_create_record_in_list( record_list,
+						num_record_fields );
 
 	if ( current_record == NULL ) {
 		return mx_error( MXE_OUT_OF_MEMORY, fname,
 			"Out of memory allocating first data record.");
 	}
 
-	strlcpy( current_record->name, token[0], MXU_RECORD_NAME_LENGTH );
+	strlcpy( current_record->name, record_name, MXU_RECORD_NAME_LENGTH );
 
 	mx_status = mx_insert_before_record( record_list, current_record );
 
 	if ( mx_status.code != MXE_SUCCESS ) {
-		free( current_record );
+		mx_free_record_structure(
+			mx_get_record_list_head_struct( record_list ),
+			current_record );
 
 		return mx_status;
 	}
 
-	/* === Figure out what record SUPERCLASS this is. === */
-
-	superclass_driver = mx_get_superclass_driver_by_name( token[1] );
-
-	if ( superclass_driver == (MX_DRIVER *) NULL ) {
-		mx_delete_record( current_record );
-
-		return mx_error( MXE_UNPARSEABLE_STRING, fname,
-		"Record superclass '%s' is unrecognizable on line '%s'.",
-			token[1], description );
-	}
-
-	current_record->mx_superclass = superclass_driver->mx_superclass;
-
-	/* === Figure out what record CLASS this is. === */
-
-	class_driver = mx_get_class_driver_by_name( token[2] );
-
-	if ( class_driver == (MX_DRIVER *) NULL ) {
-		mx_delete_record( current_record );
-
-		return mx_error( MXE_UNPARSEABLE_STRING, fname,
-			"Record class '%s' is unrecognizable on line '%s'",
-					token[2], description );
-	}
-
-	current_record->mx_class = class_driver->mx_class;
-
-	/* === Figure out what record TYPE this is. === */
-
-	type_driver = mx_get_driver_by_name( token[3] );
-
-	if ( type_driver == (MX_DRIVER *) NULL ) {
-		mx_delete_record( current_record );
-
-		return mx_error( MXE_UNPARSEABLE_STRING, fname,
-			"Record type '%s' is unrecognizable on line '%s'",
-					token[3], description );
-	}
-
+	current_record->mx_superclass = mx_superclass;
+	current_record->mx_class = mx_class;
 	current_record->mx_type = type_driver->mx_type;
 
 	/* Does this record type have new style record field support
@@ -1043,35 +1321,16 @@ mx_create_record_from_description(
 		 */
 
 		MX_DEBUG( 8,("%s: record type '%s' uses record fields.",
-			fname, token[3]));
+			fname, type_driver->name));
 
-		current_record->num_record_fields
-			= *(type_driver->num_record_fields);
+		current_record->num_record_fields = num_record_fields;
+
+		current_record->field_name_index
+			= type_driver->field_name_index;
 
 		record_field_defaults_array
 			= *(type_driver->record_field_defaults_ptr);
 
-		/* Allocate an array for the record fields of the
-		 * current record.
-		 */
-
-		current_record->record_field_array
-		    = (MX_RECORD_FIELD *) malloc(
-				current_record->num_record_fields
-				* sizeof(MX_RECORD_FIELD) );
-
-		if ( current_record->record_field_array
-					== (MX_RECORD_FIELD *) NULL ) {
-
-			mx_status = mx_error( MXE_OUT_OF_MEMORY, fname,
-	"Ran out of memory allocating record field array for record '%s'",
-				current_record->name );
-
-			mx_delete_record( current_record );
-
-			return mx_status;
-		}
-
 		/* The create_record_structures function from the
 		 * MX_RECORD_FUNCTION_LIST is invoked before we do
 		 * anything else, so that any data structures that
@@ -1120,10 +1379,11 @@ mx_create_record_from_description(
 			return mx_status;
 		}
 
-		/* Now parse the record field array. */
+		/* Now load the record field array. */
 
-		mx_status = mx_parse_record_fields( current_record,
-				record_field_defaults_array, &parse_status );
+		mx_status = mx_setup_record_fields( current_record,
+				record_field_defaults_array,
+				field_value_loader, loader_arguments );
 
 		if ( mx_status.code != MXE_SUCCESS ) {
 			mx_status = mx_error( MXE_UNPARSEABLE_STRING, fname,
@@ -2511,6 +2771,9 @@ mx_copy_defaults_to_record_field( MX_RECORD_FIELD *field,
 	field->value_change_threshold
 				= field_defaults->value_change_threshold;
 	field->last_value           = 0.0;
+	field->last_value_hash      = 0;
+	field->last_value_snapshot  = NULL;
+	field->last_value_snapshot_length = 0;
 	field->value_has_changed_manual_override = FALSE;
 	field->value_changed_test_function
 				= field_defaults->value_changed_test_function;
@@ -2529,12 +2792,31 @@ mx_parse_record_fields( MX_RECORD *record,
 			MX_RECORD_FIELD_DEFAULTS *record_field_defaults_array,
 			MX_RECORD_FIELD_PARSE_STATUS *parse_status )
 {
-	static const char fname[] = "mx_parse_record_fields()";
+	mx_status_type mx_status;
+
+	mx_status = mx_setup_record_fields( record,
+				record_field_defaults_array,
+				mx_parse_record_field_tokens, parse_status );
+
+	return mx_status;
+}
+
+/* mx_setup_record_fields() initializes the MX_RECORD_FIELD array of a
+ * record from the driver's field defaults and allocates the memory for
+ * any varargs fields.  The values of the fields that are listed in the
+ * record description are then filled in by 'field_value_loader'.
+ */
+
+MX_EXPORT mx_status_type
+mx_setup_record_fields( MX_RECORD *record,
+			MX_RECORD_FIELD_DEFAULTS *record_field_defaults_array,
+			MX_RECORD_FIELD_VALUE_LOADER *field_value_loader,
+			void *loader_arguments )
+{
+	static const char fname[] = "mx_setup_record_fields()";
 
 	MX_RECORD_FIELD *record_field, *record_field_array;
 	MX_RECORD_FIELD_DEFAULTS *record_field_defaults;
-	mx_status_type (*fptr)(void *, char *, MX_RECORD *, MX_RECORD_FIELD *,
-					MX_RECORD_FIELD_PARSE_STATUS *);
 
 	/* field_data_ptr is the value of record_field->data_pointer,
 	 * while field_value_ptr is the location that the actual data
@@ -2553,11 +2835,10 @@ mx_parse_record_fields( MX_RECORD *record,
 	void *field_value_ptr;
 
 	void *array_ptr;
-	long i, j, token_number;
+	long i, j;
 	long num_record_fields, field_type;
 	long dimension_size;
 	int allocate_the_array;
-	char token_buffer[500];
 	mx_status_type status;
 
 	if ( record == NULL ) {
@@ -2596,8 +2877,6 @@ mx_parse_record_fields( MX_RECORD *record,
 
 	/* Loop through all of the fields in the record list. */
 
-	token_number = MX_NUM_RECORD_ID_FIELDS;
-
 	for ( i = 0; i < num_record_fields; i++ ) {
 
 		/* Copy default values for this field to the
@@ -2786,16 +3065,6 @@ mx_parse_record_fields( MX_RECORD *record,
 				mx_get_field_type_string(field_type)));
 
 		} else {
-			/**********************************************
-			 * Figure out which function is used to parse *
-			 * the field.                                 *
-			 **********************************************/
-
-			status = mx_get_token_parser( field_type, &fptr );
-
-			if ( status.code != MXE_SUCCESS )
-				return status;
-
 			/* Construct a pointer to the field values. */
 
 			if ( record_field->flags & MXFF_VARARGS ) {
@@ -2811,87 +3080,118 @@ mx_parse_record_fields( MX_RECORD *record,
 			    ("%s: field_data_ptr = %p, field_value_ptr = %p",
 				fname, field_data_ptr, field_value_ptr));
 
-			/* If this field is a string field, get the maximum
-			 * length of a string token for use by the token
-			 * parser.
-			 */
+			status = (*field_value_loader)( record, record_field,
+					field_value_ptr, loader_arguments );
 
-			if ( field_type == MXFT_STRING ) {
-				parse_status->max_string_token_length =
-				  mx_get_max_string_token_length(record_field);
-			} else {
-				parse_status->max_string_token_length = 0;
-			}
+			if ( status.code != MXE_SUCCESS )
+				return status;
+		}
+	}
 
-			/* If the input field is zero-dimensional or
-			 * a one-dimensional string, call the token
-			 * parser directly.
-			 */
+	return MX_SUCCESSFUL_RESULT;
+}
 
-			if ( (record_field->num_dimensions == 0)
-			  || ((field_type == MXFT_STRING)
-			     && (record_field->num_dimensions == 1)) ) {
+/* mx_parse_record_field_tokens() fills in the value of a record field
+ * from the next token(s) of a text record description.
+ */
 
-				/*** Single Token ***/
+MX_EXPORT mx_status_type
+mx_parse_record_field_tokens( MX_RECORD *record,
+			MX_RECORD_FIELD *record_field,
+			void *field_value_ptr,
+			void *loader_arguments )
+{
+	static const char fname[] = "mx_parse_record_field_tokens()";
 
-				/* Is there a next token for this field? */
+	MX_RECORD_FIELD_PARSE_STATUS *parse_status;
+	mx_status_type (*fptr)(void *, char *, MX_RECORD *, MX_RECORD_FIELD *,
+					MX_RECORD_FIELD_PARSE_STATUS *);
+	long field_type;
+	char token_buffer[500];
+	mx_status_type status;
 
-				status = mx_get_next_record_token(parse_status, 
-					token_buffer, sizeof(token_buffer) );
+	parse_status = (MX_RECORD_FIELD_PARSE_STATUS *) loader_arguments;
 
-				if ( status.code != MXE_SUCCESS ) {
-					return mx_error(
-					MXE_UNPARSEABLE_STRING, fname,
-				"Record description string was too short.  "
-				"Did not find valid token(s) for field '%s'",
-						record_field->name );
-				}
+	field_type = record_field->datatype;
 
-				MX_DEBUG( 8,
-		("Field[%ld] = '%s', field type = %s, token[%ld] = '%s'",
-					i, record_field->name, 
-					mx_get_field_type_string(field_type),
-					token_number, token_buffer));
+	/* Figure out which function is used to parse the field. */
 
-				token_number++;
+	status = mx_get_token_parser( field_type, &fptr );
 
-				/* Now parse the token. */
+	if ( status.code != MXE_SUCCESS )
+		return status;
 
-				status = (*fptr)(field_value_ptr, token_buffer,
-					record, record_field, parse_status);
-			} else {
-				/*** Array of tokens ***/
+	/* If this field is a string field, get the maximum
+	 * length of a string token for use by the token
+	 * parser.
+	 */
 
-				/* Call mx_parse_array_description() to
-				 * get all of the tokens and put them into 
-				 * the array.
-				 */
+	if ( field_type == MXFT_STRING ) {
+		parse_status->max_string_token_length =
+			mx_get_max_string_token_length( record_field );
+	} else {
+		parse_status->max_string_token_length = 0;
+	}
 
-				MX_DEBUG( 8,
-		("Field[%ld] = '%s', field type = %s, %ld dimensional array",
-					i, record_field->name,
-					mx_get_field_type_string(field_type),
-					record_field->num_dimensions));
+	/* If the input field is zero-dimensional or
+	 * a one-dimensional string, call the token
+	 * parser directly.
+	 */
 
-				token_number++;
+	if ( (record_field->num_dimensions == 0)
+	  || ((field_type == MXFT_STRING)
+	     && (record_field->num_dimensions == 1)) ) {
 
-				status = mx_parse_array_description(
-					field_value_ptr,
-					(record_field->num_dimensions - 1),
-					record, record_field,
-					parse_status, fptr );
-			}
-			switch( status.code ) {
-			case MXE_SUCCESS:
-				break;
-			case MXE_UNPARSEABLE_STRING:
-				return mx_error( MXE_UNPARSEABLE_STRING, fname,
-			"Invalid token found in record '%s' at field '%s'.",
-					record->name, record_field->name );
-			default:
-				return status;
-			}
+		/*** Single Token ***/
+
+		/* Is there a next token for this field? */
+
+		status = mx_get_next_record_token( parse_status,
+				token_buffer, sizeof(token_buffer) );
+
+		if ( status.code != MXE_SUCCESS ) {
+			return mx_error( MXE_UNPARSEABLE_STRING, fname,
+			"Record description string was too short.  "
+			"Did not find valid token(s) for field '%s'",
+				record_field->name );
 		}
+
+		MX_DEBUG( 8,("Field '%s', field type = %s, token = '%s'",
+			record_field->name,
+			mx_get_field_type_string(field_type), token_buffer));
+
+		/* Now parse the token. */
+
+		status = (*fptr)( field_value_ptr, token_buffer,
+				record, record_field, parse_status );
+	} else {
+		/*** Array of tokens ***/
+
+		/* Call mx_parse_array_description() to
+		 * get all of the tokens and put them into 
+		 * the array.
+		 */
+
+		MX_DEBUG( 8,
+		("Field '%s', field type = %s, %ld dimensional array",
+			record_field->name,
+			mx_get_field_type_string(field_type),
+			record_field->num_dimensions));
+
+		status = mx_parse_array_description( field_value_ptr,
+				(record_field->num_dimensions - 1),
+				record, record_field, parse_status, fptr );
+	}
+
+	switch( status.code ) {
+	case MXE_SUCCESS:
+		break;
+	case MXE_UNPARSEABLE_STRING:
+		return mx_error( MXE_UNPARSEABLE_STRING, fname,
+		"Invalid token found in record '%s' at field '%s'.",
+			record->name, record_field->name );
+	default:
+		return status;
 	}
 
 	return MX_SUCCESSFUL_RESULT;
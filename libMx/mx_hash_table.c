@@ -3,11 +3,23 @@
  *
  * Purpose: Support for MX hash tables.
  *
+ *          The table is an array of MX_KEY_VALUE_PAIR entries searched
+ *          with linear probing.  It is doubled in size when it becomes
+ *          more than 3/4 full.  Deleting a key shifts any later entries
+ *          of the same probe sequence back into the hole, so the table
+ *          never contains tombstones and lookups never slow down as keys
+ *          come and go.
+ *
+ *          The copies of the keys live in fixed size cells that are
+ *          carved out of larger slabs, with freed cells kept on a free
+ *          list for reuse, so that inserting a key does not need a
+ *          separate malloc() of its own.
+ *
  * Author:  William Lavender
  *
  *--------------------------------------------------------------------------
  *
- * Copyright 2009, 2011 Illinois Institute of Technology
+ * Copyright 2009, 2011, 2026 Illinois Institute of Technology
  *
  * See the file "LICENSE" for information on usage and redistribution
  * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
@@ -16,58 +28,256 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "mx_util.h"
+#include "mx_stdint.h"
 #include "mx_hash_table.h"
 
+#define MX_HASH_TABLE_MINIMUM_SIZE		8
+
+#define MX_HASH_TABLE_MAXIMUM_CELLS_PER_SLAB	4096
+
+/* 32-bit FNV-1a hash of at most the first 'max_chars' characters. */
+
+static unsigned long
+mx_hash_table_fnv1a( const char *key, long max_chars )
+{
+	const unsigned char *ptr;
+	uint32_t hash;
+	long i;
+
+	hash = 2166136261U;
+
+	ptr = (const unsigned char *) key;
+
+	for ( i = 0; ( i < max_chars ) && ( ptr[i] != '\0' ); i++ ) {
+		hash ^= ptr[i];
+		hash *= 16777619U;
+	}
+
+	return (unsigned long) hash;
+}
+
 static long
 mx_default_hash_table_function( MX_HASH_TABLE *hash_table, const char *key )
 {
-	static const char fname[] = "mx_default_hash_table_function()";
+	unsigned long hash;
 
-	long i, max_key_length, hash;
-	unsigned long sum;
-	char c;
+	hash = mx_hash_table_fnv1a( key, hash_table->key_length - 1 );
 
-	if ( hash_table == (MX_HASH_TABLE *) NULL ) {
-		(void) mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_HASH_TABLE pointer passed was NULL." );
+	return (long) ( hash & (unsigned long) ( hash_table->table_size - 1 ) );
+}
+
+/* mx_hash_table_compute_hash() returns the value stored in the 'hash'
+ * field of an entry.  For the default hash function, this is the full
+ * 32-bit hash, so that it does not have to be recomputed when the table
+ * grows.  For a caller supplied hash function, it is the slot number
+ * that the function returned for the current table size.
+ */
+
+static mx_status_type
+mx_hash_table_compute_hash( MX_HASH_TABLE *hash_table,
+				const char *key,
+				unsigned long *hash )
+{
+	static const char fname[] = "mx_hash_table_compute_hash()";
+
+	long slot;
+
+	if ( hash_table->hash_function == mx_default_hash_table_function ) {
+		*hash = mx_hash_table_fnv1a( key, hash_table->key_length - 1 );
 
-		return -1;
+		return MX_SUCCESSFUL_RESULT;
 	}
 
-	if ( key == (const char *) NULL ) {
-		(void) mx_error( MXE_NULL_ARGUMENT, fname,
-		"The key pointer passed was NULL." );
+	slot = hash_table->hash_function( hash_table, key );
 
-		return -1;
+	if ( slot < 0 ) {
+		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
+		"The hash %ld returned for key '%s' by function %p "
+		"for hash table %p is less than zero.",
+			slot, key, hash_table->hash_function, hash_table );
+	} else
+	if ( slot >= hash_table->table_size ) {
+		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
+		"The hash %ld returned for key '%s' by function %p "
+		"for hash table %p is greater than the maximum value of %ld.",
+			slot, key, hash_table->hash_function, hash_table,
+			hash_table->table_size - 1 );
 	}
 
-	/* Compute the sum of all of the characters in the key. */
+	*hash = (unsigned long) slot;
 
-	max_key_length = hash_table->key_length;
+	return MX_SUCCESSFUL_RESULT;
+}
 
-	sum = 0;
+/* Returns the index of the entry for 'key' or -1 if it is not there. */
 
-	for ( i = 0; ; i++ ) {
-		if ( i >= max_key_length ) {
-			break;
+static long
+mx_hash_table_find( MX_HASH_TABLE *hash_table,
+			const char *key, unsigned long hash )
+{
+	MX_KEY_VALUE_PAIR *entry;
+	unsigned long i, mask;
+
+	mask = (unsigned long) ( hash_table->table_size - 1 );
+
+	i = hash & mask;
+
+	for (;;) {
+		entry = &(hash_table->array[i]);
+
+		if ( entry->key == (char *) NULL )
+			return -1;
+
+		if ( ( entry->hash == hash ) && ( strcmp( entry->key, key ) == 0 ) )
+			return (long) i;
+
+		i = ( i + 1 ) & mask;
+	}
+}
+
+/* Puts an entry into the first empty slot of its probe sequence. */
+
+static void
+mx_hash_table_place( MX_KEY_VALUE_PAIR *array, unsigned long mask,
+			MX_KEY_VALUE_PAIR *entry )
+{
+	unsigned long i;
+
+	i = entry->hash & mask;
+
+	while ( array[i].key != (char *) NULL ) {
+		i = ( i + 1 ) & mask;
+	}
+
+	array[i] = *entry;
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* Each slab starts with a pointer to the next slab, followed by the
+ * key cells.  Free cells are chained through their first bytes.
+ */
+
+static char *
+mx_hash_table_allocate_key_cell( MX_HASH_TABLE *hash_table )
+{
+	char *slab, *cell, *first_cell;
+	size_t header_size;
+	long i, num_cells;
+
+	if ( hash_table->free_key_list == NULL ) {
+		num_cells = hash_table->key_cells_per_slab;
+
+		header_size = sizeof(void *);
+
+		slab = (char *) malloc( header_size
+				+ num_cells * hash_table->key_cell_size );
+
+		if ( slab == (char *) NULL )
+			return NULL;
+
+		memcpy( slab, &(hash_table->key_slab_list), sizeof(void *) );
+
+		hash_table->key_slab_list = slab;
+
+		first_cell = slab + header_size;
+
+		for ( i = 0; i < num_cells; i++ ) {
+			cell = first_cell + i * hash_table->key_cell_size;
+
+			memcpy( cell, &(hash_table->free_key_list),
+						sizeof(void *) );
+
+			hash_table->free_key_list = cell;
 		}
 
-		c = key[i];
+		if ( ( 2 * num_cells ) <= MX_HASH_TABLE_MAXIMUM_CELLS_PER_SLAB )
+		{
+			hash_table->key_cells_per_slab = 2 * num_cells;
+		}
+	}
 
-		if ( c == '\0' ) {
-			break;
+	cell = (char *) hash_table->free_key_list;
+
+	memcpy( &(hash_table->free_key_list), cell, sizeof(void *) );
+
+	return cell;
+}
+
+static void
+mx_hash_table_free_key_cell( MX_HASH_TABLE *hash_table, char *cell )
+{
+	memcpy( cell, &(hash_table->free_key_list), sizeof(void *) );
+
+	hash_table->free_key_list = cell;
+}
+
+/*-------------------------------------------------------------------------*/
+
+static mx_status_type
+mx_hash_table_resize( MX_HASH_TABLE *hash_table, long new_table_size )
+{
+	static const char fname[] = "mx_hash_table_resize()";
+
+	MX_KEY_VALUE_PAIR *old_array, *new_array, entry;
+	long i, old_table_size;
+	mx_status_type mx_status;
+
+	new_array = (MX_KEY_VALUE_PAIR *)
+			calloc( new_table_size, sizeof(MX_KEY_VALUE_PAIR) );
+
+	if ( new_array == (MX_KEY_VALUE_PAIR *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to grow hash table %p "
+		"to %ld entries.", hash_table, new_table_size );
+	}
+
+	old_array = hash_table->array;
+	old_table_size = hash_table->table_size;
+
+	hash_table->table_size = new_table_size;
+
+	for ( i = 0; i < old_table_size; i++ ) {
+		entry = old_array[i];
+
+		if ( entry.key == (char *) NULL )
+			continue;
+
+		/* A caller supplied hash function depends on the size
+		 * of the table, so its value must be recomputed.
+		 */
+
+		if ( hash_table->hash_function
+				!= mx_default_hash_table_function )
+		{
+			mx_status = mx_hash_table_compute_hash( hash_table,
+							entry.key, &entry.hash );
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				hash_table->table_size = old_table_size;
+
+				mx_free( new_array );
+
+				return mx_status;
+			}
 		}
 
-		sum = sum + c;
+		mx_hash_table_place( new_array,
+				(unsigned long) ( new_table_size - 1 ), &entry );
 	}
 
-	hash = (long) ( sum % (hash_table->table_size) );
+	hash_table->array = new_array;
 
-	return hash;
+	mx_free( old_array );
+
+	return MX_SUCCESSFUL_RESULT;
 }
 
+/*-------------------------------------------------------------------------*/
+
 MX_EXPORT mx_status_type
 mx_hash_table_create( MX_HASH_TABLE **hash_table,
 			long key_length,
@@ -76,59 +286,76 @@ mx_hash_table_create( MX_HASH_TABLE **hash_table,
 {
 	static const char fname[] = "mx_hash_table_create()";
 
+	MX_HASH_TABLE *new_table;
+	long actual_table_size;
+
 	if ( hash_table == (MX_HASH_TABLE **) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
 		"The MX_HASH_TABLE pointer passed was NULL." );
 	}
 
-	*hash_table = malloc( sizeof(MX_HASH_TABLE) );
+	*hash_table = NULL;
+
+	if ( key_length <= 1 ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The key length %ld requested is too short.", key_length );
+	}
+
+	actual_table_size = MX_HASH_TABLE_MINIMUM_SIZE;
+
+	while ( actual_table_size < table_size ) {
+		actual_table_size *= 2;
+	}
+
+	new_table = (MX_HASH_TABLE *) malloc( sizeof(MX_HASH_TABLE) );
 
-	if ( *hash_table == (MX_HASH_TABLE *) NULL ) {
+	if ( new_table == (MX_HASH_TABLE *) NULL ) {
 		return mx_error( MXE_OUT_OF_MEMORY, fname,
 	   "Ran out of memory trying to allocate an MX_HASH_TABLE structure." );
 	}
 
-	(*hash_table)->key_length = key_length;
-	(*hash_table)->table_size = table_size;
-
-	(*hash_table)->array = calloc(table_size, sizeof(MX_KEY_VALUE_PAIR *));
+	new_table->array = (MX_KEY_VALUE_PAIR *)
+		calloc( actual_table_size, sizeof(MX_KEY_VALUE_PAIR) );
 
-	if ( (*hash_table)->array == (MX_KEY_VALUE_PAIR **) NULL ) {
-		mx_free( *hash_table );
+	if ( new_table->array == (MX_KEY_VALUE_PAIR *) NULL ) {
+		mx_free( new_table );
 
 		return mx_error( MXE_OUT_OF_MEMORY, fname,
-		"Ran out of memory trying to allocate a %lu element "
-		"table of MX_KEY_VALUE_PAIR structures.", table_size );
+		"Ran out of memory trying to allocate a %ld element "
+		"table of MX_KEY_VALUE_PAIR structures.", actual_table_size );
 	}
 
+	new_table->key_length = key_length;
+	new_table->table_size = actual_table_size;
+	new_table->num_keys = 0;
+
 	if ( hash_function == NULL ) {
-		(*hash_table)->hash_function = mx_default_hash_table_function;
+		new_table->hash_function = mx_default_hash_table_function;
 	} else {
-		(*hash_table)->hash_function = hash_function;
+		new_table->hash_function = hash_function;
 	}
 
-	return MX_SUCCESSFUL_RESULT;
-}
+	/* Key cells must be able to hold a free list pointer and are
+	 * padded to keep the pointers aligned.
+	 */
 
-static void
-mx_hash_table_destroy_hash_list( MX_KEY_VALUE_PAIR *list_start )
-{
-	MX_KEY_VALUE_PAIR *current_list_entry;
-	MX_KEY_VALUE_PAIR *next_list_entry;
+	new_table->key_cell_size = key_length;
 
-	current_list_entry = list_start;
+	if ( new_table->key_cell_size < sizeof(void *) ) {
+		new_table->key_cell_size = sizeof(void *);
+	}
 
-	while ( current_list_entry != NULL ) {
+	new_table->key_cell_size = ( ( new_table->key_cell_size
+			+ sizeof(void *) - 1 ) / sizeof(void *) )
+				* sizeof(void *);
 
-		next_list_entry = current_list_entry->next_list_entry;
+	new_table->key_slab_list = NULL;
+	new_table->free_key_list = NULL;
+	new_table->key_cells_per_slab = 16;
 
-		mx_free( current_list_entry->key );
-		mx_free( current_list_entry );
+	*hash_table = new_table;
 
-		current_list_entry = next_list_entry;
-	}
-
-	return;
+	return MX_SUCCESSFUL_RESULT;
 }
 
 MX_EXPORT void
@@ -136,23 +363,25 @@ mx_hash_table_destroy( MX_HASH_TABLE *hash_table )
 {
 	static const char fname[] = "mx_hash_table_destroy()";
 
-	MX_KEY_VALUE_PAIR *key_value_pair;
-	long i;
-	
+	char *slab, *next_slab;
+
 	if ( hash_table == (MX_HASH_TABLE *) NULL ) {
 		(void) mx_error( MXE_NULL_ARGUMENT, fname,
 		"The MX_HASH_TABLE pointer passed was NULL." );
 		return;
 	}
 
-	for ( i = 0; i < hash_table->table_size; i++ ) {
-		key_value_pair = hash_table->array[i];
+	slab = (char *) hash_table->key_slab_list;
 
-		if ( key_value_pair != (MX_KEY_VALUE_PAIR *) NULL ) {
-			mx_hash_table_destroy_hash_list( key_value_pair );
-		}
+	while ( slab != (char *) NULL ) {
+		memcpy( &next_slab, slab, sizeof(void *) );
+
+		mx_free( slab );
+
+		slab = next_slab;
 	}
 
+	mx_free( hash_table->array );
 	mx_free( hash_table );
 
 	return;
@@ -165,9 +394,10 @@ mx_hash_table_insert_key( MX_HASH_TABLE *hash_table,
 {
 	static const char fname[] = "mx_hash_table_insert_key()";
 
-	MX_KEY_VALUE_PAIR *list_entry, *new_list_entry;
-	MX_KEY_VALUE_PAIR **new_list_entry_ptr = NULL;
-	long hash;
+	MX_KEY_VALUE_PAIR new_entry;
+	unsigned long hash;
+	long i;
+	mx_status_type mx_status;
 
 	if ( hash_table == (MX_HASH_TABLE *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
@@ -178,77 +408,68 @@ mx_hash_table_insert_key( MX_HASH_TABLE *hash_table,
 		"The key pointer passed was NULL." );
 	}
 
-	/* Compute the hash for this key. */
-
-	hash = hash_table->hash_function( hash_table, key );
-
-	if ( hash < 0 ) {
+	if ( strlen( key ) >= (size_t) hash_table->key_length ) {
 		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
-		"The hash %ld returned for key '%s' by function %p "
-		"for hash table %p is less than zero.",
-			hash, key, hash_table->hash_function, hash_table );
-	} else
-	if ( hash >= hash_table->table_size ) {
-		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
-		"The hash %ld returned for key '%s' by function %p "
-		"for hash table %p is greater than the maximum value of %ld.",
-			hash, key, hash_table->hash_function, hash_table,
-			hash_table->table_size );
+		"Key '%s' is longer than the maximum length of %ld "
+		"for hash table %p.", key, hash_table->key_length - 1,
+			hash_table );
 	}
 
-	/* Find the correct place to insert the new key. */
+	mx_status = mx_hash_table_compute_hash( hash_table, key, &hash );
 
-	if ( hash_table->array[hash] == NULL ) {
-		new_list_entry_ptr = &(hash_table->array[hash]);
-	} else {
-		list_entry = hash_table->array[hash];
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-		while( list_entry != NULL ) {
+	i = mx_hash_table_find( hash_table, key, hash );
 
-			if ( strcmp( key, list_entry->key ) == 0 ) {
-				/* This key is already present, so we just
-				 * replace its value with the new value.
-				 */
+	if ( i >= 0 ) {
+		/* This key is already present, so we just
+		 * replace its value with the new value.
+		 */
 
-				list_entry->value = value;
+		hash_table->array[i].value = value;
 
-				return MX_SUCCESSFUL_RESULT;
-			}
+		return MX_SUCCESSFUL_RESULT;
+	}
 
-			if ( list_entry->next_list_entry == NULL ) {
-				new_list_entry_ptr =
-					&(list_entry->next_list_entry);
+	/* Grow the table if it would become more than 3/4 full. */
 
-				break;	/* Exit the while() loop. */
-			}
+	if ( 4 * ( hash_table->num_keys + 1 ) > 3 * hash_table->table_size ) {
 
-			list_entry = list_entry->next_list_entry;
-		}
-	}
+		mx_status = mx_hash_table_resize( hash_table,
+						2 * hash_table->table_size );
 
-	/* Create a new MX_KEY_VALUE_PAIR struct. */
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 
-	new_list_entry = malloc( sizeof(MX_KEY_VALUE_PAIR) );
+		if ( hash_table->hash_function
+				!= mx_default_hash_table_function )
+		{
+			mx_status = mx_hash_table_compute_hash( hash_table,
+								key, &hash );
 
-	if ( new_list_entry == (MX_KEY_VALUE_PAIR *) NULL ) {
-		return mx_error( MXE_OUT_OF_MEMORY, fname,
-		"Ran out of memory trying to create a new MX_KEY_VALUE_PAIR "
-		"for key '%s'.", key );
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+		}
 	}
 
-	new_list_entry->key = malloc( hash_table->key_length );
+	new_entry.key = mx_hash_table_allocate_key_cell( hash_table );
 
-	if ( new_list_entry->key == (char *) NULL ) {
+	if ( new_entry.key == (char *) NULL ) {
 		return mx_error( MXE_OUT_OF_MEMORY, fname,
 		"Ran out of memory trying to copy key '%s'.", key );
 	}
 
-	strlcpy( new_list_entry->key, key, hash_table->key_length );
+	strlcpy( new_entry.key, key, hash_table->key_length );
 
-	new_list_entry->value = value;
-	new_list_entry->next_list_entry = NULL;
+	new_entry.value = value;
+	new_entry.hash = hash;
 
-	*new_list_entry_ptr = new_list_entry;
+	mx_hash_table_place( hash_table->array,
+			(unsigned long) ( hash_table->table_size - 1 ),
+			&new_entry );
+
+	hash_table->num_keys++;
 
 	return MX_SUCCESSFUL_RESULT;
 }
@@ -259,9 +480,10 @@ mx_hash_table_delete_key( MX_HASH_TABLE *hash_table,
 {
 	static const char fname[] = "mx_hash_table_delete_key()";
 
-	MX_KEY_VALUE_PAIR *first_list_entry;
-	MX_KEY_VALUE_PAIR *previous_list_entry, *current_list_entry;
-	long hash;
+	MX_KEY_VALUE_PAIR *array;
+	unsigned long hash, mask, hole, i, home;
+	long found;
+	mx_status_type mx_status;
 
 	if ( hash_table == (MX_HASH_TABLE *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
@@ -272,82 +494,62 @@ mx_hash_table_delete_key( MX_HASH_TABLE *hash_table,
 		"The key pointer passed was NULL." );
 	}
 
-	/* Compute the hash for this key. */
+	mx_status = mx_hash_table_compute_hash( hash_table, key, &hash );
 
-	hash = hash_table->hash_function( hash_table, key );
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-	if ( hash < 0 ) {
-		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
-		"The hash %ld returned for key '%s' by function %p "
-		"for hash table %p is less than zero.",
-			hash, key, hash_table->hash_function, hash_table );
-	} else
-	if ( hash >= hash_table->table_size ) {
-		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
-		"The hash %ld returned for key '%s' by function %p "
-		"for hash table %p is greater than the maximum value of %ld.",
-			hash, key, hash_table->hash_function, hash_table,
-			hash_table->table_size );
-	}
+	found = mx_hash_table_find( hash_table, key, hash );
 
-	/* If there is no list for this hash, then return MXE_NOT_FOUND. */
-
-	if ( hash_table->array[hash] == (MX_KEY_VALUE_PAIR *) NULL ) {
+	if ( found < 0 ) {
 		return mx_error( MXE_NOT_FOUND | MXE_QUIET, fname,
 		"Key '%s' was not found in the hash table.", key );
 	}
 
-	/* Does this key match the first entry in the list? */
-
-	first_list_entry = hash_table->array[hash];
-
-	if ( strcmp( key, first_list_entry->key ) == 0 ) {
+	array = hash_table->array;
+	mask = (unsigned long) ( hash_table->table_size - 1 );
 
-		/* If so, then delete it. */
+	mx_hash_table_free_key_cell( hash_table, array[found].key );
 
-		hash_table->array[hash] = first_list_entry->next_list_entry;
+	/* Shift back any following entries that would no longer be
+	 * reachable from their home slot across the new hole.
+	 */
 
-		mx_free( first_list_entry->key );
-		mx_free( first_list_entry );
-
-		return MX_SUCCESSFUL_RESULT;
-	}
+	hole = (unsigned long) found;
+	i = hole;
 
-	/* Look through the rest of the list. */
+	for (;;) {
+		i = ( i + 1 ) & mask;
 
-	previous_list_entry = first_list_entry;
-
-	current_list_entry = previous_list_entry->next_list_entry;
-
-	while(1) {
-		if ( strcmp( key, current_list_entry->key ) == 0 ) {
-
-			/* This is the matching list entry, so delete it. */
+		if ( array[i].key == (char *) NULL )
+			break;
 
-			previous_list_entry->next_list_entry
-				= current_list_entry->next_list_entry;
+		home = array[i].hash & mask;
 
-			mx_free( current_list_entry->key );
-			mx_free( current_list_entry );
+		/* The entry at 'i' may move into the hole only if its home
+		 * slot does not lie cyclically in the range (hole, i].
+		 */
 
-			return MX_SUCCESSFUL_RESULT;
+		if ( hole <= i ) {
+			if ( ( hole < home ) && ( home <= i ) )
+				continue;
+		} else {
+			if ( ( hole < home ) || ( home <= i ) )
+				continue;
 		}
 
-		previous_list_entry = current_list_entry;
-
-		current_list_entry = current_list_entry->next_list_entry;
+		array[hole] = array[i];
 
-		if ( current_list_entry == (MX_KEY_VALUE_PAIR *) NULL ) {
-			return mx_error( MXE_NOT_FOUND | MXE_QUIET, fname,
-			"Key '%s' was not found in the hash table.", key );
-		}
+		hole = i;
 	}
 
-#if defined(OS_SOLARIS) || defined(OS_UNIXWARE)
-	/* Do nothing */
-#else
+	array[hole].key = NULL;
+	array[hole].value = NULL;
+	array[hole].hash = 0;
+
+	hash_table->num_keys--;
+
 	return MX_SUCCESSFUL_RESULT;
-#endif
 }
 
 MX_EXPORT mx_status_type
@@ -357,8 +559,9 @@ mx_hash_table_lookup_key( MX_HASH_TABLE *hash_table,
 {
 	static const char fname[] = "mx_hash_table_lookup_key()";
 
-	MX_KEY_VALUE_PAIR *list_entry;
-	long hash;
+	unsigned long hash;
+	long i;
+	mx_status_type mx_status;
 
 	if ( hash_table == (MX_HASH_TABLE *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
@@ -369,59 +572,20 @@ mx_hash_table_lookup_key( MX_HASH_TABLE *hash_table,
 		"The key pointer passed was NULL." );
 	}
 
-	/* Compute the hash for this key. */
+	mx_status = mx_hash_table_compute_hash( hash_table, key, &hash );
 
-	hash = hash_table->hash_function( hash_table, key );
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-	if ( hash < 0 ) {
-		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
-		"The hash %ld returned for key '%s' by function %p "
-		"for hash table %p is less than zero.",
-			hash, key, hash_table->hash_function, hash_table );
-	} else
-	if ( hash >= hash_table->table_size ) {
-		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
-		"The hash %ld returned for key '%s' by function %p "
-		"for hash table %p is greater than the maximum value of %ld.",
-			hash, key, hash_table->hash_function, hash_table,
-			hash_table->table_size );
-	}
+	i = mx_hash_table_find( hash_table, key, hash );
 
-	/* If there is no list for this hash, then return MXE_NOT_FOUND. */
-
-	if ( hash_table->array[hash] == (MX_KEY_VALUE_PAIR *) NULL ) {
+	if ( i < 0 ) {
 		return mx_error( MXE_NOT_FOUND | MXE_QUIET, fname,
 		"Key '%s' was not found in the hash table.", key );
 	}
 
-	/* Look for the key in the list. */
-
-	list_entry = hash_table->array[hash];
-
-	while(1) {
-		if ( strcmp( key, list_entry->key ) == 0 ) {
-
-			/* This is the matching list entry,
-			 * so return the value for it.
-			 */
-
-			*value = list_entry->value;
-
-			return MX_SUCCESSFUL_RESULT;
-		}
-
-		list_entry = list_entry->next_list_entry;
-
-		if ( list_entry == (MX_KEY_VALUE_PAIR *) NULL ) {
-			return mx_error( MXE_NOT_FOUND | MXE_QUIET, fname,
-			"Key '%s' was not found in the hash table.", key );
-		}
-	}
+	*value = hash_table->array[i].value;
 
-#if defined(OS_SOLARIS) || defined(OS_UNIXWARE)
-	/* Do nothing */
-#else
 	return MX_SUCCESSFUL_RESULT;
-#endif
 }
 
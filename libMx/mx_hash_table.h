@@ -3,11 +3,17 @@
  *
  * Purpose: Support for MX hash tables.
  *
+ *          MX hash tables map string keys to pointer values.  They use
+ *          open addressing with linear probing, grow automatically as
+ *          keys are added, and remove keys by shifting later entries
+ *          back rather than by leaving tombstones.  Copies of the keys
+ *          are kept in fixed size cells carved out of larger slabs.
+ *
  * Author:  William Lavender
  *
  *-------------------------------------------------------------------------
  *
- * Copyright 2009 Illinois Institute of Technology
+ * Copyright 2009, 2026 Illinois Institute of Technology
  *
  * See the file "LICENSE" for information on usage and redistribution
  * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
@@ -23,19 +29,36 @@
 extern "C" {
 #endif
 
+/* An entry in the table.  Empty entries have a NULL 'key'. */
+
 typedef struct mx_key_value_pair_t {
 	char *key;
 	void *value;
-	struct mx_key_value_pair_t *next_list_entry;
+	unsigned long hash;
 } MX_KEY_VALUE_PAIR;
 
 typedef struct mx_hash_table_t {
 	long key_length;
-	long table_size;
-	MX_KEY_VALUE_PAIR **array;
+	long table_size;		/* Always a power of 2. */
+	long num_keys;
+	MX_KEY_VALUE_PAIR *array;
 	long (*hash_function)( struct mx_hash_table_t *, const char * );
+
+	/* Storage for the copies of the keys. */
+
+	void *key_slab_list;
+	void *free_key_list;
+	size_t key_cell_size;
+	long key_cells_per_slab;
 } MX_HASH_TABLE;
 
+/* 'table_size' is only the initial size of the table.  It is rounded up
+ * to a power of 2 and the table is doubled in size whenever it becomes
+ * more than 3/4 full.  If 'hash_function' is NULL, a 32-bit FNV-1a hash
+ * of the key is used.  A caller supplied 'hash_function' must return a
+ * value from 0 to hash_table->table_size - 1 for the current table size.
+ */
+
 MX_API mx_status_type mx_hash_table_create( MX_HASH_TABLE **hash_table,
 				long key_length,
 				long table_size,
@@ -115,6 +115,21 @@ mxr_create_list_head( MX_RECORD *record )
 
 	record->record_field_array = record_field_array;
 
+	/* Use the field name index of the list head driver, if the
+	 * drivers have already been initialized.
+	 */
+
+	{
+		MX_DRIVER *list_head_driver;
+
+		list_head_driver = mx_get_driver_by_type( MXT_LIST_HEAD );
+
+		if ( list_head_driver != (MX_DRIVER *) NULL ) {
+			record->field_name_index =
+				list_head_driver->field_name_index;
+		}
+	}
+
 	/* Fill in the record field array. */
 
 	for ( i = 0; i < record->num_record_fields; i++ ) {
@@ -168,6 +183,8 @@ mxr_create_list_head( MX_RECORD *record )
 	list_head_struct->server_protocols_active = 0;
 	list_head_struct->handle_table = NULL;
 	list_head_struct->application_ptr = NULL;
+	list_head_struct->record_name_index = NULL;
+	list_head_struct->record_arena = NULL;
 
 	list_head_struct->default_precision = 8;
 
@@ -179,21 +196,31 @@ mxr_create_list_head( MX_RECORD *record )
 
 	list_head_struct->client_callback_handle_table = NULL;
 	list_head_struct->server_callback_handle_table = NULL;
+	list_head_struct->callback_poll_wheel = NULL;
 
 	list_head_struct->master_timer = NULL;
 	list_head_struct->callback_timer = NULL;
 
-	list_head_struct->callback_pipe = NULL;
+	list_head_struct->callback_queue = NULL;
 
 	list_head_struct->num_poll_callbacks = 0;
 	list_head_struct->poll_callback_interval = -1;
 
+	list_head_struct->callback_message_handler = NULL;
+	list_head_struct->poll_callback_dispatcher = NULL;
+
 	list_head_struct->module_list = NULL;
 
 	list_head_struct->socket_multiplexer_type = 0;
 
 	list_head_struct->max_network_dump_bytes = 0;
 
+	list_head_struct->max_client_queue_bytes = 0;
+	list_head_struct->max_client_queue_messages = 0;
+	list_head_struct->client_queue_overflow_policy = 0;
+
+	list_head_struct->num_open_threads = 0;
+
 	list_head_struct->show_thread_list = FALSE;
 	list_head_struct->show_thread_info = 0L;
 	list_head_struct->show_thread_stack = 0L;
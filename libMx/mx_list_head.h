@@ -270,6 +270,21 @@ extern "C" {
 			offsetof(MX_LIST_HEAD, max_network_dump_bytes), \
 	{0}, NULL, 0}, \
   \
+  {-1, -1, "max_client_queue_bytes", MXFT_ULONG, NULL, 0, {0}, \
+	MXF_REC_SUPERCLASS_STRUCT, \
+			offsetof(MX_LIST_HEAD, max_client_queue_bytes), \
+	{0}, NULL, 0}, \
+  \
+  {-1, -1, "max_client_queue_messages", MXFT_ULONG, NULL, 0, {0}, \
+	MXF_REC_SUPERCLASS_STRUCT, \
+			offsetof(MX_LIST_HEAD, max_client_queue_messages), \
+	{0}, NULL, 0}, \
+  \
+  {-1, -1, "client_queue_overflow_policy", MXFT_ULONG, NULL, 0, {0}, \
+	MXF_REC_SUPERCLASS_STRUCT, \
+			offsetof(MX_LIST_HEAD, client_queue_overflow_policy), \
+	{0}, NULL, 0}, \
+  \
   {MXLV_LHD_SHOW_THREAD_LIST, -1, "show_thread_list", MXFT_HEX, NULL, 0, {0},\
 	MXF_REC_SUPERCLASS_STRUCT, offsetof(MX_LIST_HEAD, show_thread_list), \
 	{0}, NULL, 0}, \
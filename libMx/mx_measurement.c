@@ -16,6 +16,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <limits.h>
 
 #include "mx_util.h"
@@ -417,6 +418,54 @@ mx_acquire_data( MX_MEASUREMENT *measurement )
 	return mx_status;
 }
 
+/* mx_readout_class_array() reads all of the scan input devices of the
+ * given class with one call to the class's array read function.  Drivers
+ * that support it, such as the network drivers, then send all of their
+ * requests at once, batched per MX server.
+ */
+
+static mx_status_type
+mx_readout_class_array( MX_SCAN *scan, long mx_class,
+			MX_RECORD **class_record_array )
+{
+	MX_RECORD *input_device;
+	long i, num_class_records;
+	mx_status_type mx_status;
+
+	num_class_records = 0;
+
+	for ( i = 0; i < scan->num_input_devices; i++ ) {
+		input_device = scan->input_device_array[i];
+
+		if ( ( input_device->mx_superclass == MXR_DEVICE )
+		  && ( input_device->mx_class == mx_class ) )
+		{
+			class_record_array[ num_class_records ] = input_device;
+
+			num_class_records++;
+		}
+	}
+
+	if ( num_class_records == 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	switch( mx_class ) {
+	case MXC_ANALOG_INPUT:
+		mx_status = mx_analog_input_array_read( num_class_records,
+						class_record_array, NULL );
+		break;
+	case MXC_SCALER:
+		mx_status = mx_scaler_array_read( num_class_records,
+						class_record_array, NULL );
+		break;
+	default:
+		mx_status = MX_SUCCESSFUL_RESULT;
+		break;
+	}
+
+	return mx_status;
+}
+
 MX_EXPORT mx_status_type
 mx_readout_data( MX_MEASUREMENT *measurement )
 {
@@ -424,11 +473,10 @@ mx_readout_data( MX_MEASUREMENT *measurement )
 
 	MX_SCAN *scan;
 	MX_RECORD **input_device_array;
+	MX_RECORD **class_record_array;
 	MX_RECORD *input_device;
-	MX_SCALER *scaler;
 	MX_AREA_DETECTOR *ad;
 	double double_value;
-	long long_value;
 	unsigned long ulong_value;
 	long i;
 	mx_status_type mx_status;
@@ -449,7 +497,34 @@ mx_readout_data( MX_MEASUREMENT *measurement )
 			scan->record->name );
 	}
 
-	/* Read out and save the values from the input devices. */
+	/* Analog inputs and scalers are read first, each class as a group. */
+
+	if ( scan->num_input_devices > 0 ) {
+		class_record_array = (MX_RECORD **)
+		    malloc( scan->num_input_devices * sizeof(MX_RECORD *) );
+
+		if ( class_record_array == (MX_RECORD **) NULL ) {
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate a %ld element "
+			"input device array for scan '%s'.",
+				scan->num_input_devices, scan->record->name );
+		}
+
+		mx_status = mx_readout_class_array( scan, MXC_ANALOG_INPUT,
+							class_record_array );
+
+		if ( mx_status.code == MXE_SUCCESS ) {
+			mx_status = mx_readout_class_array( scan, MXC_SCALER,
+							class_record_array );
+		}
+
+		mx_free( class_record_array );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	/* Read out and save the values from the other input devices. */
 
 	for ( i = 0; i < scan->num_input_devices; i++ ) {
 		input_device = input_device_array[i];
@@ -471,11 +546,9 @@ mx_readout_data( MX_MEASUREMENT *measurement )
 		case MXR_DEVICE:
 			switch( input_device->mx_class ) {
 			case MXC_ANALOG_INPUT:
-				mx_status = mx_analog_input_read(
-						input_device, &double_value );
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return mx_status;
-				}
+			case MXC_SCALER:
+				/* These have already been read above. */
+
 				break;
 			case MXC_ANALOG_OUTPUT:
 				mx_status = mx_analog_output_read(
@@ -505,17 +578,6 @@ mx_readout_data( MX_MEASUREMENT *measurement )
 					return mx_status;
 				}
 				break;
-			case MXC_SCALER:
-				mx_status = mx_scaler_read(
-						input_device, &long_value );
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return mx_status;
-				}
-				scaler = (MX_SCALER *)
-					(input_device->record_class_struct);
-
-				scaler->value = long_value;
-				break;
 			case MXC_TIMER:
 				mx_status = mx_timer_read(
 						input_device, &double_value );
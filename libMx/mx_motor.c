@@ -47,6 +47,143 @@
 #include "mx_callback.h"
 #include "mx_motor.h"
 
+/* How long to sleep between status checks while waiting for motors
+ * to stop.  The wait functions start with a short sleep so that short
+ * moves finish promptly and then back off to the old 10 millisecond
+ * interval for long moves.  A move is thus seen to have ended within
+ * 1 millisecond only during its first few milliseconds.
+ *
+ * Once the backoff has reached its ceiling, drivers that provide the
+ * wait_for_status_event() method are asked to wait for a status change
+ * instead of the wait functions just sleeping, if the motors have the
+ * MXF_MTR_WAIT_FOR_STATUS_EVENTS record flag set.  For network motors,
+ * this lets a status callback from the server end the wait early, but
+ * only as early as the server's value changed poll interval allows.
+ * Subscribing is not done for shorter waits, since it costs a round
+ * trip per motor.
+ */
+
+#define MXP_MOTOR_WAIT_MIN_SLEEP_USEC	1000
+#define MXP_MOTOR_WAIT_MAX_SLEEP_USEC	10000
+
+typedef struct {
+	long num_motor_records;
+	MX_RECORD **motor_record_array;
+	MX_MOTOR_FUNCTION_LIST *event_flist;
+	mx_bool_type use_status_events;
+	mx_bool_type status_events_started;
+	unsigned long sleep_usec;
+} MXP_MOTOR_WAIT;
+
+static mx_status_type mx_motor_finish_get_status( MX_RECORD *motor_record,
+						MX_MOTOR *motor,
+						mx_status_type mx_status,
+						unsigned long *motor_status );
+
+static void
+mxp_motor_wait_setup( MXP_MOTOR_WAIT *wait,
+			long num_motor_records,
+			MX_RECORD **motor_record_array )
+{
+	MX_MOTOR *motor;
+	MX_MOTOR_FUNCTION_LIST *flist;
+	long i;
+
+	wait->num_motor_records = num_motor_records;
+	wait->motor_record_array = motor_record_array;
+	wait->event_flist = NULL;
+	wait->use_status_events = FALSE;
+	wait->status_events_started = FALSE;
+	wait->sleep_usec = MXP_MOTOR_WAIT_MIN_SLEEP_USEC;
+
+	/* Status events are only used if all of the motors ask for them,
+	 * use the same driver and that driver supports them.
+	 */
+
+	for ( i = 0; i < num_motor_records; i++ ) {
+		motor = (MX_MOTOR *) motor_record_array[i]->record_class_struct;
+
+		if ( ( motor == (MX_MOTOR *) NULL )
+		  || ( ( motor->motor_flags
+				& MXF_MTR_WAIT_FOR_STATUS_EVENTS ) == 0 ) )
+		{
+			return;
+		}
+
+		flist = (MX_MOTOR_FUNCTION_LIST *)
+			motor_record_array[i]->class_specific_function_list;
+
+		if ( ( flist == (MX_MOTOR_FUNCTION_LIST *) NULL )
+		  || ( flist->wait_for_status_event == NULL )
+		  || ( flist->end_status_events == NULL ) )
+		{
+			return;
+		}
+
+		if ( i == 0 ) {
+			wait->event_flist = flist;
+		} else
+		if ( flist != wait->event_flist ) {
+			wait->event_flist = NULL;
+			return;
+		}
+	}
+
+	if ( wait->event_flist != (MX_MOTOR_FUNCTION_LIST *) NULL ) {
+		wait->use_status_events = TRUE;
+	}
+}
+
+static void
+mxp_motor_wait_sleep( MXP_MOTOR_WAIT *wait )
+{
+	mx_bool_type status_changed;
+	mx_status_type mx_status;
+
+	if ( ( wait->use_status_events == FALSE )
+	  || ( wait->sleep_usec < MXP_MOTOR_WAIT_MAX_SLEEP_USEC ) )
+	{
+		mx_usleep( wait->sleep_usec );
+
+		wait->sleep_usec *= 2;
+
+		if ( wait->sleep_usec > MXP_MOTOR_WAIT_MAX_SLEEP_USEC ) {
+			wait->sleep_usec = MXP_MOTOR_WAIT_MAX_SLEEP_USEC;
+		}
+		return;
+	}
+
+	wait->status_events_started = TRUE;
+
+	status_changed = FALSE;
+
+	mx_status = (*(wait->event_flist->wait_for_status_event))(
+				wait->num_motor_records,
+				wait->motor_record_array,
+				1.0e-6 * (double) wait->sleep_usec,
+				&status_changed );
+
+	/* If the driver cannot deliver status events, go back
+	 * to just sleeping for the rest of this wait.
+	 */
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		wait->use_status_events = FALSE;
+
+		mx_usleep( wait->sleep_usec );
+	}
+}
+
+static void
+mxp_motor_wait_finish( MXP_MOTOR_WAIT *wait )
+{
+	if ( wait->status_events_started ) {
+		(void) (*(wait->event_flist->end_status_events))(
+				wait->num_motor_records,
+				wait->motor_record_array );
+	}
+}
+
 /*=======================================================================*/
 
 /* This function is used by a motor's finish_record_initialization
@@ -1044,8 +1181,10 @@ mx_motor_array_internal_move_with_report( long num_motors,
 	return MX_SUCCESSFUL_RESULT;
 }
 
-MX_EXPORT mx_status_type
-mx_wait_for_motor_stop( MX_RECORD *motor_record, unsigned long flags )
+static mx_status_type
+mxp_wait_for_motor_stop( MX_RECORD *motor_record,
+			unsigned long flags,
+			MXP_MOTOR_WAIT *wait )
 {
 	static const char fname[] = "mx_wait_for_motor_stop()";
 
@@ -1238,7 +1377,7 @@ mx_wait_for_motor_stop( MX_RECORD *motor_record, unsigned long flags )
 			}
 		}
 
-		mx_msleep(10);
+		mxp_motor_wait_sleep( wait );
 	}
 
 	MX_DEBUG( 2,("%s complete for motor '%s'.", fname, motor_record->name));
@@ -1247,15 +1386,32 @@ mx_wait_for_motor_stop( MX_RECORD *motor_record, unsigned long flags )
 }
 
 MX_EXPORT mx_status_type
-mx_wait_for_motor_array_stop( long num_motor_records,
+mx_wait_for_motor_stop( MX_RECORD *motor_record, unsigned long flags )
+{
+	MXP_MOTOR_WAIT wait;
+	mx_status_type mx_status;
+
+	mxp_motor_wait_setup( &wait, 1, &motor_record );
+
+	mx_status = mxp_wait_for_motor_stop( motor_record, flags, &wait );
+
+	mxp_motor_wait_finish( &wait );
+
+	return mx_status;
+}
+
+static mx_status_type
+mxp_wait_for_motor_array_stop( long num_motor_records,
 			MX_RECORD **motor_record_array,
-			unsigned long flags )
+			unsigned long flags,
+			MXP_MOTOR_WAIT *wait )
 {
 	static const char fname[] = "mx_wait_for_motor_array_stop()";
 
 	int i, j, interrupt;
 	int motor_is_moving, any_error_occurred;
 	unsigned long motor_status, error_bitmask;
+	unsigned long *motor_status_array;
 	unsigned long hardware_limit_bitmask, software_limit_bitmask;
 	unsigned long ignore_keyboard, ignore_limit_switches;
 	unsigned long ignore_pause;
@@ -1292,30 +1448,51 @@ mx_wait_for_motor_array_stop( long num_motor_records,
 		error_bitmask = 0;
 	}
 
+	if ( num_motor_records <= 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	motor_status_array = (unsigned long *)
+			malloc( num_motor_records * sizeof(unsigned long) );
+
+	if ( motor_status_array == (unsigned long *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %ld element "
+		"motor status array.", num_motor_records );
+	}
+
 	motor_is_moving = TRUE;
 	any_error_occurred = FALSE;
 
 	for(;;) {
 		motor_is_moving = FALSE;
 
-		for ( i = 0; i < num_motor_records; i++ ) {
-
 #if MX_MOTOR_DEBUG_WAIT_ARRAY_TIMING
-			MX_HRT_START( get_status_measurement );
+		MX_HRT_START( get_status_measurement );
 #endif
 
-			/* What is the status of this motor? */
+		/* Get the status of all of the motors at once. */
 
-			mx_status = mx_motor_get_status(
-					motor_record_array[i], &motor_status );
+		mx_status = mx_motor_array_get_status( num_motor_records,
+					motor_record_array, motor_status_array );
 
-			if ( mx_status.code != MXE_SUCCESS ) {
-				for ( j = 0; j < num_motor_records; j++ ) {
-					(void) mx_motor_soft_abort(
-						motor_record_array[j]);
-				}
-				return mx_status;
+#if MX_MOTOR_DEBUG_WAIT_ARRAY_TIMING
+		MX_HRT_END( get_status_measurement );
+		MX_HRT_RESULTS( get_status_measurement, fname,
+						"get move status" );
+#endif
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			for ( j = 0; j < num_motor_records; j++ ) {
+				(void) mx_motor_soft_abort(
+					motor_record_array[j]);
 			}
+			mx_free( motor_status_array );
+			return mx_status;
+		}
+
+		for ( i = 0; i < num_motor_records; i++ ) {
+
+			motor_status = motor_status_array[i];
 
 			if ( motor_status & MXSF_MTR_IS_BUSY )
 				motor_is_moving = TRUE;
@@ -1356,67 +1533,64 @@ mx_wait_for_motor_array_stop( long num_motor_records,
 				mx_warning( "Motor '%s' is open loop.",
 					motor_record_array[i]->name );
 			}
+		}
 
 #if MX_MOTOR_DEBUG_WAIT_ARRAY_TIMING
-			MX_HRT_END( get_status_measurement );
-			MX_HRT_RESULTS( get_status_measurement, fname,
-							"get move status" );
-
-			MX_HRT_START( check_keyboard_measurement );
+		MX_HRT_START( check_keyboard_measurement );
 #endif
-			if ( ignore_keyboard == FALSE ) {
-				/* Did someone hit a key? */
+		if ( ignore_keyboard == FALSE ) {
+			/* Did someone hit a key? */
 
-				interrupt =
-					mx_user_requested_interrupt_or_pause();
+			interrupt = mx_user_requested_interrupt_or_pause();
 
-				switch( interrupt ) {
-				case MXF_USER_INT_NONE:
-					/* No interrupt occurred. */
+			switch( interrupt ) {
+			case MXF_USER_INT_NONE:
+				/* No interrupt occurred. */
 
-					break;
+				break;
 
-				case MXF_USER_INT_ABORT:
+			case MXF_USER_INT_ABORT:
 
-					for (j=0; j < num_motor_records; j++){
-						(void) mx_motor_soft_abort(
-							motor_record_array[j]);
-					}
-					return mx_error(
-						MXE_INTERRUPTED, fname,
-				    "Motor moves aborted due to user request.");
-
-				case MXF_USER_INT_PAUSE:
-					if ( ignore_pause == FALSE ) {
-						return mx_error(
-							MXE_PAUSE_REQUESTED,
-							fname,
-						"Pause requested by user." );
-					}
-					break;
+				for ( j = 0; j < num_motor_records; j++ ) {
+					(void) mx_motor_soft_abort(
+						motor_record_array[j]);
+				}
+				mx_free( motor_status_array );
 
-				case MXF_USER_INT_ERROR:
-					return mx_error(
-						MXE_FUNCTION_FAILED, fname,
+				return mx_error( MXE_INTERRUPTED, fname,
+				"Motor moves aborted due to user request.");
+
+			case MXF_USER_INT_PAUSE:
+				if ( ignore_pause == FALSE ) {
+					mx_free( motor_status_array );
+
+					return mx_error( MXE_PAUSE_REQUESTED,
+					fname, "Pause requested by user." );
+				}
+				break;
+
+			case MXF_USER_INT_ERROR:
+				mx_free( motor_status_array );
+
+				return mx_error( MXE_FUNCTION_FAILED, fname,
 				    "An error occurred while attempting to "
 				    "check for a user requested interrupt." );
 
-				default:
-					return mx_error(
-						MXE_FUNCTION_FAILED,
-						fname,
+			default:
+				mx_free( motor_status_array );
+
+				return mx_error( MXE_FUNCTION_FAILED, fname,
 				    "Unexpected value %d returned "
 				    "by mx_user_requested_interrupt()",
-						interrupt );
-				}
+					interrupt );
 			}
+		}
 
 #if MX_MOTOR_DEBUG_WAIT_ARRAY_TIMING
-			MX_HRT_END( check_keyboard_measurement );
-			MX_HRT_RESULTS( check_keyboard_measurement, fname,
-							"check keyboard" );
+		MX_HRT_END( check_keyboard_measurement );
+		MX_HRT_RESULTS( check_keyboard_measurement, fname,
+						"check keyboard" );
 #endif
-		}
 
 #if MX_MOTOR_DEBUG_WAIT_ARRAY_TIMING
 		MX_HRT_START( msleep_measurement );
@@ -1427,6 +1601,8 @@ mx_wait_for_motor_array_stop( long num_motor_records,
 				(void) mx_motor_soft_abort(
 						motor_record_array[j]);
 			}
+			mx_free( motor_status_array );
+
 			return mx_error( MXE_INTERRUPTED, fname,
 			"Motor moves aborted due to errors." );
 		}
@@ -1434,14 +1610,16 @@ mx_wait_for_motor_array_stop( long num_motor_records,
 		if ( motor_is_moving == FALSE )
 			break;			/* Exit the for loop. */
 
-		mx_msleep(10);
+		mxp_motor_wait_sleep( wait );
 
 #if MX_MOTOR_DEBUG_WAIT_ARRAY_TIMING
 		MX_HRT_END( msleep_measurement );
-		MX_HRT_RESULTS( msleep_measurement, fname, "mx_msleep(10)" );
+		MX_HRT_RESULTS( msleep_measurement, fname, "mx_usleep()" );
 #endif
 	}
 
+	mx_free( motor_status_array );
+
 #if MX_MOTOR_DEBUG_WAIT_ARRAY_TIMING
 	MX_HRT_END( total_wait_measurement );
 	MX_HRT_RESULTS( total_wait_measurement, fname, "TOTAL wait" );
@@ -1452,6 +1630,27 @@ mx_wait_for_motor_array_stop( long num_motor_records,
 	return MX_SUCCESSFUL_RESULT;
 }
 
+MX_EXPORT mx_status_type
+mx_wait_for_motor_array_stop( long num_motor_records,
+			MX_RECORD **motor_record_array,
+			unsigned long flags )
+{
+	MXP_MOTOR_WAIT wait;
+	mx_status_type mx_status;
+
+	if ( num_motor_records <= 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	mxp_motor_wait_setup( &wait, num_motor_records, motor_record_array );
+
+	mx_status = mxp_wait_for_motor_array_stop( num_motor_records,
+					motor_record_array, flags, &wait );
+
+	mxp_motor_wait_finish( &wait );
+
+	return mx_status;
+}
+
 /* mx_motor_internal_move_absolute() bypasses all of the backlash and limit
  * logic.  You should not invoke it directly unless you are prepared to handle
  * limits and backlash yourself.
@@ -2660,6 +2859,20 @@ mx_motor_get_status( MX_RECORD *motor_record,
 		(void) mx_motor_set_traditional_status( motor );
 	}
 
+	return mx_motor_finish_get_status( motor_record, motor,
+						mx_status, motor_status );
+}
+
+/* mx_motor_finish_get_status() applies the status bits that are managed
+ * by MX itself on top of the status that was reported by the driver.
+ */
+
+static mx_status_type
+mx_motor_finish_get_status( MX_RECORD *motor_record,
+				MX_MOTOR *motor,
+				mx_status_type mx_status,
+				unsigned long *motor_status )
+{
 	if ( motor->busy_start_interval_enabled ) {
 		mx_bool_type busy_start_set;
 
@@ -2708,6 +2921,147 @@ mx_motor_get_status( MX_RECORD *motor_record,
 	return mx_status;
 }
 
+MX_EXPORT mx_status_type
+mx_motor_array_get_status( long num_motor_records,
+			MX_RECORD **motor_record_array,
+			unsigned long *motor_status_array )
+{
+	static const char fname[] = "mx_motor_array_get_status()";
+
+	MX_MOTOR *motor;
+	MX_MOTOR_FUNCTION_LIST *fl_ptr;
+	mx_status_type ( *array_fptr )( long, MX_RECORD ** );
+	MX_RECORD **driver_record_array;
+	mx_bool_type *status_read;
+	long i, j, num_driver_records;
+	mx_status_type mx_status, array_status;
+
+	if ( motor_record_array == (MX_RECORD **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The motor_record_array pointer passed was NULL." );
+	}
+	if ( motor_status_array == (unsigned long *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The motor_status_array pointer passed was NULL." );
+	}
+
+	if ( num_motor_records <= 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	driver_record_array = (MX_RECORD **)
+			malloc( num_motor_records * sizeof(MX_RECORD *) );
+
+	status_read = (mx_bool_type *)
+			calloc( num_motor_records, sizeof(mx_bool_type) );
+
+	if ( ( driver_record_array == (MX_RECORD **) NULL )
+	  || ( status_read == (mx_bool_type *) NULL ) )
+	{
+		mx_free( driver_record_array );
+		mx_free( status_read );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate arrays for "
+		"%ld motor records.", num_motor_records );
+	}
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	for ( i = 0; i < num_motor_records; i++ ) {
+
+		if ( status_read[i] )
+			continue;
+
+		mx_status = mx_motor_get_pointers( motor_record_array[i],
+						&motor, &fl_ptr, fname );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
+
+		array_fptr = fl_ptr->get_status_array;
+
+		if ( array_fptr == NULL ) {
+			status_read[i] = TRUE;
+
+			mx_status = mx_motor_get_status( motor_record_array[i],
+						&motor_status_array[i] );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+
+			continue;
+		}
+
+		/* Gather the rest of the motors that use the same
+		 * get_status_array() function.
+		 */
+
+		num_driver_records = 0;
+
+		for ( j = i; j < num_motor_records; j++ ) {
+			if ( status_read[j] )
+				continue;
+
+			mx_status = mx_motor_get_pointers(
+						motor_record_array[j],
+						&motor, &fl_ptr, fname );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+
+			if ( fl_ptr->get_status_array == array_fptr ) {
+				status_read[j] = TRUE;
+
+				driver_record_array[ num_driver_records ]
+						= motor_record_array[j];
+
+				num_driver_records++;
+			}
+		}
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
+
+		array_status = ( *array_fptr )( num_driver_records,
+						driver_record_array );
+
+		for ( j = 0; j < num_driver_records; j++ ) {
+			motor = (MX_MOTOR *)
+				driver_record_array[j]->record_class_struct;
+
+			(void) mx_motor_set_traditional_status( motor );
+
+			mx_status = mx_motor_finish_get_status(
+					driver_record_array[j], motor,
+					array_status, NULL );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+		}
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
+	}
+
+	/* Copy out the status of each motor.  The same motor may be
+	 * in the array more than once.
+	 */
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		for ( i = 0; i < num_motor_records; i++ ) {
+			motor = (MX_MOTOR *)
+				motor_record_array[i]->record_class_struct;
+
+			motor_status_array[i] = motor->status;
+		}
+	}
+
+	mx_free( driver_record_array );
+	mx_free( status_read );
+
+	return mx_status;
+}
+
 /*-----------------------------------------------------------------------*/
 
 #define MXP_MOTOR_EXTENDED_STATUS_FORMAT   "%.*e %lx"
@@ -58,6 +58,19 @@ extern "C" {
 #define MXF_MTR_CANNOT_QUICK_SCAN			0x8
 #define MXF_MTR_PSEUDOMOTOR_RECURSION_IS_NOT_NECESSARY	0x10
 
+/* If every motor being waited for has MXF_MTR_WAIT_FOR_STATUS_EVENTS set
+ * and their driver supports it, the motor wait functions wait for status
+ * events from the driver instead of just sleeping.  For network motors,
+ * this subscribes to callbacks on the remote 'status' fields for the
+ * rest of each wait, which costs a round trip per motor at each end.
+ * The server only sends the callbacks at its value changed poll interval
+ * and, since Nagle's algorithm is left on for client sockets, a response
+ * that follows a callback may be held back for tens of milliseconds.
+ * That is why this is not the default.
+ */
+
+#define MXF_MTR_WAIT_FOR_STATUS_EVENTS			0x20
+
 /* Acceleration types. */
 
 #define MXF_MTR_ACCEL_NONE			0
@@ -996,6 +1009,29 @@ typedef struct {
 	mx_status_type ( *special_home_search )( MX_MOTOR *motor );
 	mx_status_type ( *setup_triggered_move )( MX_MOTOR *motor );
 	mx_status_type ( *trigger_move )( MX_MOTOR *motor );
+
+	/* get_status_array() is passed only motors that use this driver.
+	 * It must update 'motor->status' for each of them in the same way
+	 * as get_status(), but may query all of them at the same time.
+	 */
+
+	mx_status_type ( *get_status_array )( long num_motor_records,
+						MX_RECORD **motor_record_array );
+
+	/* wait_for_status_event() is also passed only motors that use this
+	 * driver and is only used if all of them have the record flag
+	 * MXF_MTR_WAIT_FOR_STATUS_EVENTS set.  It waits for up to 'timeout_in_seconds' for the driver
+	 * to be told that the status of any of them may have changed.
+	 * end_status_events() is called when the motor wait functions
+	 * are done, if wait_for_status_event() has been called.
+	 */
+
+	mx_status_type ( *wait_for_status_event )( long num_motor_records,
+						MX_RECORD **motor_record_array,
+						double timeout_in_seconds,
+						mx_bool_type *status_changed );
+	mx_status_type ( *end_status_events )( long num_motor_records,
+						MX_RECORD **motor_record_array );
 } MX_MOTOR_FUNCTION_LIST;
 
 typedef mx_status_type
@@ -1122,6 +1158,16 @@ MX_API mx_status_type mx_motor_constant_velocity_move(
 MX_API mx_status_type mx_motor_get_status( MX_RECORD *motor_record,
 						unsigned long *motor_status );
 
+/* mx_motor_array_get_status() reads the status of all of the motors in
+ * the array.  Motors whose drivers have a get_status_array() function
+ * are queried together, so that, for example, the status requests for
+ * network motors are all in flight at the same time.
+ */
+
+MX_API mx_status_type mx_motor_array_get_status( long num_motor_records,
+						MX_RECORD **motor_record_array,
+						unsigned long *motor_status_array );
+
 MX_API mx_status_type mx_motor_get_extended_status( MX_RECORD *motor_record,
 						double *motor_position,
 						unsigned long *motor_status );
@@ -53,7 +53,9 @@
 #include "mx_bit.h"
 #include "mx_record.h"
 #include "mx_socket.h"
+#include "mx_select.h"
 #include "mx_net.h"
+#include "mx_net_shm.h"
 #include "mx_handle.h"
 #include "mx_callback.h"
 #include "mx_driver.h"
@@ -74,6 +76,9 @@
 #include "mx_hrt_debug.h"
 #endif
 
+static void mx_network_abort_async_requests( MX_NETWORK_SERVER *,
+						mx_status_type );
+
 /* ====================================================================== */
 
 /* MX_NETWORK_MESSAGE_BUFFERs are used both by MX clients and MX servers
@@ -153,6 +158,8 @@ mx_allocate_network_buffer( MX_NETWORK_MESSAGE_BUFFER **message_buffer,
 
 	(*message_buffer)->data_format = MX_NETWORK_DATAFMT_ASCII;
 
+	(*message_buffer)->shared_memory_body = NULL;
+
 	if ( network_server != (MX_NETWORK_SERVER *) NULL ) {
 
 		(*message_buffer)->used_by_socket_handler = FALSE;
@@ -398,6 +405,16 @@ mx_network_receive_message( MX_RECORD *server_record,
 
 	mx_status = ( *fptr ) ( server, message_buffer );
 
+	/* If the connection was lost, then no responses will ever
+	 * arrive for the asynchronous requests sent over it.
+	 */
+
+	if ( ( mx_status.code != MXE_SUCCESS )
+	  && ( server->connection_status & MXCS_CONNECTION_LOST ) )
+	{
+		mx_network_abort_async_requests( server, mx_status );
+	}
+
 #if NETWORK_DEBUG
 	if ( server->server_flags & MXF_NETWORK_SERVER_DEBUG_VERBOSE ) {
 		fprintf( stderr, "\nMX NET: SERVER (%s) -> CLIENT\n",
@@ -521,6 +538,12 @@ mx_network_send_message( MX_RECORD *server_record,
 
 	mx_status = ( *fptr ) ( server, message_buffer );
 
+	if ( ( mx_status.code != MXE_SUCCESS )
+	  && ( server->connection_status & MXCS_CONNECTION_LOST ) )
+	{
+		mx_network_abort_async_requests( server, mx_status );
+	}
+
 	return mx_status;
 }
 
@@ -687,6 +710,114 @@ mx_network_update_message_id( unsigned long *message_id )
 
 /* ----- */
 
+/* Bookkeeping for requests started by mx_get_array_async()
+ * and mx_put_array_async().
+ */
+
+static mx_status_type mx_get_field_array_finish( MX_NETWORK_ASYNC_REQUEST *,
+						MX_NETWORK_MESSAGE_BUFFER * );
+
+static mx_status_type mx_put_field_array_finish( MX_NETWORK_ASYNC_REQUEST *,
+						MX_NETWORK_MESSAGE_BUFFER * );
+
+static void mx_network_finish_batch( MX_NETWORK_ASYNC_REQUEST *,
+						MX_NETWORK_MESSAGE_BUFFER * );
+
+static MX_NETWORK_ASYNC_REQUEST *
+mx_network_remove_async_request( MX_NETWORK_SERVER *server,
+				unsigned long message_id )
+{
+	MX_NETWORK_ASYNC_REQUEST *request, *previous_request;
+
+	previous_request = NULL;
+
+	request = server->async_request_list;
+
+	while ( request != (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+		if ( request->message_id == message_id ) {
+			if ( previous_request == NULL ) {
+				server->async_request_list =
+						request->next_request;
+			} else {
+				previous_request->next_request =
+						request->next_request;
+			}
+
+			request->next_request = NULL;
+
+			return request;
+		}
+
+		previous_request = request;
+
+		request = request->next_request;
+	}
+
+	return NULL;
+}
+
+static void
+mx_network_complete_async_request( MX_NETWORK_ASYNC_REQUEST *request,
+				MX_NETWORK_MESSAGE_BUFFER *buffer )
+{
+	switch( request->send_message_type ) {
+	case MX_NETMSG_GET_ARRAY_BATCH:
+	case MX_NETMSG_PUT_ARRAY_BATCH:
+		/* This completes all of the requests in the batch. */
+
+		mx_network_finish_batch( request, buffer );
+		return;
+	case MX_NETMSG_GET_ARRAY_BY_NAME:
+	case MX_NETMSG_GET_ARRAY_BY_HANDLE:
+		request->status = mx_get_field_array_finish( request, buffer );
+		break;
+	default:
+		request->status = mx_put_field_array_finish( request, buffer );
+		break;
+	}
+
+	request->complete = TRUE;
+}
+
+static void
+mx_network_fail_async_request( MX_NETWORK_ASYNC_REQUEST *request,
+				mx_status_type status )
+{
+	/* If the request is the head of a batch, the rest of the batch
+	 * fails with it.
+	 */
+
+	while ( request != (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+		request->status = status;
+		request->complete = TRUE;
+
+		request = request->next_in_batch;
+	}
+}
+
+static void
+mx_network_abort_async_requests( MX_NETWORK_SERVER *server,
+				mx_status_type status )
+{
+	MX_NETWORK_ASYNC_REQUEST *request, *next_request;
+
+	request = server->async_request_list;
+
+	server->async_request_list = NULL;
+
+	while ( request != (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+		next_request = request->next_request;
+
+		request->next_request = NULL;
+
+		mx_network_fail_async_request( request, status );
+
+		request = next_request;
+	}
+}
+
+/* ----- */
+
 #define MX_NETWORK_MAX_ID_MISMATCH    10
 
 MX_EXPORT mx_status_type
@@ -698,6 +829,7 @@ mx_network_wait_for_message_id( MX_RECORD *server_record,
 	static const char fname[] = "mx_network_wait_for_message_id()";
 
 	MX_NETWORK_SERVER *server;
+	MX_NETWORK_ASYNC_REQUEST *async_request;
 	MX_CLOCK_TICK current_tick, end_tick, timeout_in_ticks;
 	MX_LIST_ENTRY *list_start, *list_entry;
 	MX_CALLBACK *callback;
@@ -789,12 +921,6 @@ mx_network_wait_for_message_id( MX_RECORD *server_record,
 	/* Wait for messages.  We always go through the loop at least once. */
 
 	do {
-		/* Sleep for a moment to make sure that we do not
-		 * use up all available cpu time.
-		 */
-
-		mx_msleep(1);
-
 		/* Are any network messages available? */
 
 		mx_status = mx_network_message_is_available( server_record,
@@ -816,6 +942,8 @@ mx_network_wait_for_message_id( MX_RECORD *server_record,
 #endif
 			(void) mx_close_hardware( server_record );
 
+			mx_network_abort_async_requests( server, mx_status );
+
 			return mx_status;
 			break;
 
@@ -838,6 +966,15 @@ mx_network_wait_for_message_id( MX_RECORD *server_record,
 				RETURN_IF_TIMED_OUT_QUIET;
 			}
 
+			/* Sleep for a moment to make sure that we do not
+			 * use up all available cpu time.  We only do this
+			 * when nothing has arrived, so that a burst of
+			 * responses to pipelined requests can be read
+			 * without delay.
+			 */
+
+			mx_msleep(1);
+
 			/* Go back to the top of the loop and try again. */
 
 #if NETWORK_DEBUG_MESSAGE_IDS
@@ -920,6 +1057,30 @@ mx_network_wait_for_message_id( MX_RECORD *server_record,
 				server_record->name );
 		}
 
+		/* Responses to asynchronous requests are handled as soon
+		 * as they arrive, no matter which message ID we are
+		 * actually waiting for.
+		 */
+
+		async_request = mx_network_remove_async_request( server,
+							received_message_id );
+
+		if ( async_request != (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+
+			mx_network_complete_async_request( async_request,
+								buffer );
+
+			if ( received_message_id == expected_message_id ) {
+				return MX_SUCCESSFUL_RESULT;
+			}
+
+			if ( timeout_enabled ) {
+				RETURN_IF_TIMED_OUT;
+			}
+
+			continue;
+		}
+
 		if ( received_message_id == expected_message_id ) {
 
 #if NETWORK_DEBUG_MESSAGE_IDS
@@ -1371,6 +1532,140 @@ mx_network_wait_for_messages( MX_RECORD *record,
 
 /* ====================================================================== */
 
+static MX_SOCKET *
+mxp_network_get_server_socket( MX_RECORD *server_record )
+{
+	MX_TCPIP_SERVER *tcpip_server;
+	MX_UNIX_SERVER *unix_server;
+
+	switch( server_record->mx_type ) {
+	case MXN_NET_TCPIP:
+		tcpip_server = server_record->record_type_struct;
+
+		return tcpip_server->socket;
+	case MXN_NET_UNIX:
+		unix_server = server_record->record_type_struct;
+
+		return unix_server->socket;
+	default:
+		return NULL;
+	}
+}
+
+MX_EXPORT mx_status_type
+mx_network_wait_for_messages_from_servers( long num_servers,
+					MX_RECORD **server_record_array,
+					double timeout_in_seconds )
+{
+	static const char fname[] =
+		"mx_network_wait_for_messages_from_servers()";
+
+	MX_SOCKET *mx_socket;
+	fd_set read_fds;
+	struct timeval timeout;
+	int num_fds, highest_fd, saved_errno;
+	long i;
+	mx_status_type mx_status;
+
+	if ( server_record_array == (MX_RECORD **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The server_record_array pointer passed was NULL." );
+	}
+
+	if ( timeout_in_seconds < 0.0 ) {
+		timeout_in_seconds = 0.0;
+	}
+
+	FD_ZERO( &read_fds );
+
+	highest_fd = -1;
+
+	for ( i = 0; i < num_servers; i++ ) {
+		mx_socket = mxp_network_get_server_socket(
+						server_record_array[i] );
+
+		if ( ( mx_socket == (MX_SOCKET *) NULL )
+		  || ( mx_socket->socket_fd < 0 ) )
+		{
+			continue;
+		}
+
+		FD_SET( mx_socket->socket_fd, &read_fds );
+
+		if ( (int) mx_socket->socket_fd > highest_fd ) {
+			highest_fd = (int) mx_socket->socket_fd;
+		}
+	}
+
+	/* If none of the servers is connected, then there is nothing
+	 * that could wake us up early.
+	 */
+
+	if ( highest_fd < 0 ) {
+		mx_usleep( (unsigned long) ( 1.0e6 * timeout_in_seconds ) );
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	timeout.tv_sec = (long) timeout_in_seconds;
+	timeout.tv_usec = (long) ( 1.0e6 * ( timeout_in_seconds
+						- (double) timeout.tv_sec ) );
+
+#if defined(OS_WIN32)
+	num_fds = select( -1, &read_fds, NULL, NULL, &timeout );
+#else
+	num_fds = select( highest_fd + 1, &read_fds, NULL, NULL, &timeout );
+#endif
+
+	saved_errno = errno;
+
+	if ( num_fds < 0 ) {
+		if ( saved_errno == EINTR ) {
+			return MX_SUCCESSFUL_RESULT;
+		}
+
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"Error in select() while waiting for messages from "
+		"%ld MX servers.  Errno = %d, error message = '%s'.",
+			num_servers, saved_errno,
+			mx_strerror( saved_errno, NULL, 0 ) );
+	}
+
+	if ( num_fds == 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	/* Handle the messages that have arrived. */
+
+	for ( i = 0; i < num_servers; i++ ) {
+		mx_socket = mxp_network_get_server_socket(
+						server_record_array[i] );
+
+		if ( ( mx_socket == (MX_SOCKET *) NULL )
+		  || ( mx_socket->socket_fd < 0 ) )
+		{
+			continue;
+		}
+
+		if ( FD_ISSET( mx_socket->socket_fd, &read_fds ) == 0 )
+			continue;
+
+		mx_status = mx_network_wait_for_message_id(
+					server_record_array[i], NULL, 0, 0.0 );
+
+		switch( mx_status.code ) {
+		case MXE_SUCCESS:
+		case MXE_TIMED_OUT:
+			break;
+		default:
+			return mx_status;
+		}
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* ====================================================================== */
+
 MX_EXPORT mx_status_type
 mx_network_connection_is_up( MX_RECORD *server_record,
 				mx_bool_type *connection_is_up )
@@ -2942,6 +3237,21 @@ mx_network_dump_message( MX_NETWORK_MESSAGE_BUFFER *message_buffer,
 			case MX_NETWORK_OPTION_CLIENT_VERSION_TIME:
 				fprintf( stderr, "Client version time\n" );
 				break;
+			case MX_NETWORK_OPTION_COMPRESSION:
+				fprintf( stderr, "Compression\n" );
+				break;
+			case MX_NETWORK_OPTION_COMPRESSION_THRESHOLD:
+				fprintf( stderr, "Compression threshold\n" );
+				break;
+			case MX_NETWORK_OPTION_SHARED_MEMORY:
+				fprintf( stderr, "Shared memory\n" );
+				break;
+			case MX_NETWORK_OPTION_SHARED_MEMORY_THRESHOLD:
+				fprintf( stderr, "Shared memory threshold\n" );
+				break;
+			case MX_NETWORK_OPTION_BATCH_MESSAGES:
+				fprintf( stderr, "Batch messages\n" );
+				break;
 			default:
 				fprintf( stderr, "Unrecognized option %lu\n",
 						option_number );
@@ -3817,6 +4127,28 @@ mx_network_display_message( MX_NETWORK_MESSAGE_BUFFER *message_buffer,
 
 	/*-------------------------------------------------------------------*/
 
+	case MX_NETMSG_GET_ARRAY_BATCH:
+		fprintf( stderr, "  GET_ARRAY_BATCH: %lu fields\n",
+			(unsigned long) mx_ntohl( uint32_message[0] ) );
+		break;
+
+	case mx_server_response(MX_NETMSG_GET_ARRAY_BATCH):
+		fprintf( stderr, "  GET_ARRAY_BATCH response: %lu fields\n",
+			(unsigned long) mx_ntohl( uint32_message[0] ) );
+		break;
+
+	case MX_NETMSG_PUT_ARRAY_BATCH:
+		fprintf( stderr, "  PUT_ARRAY_BATCH: %lu fields\n",
+			(unsigned long) mx_ntohl( uint32_message[0] ) );
+		break;
+
+	case mx_server_response(MX_NETMSG_PUT_ARRAY_BATCH):
+		fprintf( stderr, "  PUT_ARRAY_BATCH response: %lu fields\n",
+			(unsigned long) mx_ntohl( uint32_message[0] ) );
+		break;
+
+	/*-------------------------------------------------------------------*/
+
 	case MX_NETMSG_GET_NETWORK_HANDLE:
 		fprintf( stderr, "  GET_NETWORK_HANDLE: '%s'\n", char_message );
 		break;
@@ -4541,31 +4873,17 @@ mx_get_array( MX_NETWORK_FIELD *nf,
 		long *dimension,
 		void *value_ptr )
 {
-	static const char fname[] = "mx_get_array()";
-
-	mx_bool_type connected;
+	MX_NETWORK_ASYNC_REQUEST request;
 	mx_status_type mx_status;
 
-	if ( nf == (MX_NETWORK_FIELD *) NULL ) {
-		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_NETWORK_FIELD pointer passed was NULL." );
-	}
-
-	mx_status = mx_network_field_is_connected( nf, &connected );
+	mx_status = mx_get_array_async( nf, datatype,
+				num_dimensions, dimension, value_ptr,
+				&request );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-	if ( connected == FALSE ) {
-		mx_status = mx_network_field_connect( nf );
-
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
-	}
-
-	mx_status = mx_internal_get_array( NULL, NULL, nf,
-					datatype, num_dimensions, dimension,
-					value_ptr );
+	mx_status = mx_network_wait_for_completions( 1, &request );
 
 	return mx_status;
 }
@@ -4579,31 +4897,17 @@ mx_put_array( MX_NETWORK_FIELD *nf,
 		long *dimension,
 		void *value_ptr )
 {
-	static const char fname[] = "mx_put_array()";
-
-	mx_bool_type connected;
+	MX_NETWORK_ASYNC_REQUEST request;
 	mx_status_type mx_status;
 
-	if ( nf == (MX_NETWORK_FIELD *) NULL ) {
-		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_NETWORK_FIELD pointer passed was NULL." );
-	}
-
-	mx_status = mx_network_field_is_connected( nf, &connected );
+	mx_status = mx_put_array_async( nf, datatype,
+				num_dimensions, dimension, value_ptr,
+				&request );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-	if ( connected == FALSE ) {
-		mx_status = mx_network_field_connect( nf );
-
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
-	}
-
-	mx_status = mx_internal_put_array( NULL, NULL, nf,
-					datatype, num_dimensions, dimension,
-					value_ptr );
+	mx_status = mx_network_wait_for_completions( 1, &request );
 
 	return mx_status;
 }
@@ -5642,22 +5946,27 @@ mx_old_copy_get_field_array( MX_RECORD *server_record,
 
 /* ---------------------------------------------------------------------- */
 
-MX_EXPORT mx_status_type
-mx_get_field_array( MX_RECORD *server_record,
-			char *remote_record_field_name,
-			MX_NETWORK_FIELD *nf,
-			MX_RECORD_FIELD *local_field,
-			void *value_ptr )
+/* mx_get_field_array() is split into a function that sends the request
+ * to the server and a function that handles the response, so that the
+ * asynchronous functions further below can have several requests in
+ * flight at the same time.
+ */
+
+static mx_status_type
+mx_get_field_array_send( MX_NETWORK_ASYNC_REQUEST *request )
 {
-	static const char fname[] = "mx_get_field_array()";
+	static const char fname[] = "mx_get_field_array_send()";
 
+	MX_RECORD *server_record;
+	char *remote_record_field_name;
+	MX_NETWORK_FIELD *nf;
+	MX_RECORD_FIELD *local_field;
 	MX_NETWORK_SERVER *server;
 	MX_NETWORK_SERVER_FUNCTION_LIST *function_list;
 	MX_LIST_HEAD *list_head;
 	char nf_label[NF_LABEL_LENGTH];
 	long local_datatype, local_num_dimensions, *local_dimension_array;
 	size_t *local_data_element_size_array;
-	mx_bool_type local_array_is_dynamically_allocated;
 	mx_bool_type use_network_handles;
 
 	MX_NETWORK_MESSAGE_BUFFER *aligned_buffer;
@@ -5665,18 +5974,14 @@ mx_get_field_array( MX_RECORD *server_record,
 	char *buffer;
 	char *message;
 	uint32_t header_length, message_length;
-	uint32_t send_message_type, receive_message_type;
-	uint32_t status_code;
-	unsigned long network_debug_flags;
-	mx_bool_type net_debug_summary = FALSE;
-
-	mx_bool_type use_old_array_copy = FALSE;
+	uint32_t send_message_type;
 
 	mx_status_type mx_status;
 
-#if NETWORK_DEBUG_TIMING
-	MX_HRT_TIMING measurement;
-#endif
+	server_record = request->server_record;
+	remote_record_field_name = request->remote_record_field_name;
+	nf = request->nf;
+	local_field = request->local_field;
 
 	server = NULL;
 	local_datatype = -1;
@@ -5709,6 +6014,9 @@ mx_get_field_array( MX_RECORD *server_record,
 
 		server_record = nf->server_record;
 		remote_record_field_name = nf->nfname;
+
+		request->server_record = server_record;
+		request->remote_record_field_name = remote_record_field_name;
 	}
 
 	mx_status = mx_local_field_get_parameters(
@@ -5737,12 +6045,6 @@ mx_get_field_array( MX_RECORD *server_record,
 			));
 	}
 
-	if ( local_field->flags & MXFF_VARARGS ) {
-		local_array_is_dynamically_allocated = TRUE;
-	} else {
-		local_array_is_dynamically_allocated = FALSE;
-	}
-
 	mx_status = mx_network_reconnect_if_down( server_record );
 
 	if ( mx_status.code != MXE_SUCCESS )
@@ -5793,6 +6095,9 @@ mx_get_field_array( MX_RECORD *server_record,
 
 	server->last_data_type = local_field->datatype;
 
+	request->send_message_type = send_message_type;
+	request->message_id = 0;
+
 	if ( mx_server_supports_message_ids(server) ) {
 
 		header[MX_NETWORK_DATA_TYPE] =
@@ -5802,42 +6107,164 @@ mx_get_field_array( MX_RECORD *server_record,
 
 		header[MX_NETWORK_MESSAGE_ID] =
 				mx_htonl( server->last_rpc_message_id );
-	}
 
-#if NETWORK_DEBUG_TIMING
-	MX_HRT_START( measurement );
-#endif
+		request->message_id = server->last_rpc_message_id;
+	}
 
 	mx_status = mx_network_send_message( server_record, aligned_buffer );
 
-	if ( mx_status.code != MXE_SUCCESS )
-		return mx_status;
+	return mx_status;
+}
 
-	/************* Wait for the response. **************/
+/* ---------------------------------------------------------------------- */
 
-	mx_status = mx_network_wait_for_message_id( server_record,
-						aligned_buffer,
-						server->last_rpc_message_id,
-						server->timeout );
-#if NETWORK_DEBUG_TIMING
-	MX_HRT_END( measurement );
+/* mx_get_field_array_copy() copies a value returned by the server
+ * into the caller's variable.  It is shared by the single and batched
+ * get_array responses.
+ */
 
-	if ( use_network_handles == FALSE ) {
-		MX_HRT_RESULTS( measurement, fname, remote_record_field_name );
+static mx_status_type
+mx_get_field_array_copy( MX_NETWORK_ASYNC_REQUEST *request,
+			MX_NETWORK_SERVER *server,
+			long message_length,
+			char *message )
+{
+	static const char fname[] = "mx_get_field_array_copy()";
+
+	MX_RECORD *server_record;
+	char *remote_record_field_name;
+	MX_NETWORK_FIELD *nf;
+	MX_RECORD_FIELD *local_field;
+	void *value_ptr;
+	MX_NETWORK_SERVER_FUNCTION_LIST *function_list;
+	long local_datatype, local_num_dimensions, *local_dimension_array;
+	size_t *local_data_element_size_array;
+	mx_bool_type local_array_is_dynamically_allocated;
+	mx_bool_type use_old_array_copy = FALSE;
+	mx_status_type mx_status;
+
+	server_record = request->server_record;
+	remote_record_field_name = request->remote_record_field_name;
+	nf = request->nf;
+	local_field = request->local_field;
+	value_ptr = request->value_ptr;
+
+	mx_status = mx_local_field_get_parameters(
+			server_record, local_field,
+			&local_datatype,
+			&local_num_dimensions,
+			&local_dimension_array,
+			&local_data_element_size_array,
+			&server, &function_list, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( local_field->flags & MXFF_VARARGS ) {
+		local_array_is_dynamically_allocated = TRUE;
 	} else {
-		MX_HRT_RESULTS( measurement, fname, "(%ld,%ld) %s",
-				nf->record_handle, nf->field_handle,
-				remote_record_field_name );
+		local_array_is_dynamically_allocated = FALSE;
 	}
-#endif
+
+	if ( nf == (MX_NETWORK_FIELD *) NULL ) {
+		use_old_array_copy = TRUE;
+	} else
+	if ( nf->nf_flags & MXF_NF_USE_OLD_ARRAY_COPY ) {
+		use_old_array_copy = TRUE;
+	} else
+	if ( server->server_flags & MXF_NETWORK_SERVER_USE_OLD_ARRAY_COPY ) {
+		use_old_array_copy = TRUE;
+	} else {
+		use_old_array_copy = FALSE;
+	}
+
+	if ( use_old_array_copy ) {
+		mx_status = mx_old_copy_get_field_array(
+					server_record,
+					server,
+					remote_record_field_name,
+					local_field,
+					local_array_is_dynamically_allocated,
+					value_ptr,
+					message_length,
+					message,
+					local_datatype,
+					local_num_dimensions,
+					local_dimension_array,
+					local_data_element_size_array );
+	} else {
+		mx_status = mx_new_copy_get_field_array(
+					server_record,
+					server,
+					nf,
+					local_field,
+					local_array_is_dynamically_allocated,
+					value_ptr,
+					message_length,
+					message,
+					local_datatype,
+					local_num_dimensions,
+					local_dimension_array,
+					local_data_element_size_array );
+	}
+
+	return mx_status;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static mx_status_type
+mx_get_field_array_finish( MX_NETWORK_ASYNC_REQUEST *request,
+			MX_NETWORK_MESSAGE_BUFFER *aligned_buffer )
+{
+	static const char fname[] = "mx_get_field_array_finish()";
+
+	MX_RECORD *server_record;
+	char *remote_record_field_name;
+	MX_NETWORK_FIELD *nf;
+	MX_RECORD_FIELD *local_field;
+	MX_NETWORK_SERVER *server;
+	MX_NETWORK_SERVER_FUNCTION_LIST *function_list;
+	MX_LIST_HEAD *list_head;
+	char nf_label[NF_LABEL_LENGTH];
+	long local_datatype, local_num_dimensions, *local_dimension_array;
+	size_t *local_data_element_size_array;
+
+	uint32_t *header;
+	char *buffer;
+	char *message;
+	uint32_t header_length, message_length;
+	uint32_t send_message_type, receive_message_type;
+	uint32_t status_code;
+	unsigned long network_debug_flags;
+	mx_bool_type net_debug_summary = FALSE;
+
+	mx_status_type mx_status;
+
+	server_record = request->server_record;
+	remote_record_field_name = request->remote_record_field_name;
+	nf = request->nf;
+	local_field = request->local_field;
+	send_message_type = request->send_message_type;
+
+	server = NULL;
+	local_datatype = -1;
+	local_num_dimensions = -1;
+	local_dimension_array = NULL;
+	local_data_element_size_array = NULL;
+
+	mx_status = mx_local_field_get_parameters(
+			server_record, local_field,
+			&local_datatype,
+			&local_num_dimensions,
+			&local_dimension_array,
+			&local_data_element_size_array,
+			&server, &function_list, fname );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-	/* Update these pointers in case they were
-	 * changed by mx_reallocate_network_buffer()
-	 * in mx_network_wait_for_message_id().
-	 */
+	list_head = mx_get_record_list_head_struct( server_record );
 
 	header = &(aligned_buffer->u.uint32_buffer[0]);
 	buffer = &(aligned_buffer->u.char_buffer[0]);
@@ -5847,6 +6274,22 @@ mx_get_field_array( MX_RECORD *server_record,
 	receive_message_type = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
 	status_code          = mx_ntohl( header[ MX_NETWORK_STATUS_CODE ] );
 
+	message = buffer + header_length;
+
+	/* Large responses may have been left in a shared memory slot,
+	 * in which case we decode them from there.
+	 */
+
+	if ( receive_message_type & MX_NETMSG_SHARED_MEMORY_FLAG ) {
+		mx_status = mx_network_shm_get_body( aligned_buffer,
+						&message, &message_length );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		receive_message_type &= (~MX_NETMSG_SHARED_MEMORY_FLAG);
+	}
+
 #if 0
 	if ( nf != NULL ) {
 		MX_DEBUG(-2,("%s: nf = %p, server = '%s', field = '%s'",
@@ -5861,14 +6304,14 @@ mx_get_field_array( MX_RECORD *server_record,
 		"message_type = %#lx, status_code = %lu", fname,
 		(unsigned long) header_length,
 		(unsigned long) message_length,
-		(unsigned long) message_type,
+		(unsigned long) receive_message_type,
 		(unsigned long) status_code));
 #endif
 	/* Check to see if the response type matches the send type. */
 
 	if ( ( server->remote_mx_version < 1005000L )
 	  && ( send_message_type == MX_NETMSG_GET_ARRAY_BY_HANDLE )
-	  && ( receive_message_type == 
+	  && ( receive_message_type ==
 	  		mx_server_response(MX_NETMSG_GET_ARRAY_BY_NAME) ) )
 	{
 		/* Bug compatibility for old MX servers. */
@@ -5908,8 +6351,6 @@ mx_get_field_array( MX_RECORD *server_record,
 			(unsigned long) receive_message_type );
 	}
 
-	message = buffer + header_length;
-
 	/* If the remote command failed, the message field will include
 	 * the text of the error message rather than the array data
 	 * we wanted.
@@ -5952,8 +6393,7 @@ mx_get_field_array( MX_RECORD *server_record,
 						nf_label, sizeof(nf_label) );
 
 		if ( network_debug_flags & MXF_NETDBG_MSG_IDS ) {
-			fprintf( stderr, "[%#lx] ",
-					server->last_rpc_message_id );
+			fprintf( stderr, "[%#lx] ", request->message_id );
 		}
 
 		fprintf( stderr, "MX GET_ARRAY('%s') = ", nf_label );
@@ -5967,47 +6407,73 @@ mx_get_field_array( MX_RECORD *server_record,
 
 	/************ Copy the data that was returned. ***************/
 
+	mx_status = mx_get_field_array_copy( request, server,
+					message_length, message );
+
+	return mx_status;
+}
+
+/* ---------------------------------------------------------------------- */
+
+MX_EXPORT mx_status_type
+mx_get_field_array( MX_RECORD *server_record,
+			char *remote_record_field_name,
+			MX_NETWORK_FIELD *nf,
+			MX_RECORD_FIELD *local_field,
+			void *value_ptr )
+{
+	MX_NETWORK_ASYNC_REQUEST request;
+	MX_NETWORK_SERVER *server;
+	mx_status_type mx_status;
+
+#if NETWORK_DEBUG_TIMING
+	static const char fname[] = "mx_get_field_array()";
+
+	MX_HRT_TIMING measurement;
+#endif
+
+	request.server_record = server_record;
+	request.remote_record_field_name = remote_record_field_name;
+	request.nf = nf;
+	request.local_field = local_field;
+	request.value_ptr = value_ptr;
+
+#if NETWORK_DEBUG_TIMING
+	MX_HRT_START( measurement );
+#endif
+
+	mx_status = mx_get_field_array_send( &request );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	/************* Wait for the response. **************/
+
+	server = (MX_NETWORK_SERVER *)
+			request.server_record->record_class_struct;
+
+	mx_status = mx_network_wait_for_message_id( request.server_record,
+						server->message_buffer,
+						request.message_id,
+						server->timeout );
+#if NETWORK_DEBUG_TIMING
+	MX_HRT_END( measurement );
+
 	if ( nf == (MX_NETWORK_FIELD *) NULL ) {
-		use_old_array_copy = TRUE;
-	} else
-	if ( nf->nf_flags & MXF_NF_USE_OLD_ARRAY_COPY ) {
-		use_old_array_copy = TRUE;
-	} else
-	if ( server->server_flags & MXF_NETWORK_SERVER_USE_OLD_ARRAY_COPY ) {
-		use_old_array_copy = TRUE;
+		MX_HRT_RESULTS( measurement, fname,
+				request.remote_record_field_name );
 	} else {
-		use_old_array_copy = FALSE;
+		MX_HRT_RESULTS( measurement, fname, "(%ld,%ld) %s",
+				nf->record_handle, nf->field_handle,
+				request.remote_record_field_name );
 	}
+#endif
 
-	if ( use_old_array_copy ) {
-		mx_status = mx_old_copy_get_field_array(
-					server_record,
-					server,
-					remote_record_field_name,
-					local_field,
-					local_array_is_dynamically_allocated,
-					value_ptr,
-					message_length,
-					message,
-					local_datatype,
-					local_num_dimensions,
-					local_dimension_array,
-					local_data_element_size_array );
-	} else {
-		mx_status = mx_new_copy_get_field_array(
-					server_record,
-					server,
-					nf,
-					local_field,
-					local_array_is_dynamically_allocated,
-					value_ptr,
-					message_length,
-					message,
-					local_datatype,
-					local_num_dimensions,
-					local_dimension_array,
-					local_data_element_size_array );
-	}
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_get_field_array_finish( &request,
+						server->message_buffer );
 
 	return mx_status;
 }
@@ -6686,46 +7152,138 @@ mx_old_copy_put_field_array( MX_RECORD *server_record,
 
 /* ---------------------------------------------------------------------- */
 
-MX_EXPORT mx_status_type
-mx_put_field_array( MX_RECORD *server_record,
-			char *remote_record_field_name,
-			MX_NETWORK_FIELD *nf,
-			MX_RECORD_FIELD *local_field,
-			void *value_ptr )
+/* Like mx_get_field_array(), mx_put_field_array() is split into a send
+ * function and a function that handles the server's response.
+ */
+
+/* mx_put_field_array_copy() copies the caller's value into the server's
+ * message buffer, starting 'field_id_length' bytes after the header.  It
+ * is shared by the single and batched put_array requests.
+ */
+
+static mx_status_type
+mx_put_field_array_copy( MX_NETWORK_ASYNC_REQUEST *request,
+			MX_NETWORK_SERVER *server,
+			uint32_t field_id_length )
 {
-	static const char fname[] = "mx_put_field_array()";
+	static const char fname[] = "mx_put_field_array_copy()";
 
-	MX_NETWORK_SERVER *server;
+	MX_RECORD *server_record;
+	char *remote_record_field_name;
+	MX_NETWORK_FIELD *nf;
+	MX_RECORD_FIELD *local_field;
+	void *value_ptr;
 	MX_NETWORK_SERVER_FUNCTION_LIST *function_list;
-	MX_LIST_HEAD *list_head;
-	char nf_label[80];
 	long local_datatype, local_num_dimensions, *local_dimension_array;
 	size_t *local_data_element_size_array;
 	mx_bool_type array_is_dynamically_allocated;
-	mx_bool_type use_network_handles;
 	mx_bool_type use_old_array_copy;
-
-	MX_NETWORK_MESSAGE_BUFFER *aligned_buffer;
-	uint32_t *header, *uint32_message;
-	char *message;
-	unsigned long network_debug_flags;
-
-	uint32_t header_length, field_id_length;
-	uint32_t message_length, max_message_length;
-	uint32_t send_message_type, receive_message_type;
-	uint32_t status_code;
-	mx_bool_type net_debug_summary;
 	mx_status_type mx_status;
 
-#if 0
-	mx_warning("%s nas not been fully tested in this MX revision.  Please use revision 5037 or before.", fname);
-#endif
-
-#if NETWORK_DEBUG_TIMING
-	MX_HRT_TIMING measurement;
-#endif
+	server_record = request->server_record;
+	remote_record_field_name = request->remote_record_field_name;
+	nf = request->nf;
+	local_field = request->local_field;
+	value_ptr = request->value_ptr;
 
-	server = NULL;
+	mx_status = mx_local_field_get_parameters(
+			server_record, local_field,
+			&local_datatype, &local_num_dimensions,
+			&local_dimension_array,
+			&local_data_element_size_array,
+			&server, &function_list, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( local_field->flags & MXFF_VARARGS ) {
+		array_is_dynamically_allocated = TRUE;
+	} else {
+		array_is_dynamically_allocated = FALSE;
+	}
+
+	use_old_array_copy = FALSE;
+
+	if ( nf == (MX_NETWORK_FIELD *) NULL ) {
+		use_old_array_copy = TRUE;
+	} else
+	if ( nf->nf_flags & MXF_NF_USE_OLD_ARRAY_COPY ) {
+		use_old_array_copy = TRUE;
+	} else
+	if ( server->server_flags & MXF_NETWORK_SERVER_USE_OLD_ARRAY_COPY ) {
+		use_old_array_copy = TRUE;
+	} else {
+		use_old_array_copy = FALSE;
+	}
+
+	if ( use_old_array_copy ) {
+		mx_status = mx_old_copy_put_field_array(
+						server_record,
+						server,
+						remote_record_field_name,
+						nf,
+						local_field,
+						array_is_dynamically_allocated,
+						value_ptr,
+						local_datatype,
+						local_num_dimensions,
+						local_dimension_array,
+						local_data_element_size_array,
+						field_id_length );
+	} else {
+		mx_status = mx_new_copy_put_field_array(
+						server_record,
+						server,
+						nf,
+						local_field,
+						array_is_dynamically_allocated,
+						value_ptr,
+						local_datatype,
+						local_num_dimensions,
+						local_dimension_array,
+						local_data_element_size_array,
+						field_id_length );
+	}
+
+	return mx_status;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static mx_status_type
+mx_put_field_array_send( MX_NETWORK_ASYNC_REQUEST *request )
+{
+	static const char fname[] = "mx_put_field_array_send()";
+
+	MX_RECORD *server_record;
+	char *remote_record_field_name;
+	MX_NETWORK_FIELD *nf;
+	MX_RECORD_FIELD *local_field;
+	MX_NETWORK_SERVER *server;
+	MX_NETWORK_SERVER_FUNCTION_LIST *function_list;
+	MX_LIST_HEAD *list_head;
+	char nf_label[80];
+	long local_datatype, local_num_dimensions, *local_dimension_array;
+	size_t *local_data_element_size_array;
+	mx_bool_type use_network_handles;
+
+	MX_NETWORK_MESSAGE_BUFFER *aligned_buffer;
+	uint32_t *header, *uint32_message;
+	char *message;
+	unsigned long network_debug_flags;
+
+	uint32_t header_length, field_id_length;
+	uint32_t message_length, max_message_length;
+	uint32_t send_message_type;
+	mx_bool_type net_debug_summary;
+	mx_status_type mx_status;
+
+	server_record = request->server_record;
+	remote_record_field_name = request->remote_record_field_name;
+	nf = request->nf;
+	local_field = request->local_field;
+
+	server = NULL;
 	local_datatype = -1;
 	local_num_dimensions = -1;
 	local_dimension_array = NULL;
@@ -6756,6 +7314,9 @@ mx_put_field_array( MX_RECORD *server_record,
 
 		server_record = nf->server_record;
 		remote_record_field_name = nf->nfname;
+
+		request->server_record = server_record;
+		request->remote_record_field_name = remote_record_field_name;
 	}
 
 	mx_status = mx_local_field_get_parameters(
@@ -6783,12 +7344,6 @@ mx_put_field_array( MX_RECORD *server_record,
 			));
 	}
 
-	if ( local_field->flags & MXFF_VARARGS ) {
-		array_is_dynamically_allocated = TRUE;
-	} else {
-		array_is_dynamically_allocated = FALSE;
-	}
-
 	mx_status = mx_network_reconnect_if_down( server_record );
 
 	if ( mx_status.code != MXE_SUCCESS )
@@ -6812,6 +7367,8 @@ mx_put_field_array( MX_RECORD *server_record,
 	header[MX_NETWORK_HEADER_LENGTH] = mx_htonl( header_length );
 	header[MX_NETWORK_STATUS_CODE]   = mx_htonl( MXE_SUCCESS );
 
+	request->message_id = 0;
+
 	if ( mx_server_supports_message_ids(server) ) {
 
 		header[MX_NETWORK_DATA_TYPE] =
@@ -6821,6 +7378,8 @@ mx_put_field_array( MX_RECORD *server_record,
 
 		header[MX_NETWORK_MESSAGE_ID] =
 				mx_htonl( server->last_rpc_message_id );
+
+		request->message_id = server->last_rpc_message_id;
 	}
 
 	if ( use_network_handles == FALSE ) {
@@ -6848,50 +7407,11 @@ mx_put_field_array( MX_RECORD *server_record,
 
 	header[MX_NETWORK_MESSAGE_TYPE] = mx_htonl( send_message_type );
 
-	/************ Copy the data to be sent. ***************/
-
-	use_old_array_copy = FALSE;
+	request->send_message_type = send_message_type;
 
-	if ( nf == (MX_NETWORK_FIELD *) NULL ) {
-		use_old_array_copy = TRUE;
-	} else
-	if ( nf->nf_flags & MXF_NF_USE_OLD_ARRAY_COPY ) {
-		use_old_array_copy = TRUE;
-	} else
-	if ( server->server_flags & MXF_NETWORK_SERVER_USE_OLD_ARRAY_COPY ) {
-		use_old_array_copy = TRUE;
-	} else {
-		use_old_array_copy = FALSE;
-	}
+	/************ Copy the data to be sent. ***************/
 
-	if ( use_old_array_copy ) {
-		mx_status = mx_old_copy_put_field_array(
-						server_record,
-						server,
-						remote_record_field_name,
-						nf,
-						local_field,
-						array_is_dynamically_allocated,
-						value_ptr,
-						local_datatype,
-						local_num_dimensions,
-						local_dimension_array,
-						local_data_element_size_array,
-						field_id_length );
-	} else {
-		mx_status = mx_new_copy_put_field_array(
-						server_record,
-						server,
-						nf,
-						local_field,
-						array_is_dynamically_allocated,
-						value_ptr,
-						local_datatype,
-						local_num_dimensions,
-						local_dimension_array,
-						local_data_element_size_array,
-						field_id_length );
-	}
+	mx_status = mx_put_field_array_copy( request, server, field_id_length );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
@@ -6917,8 +7437,7 @@ mx_put_field_array( MX_RECORD *server_record,
 						nf_label, sizeof(nf_label) );
 
 		if ( network_debug_flags & MXF_NETDBG_MSG_IDS ) {
-			fprintf( stderr, "[%#lx] ",
-					server->last_rpc_message_id );
+			fprintf( stderr, "[%#lx] ", request->message_id );
 		}
 
 		fprintf( stderr, "MX PUT_ARRAY('%s') = ", nf_label );
@@ -6935,128 +7454,1093 @@ mx_put_field_array( MX_RECORD *server_record,
 		fprintf( stderr, ")\n" );
 	}
 
+	/*************** Send the message. **************/
+
+	mx_status = mx_network_send_message( server_record, aligned_buffer );
+
+	return mx_status;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static mx_status_type
+mx_put_field_array_finish( MX_NETWORK_ASYNC_REQUEST *request,
+			MX_NETWORK_MESSAGE_BUFFER *aligned_buffer )
+{
+	static const char fname[] = "mx_put_field_array_finish()";
+
+	MX_RECORD *server_record;
+	char *remote_record_field_name;
+	MX_NETWORK_SERVER *server;
+	uint32_t *header;
+	char *message;
+	uint32_t header_length;
+	uint32_t send_message_type, receive_message_type;
+	uint32_t status_code;
+
+	server_record = request->server_record;
+	remote_record_field_name = request->remote_record_field_name;
+	send_message_type = request->send_message_type;
+
+	server = (MX_NETWORK_SERVER *) server_record->record_class_struct;
+
+	header = aligned_buffer->u.uint32_buffer;
+
+        header_length        = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+        receive_message_type = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
+        status_code          = mx_ntohl( header[ MX_NETWORK_STATUS_CODE ] );
+
+        message = aligned_buffer->u.char_buffer + header_length;
+
+	if ( ( server->remote_mx_version < 1005000L )
+	  && ( send_message_type == MX_NETMSG_PUT_ARRAY_BY_HANDLE )
+	  && ( receive_message_type ==
+	  		mx_server_response(MX_NETMSG_PUT_ARRAY_BY_NAME) ) )
+	{
+		/* Bug compatibility for old MX servers. */
+
+		/* MX servers prior to MX 1.5 returned the wrong server
+		 * response type for 'put array by handle' messages.
+		 */
+	} else
+        if ( receive_message_type != mx_server_response(send_message_type) ) {
+
+		if ( receive_message_type == MX_NETMSG_UNEXPECTED_ERROR ) {
+			return mx_put_array_ascii_error_message(
+					status_code,
+					server_record->name,
+					remote_record_field_name,
+					message );
+		}
+
+                return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"Message type for response was not %#lx.  "
+		"Instead it was of type = %#lx",
+			(unsigned long) mx_server_response(send_message_type),
+			(unsigned long) receive_message_type );
+        }
+
+        /* If the remote command failed, the message field will include
+         * the text of the error message rather than the array data
+         * we wanted.
+         */
+
+        if ( status_code != MXE_SUCCESS ) {
+		return mx_put_array_ascii_error_message(
+				status_code,
+				server_record->name,
+				remote_record_field_name,
+				message );
+        } else {
+		return MX_SUCCESSFUL_RESULT;
+	}
+}
+
+/* ---------------------------------------------------------------------- */
+
+MX_EXPORT mx_status_type
+mx_put_field_array( MX_RECORD *server_record,
+			char *remote_record_field_name,
+			MX_NETWORK_FIELD *nf,
+			MX_RECORD_FIELD *local_field,
+			void *value_ptr )
+{
+	MX_NETWORK_ASYNC_REQUEST request;
+	MX_NETWORK_SERVER *server;
+	mx_status_type mx_status;
+
 #if NETWORK_DEBUG_TIMING
-	MX_HRT_START( measurement );
-#endif
+	static const char fname[] = "mx_put_field_array()";
 
-#if 0
-	MX_DEBUG(-2,("%s: Before send message, last_rpc_message_id = %#lx",
-		fname, (unsigned long) server->last_rpc_message_id));
+	MX_HRT_TIMING measurement;
 #endif
 
-	/*************** Send the message. **************/
+	request.server_record = server_record;
+	request.remote_record_field_name = remote_record_field_name;
+	request.nf = nf;
+	request.local_field = local_field;
+	request.value_ptr = value_ptr;
 
-	mx_status = mx_network_send_message( server_record, aligned_buffer );
+#if NETWORK_DEBUG_TIMING
+	MX_HRT_START( measurement );
+#endif
+
+	mx_status = mx_put_field_array_send( &request );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-#if 0
-	MX_DEBUG(-2,("%s: Between send and wait, last_rpc_message_id = %#lx",
-		fname, (unsigned long) server->last_rpc_message_id));
-#endif
-
 	/************** Wait for the response. ************/
 
-	mx_status = mx_network_wait_for_message_id( server_record,
-						aligned_buffer,
-						server->last_rpc_message_id,
-						server->timeout );
+	server = (MX_NETWORK_SERVER *)
+			request.server_record->record_class_struct;
 
-#if 0
-	MX_DEBUG(-2,("%s: After wait for message, last_rpc_message_id = %#lx",
-		fname, (unsigned long) server->last_rpc_message_id));
-#endif
+	mx_status = mx_network_wait_for_message_id( request.server_record,
+						server->message_buffer,
+						request.message_id,
+						server->timeout );
 
 #if NETWORK_DEBUG_TIMING
 	MX_HRT_END( measurement );
 
-	if ( use_network_handles == FALSE ) {
-		MX_HRT_RESULTS( measurement, fname, remote_record_field_name );
+	if ( nf == (MX_NETWORK_FIELD *) NULL ) {
+		MX_HRT_RESULTS( measurement, fname,
+				request.remote_record_field_name );
 	} else {
 		MX_HRT_RESULTS( measurement, fname, "(%ld,%ld) %s",
 				nf->record_handle, nf->field_handle,
-				remote_record_field_name );
+				request.remote_record_field_name );
 	}
 #endif
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-	/* Update these pointers in case they were
-	 * changed by mx_reallocate_network_buffer()
-	 * in mx_network_wait_for_message_id().
-	 */
+	mx_status = mx_put_field_array_finish( &request,
+						server->message_buffer );
 
-	header = aligned_buffer->u.uint32_buffer;
+	return mx_status;
+}
 
-        header_length        = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
-        message_length       = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
-        receive_message_type = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
-        status_code          = mx_ntohl( header[ MX_NETWORK_STATUS_CODE ] );
+/* ====================================================================== */
 
-#if 0
-	if ( nf != NULL ) {
-		MX_DEBUG(-2,("%s: nf = %p, server = '%s', field = '%s'",
-			fname, nf, nf->server_record->name, nf->nfname));
+/* mx_get_array_async() and mx_put_array_async() send a request to the
+ * server and then return without waiting for the response.  The response
+ * is handled by mx_network_wait_for_message_id() whenever it arrives,
+ * which allows a client to have many requests in flight at once.
+ * mx_network_wait_for_completions() waits for a set of requests to finish.
+ */
+
+static mx_status_type
+mx_network_prepare_async_request( MX_NETWORK_FIELD *nf,
+				long datatype,
+				long num_dimensions,
+				long *dimension,
+				void *value_ptr,
+				MX_NETWORK_ASYNC_REQUEST *request,
+				const char *fname )
+{
+	mx_bool_type connected;
+	long i;
+	mx_status_type mx_status;
+
+	if ( nf == (MX_NETWORK_FIELD *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_FIELD pointer passed was NULL." );
+	}
+	if ( request == (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_ASYNC_REQUEST pointer passed was NULL." );
+	}
+
+	/* If we fail before the request has been sent, the request
+	 * is marked as already completed with the failure status.
+	 */
+
+	request->complete = TRUE;
+	request->next_request = NULL;
+	request->next_in_batch = NULL;
+	request->batch_rejected = FALSE;
+	request->local_field = NULL;
+
+	if ( ( num_dimensions < 0 )
+	  || ( num_dimensions > MXU_FIELD_MAX_DIMENSIONS ) )
+	{
+		request->status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The number of dimensions (%ld) requested for network "
+		"field '%s' is outside the allowed range of 0 to %d.",
+			num_dimensions, nf->nfname, MXU_FIELD_MAX_DIMENSIONS );
+
+		return request->status;
+	}
+	if ( ( dimension == NULL ) && ( num_dimensions > 0 ) ) {
+		request->status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+"dimension array pointer is NULL, but num_dimensions (%ld) is greater than 0",
+			num_dimensions );
+
+		return request->status;
+	}
+
+	request->status = mx_network_field_is_connected( nf, &connected );
+
+	if ( request->status.code != MXE_SUCCESS )
+		return request->status;
+
+	if ( connected == FALSE ) {
+		request->status = mx_network_field_connect( nf );
+
+		if ( request->status.code != MXE_SUCCESS )
+			return request->status;
+	}
+
+	/* The temporary record field must last until the response arrives,
+	 * so it is kept in the request structure.
+	 */
+
+	memset( &(request->temp_record_field), 0, sizeof(MX_RECORD_FIELD) );
+	memset( &(request->temp_driver), 0, sizeof(MX_DRIVER) );
+
+	if ( dimension == NULL ) {
+		request->dimension[0] = 0;
 	} else {
-		MX_DEBUG(-2,("%s: nf = %p, server = '%s', field = '%s'",
-			fname, nf, server_record->name,
-			remote_record_field_name));
+		for ( i = 0; i < num_dimensions; i++ ) {
+			request->dimension[i] = dimension[i];
+		}
+	}
+
+	request->data_element_size[0] = 0L;
+
+	/* For special 'typeinfo' fields, we treat them as MXFT_STRINGS. */
+
+	switch( datatype ) {
+	case MXFT_RECORD:
+	case MXFT_RECORDTYPE:
+	case MXFT_INTERFACE:
+	case MXFT_RECORD_FIELD:
+		datatype = MXFT_STRING;
+		break;
+	}
+
+	mx_status = mx_initialize_temp_record_field(
+			&(request->temp_record_field), &(request->temp_driver),
+			datatype, num_dimensions, request->dimension,
+			request->data_element_size, value_ptr );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		request->status = mx_status;
+
+		return mx_status;
+	}
+
+	request->server_record = nf->server_record;
+	request->remote_record_field_name = nf->nfname;
+	request->nf = nf;
+	request->local_field = &(request->temp_record_field);
+	request->value_ptr = value_ptr;
+
+	request->status = MX_SUCCESSFUL_RESULT;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static mx_status_type
+mx_network_send_async_request( MX_NETWORK_ASYNC_REQUEST *request,
+				mx_bool_type is_put )
+{
+	MX_NETWORK_SERVER *server;
+	mx_status_type mx_status;
+
+	if ( is_put ) {
+		mx_status = mx_put_field_array_send( request );
+	} else {
+		mx_status = mx_get_field_array_send( request );
+	}
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		request->status = mx_status;
+
+		return mx_status;
+	}
+
+	server = (MX_NETWORK_SERVER *)
+			request->server_record->record_class_struct;
+
+	if ( request->message_id == 0 ) {
+		/* Servers that are too old to support message IDs can
+		 * only have one request in flight, so we wait for the
+		 * response right now.
+		 */
+
+		mx_status = mx_network_wait_for_message_id(
+					request->server_record,
+					server->message_buffer,
+					0, server->timeout );
+
+		if ( mx_status.code == MXE_SUCCESS ) {
+			if ( is_put ) {
+				mx_status = mx_put_field_array_finish( request,
+						server->message_buffer );
+			} else {
+				mx_status = mx_get_field_array_finish( request,
+						server->message_buffer );
+			}
+		}
+
+		request->status = mx_status;
+
+		return mx_status;
+	}
+
+	request->status = MX_SUCCESSFUL_RESULT;
+	request->complete = FALSE;
+
+	request->next_request = server->async_request_list;
+
+	server->async_request_list = request;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static mx_status_type
+mx_network_start_async_request( MX_NETWORK_FIELD *nf,
+				long datatype,
+				long num_dimensions,
+				long *dimension,
+				void *value_ptr,
+				MX_NETWORK_ASYNC_REQUEST *request,
+				mx_bool_type is_put,
+				const char *fname )
+{
+	mx_status_type mx_status;
+
+	mx_status = mx_network_prepare_async_request( nf, datatype,
+					num_dimensions, dimension, value_ptr,
+					request, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_network_send_async_request( request, is_put );
+
+	return mx_status;
+}
+
+/* ---------------------------------------------------------------------- */
+
+MX_EXPORT mx_status_type
+mx_get_array_async( MX_NETWORK_FIELD *nf,
+		long datatype,
+		long num_dimensions,
+		long *dimension,
+		void *value_ptr,
+		MX_NETWORK_ASYNC_REQUEST *request )
+{
+	static const char fname[] = "mx_get_array_async()";
+
+	mx_status_type mx_status;
+
+	mx_status = mx_network_start_async_request( nf, datatype,
+					num_dimensions, dimension, value_ptr,
+					request, FALSE, fname );
+
+	return mx_status;
+}
+
+/* ---------------------------------------------------------------------- */
+
+MX_EXPORT mx_status_type
+mx_put_array_async( MX_NETWORK_FIELD *nf,
+		long datatype,
+		long num_dimensions,
+		long *dimension,
+		void *value_ptr,
+		MX_NETWORK_ASYNC_REQUEST *request )
+{
+	static const char fname[] = "mx_put_array_async()";
+
+	mx_status_type mx_status;
+
+	mx_status = mx_network_start_async_request( nf, datatype,
+					num_dimensions, dimension, value_ptr,
+					request, TRUE, fname );
+
+	return mx_status;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* mx_network_wait_for_completions() returns the status of the first
+ * request in the array that failed.  The status of each individual
+ * request is left in its 'status' field.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_wait_for_completions( long num_requests,
+				MX_NETWORK_ASYNC_REQUEST *request_array )
+{
+	static const char fname[] = "mx_network_wait_for_completions()";
+
+	MX_NETWORK_ASYNC_REQUEST *request, *batch_head;
+	MX_NETWORK_SERVER *server;
+	long i;
+	mx_status_type mx_status, first_failure;
+
+	if ( request_array == (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_ASYNC_REQUEST array pointer passed was NULL." );
+	}
+
+	first_failure = MX_SUCCESSFUL_RESULT;
+
+	for ( i = 0; i < num_requests; i++ ) {
+		request = &request_array[i];
+
+		if ( request->complete == FALSE ) {
+			server = (MX_NETWORK_SERVER *)
+				request->server_record->record_class_struct;
+
+			mx_status = mx_network_wait_for_message_id(
+						request->server_record,
+						server->message_buffer,
+						request->message_id,
+						server->timeout );
+
+			if ( request->complete == FALSE ) {
+				/* We gave up waiting for this request. */
+
+				batch_head = mx_network_remove_async_request(
+						server, request->message_id );
+
+				if ( mx_status.code == MXE_SUCCESS ) {
+					mx_status = mx_error(
+					MXE_NETWORK_IO_ERROR, fname,
+					"No response was received for message "
+					"ID %#lx sent to MX server '%s'.",
+						request->message_id,
+						request->server_record->name );
+				}
+
+				mx_network_fail_async_request( batch_head,
+								mx_status );
+
+				request->status = mx_status;
+				request->complete = TRUE;
+			}
+		}
+
+		if ( ( request->status.code != MXE_SUCCESS )
+		  && ( first_failure.code == MXE_SUCCESS ) )
+		{
+			first_failure = request->status;
+		}
+	}
+
+	return first_failure;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* mx_network_cancel_async() gives up on a request that is still waiting
+ * for its response, so that the caller may reuse the request structure.
+ * If the request was sent as part of a batch, the whole batch is given up.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_cancel_async( MX_NETWORK_ASYNC_REQUEST *request )
+{
+	static const char fname[] = "mx_network_cancel_async()";
+
+	MX_NETWORK_ASYNC_REQUEST *batch_head;
+	MX_NETWORK_SERVER *server;
+	mx_status_type mx_status;
+
+	if ( request == (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_ASYNC_REQUEST pointer passed was NULL." );
+	}
+
+	if ( request->complete )
+		return MX_SUCCESSFUL_RESULT;
+
+	if ( request->server_record == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The server record pointer for incomplete request %p is NULL.",
+			request );
+	}
+
+	server = (MX_NETWORK_SERVER *)
+			request->server_record->record_class_struct;
+
+	mx_status = mx_error( (MXE_INTERRUPTED | MXE_QUIET), fname,
+		"The request for '%s' with message ID %#lx to MX server '%s' "
+		"was cancelled.", request->remote_record_field_name,
+			request->message_id, request->server_record->name );
+
+	batch_head = mx_network_remove_async_request( server,
+						request->message_id );
+
+	if ( batch_head == (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+		request->status = mx_status;
+		request->complete = TRUE;
+	} else {
+		mx_network_fail_async_request( batch_head, mx_status );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* ====================================================================== */
+
+/* Batched get_array and put_array requests.  Requests for fields on the
+ * same MX server are sent together in one MX_NETMSG_GET_ARRAY_BATCH or
+ * MX_NETMSG_PUT_ARRAY_BATCH message.  The first request in a batch is put
+ * on the server's async request list, while the others are chained to it
+ * through 'next_in_batch' and completed along with it.
+ */
+
+#define MX_BATCH_PAD(n)		( ( (n) + 3 ) & ~((uint32_t) 3) )
+
+static mx_status_type
+mx_network_reserve_batch_space( MX_NETWORK_MESSAGE_BUFFER *aligned_buffer,
+				size_t needed_length )
+{
+	mx_status_type mx_status;
+
+	if ( aligned_buffer->buffer_length >= needed_length )
+		return MX_SUCCESSFUL_RESULT;
+
+	mx_status = mx_reallocate_network_buffer( aligned_buffer,
+						2 * needed_length );
+
+	return mx_status;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static mx_status_type
+mx_network_send_batch( MX_NETWORK_ASYNC_REQUEST *batch_head,
+			mx_bool_type is_put )
+{
+	static const char fname[] = "mx_network_send_batch()";
+
+	MX_NETWORK_ASYNC_REQUEST *request, *previous_request, *next_request;
+	MX_RECORD *server_record;
+	MX_NETWORK_SERVER *server;
+	MX_NETWORK_MESSAGE_BUFFER *aligned_buffer;
+	MX_LIST_HEAD *list_head;
+	uint32_t *header, *entry;
+	uint32_t header_length, offset, field_id_length, value_length;
+	uint32_t send_message_type;
+	unsigned long num_fields;
+	mx_status_type mx_status;
+
+	server_record = batch_head->server_record;
+
+	server = (MX_NETWORK_SERVER *) server_record->record_class_struct;
+
+	mx_status = mx_network_reconnect_if_down( server_record );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_network_fail_async_request( batch_head, mx_status );
+
+		return mx_status;
 	}
 
-	MX_DEBUG(-2,("%s: header_length = %lu, message_length = %lu, "
-		"message_type = %#lx, status_code = %lu", fname,
-		(unsigned long) header_length,
-		(unsigned long) message_length,
-		(unsigned long) message_type,
-		(unsigned long) status_code));
-#endif
+	if ( is_put ) {
+		send_message_type = MX_NETMSG_PUT_ARRAY_BATCH;
+	} else {
+		send_message_type = MX_NETMSG_GET_ARRAY_BATCH;
+	}
+
+	aligned_buffer = server->message_buffer;
+
+	header_length = mx_remote_header_length(server);
+
+	/* The message body starts with the number of fields. */
+
+	offset = sizeof(uint32_t);
+
+	num_fields = 0;
+
+	previous_request = NULL;
+
+	request = batch_head;
+
+	while ( request != (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+		next_request = request->next_in_batch;
+
+		mx_status = mx_network_reserve_batch_space( aligned_buffer,
+				header_length + offset + 3 * sizeof(uint32_t) );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_network_fail_async_request( batch_head, mx_status );
+
+			return mx_status;
+		}
+
+		entry = aligned_buffer->u.uint32_buffer
+				+ ( ( header_length + offset ) / sizeof(uint32_t) );
+
+		entry[0] = mx_htonl( request->nf->record_handle );
+		entry[1] = mx_htonl( request->nf->field_handle );
+
+		if ( is_put == FALSE ) {
+			offset += 2 * sizeof(uint32_t);
+		} else {
+			/* The value is copied in directly after the
+			 * handles and the value length.
+			 */
+
+			field_id_length = offset + 3 * sizeof(uint32_t);
+
+			mx_status = mx_put_field_array_copy( request,
+						server, field_id_length );
+
+			if ( mx_status.code == MXE_SUCCESS ) {
+				header = aligned_buffer->u.uint32_buffer;
+
+				value_length = mx_ntohl(
+				    header[MX_NETWORK_MESSAGE_LENGTH] )
+					- field_id_length;
+
+				mx_status = mx_network_reserve_batch_space(
+					aligned_buffer, header_length
+					+ field_id_length
+					+ MX_BATCH_PAD( value_length ) );
+			}
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				/* Leave this request out of the batch. */
+
+				request->status = mx_status;
+				request->complete = TRUE;
+				request->next_in_batch = NULL;
+
+				if ( previous_request == NULL ) {
+					batch_head = next_request;
+				} else {
+					previous_request->next_in_batch =
+							next_request;
+				}
+
+				request = next_request;
+				continue;
+			}
+
+			memset( aligned_buffer->u.char_buffer + header_length
+					+ field_id_length + value_length, 0,
+				MX_BATCH_PAD( value_length ) - value_length );
+
+			entry = aligned_buffer->u.uint32_buffer
+				+ ( ( header_length + offset ) / sizeof(uint32_t) );
+
+			entry[2] = mx_htonl( value_length );
+
+			offset = field_id_length + MX_BATCH_PAD( value_length );
+		}
+
+		num_fields++;
+
+		previous_request = request;
+
+		request = next_request;
+	}
+
+	if ( num_fields == 0 ) {
+		/* Every request in the batch has already failed. */
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	header = aligned_buffer->u.uint32_buffer;
+
+	header[MX_NETWORK_MAGIC]          = mx_htonl( MX_NETWORK_MAGIC_VALUE );
+	header[MX_NETWORK_HEADER_LENGTH]  = mx_htonl( header_length );
+	header[MX_NETWORK_MESSAGE_LENGTH] = mx_htonl( offset );
+	header[MX_NETWORK_STATUS_CODE]    = mx_htonl( MXE_SUCCESS );
+	header[MX_NETWORK_MESSAGE_TYPE]   = mx_htonl( send_message_type );
+	header[MX_NETWORK_DATA_TYPE]      = mx_htonl( 0 );
+
+	header[ header_length / sizeof(uint32_t) ] = mx_htonl( num_fields );
+
+	mx_network_update_message_id( &(server->last_rpc_message_id) );
+
+	header[MX_NETWORK_MESSAGE_ID] = mx_htonl( server->last_rpc_message_id );
+
+	for ( request = batch_head; request != NULL;
+				request = request->next_in_batch )
+	{
+		request->send_message_type = send_message_type;
+		request->message_id = server->last_rpc_message_id;
+		request->status = MX_SUCCESSFUL_RESULT;
+		request->complete = FALSE;
+	}
+
+	list_head = mx_get_record_list_head_struct( server_record );
+
+	if ( ( list_head->network_debug_flags & MXF_NETDBG_SUMMARY )
+	  || ( server->server_flags & MXF_NETWORK_SERVER_DEBUG_SUMMARY ) )
+	{
+		if ( list_head->network_debug_flags & MXF_NETDBG_MSG_IDS ) {
+			fprintf( stderr, "[%#lx] ",
+					server->last_rpc_message_id );
+		}
+
+		fprintf( stderr, "MX %s_ARRAY_BATCH( %lu fields ) to '%s'\n",
+			is_put ? "PUT" : "GET", num_fields,
+			server_record->name );
+	}
+
+	mx_status = mx_network_send_message( server_record, aligned_buffer );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_network_fail_async_request( batch_head, mx_status );
+
+		return mx_status;
+	}
+
+	batch_head->next_request = server->async_request_list;
+
+	server->async_request_list = batch_head;
+
+	MXW_UNUSED( fname );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void
+mx_network_finish_batch( MX_NETWORK_ASYNC_REQUEST *batch_head,
+			MX_NETWORK_MESSAGE_BUFFER *aligned_buffer )
+{
+	static const char fname[] = "mx_network_finish_batch()";
+
+	MX_NETWORK_ASYNC_REQUEST *request;
+	MX_RECORD *server_record;
+	MX_NETWORK_SERVER *server;
+	uint32_t *header, *entry;
+	char *message, *value;
+	uint32_t header_length, message_length, offset, entry_length;
+	uint32_t receive_message_type, status_code, value_length;
+	unsigned long num_fields;
+	mx_bool_type is_put;
+	mx_status_type mx_status;
+
+	server_record = batch_head->server_record;
+
+	server = (MX_NETWORK_SERVER *) server_record->record_class_struct;
+
+	if ( batch_head->send_message_type == MX_NETMSG_PUT_ARRAY_BATCH ) {
+		is_put = TRUE;
+		entry_length = 2 * sizeof(uint32_t);
+	} else {
+		is_put = FALSE;
+		entry_length = 3 * sizeof(uint32_t);
+	}
+
+	header = aligned_buffer->u.uint32_buffer;
+
+	header_length        = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+	message_length       = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
+	receive_message_type = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
+	status_code          = mx_ntohl( header[ MX_NETWORK_STATUS_CODE ] );
+
+	message = aligned_buffer->u.char_buffer + header_length;
+
+	if ( receive_message_type == MX_NETMSG_UNEXPECTED_ERROR ) {
+		/* The server does not understand batch messages after all.
+		 * None of the fields were touched, so we stop sending batches
+		 * to this server and mark the requests to be sent again one
+		 * at a time by mx_network_run_batch().
+		 */
+
+		server->server_supports_batch_messages = FALSE;
+
+		mx_status = mx_error( ( (long) status_code ) | MXE_QUIET, fname,
+			"MX server '%s' rejected a batch request: %s",
+			server_record->name, message );
+
+		mx_network_fail_async_request( batch_head, mx_status );
+
+		for ( request = batch_head; request != NULL;
+					request = request->next_in_batch )
+		{
+			request->batch_rejected = TRUE;
+		}
+		return;
+	}
+
+	if ( receive_message_type
+		!= mx_server_response( batch_head->send_message_type ) )
+	{
+		mx_status = mx_error( MXE_NETWORK_IO_ERROR, fname,
+			"Message type for response was not %#lx.  "
+			"Instead it was of type = %#lx",
+			    (unsigned long) mx_server_response(
+					batch_head->send_message_type ),
+			    (unsigned long) receive_message_type );
+
+		mx_network_fail_async_request( batch_head, mx_status );
+		return;
+	}
+
+	num_fields = 0;
+
+	if ( message_length >= sizeof(uint32_t) ) {
+		num_fields = mx_ntohl( *((uint32_t *) message) );
+	}
+
+	offset = sizeof(uint32_t);
+
+	for ( request = batch_head; request != NULL;
+				request = request->next_in_batch )
+	{
+		request->complete = TRUE;
+
+		if ( ( num_fields == 0 )
+		  || ( offset + entry_length > message_length ) )
+		{
+			request->status = mx_error( MXE_NETWORK_IO_ERROR, fname,
+			"The batch response from MX server '%s' did not "
+			"include a value for '%s'.",
+				server_record->name,
+				request->remote_record_field_name );
+			continue;
+		}
+
+		num_fields--;
+
+		entry = (uint32_t *) ( message + offset );
+
+		status_code = mx_ntohl( entry[0] );
+
+		if ( is_put ) {
+			value_length = mx_ntohl( entry[1] );
+		} else {
+			value_length = mx_ntohl( entry[2] );
+		}
+
+		value = message + offset + entry_length;
+
+		offset += entry_length + MX_BATCH_PAD( value_length );
+
+		if ( offset > message_length ) {
+			request->status = mx_error( MXE_NETWORK_IO_ERROR, fname,
+			"The value for '%s' in the batch response from "
+			"MX server '%s' extends past the end of the message.",
+				request->remote_record_field_name,
+				server_record->name );
+			continue;
+		}
+
+		if ( status_code != MXE_SUCCESS ) {
+			if ( status_code == MXE_BAD_HANDLE ) {
+				request->nf->record_handle = MX_ILLEGAL_HANDLE;
+				request->nf->field_handle = MX_ILLEGAL_HANDLE;
+			}
+
+			if ( is_put ) {
+				request->status =
+				    mx_put_array_ascii_error_message(
+					status_code, server_record->name,
+					request->remote_record_field_name,
+					value );
+			} else {
+				request->status =
+				    mx_get_array_ascii_error_message(
+					status_code, server_record->name,
+					request->remote_record_field_name,
+					value );
+			}
+		} else
+		if ( is_put ) {
+			request->status = MX_SUCCESSFUL_RESULT;
+		} else {
+			request->status = mx_get_field_array_copy( request,
+					server, (long) value_length, value );
+		}
+	}
+}
+
+/* ---------------------------------------------------------------------- */
+
+static mx_status_type
+mx_network_start_batch( long num_requests,
+			MX_NETWORK_ASYNC_REQUEST *request_array,
+			mx_bool_type is_put,
+			const char *fname )
+{
+	MX_NETWORK_ASYNC_REQUEST *request, *batch_tail;
+	MX_NETWORK_SERVER *server;
+	mx_bool_type *request_started;
+	long i, j, num_in_batch;
+
+	if ( request_array == (MX_NETWORK_ASYNC_REQUEST *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_ASYNC_REQUEST array pointer passed was NULL." );
+	}
+
+	if ( num_requests <= 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	request_started = calloc( num_requests, sizeof(mx_bool_type) );
+
+	if ( request_started == (mx_bool_type *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %ld element "
+		"array of request flags.", num_requests );
+	}
+
+	for ( i = 0; i < num_requests; i++ ) {
+		request = &request_array[i];
+
+		/* Requests that failed in mx_network_setup_request()
+		 * are already complete.
+		 */
+
+		if ( request_started[i]
+		  || ( request->local_field == (MX_RECORD_FIELD *) NULL ) )
+		{
+			continue;
+		}
+
+		request_started[i] = TRUE;
+
+		request->next_in_batch = NULL;
+
+		server = (MX_NETWORK_SERVER *)
+				request->server_record->record_class_struct;
+
+		/* Gather the other requests for the same server. */
+
+		batch_tail = request;
+		num_in_batch = 1;
+
+		if ( mx_server_supports_batch_messages(server) ) {
+			for ( j = i+1; j < num_requests; j++ ) {
+				if ( request_started[j]
+				  || ( request_array[j].local_field == NULL )
+				  || ( request_array[j].server_record
+					!= request->server_record ) )
+				{
+					continue;
+				}
+
+				request_started[j] = TRUE;
+
+				request_array[j].next_in_batch = NULL;
+
+				batch_tail->next_in_batch = &request_array[j];
+
+				batch_tail = &request_array[j];
+
+				num_in_batch++;
+			}
+		}
+
+		/* Failures are recorded in the individual requests. */
+
+		if ( num_in_batch == 1 ) {
+			(void) mx_network_send_async_request( request, is_put );
+		} else {
+			(void) mx_network_send_batch( request, is_put );
+		}
+	}
+
+	mx_free( request_started );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* ---------------------------------------------------------------------- */
+
+MX_EXPORT mx_status_type
+mx_network_setup_request( MX_NETWORK_ASYNC_REQUEST *request,
+			MX_NETWORK_FIELD *nf,
+			long datatype,
+			long num_dimensions,
+			long *dimension,
+			void *value_ptr )
+{
+	static const char fname[] = "mx_network_setup_request()";
+
+	mx_status_type mx_status;
+
+	mx_status = mx_network_prepare_async_request( nf, datatype,
+					num_dimensions, dimension, value_ptr,
+					request, fname );
+
+	return mx_status;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* mx_network_run_batch() sends the requests and waits for them.  If a
+ * server rejected a batch, the requests in it are then sent again as
+ * ordinary GET_ARRAY_BY_HANDLE or PUT_ARRAY_BY_HANDLE messages.
+ */
+
+static mx_status_type
+mx_network_run_batch( long num_requests,
+			MX_NETWORK_ASYNC_REQUEST *request_array,
+			mx_bool_type is_put,
+			const char *fname )
+{
+	MX_NETWORK_ASYNC_REQUEST *request;
+	mx_bool_type retry_needed;
+	long i;
+	mx_status_type mx_status;
+
+	mx_status = mx_network_start_batch( num_requests, request_array,
+						is_put, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_network_wait_for_completions( num_requests,
+							request_array );
+
+	retry_needed = FALSE;
+
+	for ( i = 0; i < num_requests; i++ ) {
+		request = &request_array[i];
+
+		if ( request->batch_rejected == FALSE )
+			continue;
+
+		request->batch_rejected = FALSE;
+		request->next_in_batch = NULL;
+
+		retry_needed = TRUE;
+
+		/* Failures are recorded in the individual requests. */
+
+		(void) mx_network_send_async_request( request, is_put );
+	}
+
+	if ( retry_needed ) {
+		mx_status = mx_network_wait_for_completions( num_requests,
+							request_array );
+	}
+
+	return mx_status;
+}
+
+/* ---------------------------------------------------------------------- */
+
+MX_EXPORT mx_status_type
+mx_get_array_batch( long num_requests,
+		MX_NETWORK_ASYNC_REQUEST *request_array )
+{
+	static const char fname[] = "mx_get_array_batch()";
 
-	if ( ( server->remote_mx_version < 1005000L )
-	  && ( send_message_type == MX_NETMSG_PUT_ARRAY_BY_HANDLE )
-	  && ( receive_message_type == 
-	  		mx_server_response(MX_NETMSG_PUT_ARRAY_BY_NAME) ) )
-	{
-		/* Bug compatibility for old MX servers. */
+	mx_status_type mx_status;
 
-		/* MX servers prior to MX 1.5 returned the wrong server
-		 * response type for 'put array by handle' messages.
-		 */
-	} else
-        if ( receive_message_type != mx_server_response(send_message_type) ) {
+	mx_status = mx_network_run_batch( num_requests, request_array,
+						FALSE, fname );
 
-		if ( receive_message_type == MX_NETMSG_UNEXPECTED_ERROR ) {
-			return mx_put_array_ascii_error_message(
-					status_code,
-					server_record->name,
-					remote_record_field_name,
-					message );
-		}
+	return mx_status;
+}
 
-                return mx_error( MXE_NETWORK_IO_ERROR, fname,
-		"Message type for response was not %#lx.  "
-		"Instead it was of type = %#lx",
-			(unsigned long) mx_server_response(send_message_type),
-			(unsigned long) receive_message_type );
-        }
+/* ---------------------------------------------------------------------- */
 
-        message = aligned_buffer->u.char_buffer + header_length;
+MX_EXPORT mx_status_type
+mx_put_array_batch( long num_requests,
+		MX_NETWORK_ASYNC_REQUEST *request_array )
+{
+	static const char fname[] = "mx_put_array_batch()";
 
-        /* If the remote command failed, the message field will include
-         * the text of the error message rather than the array data
-         * we wanted.
-         */
+	mx_status_type mx_status;
 
-        if ( status_code != MXE_SUCCESS ) {
-		return mx_put_array_ascii_error_message(
-				status_code,
-				server_record->name,
-				remote_record_field_name,
-				message );
-        } else {
-		return MX_SUCCESSFUL_RESULT;
-	}
+	mx_status = mx_network_run_batch( num_requests, request_array,
+						TRUE, fname );
+
+	return mx_status;
 }
 
 /* ====================================================================== */
@@ -9372,6 +10856,306 @@ mx_network_request_64bit_longs( MX_RECORD *server_record,
 
 /* ====================================================================== */
 
+/* mx_network_request_compression() asks the server to compress the messages
+ * that it sends us if their bodies are at least 'compression_threshold'
+ * bytes long.  Servers that do not know about compression leave the
+ * connection uncompressed, which is not treated as an error.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_request_compression( MX_RECORD *server_record,
+				unsigned long compression,
+				unsigned long compression_threshold )
+{
+	static const char fname[] = "mx_network_request_compression()";
+
+	MX_NETWORK_SERVER *server;
+	MX_TCPIP_SERVER *tcpip_server;
+	MX_UNIX_SERVER *unix_server;
+	MX_SOCKET *mx_socket;
+	mx_status_type mx_status;
+
+	if ( server_record == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"server_record argument passed was NULL." );
+	}
+
+	server = (MX_NETWORK_SERVER *) server_record->record_class_struct;
+
+	if ( server == (MX_NETWORK_SERVER *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_NETWORK_SERVER pointer for server record '%s' is NULL.",
+			server_record->name );
+	}
+
+	server->compression = MX_NETWORK_COMPRESSION_NONE;
+
+	switch( server_record->mx_type ) {
+	case MXN_NET_TCPIP:
+		tcpip_server = server_record->record_type_struct;
+
+		mx_socket = tcpip_server->socket;
+		break;
+	case MXN_NET_UNIX:
+		unix_server = server_record->record_type_struct;
+
+		mx_socket = unix_server->socket;
+		break;
+	default:
+		return mx_error( MXE_UNSUPPORTED, fname,
+		"Compression is not supported for "
+		"server record '%s' of type %ld.",
+			server_record->name, server_record->mx_type );
+	}
+
+	if ( mx_socket == (MX_SOCKET *) NULL ) {
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"Server record '%s' is not connected.", server_record->name );
+	}
+
+	mx_socket->accept_compressed_messages = FALSE;
+
+#if !defined( MX_HAVE_ZLIB )
+	if ( compression != MX_NETWORK_COMPRESSION_NONE ) {
+		return mx_error( MXE_UNSUPPORTED, fname,
+		"This copy of MX was built without zlib, so it cannot "
+		"decompress messages from server '%s'.",
+			server_record->name );
+	}
+#endif
+
+	if ( ( server->remote_mx_version == MXT_REMOTE_MX_VERSION_UNKNOWN )
+	  || ( server->remote_mx_version < 2002000L ) )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_status = mx_network_set_option( server_record,
+			MX_NETWORK_OPTION_COMPRESSION_THRESHOLD | MXE_QUIET,
+			compression_threshold );
+
+	if ( mx_status.code == MXE_ILLEGAL_ARGUMENT ) {
+		return MX_SUCCESSFUL_RESULT;
+	} else
+	if ( mx_status.code != MXE_SUCCESS ) {
+		return mx_status;
+	}
+
+	mx_status = mx_network_set_option( server_record,
+				MX_NETWORK_OPTION_COMPRESSION | MXE_QUIET,
+				compression );
+
+	switch( mx_status.code ) {
+	case MXE_SUCCESS:
+		server->compression = compression;
+
+		if ( compression != MX_NETWORK_COMPRESSION_NONE ) {
+			mx_socket->accept_compressed_messages = TRUE;
+		}
+		break;
+	case MXE_ILLEGAL_ARGUMENT:
+		/* The server does not support compression. */
+
+		break;
+	default:
+		return mx_status;
+	}
+
+	MX_DEBUG( 2,("%s: server '%s', compression = %#lx",
+		fname, server_record->name, server->compression));
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* ====================================================================== */
+
+/* mx_network_check_batch_messages() asks the server whether it accepts
+ * MX_NETMSG_GET_ARRAY_BATCH and MX_NETMSG_PUT_ARRAY_BATCH.  Servers that
+ * do not know about MX_NETWORK_OPTION_BATCH_MESSAGES reject the option,
+ * in which case requests are sent to them one at a time.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_check_batch_messages( MX_RECORD *server_record )
+{
+	static const char fname[] = "mx_network_check_batch_messages()";
+
+	MX_NETWORK_SERVER *server;
+	unsigned long option_value;
+	mx_status_type mx_status;
+
+	if ( server_record == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"server_record argument passed was NULL." );
+	}
+
+	server = (MX_NETWORK_SERVER *) server_record->record_class_struct;
+
+	if ( server == (MX_NETWORK_SERVER *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_NETWORK_SERVER pointer for server record '%s' is NULL.",
+			server_record->name );
+	}
+
+	server->server_supports_batch_messages = FALSE;
+
+	if ( ( server->remote_mx_version == MXT_REMOTE_MX_VERSION_UNKNOWN )
+	  || ( server->remote_mx_version < 2002000L )
+	  || ( mx_server_supports_message_ids(server) == FALSE )
+	  || ( server->server_supports_network_handles == FALSE ) )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_status = mx_network_get_option( server_record,
+			MX_NETWORK_OPTION_BATCH_MESSAGES | MXE_QUIET,
+			&option_value );
+
+	switch( mx_status.code ) {
+	case MXE_SUCCESS:
+		if ( option_value != 0 ) {
+			server->server_supports_batch_messages = TRUE;
+		}
+		break;
+	case MXE_ILLEGAL_ARGUMENT:
+		/* The server does not support batch messages. */
+
+		break;
+	default:
+		return mx_status;
+	}
+
+	MX_DEBUG( 2,("%s: server '%s', server_supports_batch_messages = %d",
+		fname, server_record->name,
+		(int) server->server_supports_batch_messages));
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* ====================================================================== */
+
+/* mx_network_request_shared_memory() asks the server to create a shared
+ * memory segment with 'num_slots' slots of 'slot_size' bytes and to send
+ * the bodies of messages that are at least 'threshold' bytes long through
+ * it.  The segment's file descriptor can only be passed through a Unix
+ * domain socket, so the request is skipped for TCP/IP connections.  If the
+ * server refuses, the connection keeps using the socket alone, which is
+ * not treated as an error.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_request_shared_memory( MX_RECORD *server_record,
+				unsigned long num_slots,
+				unsigned long slot_size,
+				unsigned long threshold )
+{
+	static const char fname[] = "mx_network_request_shared_memory()";
+
+	MX_NETWORK_SERVER *server;
+	MX_UNIX_SERVER *unix_server;
+	MX_SOCKET *mx_socket;
+	mx_status_type mx_status;
+
+	if ( server_record == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"server_record argument passed was NULL." );
+	}
+
+	server = (MX_NETWORK_SERVER *) server_record->record_class_struct;
+
+	if ( server == (MX_NETWORK_SERVER *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_NETWORK_SERVER pointer for server record '%s' is NULL.",
+			server_record->name );
+	}
+
+	server->use_shared_memory = FALSE;
+
+	switch( server_record->mx_type ) {
+	case MXN_NET_TCPIP:
+		return MX_SUCCESSFUL_RESULT;
+		break;
+	case MXN_NET_UNIX:
+		unix_server = server_record->record_type_struct;
+
+		mx_socket = unix_server->socket;
+		break;
+	default:
+		return mx_error( MXE_UNSUPPORTED, fname,
+		"Shared memory transport is not supported for "
+		"server record '%s' of type %ld.",
+			server_record->name, server_record->mx_type );
+	}
+
+	if ( mx_socket == (MX_SOCKET *) NULL ) {
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"Server record '%s' is not connected.", server_record->name );
+	}
+
+	if ( ( server->remote_mx_version == MXT_REMOTE_MX_VERSION_UNKNOWN )
+	  || ( server->remote_mx_version < 2002000L ) )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	if ( ( num_slots == 0 ) || ( num_slots > MX_NETWORK_SHM_MAX_SLOTS )
+	  || ( slot_size < MX_NETWORK_SHM_SLOT_SIZE_UNIT ) )
+	{
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"Cannot ask server '%s' for %lu shared memory slots "
+		"of %lu bytes.", server_record->name, num_slots, slot_size );
+	}
+
+	mx_status = mx_network_shm_expect_descriptor( mx_socket );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_network_set_option( server_record,
+			MX_NETWORK_OPTION_SHARED_MEMORY | MXE_QUIET,
+			mx_network_shm_option_value( num_slots, slot_size ) );
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		mx_status = mx_network_shm_attach( mx_socket );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			/* Tell the server to stop using the segment. */
+
+			(void) mx_network_shm_detach( mx_socket );
+
+			return mx_network_set_option( server_record,
+					MX_NETWORK_OPTION_SHARED_MEMORY, 0 );
+		}
+
+		server->use_shared_memory = TRUE;
+
+		if ( threshold != MX_NETWORK_SHM_DEFAULT_THRESHOLD ) {
+			mx_status = mx_network_set_option( server_record,
+					MX_NETWORK_OPTION_SHARED_MEMORY_THRESHOLD,
+					threshold );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+		}
+	} else {
+		(void) mx_network_shm_detach( mx_socket );
+
+		/* MXE_ILLEGAL_ARGUMENT means that the server does not
+		 * support shared memory or refused to make a segment.
+		 */
+
+		if ( mx_status.code != MXE_ILLEGAL_ARGUMENT )
+			return mx_status;
+	}
+
+	MX_DEBUG( 2,("%s: server '%s', use_shared_memory = %d",
+		fname, server_record->name, (int) server->use_shared_memory));
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* ====================================================================== */
+
 MX_EXPORT mx_status_type
 mx_network_send_client_version( MX_RECORD *server_record )
 {
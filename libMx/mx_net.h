@@ -95,6 +95,12 @@ typedef struct mx_network_message_buffer {
 
 	mx_bool_type used_by_socket_handler;
 
+	/* If the body of a GET_ARRAY response was left in a shared memory
+	 * slot, this points to it.  See mx_net_shm.h.
+	 */
+
+	void *shared_memory_body;
+
 	union {
 		struct mx_network_server_type *network_server;
 		struct mx_socket_handler_type *socket_handler;
@@ -164,6 +170,9 @@ typedef struct mx_network_server_type {
 	mx_bool_type server_supports_network_handles;
 	mx_bool_type network_handles_are_valid;
 	mx_bool_type use_64bit_network_longs;
+	unsigned long compression;
+	mx_bool_type use_shared_memory;
+	mx_bool_type server_supports_batch_messages;
 
 	unsigned long connection_status;
 
@@ -190,10 +199,57 @@ typedef struct mx_network_server_type {
 	struct mx_network_field_type **network_field_array;
 
 	MX_LIST *callback_list;
+
+	/* Asynchronous requests sent to this server that are still
+	 * waiting for their responses.
+	 */
+
+	struct mx_network_async_request_type *async_request_list;
 } MX_NETWORK_SERVER;
 
 typedef struct mx_network_field_type MX_NETWORK_FIELD;
 
+/* An MX_NETWORK_ASYNC_REQUEST describes a get_array or put_array request
+ * started by mx_get_array_async() or mx_put_array_async().  The structure
+ * belongs to the caller, but it and the value and dimension arrays passed
+ * to the async function must not be reused until the request has been
+ * completed by mx_network_wait_for_completions() or given up on with
+ * mx_network_cancel_async().
+ */
+
+typedef struct mx_network_async_request_type {
+	MX_RECORD *server_record;
+	char *remote_record_field_name;
+	MX_NETWORK_FIELD *nf;
+	MX_RECORD_FIELD *local_field;
+	void *value_ptr;
+
+	uint32_t send_message_type;
+	unsigned long message_id;
+
+	mx_bool_type complete;
+	mx_status_type status;
+
+	MX_RECORD_FIELD temp_record_field;
+	MX_DRIVER temp_driver;
+	long dimension[MXU_FIELD_MAX_DIMENSIONS];
+	size_t data_element_size[MXU_FIELD_MAX_DIMENSIONS];
+
+	struct mx_network_async_request_type *next_request;
+
+	/* Requests sent together in one batch message share a message ID
+	 * and are chained together through 'next_in_batch'.
+	 */
+
+	struct mx_network_async_request_type *next_in_batch;
+
+	/* 'batch_rejected' is set if the server refused the whole batch,
+	 * so that the request can be sent again on its own.
+	 */
+
+	mx_bool_type batch_rejected;
+} MX_NETWORK_ASYNC_REQUEST;
+
 typedef struct {
 	mx_status_type ( *receive_message ) ( MX_NETWORK_SERVER *server,
 					MX_NETWORK_MESSAGE_BUFFER *buffer );
@@ -308,6 +364,10 @@ typedef struct {
 
 #define MXF_NETWORK_SERVER_USE_64BIT_LONGS	0x10000
 
+#define MXF_NETWORK_SERVER_USE_COMPRESSION	0x20000
+#define MXF_NETWORK_SERVER_USE_SHUFFLE		0x40000
+#define MXF_NETWORK_SERVER_USE_SHARED_MEMORY	0x80000
+
 #define MXF_NETWORK_SERVER_USE_OLD_ARRAY_COPY	0x100000
 
 #define MXF_NETWORK_SERVER_DEBUG_MESSAGE_IDS	0x8000000
@@ -354,6 +414,8 @@ typedef struct {
 
 #define MX_NETMSG_ERROR_FLAG		0x8000000
 #define MX_NETMSG_SERVER_RESPONSE_FLAG	0x4000000
+#define MX_NETMSG_COMPRESSED_FLAG	0x2000000
+#define MX_NETMSG_SHARED_MEMORY_FLAG	0x1000000
 
 #define mx_server_response(x)	((x) | MX_NETMSG_SERVER_RESPONSE_FLAG)
 
@@ -385,6 +447,37 @@ typedef struct {
 #define MX_NETMSG_GET_ARRAY_BY_HANDLE	0x1003
 #define MX_NETMSG_PUT_ARRAY_BY_HANDLE	0x1004
 
+/* The batch messages carry several (record_handle, field_handle) pairs
+ * in one message.  All values in the message body are 32-bit integers
+ * in network byte order, and each field value is padded to a multiple
+ * of 4 bytes.
+ *
+ * GET_ARRAY_BATCH  request:  num_fields, then for each field
+ *                            record_handle, field_handle.
+ *                  response: num_fields, then for each field
+ *                            status_code, datatype, value_length, value.
+ *
+ * PUT_ARRAY_BATCH  request:  num_fields, then for each field
+ *                            record_handle, field_handle,
+ *                            value_length, value.
+ *                  response: num_fields, then for each field
+ *                            status_code, message_length, message.
+ *
+ * If a field failed, its value in a GET_ARRAY_BATCH response is the
+ * text of the error message instead.
+ *
+ * Clients only send batch messages to servers that report a nonzero
+ * value for MX_NETWORK_OPTION_BATCH_MESSAGES when they connect.
+ */
+
+#define MX_NETMSG_GET_ARRAY_BATCH	0x1005
+#define MX_NETMSG_PUT_ARRAY_BATCH	0x1006
+
+#define mx_server_supports_batch_messages(s) \
+	( mx_server_supports_message_ids(s) \
+	  && (s)->server_supports_network_handles \
+	  && (s)->server_supports_batch_messages )
+
 #define MX_NETMSG_GET_NETWORK_HANDLE	0x2001
 #define MX_NETMSG_GET_FIELD_TYPE	0x2005
 
@@ -422,6 +515,45 @@ typedef struct {
 #define MX_NETWORK_OPTION_WORDSIZE		4
 #define MX_NETWORK_OPTION_CLIENT_VERSION	5
 #define MX_NETWORK_OPTION_CLIENT_VERSION_TIME	6
+#define MX_NETWORK_OPTION_COMPRESSION		7
+#define MX_NETWORK_OPTION_COMPRESSION_THRESHOLD	8
+
+	/* MX_NETWORK_OPTION_COMPRESSION asks the server to compress the
+	 * bodies of messages it sends that are at least as long as the
+	 * value of MX_NETWORK_OPTION_COMPRESSION_THRESHOLD.  Compressed
+	 * messages have MX_NETMSG_COMPRESSED_FLAG set in their message
+	 * type.  Their body starts with the uncompressed body length and
+	 * a word containing the codec in the low byte and the element size
+	 * used by the byte shuffle filter in the next byte.  The compressed
+	 * data follows.  Receivers decompress such messages before anything
+	 * else looks at them.
+	 */
+
+#define MX_NETWORK_COMPRESSION_NONE		0x0
+#define MX_NETWORK_COMPRESSION_ZLIB		0x1
+#define MX_NETWORK_COMPRESSION_SHUFFLE		0x100
+
+#define MX_NETWORK_COMPRESSION_DEFAULT_THRESHOLD	65536
+
+#define MX_NETWORK_OPTION_SHARED_MEMORY		9
+
+#define MX_NETWORK_OPTION_SHARED_MEMORY_THRESHOLD	10
+
+	/* MX_NETWORK_OPTION_SHARED_MEMORY asks the server to create a shared
+	 * memory segment for a client connected through a Unix domain socket.
+	 * The value holds the number of slots and the slot size as described
+	 * in mx_net_shm.h.  The server passes the segment's file descriptor
+	 * along with its response and then sends the bodies of messages that
+	 * are at least as long as MX_NETWORK_OPTION_SHARED_MEMORY_THRESHOLD
+	 * through it.  A value of 0 detaches the segment.
+	 */
+
+#define MX_NETWORK_OPTION_BATCH_MESSAGES	11
+
+	/* MX_NETWORK_OPTION_BATCH_MESSAGES can only be read.  Servers that
+	 * handle MX_NETMSG_GET_ARRAY_BATCH and MX_NETMSG_PUT_ARRAY_BATCH
+	 * return 1.  Older servers reject the option number.
+	 */
 
 /*---*/
 
@@ -488,6 +620,17 @@ MX_API mx_status_type mx_network_wait_for_messages_from_server(
 MX_API mx_status_type mx_network_wait_for_messages( MX_RECORD *record_list,
 						double timeout_in_seconds );
 
+/* mx_network_wait_for_messages_from_servers() blocks until a message
+ * arrives from any of the servers in the array or the timeout expires,
+ * and then handles the messages that have arrived.  Callbacks thus
+ * run as soon as they arrive without the caller having to poll.
+ */
+
+MX_API mx_status_type mx_network_wait_for_messages_from_servers(
+					long num_servers,
+					MX_RECORD **server_record_array,
+					double timeout_in_seconds );
+
 MX_API mx_status_type mx_network_connection_is_up( MX_RECORD *server_record,
 					mx_bool_type *connection_is_up );
 
@@ -587,6 +730,58 @@ MX_API mx_status_type mx_put_array( MX_NETWORK_FIELD *nf,
 				long *dimension,
 				void *value );
 
+/* The asynchronous versions of mx_get_array() and mx_put_array() send
+ * their requests without waiting for the responses, so that several
+ * requests can be in flight at once, even to different servers.
+ * mx_network_wait_for_completions() then waits for all of them.
+ */
+
+#define mx_get_async( nf, t, v, r ) \
+		mx_get_array_async( (nf), (t), 0, NULL, (v), (r) )
+
+#define mx_put_async( nf, t, v, r ) \
+		mx_put_array_async( (nf), (t), 0, NULL, (v), (r) )
+
+MX_API mx_status_type mx_get_array_async( MX_NETWORK_FIELD *nf,
+				long datatype,
+				long num_dimensions,
+				long *dimension,
+				void *value,
+				MX_NETWORK_ASYNC_REQUEST *request );
+
+MX_API mx_status_type mx_put_array_async( MX_NETWORK_FIELD *nf,
+				long datatype,
+				long num_dimensions,
+				long *dimension,
+				void *value,
+				MX_NETWORK_ASYNC_REQUEST *request );
+
+MX_API mx_status_type mx_network_wait_for_completions( long num_requests,
+				MX_NETWORK_ASYNC_REQUEST *request_array );
+
+MX_API mx_status_type mx_network_cancel_async(
+				MX_NETWORK_ASYNC_REQUEST *request );
+
+/* mx_get_array_batch() and mx_put_array_batch() transfer the values for
+ * an array of requests prepared by mx_network_setup_request().  Requests
+ * for fields on the same MX server are combined into a single message
+ * if the server supports it.
+ */
+
+MX_API mx_status_type mx_network_setup_request(
+				MX_NETWORK_ASYNC_REQUEST *request,
+				MX_NETWORK_FIELD *nf,
+				long datatype,
+				long num_dimensions,
+				long *dimension,
+				void *value );
+
+MX_API mx_status_type mx_get_array_batch( long num_requests,
+				MX_NETWORK_ASYNC_REQUEST *request_array );
+
+MX_API mx_status_type mx_put_array_batch( long num_requests,
+				MX_NETWORK_ASYNC_REQUEST *request_array );
+
 /*---*/
 
 #define mx_get_by_name( s, r, t, v ) \
@@ -697,6 +892,20 @@ MX_API mx_status_type mx_network_request_64bit_longs(
 				MX_RECORD *server_record,
 				mx_bool_type use_64bit_network_longs );
 
+MX_API mx_status_type mx_network_request_compression(
+				MX_RECORD *server_record,
+				unsigned long compression,
+				unsigned long compression_threshold );
+
+MX_API mx_status_type mx_network_request_shared_memory(
+				MX_RECORD *server_record,
+				unsigned long num_slots,
+				unsigned long slot_size,
+				unsigned long threshold );
+
+MX_API mx_status_type mx_network_check_batch_messages(
+				MX_RECORD *server_record );
+
 MX_API mx_status_type mx_network_send_client_version(
 				MX_RECORD *server_record );
 
@@ -0,0 +1,954 @@
+/*
+ * Name:    mx_net_shm.c
+ *
+ * Purpose: Shared memory transport for the bodies of large MX network
+ *          messages sent between processes on the same host.
+ *
+ *          The segment starts with a small header, followed by an array
+ *          of 'slot in use' flags and then the slots themselves, which
+ *          begin on a page boundary.  The flags are set by the sender
+ *          when it fills a slot and cleared by the receiver once it is
+ *          done with the message body in the slot.  Since the sender
+ *          always uses the slots in order and the receiver processes
+ *          messages in the order they arrive, no other synchronization
+ *          between the two processes is needed.
+ *
+ *          The segment is created by the sender as a sealed memfd and
+ *          its file descriptor is passed to the receiver with SCM_RIGHTS.
+ *          Nothing in the segment is trusted by the sender after it has
+ *          been handed out, other than the 'slot in use' flags.
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#define MX_NET_SHM_DEBUG	FALSE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mx_osdef.h"
+
+#if HAVE_SEALED_MEMFD
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+
+#  if !defined(MFD_ALLOW_SEALING) || !defined(F_SEAL_SHRINK)
+#    undef HAVE_SEALED_MEMFD
+#    define HAVE_SEALED_MEMFD	0
+#  endif
+#endif
+
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_stdint.h"
+#include "mx_atomic.h"
+#include "mx_socket.h"
+#include "mx_net.h"
+#include "mx_net_shm.h"
+
+#define MXP_NETWORK_SHM_MAGIC		0x4d58534dUL	/* 'MXSM' */
+
+#define MXP_NETWORK_SHM_PAGE_SIZE	4096
+
+#define MXP_NETWORK_SHM_SEALS	( F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL )
+
+typedef struct {
+	uint32_t magic;
+	uint32_t num_slots;
+	uint32_t slot_size;
+	uint32_t threshold;
+	uint32_t data_offset;
+	uint32_t reserved[3];
+} MXP_NETWORK_SHM_HEADER;
+
+/* ---------------------------------------------------------------------- */
+
+#if HAVE_SEALED_MEMFD
+
+static void
+mxp_network_shm_set_pointers( MX_NETWORK_SHM *shm, size_t data_offset )
+{
+	shm->slot_in_use = (int32_t *) ( (MXP_NETWORK_SHM_HEADER *)
+						shm->base_address + 1 );
+
+	shm->slot_data = (unsigned char *) shm->base_address + data_offset;
+}
+
+/* mx_network_shm_create() is called by the sending side of the connection,
+ * which is the MX server.  It creates a new segment and attaches it to the
+ * socket.  The file descriptor of the segment must then be passed to the
+ * client with mx_network_shm_send_descriptor().
+ */
+
+MX_EXPORT mx_status_type
+mx_network_shm_create( MX_SOCKET *mx_socket,
+			unsigned long num_slots,
+			unsigned long slot_size,
+			unsigned long threshold )
+{
+	static const char fname[] = "mx_network_shm_create()";
+
+	MX_NETWORK_SHM *shm;
+	MXP_NETWORK_SHM_HEADER *shm_header;
+	struct sockaddr_storage local_address;
+	socklen_t address_length;
+	unsigned long data_offset;
+	int shm_fd, os_status, saved_errno;
+	mx_status_type mx_status;
+
+	if ( mx_socket == (MX_SOCKET *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_SOCKET pointer passed was NULL." );
+	}
+	if ( mx_socket->shared_memory != NULL ) {
+		return mx_error( MXE_ALREADY_EXISTS, fname,
+		"Socket %d already has a shared memory segment attached.",
+			(int) mx_socket->socket_fd );
+	}
+	if ( ( num_slots == 0 ) || ( num_slots > MX_NETWORK_SHM_MAX_SLOTS ) ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The requested number of slots (%lu) is outside "
+		"the allowed range of 1 to %d.",
+			num_slots, MX_NETWORK_SHM_MAX_SLOTS );
+	}
+	if ( ( slot_size == 0 ) || ( slot_size > INT32_MAX ) ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The requested slot size of %lu bytes is not valid.",
+			slot_size );
+	}
+
+	/* The file descriptor can only be passed through a Unix domain
+	 * socket.
+	 */
+
+	address_length = sizeof(local_address);
+
+	os_status = getsockname( mx_socket->socket_fd,
+			(struct sockaddr *) &local_address, &address_length );
+
+	if ( ( os_status != 0 ) || ( local_address.ss_family != AF_UNIX ) ) {
+		return mx_error( MXE_PERMISSION_DENIED, fname,
+		"Shared memory can only be requested by a client connected "
+		"through a Unix domain socket, but socket %d is not one.",
+			(int) mx_socket->socket_fd );
+	}
+
+	shm = (MX_NETWORK_SHM *) calloc( 1, sizeof(MX_NETWORK_SHM) );
+
+	if ( shm == (MX_NETWORK_SHM *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an "
+		"MX_NETWORK_SHM structure." );
+	}
+
+	data_offset = sizeof(MXP_NETWORK_SHM_HEADER)
+				+ num_slots * sizeof(int32_t);
+
+	data_offset = MXP_NETWORK_SHM_PAGE_SIZE
+		* ( ( data_offset + MXP_NETWORK_SHM_PAGE_SIZE - 1 )
+				/ MXP_NETWORK_SHM_PAGE_SIZE );
+
+	shm->descriptor = -1;
+	shm->is_sender = TRUE;
+	shm->waiting_for_descriptor = FALSE;
+	shm->num_slots = num_slots;
+	shm->slot_size = slot_size;
+	shm->threshold = threshold;
+	shm->next_slot = 0;
+	shm->borrowed_slot = -1;
+	shm->segment_length = data_offset + num_slots * (size_t) slot_size;
+
+	shm_fd = memfd_create( "mx_net_shm", MFD_CLOEXEC | MFD_ALLOW_SEALING );
+
+	if ( shm_fd < 0 ) {
+		saved_errno = errno;
+
+		mx_free( shm );
+
+		return mx_error( MXE_OPERATING_SYSTEM_ERROR, fname,
+		"Cannot create a shared memory segment for socket %d.  "
+		"Errno = %d, error message = '%s'.",
+			(int) mx_socket->socket_fd,
+			saved_errno, strerror( saved_errno ) );
+	}
+
+	os_status = ftruncate( shm_fd, (off_t) shm->segment_length );
+
+	if ( os_status == 0 ) {
+		os_status = fcntl( shm_fd, F_ADD_SEALS, MXP_NETWORK_SHM_SEALS );
+	}
+
+	if ( os_status != 0 ) {
+		saved_errno = errno;
+
+		mx_status = mx_error( MXE_OPERATING_SYSTEM_ERROR, fname,
+		"Cannot set up a %lu byte shared memory segment for "
+		"socket %d.  Errno = %d, error message = '%s'.",
+			(unsigned long) shm->segment_length,
+			(int) mx_socket->socket_fd,
+			saved_errno, strerror( saved_errno ) );
+
+		(void) close( shm_fd );
+		mx_free( shm );
+
+		return mx_status;
+	}
+
+	shm->base_address = mmap( NULL, shm->segment_length,
+			PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0 );
+
+	if ( shm->base_address == MAP_FAILED ) {
+		saved_errno = errno;
+
+		mx_status = mx_error( MXE_OPERATING_SYSTEM_ERROR, fname,
+		"Cannot map the %lu byte shared memory segment for "
+		"socket %d.  Errno = %d, error message = '%s'.",
+			(unsigned long) shm->segment_length,
+			(int) mx_socket->socket_fd,
+			saved_errno, strerror( saved_errno ) );
+
+		(void) close( shm_fd );
+		mx_free( shm );
+
+		return mx_status;
+	}
+
+	shm_header = (MXP_NETWORK_SHM_HEADER *) shm->base_address;
+
+	shm_header->magic       = MXP_NETWORK_SHM_MAGIC;
+	shm_header->num_slots   = (uint32_t) num_slots;
+	shm_header->slot_size   = (uint32_t) slot_size;
+	shm_header->threshold   = (uint32_t) threshold;
+	shm_header->data_offset = (uint32_t) data_offset;
+
+	mxp_network_shm_set_pointers( shm, data_offset );
+
+	shm->descriptor = shm_fd;
+
+	mx_socket->shared_memory = shm;
+
+#if MX_NET_SHM_DEBUG
+	MX_DEBUG(-2,("%s: socket %d, %lu slots of %lu bytes",
+		fname, (int) mx_socket->socket_fd, num_slots, slot_size));
+#endif
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* mx_network_shm_send_descriptor() sends the message in 'message_buffer'
+ * with the file descriptor of the segment attached to it.  The caller
+ * must make sure that nothing else is waiting to be sent to the client,
+ * since the message bypasses the socket's send hook.  Our copy of the
+ * descriptor is closed afterwards, since the mapping does not need it.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_shm_send_descriptor( MX_SOCKET *mx_socket,
+				MX_NETWORK_MESSAGE_BUFFER *message_buffer )
+{
+	static const char fname[] = "mx_network_shm_send_descriptor()";
+
+	MX_NETWORK_SHM *shm;
+	uint32_t *header;
+	char *ptr;
+	size_t bytes_left;
+	long bytes_sent;
+	struct msghdr message_header;
+	struct iovec iovec_array[1];
+	struct cmsghdr *control_header;
+	union {
+		struct cmsghdr align;
+		char buffer[ CMSG_SPACE(sizeof(int)) ];
+	} control;
+	int saved_errno;
+
+	shm = (MX_NETWORK_SHM *) mx_socket->shared_memory;
+
+	if ( ( shm == (MX_NETWORK_SHM *) NULL ) || ( shm->descriptor < 0 ) ) {
+		return mx_error( MXE_NOT_READY, fname,
+		"Socket %d does not have a shared memory segment "
+		"waiting to be sent.", (int) mx_socket->socket_fd );
+	}
+
+	header = message_buffer->u.uint32_buffer;
+
+	ptr = message_buffer->u.char_buffer;
+
+	bytes_left = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] )
+			+ mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
+
+	/* The descriptor goes with the first part of the message. */
+
+	memset( &message_header, 0, sizeof(message_header) );
+	memset( &control, 0, sizeof(control) );
+
+	iovec_array[0].iov_base = ptr;
+	iovec_array[0].iov_len = bytes_left;
+
+	message_header.msg_iov = iovec_array;
+	message_header.msg_iovlen = 1;
+	message_header.msg_control = control.buffer;
+	message_header.msg_controllen = sizeof(control.buffer);
+
+	control_header = CMSG_FIRSTHDR( &message_header );
+
+	control_header->cmsg_level = SOL_SOCKET;
+	control_header->cmsg_type = SCM_RIGHTS;
+	control_header->cmsg_len = CMSG_LEN(sizeof(int));
+
+	memcpy( CMSG_DATA(control_header), &(shm->descriptor), sizeof(int) );
+
+	do {
+		bytes_sent = sendmsg( mx_socket->socket_fd,
+					&message_header, MSG_NOSIGNAL );
+	} while ( ( bytes_sent < 0 ) && ( errno == EINTR ) );
+
+	while ( bytes_sent >= 0 ) {
+		ptr += bytes_sent;
+		bytes_left -= bytes_sent;
+
+		if ( bytes_left == 0 )
+			break;
+
+		bytes_sent = send( mx_socket->socket_fd,
+					ptr, bytes_left, MSG_NOSIGNAL );
+
+		if ( ( bytes_sent < 0 ) && ( errno == EINTR ) ) {
+			bytes_sent = 0;
+		}
+	}
+
+	saved_errno = errno;
+
+	(void) close( shm->descriptor );
+
+	shm->descriptor = -1;
+
+	if ( bytes_sent < 0 ) {
+		return mx_error( (MXE_NETWORK_IO_ERROR | MXE_QUIET), fname,
+		"Error sending the shared memory segment to socket %d.  "
+		"Errno = %d, error message = '%s'.",
+			(int) mx_socket->socket_fd,
+			saved_errno, mx_socket_strerror( saved_errno ) );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*------*/
+
+/* mx_network_shm_expect_descriptor() is called by the client before it
+ * asks for shared memory.  Until the descriptor of the segment arrives,
+ * mx_network_socket_receive_message() reads through
+ * mx_network_shm_socket_recv(), which picks it up.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_shm_expect_descriptor( MX_SOCKET *mx_socket )
+{
+	static const char fname[] = "mx_network_shm_expect_descriptor()";
+
+	MX_NETWORK_SHM *shm;
+
+	if ( mx_socket == (MX_SOCKET *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_SOCKET pointer passed was NULL." );
+	}
+
+	(void) mx_network_shm_detach( mx_socket );
+
+	shm = (MX_NETWORK_SHM *) calloc( 1, sizeof(MX_NETWORK_SHM) );
+
+	if ( shm == (MX_NETWORK_SHM *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an "
+		"MX_NETWORK_SHM structure." );
+	}
+
+	shm->descriptor = -1;
+	shm->is_sender = FALSE;
+	shm->waiting_for_descriptor = TRUE;
+	shm->base_address = NULL;
+	shm->borrowed_slot = -1;
+
+	mx_socket->shared_memory = shm;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT mx_bool_type
+mx_network_shm_wants_descriptor( MX_SOCKET *mx_socket )
+{
+	MX_NETWORK_SHM *shm;
+
+	shm = (MX_NETWORK_SHM *) mx_socket->shared_memory;
+
+	if ( ( shm == (MX_NETWORK_SHM *) NULL )
+	  || ( shm->waiting_for_descriptor == FALSE ) )
+	{
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* mx_network_shm_socket_recv() works like recv(), except that it also
+ * keeps any file descriptor sent along with the data.
+ */
+
+MX_EXPORT long
+mx_network_shm_socket_recv( MX_SOCKET *mx_socket, void *buffer, size_t length )
+{
+	MX_NETWORK_SHM *shm;
+	struct msghdr message_header;
+	struct iovec iovec_array[1];
+	struct cmsghdr *control_header;
+	union {
+		struct cmsghdr align;
+		char buffer[ CMSG_SPACE(sizeof(int)) ];
+	} control;
+	long bytes_received;
+	int received_fd;
+
+	shm = (MX_NETWORK_SHM *) mx_socket->shared_memory;
+
+	memset( &message_header, 0, sizeof(message_header) );
+
+	iovec_array[0].iov_base = buffer;
+	iovec_array[0].iov_len = length;
+
+	message_header.msg_iov = iovec_array;
+	message_header.msg_iovlen = 1;
+	message_header.msg_control = control.buffer;
+	message_header.msg_controllen = sizeof(control.buffer);
+
+	bytes_received = recvmsg( mx_socket->socket_fd,
+				&message_header, MSG_CMSG_CLOEXEC );
+
+	if ( bytes_received < 0 )
+		return bytes_received;
+
+	for ( control_header = CMSG_FIRSTHDR( &message_header );
+	      control_header != NULL;
+	      control_header = CMSG_NXTHDR( &message_header, control_header ) )
+	{
+		if ( ( control_header->cmsg_level != SOL_SOCKET )
+		  || ( control_header->cmsg_type != SCM_RIGHTS )
+		  || ( control_header->cmsg_len < CMSG_LEN(sizeof(int)) ) )
+		{
+			continue;
+		}
+
+		memcpy( &received_fd, CMSG_DATA(control_header), sizeof(int) );
+
+		if ( ( shm != (MX_NETWORK_SHM *) NULL )
+		  && ( shm->descriptor < 0 ) )
+		{
+			shm->descriptor = received_fd;
+			shm->waiting_for_descriptor = FALSE;
+		} else {
+			(void) close( received_fd );
+		}
+	}
+
+	return bytes_received;
+}
+
+/* mx_network_shm_attach() is called by the client once the server has
+ * accepted its request for shared memory.  It maps the segment whose
+ * descriptor came with the server's response.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_shm_attach( MX_SOCKET *mx_socket )
+{
+	static const char fname[] = "mx_network_shm_attach()";
+
+	MX_NETWORK_SHM *shm;
+	MXP_NETWORK_SHM_HEADER *shm_header;
+	struct stat stat_buf;
+	size_t minimum_length;
+	int os_status, seals, saved_errno;
+
+	if ( mx_socket == (MX_SOCKET *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_SOCKET pointer passed was NULL." );
+	}
+
+	shm = (MX_NETWORK_SHM *) mx_socket->shared_memory;
+
+	if ( ( shm == (MX_NETWORK_SHM *) NULL ) || shm->is_sender ) {
+		return mx_error( MXE_NOT_READY, fname,
+		"Socket %d is not waiting for a shared memory segment.",
+			(int) mx_socket->socket_fd );
+	}
+	if ( shm->descriptor < 0 ) {
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"The server did not send a shared memory segment "
+		"for socket %d.", (int) mx_socket->socket_fd );
+	}
+
+	/* The server must not be able to change the size of the segment
+	 * under us either.
+	 */
+
+	os_status = fstat( shm->descriptor, &stat_buf );
+
+	seals = fcntl( shm->descriptor, F_GET_SEALS );
+
+	if ( ( os_status != 0 )
+	  || ( stat_buf.st_size < (off_t) MXP_NETWORK_SHM_PAGE_SIZE )
+	  || ( seals < 0 )
+	  || ( ( seals & MXP_NETWORK_SHM_SEALS ) != MXP_NETWORK_SHM_SEALS ) )
+	{
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The shared memory segment sent for socket %d is not "
+		"a valid MX network segment.", (int) mx_socket->socket_fd );
+	}
+
+	shm->segment_length = (size_t) stat_buf.st_size;
+
+	shm->base_address = mmap( NULL, shm->segment_length,
+			PROT_READ | PROT_WRITE, MAP_SHARED, shm->descriptor, 0 );
+
+	if ( shm->base_address == MAP_FAILED ) {
+		saved_errno = errno;
+
+		shm->base_address = NULL;
+
+		return mx_error( MXE_OPERATING_SYSTEM_ERROR, fname,
+		"Cannot map the %lu byte shared memory segment for "
+		"socket %d.  Errno = %d, error message = '%s'.",
+			(unsigned long) shm->segment_length,
+			(int) mx_socket->socket_fd,
+			saved_errno, strerror( saved_errno ) );
+	}
+
+	(void) close( shm->descriptor );
+
+	shm->descriptor = -1;
+
+	shm_header = (MXP_NETWORK_SHM_HEADER *) shm->base_address;
+
+	minimum_length = (size_t) shm_header->data_offset
+		+ (size_t) shm_header->num_slots * shm_header->slot_size;
+
+	if ( ( shm_header->magic != MXP_NETWORK_SHM_MAGIC )
+	  || ( shm_header->num_slots == 0 )
+	  || ( shm_header->num_slots > MX_NETWORK_SHM_MAX_SLOTS )
+	  || ( shm_header->data_offset < ( sizeof(MXP_NETWORK_SHM_HEADER)
+		+ shm_header->num_slots * sizeof(int32_t) ) )
+	  || ( minimum_length > shm->segment_length ) )
+	{
+		(void) munmap( shm->base_address, shm->segment_length );
+
+		shm->base_address = NULL;
+
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The shared memory segment sent for socket %d is not "
+		"a valid MX network segment.", (int) mx_socket->socket_fd );
+	}
+
+	shm->num_slots = shm_header->num_slots;
+	shm->slot_size = shm_header->slot_size;
+	shm->threshold = shm_header->threshold;
+
+	mxp_network_shm_set_pointers( shm, shm_header->data_offset );
+
+#if MX_NET_SHM_DEBUG
+	MX_DEBUG(-2,("%s: socket %d, %lu slots of %lu bytes",
+		fname, (int) mx_socket->socket_fd,
+		shm->num_slots, shm->slot_size));
+#endif
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* mx_network_shm_release_body() hands the slot holding the body of the
+ * last GET_ARRAY response back to the sender.  It is called before each
+ * new message is received, since that is when the previous one has been
+ * decoded.
+ */
+
+MX_EXPORT void
+mx_network_shm_release_body( MX_SOCKET *mx_socket )
+{
+	MX_NETWORK_SHM *shm;
+
+	shm = (MX_NETWORK_SHM *) mx_socket->shared_memory;
+
+	if ( ( shm == (MX_NETWORK_SHM *) NULL ) || ( shm->borrowed_slot < 0 ) )
+		return;
+
+	mx_atomic_write32( &(shm->slot_in_use[ shm->borrowed_slot ]), 0 );
+
+	shm->borrowed_slot = -1;
+}
+
+/* mx_network_shm_get_body() returns where the body of a message left in
+ * a shared memory slot by mx_network_shm_receive() is and how long it is.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_shm_get_body( MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+			char **message_body,
+			uint32_t *message_length )
+{
+	static const char fname[] = "mx_network_shm_get_body()";
+
+	uint32_t *header, *body;
+	uint32_t header_length;
+
+	header = message_buffer->u.uint32_buffer;
+
+	if ( ( message_buffer->shared_memory_body == NULL )
+	  || ( ( mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] )
+			& MX_NETMSG_SHARED_MEMORY_FLAG ) == 0 ) )
+	{
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"The message in message buffer %p does not have its body "
+		"in a shared memory slot.", message_buffer );
+	}
+
+	header_length = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+
+	body = header + ( header_length / sizeof(uint32_t) );
+
+	*message_body = (char *) message_buffer->shared_memory_body;
+	*message_length = mx_ntohl( body[1] );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT mx_status_type
+mx_network_shm_detach( MX_SOCKET *mx_socket )
+{
+	MX_NETWORK_SHM *shm;
+
+	if ( mx_socket == (MX_SOCKET *) NULL )
+		return MX_SUCCESSFUL_RESULT;
+
+	shm = (MX_NETWORK_SHM *) mx_socket->shared_memory;
+
+	if ( shm == (MX_NETWORK_SHM *) NULL )
+		return MX_SUCCESSFUL_RESULT;
+
+	if ( shm->descriptor >= 0 ) {
+		(void) close( shm->descriptor );
+	}
+
+	if ( shm->base_address != NULL ) {
+		(void) munmap( shm->base_address, shm->segment_length );
+	}
+
+	mx_free( shm );
+
+	mx_socket->shared_memory = NULL;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* mx_network_shm_prepare_send() copies the body of the message into
+ * the next slot if that slot is free and the body is big enough to be
+ * worth it.  If so, 'send_ptr' and 'send_length' are changed to point
+ * at the control message that must be sent through the socket instead.
+ * The body is taken from 'message_body' if it is not NULL and from the
+ * message buffer otherwise.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_shm_prepare_send( MX_SOCKET *mx_socket,
+			MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+			void *message_body,
+			char **send_ptr,
+			unsigned long *send_length,
+			mx_bool_type *used_shared_memory )
+{
+	MX_NETWORK_SHM *shm;
+	uint32_t *header, *control_header, *control_body;
+	uint32_t header_length, message_length, message_type;
+	unsigned long slot;
+
+	*used_shared_memory = FALSE;
+
+	shm = (MX_NETWORK_SHM *) mx_socket->shared_memory;
+
+	/* Nothing may go through the segment until the client has it. */
+
+	if ( ( shm == (MX_NETWORK_SHM *) NULL ) || ( shm->is_sender == FALSE )
+	  || ( shm->descriptor >= 0 ) )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	header = message_buffer->u.uint32_buffer;
+
+	header_length  = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+	message_length = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
+	message_type   = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
+
+	if ( ( message_length < shm->threshold )
+	  || ( message_length > shm->slot_size )
+	  || ( header_length + 2 * sizeof(uint32_t)
+			> sizeof(shm->control_message) )
+	  || ( message_type & MX_NETMSG_SHARED_MEMORY_FLAG ) )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	slot = shm->next_slot;
+
+	/* If the receiver has not finished with the slot yet, send the
+	 * message through the socket rather than waiting.
+	 */
+
+	if ( mx_atomic_read32( &(shm->slot_in_use[slot]) ) != 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	if ( message_body == NULL ) {
+		message_body = message_buffer->u.char_buffer + header_length;
+	}
+
+	memcpy( shm->slot_data + slot * shm->slot_size,
+			message_body, message_length );
+
+	mx_atomic_write32( &(shm->slot_in_use[slot]), 1 );
+
+	shm->next_slot = ( slot + 1 ) % shm->num_slots;
+
+	control_header = shm->control_message;
+
+	memcpy( control_header, header, header_length );
+
+	control_header[ MX_NETWORK_MESSAGE_LENGTH ] =
+				mx_htonl( 2 * sizeof(uint32_t) );
+
+	control_header[ MX_NETWORK_MESSAGE_TYPE ] =
+			mx_htonl( message_type | MX_NETMSG_SHARED_MEMORY_FLAG );
+
+	control_body = control_header + ( header_length / sizeof(uint32_t) );
+
+	control_body[0] = mx_htonl( slot );
+	control_body[1] = mx_htonl( message_length );
+
+	*send_ptr = (char *) control_header;
+	*send_length = header_length + 2 * sizeof(uint32_t);
+
+	*used_shared_memory = TRUE;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* mx_network_shm_receive() handles a control message that has just been
+ * read into the message buffer.  The body of an uncompressed GET_ARRAY
+ * response is left in its slot for mx_get_field_array_finish() to decode,
+ * and the slot is kept until mx_network_shm_release_body() is called.
+ * For anything else, the control message is replaced with the message
+ * body from the slot, which is then handed back to the sender at once.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_shm_receive( MX_SOCKET *mx_socket,
+			MX_NETWORK_MESSAGE_BUFFER *message_buffer )
+{
+	static const char fname[] = "mx_network_shm_receive()";
+
+	MX_NETWORK_SHM *shm;
+	uint32_t *header, *body;
+	uint32_t header_length, message_length, message_type;
+	unsigned long slot, body_length;
+	mx_status_type mx_status;
+
+	shm = (MX_NETWORK_SHM *) mx_socket->shared_memory;
+
+	if ( ( shm == (MX_NETWORK_SHM *) NULL ) || shm->is_sender
+	  || ( shm->base_address == NULL ) )
+	{
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"A shared memory message was received on socket %d, "
+		"but no shared memory segment was attached to it.",
+			(int) mx_socket->socket_fd );
+	}
+
+	header = message_buffer->u.uint32_buffer;
+
+	header_length  = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+	message_length = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
+	message_type   = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
+
+	if ( message_length < 2 * sizeof(uint32_t) ) {
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"The shared memory control message received on socket %d "
+		"is too short (%lu bytes) to be valid.",
+			(int) mx_socket->socket_fd,
+			(unsigned long) message_length );
+	}
+
+	body = header + ( header_length / sizeof(uint32_t) );
+
+	slot        = mx_ntohl( body[0] );
+	body_length = mx_ntohl( body[1] );
+
+	if ( ( slot >= shm->num_slots ) || ( body_length > shm->slot_size ) ) {
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"Invalid shared memory slot %lu or length %lu was received "
+		"on socket %d.", slot, body_length,
+			(int) mx_socket->socket_fd );
+	}
+
+	switch( message_type & (~MX_NETMSG_SHARED_MEMORY_FLAG) ) {
+	case mx_server_response(MX_NETMSG_GET_ARRAY_BY_NAME):
+	case mx_server_response(MX_NETMSG_GET_ARRAY_BY_HANDLE):
+		message_buffer->shared_memory_body =
+				shm->slot_data + slot * shm->slot_size;
+
+		shm->borrowed_slot = (long) slot;
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	if ( ( header_length + body_length ) > message_buffer->buffer_length ) {
+		mx_status = mx_reallocate_network_buffer( message_buffer,
+					header_length + body_length );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		header = message_buffer->u.uint32_buffer;
+	}
+
+	memcpy( message_buffer->u.char_buffer + header_length,
+		shm->slot_data + slot * shm->slot_size, body_length );
+
+	mx_atomic_write32( &(shm->slot_in_use[slot]), 0 );
+
+	header[ MX_NETWORK_MESSAGE_LENGTH ] = mx_htonl( body_length );
+
+	header[ MX_NETWORK_MESSAGE_TYPE ] =
+		mx_htonl( message_type & (~MX_NETMSG_SHARED_MEMORY_FLAG) );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* ---------------------------------------------------------------------- */
+
+#else /* not HAVE_SEALED_MEMFD */
+
+MX_EXPORT mx_status_type
+mx_network_shm_create( MX_SOCKET *mx_socket,
+			unsigned long num_slots,
+			unsigned long slot_size,
+			unsigned long threshold )
+{
+	static const char fname[] = "mx_network_shm_create()";
+
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"Shared memory network transport is not supported "
+	"on this platform." );
+}
+
+MX_EXPORT mx_status_type
+mx_network_shm_send_descriptor( MX_SOCKET *mx_socket,
+				MX_NETWORK_MESSAGE_BUFFER *message_buffer )
+{
+	static const char fname[] = "mx_network_shm_send_descriptor()";
+
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"Shared memory network transport is not supported "
+	"on this platform." );
+}
+
+MX_EXPORT mx_status_type
+mx_network_shm_expect_descriptor( MX_SOCKET *mx_socket )
+{
+	static const char fname[] = "mx_network_shm_expect_descriptor()";
+
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"Shared memory network transport is not supported "
+	"on this platform." );
+}
+
+MX_EXPORT mx_bool_type
+mx_network_shm_wants_descriptor( MX_SOCKET *mx_socket )
+{
+	return FALSE;
+}
+
+MX_EXPORT long
+mx_network_shm_socket_recv( MX_SOCKET *mx_socket, void *buffer, size_t length )
+{
+	return recv( mx_socket->socket_fd, buffer, length, 0 );
+}
+
+MX_EXPORT mx_status_type
+mx_network_shm_attach( MX_SOCKET *mx_socket )
+{
+	static const char fname[] = "mx_network_shm_attach()";
+
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"Shared memory network transport is not supported "
+	"on this platform." );
+}
+
+MX_EXPORT void
+mx_network_shm_release_body( MX_SOCKET *mx_socket )
+{
+	return;
+}
+
+MX_EXPORT mx_status_type
+mx_network_shm_get_body( MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+			char **message_body,
+			uint32_t *message_length )
+{
+	static const char fname[] = "mx_network_shm_get_body()";
+
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"Shared memory network transport is not supported "
+	"on this platform." );
+}
+
+MX_EXPORT mx_status_type
+mx_network_shm_detach( MX_SOCKET *mx_socket )
+{
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT mx_status_type
+mx_network_shm_prepare_send( MX_SOCKET *mx_socket,
+			MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+			void *message_body,
+			char **send_ptr,
+			unsigned long *send_length,
+			mx_bool_type *used_shared_memory )
+{
+	*used_shared_memory = FALSE;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT mx_status_type
+mx_network_shm_receive( MX_SOCKET *mx_socket,
+			MX_NETWORK_MESSAGE_BUFFER *message_buffer )
+{
+	static const char fname[] = "mx_network_shm_receive()";
+
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"A shared memory message was received on socket %d, but "
+	"shared memory is not supported on this platform.",
+		(int) mx_socket->socket_fd );
+}
+
+#endif /* HAVE_SEALED_MEMFD */
+
@@ -0,0 +1,142 @@
+/*
+ * Name:    mx_net_shm.h
+ *
+ * Purpose: Shared memory transport for the bodies of large MX network
+ *          messages sent between processes on the same host.
+ *
+ *----------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#ifndef __MX_NET_SHM_H__
+#define __MX_NET_SHM_H__
+
+/* Make the header file C++ safe. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A client connected through a Unix domain socket asks for shared memory
+ * with the network option MX_NETWORK_OPTION_SHARED_MEMORY.  The server
+ * then creates a segment containing a ring of message slots and passes
+ * its file descriptor to the client along with the response to the
+ * option.  After that, the server copies the bodies of large messages
+ * into the next free slot and only sends a short control message through
+ * the socket.  The control message has the flag MX_NETMSG_SHARED_MEMORY_FLAG
+ * set and its body contains the slot number and the length of the real
+ * message body.  If no slot is free or the body does not fit in a slot,
+ * the message is sent through the socket as usual.
+ *
+ * The server writes to the segment, so it owns it.  The segment is a
+ * memfd sealed against changes of size before it is passed on, so that
+ * a client cannot shrink it under the server and make it crash with
+ * SIGBUS.  Where sealed memfds are not available, the option is refused
+ * and the connection keeps using the socket alone.
+ *
+ * The server still copies each message body into a slot, but the client
+ * does not copy the bodies of GET_ARRAY responses back out.  Instead,
+ * mx_network_shm_receive() leaves the control message in the message
+ * buffer and points 'shared_memory_body' at the slot, so that the array
+ * is decoded straight from the segment.  The slot is handed back to the
+ * server when the next message is received on the socket.  Other message
+ * types are copied into the message buffer as before.
+ */
+
+#define MXU_NETWORK_SHM_CONTROL_WORDS	32
+
+typedef struct {
+	int descriptor;
+	mx_bool_type is_sender;
+	mx_bool_type waiting_for_descriptor;
+
+	void *base_address;
+	size_t segment_length;
+
+	int32_t *slot_in_use;
+	unsigned char *slot_data;
+
+	unsigned long num_slots;
+	unsigned long slot_size;
+	unsigned long threshold;
+
+	unsigned long next_slot;
+	long borrowed_slot;
+
+	uint32_t control_message[ MXU_NETWORK_SHM_CONTROL_WORDS ];
+} MX_NETWORK_SHM;
+
+#define MX_NETWORK_SHM_DEFAULT_NUM_SLOTS	4
+#define MX_NETWORK_SHM_DEFAULT_SLOT_SIZE	( 16 * 1024 * 1024 )
+#define MX_NETWORK_SHM_DEFAULT_THRESHOLD	65536
+
+/* The value of MX_NETWORK_OPTION_SHARED_MEMORY holds the number of slots
+ * in its low 8 bits and the slot size in units of 64 kB above that.
+ */
+
+#define MX_NETWORK_SHM_MAX_SLOTS		255
+#define MX_NETWORK_SHM_SLOT_SIZE_UNIT		65536
+
+#define mx_network_shm_option_value( num_slots, slot_size ) \
+	( ( ( (slot_size) / MX_NETWORK_SHM_SLOT_SIZE_UNIT ) << 8 ) \
+		| ( (num_slots) & 0xff ) )
+
+#define mx_network_shm_option_num_slots( value )	( (value) & 0xff )
+
+#define mx_network_shm_option_slot_size( value ) \
+	( ( (value) >> 8 ) * MX_NETWORK_SHM_SLOT_SIZE_UNIT )
+
+/* These are used by the server. */
+
+MX_API mx_status_type mx_network_shm_create( MX_SOCKET *mx_socket,
+					unsigned long num_slots,
+					unsigned long slot_size,
+					unsigned long threshold );
+
+MX_API mx_status_type mx_network_shm_send_descriptor( MX_SOCKET *mx_socket,
+				MX_NETWORK_MESSAGE_BUFFER *message_buffer );
+
+/* These are used by the client. */
+
+MX_API mx_status_type mx_network_shm_expect_descriptor(
+					MX_SOCKET *mx_socket );
+
+MX_API mx_bool_type mx_network_shm_wants_descriptor( MX_SOCKET *mx_socket );
+
+MX_API long mx_network_shm_socket_recv( MX_SOCKET *mx_socket,
+					void *buffer, size_t length );
+
+MX_API mx_status_type mx_network_shm_attach( MX_SOCKET *mx_socket );
+
+MX_API void mx_network_shm_release_body( MX_SOCKET *mx_socket );
+
+MX_API mx_status_type mx_network_shm_get_body(
+				MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+				char **message_body,
+				uint32_t *message_length );
+
+/* These are used by both. */
+
+MX_API mx_status_type mx_network_shm_detach( MX_SOCKET *mx_socket );
+
+MX_API mx_status_type mx_network_shm_prepare_send( MX_SOCKET *mx_socket,
+				MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+				void *message_body,
+				char **send_ptr,
+				unsigned long *send_length,
+				mx_bool_type *used_shared_memory );
+
+MX_API mx_status_type mx_network_shm_receive( MX_SOCKET *mx_socket,
+				MX_NETWORK_MESSAGE_BUFFER *message_buffer );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MX_NET_SHM_H__ */
+
@@ -28,8 +28,13 @@
 #if HAVE_TCPIP
 
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 
+#if HAVE_READV_WRITEV
+#include <sys/uio.h>
+#endif
+
 #include "mx_util.h"
 #include "mx_record.h"
 #include "mx_stdint.h"
@@ -37,13 +42,385 @@
 #include "mx_socket.h"
 #include "mx_net.h"
 #include "mx_net_socket.h"
+#include "mx_net_shm.h"
 #include "mx_process.h"
 #include "mx_debugger.h"
 
+#if defined( MX_HAVE_ZLIB )
+#include <zlib.h>
+#endif
+
 #if MX_NET_SOCKET_DEBUG_TOTAL_PERFORMANCE || MX_NET_SOCKET_DEBUG_IO_PERFORMANCE
 #include "mx_hrt_debug.h"
 #endif
 
+/* ---------------------------------------------------------------------- */
+
+/* Message compression.
+ *
+ * A compressed message body consists of the uncompressed body length,
+ * a word with the codec in the low byte and the byte shuffle element
+ * size in the next byte, and then the zlib compressed data.  The shuffle
+ * filter groups together the first bytes of every element, then the
+ * second bytes and so on, which makes slowly varying 16-bit and 32-bit
+ * pixel data compress much better.
+ */
+
+#define MXP_COMPRESSED_PREFIX_LENGTH	( 2 * sizeof(uint32_t) )
+
+/* The uncompressed length in a received message comes from the peer, so
+ * it is checked against the largest expansion that zlib can produce
+ * (about 1032 to 1) and against the largest message that can be
+ * described by the 32-bit length in the message header.
+ */
+
+#define MXP_MAXIMUM_COMPRESSION_RATIO		1032
+#define MXP_MAXIMUM_UNCOMPRESSED_LENGTH		( (size_t) INT32_MAX )
+
+#if defined( MX_HAVE_ZLIB )
+
+static size_t
+mxp_network_shuffle_element_size( long datatype )
+{
+	switch( datatype ) {
+	case MXFT_SHORT:
+	case MXFT_USHORT:
+	case MXFT_INT16:
+	case MXFT_UINT16:
+		return 2;
+	case MXFT_INT32:
+	case MXFT_UINT32:
+	case MXFT_FLOAT:
+		return 4;
+	case MXFT_INT64:
+	case MXFT_UINT64:
+	case MXFT_DOUBLE:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+static void
+mxp_network_shuffle( unsigned char *dest, unsigned char *src,
+			size_t num_bytes, size_t element_size )
+{
+	size_t i, b, num_elements;
+
+	num_elements = num_bytes / element_size;
+
+	for ( b = 0; b < element_size; b++ ) {
+		for ( i = 0; i < num_elements; i++ ) {
+			dest[ b * num_elements + i ] =
+					src[ i * element_size + b ];
+		}
+	}
+}
+
+static void
+mxp_network_unshuffle( unsigned char *dest, unsigned char *src,
+			size_t num_bytes, size_t element_size )
+{
+	size_t i, b, num_elements;
+
+	num_elements = num_bytes / element_size;
+
+	for ( b = 0; b < element_size; b++ ) {
+		for ( i = 0; i < num_elements; i++ ) {
+			dest[ i * element_size + b ] =
+					src[ b * num_elements + i ];
+		}
+	}
+}
+
+static mx_status_type
+mxp_network_reserve_compression_buffer( MX_SOCKET *mx_socket,
+					size_t length )
+{
+	static const char fname[] = "mxp_network_reserve_compression_buffer()";
+
+	void *new_buffer;
+
+	if ( length <= mx_socket->compression_buffer_length )
+		return MX_SUCCESSFUL_RESULT;
+
+	new_buffer = realloc( mx_socket->compression_buffer, length );
+
+	if ( new_buffer == NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %lu byte "
+		"compression buffer for socket %d.",
+			(unsigned long) length, (int) mx_socket->socket_fd );
+	}
+
+	mx_socket->compression_buffer = new_buffer;
+	mx_socket->compression_buffer_length = length;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* mxp_network_compress_message() compresses the body of the message into
+ * the socket's compression buffer.  If that makes the message shorter,
+ * 'send_ptr' and 'send_length' are changed to point at the compressed
+ * message.  Otherwise, they are left alone.
+ */
+
+static mx_status_type
+mxp_network_compress_message( MX_SOCKET *mx_socket,
+				MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+				char **send_ptr,
+				int *send_length )
+{
+	static const char fname[] = "mxp_network_compress_message()";
+
+	uint32_t *header, *compressed_header;
+	unsigned char *body, *source, *compressed_body;
+	uint32_t header_length, message_length, message_type;
+	size_t shuffle_size, needed_length;
+	uLongf compressed_length;
+	int z_status;
+	mx_status_type mx_status;
+
+	header = message_buffer->u.uint32_buffer;
+
+	header_length  = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+	message_length = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
+	message_type   = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
+
+	if ( message_type & MX_NETMSG_COMPRESSED_FLAG )
+		return MX_SUCCESSFUL_RESULT;
+
+	shuffle_size = 0;
+
+	if ( ( mx_socket->compression & MX_NETWORK_COMPRESSION_SHUFFLE )
+	  && ( header_length > MX_NETWORK_DATA_TYPE * sizeof(uint32_t) ) )
+	{
+		shuffle_size = mxp_network_shuffle_element_size(
+				(long) mx_ntohl( header[MX_NETWORK_DATA_TYPE] ) );
+
+		if ( ( shuffle_size != 0 )
+		  && ( ( message_length % shuffle_size ) != 0 ) )
+		{
+			shuffle_size = 0;
+		}
+	}
+
+	compressed_length = compressBound( message_length );
+
+	needed_length = header_length + MXP_COMPRESSED_PREFIX_LENGTH
+							+ compressed_length;
+
+	if ( shuffle_size != 0 ) {
+		needed_length += message_length;
+	}
+
+	mx_status = mxp_network_reserve_compression_buffer( mx_socket,
+							needed_length );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	body = (unsigned char *) message_buffer->u.char_buffer + header_length;
+
+	compressed_header = (uint32_t *) mx_socket->compression_buffer;
+
+	compressed_body = (unsigned char *) mx_socket->compression_buffer
+			+ header_length + MXP_COMPRESSED_PREFIX_LENGTH;
+
+	if ( shuffle_size == 0 ) {
+		source = body;
+	} else {
+		source = compressed_body + compressed_length;
+
+		mxp_network_shuffle( source, body,
+					message_length, shuffle_size );
+	}
+
+	z_status = compress2( compressed_body, &compressed_length,
+				source, message_length, 1 );
+
+	if ( z_status != Z_OK ) {
+		return mx_error( MXE_FUNCTION_FAILED, fname,
+		"zlib compression of a %lu byte message for socket %d failed "
+		"with status %d.", (unsigned long) message_length,
+			(int) mx_socket->socket_fd, z_status );
+	}
+
+	/* Send the original message if compression did not help. */
+
+	if ( ( compressed_length + MXP_COMPRESSED_PREFIX_LENGTH )
+						>= message_length )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	memcpy( compressed_header, header, header_length );
+
+	compressed_header[ MX_NETWORK_MESSAGE_LENGTH ] = mx_htonl(
+		compressed_length + MXP_COMPRESSED_PREFIX_LENGTH );
+
+	compressed_header[ MX_NETWORK_MESSAGE_TYPE ] = mx_htonl(
+		message_type | MX_NETMSG_COMPRESSED_FLAG );
+
+	compressed_header[ header_length / sizeof(uint32_t) ]
+				= mx_htonl( message_length );
+
+	compressed_header[ 1 + header_length / sizeof(uint32_t) ]
+		= mx_htonl( MX_NETWORK_COMPRESSION_ZLIB | (shuffle_size << 8) );
+
+	*send_ptr = (char *) mx_socket->compression_buffer;
+
+	*send_length = (int) ( header_length + MXP_COMPRESSED_PREFIX_LENGTH
+						+ compressed_length );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+#endif /* MX_HAVE_ZLIB */
+
+/* mxp_network_decompress_message() replaces a compressed message that
+ * has just been received with its uncompressed form.
+ */
+
+static mx_status_type
+mxp_network_decompress_message( MX_SOCKET *mx_socket,
+				MX_NETWORK_MESSAGE_BUFFER *message_buffer )
+{
+	static const char fname[] = "mxp_network_decompress_message()";
+
+#if !defined( MX_HAVE_ZLIB )
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"A compressed message was received on socket %d, but this copy "
+	"of MX was built without zlib.", (int) mx_socket->socket_fd );
+#else
+	uint32_t *header, *body;
+	uint32_t header_length, message_length, message_type;
+	uint32_t uncompressed_length, codec_info;
+	size_t shuffle_size, compressed_length, needed_length;
+	unsigned char *compressed_data, *destination;
+	uLongf destination_length;
+	int z_status;
+	mx_status_type mx_status;
+
+	header = message_buffer->u.uint32_buffer;
+
+	header_length  = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+	message_length = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
+	message_type   = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
+
+	if ( mx_socket->accept_compressed_messages == FALSE ) {
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"A compressed message was received on socket %d, but "
+		"compression was not negotiated for that connection.",
+			(int) mx_socket->socket_fd );
+	}
+
+	if ( message_length < MXP_COMPRESSED_PREFIX_LENGTH ) {
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"The compressed message received on socket %d is too short "
+		"(%lu bytes) to be valid.", (int) mx_socket->socket_fd,
+			(unsigned long) message_length );
+	}
+
+	body = header + ( header_length / sizeof(uint32_t) );
+
+	uncompressed_length = mx_ntohl( body[0] );
+	codec_info          = mx_ntohl( body[1] );
+
+	shuffle_size = ( codec_info >> 8 ) & 0xff;
+
+	if ( ( codec_info & 0xff ) != MX_NETWORK_COMPRESSION_ZLIB ) {
+		return mx_error( MXE_UNSUPPORTED, fname,
+		"Unsupported compression codec %#lx was used for a message "
+		"received on socket %d.", (unsigned long) codec_info,
+			(int) mx_socket->socket_fd );
+	}
+
+	compressed_length = message_length - MXP_COMPRESSED_PREFIX_LENGTH;
+
+	if ( ( (size_t) uncompressed_length
+		> ( MXP_MAXIMUM_UNCOMPRESSED_LENGTH - (size_t) header_length ) )
+	  || ( (size_t) uncompressed_length
+		> ( compressed_length * MXP_MAXIMUM_COMPRESSION_RATIO ) ) )
+	{
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"The uncompressed length %lu of a %lu byte compressed message "
+		"received on socket %d is not valid.",
+			(unsigned long) uncompressed_length,
+			(unsigned long) compressed_length,
+			(int) mx_socket->socket_fd );
+	}
+
+	/* Move the compressed data out of the way, since the message
+	 * buffer will be overwritten by the uncompressed data.
+	 */
+
+	needed_length = compressed_length;
+
+	if ( shuffle_size != 0 ) {
+		needed_length += uncompressed_length;
+	}
+
+	mx_status = mxp_network_reserve_compression_buffer( mx_socket,
+							needed_length );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	compressed_data = (unsigned char *) mx_socket->compression_buffer;
+
+	memcpy( compressed_data, body + 2, compressed_length );
+
+	if ( ( (size_t) header_length + (size_t) uncompressed_length )
+			> message_buffer->buffer_length )
+	{
+		mx_status = mx_reallocate_network_buffer( message_buffer,
+		    (size_t) header_length + (size_t) uncompressed_length );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		header = message_buffer->u.uint32_buffer;
+	}
+
+	if ( shuffle_size == 0 ) {
+		destination = (unsigned char *) message_buffer->u.char_buffer
+							+ header_length;
+	} else {
+		destination = compressed_data + compressed_length;
+	}
+
+	destination_length = uncompressed_length;
+
+	z_status = uncompress( destination, &destination_length,
+				compressed_data, compressed_length );
+
+	if ( ( z_status != Z_OK )
+	  || ( destination_length != uncompressed_length ) )
+	{
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"Decompression of a message received on socket %d failed "
+		"with zlib status %d.", (int) mx_socket->socket_fd, z_status );
+	}
+
+	if ( shuffle_size != 0 ) {
+		mxp_network_unshuffle(
+			(unsigned char *) message_buffer->u.char_buffer
+							+ header_length,
+			destination, uncompressed_length, shuffle_size );
+	}
+
+	header[ MX_NETWORK_MESSAGE_LENGTH ] = mx_htonl( uncompressed_length );
+
+	header[ MX_NETWORK_MESSAGE_TYPE ] =
+			mx_htonl( message_type & (~MX_NETMSG_COMPRESSED_FLAG) );
+
+	return MX_SUCCESSFUL_RESULT;
+#endif /* MX_HAVE_ZLIB */
+}
+
+/* ---------------------------------------------------------------------- */
+
 MX_EXPORT mx_status_type
 mx_network_socket_receive_message( MX_SOCKET *mx_socket,
 				double timeout,
@@ -90,6 +467,12 @@ mx_network_socket_receive_message( MX_SOCKET *mx_socket,
 			(long) MXU_NETWORK_HEADER_LENGTH + 1L );
 	}
 
+	/* The previous message has been dealt with by now, so if its body
+	 * was left in a shared memory slot, the slot can be reused.
+	 */
+
+	mx_network_shm_release_body( mx_socket );
+
 	header = message_buffer->u.uint32_buffer;
 
 	/* Overwrite the header, just to make sure nothing is left over
@@ -144,7 +527,13 @@ mx_network_socket_receive_message( MX_SOCKET *mx_socket,
 		n++;
 		MX_HRT_START( io_measurement );
 #endif
-		bytes_received = recv(mx_socket->socket_fd, ptr, bytes_left, 0);
+		if ( mx_network_shm_wants_descriptor( mx_socket ) ) {
+			bytes_received = (int) mx_network_shm_socket_recv(
+					mx_socket, ptr, bytes_left );
+		} else {
+			bytes_received = recv( mx_socket->socket_fd,
+						ptr, bytes_left, 0 );
+		}
 
 #if MX_NET_SOCKET_DEBUG_IO_PERFORMANCE
 		MX_HRT_END( io_measurement );
@@ -290,7 +679,13 @@ mx_network_socket_receive_message( MX_SOCKET *mx_socket,
 		n++;
 		MX_HRT_START( io_measurement );
 #endif
-		bytes_received = recv(mx_socket->socket_fd, ptr, bytes_left, 0);
+		if ( mx_network_shm_wants_descriptor( mx_socket ) ) {
+			bytes_received = (int) mx_network_shm_socket_recv(
+					mx_socket, ptr, bytes_left );
+		} else {
+			bytes_received = recv( mx_socket->socket_fd,
+						ptr, bytes_left, 0 );
+		}
 
 #if MX_NET_SOCKET_DEBUG_IO_PERFORMANCE
 		MX_HRT_END( io_measurement );
@@ -379,6 +774,27 @@ mx_network_socket_receive_message( MX_SOCKET *mx_socket,
 	MX_HRT_RESULTS( total_measurement, fname, "Total duration" );
 #endif
 
+	if ( mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] )
+				& MX_NETMSG_SHARED_MEMORY_FLAG )
+	{
+		mx_status = mx_network_shm_receive( mx_socket, message_buffer );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		header = message_buffer->u.uint32_buffer;
+	}
+
+	if ( mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] )
+				& MX_NETMSG_COMPRESSED_FLAG )
+	{
+		mx_status = mxp_network_decompress_message( mx_socket,
+							message_buffer );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
 #if MX_NET_SOCKET_DEBUG_MESSAGES
 	MX_DEBUG(-2,("%s: Received message from socket %d <--",
 		fname, mx_socket->socket_fd ));
@@ -404,6 +820,8 @@ mx_network_socket_send_message( MX_SOCKET *mx_socket,
 	MX_CLOCK_TICK timeout_interval, current_time, timeout_time;
 	int bytes_left, bytes_sent;
 	uint32_t magic_value, header_length, message_length;
+	unsigned long shm_send_length;
+	mx_bool_type used_shared_memory;
 	mx_status_type mx_status;
 
 #if MX_NET_SOCKET_DEBUG_TOTAL_PERFORMANCE
@@ -448,6 +866,47 @@ mx_network_socket_send_message( MX_SOCKET *mx_socket,
 
 	bytes_left = header_length + message_length;
 
+	/* Large message bodies for a client on the same host may be passed
+	 * through shared memory instead of the socket.
+	 */
+
+	mx_status = mx_network_shm_prepare_send( mx_socket, message_buffer,
+				NULL, &ptr, &shm_send_length, &used_shared_memory );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( used_shared_memory ) {
+		bytes_left = (int) shm_send_length;
+	}
+
+#if defined( MX_HAVE_ZLIB )
+	if ( ( used_shared_memory == FALSE )
+	  && ( mx_socket->compression != MX_NETWORK_COMPRESSION_NONE )
+	  && ( message_length >= mx_socket->compression_threshold ) )
+	{
+		mx_status = mxp_network_compress_message( mx_socket,
+					message_buffer, &ptr, &bytes_left );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+#endif
+
+	if ( mx_socket->send_hook != NULL ) {
+		char *segment_ptr[2];
+		size_t segment_length[2];
+
+		segment_ptr[0] = ptr;
+		segment_length[0] = bytes_left;
+
+		segment_ptr[1] = NULL;
+		segment_length[1] = 0;
+
+		return (mx_socket->send_hook)( mx_socket,
+					segment_ptr, segment_length );
+	}
+
 #if 0
         {
                 long i;                                   
@@ -621,6 +1080,197 @@ mx_network_socket_send_message( MX_SOCKET *mx_socket,
 	return MX_SUCCESSFUL_RESULT;
 }
 
+/*
+ * mx_network_socket_send_message_with_data() sends a message whose body
+ * is not in the message buffer.  Only the header is taken from the message
+ * buffer, while the MX_NETWORK_MESSAGE_LENGTH bytes of the body are taken
+ * directly from 'data'.  This lets the server send large RAW arrays from
+ * the record field storage without first copying them into the message
+ * buffer.  Where writev() is available, the header and the body are
+ * handed to the kernel in a single system call.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_socket_send_message_with_data( MX_SOCKET *mx_socket,
+				double timeout,
+				MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+				void *data )
+{
+	static const char fname[] =
+			"mx_network_socket_send_message_with_data()";
+
+	uint32_t *header;
+	char *segment_ptr[2];
+	size_t segment_left[2];
+	int segment, saved_errno, comparison;
+	mx_bool_type is_non_blocking, no_timeout;
+	MX_CLOCK_TICK timeout_interval, current_time, timeout_time;
+	long bytes_sent;
+	size_t bytes_consumed;
+	uint32_t header_length, message_length;
+	unsigned long shm_send_length;
+	mx_bool_type used_shared_memory;
+	mx_status_type mx_status;
+
+#if HAVE_READV_WRITEV
+	struct iovec iovec_array[2];
+	int num_iovecs;
+#endif
+
+	if ( mx_socket == (MX_SOCKET *) NULL ) {
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"The MX_SOCKET pointer passed was NULL." );
+	}
+	if ( message_buffer == NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_MESSAGE_BUFFER pointer passed was NULL." );
+	}
+
+	header = message_buffer->u.uint32_buffer;
+
+	header_length  = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+	message_length = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
+
+	if ( ( data == NULL ) && ( message_length > 0 ) ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The data pointer passed was NULL." );
+	}
+
+	segment_ptr[0]  = message_buffer->u.char_buffer;
+	segment_left[0] = header_length;
+
+	segment_ptr[1]  = (char *) data;
+	segment_left[1] = message_length;
+
+	mx_status = mx_network_shm_prepare_send( mx_socket, message_buffer,
+			data, &(segment_ptr[0]), &shm_send_length,
+			&used_shared_memory );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( used_shared_memory ) {
+		segment_left[0] = shm_send_length;
+		segment_left[1] = 0;
+	}
+
+	if ( mx_socket->send_hook != NULL ) {
+		return (mx_socket->send_hook)( mx_socket,
+					segment_ptr, segment_left );
+	}
+
+	mx_status = mx_socket_get_non_blocking_mode( mx_socket,
+							&is_non_blocking );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( timeout < 0.0 ) {
+		no_timeout = TRUE;
+	} else {
+		no_timeout = FALSE;
+
+		timeout_interval = mx_convert_seconds_to_clock_ticks( timeout );
+
+		current_time = mx_current_clock_tick();
+
+		timeout_time = mx_add_clock_ticks( current_time,
+							timeout_interval );
+	}
+
+	segment = 0;
+
+	while ( segment < 2 ) {
+
+		if ( segment_left[segment] == 0 ) {
+			segment++;
+			continue;
+		}
+
+#if HAVE_READV_WRITEV
+		num_iovecs = 0;
+
+		for ( ; num_iovecs < (2 - segment); num_iovecs++ ) {
+			iovec_array[num_iovecs].iov_base =
+					segment_ptr[segment + num_iovecs];
+			iovec_array[num_iovecs].iov_len =
+					segment_left[segment + num_iovecs];
+		}
+
+		bytes_sent = writev( mx_socket->socket_fd,
+					iovec_array, num_iovecs );
+#else
+		bytes_sent = send( mx_socket->socket_fd, segment_ptr[segment],
+					(int) segment_left[segment], 0 );
+#endif
+
+		if ( bytes_sent >= 0 ) {
+			bytes_consumed = (size_t) bytes_sent;
+
+			while ( ( bytes_consumed > 0 ) && ( segment < 2 ) ) {
+				if ( bytes_consumed < segment_left[segment] ) {
+					segment_ptr[segment] += bytes_consumed;
+					segment_left[segment] -= bytes_consumed;
+					bytes_consumed = 0;
+				} else {
+					bytes_consumed -= segment_left[segment];
+					segment_left[segment] = 0;
+					segment++;
+				}
+			}
+			continue;
+		}
+
+		saved_errno = mx_socket_get_last_error();
+
+		switch( saved_errno ) {
+		case ECONNRESET:
+		case ECONNABORTED:
+		case EPIPE:
+			return mx_error(
+			(MXE_NETWORK_CONNECTION_LOST | MXE_QUIET), fname,
+			"Connection lost.  Errno = %d, error text = '%s'",
+				saved_errno, mx_socket_strerror(saved_errno) );
+			break;
+
+		case EINTR:
+			continue;
+
+		case EAGAIN:
+
+#if ( EAGAIN != EWOULDBLOCK )
+		case EWOULDBLOCK:
+#endif
+			if ( no_timeout ) {
+				continue;
+			}
+
+			current_time = mx_current_clock_tick();
+
+			comparison = mx_compare_clock_ticks(
+					current_time, timeout_time );
+
+			if ( comparison < 0 ) {
+				continue;
+			} else {
+				return mx_error( (MXE_TIMED_OUT | MXE_QUIET), fname,
+				"Timed out after waiting %g seconds to "
+				"write to MX network socket %d.",
+					timeout, (int) mx_socket->socket_fd );
+			}
+			break;
+		default:
+			return mx_error( (MXE_NETWORK_IO_ERROR | MXE_QUIET), fname,
+			"Error sending to remote host.  "
+			"Errno = %d, error text = '%s'",
+				saved_errno, mx_socket_strerror(saved_errno) );
+			break;
+		}
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
 MX_EXPORT mx_status_type
 mx_network_socket_send_error_message( MX_SOCKET *mx_socket,
 			uint32_t message_id,
@@ -73,6 +73,16 @@
 #  define HAVE_UNIX_DOMAIN_SOCKETS	0
 #endif
 
+/* Can we make sealed shared memory files with memfd_create()?  This
+ * also needs glibc 2.27 or above, which mx_net_shm.c checks for itself.
+ */
+
+#if defined( OS_LINUX )
+#  define HAVE_SEALED_MEMFD		1
+#else
+#  define HAVE_SEALED_MEMFD		0
+#endif
+
 /* Do we have a version of FIONREAD that supports sockets? */
 
 #if defined( OS_LINUX ) || defined( OS_MACOSX ) || defined( OS_SOLARIS ) \
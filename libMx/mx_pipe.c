@@ -494,6 +494,16 @@ mx_pipe_set_blocking_mode( MX_PIPE *mx_pipe,
 	return MX_SUCCESSFUL_RESULT;
 }
 
+MX_EXPORT mx_status_type
+mx_pipe_get_read_fd( MX_PIPE *mx_pipe, int *read_fd )
+{
+	static const char fname[] = "mx_pipe_get_read_fd()";
+
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"MX pipes do not have a selectable read file descriptor "
+	"on this operating system." );
+}
+
 /************************ Unix ***********************/
 
 #elif defined(OS_UNIX) || defined(OS_CYGWIN) || defined(OS_VMS) \
@@ -941,6 +951,31 @@ mx_pipe_set_blocking_mode( MX_PIPE *mx_pipe,
 	return MX_SUCCESSFUL_RESULT;
 }
 
+MX_EXPORT mx_status_type
+mx_pipe_get_read_fd( MX_PIPE *mx_pipe, int *read_fd )
+{
+	static const char fname[] = "mx_pipe_get_read_fd()";
+
+	MX_UNIX_PIPE *unix_pipe;
+	mx_status_type mx_status;
+
+	unix_pipe = NULL;
+
+	if ( read_fd == (int *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The read_fd pointer passed was NULL." );
+	}
+
+	mx_status = mx_pipe_get_pointers( mx_pipe, &unix_pipe, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	*read_fd = unix_pipe->read_fd;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
 /************************ VxWorks ***********************/
 
 #elif defined(OS_VXWORKS)
@@ -1230,6 +1265,16 @@ mx_pipe_set_blocking_mode( MX_PIPE *mx_pipe,
 	return MX_SUCCESSFUL_RESULT;
 }
 
+MX_EXPORT mx_status_type
+mx_pipe_get_read_fd( MX_PIPE *mx_pipe, int *read_fd )
+{
+	static const char fname[] = "mx_pipe_get_read_fd()";
+
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"MX pipes do not have a selectable read file descriptor "
+	"on this operating system." );
+}
+
 /************************ Not supported ***********************/
 
 #elif defined(OS_ECOS) || defined(OS_RTEMS)
@@ -1296,6 +1341,16 @@ mx_pipe_set_blocking_mode( MX_PIPE *mx_pipe,
 	"Pipes are not supported for this operating system." );
 }
 
+MX_EXPORT mx_status_type
+mx_pipe_get_read_fd( MX_PIPE *mx_pipe, int *read_fd )
+{
+	static const char fname[] = "mx_pipe_get_read_fd()";
+
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"MX pipes do not have a selectable read file descriptor "
+	"on this operating system." );
+}
+
 /************************ Not yet implemented ***********************/
 
 #else
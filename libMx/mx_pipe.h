@@ -52,6 +52,14 @@ MX_API mx_status_type mx_pipe_set_blocking_mode( MX_PIPE *mx_pipe,
 					int flags,
 					mx_bool_type blocking_mode_flag );
 
+/* mx_pipe_get_read_fd() returns the file descriptor of the read end of
+ * the pipe, so that it can be waited on by select(), poll(), or epoll()
+ * together with other descriptors.  It is only supported on platforms
+ * where MX pipes are implemented with real file descriptors.
+ */
+
+MX_API mx_status_type mx_pipe_get_read_fd( MX_PIPE *mx_pipe, int *read_fd );
+
 #ifdef __cplusplus
 }
 #endif
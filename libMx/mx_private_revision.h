@@ -0,0 +1,2 @@
+#define MX_REVISION_STRING "unknown"
+#define MX_REVISION_NUMBER 0
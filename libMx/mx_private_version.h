@@ -0,0 +1,29 @@
+/*
+ * Name:    mx_private_version.h
+ *
+ * Purpose: Macro definitions for the version of MX and the versions
+ *          of other software used by MX.
+ *
+ * WARNING: This file is MACHINE GENERATED.  Do not edit it!
+ */
+
+#ifndef __MX_PRIVATE_VERSION_H__
+#define __MX_PRIVATE_VERSION_H__
+
+#define MX_VERSION     2002000L
+
+#define MX_MAJOR_VERSION    2
+#define MX_MINOR_VERSION    2
+#define MX_UPDATE_VERSION   0
+
+#define MX_BRANCH_LABEL "trunk"
+
+#define MX_GNUC_VERSION    12002000L
+
+#define MX_GLIBC_VERSION   2036000L
+
+
+#define MX_HAVE_ZLIB   1
+
+#endif /* __MX_PRIVATE_VERSION_H__ */
+
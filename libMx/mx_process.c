@@ -25,6 +25,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #if !defined(OS_WIN32) && !defined(OS_ECOS)
@@ -38,6 +39,7 @@
 #include "mx_net.h"
 #include "mx_callback.h"
 #include "mx_clock_tick.h"
+#include "mx_array.h"
 #include "mx_hrt_debug.h"
 
 #include "mx_process.h"
@@ -515,26 +517,8 @@ mx_test_for_value_changed( MX_RECORD_FIELD *record_field,
 
 		mx_status = (*vc_test_fn)( record_field,
 					direction, value_changed_ptr );
-	} else
-	if ( (record_field->datatype == MXFT_STRING)
-	  || (record_field->num_dimensions >= 2) )
-	{
-		/* FIXME: For strings or multidimensional arrays,
-		 * we treat PUT operations as if they _always_
-		 * change the value.  This is oversimplistic.
-		 */
-
-		if ( direction == MX_PROCESS_PUT ) {
-			*value_changed_ptr = TRUE;
-		} else {
-			*value_changed_ptr = FALSE;
-		}
-
-		mx_status = MX_SUCCESSFUL_RESULT;
 	} else {
-		/* For 0-d and 1-d arrays that are not strings, we invoke
-		 * the default value changed test.
-		 */
+		/* Otherwise, invoke the default value changed test. */
 
 		mx_status = mx_default_test_for_value_changed( record_field,
 							direction,
@@ -563,6 +547,451 @@ mx_test_for_value_changed( MX_RECORD_FIELD *record_field,
 
 /*--------------------------------------------------------------------------*/
 
+/* The default value changed test keeps a 64-bit hash of the raw contents
+ * of the field, which is compared with the hash of the current contents.
+ * This works for fields of any datatype and dimension and detects every
+ * change, including elements that trade places or changes that would
+ * cancel out in a sum.
+ *
+ * Numeric fields with a positive value_change_threshold instead use
+ * a per-element deadband.  The field is reported as changed when any
+ * element differs by more than the threshold from its value the last time
+ * that a change was reported.  For 0-d fields the last reported value is
+ * kept in 'last_value'.  For arrays, a copy of the array is kept in
+ * 'last_value_snapshot'.
+ */
+
+#define MXP_HASH_PRIME1		0x9E3779B185EBCA87ULL
+#define MXP_HASH_PRIME2		0xC2B2AE3D27D4EB4FULL
+#define MXP_HASH_PRIME3		0x165667B19E3779F9ULL
+#define MXP_HASH_PRIME4		0x85EBCA77C2B2AE63ULL
+#define MXP_HASH_PRIME5		0x27D4EB2F165667C5ULL
+
+#define MXP_HASH_ROTATE(x,r)	( ( (x) << (r) ) | ( (x) >> ( 64 - (r) ) ) )
+
+static uint64_t
+mxp_hash_round( uint64_t accumulator, uint64_t input )
+{
+	accumulator += input * MXP_HASH_PRIME2;
+	accumulator = MXP_HASH_ROTATE( accumulator, 31 );
+	accumulator *= MXP_HASH_PRIME1;
+
+	return accumulator;
+}
+
+static uint64_t
+mxp_hash_merge( uint64_t hash, uint64_t accumulator )
+{
+	hash ^= mxp_hash_round( 0, accumulator );
+	hash = hash * MXP_HASH_PRIME1 + MXP_HASH_PRIME4;
+
+	return hash;
+}
+
+static uint64_t
+mxp_hash_read64( const unsigned char *ptr )
+{
+	uint64_t value;
+
+	memcpy( &value, ptr, sizeof(value) );
+
+	return value;
+}
+
+/* mxp_hash_bytes() is the 64-bit xxHash function.  The input is consumed
+ * 32 bytes at a time by four independent accumulators, so that the
+ * multiplies for the four lanes can be executed in parallel.  The byte
+ * order of the words is not normalized, since the hash is never compared
+ * between different computers.
+ */
+
+static uint64_t
+mxp_hash_bytes( const void *data, size_t length, uint64_t seed )
+{
+	const unsigned char *ptr, *end, *limit;
+	uint64_t v1, v2, v3, v4, hash;
+	uint32_t word32;
+
+	ptr = (const unsigned char *) data;
+	end = ptr + length;
+
+	if ( length >= 32 ) {
+		limit = end - 32;
+
+		v1 = seed + MXP_HASH_PRIME1 + MXP_HASH_PRIME2;
+		v2 = seed + MXP_HASH_PRIME2;
+		v3 = seed;
+		v4 = seed - MXP_HASH_PRIME1;
+
+		do {
+			v1 = mxp_hash_round( v1, mxp_hash_read64( ptr ) );
+			v2 = mxp_hash_round( v2, mxp_hash_read64( ptr + 8 ) );
+			v3 = mxp_hash_round( v3, mxp_hash_read64( ptr + 16 ) );
+			v4 = mxp_hash_round( v4, mxp_hash_read64( ptr + 24 ) );
+
+			ptr += 32;
+		} while ( ptr <= limit );
+
+		hash = MXP_HASH_ROTATE( v1, 1 ) + MXP_HASH_ROTATE( v2, 7 )
+			+ MXP_HASH_ROTATE( v3, 12 ) + MXP_HASH_ROTATE( v4, 18 );
+
+		hash = mxp_hash_merge( hash, v1 );
+		hash = mxp_hash_merge( hash, v2 );
+		hash = mxp_hash_merge( hash, v3 );
+		hash = mxp_hash_merge( hash, v4 );
+	} else {
+		hash = seed + MXP_HASH_PRIME5;
+	}
+
+	hash += (uint64_t) length;
+
+	while ( ( ptr + 8 ) <= end ) {
+		hash ^= mxp_hash_round( 0, mxp_hash_read64( ptr ) );
+		hash = MXP_HASH_ROTATE( hash, 27 ) * MXP_HASH_PRIME1
+							+ MXP_HASH_PRIME4;
+		ptr += 8;
+	}
+
+	if ( ( ptr + 4 ) <= end ) {
+		memcpy( &word32, ptr, sizeof(word32) );
+
+		hash ^= (uint64_t) word32 * MXP_HASH_PRIME1;
+		hash = MXP_HASH_ROTATE( hash, 23 ) * MXP_HASH_PRIME2
+							+ MXP_HASH_PRIME3;
+		ptr += 4;
+	}
+
+	while ( ptr < end ) {
+		hash ^= (*ptr) * MXP_HASH_PRIME5;
+		hash = MXP_HASH_ROTATE( hash, 11 ) * MXP_HASH_PRIME1;
+		ptr++;
+	}
+
+	hash ^= hash >> 33;
+	hash *= MXP_HASH_PRIME2;
+	hash ^= hash >> 29;
+	hash *= MXP_HASH_PRIME3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+
+typedef struct {
+	MX_RECORD_FIELD *field;
+	size_t row_length;		/* In bytes. */
+
+	uint64_t hash;
+	size_t num_bytes;
+
+	/* The following are only used by the deadband test. */
+
+	char *snapshot;
+	size_t element_size;
+	double threshold;
+	mx_bool_type copy_to_snapshot;
+	mx_bool_type value_changed;
+} MXP_VALUE_CHANGED_STATE;
+
+static size_t
+mxp_value_changed_element_size( MX_RECORD_FIELD *field )
+{
+	if ( ( field->data_element_size != NULL )
+	  && ( field->data_element_size[0] > 0 ) )
+	{
+		return field->data_element_size[0];
+	}
+
+	/* 0-d fields do not always fill in data_element_size[0]. */
+
+	switch( field->datatype ) {
+	case MXFT_STRING:
+	case MXFT_CHAR:
+	case MXFT_UCHAR:
+	case MXFT_INT8:
+	case MXFT_UINT8:
+		return 1;
+	case MXFT_SHORT:
+	case MXFT_USHORT:
+		return sizeof(short);
+	case MXFT_INT16:
+	case MXFT_UINT16:
+		return 2;
+	case MXFT_BOOL:
+		return sizeof(mx_bool_type);
+	case MXFT_INT32:
+	case MXFT_UINT32:
+		return 4;
+	case MXFT_LONG:
+	case MXFT_ULONG:
+	case MXFT_HEX:
+		return sizeof(long);
+	case MXFT_INT64:
+	case MXFT_UINT64:
+		return 8;
+	case MXFT_FLOAT:
+		return sizeof(float);
+	case MXFT_DOUBLE:
+		return sizeof(double);
+	case MXFT_RECORD:
+	case MXFT_RECORDTYPE:
+	case MXFT_INTERFACE:
+	case MXFT_RECORD_FIELD:
+		return sizeof(void *);
+	default:
+		return 0;
+	}
+}
+
+/* mxp_value_changed_read_element() returns the value of an element
+ * of a numeric field as a double.
+ */
+
+static mx_bool_type
+mxp_value_changed_is_numeric( long datatype )
+{
+	switch( datatype ) {
+	case MXFT_CHAR:
+	case MXFT_UCHAR:
+	case MXFT_INT8:
+	case MXFT_UINT8:
+	case MXFT_SHORT:
+	case MXFT_USHORT:
+	case MXFT_INT16:
+	case MXFT_UINT16:
+	case MXFT_BOOL:
+	case MXFT_INT32:
+	case MXFT_UINT32:
+	case MXFT_LONG:
+	case MXFT_ULONG:
+	case MXFT_HEX:
+	case MXFT_INT64:
+	case MXFT_UINT64:
+	case MXFT_FLOAT:
+	case MXFT_DOUBLE:
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
+static double
+mxp_value_changed_read_element( long datatype, const char *element_ptr )
+{
+	double value;
+
+	switch( datatype ) {
+	case MXFT_CHAR:
+		value = *((const char *) element_ptr);
+		break;
+	case MXFT_UCHAR:
+		value = *((const unsigned char *) element_ptr);
+		break;
+	case MXFT_INT8:
+		value = *((const int8_t *) element_ptr);
+		break;
+	case MXFT_UINT8:
+		value = *((const uint8_t *) element_ptr);
+		break;
+	case MXFT_SHORT:
+		value = *((const short *) element_ptr);
+		break;
+	case MXFT_USHORT:
+		value = *((const unsigned short *) element_ptr);
+		break;
+	case MXFT_INT16:
+		value = *((const int16_t *) element_ptr);
+		break;
+	case MXFT_UINT16:
+		value = *((const uint16_t *) element_ptr);
+		break;
+	case MXFT_BOOL:
+		value = *((const mx_bool_type *) element_ptr);
+		break;
+	case MXFT_INT32:
+		value = *((const int32_t *) element_ptr);
+		break;
+	case MXFT_UINT32:
+		value = *((const uint32_t *) element_ptr);
+		break;
+	case MXFT_LONG:
+		value = *((const long *) element_ptr);
+		break;
+	case MXFT_ULONG:
+	case MXFT_HEX:
+		value = *((const unsigned long *) element_ptr);
+		break;
+	case MXFT_INT64:
+		value = (double) *((const int64_t *) element_ptr);
+		break;
+	case MXFT_UINT64:
+		value = (double) *((const uint64_t *) element_ptr);
+		break;
+	case MXFT_FLOAT:
+		value = *((const float *) element_ptr);
+		break;
+	case MXFT_DOUBLE:
+		value = *((const double *) element_ptr);
+		break;
+	default:
+		value = 0.0;
+		break;
+	}
+
+	return value;
+}
+
+/* A change into or out of NaN always counts. */
+
+static mx_bool_type
+mxp_value_changed_exceeds( double new_value,
+			double old_value,
+			double threshold )
+{
+	if ( ( fabs( new_value - old_value ) > threshold )
+	  || ( ( new_value != new_value ) != ( old_value != old_value ) ) )
+	{
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+static void
+mxp_value_changed_row( MXP_VALUE_CHANGED_STATE *state, char *row_ptr )
+{
+	const double *double_row, *double_snapshot;
+	const char *null_ptr, *snapshot_ptr;
+	double new_value, old_value;
+	size_t i, num_elements, string_length;
+
+	if ( state->snapshot == NULL ) {
+		if ( state->field->datatype == MXFT_STRING ) {
+
+			/* Only the characters before the terminating
+			 * null byte are part of the value of a string.
+			 */
+
+			null_ptr = memchr( row_ptr, '\0', state->row_length );
+
+			if ( null_ptr == NULL ) {
+				string_length = state->row_length;
+			} else {
+				string_length = null_ptr - row_ptr;
+			}
+
+			state->hash = mxp_hash_bytes( row_ptr,
+						string_length, state->hash );
+		} else {
+			state->hash = mxp_hash_bytes( row_ptr,
+					state->row_length, state->hash );
+		}
+	} else
+	if ( state->copy_to_snapshot ) {
+		memcpy( state->snapshot + state->num_bytes,
+				row_ptr, state->row_length );
+	} else
+	if ( state->value_changed == FALSE ) {
+		snapshot_ptr = state->snapshot + state->num_bytes;
+
+		num_elements = state->row_length / state->element_size;
+
+		/* Double arrays, such as MCA spectra, are by far the most
+		 * common, so they get their own loop.
+		 */
+
+		if ( state->field->datatype == MXFT_DOUBLE ) {
+			double_row = (const double *) row_ptr;
+			double_snapshot = (const double *) snapshot_ptr;
+
+			for ( i = 0; i < num_elements; i++ ) {
+				if ( mxp_value_changed_exceeds( double_row[i],
+					double_snapshot[i], state->threshold ) )
+				{
+					state->value_changed = TRUE;
+					break;
+				}
+			}
+		} else {
+			for ( i = 0; i < num_elements; i++ ) {
+				new_value = mxp_value_changed_read_element(
+					state->field->datatype,
+					row_ptr + i * state->element_size );
+
+				old_value = mxp_value_changed_read_element(
+					state->field->datatype,
+				    snapshot_ptr + i * state->element_size );
+
+				if ( mxp_value_changed_exceeds( new_value,
+					old_value, state->threshold ) )
+				{
+					state->value_changed = TRUE;
+					break;
+				}
+			}
+		}
+	}
+
+	state->num_bytes += state->row_length;
+}
+
+/* mxp_value_changed_walk() visits the rows of the last dimension of an
+ * array field in order.  As in mx_database_cache.c, the subarrays of an
+ * MXFF_VARARGS field are reached through arrays of pointers, while other
+ * fields are contiguous C arrays.
+ */
+
+static void
+mxp_value_changed_walk( MXP_VALUE_CHANGED_STATE *state,
+			char *array_ptr,
+			long dimension_level )
+{
+	MX_RECORD_FIELD *field;
+	char *row_ptr, *subarray_ptr;
+	size_t step_size;
+	long i, num_elements;
+
+	if ( array_ptr == NULL )
+		return;
+
+	if ( dimension_level <= 0 ) {
+		mxp_value_changed_row( state, array_ptr );
+		return;
+	}
+
+	field = state->field;
+
+	num_elements = field->dimension[ field->num_dimensions
+						- dimension_level - 1 ];
+
+	if ( field->flags & MXFF_VARARGS ) {
+		step_size = field->data_element_size[ dimension_level ];
+	} else {
+		step_size = state->row_length;
+
+		for ( i = field->num_dimensions - 2;
+		    i >= ( field->num_dimensions - dimension_level ); i-- )
+		{
+			step_size *= field->dimension[i];
+		}
+	}
+
+	row_ptr = array_ptr;
+
+	for ( i = 0; i < num_elements; i++ ) {
+		if ( field->flags & MXFF_VARARGS ) {
+			subarray_ptr =
+			    mx_read_void_pointer_from_memory_location( row_ptr );
+		} else {
+			subarray_ptr = row_ptr;
+		}
+
+		mxp_value_changed_walk( state, subarray_ptr,
+					dimension_level - 1 );
+
+		row_ptr += step_size;
+	}
+}
+
 MX_EXPORT mx_status_type
 mx_default_test_for_value_changed( MX_RECORD_FIELD *record_field,
 				int direction,
@@ -570,28 +999,13 @@ mx_default_test_for_value_changed( MX_RECORD_FIELD *record_field,
 {
 	static const char fname[] = "mx_default_test_for_value_changed()";
 
+	MXP_VALUE_CHANGED_STATE state;
 	void *array_ptr;
-	char *char_array;
-	unsigned char *uchar_array;
-	int8_t *int8_array;
-	uint8_t *uint8_array;
-	short *short_array;
-	unsigned short *ushort_array;
-	int16_t *int16_array;
-	uint16_t *uint16_array;
-	mx_bool_type *bool_array;
-	int32_t *int32_array;
-	uint32_t *uint32_array;
-	long *long_array;
-	unsigned long *ulong_array;
-	float *float_array;
-	double *double_array;
-	int64_t *int64_array;
-	uint64_t *uint64_array;
-
-	double sum, new_value, difference, threshold;
-	unsigned long i, num_elements;
-	mx_bool_type value_changed;
+	char *new_snapshot;
+	size_t element_size, snapshot_length;
+	long i, dimension_level;
+	double new_value, threshold;
+	mx_bool_type use_deadband;
 
 	if ( record_field == (MX_RECORD_FIELD *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
@@ -608,212 +1022,165 @@ mx_default_test_for_value_changed( MX_RECORD_FIELD *record_field,
 		fname, record_field->num_dimensions));
 #endif
 
-	value_changed = FALSE;
-	new_value = record_field->last_value;
+	*value_changed_ptr = FALSE;
 
-	/* FIXME: Only invoke callbacks for fields for 1-d or 0-d arrays. */
+	array_ptr = mx_get_field_value_pointer(record_field);
 
-	if ( record_field->num_dimensions < 2 ) {
+	element_size = mxp_value_changed_element_size( record_field );
 
-		if ( record_field->num_dimensions == 0 ) {
-			num_elements = 1;
-		} else {
-			num_elements = record_field->dimension[0];
+	if ( ( array_ptr == NULL ) || ( element_size == 0 ) ) {
+		/* If there _is_ no value pointer, then just declare
+		 * that the field value has not changed.
+		 */
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	for ( i = 0; i < record_field->num_dimensions; i++ ) {
+		if ( record_field->dimension[i] <= 0 ) {
+			/* An empty array cannot change. */
+
+			return MX_SUCCESSFUL_RESULT;
 		}
+	}
+
+	threshold = record_field->value_change_threshold;
+
+	use_deadband = FALSE;
+
+	if ( ( threshold > 0.0 )
+	  && mxp_value_changed_is_numeric( record_field->datatype ) )
+	{
+		use_deadband = TRUE;
+	}
+
+	/* 0-d fields with a deadband compare against 'last_value'. */
+
+	if ( use_deadband && ( record_field->num_dimensions == 0 ) ) {
+		new_value = mxp_value_changed_read_element(
+				record_field->datatype, array_ptr );
 
 #if PROCESS_DEBUG_VALUE_CHANGED
-		MX_DEBUG(-2,("%s: num_elements = %ld", fname, num_elements));
+		MX_DEBUG(-2,("%s: last_value = %g, new_value = %g",
+			fname, record_field->last_value, new_value));
+		MX_DEBUG(-2,("%s: difference = %g, threshold = %g",
+			fname, fabs( new_value - record_field->last_value ),
+			threshold));
 #endif
 
-		array_ptr = mx_get_field_value_pointer(record_field);
+		if ( mxp_value_changed_exceeds( new_value,
+				record_field->last_value, threshold ) )
+		{
+			*value_changed_ptr = TRUE;
 
-#if 0
-		if ( array_ptr == NULL ) {
-			return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-			"The field value pointer for field '%s.%s' is NULL.",
-				record_field->record->name,
-				record_field->name );
-		}
-#else
-		if ( array_ptr == NULL ) {
-			/* If there _is_ no value pointer, then just declare
-			 * that the field value has not changed.
+			/* Only update 'last_value' if we
+			 * have tripped the value changed
+			 * threshold.
 			 */
 
-			*value_changed_ptr = FALSE;
-
-			return MX_SUCCESSFUL_RESULT;
+			record_field->last_value = new_value;
 		}
-#endif
 
-		sum = 0.0;
+		return MX_SUCCESSFUL_RESULT;
+	}
 
-		switch( record_field->datatype ) {
-		case MXFT_CHAR:
-			char_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += char_array[i];
-			}
-			break;
-		case MXFT_UCHAR:
-			uchar_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += uchar_array[i];
-			}
-			break;
-		case MXFT_INT8:
-			int8_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += int8_array[i];
-			}
-			break;
-		case MXFT_UINT8:
-			uint8_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += uint8_array[i];
-			}
-			break;
-		case MXFT_SHORT:
-			short_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += short_array[i];
-			}
-			break;
-		case MXFT_USHORT:
-			ushort_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += ushort_array[i];
-			}
-			break;
-		case MXFT_INT16:
-			int16_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += int16_array[i];
-			}
-			break;
-		case MXFT_UINT16:
-			uint16_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += uint16_array[i];
-			}
-			break;
-		case MXFT_BOOL:
-			bool_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += bool_array[i];
-			}
-			break;
-		case MXFT_INT32:
-			int32_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += int32_array[i];
-			}
-			break;
-		case MXFT_UINT32:
-			uint32_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += uint32_array[i];
-			}
-			break;
-		case MXFT_LONG:
-			long_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += long_array[i];
-			}
-			break;
-		case MXFT_ULONG:
-		case MXFT_HEX:
-			ulong_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += ulong_array[i];
-			}
-			break;
-		case MXFT_FLOAT:
-			float_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += float_array[i];
-			}
-			break;
-		case MXFT_DOUBLE:
-			double_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += double_array[i];
-			}
-			break;
-		case MXFT_INT64:
-			int64_array = array_ptr;
-			
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += int64_array[i];
-			}
-			break;
-		case MXFT_UINT64:
-			uint64_array = array_ptr;
-			
-#if ( defined(_MSC_VER) && (_MSC_VER < 1300) )
-			/* For Visual C++ 6.0 SP6 and before */
+	memset( &state, 0, sizeof(state) );
 
-			for ( i = 0; i < num_elements; i++ ) {
-				double double_temp;
+	state.field = record_field;
+	state.element_size = element_size;
+	state.threshold = threshold;
 
-				double_temp =
-					mx_uint64_to_double( uint64_array[i] );
+	/* Work out the length of a row.  Contiguous arrays other than
+	 * string arrays are handled as one long row.
+	 */
 
-				sum += double_temp;
-			}
-#else
-			/* For everyone else. */
+	if ( record_field->num_dimensions == 0 ) {
+		state.row_length = element_size;
+		dimension_level = 0;
+	} else
+	if ( ( ( record_field->flags & MXFF_VARARGS ) == 0 )
+	  && ( record_field->datatype != MXFT_STRING ) )
+	{
+		state.row_length = element_size;
 
-			for ( i = 0; i < num_elements; i++ ) {
-				sum += uint64_array[i];
-			}
-#endif
-			break;
-		default:
-			break;
+		for ( i = 0; i < record_field->num_dimensions; i++ ) {
+			state.row_length *= record_field->dimension[i];
 		}
 
-		new_value = mx_divide_safely( sum, num_elements );
+		dimension_level = 0;
+	} else {
+		state.row_length = element_size * record_field->dimension[
+					record_field->num_dimensions - 1 ];
+
+		dimension_level = record_field->num_dimensions - 1;
+	}
 
-		difference = fabs( new_value - record_field->last_value );
+	if ( use_deadband == FALSE ) {
+		state.hash = 0;
 
-		threshold = record_field->value_change_threshold;
+		mxp_value_changed_walk( &state, array_ptr, dimension_level );
 
 #if PROCESS_DEBUG_VALUE_CHANGED
-		MX_DEBUG(-2,("%s: last_value = %g, new_value = %g",
-			fname, record_field->last_value, new_value));
-		MX_DEBUG(-2,("%s: difference = %g, threshold = %g",
-			fname, difference, threshold));
+		MX_DEBUG(-2,("%s: last_value_hash = %#llx, new hash = %#llx",
+			fname, (unsigned long long) record_field->last_value_hash,
+			(unsigned long long) state.hash));
 #endif
 
-		if ( difference > threshold ) {
-			value_changed = TRUE;
+		if ( state.hash != record_field->last_value_hash ) {
+			*value_changed_ptr = TRUE;
 
-			/* Only update 'last_value' if we
-			 * have tripped the value changed
-			 * threshold.
-			 */
+			record_field->last_value_hash = state.hash;
+		}
 
-			record_field->last_value = new_value;
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	/* Arrays with a deadband are compared element by element with
+	 * the snapshot taken the last time that a change was reported.
+	 * If the size of the array has changed, then so has its value.
+	 */
+
+	snapshot_length = element_size;
+
+	for ( i = 0; i < record_field->num_dimensions; i++ ) {
+		snapshot_length *= record_field->dimension[i];
+	}
+
+	if ( ( record_field->last_value_snapshot != NULL )
+	  && ( record_field->last_value_snapshot_length == snapshot_length ) )
+	{
+		state.snapshot = record_field->last_value_snapshot;
+
+		mxp_value_changed_walk( &state, array_ptr, dimension_level );
+
+		if ( state.value_changed == FALSE )
+			return MX_SUCCESSFUL_RESULT;
+	} else {
+		new_snapshot = (char *) realloc(
+				record_field->last_value_snapshot,
+				snapshot_length );
+
+		if ( new_snapshot == (char *) NULL ) {
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate a %lu byte "
+			"snapshot of field '%s'.",
+				(unsigned long) snapshot_length,
+				record_field->name );
 		}
+
+		record_field->last_value_snapshot = new_snapshot;
+		record_field->last_value_snapshot_length = snapshot_length;
 	}
 
-	*value_changed_ptr = value_changed;
+	*value_changed_ptr = TRUE;
+
+	/* Save the values that we are reporting as the new snapshot. */
+
+	state.snapshot = record_field->last_value_snapshot;
+	state.copy_to_snapshot = TRUE;
+	state.num_bytes = 0;
+
+	mxp_value_changed_walk( &state, array_ptr, dimension_level );
 
 	return MX_SUCCESSFUL_RESULT;
 }
@@ -49,6 +49,18 @@ extern "C" {
 #define MXF_SRV_MULTIPLEXER_POLL	2
 #define MXF_SRV_MULTIPLEXER_EPOLL	3
 
+/* Values for the 'client_queue_overflow_policy' field in MX_LIST_HEAD.
+ * They say what the server does when a client falls so far behind that
+ * its outbound queue would exceed 'max_client_queue_bytes' or
+ * 'max_client_queue_messages'.  DEFER holds back new callback messages,
+ * keeping only the newest one for each callback, until the queue has
+ * drained.  Responses to client requests are still queued.  DISCONNECT
+ * closes the connection to the client.
+ */
+
+#define MXF_SRV_QUEUE_OVERFLOW_DEFER		0
+#define MXF_SRV_QUEUE_OVERFLOW_DISCONNECT	1
+
 /*----*/
 
 struct mx_no_auth {
@@ -83,6 +95,45 @@ typedef struct mx_socket_handler_type {
 	uint64_t      remote_mx_version_time;
 	mx_bool_type short_error_codes;
 
+	/* Client messages are assembled in 'receive_buffer' rather than
+	 * in 'message_buffer', since callback messages for this client
+	 * may be sent through 'message_buffer' before the rest of the
+	 * message arrives.  When a message is complete, the two buffers
+	 * are swapped.
+	 */
+
+	MX_NETWORK_MESSAGE_BUFFER *receive_buffer;
+
+	/* Number of bytes of a partially received client message that
+	 * are already in 'receive_buffer'.  The server assembles client
+	 * messages incrementally, so that a slow client cannot stall
+	 * the server while the rest of its message is in transit.
+	 */
+
+	size_t receive_bytes_so_far;
+
+	/* Set while a server worker thread owns the message buffer that
+	 * holds this client's request.  The handler is not watched for
+	 * input until the worker has sent its response.
+	 */
+
+	mx_bool_type worker_job_pending;
+
+	/* When a request is handed to a worker, the request's buffer goes
+	 * with it and 'spare_buffer' takes its place as 'message_buffer'
+	 * for callback messages.  The worker's buffer becomes the spare
+	 * again when the job is finished.
+	 */
+
+	MX_NETWORK_MESSAGE_BUFFER *spare_buffer;
+
+	/* Messages that could not be sent to the client without blocking
+	 * are kept in this MXSRV_OUTBOUND_QUEUE until the client has read
+	 * the ones in front of them.
+	 */
+
+	void *outbound_queue;
+
 	long authentication_type;
 	union {
 		struct mx_no_auth none;
@@ -100,12 +151,37 @@ typedef struct {
 	int handler_array_size;
 	MX_SOCKET_HANDLER **array;
 	fd_set select_readfds;
+
+	/* 'select_writefds' only contains the sockets of clients that
+	 * have messages waiting in their outbound queues.
+	 */
+
+	fd_set select_writefds;
+
+	/* The following are used by the epoll() multiplexer.
+	 * 'epoll_fd_array' is indexed by file descriptor rather than
+	 * by handler array index, so that the socket handler for an
+	 * event can be found directly from the descriptor returned by
+	 * epoll_wait().  If 'epoll_callback_queue_fd' is not negative,
+	 * then the wakeup descriptor of the callback queue is in the
+	 * epoll set and callbacks are dispatched from the multiplexer.  In the
+	 * same way, 'epoll_master_timer_fd' is the file descriptor of
+	 * a virtual timer master timer that is run by the multiplexer.
+	 */
+
 	int epoll_fd;
+	int epoll_fd_array_size;
+	MX_SOCKET_HANDLER **epoll_fd_array;
+	int epoll_callback_queue_fd;
+	int epoll_master_timer_fd;
+	long wait_timeout_ms;
 } MX_SOCKET_HANDLER_LIST;
 
 /* Define values for the 'event_type' member of MX_QUEUED_EVENT. */
 
 #define MXQ_NETWORK_MESSAGE	1
+#define MXQ_POLL_CALLBACK	2
+#define MXQ_BATCH_PART		3
 
 struct mx_queued_event_type {
 	MX_SOCKET_HANDLER *socket_handler;
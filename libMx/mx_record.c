@@ -44,6 +44,12 @@
 #include "mx_cfn.h"
 #include "mx_export.h"
 #include "mx_module.h"
+#include "mx_hash_table.h"
+#include "mx_hrt.h"
+#include "mx_thread.h"
+#include "mx_mutex.h"
+#include "mx_arena.h"
+#include "mx_database_cache.h"
 
 /* === Private function definitions === */
 
@@ -57,6 +63,17 @@ static mx_status_type mx_delete_placeholder_handler( MX_RECORD *record,
 					void *array_ptr,
 					long dimension_level );
 
+static void mx_record_name_index_discard( MX_LIST_HEAD *list_head );
+
+static void mx_record_name_index_remove( MX_LIST_HEAD *list_head,
+					MX_RECORD *record );
+
+static void mx_initialize_record_structure( MX_RECORD *record );
+
+static mx_status_type mx_open_hardware_in_parallel( MX_RECORD *record_list,
+					unsigned long inithw_flags,
+					unsigned long num_open_threads );
+
 /* === */
 
 MX_EXPORT long
@@ -176,51 +193,154 @@ mx_create_record( void )
 		(void) mx_error( MXE_OUT_OF_MEMORY, fname,
 		"Memory allocation failed trying to allocate a new record.");
 	} else {
-		/* Initialize all the non-list related fields. */
-
-		new_record->mx_superclass = 0;
-		new_record->mx_class = 0;
-		new_record->mx_type = 0;
-		new_record->name[0] = '\0';
-		new_record->label[0] = '\0';
-		new_record->handle = MX_ILLEGAL_HANDLE;
-		new_record->precision = 3;
-		new_record->resynchronize = 0;
-		new_record->record_flags = MXF_REC_ENABLED;
-		new_record->record_processing_flags = 0;
-		new_record->record_superclass_struct = NULL;
-		new_record->record_class_struct = NULL;
-		new_record->record_type_struct = NULL;
-		new_record->record_function_list = NULL;
-		new_record->superclass_specific_function_list = NULL;
-		new_record->class_specific_function_list = NULL;
-		new_record->num_record_fields = 0;
-		new_record->record_field_array = NULL;
-		new_record->allocated_by = NULL;
-		new_record->num_parent_records = 0;
-		new_record->parent_record_array = NULL;
-		new_record->num_child_records = 0;
-		new_record->child_record_array = NULL;
-		new_record->network_type_name[0] = '\0';
-		new_record->event_time_manager = NULL;
-		new_record->event_queue = NULL;
-		new_record->application_ptr = NULL;
-		new_record->application_destructor = NULL;
-		new_record->application_destructor_args = NULL;
-
-		new_record->previous_record = NULL;
-		new_record->next_record = NULL;
-		new_record->list_head = NULL;
-
-		new_record->network_type_name[0] = '\0';
-
-		new_record->script_type = MXSO_NONE;
-		new_record->script_type_name[0] = '\0';
-		new_record->script_object = NULL;
+		mx_initialize_record_structure( new_record );
+	}
+	return new_record;
+}
+
+static void
+mx_initialize_record_structure( MX_RECORD *record )
+{
+	/* Initialize all the non-list related fields. */
+
+	record->mx_superclass = 0;
+	record->mx_class = 0;
+	record->mx_type = 0;
+	record->name[0] = '\0';
+	record->label[0] = '\0';
+	record->handle = MX_ILLEGAL_HANDLE;
+	record->precision = 3;
+	record->resynchronize = 0;
+	record->record_flags = MXF_REC_ENABLED;
+	record->record_processing_flags = 0;
+	record->record_superclass_struct = NULL;
+	record->record_class_struct = NULL;
+	record->record_type_struct = NULL;
+	record->record_function_list = NULL;
+	record->superclass_specific_function_list = NULL;
+	record->class_specific_function_list = NULL;
+	record->num_record_fields = 0;
+	record->record_field_array = NULL;
+	record->field_name_index = NULL;
+	record->allocated_by = NULL;
+	record->num_parent_records = 0;
+	record->parent_record_array = NULL;
+	record->num_child_records = 0;
+	record->child_record_array = NULL;
+	record->network_type_name[0] = '\0';
+	record->event_time_manager = NULL;
+	record->event_queue = NULL;
+	record->application_ptr = NULL;
+	record->application_destructor = NULL;
+	record->application_destructor_args = NULL;
+
+	record->previous_record = NULL;
+	record->next_record = NULL;
+	record->list_head = NULL;
+
+	record->network_type_name[0] = '\0';
+
+	record->script_type = MXSO_NONE;
+	record->script_type_name[0] = '\0';
+	record->script_object = NULL;
+}
+
+/* mx_create_record_in_list() allocates a new record together with its
+ * record field array from the record arena of 'record_list'.  If the
+ * record list does not have an arena, they are allocated separately.
+ * The new record is not inserted into the list.
+ */
+
+MX_EXPORT MX_RECORD *
+mx_create_record_in_list( MX_RECORD *record_list, long num_record_fields )
+{
+	static const char fname[] = "mx_create_record_in_list()";
+
+	MX_LIST_HEAD *list_head;
+	MX_RECORD *new_record;
+	size_t record_size;
+
+	list_head = mx_get_record_list_head_struct( record_list );
+
+	if ( ( list_head == (MX_LIST_HEAD *) NULL )
+	  || ( list_head->record_arena == NULL ) )
+	{
+		new_record = mx_create_record();
+
+		if ( ( new_record == (MX_RECORD *) NULL )
+		  || ( num_record_fields <= 0 ) )
+		{
+			return new_record;
+		}
+
+		new_record->record_field_array = (MX_RECORD_FIELD *)
+			malloc( num_record_fields * sizeof(MX_RECORD_FIELD) );
+
+		if ( new_record->record_field_array == NULL ) {
+			(void) mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory allocating a %ld element "
+			"record field array.", num_record_fields );
+
+			mx_free( new_record );
+		}
+
+		return new_record;
+	}
+
+	/* Round up so that the record field array is suitably aligned. */
+
+	record_size = ( ( sizeof(MX_RECORD) + sizeof(double) - 1 )
+				/ sizeof(double) ) * sizeof(double);
+
+	if ( num_record_fields < 0 ) {
+		num_record_fields = 0;
 	}
+
+	new_record = (MX_RECORD *) mx_arena_allocate( list_head->record_arena,
+		record_size + num_record_fields * sizeof(MX_RECORD_FIELD) );
+
+	if ( new_record == (MX_RECORD *) NULL ) {
+		(void) mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Memory allocation failed trying to allocate a new record "
+		"with %ld record fields.", num_record_fields );
+
+		return NULL;
+	}
+
+	mx_initialize_record_structure( new_record );
+
+	if ( num_record_fields > 0 ) {
+		new_record->record_field_array = (MX_RECORD_FIELD *)
+					( (char *) new_record + record_size );
+	}
+
 	return new_record;
 }
 
+/* mx_free_record_structure() frees an MX_RECORD structure that was
+ * created by mx_create_record() or mx_create_record_in_list().
+ */
+
+MX_EXPORT void
+mx_free_record_structure( MX_LIST_HEAD *list_head, MX_RECORD *record )
+{
+	if ( record == (MX_RECORD *) NULL )
+		return;
+
+	if ( ( list_head != (MX_LIST_HEAD *) NULL )
+	  && mx_arena_contains( list_head->record_arena, record ) )
+	{
+		/* The memory is kept by the arena for the next record
+		 * of the same size.
+		 */
+
+		mx_arena_free( list_head->record_arena, record );
+		return;
+	}
+
+	mx_free( record );
+}
+
 MX_EXPORT mx_status_type
 mx_delete_record( MX_RECORD *record )
 {
@@ -367,6 +487,15 @@ mx_delete_record( MX_RECORD *record )
 		 */
 	}
 
+	/* Free the snapshots kept by the value changed test. */
+
+	if ( record->record_field_array != (MX_RECORD_FIELD *) NULL ) {
+		for ( i = 0; i < record->num_record_fields; i++ ) {
+			mx_free(
+			    record->record_field_array[i].last_value_snapshot );
+		}
+	}
+
 	/* Find the type specific 'delete record' function to delete the
 	 * type specific parts of the record.  If anything goes wrong in
 	 * this processing, continue anyway.
@@ -398,11 +527,21 @@ mx_delete_record( MX_RECORD *record )
 
 	MX_DEBUG( 8,("%s: About to free record '%s'", fname, record->name));
 
+	/* Remove the record from the record name index.  If this is
+	 * the list head record itself, the index goes away with it.
+	 */
+
+	if ( record == list_head_struct->record ) {
+		mx_record_name_index_discard( list_head_struct );
+	} else {
+		mx_record_name_index_remove( list_head_struct, record );
+	}
+
 	/* Now get rid of the MX_RECORD structure itself. */
 
 	*(record->name) = '\0';   /* Erase the name */
 
-	mx_free( record );
+	mx_free_record_structure( list_head_struct, record );
 
 	MX_DEBUG( 8,("%s is complete.", fname));
 
@@ -576,6 +715,154 @@ mx_delete_placeholder_handler( MX_RECORD *record,
 	return MX_SUCCESSFUL_RESULT;
 }
 
+/* The record name index is an MX_HASH_TABLE hung off of the MX_LIST_HEAD.
+ * It is kept in step with the record list by mx_insert_after_record(),
+ * mx_delete_record() and mx_rename_record().  If an update of the index
+ * ever fails, the index is thrown away and mx_get_record() goes back to
+ * walking the record list, so a lookup never returns a wrong answer.
+ */
+
+/* The table grows as records are added, so this is only a starting size. */
+
+#define MX_RECORD_NAME_INDEX_SIZE	1024
+
+static void
+mx_record_name_index_discard( MX_LIST_HEAD *list_head )
+{
+	MX_HASH_TABLE *record_name_index;
+
+	record_name_index = (MX_HASH_TABLE *) list_head->record_name_index;
+
+	if ( record_name_index != (MX_HASH_TABLE *) NULL ) {
+		list_head->record_name_index = NULL;
+
+		mx_hash_table_destroy( record_name_index );
+	}
+}
+
+static void
+mx_record_name_index_add( MX_LIST_HEAD *list_head, MX_RECORD *record )
+{
+	MX_HASH_TABLE *record_name_index;
+	mx_status_type mx_status;
+
+	record_name_index = (MX_HASH_TABLE *) list_head->record_name_index;
+
+	if ( ( record_name_index == (MX_HASH_TABLE *) NULL )
+	  || ( record->name[0] == '\0' ) )
+	{
+		return;
+	}
+
+	mx_status = mx_hash_table_insert_key( record_name_index,
+						record->name, record );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_record_name_index_discard( list_head );
+	}
+}
+
+static void
+mx_record_name_index_remove( MX_LIST_HEAD *list_head, MX_RECORD *record )
+{
+	MX_HASH_TABLE *record_name_index;
+	void *value;
+	mx_status_type mx_status;
+
+	record_name_index = (MX_HASH_TABLE *) list_head->record_name_index;
+
+	if ( ( record_name_index == (MX_HASH_TABLE *) NULL )
+	  || ( record->name[0] == '\0' ) )
+	{
+		return;
+	}
+
+	/* Only remove the entry if it really points to this record. */
+
+	mx_status = mx_hash_table_lookup_key( record_name_index,
+						record->name, &value );
+
+	if ( ( mx_status.code != MXE_SUCCESS ) || ( value != record ) )
+		return;
+
+	mx_status = mx_hash_table_delete_key( record_name_index,
+						record->name );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_record_name_index_discard( list_head );
+	}
+}
+
+MX_EXPORT mx_status_type
+mx_create_record_name_index( MX_RECORD *record_list )
+{
+	static const char fname[] = "mx_create_record_name_index()";
+
+	MX_LIST_HEAD *list_head;
+	MX_HASH_TABLE *record_name_index;
+	MX_RECORD *current_record;
+	mx_status_type mx_status;
+
+	if ( record_list == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The record list pointer passed was NULL." );
+	}
+
+	list_head = mx_get_record_list_head_struct( record_list );
+
+	if ( list_head == (MX_LIST_HEAD *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_LIST_HEAD pointer for record list %p is NULL.",
+			record_list );
+	}
+
+	mx_record_name_index_discard( list_head );
+
+	mx_status = mx_hash_table_create( &record_name_index,
+					MXU_RECORD_NAME_LENGTH + 1,
+					MX_RECORD_NAME_INDEX_SIZE, NULL );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	list_head->record_name_index = record_name_index;
+
+	/* Add the records that are already in the list. */
+
+	current_record = record_list;
+
+	do {
+		mx_record_name_index_add( list_head, current_record );
+
+		current_record = current_record->next_record;
+
+	} while ( ( current_record != NULL )
+		&& ( current_record != record_list ) );
+
+	if ( list_head->record_name_index == NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to build the record name index." );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT void
+mx_destroy_record_name_index( MX_RECORD *record_list )
+{
+	MX_LIST_HEAD *list_head;
+
+	if ( record_list == (MX_RECORD *) NULL )
+		return;
+
+	list_head = mx_get_record_list_head_struct( record_list );
+
+	if ( list_head == (MX_LIST_HEAD *) NULL )
+		return;
+
+	mx_record_name_index_discard( list_head );
+}
+
 /* mx_insert_before_record() adds a record just before the current record. */
 
 MX_EXPORT mx_status_type
@@ -659,6 +946,8 @@ mx_insert_after_record( MX_RECORD *old_record, MX_RECORD *new_record )
 	MX_DEBUG( 8,("%s: inserted record '%s', num_records = %lu",
 		fname, new_record->name, list_head->num_records));
 
+	mx_record_name_index_add( list_head, new_record );
+
 	return MX_SUCCESSFUL_RESULT;
 }
 
@@ -669,6 +958,9 @@ mx_get_record( MX_RECORD *specified_record, const char *record_name )
 
 	MX_RECORD *current_record;
 	MX_RECORD *matching_record;
+	MX_LIST_HEAD *list_head;
+	void *value;
+	mx_status_type mx_status;
 
 	if ( specified_record == (MX_RECORD *) NULL ) {
 		mx_error( MXE_ILLEGAL_ARGUMENT, fname,
@@ -683,6 +975,26 @@ mx_get_record( MX_RECORD *specified_record, const char *record_name )
 		return NULL;
 	}
 
+	/* If the record list has a record name index, use it. */
+
+	if ( specified_record->list_head != (MX_RECORD *) NULL ) {
+		list_head = (MX_LIST_HEAD *)
+		    specified_record->list_head->record_superclass_struct;
+
+		if ( ( list_head != (MX_LIST_HEAD *) NULL )
+		  && ( list_head->record_name_index != NULL ) )
+		{
+			mx_status = mx_hash_table_lookup_key(
+				(MX_HASH_TABLE *) list_head->record_name_index,
+				record_name, &value );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return NULL;
+
+			return (MX_RECORD *) value;
+		}
+	}
+
 	/* Walk through the linked list looking for the record.
 	 * Since the list is a circular list, we will find the
 	 * record regardless of where in the list we start.
@@ -709,13 +1021,94 @@ mx_get_record( MX_RECORD *specified_record, const char *record_name )
 	return matching_record;
 }
 
+/* mx_rename_record() changes the name of a record that is already in
+ * a record list, keeping the record name index up to date.
+ */
+
+MX_EXPORT mx_status_type
+mx_rename_record( MX_RECORD *record, const char *new_name )
+{
+	static const char fname[] = "mx_rename_record()";
+
+	MX_LIST_HEAD *list_head;
+	MX_RECORD *other_record;
+
+	if ( record == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_RECORD pointer passed was NULL." );
+	}
+	if ( new_name == (const char *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The new name pointer passed was NULL." );
+	}
+
+	if ( strlen( new_name ) >= MXU_RECORD_NAME_LENGTH ) {
+		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
+		"The new name '%s' for record '%s' is longer than the "
+		"maximum allowed length of %d.",
+			new_name, record->name, MXU_RECORD_NAME_LENGTH - 1 );
+	}
+
+	if ( record->list_head == (MX_RECORD *) NULL ) {
+		strlcpy( record->name, new_name, MXU_RECORD_NAME_LENGTH );
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	other_record = mx_get_record( record, new_name );
+
+	if ( other_record == record ) {
+		return MX_SUCCESSFUL_RESULT;
+	} else
+	if ( other_record != (MX_RECORD *) NULL ) {
+		return mx_error( MXE_ALREADY_EXISTS, fname,
+		"Cannot rename record '%s' to '%s', since a record "
+		"with that name already exists.", record->name, new_name );
+	}
+
+	list_head = mx_get_record_list_head_struct( record );
+
+	if ( list_head == (MX_LIST_HEAD *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_LIST_HEAD pointer for record '%s' is NULL.",
+			record->name );
+	}
+
+	mx_record_name_index_remove( list_head, record );
+
+	strlcpy( record->name, new_name, MXU_RECORD_NAME_LENGTH );
+
+	mx_record_name_index_add( list_head, record );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
 MX_EXPORT mx_status_type
 mx_delete_record_list( MX_RECORD *record_list )
 {
+	MX_LIST_HEAD *list_head;
+	MX_ARENA *record_arena;
 	mx_status_type mx_status;
 
+	list_head = mx_get_record_list_head_struct( record_list );
+
+	if ( list_head == (MX_LIST_HEAD *) NULL ) {
+		record_arena = NULL;
+	} else {
+		record_arena = (MX_ARENA *) list_head->record_arena;
+	}
+
 	mx_status = mx_delete_record_class( record_list, MXR_ANY );
 
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	/* All of the records are gone, so the memory they used
+	 * can be given back in one step.
+	 */
+
+	mx_arena_destroy( record_arena );
+
 	return mx_status;
 }
 
@@ -813,6 +1206,10 @@ mx_get_database( void )
  * one database running in a process, but we do not currently enforce that.
  */
 
+/* The record arena gets memory from malloc() in blocks of this size. */
+
+#define MX_RECORD_ARENA_BLOCK_SIZE	( 1024L * 1024L )
+
 MX_EXPORT MX_RECORD *
 mx_initialize_database( void )
 {
@@ -847,6 +1244,33 @@ mx_initialize_database( void )
 	if ( mx_status.code != MXE_SUCCESS )
 		return NULL;
 
+	/* Index the record list by name.  If this fails, mx_get_record()
+	 * will just have to search the list.
+	 */
+
+	(void) mx_create_record_name_index( record_list_head );
+
+	/* Records created from database descriptions are allocated from
+	 * an arena.  If the arena cannot be created, they are allocated
+	 * with malloc() instead.
+	 */
+
+	{
+		MX_LIST_HEAD *list_head;
+		MX_ARENA *record_arena;
+
+		list_head = mx_get_record_list_head_struct( record_list_head );
+
+		if ( list_head != (MX_LIST_HEAD *) NULL ) {
+			mx_status = mx_arena_create( &record_arena,
+						MX_RECORD_ARENA_BLOCK_SIZE );
+
+			if ( mx_status.code == MXE_SUCCESS ) {
+				list_head->record_arena = record_arena;
+			}
+		}
+	}
+
 	/* Save a copy of the list head record pointer for programs
 	 * that need to be able to find the database.
 	 */
@@ -874,7 +1298,11 @@ typedef struct {
 static mx_status_type mx_setup_database_private(MX_RECORD **, MXP_DB_SOURCE *);
 
 static mx_status_type mx_read_database_private(MX_RECORD *,
-						MXP_DB_SOURCE *, unsigned long);
+						MXP_DB_SOURCE *, unsigned long,
+						MX_DATABASE_CACHE_WRITER *);
+
+static mx_status_type mx_read_database_file_with_cache( MX_RECORD *,
+						MXP_DB_SOURCE *, unsigned long );
 
 /*
  * mx_setup_database() is a simplified startup routine that performs
@@ -1015,7 +1443,7 @@ mx_setup_database_private( MX_RECORD **record_list, MXP_DB_SOURCE *db_source )
 
 	/* Read in the database and initialize the corresponding hardware. */
 
-	mx_status = mx_read_database_private( *record_list, db_source, 0 );
+	mx_status = mx_read_database_private( *record_list, db_source, 0, NULL );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
@@ -1093,7 +1521,13 @@ mx_read_database_file( MX_RECORD *record_list,
 	db_source.is_array = FALSE;
 	db_source.filename = filename;
 
-	mx_status = mx_read_database_private( record_list, &db_source, flags );
+	if ( flags & MXFC_USE_DATABASE_CACHE ) {
+		mx_status = mx_read_database_file_with_cache( record_list,
+							&db_source, flags );
+	} else {
+		mx_status = mx_read_database_private( record_list,
+						&db_source, flags, NULL );
+	}
 
 	return mx_status;
 }
@@ -1124,41 +1558,123 @@ mx_read_database_from_array( MX_RECORD *record_list,
 	db_source.num_lines = num_description_lines;
 	db_source.array_ptr = description_array;
 
-	mx_status = mx_read_database_private( record_list, &db_source, flags );
+	mx_status = mx_read_database_private( record_list,
+					&db_source, flags, NULL );
 
 	return mx_status;
 }
 
+/* mx_read_database_file_with_cache() loads a database file from its
+ * binary cache if the cache still matches the file.  Otherwise, the text
+ * file is parsed as usual and a new cache is written afterwards.
+ */
+
 static mx_status_type
-mxp_readline_from_file( MXP_DB_SOURCE *db_source,
-			char *buffer, size_t buffer_length )
+mx_read_database_file_with_cache( MX_RECORD *record_list,
+				MXP_DB_SOURCE *db_source,
+				unsigned long flags )
 {
-	static const char fname[] = "mxp_readline_from_file()";
+	static const char fname[] = "mx_read_database_file_with_cache()";
 
-	char c;
-	size_t length;
-	int saved_errno;
+	MX_DATABASE_CACHE_WRITER *cache_writer;
+	mx_bool_type cache_was_loaded;
+	double start_time, parse_time, write_time;
+	mx_status_type mx_status, cache_status;
 
-	mx_fgets( buffer, buffer_length, db_source->file );
+	start_time = mx_high_resolution_time_as_double();
 
-	if ( feof( db_source->file ) ) {
-		fclose( db_source->file );
+	mx_status = mx_database_cache_load( record_list, db_source->filename,
+						flags, &cache_was_loaded );
 
-		return mx_error( (MXE_END_OF_DATA | MXE_QUIET), fname,
-			"End of file at line %ld of file '%s'.",
-			db_source->line_number, db_source->filename );
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( cache_was_loaded ) {
+		mx_info( "Loaded MX database file '%s' from its binary cache "
+			"in %.6f seconds.", db_source->filename,
+			mx_high_resolution_time_as_double() - start_time );
+
+		return MX_SUCCESSFUL_RESULT;
 	}
 
-	if ( ferror( db_source->file ) ) {
-		saved_errno = errno;
+	/* If a cache writer cannot be created, we just parse the
+	 * file without writing a cache.
+	 */
 
-		fclose( db_source->file );
+	mx_status = mx_database_cache_create_writer( &cache_writer,
+							db_source->filename );
 
-		return mx_error( MXE_FILE_IO_ERROR, fname,
-			"Error at line %ld of file '%s'.  "
-			"Errno = %d, error message = '%s'.",
-			db_source->line_number, db_source->filename,
-			saved_errno, strerror( saved_errno ) );
+	if ( mx_status.code != MXE_SUCCESS ) {
+		cache_writer = NULL;
+	}
+
+	start_time = mx_high_resolution_time_as_double();
+
+	mx_status = mx_read_database_private( record_list, db_source,
+							flags, cache_writer );
+
+	parse_time = mx_high_resolution_time_as_double() - start_time;
+
+	if ( cache_writer == NULL ) {
+		cache_status = mx_error( MXE_NOT_AVAILABLE | MXE_QUIET, fname,
+				"No database cache writer was created." );
+	} else {
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_database_cache_abandon( cache_writer );
+		}
+
+		cache_status = mx_database_cache_finish_writer( cache_writer );
+	}
+
+	write_time = mx_high_resolution_time_as_double()
+					- start_time - parse_time;
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( cache_status.code == MXE_SUCCESS ) {
+		mx_info( "Parsed MX database file '%s' as text in %.6f seconds "
+			"(%.6f seconds to write the binary cache).",
+			db_source->filename, parse_time, write_time );
+	} else {
+		mx_info( "Parsed MX database file '%s' as text in %.6f seconds "
+			"(no binary cache was written).",
+			db_source->filename, parse_time );
+	}
+
+	return mx_status;
+}
+
+static mx_status_type
+mxp_readline_from_file( MXP_DB_SOURCE *db_source,
+			char *buffer, size_t buffer_length )
+{
+	static const char fname[] = "mxp_readline_from_file()";
+
+	char c;
+	size_t length;
+	int saved_errno;
+
+	mx_fgets( buffer, buffer_length, db_source->file );
+
+	if ( feof( db_source->file ) ) {
+		fclose( db_source->file );
+
+		return mx_error( (MXE_END_OF_DATA | MXE_QUIET), fname,
+			"End of file at line %ld of file '%s'.",
+			db_source->line_number, db_source->filename );
+	}
+
+	if ( ferror( db_source->file ) ) {
+		saved_errno = errno;
+
+		fclose( db_source->file );
+
+		return mx_error( MXE_FILE_IO_ERROR, fname,
+			"Error at line %ld of file '%s'.  "
+			"Errno = %d, error message = '%s'.",
+			db_source->line_number, db_source->filename,
+			saved_errno, strerror( saved_errno ) );
 	}
 
 	/* Strip off any trailing newline or carriage return characters. */
@@ -1244,10 +1760,295 @@ mxp_get_cfn_filename( int filename_type,
 	return mx_status;
 }
 
+/* mx_process_database_directive() carries out a database file line that
+ * starts with '!'.  For '!return', *return_requested is set to TRUE to
+ * tell the caller to skip the rest of the file.
+ */
+
+MX_EXPORT mx_status_type
+mx_process_database_directive( MX_RECORD *record_list_head,
+				char *buffer,
+				unsigned long flags,
+				mx_bool_type *return_requested )
+{
+	static const char fname[] = "mx_process_database_directive()";
+
+	char filename[ MXU_FILENAME_LENGTH + 1 ];
+	int saved_errno;
+	mx_status_type mx_status;
+
+	*return_requested = FALSE;
+
+	if ( strncmp( buffer, "!include ", 9 ) == 0 ) {
+
+		/* If the first 9 characters of a line consists
+		 * of the string '!include' followed by a space,
+		 * then the rest of the line is assumed to contain
+		 * the name of another database file to include
+		 * here.
+		 */
+
+		mx_status = mxp_get_cfn_filename( MX_CFN_CONFIG,
+				buffer, filename, sizeof(filename) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		MX_DEBUG( 2,("%s: Trying to read include file '%s'",
+			fname, filename));
+
+		/* Try to read the include file. */
+
+		mx_status = mx_read_database_file( record_list_head,
+					filename, flags );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		MX_DEBUG( 2,("%s: Successfully read include file '%s'",
+			fname, filename));
+
+	} else if ( strncmp( buffer, "!export ", 8 ) == 0 ) {
+
+		mx_status = mx_invoke_export_callback( record_list_head,
+							buffer );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+	} else if ( strncmp( buffer, "!load ", 6 ) == 0 ) {
+
+		mx_status = mxp_get_cfn_filename( MX_CFN_MODULE,
+				buffer, filename, sizeof(filename) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		/* Try to read a dynamically loadable MX module. */
+
+		mx_status = mx_load_module( filename,
+					record_list_head, NULL );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	} else if ( strncmp( buffer, "!library ", 9 ) == 0 ) {
+
+		MX_DYNAMIC_LIBRARY *dynamic_library = NULL;
+
+		mx_status = mxp_get_cfn_filename( MX_CFN_ABSOLUTE,
+				buffer, filename, sizeof(filename) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		mx_status = mx_dynamic_library_open( filename,
+					&dynamic_library, 0 );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		MX_DEBUG(-2,("%s:  dynamic library '%s' ptr = %p",
+			fname, filename, dynamic_library));
+
+	} else if ( strncmp( buffer, "!return", 7 ) == 0 ) {
+
+		*return_requested = TRUE;
+
+	} else if ( strncmp( buffer, "!break", 6 ) == 0 ) {
+
+		mx_breakpoint();
+
+	} else if ( strncmp( buffer, "!debug", 6 ) == 0 ) {
+
+		mx_breakpoint();
+
+	} else if ( strncmp( buffer, "!error", 6 ) == 0 ) {
+
+		(void) mx_error(MXE_SOFTWARE_CONFIGURATION_ERROR, fname,
+		"'%s' -- Exiting...", buffer );
+
+		exit(1);
+
+	} else if ( strncmp( buffer, "!getenv ", 8 ) == 0 ) {
+		int env_argc; char **env_argv; char *env_dup;
+		char *variable_name;
+
+		/* Find the name of the environment variable. */
+
+		env_dup = strdup( buffer );
+
+		if ( env_dup == (char *) NULL ) {
+			saved_errno = errno;
+
+			return mx_error( MXE_UNKNOWN_ERROR, fname,
+			"The attempt to create a duplicate of "
+			"the !getenv string '%s' failed.  "
+			"errno = %d, error message = '%s'",
+			buffer, saved_errno, strerror(saved_errno) );
+		}
+
+		mx_string_split( env_dup, " ", &env_argc, &env_argv );
+
+		if ( env_argc < 2 ) {
+			mx_free( env_argv );
+			mx_free( env_dup );
+
+			return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"Could not find an environment variable name "
+			"in the directive '%s'.", buffer );
+		}
+
+		variable_name = env_argv[1];
+
+		mx_info( "getenv: '%s' = '%s'", 
+			variable_name, getenv( variable_name ) );
+
+		mx_free( env_argv );
+		mx_free( env_dup );
+
+	} else if ( strncmp( buffer, "!setenv ", 8 ) == 0 ) {
+		int env_argc; char **env_argv; char *env_dup;
+		char variable_delimiter, variable_first_byte;
+		char *old_buffer_value, *ptr;
+		char variable_name[2048];
+		char new_variable_value[10000];
+
+		/* Find the name of the environment variable. */
+
+		env_dup = strdup( buffer );
+
+		if ( env_dup == (char *) NULL ) {
+			saved_errno = errno;
+
+		return mx_error( MXE_UNKNOWN_ERROR, fname,
+			"The attempt to create a duplicate of "
+			"the !getenv string '%s' failed.  "
+			"errno = %d, error message = '%s'",
+			buffer, saved_errno, strerror(saved_errno) );
+		}
+
+		mx_string_split( env_dup, " ", &env_argc, &env_argv );
+
+		if ( env_argc < 2 ) {
+			mx_free( env_argv );
+			mx_free( env_dup );
+
+			return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"Could not find an environment variable name "
+			"in the directive '%s'.", buffer );
+		}
+
+		strlcpy( variable_name, env_argv[1],
+				sizeof(variable_name) );
+
+		/* Find out if the value of the environment variable
+		 * is in a quoted string or not.
+		 */
+
+		variable_first_byte = env_argv[2][0];
+
+		if ( ( variable_first_byte == '"' )
+		  || ( variable_first_byte == '\'' ) )
+		{
+			variable_delimiter = variable_first_byte;
+		} else {
+			variable_delimiter = '\0';
+		}
+
+		/* mx_string_split() behaves differently from strtok()
+		 * and friends.
+		 *
+		 * For example, if strtok() is using
+		 * space characters ' ' as its delimiter and it is
+		 * parsing the string "arg1   arg2", then strtok()
+		 * will report that there are four arguments, namely,
+		 * 'arg1', '', '', and 'arg2'.  But, mx_string_split()
+		 * will report that there are two arguments, namely,
+		 * 'arg1' and 'arg2'.  In other words, if three copies
+		 * of the space character ' ' are found in a row,
+		 * mx_string_split() treats them as one delimiter,
+		 * while strtok() treats them as three delimiters.
+		 *
+		 * For most of MX's purposes, the behavior of 
+		 * mx_string_split() is more useful than the behavior
+		 * of strtok().  However, this is _not_ one of those
+		 * cases.  For example, if we compare the parsing 
+		 * of a filename that looks like this
+		 * "C:\Documents and Settings\abc.txt" to the parsing
+		 * of "C:\Documents  and  Settings\abc.txt", we
+		 * find that these two different filenames actually
+		 * refer to different files.  So when parsing
+		 * filenames, it is important that we preserve the
+		 * same number of delimiters.
+		 *
+		 * Given that, we discard env_argv and find the value
+		 * of the environment variable directly from the
+		 * 'buffer' variable.
+		 */
+
+		mx_free( env_argv );
+		mx_free( env_dup );
+
+		if ( variable_delimiter != '\0' ) {
+
+			old_buffer_value = 
+				strchr( buffer, variable_delimiter );
+
+			old_buffer_value++;
+
+			/* Null terminate the variable value. */
+
+			ptr = strchr( old_buffer_value,
+					variable_delimiter);
+
+			if ( ptr != NULL ) {
+				*ptr = '\0';
+			}
+		} else {
+			/* Skip over the variable name in the buffer.
+			 *
+			 * We do this by skipping over space characters,
+			 * and then non-space characters, followed by
+			 * more space characters./
+			 */
+
+			old_buffer_value = buffer;
+
+			old_buffer_value +=
+				strspn( old_buffer_value, " " );
+
+			old_buffer_value +=
+				strcspn( old_buffer_value, " " );
+
+			old_buffer_value +=
+				strspn( old_buffer_value, " " );
+		}
+
+		/* Expand any environment values specified in the
+		 * old string like this %env% (Windows) or as
+		 * $env (anybody else).
+		 */
+
+		mx_expand_env( new_variable_value, old_buffer_value,
+					sizeof(new_variable_value));
+
+		/* Update the environment variable's value. */
+
+		mx_setenv( variable_name, new_variable_value );
+
+	} else {
+		mx_warning( "Ignoring unrecognized directive: '%s'",
+			buffer );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
 static mx_status_type
 mx_read_database_private( MX_RECORD *record_list_head,
 			MXP_DB_SOURCE *db_source,
-			unsigned long flags )
+			unsigned long flags,
+			MX_DATABASE_CACHE_WRITER *cache_writer )
 {
 	static const char fname[] = "mx_read_database_private()";
 
@@ -1259,7 +2060,7 @@ mx_read_database_private( MX_RECORD *record_list_head,
 	MX_RECORD_FIELD_PARSE_STATUS parse_status;
 	char token[ MXU_FILENAME_LENGTH + 1 ];
 #endif
-	char filename[ MXU_FILENAME_LENGTH + 1 ];
+	mx_bool_type return_requested;
 	mx_status_type mx_status;
 
 	if ( db_source->is_array ) {
@@ -1341,266 +2142,27 @@ mx_read_database_private( MX_RECORD *record_list_head,
 			 * are skipped.
 			 */
 
-		} else if ( strncmp( buffer, "!include ", 9 ) == 0 ) {
+		} else if ( buffer[0] == '!' ) {
 
-			/* If the first 9 characters of a line consists
-			 * of the string '!include' followed by a space,
-			 * then the rest of the line is assumed to contain
-			 * the name of another database file to include
-			 * here.
+			/* Lines that begin with '!' are directives.  They
+			 * go into the cache as text and are carried out
+			 * again whenever the cache is loaded.
 			 */
 
-			mx_status = mxp_get_cfn_filename( MX_CFN_CONFIG,
-					buffer, filename, sizeof(filename) );
-
-			if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
-
-			MX_DEBUG( 2,("%s: Trying to read include file '%s'",
-				fname, filename));
-
-			/* Try to read the include file. */
-
-			mx_status = mx_read_database_file( record_list_head,
-						filename, flags );
-
-			if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
-
-			MX_DEBUG( 2,("%s: Successfully read include file '%s'",
-				fname, filename));
-
-		} else if ( strncmp( buffer, "!export ", 8 ) == 0 ) {
-
-			mx_status = mx_invoke_export_callback( record_list_head,
+			if ( cache_writer != NULL ) {
+				mx_database_cache_add_directive( cache_writer,
 								buffer );
+			}
 
-			if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
-
-		} else if ( strncmp( buffer, "!load ", 6 ) == 0 ) {
-
-			mx_status = mxp_get_cfn_filename( MX_CFN_MODULE,
-					buffer, filename, sizeof(filename) );
-
-			if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
-
-			/* Try to read a dynamically loadable MX module. */
-
-			mx_status = mx_load_module( filename,
-						record_list_head, NULL );
-
-			if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
-		} else if ( strncmp( buffer, "!library ", 9 ) == 0 ) {
-
-			MX_DYNAMIC_LIBRARY *dynamic_library = NULL;
-
-			mx_status = mxp_get_cfn_filename( MX_CFN_ABSOLUTE,
-					buffer, filename, sizeof(filename) );
-
-			if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
-
-			mx_status = mx_dynamic_library_open( filename,
-						&dynamic_library, 0 );
+			mx_status = mx_process_database_directive(
+					record_list_head, buffer, flags,
+					&return_requested );
 
 			if ( mx_status.code != MXE_SUCCESS )
 				return mx_status;
 
-			MX_DEBUG(-2,("%s:  dynamic library '%s' ptr = %p",
-				fname, filename, dynamic_library));
-
-		} else if ( strncmp( buffer, "!return", 7 ) == 0 ) {
-
-			return MX_SUCCESSFUL_RESULT;
-
-		} else if ( strncmp( buffer, "!break", 6 ) == 0 ) {
-
-			mx_breakpoint();
-
-		} else if ( strncmp( buffer, "!debug", 6 ) == 0 ) {
-
-			mx_breakpoint();
-
-		} else if ( strncmp( buffer, "!error", 6 ) == 0 ) {
-
-			(void) mx_error(MXE_SOFTWARE_CONFIGURATION_ERROR, fname,
-			"'%s' -- Exiting...", buffer );
-
-			exit(1);
-
-		} else if ( strncmp( buffer, "!getenv ", 8 ) == 0 ) {
-			int env_argc; char **env_argv; char *env_dup;
-			char *variable_name;
-
-			/* Find the name of the environment variable. */
-
-			env_dup = strdup( buffer );
-
-			if ( env_dup == (char *) NULL ) {
-				saved_errno = errno;
-
-				return mx_error( MXE_UNKNOWN_ERROR, fname,
-				"The attempt to create a duplicate of "
-				"the !getenv string '%s' failed.  "
-				"errno = %d, error message = '%s'",
-				buffer, saved_errno, strerror(saved_errno) );
-			}
-
-			mx_string_split( env_dup, " ", &env_argc, &env_argv );
-
-			if ( env_argc < 2 ) {
-				mx_free( env_argv );
-				mx_free( env_dup );
-
-				return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-				"Could not find an environment variable name "
-				"in the directive '%s'.", buffer );
-			}
-
-			variable_name = env_argv[1];
-
-			mx_info( "getenv: '%s' = '%s'", 
-				variable_name, getenv( variable_name ) );
-
-			mx_free( env_argv );
-			mx_free( env_dup );
-
-		} else if ( strncmp( buffer, "!setenv ", 8 ) == 0 ) {
-			int env_argc; char **env_argv; char *env_dup;
-			char variable_delimiter, variable_first_byte;
-			char *old_buffer_value, *ptr;
-			char variable_name[2048];
-			char new_variable_value[10000];
-
-			/* Find the name of the environment variable. */
-
-			env_dup = strdup( buffer );
-
-			if ( env_dup == (char *) NULL ) {
-				saved_errno = errno;
-
-			return mx_error( MXE_UNKNOWN_ERROR, fname,
-				"The attempt to create a duplicate of "
-				"the !getenv string '%s' failed.  "
-				"errno = %d, error message = '%s'",
-				buffer, saved_errno, strerror(saved_errno) );
-			}
-
-			mx_string_split( env_dup, " ", &env_argc, &env_argv );
-
-			if ( env_argc < 2 ) {
-				mx_free( env_argv );
-				mx_free( env_dup );
-
-				return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-				"Could not find an environment variable name "
-				"in the directive '%s'.", buffer );
-			}
-
-			strlcpy( variable_name, env_argv[1],
-					sizeof(variable_name) );
-
-			/* Find out if the value of the environment variable
-			 * is in a quoted string or not.
-			 */
-
-			variable_first_byte = env_argv[2][0];
-
-			if ( ( variable_first_byte == '"' )
-			  || ( variable_first_byte == '\'' ) )
-			{
-				variable_delimiter = variable_first_byte;
-			} else {
-				variable_delimiter = '\0';
-			}
-
-			/* mx_string_split() behaves differently from strtok()
-			 * and friends.
-			 *
-			 * For example, if strtok() is using
-			 * space characters ' ' as its delimiter and it is
-			 * parsing the string "arg1   arg2", then strtok()
-			 * will report that there are four arguments, namely,
-			 * 'arg1', '', '', and 'arg2'.  But, mx_string_split()
-			 * will report that there are two arguments, namely,
-			 * 'arg1' and 'arg2'.  In other words, if three copies
-			 * of the space character ' ' are found in a row,
-			 * mx_string_split() treats them as one delimiter,
-			 * while strtok() treats them as three delimiters.
-			 *
-			 * For most of MX's purposes, the behavior of 
-			 * mx_string_split() is more useful than the behavior
-			 * of strtok().  However, this is _not_ one of those
-			 * cases.  For example, if we compare the parsing 
-			 * of a filename that looks like this
-			 * "C:\Documents and Settings\abc.txt" to the parsing
-			 * of "C:\Documents  and  Settings\abc.txt", we
-			 * find that these two different filenames actually
-			 * refer to different files.  So when parsing
-			 * filenames, it is important that we preserve the
-			 * same number of delimiters.
-			 *
-			 * Given that, we discard env_argv and find the value
-			 * of the environment variable directly from the
-			 * 'buffer' variable.
-			 */
-
-			mx_free( env_argv );
-			mx_free( env_dup );
-
-			if ( variable_delimiter != '\0' ) {
-
-				old_buffer_value = 
-					strchr( buffer, variable_delimiter );
-
-				old_buffer_value++;
-
-				/* Null terminate the variable value. */
-
-				ptr = strchr( old_buffer_value,
-						variable_delimiter);
-
-				if ( ptr != NULL ) {
-					*ptr = '\0';
-				}
-			} else {
-				/* Skip over the variable name in the buffer.
-				 *
-				 * We do this by skipping over space characters,
-				 * and then non-space characters, followed by
-				 * more space characters./
-				 */
-
-				old_buffer_value = buffer;
-
-				old_buffer_value +=
-					strspn( old_buffer_value, " " );
-
-				old_buffer_value +=
-					strcspn( old_buffer_value, " " );
-
-				old_buffer_value +=
-					strspn( old_buffer_value, " " );
-			}
-
-			/* Expand any environment values specified in the
-			 * old string like this %env% (Windows) or as
-			 * $env (anybody else).
-			 */
-
-			mx_expand_env( new_variable_value, old_buffer_value,
-						sizeof(new_variable_value));
-
-			/* Update the environment variable's value. */
-
-			mx_setenv( variable_name, new_variable_value );
-
-		} else if ( buffer[0] == '!' ) {
-			mx_warning( "Ignoring unrecognized directive: '%s'",
-				buffer );
+			if ( return_requested )
+				return MX_SUCCESSFUL_RESULT;
 
 		} else {
 			/* Otherwise, we assume this line is just a
@@ -1611,12 +2173,25 @@ mx_read_database_private( MX_RECORD *record_list_head,
 					record_list_head, buffer,
 					&created_record, flags );
 
-			if ( mx_status.code != MXE_SUCCESS ) {
+			if ( mx_status.code == MXE_SUCCESS ) {
+			    if ( cache_writer != NULL ) {
+				mx_database_cache_add_record( cache_writer,
+							created_record );
+			    }
+			} else {
 			    if ( (flags & MXFC_DELETE_BROKEN_RECORDS) == 0 ) {
 
 				return mx_status;
 
 			    } else {
+				/* The cache would not reproduce the
+				 * warnings below, so do not write one.
+				 */
+
+				if ( cache_writer != NULL ) {
+				    mx_database_cache_abandon( cache_writer );
+				}
+
 				if ( db_source->is_array ) {
 
 				   /* Is array. */
@@ -1945,6 +2520,479 @@ mx_write_database_file( MX_RECORD *record_list, const char *filename,
 	return MX_SUCCESSFUL_RESULT;
 }
 
+/*----*/
+
+/* mx_record_domain_find_root() and mx_record_domain_merge() implement
+ * the union-find structure that is used to group records into
+ * serialization domains.  Element i of 'domain_parent_array' starts out
+ * as i and is thereafter only changed by these two functions.
+ */
+
+MX_EXPORT long
+mx_record_domain_find_root( long *domain_parent_array, long i )
+{
+	long root, next;
+
+	root = i;
+
+	while ( domain_parent_array[root] != root ) {
+		root = domain_parent_array[root];
+	}
+
+	/* Path compression. */
+
+	while ( domain_parent_array[i] != root ) {
+		next = domain_parent_array[i];
+
+		domain_parent_array[i] = root;
+
+		i = next;
+	}
+
+	return root;
+}
+
+MX_EXPORT void
+mx_record_domain_merge( long *domain_parent_array, long i, long j )
+{
+	long root_i, root_j;
+
+	root_i = mx_record_domain_find_root( domain_parent_array, i );
+	root_j = mx_record_domain_find_root( domain_parent_array, j );
+
+	if ( root_i != root_j ) {
+		domain_parent_array[root_j] = root_i;
+	}
+}
+
+/*----*/
+
+/* mx_open_hardware_in_parallel() splits the records into serialization
+ * domains, which are the connected components of the graph formed by
+ * each record's parent_record_array.  The records in a domain are opened
+ * one at a time, with each record opened after the records that it
+ * depends on and otherwise in record list order.  Different domains are
+ * opened at the same time by a pool of threads, so that slow network
+ * connections and device handshakes to unrelated hardware overlap.
+ */
+
+typedef struct {
+	MX_RECORD *record;
+	long next_in_domain;
+	int visit_state;
+	long open_status_code;
+} MXP_OPEN_RECORD_INFO;
+
+typedef struct {
+	MX_MUTEX *mutex;
+	MXP_OPEN_RECORD_INFO *info_array;
+	long *domain_array;
+	long num_domains;
+	long next_domain;
+	unsigned long inithw_flags;
+
+	/* 'abort_requested' is protected by 'mutex'. */
+
+	mx_bool_type abort_requested;
+} MXP_PARALLEL_OPEN;
+
+#define MXS_OPEN_NOT_VISITED	0
+#define MXS_OPEN_VISITING	1
+#define MXS_OPEN_VISITED	2
+
+static long
+mxp_open_record_index( MX_HASH_TABLE *index_table,
+			MXP_OPEN_RECORD_INFO *info_array,
+			MX_RECORD *record )
+{
+	void *value;
+	mx_status_type mx_status;
+
+	if ( record == (MX_RECORD *) NULL )
+		return -1;
+
+	mx_status = mx_hash_table_lookup_key( index_table,
+						record->name, &value );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return -1;
+
+	if ( ((MXP_OPEN_RECORD_INFO *) value)->record != record )
+		return -1;
+
+	return (MXP_OPEN_RECORD_INFO *) value - info_array;
+}
+
+/* mxp_open_visit_record() appends record 'i' to the end of its domain
+ * after first appending all of the records that it depends on.  A record
+ * that is reached again while its own parents are still being visited is
+ * part of a dependency loop, so the loop is broken at that point.
+ */
+
+static void
+mxp_open_visit_record( MX_HASH_TABLE *index_table,
+			MXP_OPEN_RECORD_INFO *info_array,
+			long *domain_parent_array,
+			long *domain_first_array,
+			long *domain_last_array,
+			long i )
+{
+	MX_RECORD *record;
+	long j, k, root;
+
+	if ( info_array[i].visit_state != MXS_OPEN_NOT_VISITED )
+		return;
+
+	info_array[i].visit_state = MXS_OPEN_VISITING;
+
+	record = info_array[i].record;
+
+	for ( k = 0; k < record->num_parent_records; k++ ) {
+		j = mxp_open_record_index( index_table, info_array,
+					record->parent_record_array[k] );
+
+		if ( j >= 0 ) {
+			mxp_open_visit_record( index_table, info_array,
+				domain_parent_array, domain_first_array,
+				domain_last_array, j );
+		}
+	}
+
+	info_array[i].visit_state = MXS_OPEN_VISITED;
+
+	root = mx_record_domain_find_root( domain_parent_array, i );
+
+	if ( domain_last_array[root] >= 0 ) {
+		info_array[ domain_last_array[root] ].next_in_domain = i;
+	} else {
+		domain_first_array[root] = i;
+	}
+
+	domain_last_array[root] = i;
+}
+
+static mx_bool_type
+mxp_open_abort_requested( MXP_PARALLEL_OPEN *parallel_open )
+{
+	mx_bool_type abort_requested;
+
+	mx_mutex_lock( parallel_open->mutex );
+
+	abort_requested = parallel_open->abort_requested;
+
+	mx_mutex_unlock( parallel_open->mutex );
+
+	return abort_requested;
+}
+
+static mx_status_type
+mxp_open_thread_fn( MX_THREAD *thread, void *args )
+{
+	MXP_PARALLEL_OPEN *parallel_open;
+	MXP_OPEN_RECORD_INFO *info;
+	long i;
+	mx_status_type mx_status;
+
+	parallel_open = (MXP_PARALLEL_OPEN *) args;
+
+	for (;;) {
+		mx_mutex_lock( parallel_open->mutex );
+
+		if ( parallel_open->abort_requested
+		  || ( parallel_open->next_domain
+				>= parallel_open->num_domains ) )
+		{
+			mx_mutex_unlock( parallel_open->mutex );
+
+			return MX_SUCCESSFUL_RESULT;
+		}
+
+		i = parallel_open->domain_array[ parallel_open->next_domain ];
+
+		parallel_open->next_domain++;
+
+		mx_mutex_unlock( parallel_open->mutex );
+
+		while ( i >= 0 ) {
+			if ( mxp_open_abort_requested( parallel_open ) )
+				break;
+
+			info = &(parallel_open->info_array[i]);
+
+			if ( parallel_open->inithw_flags
+					& MXF_INITHW_TRACE_OPENS )
+			{
+				mx_info( "Opening record '%s'.",
+						info->record->name );
+			}
+
+			mx_status = mx_open_hardware( info->record );
+
+			info->open_status_code = mx_status.code;
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				info->record->record_flags |= MXF_REC_FAULTED;
+
+				if ( parallel_open->inithw_flags
+						& MXF_INITHW_ABORT_ON_FAULT )
+				{
+					mx_mutex_lock( parallel_open->mutex );
+
+					parallel_open->abort_requested = TRUE;
+
+					mx_mutex_unlock( parallel_open->mutex );
+				}
+			}
+
+			i = info->next_in_domain;
+		}
+	}
+}
+
+static mx_status_type
+mx_open_hardware_in_parallel( MX_RECORD *record_list,
+				unsigned long inithw_flags,
+				unsigned long num_open_threads )
+{
+	static const char fname[] = "mx_open_hardware_in_parallel()";
+
+	MXP_PARALLEL_OPEN parallel_open;
+	MXP_OPEN_RECORD_INFO *info_array;
+	MX_HASH_TABLE *index_table;
+	MX_THREAD **thread_array;
+	MX_RECORD *current_record;
+	long i, j, k, root_i, num_records, num_threads;
+	long *domain_parent_array, *domain_first_array, *domain_last_array;
+	long thread_exit_status;
+	char error_message[80];
+	mx_status_type mx_status;
+
+	memset( &parallel_open, 0, sizeof(parallel_open) );
+
+	num_records = 0;
+
+	for ( current_record = record_list->next_record;
+	    current_record != record_list;
+	    current_record = current_record->next_record )
+	{
+		num_records++;
+	}
+
+	if ( num_records == 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	info_array = (MXP_OPEN_RECORD_INFO *)
+			calloc( num_records, sizeof(MXP_OPEN_RECORD_INFO) );
+
+	domain_parent_array = (long *) malloc( num_records * sizeof(long) );
+
+	domain_first_array = (long *) malloc( num_records * sizeof(long) );
+
+	domain_last_array = (long *) malloc( num_records * sizeof(long) );
+
+	parallel_open.domain_array =
+			(long *) malloc( num_records * sizeof(long) );
+
+	if ( ( info_array == (MXP_OPEN_RECORD_INFO *) NULL )
+	  || ( domain_parent_array == (long *) NULL )
+	  || ( domain_first_array == (long *) NULL )
+	  || ( domain_last_array == (long *) NULL )
+	  || ( parallel_open.domain_array == (long *) NULL ) )
+	{
+		mx_free( info_array );
+		mx_free( domain_parent_array );
+		mx_free( domain_first_array );
+		mx_free( domain_last_array );
+		mx_free( parallel_open.domain_array );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate open information "
+		"for %ld records.", num_records );
+	}
+
+	mx_status = mx_hash_table_create( &index_table,
+				MXU_RECORD_NAME_LENGTH + 1, num_records, NULL );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_free( info_array );
+		mx_free( domain_parent_array );
+		mx_free( domain_first_array );
+		mx_free( domain_last_array );
+		mx_free( parallel_open.domain_array );
+
+		return mx_status;
+	}
+
+	i = 0;
+
+	for ( current_record = record_list->next_record;
+	    current_record != record_list;
+	    current_record = current_record->next_record )
+	{
+		info_array[i].record = current_record;
+		info_array[i].next_in_domain = -1;
+		info_array[i].visit_state = MXS_OPEN_NOT_VISITED;
+		info_array[i].open_status_code = MXE_SUCCESS;
+
+		domain_parent_array[i] = i;
+		domain_first_array[i] = -1;
+		domain_last_array[i] = -1;
+
+		(void) mx_hash_table_insert_key( index_table,
+					current_record->name, &info_array[i] );
+		i++;
+	}
+
+	/* Merge each record with all of the records that it depends on. */
+
+	for ( i = 0; i < num_records; i++ ) {
+		current_record = info_array[i].record;
+
+		for ( k = 0; k < current_record->num_parent_records; k++ ) {
+			j = mxp_open_record_index( index_table, info_array,
+				current_record->parent_record_array[k] );
+
+			if ( j >= 0 ) {
+				mx_record_domain_merge( domain_parent_array,
+								i, j );
+			}
+		}
+	}
+
+	/* Put the records of each domain in the order that they must be
+	 * opened and list the domains in the order of their first record.
+	 */
+
+	for ( i = 0; i < num_records; i++ ) {
+		mxp_open_visit_record( index_table, info_array,
+				domain_parent_array, domain_first_array,
+				domain_last_array, i );
+	}
+
+	parallel_open.num_domains = 0;
+
+	for ( i = 0; i < num_records; i++ ) {
+		root_i = mx_record_domain_find_root( domain_parent_array, i );
+
+		if ( domain_first_array[root_i] < 0 )
+			continue;
+
+		parallel_open.domain_array[ parallel_open.num_domains ]
+						= domain_first_array[root_i];
+
+		parallel_open.num_domains++;
+
+		domain_first_array[root_i] = -1;
+	}
+
+	mx_free( domain_parent_array );
+	mx_free( domain_first_array );
+	mx_free( domain_last_array );
+	mx_hash_table_destroy( index_table );
+
+	/* Now open the domains. */
+
+	num_threads = (long) num_open_threads;
+
+	if ( num_threads > parallel_open.num_domains ) {
+		num_threads = parallel_open.num_domains;
+	}
+
+	mx_info( "Opening %ld records in %ld serialization domains "
+		"with %ld threads.",
+		num_records, parallel_open.num_domains, num_threads );
+
+	parallel_open.info_array = info_array;
+	parallel_open.next_domain = 0;
+	parallel_open.inithw_flags = inithw_flags;
+	parallel_open.abort_requested = FALSE;
+
+	thread_array = (MX_THREAD **) calloc( num_threads, sizeof(MX_THREAD *) );
+
+	if ( thread_array == (MX_THREAD **) NULL ) {
+		mx_free( info_array );
+		mx_free( parallel_open.domain_array );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an array of %ld threads.",
+			num_threads );
+	}
+
+	mx_status = mx_mutex_create( &(parallel_open.mutex) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_free( thread_array );
+		mx_free( info_array );
+		mx_free( parallel_open.domain_array );
+
+		return mx_status;
+	}
+
+	for ( i = 0; i < num_threads; i++ ) {
+		mx_status = mx_thread_create( &(thread_array[i]),
+						"MX hardware open",
+						mxp_open_thread_fn,
+						&parallel_open );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			thread_array[i] = NULL;
+			break;
+		}
+	}
+
+	/* If no threads could be created at all, the calling thread
+	 * opens all of the domains itself.
+	 */
+
+	if ( i == 0 ) {
+		(void) mxp_open_thread_fn( NULL, &parallel_open );
+	}
+
+	for ( i = 0; i < num_threads; i++ ) {
+		if ( thread_array[i] != (MX_THREAD *) NULL ) {
+			(void) mx_thread_wait( thread_array[i],
+				&thread_exit_status, MX_THREAD_INFINITE_WAIT );
+
+			(void) mx_thread_free_data_structures(
+							thread_array[i] );
+		}
+	}
+
+	mx_free( thread_array );
+	(void) mx_mutex_destroy( parallel_open.mutex );
+
+	/* The error messages of the records that failed may have been
+	 * interleaved with the messages of other threads, so list the
+	 * failed records again here.
+	 */
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	for ( i = 0; i < num_records; i++ ) {
+		if ( info_array[i].open_status_code == MXE_SUCCESS )
+			continue;
+
+		mx_warning( "Opening record '%s' failed with %s.",
+			info_array[i].record->name,
+			mx_strerror( info_array[i].open_status_code,
+				error_message, sizeof(error_message) ) );
+
+		if ( ( mx_status.code == MXE_SUCCESS )
+		  && ( inithw_flags & MXF_INITHW_ABORT_ON_FAULT ) )
+		{
+			mx_status = mx_error(
+				info_array[i].open_status_code | MXE_QUIET,
+				fname, "Opening record '%s' failed.",
+				info_array[i].record->name );
+		}
+	}
+
+	mx_free( info_array );
+	mx_free( parallel_open.domain_array );
+
+	return mx_status;
+}
+
 MX_EXPORT mx_status_type
 mx_initialize_hardware( MX_RECORD *record_list_head,
 			unsigned long inithw_flags )
@@ -1952,6 +3000,7 @@ mx_initialize_hardware( MX_RECORD *record_list_head,
 	static const char fname[] = "mx_initialize_hardware()";
 
 	MX_RECORD *current_record;
+	MX_LIST_HEAD *list_head;
 	mx_status_type mx_status;
 
 	MX_DEBUG( 7,("%s invoked.", fname));
@@ -1968,6 +3017,14 @@ mx_initialize_hardware( MX_RECORD *record_list_head,
 		"Pointer passed to this function is not a record list head.");
 	}
 
+	list_head = mx_get_record_list_head_struct( record_list_head );
+
+	if ( list_head == (MX_LIST_HEAD *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_LIST_HEAD pointer for record list %p is NULL.",
+			record_list_head );
+	}
+
 	/* Initialize the hardware. */
 
 	current_record = record_list_head;
@@ -1996,6 +3053,21 @@ mx_initialize_hardware( MX_RECORD *record_list_head,
 
 		current_record = current_record->next_record;
 
+		/* After the list head itself has been opened, the rest
+		 * of the records may be opened in parallel.
+		 */
+
+		if ( list_head->num_open_threads > 1 ) {
+			mx_status = mx_open_hardware_in_parallel(
+					record_list_head, inithw_flags,
+					list_head->num_open_threads );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+
+			break;
+		}
+
 	} while ( current_record != record_list_head );
 
 	/* A few drivers require extra initialization steps after
@@ -116,6 +116,9 @@ typedef struct mx_record_field_type {
 
 	double value_change_threshold;
 	double last_value;
+	uint64_t last_value_hash;
+	void *last_value_snapshot;
+	size_t last_value_snapshot_length;
 	mx_bool_type value_has_changed_manual_override;
 
 	mx_status_type (*value_changed_test_function)(
@@ -186,6 +189,7 @@ typedef struct mx_record_type {
 
 	long                  num_record_fields;
 	MX_RECORD_FIELD       *record_field_array;
+	void                  *field_name_index;   /* Shared with the driver */
 
 	struct mx_record_type *allocated_by;
 	long                  num_parent_records;
@@ -517,6 +521,7 @@ typedef struct mx_driver_type {
 	long *num_record_fields;
 	MX_RECORD_FIELD_DEFAULTS **record_field_defaults_ptr;
 	struct mx_driver_type *next_driver;
+	void *field_name_index;
 } MX_DRIVER;
 
 typedef struct {
@@ -605,6 +610,20 @@ typedef struct {
 	void *handle_table;
 	void *application_ptr;
 
+	/* 'record_name_index' is an MX_HASH_TABLE that maps record names
+	 * to MX_RECORD pointers for mx_get_record().  If it is NULL,
+	 * mx_get_record() falls back to walking the record list.
+	 */
+
+	void *record_name_index;
+
+	/* 'record_arena' is an MX_ARENA that holds the MX_RECORD structures
+	 * and record field arrays of the records in the list.  The memory
+	 * is only given back when mx_delete_record_list() is called.
+	 */
+
+	void *record_arena;
+
 	char hostname[ MXU_HOSTNAME_LENGTH + 1 ];
 	char username[ MXU_USERNAME_LENGTH + 1 ];
 	char program_name[ MXU_PROGRAM_NAME_LENGTH + 1 ];
@@ -615,21 +634,55 @@ typedef struct {
 	void *client_callback_handle_table;
 	void *server_callback_handle_table;
 
+	/* 'callback_poll_wheel' is the schedule that mx_poll_callback_handler()
+	 * uses to find the server callbacks that are due on each poll.
+	 */
+
+	void *callback_poll_wheel;
+
 	void *master_timer;
 	void *callback_timer;
 
-	void *callback_pipe;
+	void *callback_queue;
 
 	void *poll_callback_message;
 	unsigned long num_poll_callbacks;
 	double poll_callback_interval;		/* in seconds */
 
+	/* An MX server that runs hardware requests on worker threads sets
+	 * the following two hooks.  If 'callback_message_handler' is not
+	 * NULL, mx_process_callbacks() passes each MX_CALLBACK_MESSAGE to it
+	 * instead of calling mx_process_callback_message().  Similarly, if
+	 * 'poll_callback_dispatcher' is not NULL, mx_poll_callback_handler()
+	 * passes each MX_CALLBACK that is due to it instead of calling
+	 * mx_poll_callback_field().
+	 */
+
+	mx_status_type (*callback_message_handler)( void *callback_message );
+	mx_status_type (*poll_callback_dispatcher)( void *callback,
+						mx_bool_type get_new_value );
+
 	void *module_list;
 
 	unsigned long socket_multiplexer_type;
 
 	unsigned long max_network_dump_bytes;
 
+	/* Limits on the messages that an MX server queues for a client
+	 * that is not reading them.  A limit of 0 means no limit.
+	 */
+
+	unsigned long max_client_queue_bytes;
+	unsigned long max_client_queue_messages;
+	unsigned long client_queue_overflow_policy;
+
+	/* If num_open_threads is greater than 1, mx_initialize_hardware()
+	 * opens unrelated groups of records in parallel using that many
+	 * threads.  Otherwise, the records are opened one at a time.
+	 */
+
+	unsigned long num_open_threads;
+
 	/* Show a list of all threads in this process. */
 	mx_bool_type show_thread_list;
 
@@ -655,6 +708,14 @@ typedef struct {
 #define MXFC_ALLOW_SCAN_REPLACEMENT	0x2
 #define MXFC_DELETE_BROKEN_RECORDS	0x4
 
+/* MXFC_USE_DATABASE_CACHE only applies to mx_read_database_file().  It
+ * tells it to load a database file from a binary cache of the parsed
+ * records, if a cache that matches the file exists, and otherwise to
+ * write a new cache after the file has been parsed.
+ */
+
+#define MXFC_USE_DATABASE_CACHE		0x8
+
 /* The following are flags for mx_initialize_hardware(). */
 
 #define MXF_INITHW_TRACE_OPENS		0x1
@@ -668,6 +729,12 @@ MX_API mx_bool_type mx_verify_driver_type( MX_RECORD *record,
 MX_API MX_DRIVER *mx_get_driver_by_name( char *name );
 MX_API MX_DRIVER *mx_get_driver_by_type( long record_type );
 
+/* mx_set_driver_index() turns the use of the driver name and type indexes
+ * by the two functions above on or off.  It is on by default.
+ */
+
+MX_API void mx_set_driver_index( mx_bool_type use_driver_index );
+
 MX_API MX_DRIVER *mx_get_driver_object( MX_RECORD *record );
 MX_API MX_DRIVER *mx_get_driver_class_object( MX_RECORD *record );
 MX_API MX_DRIVER *mx_get_driver_superclass_object( MX_RECORD *record );
@@ -696,6 +763,10 @@ MX_API char *mx_get_parameter_name_from_type( MX_RECORD *record, long type,
 						size_t name_buffer_length );
 
 MX_API MX_RECORD      *mx_create_record( void );
+MX_API MX_RECORD      *mx_create_record_in_list( MX_RECORD *record_list,
+						long num_record_fields );
+MX_API void            mx_free_record_structure( MX_LIST_HEAD *list_head,
+						MX_RECORD *record );
 MX_API mx_status_type  mx_delete_record( MX_RECORD *record );
 
 MX_API mx_status_type  mx_insert_before_record( MX_RECORD *old_record,
@@ -706,6 +777,13 @@ MX_API mx_status_type  mx_insert_after_record( MX_RECORD *old_record,
 MX_API MX_RECORD      *mx_get_record( MX_RECORD *record_list,
 						const char *record_name );
 
+MX_API mx_status_type  mx_rename_record( MX_RECORD *record,
+						const char *new_name );
+
+MX_API mx_status_type  mx_create_record_name_index( MX_RECORD *record_list );
+
+MX_API void            mx_destroy_record_name_index( MX_RECORD *record_list );
+
 MX_API mx_status_type  mx_default_delete_record_handler( MX_RECORD *record );
 
 MX_API mx_status_type  mx_delete_record_list( MX_RECORD *record_list );
@@ -724,6 +802,17 @@ MX_API mx_status_type  mx_initialize_hardware( MX_RECORD *record_list,
 
 MX_API mx_status_type  mx_shutdown_hardware( MX_RECORD *record_list );
 
+/* Records that depend on each other through their parent_record_array
+ * belong to the same serialization domain.  The domains are found by
+ * merging the array index of each record with those of its parents.
+ */
+
+MX_API long            mx_record_domain_find_root( long *domain_parent_array,
+						long i );
+
+MX_API void            mx_record_domain_merge( long *domain_parent_array,
+						long i, long j );
+
 MX_API MX_LIST_HEAD   *mx_get_record_list_head_struct( MX_RECORD *record );
 
 MX_API mx_bool_type    mx_database_is_server( MX_RECORD *record );
@@ -771,6 +860,12 @@ MX_API mx_status_type  mx_read_database_from_array( MX_RECORD *record_list,
 						long num_descriptions,
 						char **description_array,
 						unsigned long flags );
+
+MX_API_PRIVATE mx_status_type  mx_process_database_directive(
+						MX_RECORD *record_list,
+						char *directive,
+						unsigned long flags,
+						mx_bool_type *return_requested );
 /* --- */
 
 /* These functions return the record list pointer as the function return
@@ -920,6 +1015,41 @@ MX_API_PRIVATE mx_status_type  mx_parse_record_fields( MX_RECORD *record,
 			MX_RECORD_FIELD_DEFAULTS *record_field_defaults_array,
 			MX_RECORD_FIELD_PARSE_STATUS *parse_status );
 
+/* An MX_RECORD_FIELD_VALUE_LOADER fills in the value of a record field
+ * that is listed in the record description.  Like the typedef for
+ * MX_TRAVERSE_FIELD_HANDLER below, it can only be used to declare
+ * pointers to such functions.
+ */
+
+typedef mx_status_type MX_RECORD_FIELD_VALUE_LOADER(
+				MX_RECORD *record,
+				MX_RECORD_FIELD *record_field,
+				void *field_value_ptr,
+				void *loader_arguments );
+
+MX_API_PRIVATE mx_status_type  mx_setup_record_fields( MX_RECORD *record,
+			MX_RECORD_FIELD_DEFAULTS *record_field_defaults_array,
+			MX_RECORD_FIELD_VALUE_LOADER *field_value_loader,
+			void *loader_arguments );
+
+MX_API_PRIVATE mx_status_type  mx_parse_record_field_tokens(
+				MX_RECORD *record,
+				MX_RECORD_FIELD *record_field,
+				void *field_value_ptr,
+				void *loader_arguments );
+
+MX_API_PRIVATE mx_status_type  mx_create_record_from_driver(
+				MX_RECORD *record_list,
+				const char *record_name,
+				long mx_superclass,
+				long mx_class,
+				MX_DRIVER *type_driver,
+				const char *description,
+				unsigned long flags,
+				MX_RECORD_FIELD_VALUE_LOADER *field_value_loader,
+				void *loader_arguments,
+				MX_RECORD **created_record );
+
 MX_API_PRIVATE mx_status_type  mx_get_next_record_token(
 				MX_RECORD_FIELD_PARSE_STATUS *parse_status,
 				char *buffer, size_t buffer_length );
@@ -972,6 +1102,8 @@ MX_API_PRIVATE mx_status_type  mx_find_record_field_defaults_index(
 		const char *name_of_field_to_find,
 		long *index_of_field_that_was_found );
 
+MX_API_PRIVATE mx_status_type  mx_create_field_name_index( MX_DRIVER *driver );
+
 MX_API long mx_get_datatype_from_datatype_name( const char *datatype_name );
 
 MX_API const char *mx_get_datatype_name_from_datatype( long datatype );
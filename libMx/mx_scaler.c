@@ -192,37 +192,27 @@ mx_scaler_overflow_set( MX_RECORD *scaler_record, mx_bool_type *overflow_set )
 	return mx_status;
 }
 
-MX_EXPORT mx_status_type
-mx_scaler_read( MX_RECORD *scaler_record, long *value )
+/* mx_scaler_get_dark_current_time() finds out whether a dark current
+ * must be subtracted from the next value read from the scaler, and if
+ * so, for how long the scaler has been counting.
+ */
+
+static mx_status_type
+mx_scaler_get_dark_current_time( MX_RECORD *scaler_record,
+				MX_SCALER *scaler,
+				int *subtract_dark_current_ptr,
+				double *last_measurement_time_ptr )
 {
 	static const char fname[] = "mx_scaler_read()";
 
-	MX_SCALER *scaler;
 	MX_RECORD *timer_record;
-	MX_SCALER_FUNCTION_LIST *function_list;
-	mx_status_type ( *read_fn ) ( MX_SCALER * );
-	long offset, timer_mode;
+	long timer_mode;
 	int subtract_dark_current;
 	double last_measurement_time;
 	mx_status_type mx_status;
 
-	mx_status = mx_scaler_get_pointers( scaler_record,
-					&scaler, &function_list, fname );
-
-	if ( mx_status.code != MXE_SUCCESS )
-		return mx_status;
-
-	read_fn = function_list->read;
-
-	if ( read_fn == NULL ) {
-		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-		"The 'read' function pointer for scaler '%s' is NULL.",
-			scaler_record->name );
-	}
-
 	subtract_dark_current = FALSE;
 	last_measurement_time = 0.0;
-	offset = 0;
 
 	/* We only subtract a dark current here if:
 	 *
@@ -280,12 +270,22 @@ mx_scaler_read( MX_RECORD *scaler_record, long *value )
 		}
 	}
 
-	/* Read the raw measurement. */
+	*subtract_dark_current_ptr = subtract_dark_current;
+	*last_measurement_time_ptr = last_measurement_time;
 
-	mx_status = (*read_fn)( scaler );
+	return MX_SUCCESSFUL_RESULT;
+}
 
-	if ( mx_status.code != MXE_SUCCESS )
-		return mx_status;
+/* mx_scaler_compute_value() subtracts the dark current, if needed, from
+ * the raw value that the driver has just read.
+ */
+
+static void
+mx_scaler_compute_value( MX_SCALER *scaler,
+			int subtract_dark_current,
+			double last_measurement_time )
+{
+	long offset;
 
 	/* Compute and subtract the dark current offset for this measurement
 	 * if needed.
@@ -299,6 +299,49 @@ mx_scaler_read( MX_RECORD *scaler_record, long *value )
 	} else {
 		scaler->value = scaler->raw_value;
 	}
+}
+
+MX_EXPORT mx_status_type
+mx_scaler_read( MX_RECORD *scaler_record, long *value )
+{
+	static const char fname[] = "mx_scaler_read()";
+
+	MX_SCALER *scaler;
+	MX_SCALER_FUNCTION_LIST *function_list;
+	mx_status_type ( *read_fn ) ( MX_SCALER * );
+	int subtract_dark_current;
+	double last_measurement_time;
+	mx_status_type mx_status;
+
+	mx_status = mx_scaler_get_pointers( scaler_record,
+					&scaler, &function_list, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	read_fn = function_list->read;
+
+	if ( read_fn == NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The 'read' function pointer for scaler '%s' is NULL.",
+			scaler_record->name );
+	}
+
+	mx_status = mx_scaler_get_dark_current_time( scaler_record, scaler,
+				&subtract_dark_current, &last_measurement_time );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	/* Read the raw measurement. */
+
+	mx_status = (*read_fn)( scaler );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_scaler_compute_value( scaler,
+				subtract_dark_current, last_measurement_time );
 
 	if ( value != NULL ) {
 		*value = scaler->value;
@@ -306,6 +349,150 @@ mx_scaler_read( MX_RECORD *scaler_record, long *value )
 	return MX_SUCCESSFUL_RESULT;
 }
 
+MX_EXPORT mx_status_type
+mx_scaler_array_read( long num_records,
+			MX_RECORD **record_array,
+			long *value_array )
+{
+	static const char fname[] = "mx_scaler_array_read()";
+
+	MX_SCALER *scaler;
+	MX_SCALER_FUNCTION_LIST *function_list;
+	mx_status_type ( *array_fptr )( long, MX_RECORD ** );
+	MX_RECORD **driver_record_array;
+	mx_bool_type *value_read;
+	long i, j, num_driver_records;
+	int subtract_dark_current;
+	double last_measurement_time;
+	mx_status_type mx_status;
+
+	if ( record_array == (MX_RECORD **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The record_array pointer passed was NULL." );
+	}
+
+	if ( num_records <= 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	driver_record_array = (MX_RECORD **)
+			malloc( num_records * sizeof(MX_RECORD *) );
+
+	value_read = (mx_bool_type *)
+			calloc( num_records, sizeof(mx_bool_type) );
+
+	if ( ( driver_record_array == (MX_RECORD **) NULL )
+	  || ( value_read == (mx_bool_type *) NULL ) )
+	{
+		mx_free( driver_record_array );
+		mx_free( value_read );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate arrays for "
+		"%ld scaler records.", num_records );
+	}
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	for ( i = 0; i < num_records; i++ ) {
+
+		if ( value_read[i] )
+			continue;
+
+		mx_status = mx_scaler_get_pointers( record_array[i],
+					&scaler, &function_list, fname );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
+
+		array_fptr = function_list->read_array;
+
+		if ( array_fptr == NULL ) {
+			value_read[i] = TRUE;
+
+			mx_status = mx_scaler_read( record_array[i], NULL );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+
+			continue;
+		}
+
+		/* Gather the rest of the scalers that use the same
+		 * read_array() function.
+		 */
+
+		num_driver_records = 0;
+
+		for ( j = i; j < num_records; j++ ) {
+			if ( value_read[j] )
+				continue;
+
+			mx_status = mx_scaler_get_pointers( record_array[j],
+					&scaler, &function_list, fname );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+
+			if ( function_list->read_array == array_fptr ) {
+				value_read[j] = TRUE;
+
+				driver_record_array[ num_driver_records ]
+						= record_array[j];
+
+				num_driver_records++;
+			}
+		}
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
+
+		mx_status = ( *array_fptr )( num_driver_records,
+						driver_record_array );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
+
+		for ( j = 0; j < num_driver_records; j++ ) {
+			scaler = (MX_SCALER *)
+				driver_record_array[j]->record_class_struct;
+
+			mx_status = mx_scaler_get_dark_current_time(
+					driver_record_array[j], scaler,
+					&subtract_dark_current,
+					&last_measurement_time );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+
+			mx_scaler_compute_value( scaler,
+				subtract_dark_current, last_measurement_time );
+		}
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
+	}
+
+	/* Copy out the value of each scaler.  The same scaler may be
+	 * in the array more than once.
+	 */
+
+	if ( ( mx_status.code == MXE_SUCCESS )
+	  && ( value_array != (long *) NULL ) )
+	{
+		for ( i = 0; i < num_records; i++ ) {
+			scaler = (MX_SCALER *)
+				record_array[i]->record_class_struct;
+
+			value_array[i] = scaler->value;
+		}
+	}
+
+	mx_free( driver_record_array );
+	mx_free( value_read );
+
+	return mx_status;
+}
+
 MX_EXPORT mx_status_type
 mx_scaler_read_raw( MX_RECORD *scaler_record, long *value )
 {
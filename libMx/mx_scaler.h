@@ -123,6 +123,14 @@ typedef struct {
 	mx_status_type ( *set_parameter ) ( MX_SCALER *scaler );
 	mx_status_type ( *set_modes_of_associated_counters )
 					( MX_SCALER *scaler );
+
+	/* read_array() is passed only scalers that use this driver.
+	 * It must update 'raw_value' for each of them in the same way
+	 * as read(), but may read all of them at the same time.
+	 */
+
+	mx_status_type ( *read_array ) ( long num_records,
+					MX_RECORD **record_array );
 } MX_SCALER_FUNCTION_LIST;
 
 MX_API_PRIVATE mx_status_type mx_scaler_get_pointers( MX_RECORD *scaler_record,
@@ -139,6 +147,16 @@ MX_API mx_status_type mx_scaler_overflow_set( MX_RECORD *scaler_record,
 
 MX_API mx_status_type mx_scaler_read( MX_RECORD *scaler_record, long *value );
 
+/* mx_scaler_array_read() reads all of the scalers in the array.  Scalers
+ * whose drivers have a read_array() function are read together, so that,
+ * for example, the requests for network scalers are all in flight at the
+ * same time.  'value_array' may be NULL.
+ */
+
+MX_API mx_status_type mx_scaler_array_read( long num_records,
+						MX_RECORD **record_array,
+						long *value_array );
+
 MX_API mx_status_type mx_scaler_read_raw( MX_RECORD *scaler_record,
 							long *value );
 
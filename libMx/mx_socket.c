@@ -54,6 +54,7 @@
 #include "mx_socket.h"
 #include "mx_select.h"
 #include "mx_net.h"
+#include "mx_net_shm.h"
 
 #if ( HAVE_UNIX_DOMAIN_SOCKETS && !defined(AF_LOCAL) )
 #define AF_LOCAL	AF_UNIX
@@ -693,8 +694,9 @@ mx_tcp_socket_open_as_client( MX_SOCKET **client_socket,
 		if ( buffer_size > 0 ) {
 			MX_CIRCULAR_BUFFER *circular_buffer;
 
-			mx_status = mx_circular_buffer_create( &circular_buffer,
-								buffer_size );
+			mx_status = mx_circular_buffer_create_with_flags(
+						&circular_buffer, buffer_size,
+						MXF_CIRCULAR_BUFFER_SPSC );
 
 			if ( mx_status.code != MXE_SUCCESS )
 				return mx_status;
@@ -1067,8 +1069,9 @@ mx_unix_socket_open_as_client( MX_SOCKET **client_socket,
 		if ( buffer_size > 0 ) {
 			MX_CIRCULAR_BUFFER *circular_buffer;
 
-			mx_status = mx_circular_buffer_create( &circular_buffer,
-								buffer_size );
+			mx_status = mx_circular_buffer_create_with_flags(
+						&circular_buffer, buffer_size,
+						MXF_CIRCULAR_BUFFER_SPSC );
 
 			if ( mx_status.code != MXE_SUCCESS )
 				return mx_status;
@@ -1322,10 +1325,15 @@ mx_socket_close( MX_SOCKET *mx_socket )
 
 	mx_status = mx_socket_set_non_blocking_mode( mx_socket, TRUE );
 
+	mx_free( mx_socket->compression_buffer );
+
+	(void) mx_network_shm_detach( mx_socket );
+
 	mx_socket->socket_fd = MX_INVALID_SOCKET_FD;
 	mx_socket->socket_flags = 0;
 	mx_socket->is_non_blocking = FALSE;
 	mx_socket->receive_buffer = NULL;
+	mx_socket->send_hook = NULL;
 
 	mx_free( mx_socket );
 
@@ -2924,6 +2932,242 @@ mx_socket_send( MX_SOCKET *mx_socket,
 	return MX_SUCCESSFUL_RESULT;
 }
 
+/* mxp_socket_receive_buffered() is used by mx_socket_receive() for sockets
+ * that have an MX receive buffer.  Bytes are received from the socket
+ * directly into the circular buffer and line terminators are looked for
+ * in place there, so only the line that is returned to the caller is
+ * copied.  Anything after the line stays in the buffer for the next call.
+ * A line that fills the caller's buffer or the whole receive buffer
+ * without a line terminator is returned as it is.
+ */
+
+static mx_status_type
+mxp_socket_receive_buffered( MX_SOCKET *mx_socket,
+			MX_CIRCULAR_BUFFER *circular_buffer,
+			char *callers_buffer,
+			size_t callers_buffer_length_in_bytes,
+			size_t *num_bytes_received,
+			char *terminators,
+			size_t num_terminators,
+			double timeout_in_seconds )
+{
+	static const char fname[] = "mxp_socket_receive_buffered()";
+
+	char *first_span, *second_span;
+	unsigned long first_span_length, second_span_length;
+	unsigned long bytes_available, bytes_scanned, line_length;
+	unsigned long bytes_copied, num_terminators_seen, quiet;
+	long bytes_received_from_socket;
+	int saved_errno;
+	char c;
+	mx_bool_type first_time, line_complete;
+	MX_CLOCK_TICK starting_clock_tick, current_clock_tick;
+	double elapsed_time_in_seconds, timeout_left_in_seconds;
+	mx_status_type mx_status;
+
+	if ( num_bytes_received != NULL ) {
+		*num_bytes_received = 0;
+	}
+
+	if ( callers_buffer_length_in_bytes == 0 ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	if ( mx_socket->socket_flags & MXF_SOCKET_QUIET ) {
+		quiet = MXE_QUIET;
+	} else {
+		quiet = 0;
+	}
+
+	bytes_scanned = 0;
+	num_terminators_seen = 0;
+	line_complete = FALSE;
+
+	first_time = TRUE;
+
+	starting_clock_tick = mx_current_clock_tick();
+
+	for (;;) {
+		mx_status = mx_circular_buffer_get_read_spans( circular_buffer,
+					&first_span, &first_span_length,
+					&second_span, &second_span_length );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		bytes_available = first_span_length + second_span_length;
+
+		line_length = 0;
+
+		if ( num_terminators == 0 ) {
+			/* Without line terminators, the caller gets
+			 * whatever has arrived.
+			 */
+
+			if ( bytes_available > callers_buffer_length_in_bytes ) {
+				line_length = callers_buffer_length_in_bytes;
+			} else {
+				line_length = bytes_available;
+			}
+		} else {
+			/* Carry on scanning where the last pass stopped. */
+
+			while ( ( bytes_scanned < bytes_available )
+			  && ( bytes_scanned < callers_buffer_length_in_bytes ) )
+			{
+				if ( bytes_scanned < first_span_length ) {
+					c = first_span[ bytes_scanned ];
+				} else {
+					c = second_span[ bytes_scanned
+							- first_span_length ];
+				}
+
+				bytes_scanned++;
+
+				if ( c == terminators[num_terminators_seen] ) {
+					num_terminators_seen++;
+				} else {
+					num_terminators_seen = 0;
+				}
+
+				if ( num_terminators_seen >= num_terminators ) {
+					line_complete = TRUE;
+					break;
+				}
+			}
+
+			if ( line_complete
+			  || ( bytes_scanned >= callers_buffer_length_in_bytes )
+			  || ( bytes_available >= circular_buffer->buffer_size ) )
+			{
+				line_length = bytes_scanned;
+			}
+		}
+
+		if ( line_length > 0 ) {
+			mx_status = mx_circular_buffer_read( circular_buffer,
+						callers_buffer, line_length,
+						&bytes_copied );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+
+			if ( num_bytes_received != NULL ) {
+				*num_bytes_received = bytes_copied;
+			}
+
+			if ( line_complete ) {
+				/* Overwrite the line terminators and the
+				 * rest of the caller's buffer with null bytes.
+				 */
+
+				memset( callers_buffer + line_length
+						- num_terminators, 0,
+					callers_buffer_length_in_bytes
+						- line_length
+						+ num_terminators );
+			}
+
+			return MX_SUCCESSFUL_RESULT;
+		}
+
+		/* Wait for more bytes to arrive. */
+
+		if ( first_time || ( timeout_in_seconds > 0.0 ) ) {
+
+			first_time = FALSE;
+
+			current_clock_tick = mx_current_clock_tick();
+
+			elapsed_time_in_seconds =
+			    mx_clock_difference_in_seconds( current_clock_tick,
+							starting_clock_tick );
+
+			timeout_left_in_seconds = timeout_in_seconds
+						- elapsed_time_in_seconds;
+
+			if ( timeout_left_in_seconds < 0.0 ) {
+				return mx_error( MXE_TIMED_OUT, fname,
+				"Timed out after waiting %g seconds for "
+				"input from socket %d.",
+					timeout_in_seconds,
+					mx_socket->socket_fd );
+			}
+
+			mx_status = mx_socket_wait_for_event( mx_socket,
+						timeout_left_in_seconds );
+
+			mx_status.code &= ~(MXE_QUIET);
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+		}
+
+		/* Receive straight into the free space in the buffer. */
+
+		mx_status = mx_circular_buffer_get_write_spans( circular_buffer,
+					&first_span, &first_span_length,
+					&second_span, &second_span_length );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		bytes_received_from_socket = recv( mx_socket->socket_fd,
+				first_span, (int) first_span_length, 0 );
+
+#if MX_SOCKET_DEBUG_RECEIVE
+		MX_DEBUG(-2,
+		("%s: socket %d, bytes_received_from_socket = %ld",
+			fname, mx_socket->socket_fd,
+			bytes_received_from_socket ));
+#endif
+
+		switch( bytes_received_from_socket ) {
+		case 0:
+			*callers_buffer = '\0';
+
+			return mx_error(
+			    ( MXE_NETWORK_CONNECTION_LOST | quiet ), fname,
+			    "Network connection closed unexpectedly." );
+			break;
+		case MX_SOCKET_ERROR:
+			saved_errno = mx_socket_get_last_error();
+
+			switch( saved_errno ) {
+			case ECONNRESET:
+			case ECONNABORTED:
+				return mx_error(
+				( MXE_NETWORK_CONNECTION_LOST | quiet ), fname,
+				"Network connection lost for socket %d.",
+					(int) mx_socket->socket_fd );
+				break;
+			case EWOULDBLOCK:
+				return mx_error(
+				( MXE_END_OF_DATA | quiet ), fname,
+				"End of data for socket %d.",
+					(int) mx_socket->socket_fd );
+				break;
+			default:
+				return mx_error(
+				( MXE_NETWORK_IO_ERROR | quiet ), fname,
+			"Error receiving message body from remote host.  "
+			"Errno = %d, error text = '%s'",
+				saved_errno, mx_socket_strerror(saved_errno));
+				break;
+			}
+			break;
+		default:
+			mx_status = mx_circular_buffer_increment_bytes_written(
+					circular_buffer,
+					(unsigned long) bytes_received_from_socket );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+			break;
+		}
+	}
+}
+
 MX_EXPORT mx_status_type
 mx_socket_receive( MX_SOCKET *mx_socket,
 		void *callers_buffer,
@@ -2942,10 +3186,8 @@ mx_socket_receive( MX_SOCKET *mx_socket,
 	char *write_ptr, *scan_ptr, *terminators;
 
 	MX_CIRCULAR_BUFFER *circular_buffer = NULL;
-	char *start_of_next_line = NULL;
 	char *start_of_memory_to_zero = NULL;
-	unsigned long bytes_saved, bytes_peeked_from_buffer;
-	unsigned long num_bytes_to_save, num_bytes_to_zero;
+	unsigned long num_bytes_to_zero;
 	unsigned long socket_flags, quiet;
 	MX_CLOCK_TICK starting_clock_tick, current_clock_tick;
 	double elapsed_time_in_seconds = 0.0;
@@ -2990,6 +3232,16 @@ mx_socket_receive( MX_SOCKET *mx_socket,
 		timeout_in_seconds = DBL_MAX;
 	}
 
+	if ( circular_buffer != (MX_CIRCULAR_BUFFER *) NULL ) {
+		return mxp_socket_receive_buffered( mx_socket, circular_buffer,
+					(char *) callers_buffer,
+					callers_buffer_length_in_bytes,
+					num_bytes_received,
+					terminators,
+					input_terminators_length_in_bytes,
+					timeout_in_seconds );
+	}
+
 	first_time = TRUE;
 
 	starting_clock_tick = mx_current_clock_tick();
@@ -2998,42 +3250,6 @@ mx_socket_receive( MX_SOCKET *mx_socket,
 
 	    bytes_received_from_socket = 0;
 
-	    bytes_peeked_from_buffer = 0;
-
-	    /* First see if there are any bytes left in the circular buffer
-	     * from previous recv() calls.
-	     */
-
-	    if ( socket_flags & MXF_SOCKET_USE_MX_RECEIVE_BUFFER ) {
-		mx_status = mx_circular_buffer_peek( circular_buffer,
-						write_ptr, bytes_left,
-						&bytes_peeked_from_buffer );
-
-		if ( mx_status.code != MXE_SUCCESS )
-		    return mx_status;
-
-		if ( bytes_peeked_from_buffer > bytes_left ) {
-		    return mx_error( MXE_LIMIT_WAS_EXCEEDED, fname,
-			"More bytes (%lu) were read from the circular "
-			"buffer for MX socket %d than were available "
-			"in the caller's message buffer size (%lu).  "
-			"This should not be able to happen.",
-				bytes_peeked_from_buffer,
-				(int) mx_socket->socket_fd,
-				bytes_left );
-		}
-
-		/* Mark the bytes as read. */
-
-		/* FIXME: Why aren't we using mx_circular_buffer_read() here? */
-
-		write_ptr += bytes_peeked_from_buffer;
-
-		bytes_left -= bytes_peeked_from_buffer;
-
-		total_bytes_in_callers_buffer += bytes_peeked_from_buffer;
-	    }
-
 	    /* If there is room available, try reading from the socket itself.*/
 
 	    if ( bytes_left > 0 ) {
@@ -3196,20 +3412,6 @@ mx_socket_receive( MX_SOCKET *mx_socket,
 		 * we received to the caller.
 		 */
 
-		if ( socket_flags & MXF_SOCKET_USE_MX_RECEIVE_BUFFER ) {
-
-		    /* First, tell the circular buffer to treat the bytes
-		     * we peeked as having been read.
-		     */
-
-		    mx_status = mx_circular_buffer_increment_bytes_read(
-						circular_buffer,
-						bytes_peeked_from_buffer );
-
-		    if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
-		}
-
 		/* If requested, tell the caller the number of bytes
 		 * we are sending to it.
 		 */
@@ -3251,93 +3453,8 @@ mx_socket_receive( MX_SOCKET *mx_socket,
 		    }
 
 		    /* If we get here, then we have found the specified
-		     * line terminators in the incoming bytes.  What we
-		     * do next depends on the values of these variables:
-		     *
-		     *      num_bytes_to_send_to_caller
-		     *      bytes_peeked_from_buffer
-		     *      bytes_received_from_socket
-		     */
-
-		    if ( socket_flags & MXF_SOCKET_USE_MX_RECEIVE_BUFFER ) {
-			if (num_bytes_to_send_to_caller
-					<= bytes_peeked_from_buffer)
-			{
-			    /* In this case, all of the bytes we are sending
-			     * to the caller came from the circular buffer.
-			     * Thus, we must increment the circular buffer's
-			     * bytes_read value to match.
-			     *
-			     * We can only get here if no bytes were received
-			     * from the socket, so we do not have to worry about
-			     * handling socket bytes in this case.
-			     */
-
-			    mx_status = mx_circular_buffer_increment_bytes_read(
-						circular_buffer,
-						num_bytes_to_send_to_caller );
-
-			    if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
-			} else {
-
-			    /* All of the bytes we peeked from the circular
-			     * buffer (if any) are going to be sent to the
-			     * caller.  So inform the circular buffer that
-			     * those bytes have been read.
-			     */
-
-			    mx_status = mx_circular_buffer_increment_bytes_read(
-						circular_buffer,
-						bytes_peeked_from_buffer );
-
-			    if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
-
-			    /* Any bytes received from the socket that are not
-			     * going to be sent to the caller need to be saved
-			     * in the circular buffer.
-			     */
-
-			    num_bytes_to_save = total_bytes_in_callers_buffer
-						- num_bytes_to_send_to_caller;
-
-			    start_of_next_line = &scan_ptr[i+1];
-
-#if MX_SOCKET_DEBUG_RECEIVE
-			    MX_DEBUG(-2,("%s: num_bytes_to_save = %ld",
-				fname, num_bytes_to_save));
-			    MX_DEBUG(-2,("%s: start_of_next_line = '%s'",
-				fname, start_of_next_line));
-#endif
-
-			    /* Copy the leftover bytes to the circular buffer.*/
-
-			    mx_status = mx_circular_buffer_write(
-						circular_buffer,
-						start_of_next_line,
-						num_bytes_to_save,
-						&bytes_saved );
-
-			    if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
-
-			    if ( bytes_saved != num_bytes_to_save ) {
-				return mx_error( MXE_DATA_WAS_LOST, fname,
-					"Socket data after the line "
-					"terminators was not fully "
-					"saved to the circular buffer "
-					"for socket %d.  "
-					"Bytes lost = %ld.",
-					    (int) mx_socket->socket_fd,
-					    num_bytes_to_save - bytes_saved);
-			    }
-			}
-		    }
-
-		    /* At this point, we have finished all of our work
-		     * with the circular buffer, so now we can prepare
-		     * to return the line we found to our caller.
+		     * line terminators in the incoming bytes, so now we
+		     * can prepare to return the line we found to our caller.
 		     *
 		     * We do this by overwriting the leftover bytes in
 		     * the caller's buffer (and the line terminators!)
@@ -3391,22 +3508,6 @@ mx_socket_receive( MX_SOCKET *mx_socket,
 	    }
 	}
 
-	if ( socket_flags & MXF_SOCKET_USE_MX_RECEIVE_BUFFER ) {
-
-	    /* We filled the caller's buffer without finding any line
-	     * terminators, so just return what we received.  Make sure
-	     * to tell the circular buffer that the bytes we peeked are
-	     * now read.
-	     */
-
-	    mx_status = mx_circular_buffer_increment_bytes_read(
-						circular_buffer,
-						bytes_peeked_from_buffer );
-
-	    if ( mx_status.code != MXE_SUCCESS )
-		return mx_status;
-	}
-
 	if ( num_bytes_received != NULL ) {
 		*num_bytes_received = total_bytes_in_callers_buffer;
 	}
@@ -143,7 +143,7 @@ extern "C" {
  * required to have socket handlers.
  */
 
-typedef struct {
+typedef struct mx_socket_type {
 	MX_SOCKET_FD socket_fd;
 	unsigned long socket_flags;
 	mx_bool_type is_non_blocking;
@@ -163,6 +163,34 @@ typedef struct {
 	/* MX_SOCKET_HANDLER *socket_handler; */
 
 	void *socket_handler;
+
+	/* Compression of large outgoing MX network messages.  The
+	 * 'compression' field uses the MX_NETWORK_COMPRESSION_... values
+	 * from mx_net.h.  Compressed messages are only accepted from the
+	 * peer if 'accept_compressed_messages' was set when compression
+	 * was negotiated for the connection.
+	 */
+
+	unsigned long compression;
+	unsigned long compression_threshold;
+	mx_bool_type accept_compressed_messages;
+	void *compression_buffer;
+	size_t compression_buffer_length;
+
+	/* MX_NETWORK_SHM *shared_memory; */
+
+	void *shared_memory;
+
+	/* If 'send_hook' is not NULL, the MX network message send functions
+	 * pass the fully prepared message to it rather than writing it to
+	 * the socket themselves.  The message is made up of two segments,
+	 * the second of which may be empty.  MX servers use this to queue
+	 * messages for clients that are not keeping up.
+	 */
+
+	mx_status_type ( *send_hook )( struct mx_socket_type *mx_socket,
+					char **segment_ptr,
+					size_t *segment_length );
 } MX_SOCKET;
 
 /* MX socket types. */
@@ -18,6 +18,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "mx_util.h"
 #include "mx_time.h"
@@ -39,21 +40,47 @@
 			}						\
 		} while (0)
 
+/* On Linux, a master timer can be driven by a timerfd that the caller
+ * waits on in its own event loop, instead of by a POSIX interval timer.
+ */
+
+#if defined(OS_LINUX) && defined(MX_GLIBC_VERSION) \
+	&& ( MX_GLIBC_VERSION >= 2008000L )
+#  define HAVE_TIMERFD	TRUE
+#else
+#  define HAVE_TIMERFD	FALSE
+#endif
+
+#if HAVE_TIMERFD
+#  include <errno.h>
+#  include <unistd.h>
+#  include <sys/timerfd.h>
+#endif
+
 /* The following are typedefs intended for the private usage of this file. */
 
-struct mx_master_timer_event_struct {
-	MX_VIRTUAL_TIMER *vtimer;
-	struct timespec expiration_time;
-	struct mx_master_timer_event_struct *previous_event;
-	struct mx_master_timer_event_struct *next_event;
-};
+/* A virtual timer has at most one pending event at a time.  The pending
+ * events are kept in a binary heap ordered by expiration time, and each
+ * virtual timer records the index of its event in the heap, so that
+ * starting, stopping and expiring a timer all take O(log n) time.
+ */
 
-typedef struct mx_master_timer_event_struct MX_MASTER_TIMER_EVENT;
+typedef struct {
+	struct timespec expiration_time;
+	MX_VIRTUAL_TIMER *vtimer;
+} MX_MASTER_TIMER_EVENT;
 
 typedef struct {
 	MX_MUTEX *mutex;
 	unsigned long num_timer_events;
-	MX_MASTER_TIMER_EVENT *timer_event_list;
+	unsigned long max_timer_events;
+	MX_MASTER_TIMER_EVENT *timer_event_heap;
+
+	/* 'timer_fd' is -1 unless the master timer is driven by a timerfd.
+	 * The timerfd is always armed for the earliest pending event.
+	 */
+
+	int timer_fd;
 } MX_MASTER_TIMER_EVENT_LIST;
 
 /*--------------------------------------------------------------------------*/
@@ -107,7 +134,7 @@ mx_virtual_timer_get_pointers( MX_VIRTUAL_TIMER *vtimer,
 /* WARNING, WARNING, WARNING:
  *
  *    The following functions from mx_show_event_list() to
- *    mx_delete_all_vtimer_events() must all be invoked with
+ *    mx_delete_vtimer_event() must all be invoked with
  *    with the event_list's mutex already LOCKED!!!
  */
 
@@ -119,7 +146,7 @@ mx_show_event_list( const char *calling_fname,
 {
 	static const char fname[] = "mx_show_event_list()";
 
-	MX_MASTER_TIMER_EVENT *current_event;
+	MX_MASTER_TIMER_EVENT *event;
 	unsigned long i;
 
 	MX_DEBUG(-2,("%s invoked for event_list = %p by %s",
@@ -129,394 +156,277 @@ mx_show_event_list( const char *calling_fname,
 		return;
 	}
 
-	current_event = event_list->timer_event_list;
-
 	MX_DEBUG(-2,("Event list %p", event_list));
 	MX_DEBUG(-2,("------------------------------"));
 
-	if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
+	if ( event_list->num_timer_events == 0 ) {
 
 		MX_DEBUG(-2,("---> Event list is empty <---"));
 		return;
 	}
 
-	i = 0;
-
-	for (;;) {
-
-		MX_DEBUG(-2,("Event %lu = %p", i, current_event));
+	for ( i = 0; i < event_list->num_timer_events; i++ ) {
+		event = &(event_list->timer_event_heap[i]);
 
-		current_event = current_event->next_event;
-
-		if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-			MX_DEBUG(-2,("---> End of event list <---"));
-			return;
-		}
-		i++;
+		MX_DEBUG(-2,("Event %lu: vtimer %p, expiration_time = (%lu,%lu)",
+			i, event->vtimer,
+			(unsigned long) event->expiration_time.tv_sec,
+			(unsigned long) event->expiration_time.tv_nsec));
 	}
+
+	MX_DEBUG(-2,("---> End of event list <---"));
 }
 
 #endif /* MX_VIRTUAL_TIMER_DEBUG */
 
-static mx_status_type
-mx_add_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
-			MX_VIRTUAL_TIMER *vtimer,
-			struct timespec timer_interval,
-			int interval_type )
+static void
+mx_place_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
+			unsigned long i,
+			MX_MASTER_TIMER_EVENT *event )
 {
-	static const char fname[] = "mx_add_vtimer_event()";
+	event_list->timer_event_heap[i] = *event;
 
-	MX_MASTER_TIMER_EVENT *new_event;
-	MX_MASTER_TIMER_EVENT *previous_event, *current_event, *next_event;
-	struct timespec current_time;
-	int comparison;
-
-#if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s invoked for event list %p and vtimer %p",
-		fname, event_list, vtimer));
-#endif
-
-	if ( event_list == (MX_MASTER_TIMER_EVENT_LIST *) NULL ) {
-		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_MASTER_TIMER_EVENT_LIST pointer passed was NULL." );
-	}
-
-	if ( vtimer == (MX_VIRTUAL_TIMER *) NULL ) {
-		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_VIRTUAL_TIMER pointer passed was NULL." );
-	}
-
-	if ( (interval_type != MXF_VTIMER_ABSOLUTE_TIME)
-	  && (interval_type != MXF_VTIMER_RELATIVE_TIME) )
-	{
-		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-		"The requested interval type %d is not one of the allowed "
-		"values of MXF_VTIMER_ABSOLUTE_TIME (%d) or "
-		"MXF_VTIMER_RELATIVE_TIME (%d).", interval_type,
-			MXF_VTIMER_ABSOLUTE_TIME, MXF_VTIMER_RELATIVE_TIME );
-	}
+	event->vtimer->event_index = (long) i;
+}
 
-	/* Create an event structure. */
+/* Move the event at index 'i' toward the top of the heap until it is
+ * no earlier than its parent, or down toward the bottom until it is no
+ * later than either of its children.
+ */
 
-	new_event = (MX_MASTER_TIMER_EVENT *)
-			malloc( sizeof(MX_MASTER_TIMER_EVENT) );
+static void
+mx_sift_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list, unsigned long i )
+{
+	MX_MASTER_TIMER_EVENT *heap;
+	MX_MASTER_TIMER_EVENT event;
+	unsigned long parent, child, num_events;
 
-	if ( new_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-		return mx_error( MXE_OUT_OF_MEMORY, fname,
-   "Ran out of memory trying to allocate an MX_MASTER_TIMER_EVENT structure." );
-   	}
+	heap = event_list->timer_event_heap;
+	num_events = event_list->num_timer_events;
 
-	new_event->vtimer = vtimer;
+	event = heap[i];
 
-	/* Compute the absolute time of the event we are adding. */
+	while ( i > 0 ) {
+		parent = ( i - 1 ) / 2;
 
-#if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s: timer_interval = (%lu,%lu), interval_type = %d",
-		fname, (unsigned long) timer_interval.tv_sec,
-		(unsigned long) timer_interval.tv_nsec, interval_type));
-#endif
-
-	switch ( interval_type ) {
-	case MXF_VTIMER_ABSOLUTE_TIME:
-		new_event->expiration_time = timer_interval;
-		break;
-	case MXF_VTIMER_RELATIVE_TIME:
-		current_time = mx_high_resolution_time();
+		if ( mx_compare_timespec_times( event.expiration_time,
+					heap[parent].expiration_time ) >= 0 )
+		{
+			break;
+		}
 
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: current_time = (%lu,%lu)",
-			fname, (unsigned long) current_time.tv_sec,
-			(unsigned long) current_time.tv_nsec));
-#endif
+		mx_place_vtimer_event( event_list, i, &heap[parent] );
 
-		new_event->expiration_time = mx_add_timespec_times(
-					    current_time, timer_interval );
-		break;
+		i = parent;
 	}
 
-#if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s: Created new_event = %p, expiration_time = (%lu,%lu)",
-		fname, new_event,
-		(unsigned long) new_event->expiration_time.tv_sec,
-		(unsigned long) new_event->expiration_time.tv_nsec));
-#endif
-
-	/* If there are no events in the event list, add new_event as the
-	 * only event in the list.
-	 */
-
-	current_event = event_list->timer_event_list;
+	for (;;) {
+		child = 2 * i + 1;
 
-	if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-		new_event->previous_event = NULL;
-		new_event->next_event = NULL;
+		if ( child >= num_events )
+			break;
 
-		event_list->timer_event_list = new_event;
+		if ( ( child + 1 < num_events )
+		  && ( mx_compare_timespec_times( heap[child+1].expiration_time,
+					heap[child].expiration_time ) < 0 ) )
+		{
+			child++;
+		}
 
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: event %p is the only event in the list.",
-			fname, event_list->timer_event_list));
+		if ( mx_compare_timespec_times( heap[child].expiration_time,
+					event.expiration_time ) >= 0 )
+		{
+			break;
+		}
 
-		mx_show_event_list( fname, event_list );
-#endif
+		mx_place_vtimer_event( event_list, i, &heap[child] );
 
-		return MX_SUCCESSFUL_RESULT;
+		i = child;
 	}
 
-	/* Find the correct place in the event list for this event. */
+	mx_place_vtimer_event( event_list, i, &event );
+}
 
-	for (;;) {
+/* Arm the timerfd, if there is one, for the earliest pending event. */
 
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: Top of for(;;) loop, current_event = %p",
-			fname, current_event));
-#endif
+static void
+mx_arm_master_timer_fd( MX_MASTER_TIMER_EVENT_LIST *event_list )
+{
+#if HAVE_TIMERFD
+	static const char fname[] = "mx_arm_master_timer_fd()";
 
-		comparison = mx_compare_timespec_times(
-					new_event->expiration_time,
-					current_event->expiration_time );
+	struct itimerspec new_value;
+	struct timespec current_time, expiration_time;
+	int saved_errno;
 
-		/* If the new event is scheduled to occur before the current
-		 * event, insert the new event here and then return.
-		 */
+	if ( event_list->timer_fd < 0 )
+		return;
 
-		if ( comparison < 0 ) {
-			if ( current_event == event_list->timer_event_list ) {
-				new_event->previous_event = NULL;
-				new_event->next_event = current_event;
+	memset( &new_value, 0, sizeof(new_value) );
 
-				current_event->previous_event = new_event;
-				event_list->timer_event_list = new_event;
+	if ( event_list->num_timer_events > 0 ) {
+		expiration_time =
+			event_list->timer_event_heap[0].expiration_time;
 
-#if MX_VIRTUAL_TIMER_DEBUG
-				MX_DEBUG(-2,
-			("%s: Adding event %p to the start of the list."
-			" event_list->timer_event_list->next_event = %p",
-				    fname, event_list->timer_event_list,
-				    event_list->timer_event_list->next_event));
-#endif
-			} else {
-				previous_event = current_event->previous_event;
+		current_time = mx_high_resolution_time();
 
-				new_event->previous_event = previous_event;
-				new_event->next_event = current_event;
+		if ( mx_compare_timespec_times( expiration_time,
+						current_time ) > 0 )
+		{
+			new_value.it_value = mx_subtract_timespec_times(
+					expiration_time, current_time );
+		} else {
+			/* Already expired, so fire as soon as possible.
+			 * An it_value of zero would disarm the timer.
+			 */
 
-#if MX_VIRTUAL_TIMER_DEBUG
-				MX_DEBUG(-2,
-			("%s: Adding event %p between events %p and %p",
-			fname, new_event, previous_event, current_event));
-#endif
+			new_value.it_value.tv_nsec = 1;
+		}
+	}
 
-				current_event->previous_event = new_event;
-				previous_event->next_event = new_event;
+	if ( timerfd_settime( event_list->timer_fd, 0, &new_value, NULL ) != 0 )
+	{
+		saved_errno = errno;
 
-#if MX_VIRTUAL_TIMER_DEBUG
-				MX_DEBUG(-2,
-			("%s: previous_event->next_event = %p, "
-			"current_event->previous_event = %p",
-				fname, previous_event->next_event,
-				current_event->previous_event));
+		(void) mx_error( MXE_OPERATING_SYSTEM_ERROR, fname,
+		"The attempt to arm timerfd %d failed.  "
+		"Errno = %d, error message = '%s'.",
+			event_list->timer_fd, saved_errno,
+			strerror( saved_errno ) );
+	}
 #endif
-			}
-			return MX_SUCCESSFUL_RESULT;
-		}
+}
 
-		/* Proceed on to the next event in the list. */
+static void
+mx_delete_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
+			MX_VIRTUAL_TIMER *vtimer )
+{
+	unsigned long i, last;
 
-		next_event = current_event->next_event;
+	if ( vtimer->event_index < 0 )
+		return;
 
-		/* If we find that we are at the end of the list, append
-		 * the new event here.
-		 */
+	i = (unsigned long) vtimer->event_index;
 
-		if ( next_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-			new_event->next_event = NULL;
-			new_event->previous_event = current_event;
-			current_event->next_event = new_event;
+	vtimer->event_index = -1;
 
-#if MX_VIRTUAL_TIMER_DEBUG
-			MX_DEBUG(-2,
-			("%s: Appending event %p at the end of the list.  "
-			"current_event->next_event = %p, "
-			"new_event->previous_event = %p",
-				fname, new_event,
-				current_event->next_event,
-				new_event->previous_event));
-
-			mx_show_event_list( fname, event_list );
-#endif
+	last = event_list->num_timer_events - 1;
 
-			return MX_SUCCESSFUL_RESULT;
-		}
+	event_list->num_timer_events--;
 
-		/* Otherwise, we must keep going. */
+	if ( i != last ) {
+		mx_place_vtimer_event( event_list, i,
+				&(event_list->timer_event_heap[last]) );
 
-		current_event = next_event;
+		mx_sift_vtimer_event( event_list, i );
 	}
 
-#if defined(OS_HPUX) && defined(__hppa)
-	return MX_SUCCESSFUL_RESULT;
+#if MX_VIRTUAL_TIMER_DEBUG
+	mx_show_event_list( "mx_delete_vtimer_event()", event_list );
 #endif
 }
 
 static mx_status_type
-mx_get_next_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
+mx_add_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
 			MX_VIRTUAL_TIMER *vtimer,
-			MX_MASTER_TIMER_EVENT *current_vtimer_event,
-			MX_MASTER_TIMER_EVENT **next_vtimer_event )
+			struct timespec timer_interval,
+			int interval_type )
 {
-	static const char fname[] = "mx_get_next_vtimer_event()";
+	static const char fname[] = "mx_add_vtimer_event()";
 
-	MX_MASTER_TIMER_EVENT *current_event;
+	MX_MASTER_TIMER_EVENT new_event;
+	MX_MASTER_TIMER_EVENT *new_heap;
+	unsigned long new_max_events;
+	struct timespec current_time;
 
 #if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s invoked for event list = %p", fname, event_list));
-	MX_DEBUG(-2,("%s: vtimer = %p, current_vtimer_event = %p",
-		fname, vtimer, current_vtimer_event));
+	MX_DEBUG(-2,("%s invoked for event list %p and vtimer %p",
+		fname, event_list, vtimer));
 #endif
 
-	if ( vtimer == (MX_VIRTUAL_TIMER *) NULL ) {
+	if ( event_list == (MX_MASTER_TIMER_EVENT_LIST *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_VIRTUAL_TIMER pointer passed was NULL." );
+		"The MX_MASTER_TIMER_EVENT_LIST pointer passed was NULL." );
 	}
 
-	if ( next_vtimer_event == (MX_MASTER_TIMER_EVENT **) NULL ) {
+	if ( vtimer == (MX_VIRTUAL_TIMER *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The next_vtimer_event pointer passed was NULL." );
+		"The MX_VIRTUAL_TIMER pointer passed was NULL." );
 	}
 
-	if ( current_vtimer_event != (MX_MASTER_TIMER_EVENT *) NULL ) {
-		current_event = current_vtimer_event->next_event;
-	} else {
-		/* Specify the first event in the event list. */
-
-		if ( event_list == (MX_MASTER_TIMER_EVENT_LIST *) NULL ) {
-			return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-			"The event_list and the current_vtimer_event pointers "
-			"passed to this function cannot _both_ be NULL." );
-		}
-
-		current_event = event_list->timer_event_list;
+	new_event.vtimer = vtimer;
 
-		if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-			/* This event list does not have any events right now.*/
-
-			*next_vtimer_event = NULL;
+	/* Compute the absolute time of the event we are adding. */
 
 #if MX_VIRTUAL_TIMER_DEBUG
-			MX_DEBUG(-2,
-			("%s: No events in this event list.", fname));
+	MX_DEBUG(-2,("%s: timer_interval = (%lu,%lu), interval_type = %d",
+		fname, (unsigned long) timer_interval.tv_sec,
+		(unsigned long) timer_interval.tv_nsec, interval_type));
 #endif
 
-			return MX_SUCCESSFUL_RESULT;
-		}
+	switch ( interval_type ) {
+	case MXF_VTIMER_ABSOLUTE_TIME:
+		new_event.expiration_time = timer_interval;
+		break;
+	case MXF_VTIMER_RELATIVE_TIME:
+		current_time = mx_high_resolution_time();
+
+		new_event.expiration_time = mx_add_timespec_times(
+					    current_time, timer_interval );
+		break;
+	default:
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The requested interval type %d is not one of the allowed "
+		"values of MXF_VTIMER_ABSOLUTE_TIME (%d) or "
+		"MXF_VTIMER_RELATIVE_TIME (%d).", interval_type,
+			MXF_VTIMER_ABSOLUTE_TIME, MXF_VTIMER_RELATIVE_TIME );
 	}
 
-	for (;;) {
+	/* A virtual timer only has one pending event at a time. */
 
-		if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-			/* This event list has no more events in it. */
+	mx_delete_vtimer_event( event_list, vtimer );
 
-			*next_vtimer_event = NULL;
+	if ( event_list->num_timer_events >= event_list->max_timer_events ) {
 
-#if MX_VIRTUAL_TIMER_DEBUG
-			MX_DEBUG(-2,
-			("%s: No more events in this event list.", fname));
-#endif
+		new_max_events = 2 * event_list->max_timer_events;
 
-			return MX_SUCCESSFUL_RESULT;
+		if ( new_max_events < 16 ) {
+			new_max_events = 16;
 		}
 
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,
-		("%s: current_event = %p, current_event->vtimer = %p",
-			fname, current_event, current_event->vtimer));
-#endif
-
-		if ( current_event->vtimer == vtimer ) {
-			/* We have a match, so return this event. */
-
-			*next_vtimer_event = current_event;
+		new_heap = (MX_MASTER_TIMER_EVENT *) realloc(
+				event_list->timer_event_heap,
+				new_max_events * sizeof(MX_MASTER_TIMER_EVENT) );
 
-#if MX_VIRTUAL_TIMER_DEBUG
-			MX_DEBUG(-2,("%s: FOUND ---> next_vtimer_event = %p",
-				fname, *next_vtimer_event));
-#endif
-
-			return MX_SUCCESSFUL_RESULT;
+		if ( new_heap == (MX_MASTER_TIMER_EVENT *) NULL ) {
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to expand the timer event "
+			"list %p to %lu events.", event_list, new_max_events );
 		}
 
-		current_event = current_event->next_event;
+		event_list->timer_event_heap = new_heap;
+		event_list->max_timer_events = new_max_events;
 	}
 
-#if defined(OS_HPUX) && defined(__hppa)
-	return MX_SUCCESSFUL_RESULT;
-#endif
-}
+	event_list->num_timer_events++;
 
-static mx_status_type
-mx_delete_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
-			MX_MASTER_TIMER_EVENT *current_event )
-{
-	static const char fname[] = "mx_delete_vtimer_event()";
+	mx_place_vtimer_event( event_list,
+			event_list->num_timer_events - 1, &new_event );
 
-	MX_MASTER_TIMER_EVENT *previous_event, *next_event;
+	mx_sift_vtimer_event( event_list, event_list->num_timer_events - 1 );
 
-#if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s invoked for event list %p and event %p",
-		fname, event_list, current_event));
-#endif
+	/* If this is now the earliest event, the timerfd must be rearmed. */
 
-	if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_MASTER_TIMER_EVENT pointer passed was NULL." );
-	}
-
-	previous_event = current_event->previous_event;
-
-	next_event = current_event->next_event;
-
-#if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s: previous_event = %p, next_event = %p",
-		fname, previous_event, next_event));
-#endif
-
-	if ( current_event == event_list->timer_event_list ) {
-		event_list->timer_event_list = next_event;
-
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: current_event = %p is at the start of the "
-		"event list.  Set event list start to next event = %p",
-		fname, current_event, event_list->timer_event_list));
-#endif
+	if ( vtimer->event_index == 0 ) {
+		mx_arm_master_timer_fd( event_list );
 	}
 
-	if ( next_event != (MX_MASTER_TIMER_EVENT *) NULL ) {
-		next_event->previous_event = previous_event;
-
 #if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: Set next_event->previous_event to %p",
-			fname, next_event->previous_event));
-#endif
-	}
-
-	if ( previous_event != (MX_MASTER_TIMER_EVENT *) NULL ) {
-		previous_event->next_event = next_event;
-
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: Set previous_event->next_event to %p",
-			fname, previous_event->next_event));
-#endif
-	}
-
-#if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s: About to free event %p", fname, current_event));
-#endif
-
-	mx_free( current_event );
-
-#if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s: Finished freeing event", fname));
+	MX_DEBUG(-2,("%s: Added event for vtimer %p at index %ld, "
+		"expiration_time = (%lu,%lu)", fname, vtimer,
+		vtimer->event_index,
+		(unsigned long) new_event.expiration_time.tv_sec,
+		(unsigned long) new_event.expiration_time.tv_nsec));
 
 	mx_show_event_list( fname, event_list );
 #endif
@@ -524,99 +434,42 @@ mx_delete_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
 	return MX_SUCCESSFUL_RESULT;
 }
 
-static mx_status_type
-mx_delete_all_vtimer_events( MX_MASTER_TIMER_EVENT_LIST *event_list,
-				MX_VIRTUAL_TIMER *vtimer )
+static double
+mx_get_vtimer_seconds_left( MX_MASTER_TIMER_EVENT_LIST *event_list,
+			MX_VIRTUAL_TIMER *vtimer )
 {
-#if MX_VIRTUAL_TIMER_DEBUG
-	static const char fname[] = "mx_delete_all_vtimer_events()";
-#endif
-
-	MX_MASTER_TIMER_EVENT *current_event, *next_event;
-	mx_status_type mx_status;
-
-#if MX_VIRTUAL_TIMER_DEBUG
-	unsigned long i;
-
-	MX_DEBUG(-2,("*****************************************************"));
-	MX_DEBUG(-2,("%s invoked for event list %p and vtimer %p",
-		fname, event_list, vtimer));
-
-	mx_show_event_list( fname, event_list );
-#endif
-
-	/* Look for the first event in the linked list for this timer. */
-
-	mx_status = mx_get_next_vtimer_event( event_list, vtimer,
-						NULL, &next_event );
-
-	if ( mx_status.code != MXE_SUCCESS )
-		return mx_status;
-
-	if ( next_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-		/* There are no outstanding events for this timer,
-		 * so just return.
-		 */
-
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,
-		("%s: No events to delete for this vtimer.", fname));
-#endif
-
-		return MX_SUCCESSFUL_RESULT;
-	}
-
-	/* Loop through the event list looking for events for this vtimer. */
-
-#if MX_VIRTUAL_TIMER_DEBUG
-	i = 0;
-#endif
-
-	while ( next_event != (MX_MASTER_TIMER_EVENT *) NULL ) {
-
-		current_event = next_event;
-
-		/* Find the next event. */
-
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: finding next event for event #%lu = %p",
-			fname, i, current_event));
-#endif
-
-		mx_status = mx_get_next_vtimer_event( event_list, vtimer,
-						current_event, &next_event );
-
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
+	struct timespec current_time, expiration_time, time_difference;
 
-		/* Delete the current event from the event list. */
+	if ( vtimer->event_index < 0 )
+		return 0.0;
 
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: deleting event #%lu = %p",
-			fname, i, current_event));
-#endif
+	expiration_time =
+		event_list->timer_event_heap[ vtimer->event_index ].expiration_time;
 
-		mx_status = mx_delete_vtimer_event( event_list, current_event );
+	current_time = mx_high_resolution_time();
 
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
+	if ( mx_compare_timespec_times( current_time, expiration_time ) >= 0 )
+		return 0.0;
 
-#if MX_VIRTUAL_TIMER_DEBUG
-		i++;
-#endif
-	}
+	time_difference = mx_subtract_timespec_times(
+				expiration_time, current_time );
 
-	return MX_SUCCESSFUL_RESULT;
+	return mx_convert_timespec_time_to_seconds( time_difference );
 }
 
 /*--------------------------------------------------------------------------*/
 
+/* Run the virtual timers that have expired.  If 'wait_for_lock' is FALSE
+ * and somebody else has the event list locked, we return and let the
+ * next tick of a periodic master timer try again.
+ */
+
 static void
-mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
+mx_process_vtimer_events( MX_MASTER_TIMER_EVENT_LIST *event_list,
+			mx_bool_type wait_for_lock )
 {
-	static const char fname[] = "mx_master_timer_callback_function()";
+	static const char fname[] = "mx_process_vtimer_events()";
 
-	MX_MASTER_TIMER_EVENT_LIST *event_list;
 	MX_MASTER_TIMER_EVENT *current_event;
 	MX_VIRTUAL_TIMER *vtimer;
 	struct timespec current_time, expiration_time, new_expiration_time;
@@ -626,20 +479,17 @@ mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
 
 #if MX_VIRTUAL_TIMER_DEBUG_MASTER_CALLBACK
 	MX_DEBUG(-2,("vvv------------------------------------------------vvv"));
-	MX_DEBUG(-2,("%s invoked for itimer = %p, args = %p",
-		fname, itimer, args));
-#endif
-
-	event_list = (MX_MASTER_TIMER_EVENT_LIST *) args;
-
-#if MX_VIRTUAL_TIMER_DEBUG_MASTER_CALLBACK
 	MX_DEBUG(-2,("%s: num_timer_events = %lu",
 		fname, event_list->num_timer_events));
 #endif
 
 	/* Attempt to lock the mutex for the timer event list. */
 
-	lock_status = mx_mutex_trylock( event_list->mutex );
+	if ( wait_for_lock ) {
+		lock_status = mx_mutex_lock( event_list->mutex );
+	} else {
+		lock_status = mx_mutex_trylock( event_list->mutex );
+	}
 
 	switch( lock_status ) {
 	case MXE_SUCCESS:
@@ -679,18 +529,9 @@ mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
 
 	current_time = mx_high_resolution_time();
 
-	for (;;) {
-		current_event = event_list->timer_event_list;
-
-#if MX_VIRTUAL_TIMER_DEBUG_MASTER_CALLBACK
-		MX_DEBUG(-2,("%s: current_event = %p", fname, current_event));
-#endif
+	while ( event_list->num_timer_events > 0 ) {
 
-		if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-			/* We have reached the end of the event list. */
-
-			break;	/* Exit the for(;;) loop. */
-		}
+		current_event = &(event_list->timer_event_heap[0]);
 
 		expiration_time = current_event->expiration_time;
 
@@ -706,26 +547,25 @@ mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
 #endif
 
 		if ( comparison < 0 ) {
-			/* If this event is scheduled to happen in the future,
-			 * stop processing the event list at this point.
+			/* If the earliest event is scheduled to happen in
+			 * the future, then we are done.
 			 */
 
-			break;	/* Exit the for(;;) loop. */
+			break;	/* Exit the while() loop. */
 		}
 
-		/* If the virtual timer is a periodic timer, then schedule
-		 * the next event.
-		 */
-
 		vtimer = current_event->vtimer;
 
-		if ( vtimer == (MX_VIRTUAL_TIMER *) NULL ) {
-			(void) mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-			"The MX_VIRTUAL_TIMER pointer for event %p is NULL.",
-				current_event );
+		/* Remove the event before invoking the callback, so that
+		 * the callback is free to restart, stop or destroy the
+		 * virtual timer.
+		 */
 
-			break;	/* Exit the for(;;) loop. */
-		}
+		mx_delete_vtimer_event( event_list, vtimer );
+
+		/* If the virtual timer is a periodic timer, then schedule
+		 * the next event.
+		 */
 
 		if ( vtimer->timer_type == MXIT_PERIODIC_TIMER ) {
 
@@ -744,7 +584,7 @@ mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
 						MXF_VTIMER_ABSOLUTE_TIME );
 
 			if ( mx_status.code != MXE_SUCCESS ) {
-				break;	/* Exit the for(;;) loop. */
+				break;	/* Exit the while() loop. */
 			}
 
 #if MX_VIRTUAL_TIMER_DEBUG_MASTER_CALLBACK
@@ -758,28 +598,15 @@ mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
 		
 		/* Invoke the callback function if there is one. */
 
-		vtimer = current_event->vtimer;
-
-		if ( vtimer != (MX_VIRTUAL_TIMER *) NULL ) {
+		if ( vtimer->callback_function != NULL ) {
 
-			if ( vtimer->callback_function != NULL ) {
-
-				(vtimer->callback_function)( vtimer,
-							vtimer->callback_args );
-			}
-		}
-
-		/* We are done with this event, so delete it
-		 * from the event list.
-		 */
-
-		mx_status = mx_delete_vtimer_event( event_list, current_event );
-
-		if ( mx_status.code != MXE_SUCCESS ) {
-			break;	/* Exit the for(;;) loop. */
+			(vtimer->callback_function)( vtimer,
+						vtimer->callback_args );
 		}
 	}
 
+	mx_arm_master_timer_fd( event_list );
+
 	/* We are done, so unlock the event list before returning. */
 
 	UNLOCK_EVENT_LIST(event_list);
@@ -793,45 +620,76 @@ mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
 	return;
 }
 
-/*--------------------------------------------------------------------------*/
-
-MX_EXPORT mx_status_type
-mx_virtual_timer_create_master( MX_INTERVAL_TIMER **master_timer,
-				double master_timer_period_in_seconds )
+static void
+mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
 {
-	static const char fname[] = "mx_virtual_timer_create_master()";
+#if MX_VIRTUAL_TIMER_DEBUG_MASTER_CALLBACK
+	static const char fname[] = "mx_master_timer_callback_function()";
 
-	MX_MASTER_TIMER_EVENT_LIST *event_list;
-	mx_status_type mx_status;
+	MX_DEBUG(-2,("%s invoked for itimer = %p, args = %p",
+		fname, itimer, args));
+#endif
 
-	MX_DEBUG( 2,("%s invoked.", fname));
+	mx_process_vtimer_events( (MX_MASTER_TIMER_EVENT_LIST *) args, FALSE );
+}
 
-	if ( master_timer == (MX_INTERVAL_TIMER **) NULL ) {
-		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_INTERVAL_TIMER pointer passed was NULL." );
-	}
+static mx_status_type
+mx_create_master_timer_event_list( MX_MASTER_TIMER_EVENT_LIST **event_list )
+{
+	static const char fname[] = "mx_create_master_timer_event_list()";
+
+	mx_status_type mx_status;
 
 	/* Create a list of future virtual timer events that are to be
-	 * processed by the real interval timer.
+	 * processed by the master timer.
 	 */
 
-	event_list = (MX_MASTER_TIMER_EVENT_LIST *)
+	*event_list = (MX_MASTER_TIMER_EVENT_LIST *)
 				malloc( sizeof(MX_MASTER_TIMER_EVENT_LIST) );
 
-	if ( event_list == (MX_MASTER_TIMER_EVENT_LIST *) NULL ) {
+	if ( *event_list == (MX_MASTER_TIMER_EVENT_LIST *) NULL ) {
 		return mx_error( MXE_OUT_OF_MEMORY, fname,
 			"Ran out of memory trying to allocate an "
 			"MX_MASTER_TIMER_EVENT_LIST structure." );
 	}
 
-	/* Initialize the list of future virtual timer events to be 0 and
+	/* Initialize the list of future virtual timer events to be empty and
 	 * create a mutex to manage access to the virtual timer event list.
 	 */
 
-	event_list->num_timer_events = 0;
-	event_list->timer_event_list = NULL;
+	(*event_list)->num_timer_events = 0;
+	(*event_list)->max_timer_events = 0;
+	(*event_list)->timer_event_heap = NULL;
+	(*event_list)->timer_fd = -1;
+
+	mx_status = mx_mutex_create( &((*event_list)->mutex) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_free( *event_list );
+	}
+
+	return mx_status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_virtual_timer_create_master( MX_INTERVAL_TIMER **master_timer,
+				double master_timer_period_in_seconds )
+{
+	static const char fname[] = "mx_virtual_timer_create_master()";
+
+	MX_MASTER_TIMER_EVENT_LIST *event_list;
+	mx_status_type mx_status;
+
+	MX_DEBUG( 2,("%s invoked.", fname));
+
+	if ( master_timer == (MX_INTERVAL_TIMER **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_INTERVAL_TIMER pointer passed was NULL." );
+	}
 
-	mx_status = mx_mutex_create( &(event_list->mutex) );
+	mx_status = mx_create_master_timer_event_list( &event_list );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
@@ -855,11 +713,146 @@ mx_virtual_timer_create_master( MX_INTERVAL_TIMER **master_timer,
 	return mx_status;
 }
 
+MX_EXPORT mx_status_type
+mx_virtual_timer_create_fd_master( MX_INTERVAL_TIMER **master_timer )
+{
+	static const char fname[] = "mx_virtual_timer_create_fd_master()";
+
+#if HAVE_TIMERFD
+	MX_MASTER_TIMER_EVENT_LIST *event_list;
+	int saved_errno;
+	mx_status_type mx_status;
+
+	if ( master_timer == (MX_INTERVAL_TIMER **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_INTERVAL_TIMER pointer passed was NULL." );
+	}
+
+	mx_status = mx_create_master_timer_event_list( &event_list );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	event_list->timer_fd = timerfd_create( CLOCK_MONOTONIC,
+					TFD_NONBLOCK | TFD_CLOEXEC );
+
+	if ( event_list->timer_fd < 0 ) {
+		saved_errno = errno;
+
+		(void) mx_mutex_destroy( event_list->mutex );
+		mx_free( event_list );
+
+		return mx_error( MXE_OPERATING_SYSTEM_ERROR, fname,
+		"The attempt to create a timerfd failed.  "
+		"Errno = %d, error message = '%s'.",
+			saved_errno, strerror( saved_errno ) );
+	}
+
+	/* The MX_INTERVAL_TIMER structure is only used to hold the event
+	 * list for the virtual timers.  No real interval timer is created.
+	 */
+
+	*master_timer = (MX_INTERVAL_TIMER *)
+				calloc( 1, sizeof(MX_INTERVAL_TIMER) );
+
+	if ( *master_timer == (MX_INTERVAL_TIMER *) NULL ) {
+		(void) close( event_list->timer_fd );
+		(void) mx_mutex_destroy( event_list->mutex );
+		mx_free( event_list );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an "
+		"MX_INTERVAL_TIMER structure." );
+	}
+
+	(*master_timer)->timer_type = MXIT_ONE_SHOT_TIMER;
+	(*master_timer)->callback_function = mx_master_timer_callback_function;
+	(*master_timer)->callback_args = event_list;
+	(*master_timer)->private_ptr = NULL;
+
+	return MX_SUCCESSFUL_RESULT;
+#else
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"File descriptor based master timers are not supported "
+	"on this platform." );
+#endif
+}
+
+MX_EXPORT mx_status_type
+mx_virtual_timer_get_master_fd( MX_INTERVAL_TIMER *master_timer, int *fd )
+{
+	static const char fname[] = "mx_virtual_timer_get_master_fd()";
+
+	MX_MASTER_TIMER_EVENT_LIST *event_list;
+
+	if ( master_timer == (MX_INTERVAL_TIMER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_INTERVAL_TIMER pointer passed was NULL." );
+	}
+	if ( fd == (int *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The file descriptor pointer passed was NULL." );
+	}
+
+	event_list = master_timer->callback_args;
+
+	if ( event_list == (MX_MASTER_TIMER_EVENT_LIST *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_MASTER_TIMER_EVENT_LIST pointer for "
+		"master timer %p is NULL.", master_timer );
+	}
+
+	*fd = event_list->timer_fd;
+
+	if ( *fd < 0 ) {
+		return mx_error( MXE_NOT_FOUND | MXE_QUIET, fname,
+		"Master timer %p is not driven by a file descriptor.",
+			master_timer );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT mx_status_type
+mx_virtual_timer_handle_master_fd( MX_INTERVAL_TIMER *master_timer )
+{
+#if HAVE_TIMERFD
+	MX_MASTER_TIMER_EVENT_LIST *event_list;
+	uint64_t num_expirations;
+	int fd;
+	mx_status_type mx_status;
+
+	mx_status = mx_virtual_timer_get_master_fd( master_timer, &fd );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	event_list = master_timer->callback_args;
+
+	/* Clear the readable state of the timerfd.  The read fails with
+	 * EAGAIN if the timer has not expired, which is harmless.
+	 */
+
+	(void) read( fd, &num_expirations, sizeof(num_expirations) );
+
+	mx_process_vtimer_events( event_list, TRUE );
+
+	return MX_SUCCESSFUL_RESULT;
+#else
+	static const char fname[] = "mx_virtual_timer_handle_master_fd()";
+
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"File descriptor based master timers are not supported "
+	"on this platform." );
+#endif
+}
+
 MX_EXPORT mx_status_type
 mx_virtual_timer_destroy_master( MX_INTERVAL_TIMER *master_timer )
 {
 	static const char fname[] = "mx_virtual_timer_destroy_master()";
 
+	MX_MASTER_TIMER_EVENT_LIST *event_list;
 	mx_status_type mx_status;
 
 	MX_DEBUG( 2,("%s invoked.", fname));
@@ -869,6 +862,28 @@ mx_virtual_timer_destroy_master( MX_INTERVAL_TIMER *master_timer )
 		"The MX_INTERVAL_TIMER pointer passed was NULL." );
 	}
 
+	event_list = master_timer->callback_args;
+
+#if HAVE_TIMERFD
+	if ( ( event_list != (MX_MASTER_TIMER_EVENT_LIST *) NULL )
+	  && ( event_list->timer_fd >= 0 ) )
+	{
+		/* Nothing else can use the event list once the timerfd
+		 * is closed, so it can be freed here.
+		 */
+
+		(void) close( event_list->timer_fd );
+
+		(void) mx_mutex_destroy( event_list->mutex );
+
+		mx_free( event_list->timer_event_heap );
+		mx_free( event_list );
+		mx_free( master_timer );
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+#endif
+
 	mx_status = mx_interval_timer_stop( master_timer, NULL );
 
 	if ( mx_status.code != MXE_SUCCESS )
@@ -915,6 +930,7 @@ mx_virtual_timer_create( MX_VIRTUAL_TIMER **vtimer,
 	(*vtimer)->callback_function = callback_function;
 	(*vtimer)->callback_args = callback_args;
 	(*vtimer)->private_ptr = NULL;
+	(*vtimer)->event_index = -1;
 
 	return MX_SUCCESSFUL_RESULT;
 }
@@ -951,7 +967,6 @@ mx_virtual_timer_is_busy( MX_VIRTUAL_TIMER *vtimer,
 
 	MX_INTERVAL_TIMER *master_timer;
 	MX_MASTER_TIMER_EVENT_LIST *event_list;
-	MX_MASTER_TIMER_EVENT *next_event;
 	long lock_status;
 	mx_status_type mx_status;
 
@@ -979,21 +994,9 @@ mx_virtual_timer_is_busy( MX_VIRTUAL_TIMER *vtimer,
 			master_timer, vtimer );
 	}
 
-	/* See if there are any scheduled events for this timer. */
+	/* The timer is busy if it has a pending event. */
 
-	mx_status = mx_get_next_vtimer_event( event_list, vtimer,
-						NULL, &next_event );
-
-	if ( mx_status.code != MXE_SUCCESS ) {
-		UNLOCK_EVENT_LIST( event_list );
-		return mx_status;
-	}
-
-	/* If a next_event structure is returned, then the timer is still
-	 * busy.  Otherwise, it is not busy.
-	 */
-
-	if ( next_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
+	if ( vtimer->event_index < 0 ) {
 		*busy = FALSE;
 	} else {
 		*busy = TRUE;
@@ -1102,16 +1105,9 @@ mx_virtual_timer_start( MX_VIRTUAL_TIMER *vtimer,
 	}
 #endif
 
-	/* Get rid of any old events due to this virtual timer. */
-
-	mx_status = mx_delete_all_vtimer_events( event_list, vtimer );
-
-	if ( mx_status.code != MXE_SUCCESS ) {
-		UNLOCK_EVENT_LIST( event_list );
-		return mx_status;
-	}
-
-	/* Add a list entry for the next virtual timer event. */
+	/* Schedule the next virtual timer event.  This replaces any
+	 * event that was already pending for this virtual timer.
+	 */
 
 	mx_status = mx_add_vtimer_event( event_list,
 					vtimer, vtimer->timer_period,
@@ -1137,22 +1133,44 @@ mx_virtual_timer_stop( MX_VIRTUAL_TIMER *vtimer,
 {
 	static const char fname[] = "mx_virtual_timer_stop()";
 
+	MX_INTERVAL_TIMER *master_timer;
 	MX_MASTER_TIMER_EVENT_LIST *event_list;
+	long lock_status;
 	mx_status_type mx_status;
 
+	master_timer = NULL;
 	event_list = NULL;
 
 	mx_status = mx_virtual_timer_get_pointers( vtimer,
-					NULL, &event_list, fname );
+					&master_timer, &event_list, fname );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
 	MX_DEBUG( 2,("%s invoked for vtimer %p.", fname, vtimer));
 
-	mx_status = mx_delete_all_vtimer_events( event_list, vtimer );
+	/* Get exclusive access to the master timer event list. */
 
-	return mx_status;
+	lock_status = mx_mutex_lock( event_list->mutex );
+
+	if ( lock_status != MXE_SUCCESS ) {
+		/* The mutex is not locked, so just return an error. */
+
+		return mx_error( lock_status, fname,
+			"Unable to lock the mutex for the event list of "
+			"master timer %p used by virtual timer %p",
+			master_timer, vtimer );
+	}
+
+	if ( seconds_left != (double *) NULL ) {
+		*seconds_left = mx_get_vtimer_seconds_left( event_list, vtimer );
+	}
+
+	mx_delete_vtimer_event( event_list, vtimer );
+
+	UNLOCK_EVENT_LIST( event_list );
+
+	return MX_SUCCESSFUL_RESULT;
 }
 
 MX_EXPORT mx_status_type
@@ -1163,9 +1181,6 @@ mx_virtual_timer_read( MX_VIRTUAL_TIMER *vtimer,
 
 	MX_INTERVAL_TIMER *master_timer;
 	MX_MASTER_TIMER_EVENT_LIST *event_list;
-	MX_MASTER_TIMER_EVENT *next_event;
-	struct timespec current_time, expiration_time, time_difference;
-	int comparison;
 	long lock_status;
 	mx_status_type mx_status;
 
@@ -1193,41 +1208,8 @@ mx_virtual_timer_read( MX_VIRTUAL_TIMER *vtimer,
 			master_timer, vtimer );
 	}
 
-	/* See if there are any scheduled events for this timer. */
-
-	mx_status = mx_get_next_vtimer_event( event_list, vtimer,
-						NULL, &next_event );
-
-	if ( mx_status.code != MXE_SUCCESS ) {
-		UNLOCK_EVENT_LIST( event_list );
-		return mx_status;
-	}
-
-	/* If a next_event structure is returned, then the timer is still
-	 * busy, so we must extract the number of seconds until the next
-	 * expiration time.
-	 */
-
-	if ( next_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-		*seconds_till_expiration = 0.0;
-	} else {
-		current_time = mx_high_resolution_time();
-
-		expiration_time = next_event->expiration_time;
-
-		comparison = mx_compare_timespec_times( current_time,
-							expiration_time );
-
-		if ( comparison >= 0 ) {
-			*seconds_till_expiration = 0.0;
-		} else {
-			time_difference = mx_subtract_timespec_times(
-					expiration_time, current_time );
-
-			*seconds_till_expiration =
-			  mx_convert_timespec_time_to_seconds(time_difference);
-		}
-	}
+	*seconds_till_expiration =
+		mx_get_vtimer_seconds_left( event_list, vtimer );
 
 	UNLOCK_EVENT_LIST( event_list );
 
@@ -37,6 +37,12 @@ struct mx_virtual_timer_struct {
 				void *callback_args );
 	void *callback_args;
 	void *private_ptr;
+
+	/* Index of the pending event for this timer in the master timer's
+	 * event heap, or -1 if the timer is not running.
+	 */
+
+	long event_index;
 };
 
 typedef struct mx_virtual_timer_struct MX_VIRTUAL_TIMER;
@@ -53,6 +59,25 @@ mx_virtual_timer_create_master( MX_INTERVAL_TIMER **master_timer,
 MX_API mx_status_type
 mx_virtual_timer_destroy_master( MX_INTERVAL_TIMER *master_timer );
 
+/* A file descriptor master timer does not use a signal or a thread.
+ * Instead, the caller waits for the file descriptor returned by
+ * mx_virtual_timer_get_master_fd() to become readable and then calls
+ * mx_virtual_timer_handle_master_fd() to run the virtual timers that
+ * have expired.  The file descriptor is only armed for the next virtual
+ * timer that is due, so an idle master timer causes no wakeups.
+ *
+ * These functions return MXE_UNSUPPORTED on platforms without timerfd.
+ */
+
+MX_API mx_status_type
+mx_virtual_timer_create_fd_master( MX_INTERVAL_TIMER **master_timer );
+
+MX_API mx_status_type
+mx_virtual_timer_get_master_fd( MX_INTERVAL_TIMER *master_timer, int *fd );
+
+MX_API mx_status_type
+mx_virtual_timer_handle_master_fd( MX_INTERVAL_TIMER *master_timer );
+
 /*----*/
 
 MX_API mx_status_type
@@ -126,10 +126,15 @@ mxn_tcpip_server_create_record_structures( MX_RECORD *record )
 
 	network_server->callback_list = NULL;
 
+	network_server->async_request_list = NULL;
+
 	MX_DEBUG( 2,("%s: MX_WORDSIZE = %d, MX_PROGRAM_MODEL = %#x",
 		fname, MX_WORDSIZE, MX_PROGRAM_MODEL));
 
 	network_server->use_64bit_network_longs = FALSE;
+	network_server->compression = MX_NETWORK_COMPRESSION_NONE;
+	network_server->use_shared_memory = FALSE;
+	network_server->server_supports_batch_messages = FALSE;
 
 	network_server->connection_status = 0;
 
@@ -198,6 +203,7 @@ mxn_tcpip_server_open( MX_RECORD *record )
 	unsigned long version_major, version_minor, version_update;
 	uint64_t      version_time;
 	unsigned long flags, requested_data_format, socket_flags;
+	unsigned long compression;
 	long mx_status_code;
 	unsigned long network_debug_flags;
 	mx_bool_type quiet_open;
@@ -385,6 +391,7 @@ mxn_tcpip_server_open( MX_RECORD *record )
 
 	network_server->remote_mx_version = MXT_REMOTE_MX_VERSION_UNKNOWN;
 	network_server->remote_mx_version_time = 0UL;
+	network_server->server_supports_batch_messages = FALSE;
 	version = 0UL;
 
 	/* Warning: You _MUST_ use mx_get_by_name() to get the remote
@@ -494,6 +501,31 @@ mxn_tcpip_server_open( MX_RECORD *record )
 			return mx_status;
 	}
 
+	/* Large arrays, such as area detector frames, can be sent to us
+	 * compressed if the user asked for it.
+	 */
+
+	if ( flags & MXF_NETWORK_SERVER_USE_COMPRESSION ) {
+		compression = MX_NETWORK_COMPRESSION_ZLIB;
+
+		if ( flags & MXF_NETWORK_SERVER_USE_SHUFFLE ) {
+			compression |= MX_NETWORK_COMPRESSION_SHUFFLE;
+		}
+
+		mx_status = mx_network_request_compression( record, compression,
+				MX_NETWORK_COMPRESSION_DEFAULT_THRESHOLD );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	/* Find out whether the server accepts batched get and put messages. */
+
+	mx_status = mx_network_check_batch_messages( record );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
 	return MX_SUCCESSFUL_RESULT;
 }
 
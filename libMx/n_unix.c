@@ -29,6 +29,7 @@
 #include "mx_socket.h"
 #include "mx_net.h"
 #include "mx_net_socket.h"
+#include "mx_net_shm.h"
 #include "n_unix.h"
 
 MX_RECORD_FUNCTION_LIST mxn_unix_server_record_function_list = {
@@ -125,10 +126,15 @@ mxn_unix_server_create_record_structures( MX_RECORD *record )
 
 	network_server->callback_list = NULL;
 
+	network_server->async_request_list = NULL;
+
 	MX_DEBUG( 2,("%s: MX_WORDSIZE = %d, MX_PROGRAM_MODEL = %#x",
 		fname, MX_WORDSIZE, MX_PROGRAM_MODEL));
 
 	network_server->use_64bit_network_longs = FALSE;
+	network_server->compression = MX_NETWORK_COMPRESSION_NONE;
+	network_server->use_shared_memory = FALSE;
+	network_server->server_supports_batch_messages = FALSE;
 
 	network_server->connection_status = 0;
 
@@ -396,6 +402,7 @@ mxn_unix_server_open( MX_RECORD *record )
 
 	network_server->remote_mx_version = MXT_REMOTE_MX_VERSION_UNKNOWN;
 	network_server->remote_mx_version_time = 0UL;
+	network_server->server_supports_batch_messages = FALSE;
 	version = 0L;
 
 	/* Warning: You _MUST_ use mx_get_by_name() to get the remote
@@ -505,6 +512,27 @@ mxn_unix_server_open( MX_RECORD *record )
 			return mx_status;
 	}
 
+	/* Since the server is on this host, large arrays such as area
+	 * detector frames can be passed to us through shared memory.
+	 */
+
+	if ( flags & MXF_NETWORK_SERVER_USE_SHARED_MEMORY ) {
+		mx_status = mx_network_request_shared_memory( record,
+				MX_NETWORK_SHM_DEFAULT_NUM_SLOTS,
+				MX_NETWORK_SHM_DEFAULT_SLOT_SIZE,
+				MX_NETWORK_SHM_DEFAULT_THRESHOLD );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	/* Find out whether the server accepts batched get and put messages. */
+
+	mx_status = mx_network_check_batch_messages( record );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
 	return MX_SUCCESSFUL_RESULT;
 }
 
@@ -471,7 +471,7 @@ mxp_area_detector_measure_correction_frame_handler( MX_RECORD *record,
 
 	list_head = mx_get_record_list_head_struct( record );
 
-	if ( list_head->callback_pipe == NULL ) {
+	if ( list_head->callback_queue == NULL ) {
 		/* We are not configured to handle callbacks, so we must
 		 * wait for the correction measurement to finish.
 		 */
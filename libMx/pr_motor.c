@@ -41,8 +41,8 @@
 	} while (0)
 
 /* mxp_motor_backlash_vtimer_callback() is called when the one-shot
- * virtual timer fires.  Its job is to write a pointer to the
- * MX_CALLBACK_MESSAGE structure to the callback pipe.  Virtual timer
+ * virtual timer fires.  Its job is to send a pointer to the
+ * MX_CALLBACK_MESSAGE structure to the callback queue.  Virtual timer
  * callbacks are very limited in what they can do, so it is not safe
  * to try to do the whole thing here.
  */
@@ -70,23 +70,22 @@ mxp_motor_backlash_vtimer_callback( MX_VIRTUAL_TIMER *vtimer, void *args )
 
 	list_head = callback_message->list_head;
 
-	if ( list_head->callback_pipe == (MX_PIPE *) NULL ) {
+	if ( list_head->callback_queue == (MX_CALLBACK_QUEUE *) NULL ) {
 		(void) mx_error( MXE_IPC_IO_ERROR, fname,
-		"The callback pipe for this process has not been created." );
+		"The callback queue for this process has not been created." );
 
 		return;
 	}
 
-	(void) mx_pipe_write( list_head->callback_pipe,
-				(char *) &callback_message,
-				sizeof(MX_CALLBACK_MESSAGE *) );
+	(void) mx_callback_queue_send( list_head->callback_queue,
+					callback_message );
 
 	return;
 }
 
 /* mx_motor_backlash_callback() gets called after the main thread reads
- * the message written by mxp_motor_backlash_vtimer_callback() to the
- * callback pipe and sees whether or not the motor has completed the
+ * the message sent by mxp_motor_backlash_vtimer_callback() to the
+ * callback queue and sees whether or not the motor has completed the
  * backlash move.  If the backlash move is complete, the main move is
  * started and the callback message is deleted.  If the backlash move
  * is _not_ complete, the one-shot virtual timer is started to reschedule
@@ -255,7 +254,7 @@ mxp_motor_move_absolute_handler( MX_RECORD *record, double destination )
 
 	list_head = mx_get_record_list_head_struct( record );
 
-	if ( list_head->callback_pipe == NULL ) {
+	if ( list_head->callback_queue == NULL ) {
 
 		/* We are not configured to handle callbacks,
 		 * so just start the move.
@@ -1483,7 +1483,7 @@ mxp_aviex_pccd_enable_monitor_callbacks( MX_RECORD *record,
 
 	list_head = mx_get_record_list_head_struct( record );
 
-	if ( list_head->callback_pipe == NULL ) {
+	if ( list_head->callback_queue == NULL ) {
 		return mx_error( MXE_SOFTWARE_CONFIGURATION_ERROR, fname,
 		"This process is not configured to handle callbacks, so "
 		"monitor callbacks cannot be enabled for area detector '%s'.",
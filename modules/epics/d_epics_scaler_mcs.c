@@ -455,7 +455,7 @@ mxd_epics_scaler_mcs_open( MX_RECORD *record )
 			record->name );
 	}
 
-	/* Check to see if this database process has a callback pipe.
+	/* Check to see if this database process has a callback queue.
 	 * If it does not, then warn the user that this driver cannot
 	 * operate correctly.
 	 */
@@ -469,12 +469,12 @@ mxd_epics_scaler_mcs_open( MX_RECORD *record )
 			record->name );
 	}
 
-	if ( list_head->callback_pipe == NULL ) {
+	if ( list_head->callback_queue == NULL ) {
 
 		return mx_error( MXE_SOFTWARE_CONFIGURATION_ERROR, fname,
-		"The driver '%s' for record '%s' uses the MX callback pipe "
+		"The driver '%s' for record '%s' uses the MX callback queue "
 		"to service its callbacks.  However, this process does not "
-		"have an MX callback pipe, so the driver _CANNOT_ run "
+		"have an MX callback queue, so the driver _CANNOT_ run "
 		"correctly.  Perhaps you need to be running this driver in "
 		"an MX server?",
 			mx_get_driver_name( record ),
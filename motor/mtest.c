@@ -364,7 +364,7 @@ motor_test_fn( int argc, char *argv[] )
 			}
 
 			mx_status = mx_process_callbacks( motor_record_list,
-					list_head->callback_pipe );
+					list_head->callback_queue );
 
 			if ( mx_status.code == MXE_SUCCESS ) {
 				return SUCCESS;
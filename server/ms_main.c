@@ -539,16 +539,22 @@ mxserver_main( int argc, char *argv[] )
 	int bypass_signal_handlers, poll_all;
 	unsigned long network_debug_flags;
 	long max_network_dump_bytes;
+	unsigned long max_client_queue_bytes;
+	unsigned long max_client_queue_messages;
+	unsigned long client_queue_overflow_policy;
 	mx_bool_type enable_remote_breakpoint;
 	mx_bool_type wait_for_debugger, just_in_time_debugging;
 	mx_bool_type wait_at_exit;
 	mx_bool_type monitor_resources;
+	unsigned long database_flags;
 	double resource_monitor_interval;
 	double master_timer_period;
 	double vc_poll_callback_interval;
 	long delay_microseconds;
 	unsigned long default_data_format;
 	unsigned long multiplexer_type;		/* For sockets */
+	long num_worker_threads;
+	unsigned long num_open_threads;
 	FILE *new_stderr;
 
 	int max_sockets, handler_array_size;
@@ -641,6 +647,14 @@ mxserver_main( int argc, char *argv[] )
 	network_debug_flags = 0;
 	max_network_dump_bytes = -1L;
 
+	/* Limits on how far behind a client may fall before the server
+	 * starts holding back its callback messages.
+	 */
+
+	max_client_queue_bytes = 256L * 1024L * 1024L;
+	max_client_queue_messages = 10000L;
+	client_queue_overflow_policy = MXF_SRV_QUEUE_OVERFLOW_DEFER;
+
 	enable_remote_breakpoint = FALSE;
 
 	wait_for_debugger = FALSE;
@@ -656,7 +670,11 @@ mxserver_main( int argc, char *argv[] )
 
 	poll_all = FALSE;
 
+	database_flags = 0;
+
 	multiplexer_type = MXF_SRV_MULTIPLEXER_SELECT;
+	num_worker_threads = 0;
+	num_open_threads = 0;
 
 #if HAVE_GETOPT
         /* Process command line arguments, if any. */
@@ -664,7 +682,7 @@ mxserver_main( int argc, char *argv[] )
         error_flag = FALSE;
 
         while ((c = getopt(argc, argv,
-    "aA:b:BcC:d:De:E:f:IJkl:L:m:M:n:NO:p:P:q:rsStT:u:v:wxX:Y:Z")) != -1)
+    "aA:b:BcC:d:De:E:f:Ij:JkKl:L:m:M:n:No:O:p:P:q:Q:rR:sStT:u:U:v:wxX:Y:Z")) != -1)
 	{
                 switch (c) {
 		case 'a':
@@ -729,12 +747,18 @@ mxserver_main( int argc, char *argv[] )
 		case 'I':
 			mxp_force_immediate_exit_flag = TRUE;
 			break;
+		case 'j':
+			num_worker_threads = atol( optarg );
+			break;
 		case 'J':
 			just_in_time_debugging = TRUE;
                         break;
 		case 'k':
 			enable_callbacks = FALSE;
 			break;
+		case 'K':
+			database_flags |= MXFC_USE_DATABASE_CACHE;
+			break;
 		case 'l':
 			install_syslog_handler = TRUE;
 			syslog_options = 0;
@@ -760,6 +784,9 @@ mxserver_main( int argc, char *argv[] )
 		case 'N':
 			debug_main_loop = TRUE;
 			break;
+		case 'o':
+			num_open_threads = strtoul( optarg, NULL, 0 );
+			break;
 		case 'O':
 			{
 				FILE *pid_file = fopen( optarg, "w" );
@@ -781,9 +808,31 @@ mxserver_main( int argc, char *argv[] )
 		case 'q':
 			max_network_dump_bytes = atol( optarg );
 			break;
+		case 'Q':
+			max_client_queue_bytes = strtoul( optarg, NULL, 0 );
+			break;
 		case 'r':
 			enable_remote_breakpoint = TRUE;
 			break;
+		case 'R':
+			/* 'drop' is the old name for 'defer'. */
+
+			if ( ( strcmp( "defer", optarg ) == 0 )
+			  || ( strcmp( "drop", optarg ) == 0 ) )
+			{
+				client_queue_overflow_policy =
+					MXF_SRV_QUEUE_OVERFLOW_DEFER;
+			} else
+			if ( strcmp( "disconnect", optarg ) == 0 ) {
+				client_queue_overflow_policy =
+					MXF_SRV_QUEUE_OVERFLOW_DISCONNECT;
+			} else {
+				fprintf( stderr,
+	"mxserver: Error: unrecognized client queue overflow policy '%s'.\n"
+	"  The allowed values are defer and disconnect.\n", optarg );
+				exit(1);
+			}
+			break;
 		case 's':
 			display_stack_traceback = TRUE;
 			break;
@@ -807,6 +856,9 @@ mxserver_main( int argc, char *argv[] )
 			exit(1);
 #endif
 			break;
+		case 'U':
+			max_client_queue_messages = strtoul( optarg, NULL, 0 );
+			break;
 		case 'v':
 			vc_poll_callback_interval = atof( optarg );
 			break;
@@ -852,7 +904,9 @@ mxserver_main( int argc, char *argv[] )
                         fprintf( stderr,
 "Usage: mxserver [-d debug_level] [-f mx_database_file] [-l log_number]\n"
 "  [-L log_number ] [-p server_port] [-P display_precision] \n"
-"  [-C connection_acl_filename]\n" );
+"  [-C connection_acl_filename] [-K] [-o num_open_threads]\n"
+"  [-j num_worker_threads] [-Q max_client_queue_bytes]\n"
+"  [-U max_client_queue_messages] [-R defer|disconnect]\n" );
                         exit(1);
                 }
         }
@@ -1015,6 +1069,16 @@ mxserver_main( int argc, char *argv[] )
 	socket_handler_list.num_sockets_in_use = 0;
 
 	socket_handler_list.epoll_fd = -1;
+	socket_handler_list.epoll_fd_array_size = 0;
+	socket_handler_list.epoll_fd_array = NULL;
+	socket_handler_list.epoll_callback_queue_fd = -1;
+	socket_handler_list.epoll_master_timer_fd = -1;
+
+	/* A negative wait timeout means that multiplexers which support
+	 * it will block until there is something for them to do.
+	 */
+
+	socket_handler_list.wait_timeout_ms = -1;
 
 	socket_handler_list.handler_array_size = handler_array_size;
 
@@ -1117,6 +1181,13 @@ mxserver_main( int argc, char *argv[] )
 
 	list_head_struct->max_network_dump_bytes = max_network_dump_bytes;
 
+	list_head_struct->max_client_queue_bytes = max_client_queue_bytes;
+	list_head_struct->max_client_queue_messages = max_client_queue_messages;
+	list_head_struct->client_queue_overflow_policy =
+					client_queue_overflow_policy;
+
+	list_head_struct->num_open_threads = num_open_threads;
+
 #if 0
 	fprintf(stderr, "%s: list_head_struct->network_debug = %d\n",
 		fname, list_head_struct->network_debug );
@@ -1162,32 +1233,37 @@ mxserver_main( int argc, char *argv[] )
 	/* If requested, enable the callback support. */
 
 	if ( enable_callbacks ) {
-		MX_PIPE *callback_pipe;
+		MX_CALLBACK_QUEUE *callback_queue;
 		MX_INTERVAL_TIMER *master_timer;
 
 		mx_info("Enabling callbacks.");
 
-		mx_status = mx_pipe_open( &callback_pipe );
+		mx_status = mx_callback_queue_create( &callback_queue );
 
 		if ( mx_status.code != MXE_SUCCESS )
 			exit( mx_status.code );
 
-		list_head_struct->callback_pipe = callback_pipe;
-
-		mx_status = mx_pipe_set_blocking_mode(
-				list_head_struct->callback_pipe,
-				MXF_PIPE_READ | MXF_PIPE_WRITE,
-				FALSE );
+		list_head_struct->callback_queue = callback_queue;
 
-		if ( mx_status.code != MXE_SUCCESS )
-			exit( mx_status.code );
-
-		/* Create a master timer with a timer period
-		 * of 100 milliseconds.
+		/* The epoll() multiplexer waits on a timerfd for the
+		 * virtual timers, so that it only wakes up when one of
+		 * them is due.  Otherwise, create a master timer that
+		 * polls the virtual timers every 'master_timer_period'
+		 * seconds (100 milliseconds by default).
 		 */
 
+#if HAVE_LINUX_EPOLL
+		if ( multiplexer_type == MXF_SRV_MULTIPLEXER_EPOLL ) {
+			mx_status = mx_virtual_timer_create_fd_master(
+							&master_timer );
+		} else {
+			mx_status = mx_virtual_timer_create_master(
+				&master_timer, master_timer_period );
+		}
+#else
 		mx_status = mx_virtual_timer_create_master( &master_timer,
 							master_timer_period );
+#endif
 
 		if ( mx_status.code != MXE_SUCCESS )
 			exit( mx_status.code );
@@ -1204,7 +1280,7 @@ mxserver_main( int argc, char *argv[] )
 	mx_info("Loading MX database file '%s'.", mx_database_filename);
 
 	mx_status = mx_read_database_file( mx_record_list,
-					mx_database_filename, 0 );
+					mx_database_filename, database_flags );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		exit( mx_status.code );
@@ -1334,6 +1410,22 @@ mxserver_main( int argc, char *argv[] )
 		exit(1);
 	}
 
+	/* If requested, start the worker threads that process get_array
+	 * and put_array requests.  From here on, the main thread holds
+	 * the server core mutex except while it is waiting for events.
+	 */
+
+	if ( num_worker_threads > 0 ) {
+		mx_status = mxsrv_worker_pool_create( mx_record_list,
+						&socket_handler_list,
+						num_worker_threads );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+
+		mxsrv_core_lock();
+	}
+
 	if ( delay_microseconds > 0 ) {
 		mx_warning( "The MX server has been manually throttled "
 		"using the -n option to a minimum of %ld microseconds "
@@ -1342,6 +1434,17 @@ mxserver_main( int argc, char *argv[] )
 
 	if ( monitor_resources ) {
 		mxsrv_display_resource_usage( TRUE, resource_monitor_interval );
+
+		/* Wake up often enough for the resource usage display
+		 * to be updated on schedule.
+		 */
+
+		if ( resource_monitor_interval > 0.0 ) {
+			socket_handler_list.wait_timeout_ms =
+			    mx_round( 1000.0 * resource_monitor_interval );
+		} else {
+			socket_handler_list.wait_timeout_ms = 1000;
+		}
 	}
 
 	/************ Primary event loop *************/
@@ -1396,23 +1499,25 @@ mxserver_main( int argc, char *argv[] )
 
 		mxsrv_process_sockets( mx_record_list, &socket_handler_list );
 
-		/* Check for callbacks. */
+		/* Check for callbacks.  If the socket multiplexer is
+		 * already watching the callback queue, then it has
+		 * dispatched the callbacks itself.
+		 */
 
-		if ( list_head_struct->callback_pipe != NULL ) {
-			size_t num_bytes_available;
+		if ( ( list_head_struct->callback_queue != NULL )
+		  && ( socket_handler_list.epoll_callback_queue_fd < 0 )
+		  && ( mx_callback_queue_is_empty(
+				list_head_struct->callback_queue ) == FALSE ) )
+		{
+			mx_status = mx_process_callbacks( mx_record_list,
+					list_head_struct->callback_queue );
+		}
 
-			mx_status = mx_pipe_num_bytes_available(
-						list_head_struct->callback_pipe,
-						&num_bytes_available );
+		/* Send any messages that are still waiting to go out
+		 * to slow clients.
+		 */
 
-			if ( ( mx_status.code == MXE_SUCCESS )
-			  && ( num_bytes_available > 0 ) )
-			{
-				mx_status = mx_process_callbacks(
-					mx_record_list,
-					list_head_struct->callback_pipe );
-			}
-		}
+		mxsrv_process_outbound_queues( &socket_handler_list );
 	}
 
 #if ( defined(OS_HPUX) && !defined(__ia64) )
@@ -1518,3 +1623,56 @@ mxsrv_update_fds( MX_LIST_HEAD *list_head,
 	}
 }
 
+
+/*-------------------------------------------------------------------------*/
+
+void
+mxsrv_update_fd( MX_LIST_HEAD *list_head,
+			MX_SOCKET_HANDLER_LIST *socket_handler_list,
+			MX_SOCKET_HANDLER *socket_handler )
+{
+	static const char fname[] = "mxsrv_update_fd()";
+
+	mx_status_type mx_status;
+
+	if ( list_head == (MX_LIST_HEAD *) NULL ) {
+		mx_status = mx_error( MXE_NULL_ARGUMENT, fname,
+			"The MX_LIST_HEAD pointer passed was NULL." );
+
+		exit( mx_status.code );
+	}
+
+	if ( socket_handler_list == (MX_SOCKET_HANDLER_LIST *) NULL ) {
+		mx_status = mx_error( MXE_NULL_ARGUMENT, fname,
+			"The MX_SOCKET_HANDLER_LIST pointer passed was NULL." );
+
+		exit( mx_status.code );
+	}
+
+	if ( socket_handler == (MX_SOCKET_HANDLER *) NULL ) {
+		mx_status = mx_error( MXE_NULL_ARGUMENT, fname,
+			"The MX_SOCKET_HANDLER pointer passed was NULL." );
+
+		exit( mx_status.code );
+	}
+
+	switch( list_head->socket_multiplexer_type ) {
+	case MXF_SRV_MULTIPLEXER_SELECT:
+		mxsrv_update_select_fd( list_head,
+					socket_handler_list, socket_handler );
+		break;
+#if HAVE_LINUX_EPOLL
+	case MXF_SRV_MULTIPLEXER_EPOLL:
+		mxsrv_update_epoll_fd( list_head,
+					socket_handler_list, socket_handler );
+		break;
+#endif
+	default:
+		mx_status = mx_error( MXE_UNSUPPORTED, fname,
+		"Unsupported socket multiplexer type %lu requested.",
+			list_head->socket_multiplexer_type );
+
+		exit( mx_status.code );
+		break;
+	}
+}
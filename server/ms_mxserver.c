@@ -52,6 +52,7 @@
 #include "mx_socket.h"
 #include "mx_net.h"
 #include "mx_net_socket.h"
+#include "mx_net_shm.h"
 #include "mx_pipe.h"
 #include "mx_array.h"
 #include "mx_list.h"
@@ -104,6 +105,8 @@ mxsrv_get_returning_message_type( uint32_t message_type )
 			mx_server_response(MX_NETMSG_GET_ARRAY_BY_HANDLE)},
 {MX_NETMSG_PUT_ARRAY_BY_HANDLE,
 			mx_server_response(MX_NETMSG_PUT_ARRAY_BY_HANDLE)},
+{MX_NETMSG_GET_ARRAY_BATCH,   mx_server_response(MX_NETMSG_GET_ARRAY_BATCH)},
+{MX_NETMSG_PUT_ARRAY_BATCH,   mx_server_response(MX_NETMSG_PUT_ARRAY_BATCH)},
 {MX_NETMSG_GET_FIELD_TYPE,    mx_server_response(MX_NETMSG_GET_FIELD_TYPE)},
 {MX_NETMSG_GET_ATTRIBUTE,     mx_server_response(MX_NETMSG_GET_ATTRIBUTE)},
 {MX_NETMSG_SET_ATTRIBUTE,     mx_server_response(MX_NETMSG_SET_ATTRIBUTE)},
@@ -174,9 +177,10 @@ mxsrv_free_client_socket_handler( MX_SOCKET_HANDLER *socket_handler,
 	if ( socket_handler_list != NULL ) {
 		socket_handler_list->array[n] = NULL;
 
-		/* Update the list of fds to check. */
+		/* Stop checking this client's fd. */
 
-		mxsrv_update_fds( list_head, socket_handler_list );
+		mxsrv_update_fd( list_head, socket_handler_list,
+						socket_handler );
 	}
 
 	/* Announce that the client socket has gone away. */
@@ -580,6 +584,8 @@ mxsrv_free_client_socket_handler( MX_SOCKET_HANDLER *socket_handler,
 			     * callback handle table.
 			     */
 
+			    mx_poll_callback_remove( list_head, callback_ptr );
+
 #if NETWORK_PROTECT_VM_HANDLE_TABLE
 			    mx_callback_handle_table_change_permissions(
 					callback_handle_table,
@@ -703,6 +709,10 @@ mxsrv_free_client_socket_handler( MX_SOCKET_HANDLER *socket_handler,
 	 * so prepare to delete the socket handler itself.
 	 */
 
+	/* Discard any messages still waiting to be sent to the client. */
+
+	mxsrv_free_outbound_queue( socket_handler );
+
 	/* Close our end of the synchronous socket. */
 
 	(void) mx_socket_close( socket_handler->mx_socket );
@@ -715,12 +725,20 @@ mxsrv_free_client_socket_handler( MX_SOCKET_HANDLER *socket_handler,
 	mx_free( socket_handler->mx_socket );
 #endif
 
-	/* Free the message buffer. */
+	/* Free the message buffers. */
 
 	if ( socket_handler->message_buffer != NULL ) {
 		mx_free_network_buffer( socket_handler->message_buffer );
 	}
 
+	if ( socket_handler->receive_buffer != NULL ) {
+		mx_free_network_buffer( socket_handler->receive_buffer );
+	}
+
+	if ( socket_handler->spare_buffer != NULL ) {
+		mx_free_network_buffer( socket_handler->spare_buffer );
+	}
+
 	/* Invalidate the contents of the socket handler just in case
 	 * someone has a pointer to it.
 	 */
@@ -729,6 +747,8 @@ mxsrv_free_client_socket_handler( MX_SOCKET_HANDLER *socket_handler,
 	socket_handler->handler_array_index = -1;
 	socket_handler->event_handler = NULL;
 	socket_handler->message_buffer = NULL;
+	socket_handler->receive_buffer = NULL;
+	socket_handler->spare_buffer = NULL;
 
 	mx_free( socket_handler );
 
@@ -945,6 +965,8 @@ mxsrv_mx_server_socket_init( MX_RECORD *list_head_record,
 	 */
 
 	socket_handler->message_buffer = NULL;
+	socket_handler->receive_buffer = NULL;
+	socket_handler->spare_buffer = NULL;
 
 	socket_handler_list->num_sockets_in_use++;
 
@@ -1175,9 +1197,17 @@ mxsrv_mx_server_socket_process_event( MX_RECORD *record_list,
 
 	new_socket_handler->last_rpc_message_id = 0;
 
+	new_socket_handler->receive_bytes_so_far = 0;
+
+	new_socket_handler->worker_job_pending = FALSE;
+
+	new_socket_handler->spare_buffer = NULL;
+
+	new_socket_handler->outbound_queue = NULL;
+
 	new_socket_handler->authentication_type = MXF_SRVAUTH_NONE;
 
-	/* Allocate memory for the message buffer. */
+	/* Allocate memory for the message buffers. */
 
 	mx_status = mx_allocate_network_buffer(
 			&(new_socket_handler->message_buffer),
@@ -1191,12 +1221,34 @@ mxsrv_mx_server_socket_process_event( MX_RECORD *record_list,
 		return mx_status;
 	}
 
+	mx_status = mx_allocate_network_buffer(
+			&(new_socket_handler->receive_buffer),
+			NULL, new_socket_handler,
+			MXU_NETWORK_INITIAL_MESSAGE_BUFFER_LENGTH );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_free_network_buffer( new_socket_handler->message_buffer );
+		mx_free( client_socket );
+		mx_free( new_socket_handler );
+
+		return mx_status;
+	}
+
 	new_socket_handler->message_buffer->data_format
 					= new_socket_handler->data_format;
 
+	new_socket_handler->receive_buffer->data_format
+					= new_socket_handler->data_format;
+
 	new_socket_handler->mx_socket = client_socket;
 	client_socket->socket_handler = new_socket_handler;
 
+	/* Route all messages to the client through its outbound queue,
+	 * so that a client that stops reading cannot stall the server.
+	 */
+
+	client_socket->send_hook = mxsrv_outbound_send_hook;
+
 	new_socket_handler->event_handler
 			= server_socket_struct->client_event_handler;
 
@@ -1317,9 +1369,9 @@ mxsrv_mx_server_socket_process_event( MX_RECORD *record_list,
 
 	socket_handler_list->num_sockets_in_use++;
 
-	/* Update the list of fds to check. */
+	/* Start checking the new client's fd. */
 
-	mxsrv_update_fds( list_head, socket_handler_list );
+	mxsrv_update_fd( list_head, socket_handler_list, new_socket_handler );
 
 	/* Announce that a new client has connected. */
 
@@ -1370,6 +1422,210 @@ mxsrv_mx_client_socket_init( MX_RECORD *record_list,
 
 /*--------------------------------------------------------------------------*/
 
+/* On platforms that support it, MSG_DONTWAIT lets us drain everything that
+ * is available on the socket without blocking.  Elsewhere, we only issue a
+ * single recv() per readiness event, which cannot block since the socket
+ * multiplexer has just told us that the socket is readable.
+ */
+
+#if defined(MSG_DONTWAIT)
+#  define MXSRV_RECV_FLAGS		MSG_DONTWAIT
+#  define MXSRV_RECV_MULTIPLE_CALLS	TRUE
+#else
+#  define MXSRV_RECV_FLAGS		0
+#  define MXSRV_RECV_MULTIPLE_CALLS	FALSE
+#endif
+
+static mx_status_type
+mxsrv_receive_partial_message( MX_SOCKET_HANDLER *socket_handler,
+				MX_SOCKET_HANDLER_LIST *socket_handler_list,
+				size_t bytes_wanted,
+				mx_bool_type *message_complete )
+{
+	static const char fname[] = "mxsrv_receive_partial_message()";
+
+	MX_SOCKET *client_socket;
+	char *ptr;
+	int saved_errno;
+	long bytes_left, bytes_received;
+	mx_bool_type partial_message;
+	mx_status_type mx_status;
+
+	client_socket = socket_handler->mx_socket;
+
+	*message_complete = FALSE;
+
+	while ( socket_handler->receive_bytes_so_far < bytes_wanted ) {
+
+		ptr = socket_handler->receive_buffer->u.char_buffer
+				+ socket_handler->receive_bytes_so_far;
+
+		bytes_left = (long) ( bytes_wanted
+				- socket_handler->receive_bytes_so_far );
+
+		bytes_received = recv( client_socket->socket_fd,
+					ptr, bytes_left, MXSRV_RECV_FLAGS );
+
+		switch( bytes_received ) {
+		case MX_SOCKET_ERROR:
+			saved_errno = mx_socket_get_last_error();
+
+			switch( saved_errno ) {
+			case EWOULDBLOCK:
+#if defined(EAGAIN) && ( EAGAIN != EWOULDBLOCK )
+			case EAGAIN:
+#endif
+			case EINTR:
+				/* Nothing more is available right now. */
+
+				return MX_SUCCESSFUL_RESULT;
+				break;
+			case ECONNRESET:
+			case ECONNABORTED:
+				break;
+			default:
+				(void) mxsrv_free_client_socket_handler(
+					socket_handler, socket_handler_list );
+
+				return mx_error( MXE_NETWORK_IO_ERROR, fname,
+				"Error receiving message from remote host.  "
+				"Errno = %d, error text = '%s'",
+				saved_errno, mx_socket_strerror( saved_errno ) );
+				break;
+			}
+
+			/* The socket handler is freed here, so the caller
+			 * must not touch it again.  It will not, since
+			 * message_complete is still FALSE.
+			 */
+
+			mx_status = mxsrv_free_client_socket_handler(
+					socket_handler, socket_handler_list );
+
+			return mx_status;
+			break;
+		case 0:
+			/* The remote socket has closed so remove the
+			 * socket handler from the socket handler list.
+			 */
+
+			partial_message =
+				( socket_handler->receive_bytes_so_far > 0 );
+
+			mx_status = mxsrv_free_client_socket_handler(
+					socket_handler, socket_handler_list );
+
+			if ( partial_message ) {
+				return mx_error( MXE_NETWORK_IO_ERROR, fname,
+				"Network connection closed unexpectedly "
+				"in the middle of a message." );
+			}
+
+			return mx_status;
+			break;
+		default:
+			socket_handler->receive_bytes_so_far += bytes_received;
+			break;
+		}
+
+		if ( MXSRV_RECV_MULTIPLE_CALLS == FALSE ) {
+			break;
+		}
+	}
+
+	if ( socket_handler->receive_bytes_so_far >= bytes_wanted ) {
+		*message_complete = TRUE;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* mxsrv_get_field_from_handle() converts a (record_handle, field_handle)
+ * pair sent by a client into MX_RECORD and MX_RECORD_FIELD pointers.
+ */
+
+static mx_status_type
+mxsrv_get_field_from_handle( MX_LIST_HEAD *list_head,
+				long record_handle,
+				long field_handle,
+				MX_RECORD **record,
+				MX_RECORD_FIELD **record_field )
+{
+	static const char fname[] = "mxsrv_get_field_from_handle()";
+
+	MX_HANDLE_TABLE *handle_table;
+	void *record_ptr;
+	mx_status_type mx_status;
+
+	*record = NULL;
+	*record_field = NULL;
+
+	handle_table = (MX_HANDLE_TABLE *) list_head->handle_table;
+
+	if ( handle_table == (MX_HANDLE_TABLE *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The 'handle_table' pointer for the MX database is NULL." );
+	}
+
+#if NETWORK_DEBUG_HANDLES
+	MX_DEBUG(-2,("%s: requested network field (%ld,%ld)",
+		fname, record_handle, field_handle));
+#endif
+
+	if ( (record_handle < 0) || (field_handle < 0) ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"Illegal network field handle (%ld,%ld) requested.  "
+		"The two values in a network field handle must both "
+		"be non-negative.", record_handle, field_handle );
+	}
+
+	/* First find the record pointer. */
+
+	mx_status = mx_get_pointer_from_handle( &record_ptr,
+					handle_table, record_handle );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	*record = (MX_RECORD *) record_ptr;
+
+	if ( *record == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_RECORD pointer returned for network field "
+		"(%ld,%ld) is NULL.", record_handle, field_handle );
+	}
+
+	/* Then find the field pointer. */
+
+	if ( field_handle >= (*record)->num_record_fields ) {
+		mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The requested field handle %ld for network field "
+		"(%ld,%ld) is greater than or equal to the "
+		"number of record fields %ld for record '%s'.",
+			field_handle, record_handle, field_handle,
+			(*record)->num_record_fields, (*record)->name );
+
+		*record = NULL;
+
+		return mx_status;
+	}
+
+	*record_field = &((*record)->record_field_array[ field_handle ]);
+
+#if NETWORK_DEBUG_HANDLES
+	MX_DEBUG(-2,
+	("%s: network field handle = (%ld,%ld), record = '%s', field = '%s'",
+		fname, record_handle, field_handle,
+		(*record)->name, (*record_field)->name ));
+#endif
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*--------------------------------------------------------------------------*/
+
 mx_status_type
 mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 				MX_SOCKET_HANDLER *socket_handler,
@@ -1387,15 +1643,13 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 	MX_RECORD *record;
 	MX_RECORD_FIELD *record_field;
 	MX_LIST_HEAD *list_head;
-	MX_HANDLE_TABLE *handle_table;
 	long record_handle, field_handle;
 	MX_SOCKET *client_socket;
-	void *record_ptr;
 
 	char *ptr, *message_ptr, *value_ptr;
 	uint32_t *uint32_message_body;
-	int saved_errno;
-	int bytes_left, bytes_received, initial_recv_length;
+	mx_bool_type message_complete;
+	size_t initial_recv_length;
 	uint32_t magic_value, header_length, message_length, total_length;
 	uint32_t message_type, returned_message_type, message_id;
 	mx_status_type mx_status, mx_status2;
@@ -1448,57 +1702,38 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 		    "The MX_LIST_HEAD pointer for the MX database is NULL." );
 	}
 
-	/* Try to read the beginning of the header of the incoming message. */
-
-	received_message = socket_handler->message_buffer;
+	/* Client messages are assembled incrementally.  Each time that
+	 * the socket becomes readable, we take whatever bytes are available
+	 * without blocking and return if the message is not yet complete.
+	 * The number of bytes received so far is kept in the socket handler,
+	 * so the next call picks up where this one left off.
+	 */
 
-	header = received_message->u.uint32_buffer;
-	ptr    = received_message->u.char_buffer;
+	received_message = socket_handler->receive_buffer;
 
 	initial_recv_length = 4 * sizeof( uint32_t );
 
-	bytes_left = initial_recv_length;
-
-	while( bytes_left > 0 ) {
-		bytes_received = recv( client_socket->socket_fd,
-						ptr, bytes_left, 0 );
+	/* Try to read the beginning of the header of the incoming message. */
 
-		switch( bytes_received ) {
-		case MX_SOCKET_ERROR:
-			saved_errno = mx_socket_get_last_error();
+	if ( socket_handler->receive_bytes_so_far < initial_recv_length ) {
 
-			switch( saved_errno ) {
-			case ECONNRESET:
-			case ECONNABORTED:
-				break;
-			default:
-				return mx_error( MXE_NETWORK_IO_ERROR, fname,
-"Error receiving header from remote host.  Errno = %d, error text = '%s'",
-			saved_errno, mx_socket_strerror( saved_errno ) );
-				break;
-			}
-			mx_status = mxsrv_free_client_socket_handler(
-					socket_handler, socket_handler_list );
+		mx_status = mxsrv_receive_partial_message( socket_handler,
+					socket_handler_list,
+					initial_recv_length,
+					&message_complete );
 
+		if ( mx_status.code != MXE_SUCCESS )
 			return mx_status;
-			break;
-		case 0:
-			/* The remote socket has closed so remove the
-			 * socket handler from the socket handler list.
-			 */
 
-			mx_status = mxsrv_free_client_socket_handler(
-					socket_handler, socket_handler_list );
+		if ( message_complete == FALSE ) {
+			/* Wait for the rest of the header to arrive. */
 
-			return mx_status;
-			break;
-		default:
-			bytes_left -= bytes_received;
-			ptr += bytes_received;
-			break;
+			return MX_SUCCESSFUL_RESULT;
 		}
 	}
 
+	header = received_message->u.uint32_buffer;
+
 #if 0 && NETWORK_DEBUG_VERBOSE
 	{
 		long i;
@@ -1537,6 +1772,8 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 #endif
 
         if ( magic_value != MX_NETWORK_MAGIC_VALUE ) {
+		socket_handler->receive_bytes_so_far = 0;
+
                 return mx_error( MXE_NETWORK_IO_ERROR, fname,
                 "Wrong magic number %lx in received message.",
 		(unsigned long) magic_value );
@@ -1556,7 +1793,8 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 	}
 
 	/* If the message is too long to fit into the current buffer,
-	 * increase the size of the buffer.
+	 * increase the size of the buffer.  The bytes that have already
+	 * been received are preserved by the reallocation.
 	 */
 
 	total_length = header_length + message_length;
@@ -1569,57 +1807,52 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 	   		(unsigned long) total_length ));
 
 		mx_status = mx_reallocate_network_buffer(
-					socket_handler->message_buffer,
+					socket_handler->receive_buffer,
 					total_length );
 
-		if ( mx_status.code != MXE_SUCCESS )
+		if ( mx_status.code != MXE_SUCCESS ) {
+			socket_handler->receive_bytes_so_far = 0;
+
 			return mx_status;
+		}
 
 		/* Update local pointers. */
 
-		received_message = socket_handler->message_buffer;
+		received_message = socket_handler->receive_buffer;
 
 		header = received_message->u.uint32_buffer;
 	}
 
-        /* Receive the rest of the data. */
+        /* Receive as much of the rest of the data as is available. */
 
-	ptr  = received_message->u.char_buffer;
+	if ( socket_handler->receive_bytes_so_far < total_length ) {
 
-	ptr += initial_recv_length;
+		mx_status = mxsrv_receive_partial_message( socket_handler,
+					socket_handler_list,
+					total_length,
+					&message_complete );
 
-        bytes_left = total_length - initial_recv_length;
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 
-        while( bytes_left > 0 ) {
-                bytes_received = recv( client_socket->socket_fd,
-						ptr, bytes_left, 0 );
+		if ( message_complete == FALSE ) {
+			/* Wait for the rest of the body to arrive. */
 
-                switch( bytes_received ) {
-		case MX_SOCKET_ERROR:
-			saved_errno = mx_socket_get_last_error();
+			return MX_SUCCESSFUL_RESULT;
+		}
 
-			(void) mxsrv_free_client_socket_handler(
-					socket_handler, socket_handler_list );
+		header = received_message->u.uint32_buffer;
+	}
 
-                        return mx_error( MXE_NETWORK_IO_ERROR, fname,
-                        "Error receiving message body from remote host.  "
-                        "Errno = %d, error text = '%s'",
-			saved_errno, mx_socket_strerror( saved_errno ) );
+	/* We have a complete message.  Move it to the message buffer, where
+	 * the response will be built, and reset the receive state so that
+	 * the old message buffer is used to assemble the next message.
+	 */
 
-                        break;
-                case 0:
-			(void) mxsrv_free_client_socket_handler(
-					socket_handler, socket_handler_list );
+	socket_handler->receive_buffer = socket_handler->message_buffer;
+	socket_handler->message_buffer = received_message;
 
-                        return mx_error( MXE_NETWORK_IO_ERROR, fname,
-				"Network connection closed unexpectedly." );
-                        break;
-                default:
-                        bytes_left -= bytes_received;
-                        ptr += bytes_received;
-                        break;
-                }
-        }
+	socket_handler->receive_bytes_so_far = 0;
 
 	/**** If requested, dump out the received binary message ****/
 
@@ -1690,6 +1923,14 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 			strlcpy( message_type_string, "PUT_ARRAY_BY_HANDLE",
 						sizeof(message_type_string) );
 			break;
+		case MX_NETMSG_GET_ARRAY_BATCH:
+			strlcpy( message_type_string, "GET_ARRAY_BATCH",
+						sizeof(message_type_string) );
+			break;
+		case MX_NETMSG_PUT_ARRAY_BATCH:
+			strlcpy( message_type_string, "PUT_ARRAY_BATCH",
+						sizeof(message_type_string) );
+			break;
 		case MX_NETMSG_GET_NETWORK_HANDLE:
 			strlcpy( message_type_string, "GET_NETWORK_HANDLE",
 						sizeof(message_type_string) );
@@ -1776,6 +2017,8 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 		value_at_message_start = MXS_START_RECORD_FIELD_HANDLE;
 		break;
 
+	case MX_NETMSG_GET_ARRAY_BATCH:
+	case MX_NETMSG_PUT_ARRAY_BATCH:
 	case MX_NETMSG_SET_CLIENT_INFO:
 	case MX_NETMSG_GET_OPTION:
 	case MX_NETMSG_SET_OPTION:
@@ -1858,15 +2101,6 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 		break;
 
 	case MXS_START_RECORD_FIELD_HANDLE:
-		handle_table = (MX_HANDLE_TABLE *) list_head->handle_table;
-
-		if ( handle_table == (MX_HANDLE_TABLE *) NULL ) {
-			mx_status = mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-		    "The 'handle_table' pointer for the MX database is NULL." );
-
-			break;	/* Exit the switch() statement. */
-		}
-
 		uint32_message_body = header +
 		  (mx_remote_header_length(socket_handler) / sizeof(uint32_t));
 
@@ -1874,72 +2108,9 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 
 		field_handle = (long) mx_ntohl( uint32_message_body[1] );
 
-#if NETWORK_DEBUG_HANDLES
-		MX_DEBUG(-2,("%s: requested network field (%ld,%ld)",
-			fname, record_handle, field_handle));
-#endif
-
-		if ( (record_handle < 0) || (field_handle < 0) ) {
-			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-			"Illegal network field handle (%ld,%ld) requested.  "
-			"The two values in a network field handle must both "
-			"be non-negative.", record_handle, field_handle );
-
-			break;	/* Exit the switch() statement. */
-		}
-
-		/* First find the record pointer. */
-
-		mx_status = mx_get_pointer_from_handle( &record_ptr,
-						handle_table, record_handle );
-
-		if ( mx_status.code != MXE_SUCCESS ) {
-
-			break;	/* Exit the switch() statement. */
-		}
-
-		record = (MX_RECORD *) record_ptr;
-
-		if ( record == (MX_RECORD *) NULL ) {
-			mx_status = mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-			"The MX_RECORD pointer returned for network field "
-			"(%ld,%ld) is NULL.", record_handle, field_handle );
-
-			break;	/* Exit the switch() statement. */
-		}
-
-		/* Then find the field pointer. */
-
-		if ( field_handle >= record->num_record_fields ) {
-			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-			"The requested field handle %ld for network field "
-			"(%ld,%ld) is greater than or equal to the "
-			"number of record fields %ld for record '%s'.",
-				field_handle, record_handle, field_handle,
-				record->num_record_fields, record->name );
-
-			break;	/* Exit the switch() statement. */
-		}
-
-		record_field = &(record->record_field_array[ field_handle ]);
-
-		if ( record_field == (MX_RECORD_FIELD *) NULL ) {
-
-			mx_status = mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-			"The MX_RECORD_FIELD pointer returned for "
-			"network field (%ld,%ld) is NULL.",
-				record_handle, field_handle );
-
-			break;	/* Exit the switch() statement. */
-		}
-
-#if NETWORK_DEBUG_HANDLES
-		MX_DEBUG(-2,
-	("%s: network field handle = (%ld,%ld), record = '%s', field = '%s'",
-	 		fname, record_handle, field_handle,
-			record->name, record_field->name ));
-#endif
-
+		mx_status = mxsrv_get_field_from_handle( list_head,
+					record_handle, field_handle,
+					&record, &record_field );
 		break;
 
 	default:
@@ -1993,13 +2164,44 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 	MX_HRT_START( immediate_measurement );
 #endif
 
-	/* Here we handle messages that are to be dealt with immediately. */
-
-	update_next_event_time = FALSE;
+	/* If a worker pool is in use, get and put requests are handed
+	 * over to the worker that serves this record's hardware.
+	 */
 
-	switch ( message_type ) {
-	case MX_NETMSG_GET_ARRAY_BY_NAME:
-	case MX_NETMSG_GET_ARRAY_BY_HANDLE:
+	if ( mxsrv_worker_pool_is_enabled() ) {
+		switch ( message_type ) {
+		case MX_NETMSG_GET_ARRAY_BY_NAME:
+		case MX_NETMSG_GET_ARRAY_BY_HANDLE:
+		case MX_NETMSG_PUT_ARRAY_BY_NAME:
+		case MX_NETMSG_PUT_ARRAY_BY_HANDLE:
+			queue_a_message = TRUE;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if ( queue_a_message ) {
+		mx_status = mxsrv_worker_pool_queue_event( socket_handler,
+							record, record_field );
+		return mx_status;
+	}
+
+	/* Here we handle messages that are to be dealt with immediately. */
+
+	update_next_event_time = FALSE;
+
+	/* Keep worker threads away from the hardware used by this record
+	 * while we are looking at it here.
+	 */
+
+	if ( record != (MX_RECORD *) NULL ) {
+		mxsrv_worker_pool_quiesce_record( record );
+	}
+
+	switch ( message_type ) {
+	case MX_NETMSG_GET_ARRAY_BY_NAME:
+	case MX_NETMSG_GET_ARRAY_BY_HANDLE:
 		mx_status = mxsrv_handle_get_array( record_list, socket_handler,
 						record, record_field,
 						received_message );
@@ -2029,6 +2231,12 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 
 		update_next_event_time = TRUE;
 		break;
+	case MX_NETMSG_GET_ARRAY_BATCH:
+	case MX_NETMSG_PUT_ARRAY_BATCH:
+		mx_status = mxsrv_handle_array_batch( record_list,
+						socket_handler,
+						received_message );
+		break;
 	case MX_NETMSG_GET_NETWORK_HANDLE:
 		mx_status = mxsrv_handle_get_network_handle( record_list,
 						socket_handler,
@@ -2092,6 +2300,10 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 		break;
 	}
 
+	if ( record != (MX_RECORD *) NULL ) {
+		mxsrv_worker_pool_resume_record( record );
+	}
+
 #if NETWORK_DEBUG_VERBOSE
 	MX_DEBUG(-2,("socket_handler->mx_socket = %p",
 				socket_handler->mx_socket));
@@ -2257,7 +2469,11 @@ mxsrv_mx_client_socket_proc_queued_event( MX_RECORD *record_list,
 
 			value_ptr += ( 2 * sizeof( uint32_t ) );
 		} else {
-			value_ptr += MXU_RECORD_FIELD_NAME_LENGTH;
+			if ( socket_handler->remote_mx_version < 1005005L ) {
+				value_ptr += 49;
+			} else {
+				value_ptr += MXU_RECORD_FIELD_NAME_LENGTH;
+			}
 		}
 
 		mx_status = mxsrv_handle_put_array( record_list,
@@ -2407,7 +2623,7 @@ mxsrv_handle_get_array( MX_RECORD *record_list,
 		mx_numbered_breakpoint( 0 );
 #endif
 
-		mx_status = mx_process_record_field_without_callbacks(
+		mx_status = mxsrv_process_record_field_for_client(
 					record, record_field,
 					socket_handler, MX_PROCESS_GET );
 
@@ -2466,51 +2682,34 @@ mxsrv_handle_get_array( MX_RECORD *record_list,
 
 /*--------------------------------------------------------------------------*/
 
-mx_status_type
-mxsrv_send_field_value_to_client( 
-			MX_SOCKET_HANDLER *socket_handler,
+/* mxsrv_encode_field_value() writes the value of a record field into
+ * a network message buffer, starting 'offset' bytes from the beginning
+ * of the buffer, using the data format selected by the client.  For the
+ * binary data formats, the buffer is made larger if the value does not fit.
+ */
+
+static mx_status_type
+mxsrv_encode_field_value( MX_SOCKET_HANDLER *socket_handler,
 			MX_RECORD *record,
 			MX_RECORD_FIELD *record_field,
 			MX_NETWORK_MESSAGE_BUFFER *network_message,
-			uint32_t message_type_for_client,
-			uint32_t message_id_for_client )
+			long offset,
+			long *num_bytes_encoded )
 {
-	static const char fname[] = "mxsrv_send_field_value_to_client()";
+	static const char fname[] = "mxsrv_encode_field_value()";
 
-	char location[ sizeof(fname) + 80 ];
-	uint32_t *send_buffer_header;
 	char *send_buffer_message;
-	long send_buffer_header_length, send_buffer_message_length;
-	long send_buffer_message_actual_length;
+	long send_buffer_message_length;
 	size_t num_network_bytes;
-
-	MX_SOCKET *mx_socket;
 	void *pointer_to_value;
 	int array_is_dynamically_allocated;
 	unsigned long data_format;
+	int i, max_attempts;
 	mx_status_type ( *token_constructor )
 		(void *, char *, size_t, MX_RECORD *, MX_RECORD_FIELD *);
 	mx_status_type mx_status;
 
-	mx_status = MX_SUCCESSFUL_RESULT;
-
-	if ( socket_handler == (MX_SOCKET_HANDLER *) NULL ) {
-		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_SOCKET_HANDLER pointer passed was NULL." );
-	}
-	if ( network_message == (MX_NETWORK_MESSAGE_BUFFER *) NULL ) {
-		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_NETWORK_MESSAGE_BUFFER pointer passed was NULL." );
-	}
-
-	mx_socket = socket_handler->mx_socket;
-
-#if NETWORK_DEBUG_MESSAGE_IDS
-	MX_DEBUG(-2,("%s: [%#lx] sending '%s.%s' to socket %d",
-		fname, (unsigned long) message_id_for_client,
-		record->name, record_field->name,
-		(int) mx_socket->socket_fd ));
-#endif
+	*num_bytes_encoded = 0;
 
 	if ( record_field->flags & MXFF_VARARGS ) {
 		array_is_dynamically_allocated = TRUE;
@@ -2522,36 +2721,22 @@ mxsrv_send_field_value_to_client(
 
 	pointer_to_value = mx_get_field_value_pointer( record_field );
 
-	/* Construct the response header. */
-
-	send_buffer_header_length =
-		(long) mx_remote_header_length(socket_handler);
+	send_buffer_message = network_message->u.char_buffer + offset;
 
 	send_buffer_message_length = (long)
-		( network_message->buffer_length - send_buffer_header_length );
-
-	send_buffer_message_actual_length = 0;
-
-	send_buffer_header = network_message->u.uint32_buffer;;
-
-	send_buffer_message  = network_message->u.char_buffer;
-	send_buffer_message += send_buffer_header_length;
-
-	/* What data format do we use to send the response? */
+		( network_message->buffer_length - offset );
 
 	data_format = socket_handler->data_format;
 
-	if ( mx_status.code == MXE_SUCCESS ) {
-
-	    int i, max_attempts;
+	mx_status = MX_SUCCESSFUL_RESULT;
 
-	    /* Loop until the output buffer is large enough for the data
-	     * that we want to send or until some other error occurs.
-	     */
+	/* Loop until the output buffer is large enough for the data
+	 * that we want to send or until some other error occurs.
+	 */
 
-	    max_attempts = 10;
+	max_attempts = 10;
 
-	    for ( i = 0; i < max_attempts; i++ ) {
+	for ( i = 0; i < max_attempts; i++ ) {
 
 		size_t current_length, new_length;
 
@@ -2587,8 +2772,8 @@ mxsrv_send_field_value_to_client(
 				}
 		        }
 
-			send_buffer_message_actual_length
-				= (long) strlen( send_buffer_message ) + 1;
+			*num_bytes_encoded =
+				(long) strlen( send_buffer_message ) + 1;
 
 			/* ASCII data transfers do not currently support
 			 * dynamically resizing network buffers, so we return
@@ -2623,8 +2808,7 @@ mxsrv_send_field_value_to_client(
 				    socket_handler->use_64bit_network_longs,
 				    socket_handler->remote_mx_version );
 
-			send_buffer_message_actual_length
-				= (long) num_network_bytes;
+			*num_bytes_encoded = (long) num_network_bytes;
 			break;
 
 		case MX_NETWORK_DATAFMT_XDR:
@@ -2644,8 +2828,7 @@ mxsrv_send_field_value_to_client(
 					send_buffer_message_length,
 					&num_network_bytes );
 
-			send_buffer_message_actual_length
-				= (long) num_network_bytes;
+			*num_bytes_encoded = (long) num_network_bytes;
 #else
 			mx_status = mx_error( MXE_UNSUPPORTED, fname,
 				"XDR network data format is not supported "
@@ -2688,23 +2871,231 @@ mxsrv_send_field_value_to_client(
 
 		/* Update some values. */
 
-		send_buffer_header = network_message->u.uint32_buffer;;
-
 		send_buffer_message = network_message->u.char_buffer
-						+ send_buffer_header_length;
+						+ offset;
 
 		send_buffer_message_length += num_network_bytes;
-	    }
+	}
 
-	    if ( i >= max_attempts ) {
+	if ( i >= max_attempts ) {
 		return mx_error( MXE_UNKNOWN_ERROR, fname,
 			"%d attempts to increase the network buffer size "
 			"for record field '%s.%s' failed.  "
 			"You should never see this error.",
 			    max_attempts, record->name, record_field->name );
-	    }
 	}
 
+
+	return mx_status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Binary array values at least this large are sent directly from the
+ * record field storage rather than being copied into the message buffer.
+ */
+
+#define MXSRV_ZERO_COPY_THRESHOLD	4096
+
+/* mxsrv_get_zero_copy_data() decides whether the value of a record field
+ * can be sent to the client exactly as it is laid out in memory.  That is
+ * true for large RAW or BYTESWAP arrays of plain numeric types whose
+ * elements are stored contiguously, as long as longs have the same size
+ * on the network as they do here.  Everything else goes through
+ * mxsrv_encode_field_value().
+ */
+
+static mx_bool_type
+mxsrv_get_zero_copy_data( MX_SOCKET_HANDLER *socket_handler,
+			MX_RECORD_FIELD *record_field,
+			void **data_pointer,
+			long *num_data_bytes )
+{
+	mx_bool_type native_longs_are_64bits;
+	size_t element_size;
+	long i, num_elements;
+
+	switch( socket_handler->data_format ) {
+	case MX_NETWORK_DATAFMT_RAW:
+	case MX_NETWORK_DATAFMT_BYTESWAP:
+		break;
+	default:
+		return FALSE;
+	}
+
+	/* The network debugging output expects to find the value
+	 * in the message buffer.
+	 */
+
+	if ( socket_handler->network_debug_flags != 0 )
+		return FALSE;
+
+	if ( record_field->num_dimensions < 1 )
+		return FALSE;
+
+	/* A varargs array with more than one dimension is an array of
+	 * row pointers, so its elements are not known to be contiguous.
+	 */
+
+	if ( ( record_field->num_dimensions > 1 )
+	  && ( record_field->flags & MXFF_VARARGS ) )
+	{
+		return FALSE;
+	}
+
+#if ( MX_WORDSIZE == 64 )
+	native_longs_are_64bits = TRUE;
+#else
+	native_longs_are_64bits = FALSE;
+#endif
+
+	switch( record_field->datatype ) {
+	case MXFT_CHAR:
+	case MXFT_UCHAR:
+	case MXFT_INT8:
+	case MXFT_UINT8:
+	case MXFT_SHORT:
+	case MXFT_USHORT:
+	case MXFT_INT16:
+	case MXFT_UINT16:
+	case MXFT_BOOL:
+	case MXFT_INT32:
+	case MXFT_UINT32:
+	case MXFT_INT64:
+	case MXFT_UINT64:
+	case MXFT_FLOAT:
+	case MXFT_DOUBLE:
+		break;
+	case MXFT_LONG:
+	case MXFT_ULONG:
+	case MXFT_HEX:
+		if ( native_longs_are_64bits
+			!= socket_handler->use_64bit_network_longs )
+		{
+			return FALSE;
+		}
+		break;
+	default:
+		return FALSE;
+	}
+
+	element_size = mx_get_scalar_element_size( record_field->datatype,
+						native_longs_are_64bits );
+
+	num_elements = 1;
+
+	for ( i = 0; i < record_field->num_dimensions; i++ ) {
+		num_elements *= record_field->dimension[i];
+	}
+
+	*num_data_bytes = (long) ( num_elements * element_size );
+
+	if ( *num_data_bytes < MXSRV_ZERO_COPY_THRESHOLD )
+		return FALSE;
+
+	/* Values that will be compressed must go through the buffer. */
+
+	if ( ( socket_handler->mx_socket->compression
+				!= MX_NETWORK_COMPRESSION_NONE )
+	  && ( *num_data_bytes
+			>= socket_handler->mx_socket->compression_threshold ) )
+	{
+		return FALSE;
+	}
+
+	*data_pointer = mx_get_field_value_pointer( record_field );
+
+	if ( *data_pointer == NULL )
+		return FALSE;
+
+	return TRUE;
+}
+
+/*--------------------------------------------------------------------------*/
+
+mx_status_type
+mxsrv_send_field_value_to_client( 
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_RECORD *record,
+			MX_RECORD_FIELD *record_field,
+			MX_NETWORK_MESSAGE_BUFFER *network_message,
+			uint32_t message_type_for_client,
+			uint32_t message_id_for_client )
+{
+	static const char fname[] = "mxsrv_send_field_value_to_client()";
+
+	char location[ sizeof(fname) + 80 ];
+	uint32_t *send_buffer_header;
+	char *send_buffer_message;
+	long send_buffer_header_length, send_buffer_message_length;
+	long send_buffer_message_actual_length;
+
+	MX_SOCKET *mx_socket;
+	unsigned long data_format;
+	mx_bool_type use_zero_copy;
+	void *zero_copy_data = NULL;
+	long zero_copy_length = 0;
+	mx_status_type mx_status;
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	if ( socket_handler == (MX_SOCKET_HANDLER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_SOCKET_HANDLER pointer passed was NULL." );
+	}
+	if ( network_message == (MX_NETWORK_MESSAGE_BUFFER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_MESSAGE_BUFFER pointer passed was NULL." );
+	}
+
+	mx_socket = socket_handler->mx_socket;
+
+#if NETWORK_DEBUG_MESSAGE_IDS
+	MX_DEBUG(-2,("%s: [%#lx] sending '%s.%s' to socket %d",
+		fname, (unsigned long) message_id_for_client,
+		record->name, record_field->name,
+		(int) mx_socket->socket_fd ));
+#endif
+
+	/* Construct the response header. */
+
+	send_buffer_header_length =
+		(long) mx_remote_header_length(socket_handler);
+
+	send_buffer_message_actual_length = 0;
+
+	/* What data format do we use to send the response? */
+
+	data_format = socket_handler->data_format;
+
+	/* Large contiguous binary arrays are sent straight from the field
+	 * storage, so only the header is constructed in the message buffer.
+	 */
+
+	use_zero_copy = mxsrv_get_zero_copy_data( socket_handler, record_field,
+					&zero_copy_data, &zero_copy_length );
+
+	if ( use_zero_copy ) {
+		send_buffer_message_actual_length = zero_copy_length;
+	} else {
+		mx_status = mxsrv_encode_field_value( socket_handler,
+					record, record_field,
+					network_message,
+					send_buffer_header_length,
+					&send_buffer_message_actual_length );
+
+		/* ASCII data transfers do not currently support dynamically
+		 * resizing network buffers, so we return instead if we get
+		 * an MXE_WOULD_EXCEED_LIMIT status code.
+		 */
+
+		if ( mx_status.code == MXE_WOULD_EXCEED_LIMIT )
+			return mx_status;
+	}
+
+	send_buffer_message_length = (long)
+		( network_message->buffer_length - send_buffer_header_length );
+
 	/* Make sure these pointers are up to date. */
 
 	send_buffer_header = network_message->u.uint32_buffer;;
@@ -2865,8 +3256,13 @@ mxsrv_send_field_value_to_client(
 	    fprintf( stderr, "\n" );
 	}
 
-	mx_status = mx_network_socket_send_message( mx_socket,
+	if ( use_zero_copy ) {
+		mx_status = mx_network_socket_send_message_with_data( mx_socket,
+					-1.0, network_message, zero_copy_data );
+	} else {
+		mx_status = mx_network_socket_send_message( mx_socket,
 						-1.0, network_message );
+	}
 
 	if ( mx_status.code != MXE_SUCCESS ) {
 		if ( record != NULL ) {
@@ -2894,39 +3290,23 @@ mxsrv_send_field_value_to_client(
 
 /*--------------------------------------------------------------------------*/
 
-mx_status_type
-mxsrv_handle_put_array( MX_RECORD *record_list,
-			MX_SOCKET_HANDLER *socket_handler,
+/* mxsrv_decode_field_value() copies a value sent by a client in the
+ * client's data format into a record field.
+ */
+
+static mx_status_type
+mxsrv_decode_field_value( MX_SOCKET_HANDLER *socket_handler,
 			MX_RECORD *record,
 			MX_RECORD_FIELD *record_field,
-			MX_NETWORK_MESSAGE_BUFFER *network_message,
-			void *value_buffer_ptr )
+			char *value_buffer,
+			long buffer_left,
+			size_t *num_value_bytes )
 {
-	static const char fname[] = "mxsrv_handle_put_array()";
-
-	char location[ sizeof(fname) + 40 ];
-	char *receive_buffer_message;
-	uint32_t *receive_buffer_header;
-	uint32_t receive_buffer_header_length;
-	uint32_t receive_buffer_message_length;
-	uint32_t receive_buffer_message_type;
-	uint32_t receive_buffer_message_id;
-	uint32_t send_buffer_message_type;
-	long receive_datatype;
-
-	char *send_buffer_message;
-	char *value_buffer = NULL;
-	uint32_t *send_buffer_header;
-	uint32_t send_buffer_header_length, send_buffer_message_length;
-	size_t num_value_bytes;
+	static const char fname[] = "mxsrv_decode_field_value()";
 
-	MX_SOCKET *mx_socket;
 	MX_RECORD_FIELD_PARSE_STATUS parse_status;
 	char token_buffer[500];
 	void *pointer_to_value;
-	long message_buffer_used, buffer_left;
-
-	mx_bool_type check_for_callbacks;
 
 #if defined(_WIN64)
 	uint64_t i, xdr_ptr_address, xdr_remainder, xdr_gap_size;
@@ -2941,14 +3321,223 @@ mxsrv_handle_put_array( MX_RECORD *record_list,
 
 	char separators[] = MX_RECORD_FIELD_SEPARATORS;
 
-#if NETWORK_DEBUG_TIMING
-	MX_HRT_TIMING measurement;
+	*num_value_bytes = 0;
 
-	MX_HRT_START( measurement );
-#endif
+	if ( record_field->flags & MXFF_VARARGS ) {
+		array_is_dynamically_allocated = TRUE;
+	} else {
+		array_is_dynamically_allocated = FALSE;
+	}
 
-	/* If the socket handler pointer is NULL, then we have no way
-	 * to return a response to the (hypothetical?) client.
+	pointer_to_value = mx_get_field_value_pointer( record_field );
+
+	mx_status = mx_get_token_parser( record_field->datatype, &token_parser );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	switch( socket_handler->data_format ) {
+	case MX_NETWORK_DATAFMT_ASCII:
+
+		/* The data were sent in ASCII MX database format. */
+
+#if 0 && NETWORK_DEBUG_VERBOSE
+		MX_DEBUG(-2,("%s: value_string = '%s'",
+					fname, value_string));
+#endif
+
+		mx_initialize_parse_status( &parse_status,
+					value_buffer, separators );
+
+		/* If this is a string field, get the maximum length of
+		 * a string token for use by the parser.
+		 */
+
+		if ( record_field->datatype == MXFT_STRING ) {
+			parse_status.max_string_token_length =
+			 mx_get_max_string_token_length( record_field );
+		} else {
+			parse_status.max_string_token_length = 0L;
+		}
+
+		/* Parse the tokens. */
+
+		if ( (record_field->num_dimensions == 0)
+                  || ((record_field->datatype == MXFT_STRING)
+		   && (record_field->num_dimensions == 1)) ) {
+
+                        mx_status = mx_get_next_record_token(
+				&parse_status,
+                                        token_buffer, sizeof(token_buffer) );
+
+                        if ( mx_status.code == MXE_SUCCESS ) {
+#if NETWORK_DEBUG_VERBOSE
+				MX_DEBUG(-2,
+			    ("%s: calling *token_parser() for '%s.%s'",
+			    fname, record->name, record_field->name));
+#endif
+
+	                        mx_status = ( *token_parser ) (
+					pointer_to_value,
+					token_buffer,
+					record, record_field,
+					&parse_status );
+			}
+                } else {
+
+#if NETWORK_DEBUG_VERBOSE
+			MX_DEBUG(-2,
+		("%s: calling mx_parse_array_description for '%s.%s'",
+			fname, record->name, record_field->name));
+#endif
+			mx_status = mx_parse_array_description(
+                                        pointer_to_value,
+                                        (record_field->num_dimensions - 1),
+                                        record, record_field,
+                                        &parse_status, token_parser );
+                	}
+
+		*num_value_bytes = strlen( value_buffer );
+		break;
+
+	case MX_NETWORK_DATAFMT_RAW:
+	case MX_NETWORK_DATAFMT_BYTESWAP:
+
+		/* Note: MX expects the clients to perform any byte
+		 * swapping, so the MX server assumes that the data
+		 * sent by the client is already byte swapped.
+		 */
+
+		mx_status = mx_copy_network_buffer_to_array(
+				value_buffer,
+				buffer_left,
+				pointer_to_value,
+				array_is_dynamically_allocated,
+				record_field->datatype,
+				record_field->num_dimensions,
+				record_field->dimension,
+				record_field->data_element_size,
+				num_value_bytes,
+			    socket_handler->use_64bit_network_longs,
+			    socket_handler->remote_mx_version );
+		break;
+
+	case MX_NETWORK_DATAFMT_XDR:
+		/* XDR is a legacy format intended for use with
+		 * MX servers before MX 2.2.
+		 */
+#if HAVE_XDR
+		/* The XDR data pointer 'ptr' must be aligned on a
+		 * 4 byte address boundary for XDR data conversion
+		 * to work correctly on all architectures.  If the
+		 * pointer does not point to an address that is a
+		 * multiple of 4 bytes, we move it to the next address
+		 * that _is_ and fill the bytes inbetween with zeros.
+	 	 */
+
+#if defined(_WIN64)
+		xdr_ptr_address = (uint64_t) value_buffer;
+#else
+		xdr_ptr_address = (unsigned long) value_buffer;
+#endif
+
+		xdr_remainder = xdr_ptr_address % 4;
+
+		if ( xdr_remainder != 0 ) {
+			xdr_gap_size = 4 - xdr_remainder;
+
+			for ( i = 0; i < xdr_gap_size; i++ ) {
+				value_buffer[i] = '\0';
+			}
+
+			value_buffer += xdr_gap_size;
+
+			buffer_left -= xdr_gap_size;
+		}
+
+#if defined(_WIN64)
+		MX_DEBUG( 2,
+		("%s: ptr_address = %#I64x, value_buffer = %p",
+			fname, xdr_ptr_address, value_buffer));
+#else
+		MX_DEBUG( 2,
+		("%s: ptr_address = %#lx, value_buffer = %p",
+			fname, xdr_ptr_address, value_buffer));
+#endif
+
+		/* Now we are ready to do the XDR data conversion. */
+
+		mx_status = mx_xdr_data_transfer(
+				MX_XDR_DECODE,
+				pointer_to_value,
+				array_is_dynamically_allocated,
+				record_field->datatype,
+				record_field->num_dimensions,
+				record_field->dimension,
+				record_field->data_element_size,
+				value_buffer,
+				buffer_left,
+				num_value_bytes );
+#else
+		mx_status = mx_error( MXE_UNSUPPORTED, fname,
+			"XDR network data format is not supported "
+			"on this system." );
+#endif
+		break;
+
+	default:
+		mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+	    "Unrecognized network data format type %lu was requested.",
+	    		socket_handler->data_format );
+		break;
+	}
+
+	return mx_status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+mx_status_type
+mxsrv_handle_put_array( MX_RECORD *record_list,
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_RECORD *record,
+			MX_RECORD_FIELD *record_field,
+			MX_NETWORK_MESSAGE_BUFFER *network_message,
+			void *value_buffer_ptr )
+{
+	static const char fname[] = "mxsrv_handle_put_array()";
+
+	char location[ sizeof(fname) + 40 ];
+	char *receive_buffer_message;
+	uint32_t *receive_buffer_header;
+	uint32_t receive_buffer_header_length;
+	uint32_t receive_buffer_message_length;
+	uint32_t receive_buffer_message_type;
+	uint32_t receive_buffer_message_id;
+	uint32_t send_buffer_message_type;
+	long receive_datatype;
+
+	char *send_buffer_message;
+	char *value_buffer = NULL;
+	uint32_t *send_buffer_header;
+	uint32_t send_buffer_header_length, send_buffer_message_length;
+	size_t num_value_bytes;
+
+	MX_SOCKET *mx_socket;
+	long message_buffer_used, buffer_left;
+
+	mx_bool_type check_for_callbacks;
+
+	mx_status_type mx_status;
+
+#if NETWORK_DEBUG_TIMING
+	MX_HRT_TIMING measurement;
+
+	MX_HRT_START( measurement );
+#endif
+
+	/* If the socket handler pointer is NULL, then we have no way
+	 * to return a response to the (hypothetical?) client.
 	 */
 
 	if ( socket_handler == (MX_SOCKET_HANDLER *) NULL ) {
@@ -3037,28 +3626,12 @@ mxsrv_handle_put_array( MX_RECORD *record_list,
 			break;		/* Exit the do...while(0) loop. */
 		}
 
-		/* Get some parameters from the field. */
-
-		if ( record_field->flags & MXFF_VARARGS ) {
-			array_is_dynamically_allocated = TRUE;
-		} else {
-			array_is_dynamically_allocated = FALSE;
-		}
-
 #if NETWORK_DEBUG_FIELD_NAMES
 	        MX_DEBUG(-2,("%s: record_name = '%s'", fname, record->name));
 		MX_DEBUG(-2,("%s: field_name = '%s'", fname,
 						record_field->name));
 #endif
 
-		pointer_to_value = mx_get_field_value_pointer( record_field );
-
-	        mx_status = mx_get_token_parser(
-                        record_field->datatype, &token_parser );
-
-		if ( mx_status.code != MXE_SUCCESS )
-			break;		/* Exit the do...while(0) loop. */
-
 		/* Get a pointer to the start of the value string. */
 
 		receive_buffer_message  = network_message->u.char_buffer;
@@ -3095,368 +3668,911 @@ mxsrv_handle_put_array( MX_RECORD *record_list,
 			break;		/* Exit the do...while(0) loop. */
 		}
 
-		switch( socket_handler->data_format ) {
-		case MX_NETWORK_DATAFMT_ASCII:
+		mx_status = mxsrv_decode_field_value( socket_handler,
+					record, record_field,
+					value_buffer, buffer_left,
+					&num_value_bytes );
 
-			/* The data were sent in ASCII MX database format. */
+		if ( mx_status.code != MXE_SUCCESS )
+			break;		/* Exit the do...while(0) loop. */
 
-#if 0 && NETWORK_DEBUG_VERBOSE
-			MX_DEBUG(-2,("%s: value_string = '%s'",
-						fname, value_string));
-#endif
+		/* Send the client request just received to the hardware. */
 
-			mx_initialize_parse_status( &parse_status,
-						value_buffer, separators );
+		mx_status = mxsrv_process_record_field_for_client(
+					record, record_field,
+					socket_handler, MX_PROCESS_PUT );
 
-			/* If this is a string field, get the maximum length of
-			 * a string token for use by the parser.
-			 */
+		if ( mx_status.code == MXE_SUCCESS ) {
+			check_for_callbacks = TRUE;
+		}
+	} while (0);
 
-			if ( record_field->datatype == MXFT_STRING ) {
-				parse_status.max_string_token_length =
-				 mx_get_max_string_token_length( record_field );
-			} else {
-				parse_status.max_string_token_length = 0L;
-			}
+	/* Bug compatibility for old MX clients. */
 
-			/* Parse the tokens. */
+	if ( ( mx_client_supports_message_ids(socket_handler) == FALSE )
+	  && ( receive_buffer_message_type == MX_NETMSG_PUT_ARRAY_BY_HANDLE ) )
+	{
+		/* MX clients prior to MX 1.5 expected the wrong server
+		 * response type for 'put array by handle' messages.
+		 */
 
-			if ( (record_field->num_dimensions == 0)
-	                  || ((record_field->datatype == MXFT_STRING)
-			   && (record_field->num_dimensions == 1)) ) {
+		send_buffer_message_type =
+			mx_server_response(MX_NETMSG_PUT_ARRAY_BY_NAME);
+	} else {
+		send_buffer_message_type =
+			mx_server_response( receive_buffer_message_type );
+	}
 
-	                        mx_status = mx_get_next_record_token(
-					&parse_status,
-                                        token_buffer, sizeof(token_buffer) );
+	/* Allocate a buffer to construct the message to be sent
+	 * back to the client.
+	 */
 
-	                        if ( mx_status.code == MXE_SUCCESS ) {
-#if NETWORK_DEBUG_VERBOSE
-					MX_DEBUG(-2,
-				    ("%s: calling *token_parser() for '%s.%s'",
-				    fname, record->name, record_field->name));
-#endif
+	send_buffer_header_length = mx_remote_header_length(socket_handler);
 
-		                        mx_status = ( *token_parser ) (
-						pointer_to_value,
-						token_buffer,
-						record, record_field,
-						&parse_status );
-				}
-	                } else {
+        if ( mx_status.code == MXE_SUCCESS ) {
+		send_buffer_message_length = 1;
+	} else {
+		send_buffer_message_length = (uint32_t)
+			( 1 + strlen(mx_status.message) );
+	}
 
-#if NETWORK_DEBUG_VERBOSE
-				MX_DEBUG(-2,
-			("%s: calling mx_parse_array_description for '%s.%s'",
-				fname, record->name, record_field->name));
-#endif
-				mx_status = mx_parse_array_description(
-                                        pointer_to_value,
-                                        (record_field->num_dimensions - 1),
-                                        record, record_field,
-                                        &parse_status, token_parser );
-                	}
+	send_buffer_header = network_message->u.uint32_buffer;
 
-			num_value_bytes = strlen( value_buffer );
-			break;
+	send_buffer_message  = network_message->u.char_buffer;
+	send_buffer_message += send_buffer_header_length;
 
-		case MX_NETWORK_DATAFMT_RAW:
-		case MX_NETWORK_DATAFMT_BYTESWAP:
+	send_buffer_header[ MX_NETWORK_STATUS_CODE ] = mx_htonl(mx_status.code);
 
-			/* Note: MX expects the clients to perform any byte
-			 * swapping, so the MX server assumes that the data
-			 * sent by the client is already byte swapped.
-			 */
+        if ( mx_status.code == MXE_SUCCESS ) {
+		strlcpy( send_buffer_message, "", send_buffer_message_length );
+	} else {
+		strlcpy( send_buffer_message, mx_status.message,
+						send_buffer_message_length );
+	}
 
-			mx_status = mx_copy_network_buffer_to_array(
-					value_buffer,
-					buffer_left,
-					pointer_to_value,
-					array_is_dynamically_allocated,
-					record_field->datatype,
-					record_field->num_dimensions,
-					record_field->dimension,
-					record_field->data_element_size,
-					&num_value_bytes,
-				    socket_handler->use_64bit_network_longs,
-				    socket_handler->remote_mx_version );
-			break;
+	send_buffer_header[ MX_NETWORK_MAGIC ]
+				= mx_htonl( MX_NETWORK_MAGIC_VALUE );
 
-		case MX_NETWORK_DATAFMT_XDR:
-			/* XDR is a legacy format intended for use with
-			 * MX servers before MX 2.2.
-			 */
-#if HAVE_XDR
-			/* The XDR data pointer 'ptr' must be aligned on a
-			 * 4 byte address boundary for XDR data conversion
-			 * to work correctly on all architectures.  If the
-			 * pointer does not point to an address that is a
-			 * multiple of 4 bytes, we move it to the next address
-			 * that _is_ and fill the bytes inbetween with zeros.
-		 	 */
+	send_buffer_header[ MX_NETWORK_MESSAGE_TYPE ]
+				= mx_htonl( send_buffer_message_type );
 
-#if defined(_WIN64)
-			xdr_ptr_address = (uint64_t) value_buffer;
-#else
-			xdr_ptr_address = (unsigned long) value_buffer;
-#endif
+	send_buffer_header[ MX_NETWORK_HEADER_LENGTH ]
+				= mx_htonl( send_buffer_header_length );
 
-			xdr_remainder = xdr_ptr_address % 4;
+	send_buffer_header[ MX_NETWORK_MESSAGE_LENGTH ]
+				= mx_htonl( send_buffer_message_length );
 
-			if ( xdr_remainder != 0 ) {
-				xdr_gap_size = 4 - xdr_remainder;
+	if ( mx_client_supports_message_ids(socket_handler) ) {
 
-				for ( i = 0; i < xdr_gap_size; i++ ) {
-					value_buffer[i] = '\0';
-				}
+		send_buffer_header[ MX_NETWORK_DATA_TYPE ]
+				= mx_htonl( record_field->datatype );
 
-				value_buffer += xdr_gap_size;
+		send_buffer_header[ MX_NETWORK_MESSAGE_ID ]
+				= mx_htonl( receive_buffer_message_id );
+	}
 
-				buffer_left -= xdr_gap_size;
-			}
+	/* Send the string description back to the client. */
 
-#if defined(_WIN64)
-			MX_DEBUG( 2,
-			("%s: ptr_address = %#I64x, value_buffer = %p",
-				fname, xdr_ptr_address, value_buffer));
-#else
-			MX_DEBUG( 2,
-			("%s: ptr_address = %#lx, value_buffer = %p",
-				fname, xdr_ptr_address, value_buffer));
-#endif
+#if NETWORK_DEBUG
+	{
+		char text_buffer[200];
 
-			/* Now we are ready to do the XDR data conversion. */
+		snprintf( text_buffer, sizeof(text_buffer),
+			"%s: sending response = '", fname );
 
-			mx_status = mx_xdr_data_transfer(
-					MX_XDR_DECODE,
-					pointer_to_value,
-					array_is_dynamically_allocated,
-					record_field->datatype,
-					record_field->num_dimensions,
-					record_field->dimension,
-					record_field->data_element_size,
-					value_buffer,
-					buffer_left,
-					&num_value_bytes );
-#else
-			mx_status = mx_error( MXE_UNSUPPORTED, fname,
-				"XDR network data format is not supported "
-				"on this system." );
+		buffer_left = sizeof(text_buffer) - strlen(text_buffer) - 6;
+
+		strlcat( text_buffer, send_buffer_message, sizeof(text_buffer));
+
+		if ( buffer_left < send_buffer_message_length ) {
+			strlcat( text_buffer, "***'", sizeof(text_buffer) );
+		} else {
+			strlcat( text_buffer, "'", sizeof(text_buffer) );
+		}
+
+		MX_DEBUG(-2,("%s", text_buffer));
+	}
 #endif
-			break;
 
-		default:
-			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-		    "Unrecognized network data format type %lu was requested.",
-		    		socket_handler->data_format );
-			break;
+	if ( socket_handler->network_debug_flags & MXF_NETDBG_DUMP ) {
+		MX_LIST_HEAD *list_head;
+
+		list_head = mx_get_record_list_head_struct( record );
+
+		if ( list_head == (MX_LIST_HEAD *) NULL ) {
+			return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+			"The MX_LIST_HEAD structure pointer for record '%s' "
+			"is NULL.", record->name );
+		}
+
+		mx_network_dump_message( network_message,
+					socket_handler->data_format,
+					list_head->max_network_dump_bytes );
+	}
+
+	if ( socket_handler->network_debug_flags & MXF_NETDBG_VERBOSE ) {
+		fprintf( stderr, "\nMX NET: SERVER -> CLIENT (socket %d)\n",
+				(int) mx_socket->socket_fd );
+
+		mx_network_display_message( network_message, record_field,
+				socket_handler->use_64bit_network_longs );
+	}
+
+	if ( socket_handler->network_debug_flags & MXF_NETDBG_SUMMARY ) {
+		mxsrv_print_timestamp();
+
+		if ( socket_handler->network_debug_flags & MXF_NETDBG_MSG_IDS )
+		{
+			fprintf( stderr, "[%#lx] ",
+					socket_handler->last_rpc_message_id );
+		}
+
+		fprintf( stderr,
+			"MX (socket %d) PUT_ARRAY('%s.%s') = ",
+			(int) socket_handler->mx_socket->socket_fd,
+			record->name,
+			record_field->name );
+
+		mx_network_buffer_show_value(
+				value_buffer,
+				socket_handler->data_format,
+				record_field->datatype,
+				receive_buffer_message_type,
+				num_value_bytes,
+				socket_handler->use_64bit_network_longs );
+
+		fprintf( stderr, "\n" );
+	}
+
+#if 0
+		MX_DEBUG(-2,
+		("%s: Before send: receive_buffer_message_id = %#lx",
+			fname, receive_buffer_message_id));
+		MX_DEBUG(-2,
+		("%s: Before send: last_rpc_message_id = %#lx",
+			fname, socket_handler->last_rpc_message_id));
+		MX_DEBUG(-2,
+		("%s: Before send: send buffer message id = %#lx", fname,
+		mx_ntohl( send_buffer_header[ MX_NETWORK_MESSAGE_ID ] ) ));
+#endif
+
+	mx_status = mx_network_socket_send_message( mx_socket,
+						-1.0, network_message );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		snprintf( location, sizeof(location),
+				"%s to client socket %d",
+				fname, mx_socket->socket_fd );
+
+		return mx_error( mx_status.code, location,
+					"%s", mx_status.message );
+	}
+
+	MX_DEBUG( 1,("***** %s successful *****", fname));
+
+	/* If necessary, we now check to see if any callbacks need to be
+	 * invoked as a consequence of the record field processing above.
+	 */
+
+	if ( check_for_callbacks ) {
+		mx_bool_type value_changed;
+
+		mx_status = mx_test_for_value_changed( record_field,
+							MX_PROCESS_PUT,
+							&value_changed );
+
+		if ( value_changed
+		  && (record_field->callback_list != NULL) )
+		{
+			mx_status = mx_local_field_invoke_callback_list(
+					record_field, MXCBT_VALUE_CHANGED );
+		}
+	}
+
+#if NETWORK_DEBUG_TIMING
+	MX_HRT_END( measurement );
+
+	MX_HRT_RESULTS( measurement, fname,
+		"for '%s.%s'", record->name, record_field->name );
+#endif
+
+	MXW_UNUSED( receive_datatype );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* mxsrv_reserve_batch_space() makes sure that a network message buffer
+ * has room for at least 'needed_length' bytes.
+ */
+
+static mx_status_type
+mxsrv_reserve_batch_space( MX_NETWORK_MESSAGE_BUFFER *network_message,
+				size_t needed_length )
+{
+	size_t new_length;
+	mx_status_type mx_status;
+
+	if ( network_message->buffer_length >= needed_length )
+		return MX_SUCCESSFUL_RESULT;
+
+	new_length = 2 * network_message->buffer_length;
+
+	if ( new_length < needed_length ) {
+		new_length = needed_length;
+	}
+
+	mx_status = mx_reallocate_network_buffer( network_message, new_length );
+
+	return mx_status;
+}
+
+#define MXSRV_BATCH_PAD(n)	( ( (n) + 3 ) & ~((size_t) 3) )
+
+/* mxsrv_get_batch_fields() converts the list of network handles at the
+ * start of a batch message into record and record field pointers.  For
+ * MX_NETMSG_GET_ARRAY_BATCH messages the handles are adjacent, while for
+ * MX_NETMSG_PUT_ARRAY_BATCH messages each pair of handles is followed by
+ * the value to be written.  The offsets of the put values are returned
+ * in 'value_offset_array'.
+ */
+
+static mx_status_type
+mxsrv_get_batch_fields( MX_RECORD *record_list,
+			MX_NETWORK_MESSAGE_BUFFER *network_message,
+			mx_bool_type is_put,
+			unsigned long *num_fields,
+			MX_RECORD ***record_array,
+			MX_RECORD_FIELD ***field_array,
+			mx_status_type **status_array,
+			size_t **value_offset_array )
+{
+	static const char fname[] = "mxsrv_get_batch_fields()";
+
+	MX_LIST_HEAD *list_head;
+	uint32_t *header;
+	uint32_t header_length, message_length, value_length;
+	size_t offset, end_of_message, entry_length;
+	unsigned long i;
+	long record_handle, field_handle;
+
+	*num_fields = 0;
+	*record_array = NULL;
+	*field_array = NULL;
+	*status_array = NULL;
+	*value_offset_array = NULL;
+
+	list_head = mx_get_record_list_head_struct( record_list );
+
+	header = network_message->u.uint32_buffer;
+
+	header_length  = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+	message_length = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
+
+	end_of_message = header_length + message_length;
+
+	if ( message_length < sizeof(uint32_t) ) {
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"The batch message body is too short (%lu bytes) to contain "
+		"a field count.", (unsigned long) message_length );
+	}
+
+	*num_fields = mx_ntohl( header[ header_length / sizeof(uint32_t) ] );
+
+	if ( is_put ) {
+		entry_length = 3 * sizeof(uint32_t);
+	} else {
+		entry_length = 2 * sizeof(uint32_t);
+	}
+
+	if ( (*num_fields) > (message_length / entry_length) ) {
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"The field count (%lu) in a batch message is larger than "
+		"will fit in the %lu byte message body.",
+			*num_fields, (unsigned long) message_length );
+	}
+
+	if ( (*num_fields) == 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	*record_array = calloc( *num_fields, sizeof(MX_RECORD *) );
+	*field_array = calloc( *num_fields, sizeof(MX_RECORD_FIELD *) );
+	*status_array = calloc( *num_fields, sizeof(mx_status_type) );
+
+	if ( is_put ) {
+		*value_offset_array = calloc( *num_fields, sizeof(size_t) );
+	}
+
+	if ( ( (*record_array) == NULL ) || ( (*field_array) == NULL )
+	  || ( (*status_array) == NULL )
+	  || ( is_put && ( (*value_offset_array) == NULL ) ) )
+	{
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate arrays "
+		"for a %lu field batch message.", *num_fields );
+	}
+
+	offset = header_length + sizeof(uint32_t);
+
+	for ( i = 0; i < (*num_fields); i++ ) {
+		if ( ( offset + entry_length ) > end_of_message ) {
+			return mx_error( MXE_NETWORK_IO_ERROR, fname,
+			"Batch message entry %lu extends past the end "
+			"of the message.", i );
 		}
 
+		header = network_message->u.uint32_buffer
+				+ ( offset / sizeof(uint32_t) );
+
+		record_handle = (long) mx_ntohl( header[0] );
+		field_handle  = (long) mx_ntohl( header[1] );
+
+		offset += entry_length;
+
+		if ( is_put ) {
+			value_length = mx_ntohl( header[2] );
+
+			if ( ( offset + value_length ) > end_of_message ) {
+				return mx_error( MXE_NETWORK_IO_ERROR, fname,
+				"The value for batch message entry %lu "
+				"extends past the end of the message.", i );
+			}
+
+			(*value_offset_array)[i] = offset;
+
+			offset += MXSRV_BATCH_PAD( value_length );
+		}
+
+		(*status_array)[i] = mxsrv_get_field_from_handle( list_head,
+					record_handle, field_handle,
+					&((*record_array)[i]),
+					&((*field_array)[i]) );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*--------------------------------------------------------------------------*/
+
+static void
+mxsrv_free_batch_fields( MX_RECORD **record_array,
+			MX_RECORD_FIELD **field_array,
+			mx_status_type *status_array,
+			size_t *value_offset_array )
+{
+	mx_free( record_array );
+	mx_free( field_array );
+	mx_free( status_array );
+	mx_free( value_offset_array );
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* After the response to a batch message has been sent, we check whether
+ * any callbacks must be invoked and update the event time managers, just
+ * as is done for single get_array and put_array messages.
+ */
+
+static void
+mxsrv_finish_batch_fields( unsigned long num_fields,
+			MX_RECORD **record_array,
+			MX_RECORD_FIELD **field_array,
+			mx_status_type *status_array,
+			int operation )
+{
+	MX_RECORD *record;
+	MX_RECORD_FIELD *record_field;
+	mx_bool_type value_changed;
+	unsigned long i;
+
+	for ( i = 0; i < num_fields; i++ ) {
+		if ( status_array[i].code != MXE_SUCCESS )
+			continue;
+
+		record = record_array[i];
+		record_field = field_array[i];
+
+		(void) mx_test_for_value_changed( record_field,
+						operation, &value_changed );
+
+		if ( value_changed
+		  && (record_field->callback_list != NULL) )
+		{
+			(void) mx_local_field_invoke_callback_list(
+					record_field, MXCBT_VALUE_CHANGED );
+		}
+
+		if ( record->event_time_manager != NULL ) {
+			(void) mx_update_next_allowed_event_time( record,
+								record_field );
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------*/
+
+static mx_status_type
+mxsrv_send_batch_response( MX_SOCKET_HANDLER *socket_handler,
+			MX_NETWORK_MESSAGE_BUFFER *network_message,
+			uint32_t message_type_for_client,
+			uint32_t message_id_for_client,
+			size_t end_of_message,
+			unsigned long num_fields,
+			const char *label )
+{
+	static const char fname[] = "mxsrv_send_batch_response()";
+
+	char location[ sizeof(fname) + 40 ];
+	uint32_t *header;
+	uint32_t header_length;
+	MX_SOCKET *mx_socket;
+	mx_status_type mx_status;
+
+	mx_socket = socket_handler->mx_socket;
+
+	header = network_message->u.uint32_buffer;
+
+	header_length = mx_remote_header_length(socket_handler);
+
+	header[ MX_NETWORK_MAGIC ] = mx_htonl( MX_NETWORK_MAGIC_VALUE );
+	header[ MX_NETWORK_HEADER_LENGTH ] = mx_htonl( header_length );
+	header[ MX_NETWORK_MESSAGE_LENGTH ]
+			= mx_htonl( end_of_message - header_length );
+	header[ MX_NETWORK_STATUS_CODE ] = mx_htonl( MXE_SUCCESS );
+	header[ MX_NETWORK_MESSAGE_TYPE ] = mx_htonl( message_type_for_client );
+	header[ MX_NETWORK_DATA_TYPE ] = mx_htonl( 0 );
+	header[ MX_NETWORK_MESSAGE_ID ] = mx_htonl( message_id_for_client );
+
+	header[ header_length / sizeof(uint32_t) ] = mx_htonl( num_fields );
+
+	if ( socket_handler->network_debug_flags & MXF_NETDBG_SUMMARY ) {
+		mxsrv_print_timestamp();
+
+		if ( socket_handler->network_debug_flags & MXF_NETDBG_MSG_IDS )
+		{
+			fprintf( stderr, "[%#lx] ",
+				(unsigned long) message_id_for_client );
+		}
+
+		fprintf( stderr, "MX (socket %d) %s( %lu fields )\n",
+			(int) mx_socket->socket_fd, label, num_fields );
+	}
+
+	mx_status = mx_network_socket_send_message( mx_socket,
+						-1.0, network_message );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		snprintf( location, sizeof(location),
+				"%s to client socket %d",
+				fname, mx_socket->socket_fd );
+
+		return mx_error( mx_status.code, location,
+					"%s", mx_status.message );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* mxsrv_batch_create() decodes the list of fields in a GET_ARRAY_BATCH
+ * or PUT_ARRAY_BATCH message that is in 'network_message'.
+ */
+
+mx_status_type
+mxsrv_batch_create( MX_RECORD *record_list,
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_NETWORK_MESSAGE_BUFFER *network_message,
+			MXSRV_BATCH **batch_ptr )
+{
+	static const char fname[] = "mxsrv_batch_create()";
+
+	MXSRV_BATCH *batch;
+	uint32_t *header;
+	mx_status_type mx_status;
+
+	*batch_ptr = NULL;
+
+	batch = (MXSRV_BATCH *) calloc( 1, sizeof(MXSRV_BATCH) );
+
+	if ( batch == (MXSRV_BATCH *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an MXSRV_BATCH." );
+	}
+
+	header = network_message->u.uint32_buffer;
+
+	batch->socket_handler = socket_handler;
+	batch->network_message = network_message;
+	batch->message_type = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
+	batch->message_id   = mx_ntohl( header[ MX_NETWORK_MESSAGE_ID ] );
+
+	if ( batch->message_type == MX_NETMSG_PUT_ARRAY_BATCH ) {
+		batch->is_put = TRUE;
+	} else {
+		batch->is_put = FALSE;
+	}
+
+	batch->num_parts_pending = 0;
+
+	mx_status = mxsrv_get_batch_fields( record_list, network_message,
+					batch->is_put, &(batch->num_fields),
+					&(batch->record_array),
+					&(batch->field_array),
+					&(batch->status_array),
+					&(batch->value_offset_array) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mxsrv_batch_destroy( batch );
+		return mx_status;
+	}
+
+	*batch_ptr = batch;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+void
+mxsrv_batch_destroy( MXSRV_BATCH *batch )
+{
+	if ( batch == (MXSRV_BATCH *) NULL )
+		return;
+
+	mxsrv_free_batch_fields( batch->record_array, batch->field_array,
+			batch->status_array, batch->value_offset_array );
+
+	mx_free( batch );
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* mxsrv_batch_process_field() reads or writes field 'i' of a batch.
+ * The result is left in the batch's status array.
+ */
+
+void
+mxsrv_batch_process_field( MXSRV_BATCH *batch, unsigned long i )
+{
+	static const char fname[] = "mxsrv_batch_process_field()";
+
+	MX_SOCKET_HANDLER *socket_handler;
+	MX_RECORD *record;
+	MX_RECORD_FIELD *record_field;
+	char *value_buffer;
+	uint32_t *entry;
+	uint32_t value_length;
+	size_t num_value_bytes;
+
+	if ( batch->status_array[i].code != MXE_SUCCESS )
+		return;
+
+	socket_handler = batch->socket_handler;
+	record = batch->record_array[i];
+	record_field = batch->field_array[i];
+
+	if ( record_field->flags & MXFF_NO_ACCESS ) {
+		batch->status_array[i] = mx_error( MXE_PERMISSION_DENIED,
+		fname, "MX record field '%s.%s' can not be accessed "
+		"by an MX client program.",
+			record->name, record_field->name );
+		return;
+	}
+
+	if ( batch->is_put == FALSE ) {
+		batch->status_array[i] = mxsrv_process_record_field_for_client(
+					record, record_field,
+					socket_handler, MX_PROCESS_GET );
+		return;
+	}
+
+	if ( record_field->flags & MXFF_READ_ONLY ) {
+		batch->status_array[i] = mx_error( MXE_READ_ONLY, fname,
+		"MX record field '%s.%s' is read-only.",
+			record->name, record_field->name );
+		return;
+	}
+
+	value_buffer = batch->network_message->u.char_buffer
+				+ batch->value_offset_array[i];
+
+	entry = (uint32_t *) ( value_buffer - sizeof(uint32_t) );
+
+	value_length = mx_ntohl( entry[0] );
+
+	if ( ( socket_handler->data_format == MX_NETWORK_DATAFMT_ASCII )
+	  && ( ( value_length == 0 )
+	    || ( value_buffer[ value_length - 1 ] != '\0' ) ) )
+	{
+		batch->status_array[i] = mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"The ASCII value sent for MX record field '%s.%s' "
+		"is not null terminated.",
+			record->name, record_field->name );
+		return;
+	}
+
+	batch->status_array[i] = mxsrv_decode_field_value( socket_handler,
+					record, record_field,
+					value_buffer, (long) value_length,
+					&num_value_bytes );
+
+	if ( batch->status_array[i].code != MXE_SUCCESS )
+		return;
+
+	batch->status_array[i] = mxsrv_process_record_field_for_client(
+					record, record_field,
+					socket_handler, MX_PROCESS_PUT );
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* mxsrv_batch_build_get_response() writes the values read for a
+ * GET_ARRAY_BATCH message over the request and returns the length of
+ * the response in 'end_of_message'.
+ */
+
+static mx_status_type
+mxsrv_batch_build_get_response( MXSRV_BATCH *batch, size_t *end_of_message )
+{
+	MX_SOCKET_HANDLER *socket_handler;
+	MX_NETWORK_MESSAGE_BUFFER *network_message;
+	mx_status_type *status_array;
+	uint32_t *entry;
+	unsigned long i;
+	size_t offset, value_offset, message_text_length;
+	long value_length;
+	int attempt;
+	mx_status_type mx_status;
+
+	socket_handler = batch->socket_handler;
+	network_message = batch->network_message;
+	status_array = batch->status_array;
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	offset = mx_remote_header_length(socket_handler) + sizeof(uint32_t);
+
+	for ( i = 0; i < batch->num_fields; i++ ) {
+		value_offset = offset + 3 * sizeof(uint32_t);
+
+		mx_status = mxsrv_reserve_batch_space( network_message,
+							value_offset + 1 );
+
 		if ( mx_status.code != MXE_SUCCESS )
-			break;		/* Exit the do...while(0) loop. */
+			return mx_status;
 
-		/* Send the client request just received to the hardware. */
+		value_length = 0;
+
+		if ( status_array[i].code == MXE_SUCCESS ) {
+
+			/* ASCII values cannot grow the buffer by themselves,
+			 * so we do that for them here.
+			 */
 
-		mx_status = mx_process_record_field_without_callbacks(
-					record, record_field,
-					socket_handler, MX_PROCESS_PUT );
+			for ( attempt = 0; attempt < 10; attempt++ ) {
+				mx_status = mxsrv_encode_field_value(
+					socket_handler,
+					batch->record_array[i],
+					batch->field_array[i],
+					network_message, (long) value_offset,
+					&value_length );
 
-		if ( mx_status.code == MXE_SUCCESS ) {
-			check_for_callbacks = TRUE;
-		}
-	} while (0);
+				if ( mx_status.code != MXE_WOULD_EXCEED_LIMIT )
+					break;
 
-	/* Bug compatibility for old MX clients. */
+				mx_status = mxsrv_reserve_batch_space(
+					network_message,
+					2 * network_message->buffer_length );
 
-	if ( ( mx_client_supports_message_ids(socket_handler) == FALSE )
-	  && ( receive_buffer_message_type == MX_NETMSG_PUT_ARRAY_BY_HANDLE ) )
-	{
-		/* MX clients prior to MX 1.5 expected the wrong server
-		 * response type for 'put array by handle' messages.
-		 */
+				if ( mx_status.code != MXE_SUCCESS )
+					break;
 
-		send_buffer_message_type =
-			mx_server_response(MX_NETMSG_PUT_ARRAY_BY_NAME);
-	} else {
-		send_buffer_message_type =
-			mx_server_response( receive_buffer_message_type );
-	}
+				mx_status.code = MXE_WOULD_EXCEED_LIMIT;
+			}
 
-	/* Allocate a buffer to construct the message to be sent
-	 * back to the client.
-	 */
+			status_array[i] = mx_status;
+		}
 
-	send_buffer_header_length = mx_remote_header_length(socket_handler);
+		if ( status_array[i].code != MXE_SUCCESS ) {
+			message_text_length =
+				strlen( status_array[i].message ) + 1;
 
-        if ( mx_status.code == MXE_SUCCESS ) {
-		send_buffer_message_length = 1;
-	} else {
-		send_buffer_message_length = (uint32_t)
-			( 1 + strlen(mx_status.message) );
-	}
+			mx_status = mxsrv_reserve_batch_space( network_message,
+					value_offset + message_text_length );
 
-	send_buffer_header = network_message->u.uint32_buffer;
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
 
-	send_buffer_message  = network_message->u.char_buffer;
-	send_buffer_message += send_buffer_header_length;
+			strlcpy( network_message->u.char_buffer + value_offset,
+				status_array[i].message, message_text_length );
 
-	send_buffer_header[ MX_NETWORK_STATUS_CODE ] = mx_htonl(mx_status.code);
+			value_length = (long) message_text_length;
+		}
 
-        if ( mx_status.code == MXE_SUCCESS ) {
-		strlcpy( send_buffer_message, "", send_buffer_message_length );
-	} else {
-		strlcpy( send_buffer_message, mx_status.message,
-						send_buffer_message_length );
-	}
+		mx_status = mxsrv_reserve_batch_space( network_message,
+			value_offset + MXSRV_BATCH_PAD( value_length ) );
 
-	send_buffer_header[ MX_NETWORK_MAGIC ]
-				= mx_htonl( MX_NETWORK_MAGIC_VALUE );
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 
-	send_buffer_header[ MX_NETWORK_MESSAGE_TYPE ]
-				= mx_htonl( send_buffer_message_type );
+		memset( network_message->u.char_buffer
+				+ value_offset + value_length, 0,
+			MXSRV_BATCH_PAD( value_length ) - value_length );
 
-	send_buffer_header[ MX_NETWORK_HEADER_LENGTH ]
-				= mx_htonl( send_buffer_header_length );
+		entry = network_message->u.uint32_buffer
+				+ ( offset / sizeof(uint32_t) );
 
-	send_buffer_header[ MX_NETWORK_MESSAGE_LENGTH ]
-				= mx_htonl( send_buffer_message_length );
+		entry[0] = mx_htonl( status_array[i].code );
 
-	if ( mx_client_supports_message_ids(socket_handler) ) {
+		if ( batch->field_array[i] == (MX_RECORD_FIELD *) NULL ) {
+			entry[1] = mx_htonl( 0 );
+		} else {
+			entry[1] = mx_htonl( batch->field_array[i]->datatype );
+		}
 
-		send_buffer_header[ MX_NETWORK_DATA_TYPE ]
-				= mx_htonl( record_field->datatype );
+		entry[2] = mx_htonl( value_length );
 
-		send_buffer_header[ MX_NETWORK_MESSAGE_ID ]
-				= mx_htonl( receive_buffer_message_id );
+		offset = value_offset + MXSRV_BATCH_PAD( value_length );
 	}
 
-	/* Send the string description back to the client. */
+	*end_of_message = offset;
 
-#if NETWORK_DEBUG
-	{
-		char text_buffer[200];
+	return MX_SUCCESSFUL_RESULT;
+}
 
-		snprintf( text_buffer, sizeof(text_buffer),
-			"%s: sending response = '", fname );
+/* mxsrv_batch_build_put_response() writes the status of each of the
+ * values written for a PUT_ARRAY_BATCH message over the request.
+ */
 
-		buffer_left = sizeof(text_buffer) - strlen(text_buffer) - 6;
+static mx_status_type
+mxsrv_batch_build_put_response( MXSRV_BATCH *batch, size_t *end_of_message )
+{
+	MX_NETWORK_MESSAGE_BUFFER *network_message;
+	mx_status_type *status_array;
+	uint32_t *entry;
+	unsigned long i;
+	size_t offset, text_offset, text_length;
+	mx_status_type mx_status;
 
-		strlcat( text_buffer, send_buffer_message, sizeof(text_buffer));
+	network_message = batch->network_message;
+	status_array = batch->status_array;
 
-		if ( buffer_left < send_buffer_message_length ) {
-			strlcat( text_buffer, "***'", sizeof(text_buffer) );
+	offset = mx_remote_header_length(batch->socket_handler)
+						+ sizeof(uint32_t);
+
+	for ( i = 0; i < batch->num_fields; i++ ) {
+		text_offset = offset + 2 * sizeof(uint32_t);
+
+		if ( status_array[i].code == MXE_SUCCESS ) {
+			text_length = 0;
 		} else {
-			strlcat( text_buffer, "'", sizeof(text_buffer) );
+			text_length = strlen( status_array[i].message ) + 1;
 		}
 
-		MX_DEBUG(-2,("%s", text_buffer));
-	}
-#endif
+		mx_status = mxsrv_reserve_batch_space( network_message,
+				text_offset + MXSRV_BATCH_PAD( text_length ) );
 
-	if ( socket_handler->network_debug_flags & MXF_NETDBG_DUMP ) {
-		MX_LIST_HEAD *list_head;
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 
-		list_head = mx_get_record_list_head_struct( record );
+		memset( network_message->u.char_buffer + text_offset, 0,
+					MXSRV_BATCH_PAD( text_length ) );
 
-		if ( list_head == (MX_LIST_HEAD *) NULL ) {
-			return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-			"The MX_LIST_HEAD structure pointer for record '%s' "
-			"is NULL.", record->name );
+		if ( text_length > 0 ) {
+			strlcpy( network_message->u.char_buffer + text_offset,
+				status_array[i].message, text_length );
 		}
 
-		mx_network_dump_message( network_message,
-					socket_handler->data_format,
-					list_head->max_network_dump_bytes );
-	}
+		entry = network_message->u.uint32_buffer
+				+ ( offset / sizeof(uint32_t) );
 
-	if ( socket_handler->network_debug_flags & MXF_NETDBG_VERBOSE ) {
-		fprintf( stderr, "\nMX NET: SERVER -> CLIENT (socket %d)\n",
-				(int) mx_socket->socket_fd );
+		entry[0] = mx_htonl( status_array[i].code );
+		entry[1] = mx_htonl( text_length );
 
-		mx_network_display_message( network_message, record_field,
-				socket_handler->use_64bit_network_longs );
+		offset = text_offset + MXSRV_BATCH_PAD( text_length );
 	}
 
-	if ( socket_handler->network_debug_flags & MXF_NETDBG_SUMMARY ) {
-		mxsrv_print_timestamp();
+	*end_of_message = offset;
 
-		if ( socket_handler->network_debug_flags & MXF_NETDBG_MSG_IDS )
-		{
-			fprintf( stderr, "[%#lx] ",
-					socket_handler->last_rpc_message_id );
-		}
+	return MX_SUCCESSFUL_RESULT;
+}
 
-		fprintf( stderr,
-			"MX (socket %d) PUT_ARRAY('%s.%s') = ",
-			(int) socket_handler->mx_socket->socket_fd,
-			record->name,
-			record_field->name );
+/* mxsrv_batch_send_response() is called once all of the fields of a batch
+ * have been processed.  The request is no longer needed, so the response
+ * is built in its place.
+ */
 
-		mx_network_buffer_show_value(
-				value_buffer,
-				socket_handler->data_format,
-				record_field->datatype,
-				receive_buffer_message_type,
-				num_value_bytes,
-				socket_handler->use_64bit_network_longs );
+mx_status_type
+mxsrv_batch_send_response( MXSRV_BATCH *batch )
+{
+	MX_SOCKET_HANDLER *socket_handler;
+	size_t end_of_message;
+	int operation;
+	mx_status_type mx_status;
 
-		fprintf( stderr, "\n" );
-	}
+	socket_handler = batch->socket_handler;
 
-#if 0
-		MX_DEBUG(-2,
-		("%s: Before send: receive_buffer_message_id = %#lx",
-			fname, receive_buffer_message_id));
-		MX_DEBUG(-2,
-		("%s: Before send: last_rpc_message_id = %#lx",
-			fname, socket_handler->last_rpc_message_id));
-		MX_DEBUG(-2,
-		("%s: Before send: send buffer message id = %#lx", fname,
-		mx_ntohl( send_buffer_header[ MX_NETWORK_MESSAGE_ID ] ) ));
-#endif
+	end_of_message = 0;
 
-	mx_status = mx_network_socket_send_message( mx_socket,
-						-1.0, network_message );
+	if ( batch->is_put ) {
+		mx_status = mxsrv_batch_build_put_response( batch,
+							&end_of_message );
+		operation = MX_PROCESS_PUT;
+	} else {
+		mx_status = mxsrv_batch_build_get_response( batch,
+							&end_of_message );
+		operation = MX_PROCESS_GET;
+	}
 
 	if ( mx_status.code != MXE_SUCCESS ) {
-		snprintf( location, sizeof(location),
-				"%s to client socket %d",
-				fname, mx_socket->socket_fd );
-
-		return mx_error( mx_status.code, location,
-					"%s", mx_status.message );
+		mx_status = mx_network_socket_send_error_message(
+					socket_handler->mx_socket,
+					batch->message_id,
+					socket_handler->remote_header_length,
+					socket_handler->network_debug_flags,
+					MX_NETMSG_UNEXPECTED_ERROR,
+					mx_status );
+	} else {
+		mx_status = mxsrv_send_batch_response( socket_handler,
+			batch->network_message,
+			mx_server_response( batch->message_type ),
+			batch->message_id, end_of_message, batch->num_fields,
+			batch->is_put ? "PUT_ARRAY_BATCH" : "GET_ARRAY_BATCH" );
 	}
 
-	MX_DEBUG( 1,("***** %s successful *****", fname));
+	mxsrv_finish_batch_fields( batch->num_fields, batch->record_array,
+				batch->field_array, batch->status_array,
+				operation );
 
-	/* If necessary, we now check to see if any callbacks need to be
-	 * invoked as a consequence of the record field processing above.
-	 */
+	return mx_status;
+}
 
-	if ( check_for_callbacks ) {
-		mx_bool_type value_changed;
+/*--------------------------------------------------------------------------*/
 
-		mx_status = mx_test_for_value_changed( record_field,
-							MX_PROCESS_PUT,
-							&value_changed );
+/* mxsrv_handle_array_batch() handles MX_NETMSG_GET_ARRAY_BATCH and
+ * MX_NETMSG_PUT_ARRAY_BATCH messages.  If a worker pool is in use,
+ * the fields are handed to the workers that serve their records.
+ * Otherwise, they are processed here in order.
+ */
 
-		if ( value_changed
-		  && (record_field->callback_list != NULL) )
-		{
-			mx_status = mx_local_field_invoke_callback_list(
-					record_field, MXCBT_VALUE_CHANGED );
-		}
+mx_status_type
+mxsrv_handle_array_batch( MX_RECORD *record_list,
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_NETWORK_MESSAGE_BUFFER *network_message )
+{
+	MXSRV_BATCH *batch;
+	uint32_t *header;
+	unsigned long i;
+	mx_status_type mx_status;
+
+	mx_status = mxsrv_batch_create( record_list, socket_handler,
+					network_message, &batch );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		header = network_message->u.uint32_buffer;
+
+		return mx_network_socket_send_error_message(
+				socket_handler->mx_socket,
+				mx_ntohl( header[ MX_NETWORK_MESSAGE_ID ] ),
+				socket_handler->remote_header_length,
+				socket_handler->network_debug_flags,
+				MX_NETMSG_UNEXPECTED_ERROR,
+				mx_status );
 	}
 
-#if NETWORK_DEBUG_TIMING
-	MX_HRT_END( measurement );
+	if ( mxsrv_worker_pool_is_enabled() ) {
+		return mxsrv_worker_pool_queue_batch( batch );
+	}
 
-	MX_HRT_RESULTS( measurement, fname,
-		"for '%s.%s'", record->name, record_field->name );
-#endif
+	for ( i = 0; i < batch->num_fields; i++ ) {
+		mxsrv_batch_process_field( batch, i );
+	}
 
-	MXW_UNUSED( receive_datatype );
+	mx_status = mxsrv_batch_send_response( batch );
 
-	return MX_SUCCESSFUL_RESULT;
+	mxsrv_batch_destroy( batch );
+
+	return mx_status;
 }
 
 /*--------------------------------------------------------------------------*/
@@ -4584,6 +5700,7 @@ mxsrv_handle_get_option( MX_RECORD *record_list,
 	uint32_t *option_array;
 	uint32_t option_number, option_value;
 	int illegal_option_number;
+	MX_NETWORK_SHM *shm;
 	mx_status_type mx_status;
 
 	option_array  = network_message->u.uint32_buffer;
@@ -4622,6 +5739,34 @@ mxsrv_handle_get_option( MX_RECORD *record_list,
 	case MX_NETWORK_OPTION_WORDSIZE:
 		option_value = MX_WORDSIZE;
 		break;
+	case MX_NETWORK_OPTION_COMPRESSION:
+		option_value = socket_handler->mx_socket->compression;
+		break;
+	case MX_NETWORK_OPTION_COMPRESSION_THRESHOLD:
+		option_value = socket_handler->mx_socket->compression_threshold;
+		break;
+	case MX_NETWORK_OPTION_SHARED_MEMORY:
+		shm = (MX_NETWORK_SHM *) socket_handler->mx_socket->shared_memory;
+
+		if ( shm == (MX_NETWORK_SHM *) NULL ) {
+			option_value = 0;
+		} else {
+			option_value = mx_network_shm_option_value(
+					shm->num_slots, shm->slot_size );
+		}
+		break;
+	case MX_NETWORK_OPTION_SHARED_MEMORY_THRESHOLD:
+		shm = (MX_NETWORK_SHM *) socket_handler->mx_socket->shared_memory;
+
+		if ( shm == (MX_NETWORK_SHM *) NULL ) {
+			option_value = 0;
+		} else {
+			option_value = shm->threshold;
+		}
+		break;
+	case MX_NETWORK_OPTION_BATCH_MESSAGES:
+		option_value = 1;
+		break;
 	default:
 		option_value = 0;
 		illegal_option_number = TRUE;
@@ -4729,10 +5874,19 @@ mxsrv_handle_get_option( MX_RECORD *record_list,
 			(unsigned long) option_value );
 	}
 
-	/* Send the option information back to the client. */
+	/* Send the option information back to the client.  A new shared
+	 * memory segment is passed along with it.
+	 */
+
+	shm = (MX_NETWORK_SHM *) socket_handler->mx_socket->shared_memory;
 
-	mx_status = mx_network_socket_send_message(
-		socket_handler->mx_socket, -1.0, network_message );
+	if ( ( shm != (MX_NETWORK_SHM *) NULL ) && ( shm->descriptor >= 0 ) ) {
+		mx_status = mx_network_shm_send_descriptor(
+				socket_handler->mx_socket, network_message );
+	} else {
+		mx_status = mx_network_socket_send_message(
+			socket_handler->mx_socket, -1.0, network_message );
+	}
 
 	if ( mx_status.code != MXE_SUCCESS ) {
 		snprintf( location, sizeof(location),
@@ -4766,6 +5920,7 @@ mxsrv_handle_set_option( MX_RECORD *record_list,
 	uint32_t *option_array;
 	uint32_t option_number, option_value;
 	int illegal_option_number, illegal_option_value;
+	MX_NETWORK_SHM *shm;
 	mx_status_type mx_status;
 
 	list_head = mx_get_record_list_head_struct( record_list );
@@ -4796,6 +5951,7 @@ mxsrv_handle_set_option( MX_RECORD *record_list,
 	case MX_NETWORK_OPTION_DATAFMT:
 		socket_handler->data_format = option_value;
 		socket_handler->message_buffer->data_format = option_value;
+		socket_handler->receive_buffer->data_format = option_value;
 		break;
 
 	case MX_NETWORK_OPTION_64BIT_LONG:
@@ -4852,6 +6008,64 @@ mxsrv_handle_set_option( MX_RECORD *record_list,
 #endif
 		break;
 
+	case MX_NETWORK_OPTION_COMPRESSION:
+		switch( option_value ) {
+		case MX_NETWORK_COMPRESSION_NONE:
+			socket_handler->mx_socket->compression = option_value;
+			break;
+#if defined( MX_HAVE_ZLIB )
+		case MX_NETWORK_COMPRESSION_ZLIB:
+		case ( MX_NETWORK_COMPRESSION_ZLIB
+				| MX_NETWORK_COMPRESSION_SHUFFLE ):
+			socket_handler->mx_socket->compression = option_value;
+			break;
+#endif
+		default:
+			illegal_option_value = TRUE;
+			break;
+		}
+		break;
+
+	case MX_NETWORK_OPTION_COMPRESSION_THRESHOLD:
+		socket_handler->mx_socket->compression_threshold = option_value;
+		break;
+
+	case MX_NETWORK_OPTION_SHARED_MEMORY:
+		(void) mx_network_shm_detach( socket_handler->mx_socket );
+
+		if ( option_value == 0 )
+			break;
+
+		/* The descriptor of the new segment goes out with our
+		 * response, which bypasses the outbound queue.  So refuse
+		 * if anything is still queued for this client.
+		 */
+
+		if ( mxsrv_outbound_queue_is_pending( socket_handler ) ) {
+			illegal_option_value = TRUE;
+			break;
+		}
+
+		mx_status = mx_network_shm_create( socket_handler->mx_socket,
+				mx_network_shm_option_num_slots( option_value ),
+				mx_network_shm_option_slot_size( option_value ),
+				MX_NETWORK_SHM_DEFAULT_THRESHOLD );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			illegal_option_value = TRUE;
+		}
+		break;
+
+	case MX_NETWORK_OPTION_SHARED_MEMORY_THRESHOLD:
+		shm = (MX_NETWORK_SHM *) socket_handler->mx_socket->shared_memory;
+
+		if ( shm == (MX_NETWORK_SHM *) NULL ) {
+			illegal_option_value = TRUE;
+		} else {
+			shm->threshold = option_value;
+		}
+		break;
+
 	default:
 		illegal_option_number = TRUE;
 		break;
@@ -4977,10 +6191,19 @@ mxsrv_handle_set_option( MX_RECORD *record_list,
 			(unsigned long) option_value );
 	}
 
-	/* Send the option information back to the client. */
+	/* Send the option information back to the client.  A new shared
+	 * memory segment is passed along with it.
+	 */
 
-	mx_status = mx_network_socket_send_message(
-		socket_handler->mx_socket, -1.0, network_message );
+	shm = (MX_NETWORK_SHM *) socket_handler->mx_socket->shared_memory;
+
+	if ( ( shm != (MX_NETWORK_SHM *) NULL ) && ( shm->descriptor >= 0 ) ) {
+		mx_status = mx_network_shm_send_descriptor(
+				socket_handler->mx_socket, network_message );
+	} else {
+		mx_status = mx_network_socket_send_message(
+			socket_handler->mx_socket, -1.0, network_message );
+	}
 
 	if ( mx_status.code != MXE_SUCCESS ) {
 		snprintf( location, sizeof(location),
@@ -5569,6 +6792,8 @@ mxsrv_handle_delete_callback( MX_RECORD *record,
 		 * callback handle table.
 		 */
 
+		mx_poll_callback_remove( list_head, callback );
+
 		callback_handle = (signed long)
 			( callback->callback_id & MX_NETWORK_MESSAGE_ID_MASK );
 
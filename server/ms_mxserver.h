@@ -122,6 +122,44 @@ extern mx_status_type mxsrv_handle_put_array(
 			MX_NETWORK_MESSAGE_BUFFER *message_buffer,
 			void *received_value_ptr );
 
+/* An MXSRV_BATCH holds a GET_ARRAY_BATCH or PUT_ARRAY_BATCH request
+ * while its fields are processed.  With a worker pool, each field is
+ * processed by the worker that serves its record and the response is
+ * sent by the worker that finishes last.
+ */
+
+typedef struct {
+	MX_SOCKET_HANDLER *socket_handler;
+	MX_NETWORK_MESSAGE_BUFFER *network_message;
+	mx_bool_type is_put;
+	uint32_t message_type;
+	uint32_t message_id;
+	unsigned long num_fields;
+	MX_RECORD **record_array;
+	MX_RECORD_FIELD **field_array;
+	mx_status_type *status_array;
+	size_t *value_offset_array;
+	long num_parts_pending;
+} MXSRV_BATCH;
+
+extern mx_status_type mxsrv_handle_array_batch(
+			MX_RECORD *record_list,
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_NETWORK_MESSAGE_BUFFER *message_buffer );
+
+extern mx_status_type mxsrv_batch_create(
+			MX_RECORD *record_list,
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+			MXSRV_BATCH **batch );
+
+extern void mxsrv_batch_destroy( MXSRV_BATCH *batch );
+
+extern void mxsrv_batch_process_field( MXSRV_BATCH *batch,
+			unsigned long field_index );
+
+extern mx_status_type mxsrv_batch_send_response( MXSRV_BATCH *batch );
+
 extern mx_status_type mxsrv_handle_get_network_handle(
 			MX_RECORD *record_list,
 			MX_SOCKET_HANDLER *socket_handler,
@@ -222,6 +260,16 @@ extern void mxsrv_process_sockets( MX_RECORD *record_list,
 
 extern void mxsrv_update_fds( MX_LIST_HEAD *mx_list_head,
 				MX_SOCKET_HANDLER_LIST *socket_handler_list );
+
+/* mxsrv_update_fd() only updates the descriptor of the socket handler
+ * passed to it, which must be called whenever that handler is added to
+ * or removed from the handler array or its worker_job_pending flag
+ * changes.
+ */
+
+extern void mxsrv_update_fd( MX_LIST_HEAD *mx_list_head,
+				MX_SOCKET_HANDLER_LIST *socket_handler_list,
+				MX_SOCKET_HANDLER *socket_handler );
 /*---*/
 
 extern void mxsrv_process_sockets_with_select( MX_RECORD *record_list,
@@ -230,6 +278,10 @@ extern void mxsrv_process_sockets_with_select( MX_RECORD *record_list,
 extern void mxsrv_update_select_fds( MX_LIST_HEAD *mx_list_head,
 				MX_SOCKET_HANDLER_LIST *socket_handler_list );
 
+extern void mxsrv_update_select_fd( MX_LIST_HEAD *mx_list_head,
+				MX_SOCKET_HANDLER_LIST *socket_handler_list,
+				MX_SOCKET_HANDLER *socket_handler );
+
 /*---*/
 
 #if ( defined(OS_LINUX) && defined(MX_GLIBC_VERSION) \
@@ -247,10 +299,79 @@ extern void mxsrv_process_sockets_with_epoll( MX_RECORD *record_list,
 extern void mxsrv_update_epoll_fds( MX_LIST_HEAD *mx_list_head,
 				MX_SOCKET_HANDLER_LIST *socket_handler_list );
 
+extern void mxsrv_update_epoll_fd( MX_LIST_HEAD *mx_list_head,
+				MX_SOCKET_HANDLER_LIST *socket_handler_list,
+				MX_SOCKET_HANDLER *socket_handler );
+
 #endif /* HAVE_LINUX_EPOLL */
 
 /*---*/
 
+extern mx_status_type mxsrv_worker_pool_create( MX_RECORD *record_list,
+				MX_SOCKET_HANDLER_LIST *socket_handler_list,
+				long num_workers );
+
+extern mx_bool_type mxsrv_worker_pool_is_enabled( void );
+
+extern void mxsrv_core_lock( void );
+
+extern void mxsrv_core_unlock( void );
+
+extern mx_status_type mxsrv_worker_pool_queue_event(
+				MX_SOCKET_HANDLER *socket_handler,
+				MX_RECORD *record,
+				MX_RECORD_FIELD *record_field );
+
+extern void mxsrv_worker_pool_quiesce( void );
+
+extern void mxsrv_worker_pool_resume( void );
+
+extern void mxsrv_worker_pool_quiesce_record( MX_RECORD *record );
+
+extern void mxsrv_worker_pool_resume_record( MX_RECORD *record );
+
+extern mx_status_type mxsrv_worker_pool_queue_batch( MXSRV_BATCH *batch );
+
+extern mx_status_type mxsrv_worker_pool_dispatch_poll( void *callback,
+				mx_bool_type get_new_value );
+
+extern mx_status_type mxsrv_worker_pool_handle_callback_message(
+				void *callback_message );
+
+extern mx_status_type mxsrv_process_record_field_for_client(
+				MX_RECORD *record,
+				MX_RECORD_FIELD *record_field,
+				MX_SOCKET_HANDLER *socket_handler,
+				int operation );
+
+/*---*/
+
+extern mx_status_type mxsrv_outbound_send_hook( MX_SOCKET *mx_socket,
+				char **segment_ptr,
+				size_t *segment_length );
+
+/* How often, in milliseconds, the main loop wakes up to see whether
+ * a worker thread has finished with a client that is waiting to be
+ * disconnected.
+ */
+
+#define MXSRV_OUTBOUND_WAIT_MS	10
+
+extern mx_bool_type mxsrv_outbound_queue_is_pending(
+				MX_SOCKET_HANDLER *socket_handler );
+
+extern void mxsrv_outbound_socket_writeable(
+				MX_SOCKET_HANDLER *socket_handler );
+
+extern mx_bool_type mxsrv_outbound_disconnects_are_pending( void );
+
+extern void mxsrv_process_outbound_queues(
+				MX_SOCKET_HANDLER_LIST *socket_handler_list );
+
+extern void mxsrv_free_outbound_queue( MX_SOCKET_HANDLER *socket_handler );
+
+/*---*/
+
 #if HAVE_UNIX_DOMAIN_SOCKETS
 
 extern mx_status_type mxsrv_get_unix_domain_socket_credentials(
@@ -0,0 +1,955 @@
+/*
+ * Name: ms_outbound.c
+ *
+ * Purpose: Per-client outbound message queues for the MX server.
+ *
+ *          Every client socket has its 'send_hook' pointed at
+ *          mxsrv_outbound_send_hook(), so all messages that the server
+ *          sends to a client pass through here.  A message is written
+ *          to the socket immediately if nothing is queued in front of
+ *          it and the socket will take it without blocking.  Whatever
+ *          cannot be sent right away is copied to the client's queue.
+ *          While a queue has messages in it, the socket multiplexer also
+ *          waits for the client's socket to become writeable and then
+ *          sends as much of the queue as it can.  Thus a client that
+ *          stops reading can no longer stall the server.
+ *
+ *          Value changed callback messages that are still waiting in
+ *          the queue are coalesced, so that a field that changes many
+ *          times before the client catches up is only sent once with
+ *          its latest value.  A coalesced message keeps the place in
+ *          the queue of the message that it replaces, so it may reach
+ *          the client ahead of messages that were queued after that one.
+ *          Only the order of the values sent for each field is kept.
+ *
+ *          If a client falls further behind than the limits in the
+ *          MX_LIST_HEAD allow, it is either disconnected or its new
+ *          callback messages are held back, depending on the value of
+ *          'client_queue_overflow_policy'.  Only the newest held back
+ *          message for each callback is kept, and these are sent once
+ *          the queue has drained.  Thus the client still ends up with
+ *          the last value of every field.  Responses to client requests
+ *          are never held back.
+ *
+ *--------------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#define MS_OUTBOUND_DEBUG	FALSE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mx_osdef.h"
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_stdint.h"
+#include "mx_socket.h"
+#include "mx_net.h"
+#include "mx_process.h"
+
+#include "ms_mxserver.h"
+
+typedef struct mxsrv_outbound_message_type {
+	struct mxsrv_outbound_message_type *next_message;
+
+	/* 'callback_id' is 0 for messages that may not be coalesced. */
+
+	uint32_t callback_id;
+
+	size_t length;
+	size_t bytes_sent;
+	char *data;
+} MXSRV_OUTBOUND_MESSAGE;
+
+typedef struct {
+	MXSRV_OUTBOUND_MESSAGE *first_message;
+	MXSRV_OUTBOUND_MESSAGE *last_message;
+
+	unsigned long num_messages;
+	size_t num_bytes;
+
+	/* Callback messages that arrived while the queue was over its
+	 * limits.  There is at most one message here for each callback.
+	 * They are not counted in 'num_messages' and 'num_bytes'.
+	 */
+
+	MXSRV_OUTBOUND_MESSAGE *first_deferred;
+	MXSRV_OUTBOUND_MESSAGE *last_deferred;
+
+	unsigned long num_coalesced;
+	unsigned long num_deferred;
+
+	mx_bool_type disconnect_requested;
+} MXSRV_OUTBOUND_QUEUE;
+
+/* The number of clients that are waiting to be disconnected. */
+
+static long mxsrv_num_disconnect_requests = 0;
+
+/* On platforms that support it, MSG_DONTWAIT lets us write to the socket
+ * without blocking.  Elsewhere, we check with select() that the socket
+ * is writeable before each send().
+ */
+
+#if defined(MSG_DONTWAIT)
+#  if defined(MSG_NOSIGNAL)
+#    define MXSRV_SEND_FLAGS	( MSG_DONTWAIT | MSG_NOSIGNAL )
+#  else
+#    define MXSRV_SEND_FLAGS	MSG_DONTWAIT
+#  endif
+#  define MXSRV_USE_SENDMSG	HAVE_READV_WRITEV
+#else
+#  define MXSRV_SEND_FLAGS	0
+#  define MXSRV_USE_SENDMSG	FALSE
+#endif
+
+#if MXSRV_USE_SENDMSG
+#include <sys/uio.h>
+#endif
+
+/*-------------------------------------------------------------------------*/
+
+#if ( MXSRV_USE_SENDMSG == FALSE )
+
+static mx_bool_type
+mxsrv_outbound_socket_is_writeable( MX_SOCKET *mx_socket )
+{
+	fd_set write_fds;
+	struct timeval timeout;
+	int num_fds;
+
+	FD_ZERO( &write_fds );
+	FD_SET( mx_socket->socket_fd, &write_fds );
+
+	timeout.tv_sec = 0;
+	timeout.tv_usec = 0;
+
+	num_fds = select( (int) mx_socket->socket_fd + 1,
+				NULL, &write_fds, NULL, &timeout );
+
+	if ( num_fds > 0 ) {
+		return TRUE;
+	} else {
+		return FALSE;
+	}
+}
+
+#endif
+
+/* mxsrv_outbound_send_segments() writes as much of the message segments
+ * as the socket will take without blocking and reports how much that was.
+ * The header and the body go out in a single sendmsg() call where that is
+ * available, since sending them separately interacts badly with Nagle's
+ * algorithm on the client's delayed acknowledgements.
+ */
+
+static mx_status_type
+mxsrv_outbound_send_segments( MX_SOCKET *mx_socket,
+			char **segment_ptr, size_t *segment_length,
+			size_t *bytes_sent )
+{
+	static const char fname[] = "mxsrv_outbound_send_segments()";
+
+	char *ptr[2];
+	size_t left[2], bytes_consumed;
+	long send_status;
+	int segment, saved_errno;
+
+#if MXSRV_USE_SENDMSG
+	struct msghdr message_header;
+	struct iovec iovec_array[2];
+#endif
+
+	ptr[0] = segment_ptr[0];
+	ptr[1] = segment_ptr[1];
+
+	left[0] = segment_length[0];
+	left[1] = segment_length[1];
+
+	*bytes_sent = 0;
+
+	segment = 0;
+
+	while ( segment < 2 ) {
+
+		if ( left[segment] == 0 ) {
+			segment++;
+			continue;
+		}
+
+#if MXSRV_USE_SENDMSG
+		memset( &message_header, 0, sizeof(message_header) );
+
+		message_header.msg_iov = iovec_array;
+		message_header.msg_iovlen = 0;
+
+		for ( ; message_header.msg_iovlen < (2 - segment);
+					message_header.msg_iovlen++ )
+		{
+			iovec_array[message_header.msg_iovlen].iov_base =
+				ptr[segment + message_header.msg_iovlen];
+			iovec_array[message_header.msg_iovlen].iov_len =
+				left[segment + message_header.msg_iovlen];
+		}
+
+		send_status = sendmsg( mx_socket->socket_fd,
+					&message_header, MXSRV_SEND_FLAGS );
+#else
+		if ( mxsrv_outbound_socket_is_writeable( mx_socket ) == FALSE )
+			return MX_SUCCESSFUL_RESULT;
+
+		send_status = send( mx_socket->socket_fd, ptr[segment],
+					(int) left[segment], MXSRV_SEND_FLAGS );
+#endif
+
+		if ( send_status > 0 ) {
+			bytes_consumed = (size_t) send_status;
+
+			*bytes_sent += bytes_consumed;
+
+			while ( ( bytes_consumed > 0 ) && ( segment < 2 ) ) {
+				if ( bytes_consumed < left[segment] ) {
+					ptr[segment] += bytes_consumed;
+					left[segment] -= bytes_consumed;
+					bytes_consumed = 0;
+				} else {
+					bytes_consumed -= left[segment];
+					left[segment] = 0;
+					segment++;
+				}
+			}
+			continue;
+		} else
+		if ( send_status == 0 ) {
+			return MX_SUCCESSFUL_RESULT;
+		}
+
+		saved_errno = mx_socket_get_last_error();
+
+		switch( saved_errno ) {
+		case EINTR:
+			continue;
+
+		case EWOULDBLOCK:
+#if defined(EAGAIN) && ( EAGAIN != EWOULDBLOCK )
+		case EAGAIN:
+#endif
+			return MX_SUCCESSFUL_RESULT;
+
+		case ECONNRESET:
+		case ECONNABORTED:
+		case EPIPE:
+			return mx_error(
+				(MXE_NETWORK_CONNECTION_LOST | MXE_QUIET), fname,
+			"Connection lost.  Errno = %d, error text = '%s'",
+				saved_errno, mx_socket_strerror(saved_errno) );
+
+		default:
+			return mx_error( (MXE_NETWORK_IO_ERROR | MXE_QUIET), fname,
+			"Error sending to client socket %d.  "
+			"Errno = %d, error text = '%s'",
+				(int) mx_socket->socket_fd,
+				saved_errno, mx_socket_strerror(saved_errno) );
+		}
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* Only value changed callback messages may be coalesced.  Messages that
+ * refer to a shared memory slot are excluded, since throwing one of them
+ * away would leave its slot marked as busy.
+ */
+
+static uint32_t
+mxsrv_outbound_get_callback_id( char *message, size_t length )
+{
+	uint32_t header[ MX_NETWORK_MESSAGE_ID + 1 ];
+	uint32_t header_length, message_type, message_id;
+
+	if ( length < sizeof(header) )
+		return 0;
+
+	memcpy( header, message, sizeof(header) );
+
+	header_length = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+
+	if ( header_length < sizeof(header) )
+		return 0;
+
+	message_type = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
+
+	if ( message_type & MX_NETMSG_SHARED_MEMORY_FLAG )
+		return 0;
+
+	message_type &= ~MX_NETMSG_COMPRESSED_FLAG;
+
+	if ( message_type != mx_server_response(MX_NETMSG_CALLBACK) )
+		return 0;
+
+	message_id = mx_ntohl( header[ MX_NETWORK_MESSAGE_ID ] );
+
+	if ( ( message_id & MX_NETWORK_MESSAGE_IS_CALLBACK ) == 0 )
+		return 0;
+
+	return message_id;
+}
+
+/* Copy the two segments of a message, less the first 'skip' bytes,
+ * into 'destination'.
+ */
+
+static void
+mxsrv_outbound_copy_segments( char *destination,
+				char **segment_ptr, size_t *segment_length,
+				size_t skip )
+{
+	int i;
+
+	for ( i = 0; i < 2; i++ ) {
+		if ( skip >= segment_length[i] ) {
+			skip -= segment_length[i];
+			continue;
+		}
+
+		memcpy( destination, segment_ptr[i] + skip,
+				segment_length[i] - skip );
+
+		destination += segment_length[i] - skip;
+
+		skip = 0;
+	}
+}
+
+/* Tell the socket multiplexer whether or not to wait for the client's
+ * socket to become writeable.
+ */
+
+static void
+mxsrv_outbound_update_watch( MX_SOCKET_HANDLER *socket_handler )
+{
+	MX_LIST_HEAD *list_head;
+	MX_SOCKET_HANDLER_LIST *socket_handler_list;
+
+	list_head = socket_handler->list_head;
+
+	if ( list_head == (MX_LIST_HEAD *) NULL )
+		return;
+
+	socket_handler_list =
+		(MX_SOCKET_HANDLER_LIST *) list_head->application_ptr;
+
+	if ( socket_handler_list == (MX_SOCKET_HANDLER_LIST *) NULL )
+		return;
+
+	mxsrv_update_fd( list_head, socket_handler_list, socket_handler );
+}
+
+static void
+mxsrv_outbound_update_pending( MX_SOCKET_HANDLER *socket_handler,
+				MXSRV_OUTBOUND_QUEUE *queue,
+				mx_bool_type was_pending )
+{
+	mx_bool_type is_pending;
+
+	is_pending = ( queue->first_message != NULL );
+
+	if ( is_pending != was_pending ) {
+		mxsrv_outbound_update_watch( socket_handler );
+	}
+}
+
+static void
+mxsrv_outbound_request_disconnect( MX_SOCKET_HANDLER *socket_handler,
+				MXSRV_OUTBOUND_QUEUE *queue )
+{
+	if ( queue->disconnect_requested )
+		return;
+
+	queue->disconnect_requested = TRUE;
+
+	mxsrv_num_disconnect_requests++;
+
+	/* There is no point in waiting for the socket to become
+	 * writeable any more.
+	 */
+
+	if ( queue->first_message != NULL ) {
+		mxsrv_outbound_update_watch( socket_handler );
+	}
+}
+
+/* mxsrv_outbound_new_message() makes a queue entry that holds a copy of
+ * the message segments, less the first 'skip' bytes.
+ */
+
+static MXSRV_OUTBOUND_MESSAGE *
+mxsrv_outbound_new_message( char **segment_ptr, size_t *segment_length,
+				size_t skip, uint32_t callback_id )
+{
+	MXSRV_OUTBOUND_MESSAGE *message;
+
+	message = (MXSRV_OUTBOUND_MESSAGE *)
+			malloc( sizeof(MXSRV_OUTBOUND_MESSAGE) );
+
+	if ( message == (MXSRV_OUTBOUND_MESSAGE *) NULL )
+		return NULL;
+
+	message->length = segment_length[0] + segment_length[1] - skip;
+
+	message->data = (char *) malloc( message->length );
+
+	if ( message->data == (char *) NULL ) {
+		mx_free( message );
+		return NULL;
+	}
+
+	mxsrv_outbound_copy_segments( message->data,
+				segment_ptr, segment_length, skip );
+
+	message->callback_id = callback_id;
+	message->bytes_sent = 0;
+	message->next_message = NULL;
+
+	return message;
+}
+
+/* mxsrv_outbound_replace() puts a new value into a queued callback message
+ * that has not started to go out yet.  The previous length of the message
+ * is returned in 'old_length'.  Returns FALSE if we ran out of memory.
+ */
+
+static mx_bool_type
+mxsrv_outbound_replace( MXSRV_OUTBOUND_MESSAGE *message,
+			char **segment_ptr, size_t *segment_length,
+			size_t *old_length )
+{
+	size_t new_length;
+	char *new_data;
+
+	new_length = segment_length[0] + segment_length[1];
+
+	*old_length = message->length;
+
+	if ( new_length != message->length ) {
+		new_data = realloc( message->data, new_length );
+
+		if ( new_data == NULL )
+			return FALSE;
+
+		message->data = new_data;
+		message->length = new_length;
+	}
+
+	mxsrv_outbound_copy_segments( message->data,
+				segment_ptr, segment_length, 0 );
+
+	return TRUE;
+}
+
+/* mxsrv_outbound_release_deferred() moves the callback messages that were
+ * held back to the end of the queue.
+ */
+
+static void
+mxsrv_outbound_release_deferred( MXSRV_OUTBOUND_QUEUE *queue )
+{
+	MXSRV_OUTBOUND_MESSAGE *message;
+
+	while ( queue->first_deferred != NULL ) {
+		message = queue->first_deferred;
+
+		queue->first_deferred = message->next_message;
+
+		message->next_message = NULL;
+
+		if ( queue->last_message == NULL ) {
+			queue->first_message = message;
+		} else {
+			queue->last_message->next_message = message;
+		}
+
+		queue->last_message = message;
+
+		queue->num_messages++;
+		queue->num_bytes += message->length;
+	}
+
+	queue->last_deferred = NULL;
+}
+
+/* mxsrv_outbound_flush() sends queued messages until the queue is empty
+ * or the socket would block.
+ */
+
+static mx_status_type
+mxsrv_outbound_flush( MX_SOCKET_HANDLER *socket_handler,
+			MXSRV_OUTBOUND_QUEUE *queue )
+{
+	MXSRV_OUTBOUND_MESSAGE *message;
+	char *segment_ptr[2];
+	size_t segment_length[2], bytes_sent;
+	mx_bool_type was_pending;
+	mx_status_type mx_status;
+
+	was_pending = ( queue->first_message != NULL );
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	for (;;) {
+	    while ( queue->first_message != NULL ) {
+		message = queue->first_message;
+
+		segment_ptr[0] = message->data + message->bytes_sent;
+		segment_length[0] = message->length - message->bytes_sent;
+
+		segment_ptr[1] = NULL;
+		segment_length[1] = 0;
+
+		mx_status = mxsrv_outbound_send_segments(
+					socket_handler->mx_socket,
+					segment_ptr, segment_length,
+					&bytes_sent );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
+
+		message->bytes_sent += bytes_sent;
+
+		if ( message->bytes_sent < message->length )
+			break;
+
+		queue->first_message = message->next_message;
+
+		if ( queue->first_message == NULL ) {
+			queue->last_message = NULL;
+		}
+
+		queue->num_messages--;
+		queue->num_bytes -= message->length;
+
+		mx_free( message->data );
+		mx_free( message );
+	    }
+
+	    if ( ( mx_status.code != MXE_SUCCESS )
+	      || ( queue->first_message != NULL )
+	      || ( queue->first_deferred == NULL ) )
+	    {
+		break;
+	    }
+
+	    /* The queue has drained, so the callback messages that were
+	     * held back can go out now.
+	     */
+
+	    mxsrv_outbound_release_deferred( queue );
+	}
+
+	mxsrv_outbound_update_pending( socket_handler, queue, was_pending );
+
+	return mx_status;
+}
+
+/* mxsrv_outbound_coalesce() replaces the value in a queued callback message
+ * for the same field that has not started to go out yet.  A message that
+ * is being held back is looked at first, since it is sent after everything
+ * in the queue.  Returns TRUE if one was found.
+ */
+
+static mx_bool_type
+mxsrv_outbound_coalesce( MXSRV_OUTBOUND_QUEUE *queue, uint32_t callback_id,
+			char **segment_ptr, size_t *segment_length )
+{
+	MXSRV_OUTBOUND_MESSAGE *message;
+	size_t old_length;
+
+	for ( message = queue->first_deferred; message != NULL;
+				message = message->next_message )
+	{
+		if ( message->callback_id != callback_id )
+			continue;
+
+		if ( mxsrv_outbound_replace( message, segment_ptr,
+					segment_length, &old_length ) == FALSE )
+		{
+			return FALSE;
+		}
+
+		queue->num_coalesced++;
+
+		return TRUE;
+	}
+
+	for ( message = queue->first_message; message != NULL;
+				message = message->next_message )
+	{
+		if ( ( message->callback_id != callback_id )
+		  || ( message->bytes_sent != 0 ) )
+		{
+			continue;
+		}
+
+		if ( mxsrv_outbound_replace( message, segment_ptr,
+					segment_length, &old_length ) == FALSE )
+		{
+			return FALSE;
+		}
+
+		queue->num_bytes -= old_length;
+		queue->num_bytes += message->length;
+
+		queue->num_coalesced++;
+
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/*-------------------------------------------------------------------------*/
+
+mx_status_type
+mxsrv_outbound_send_hook( MX_SOCKET *mx_socket,
+			char **segment_ptr,
+			size_t *segment_length )
+{
+	static const char fname[] = "mxsrv_outbound_send_hook()";
+
+	MX_SOCKET_HANDLER *socket_handler;
+	MX_LIST_HEAD *list_head;
+	MXSRV_OUTBOUND_QUEUE *queue;
+	MXSRV_OUTBOUND_MESSAGE *message;
+	uint32_t callback_id;
+	size_t total_length, skip;
+	mx_bool_type was_pending, over_limit;
+	mx_status_type mx_status;
+
+	socket_handler = (MX_SOCKET_HANDLER *) mx_socket->socket_handler;
+
+	if ( socket_handler == (MX_SOCKET_HANDLER *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"Client socket %d does not have a socket handler.",
+			(int) mx_socket->socket_fd );
+	}
+
+	queue = (MXSRV_OUTBOUND_QUEUE *) socket_handler->outbound_queue;
+
+	if ( queue == (MXSRV_OUTBOUND_QUEUE *) NULL ) {
+		queue = (MXSRV_OUTBOUND_QUEUE *)
+				calloc( 1, sizeof(MXSRV_OUTBOUND_QUEUE) );
+
+		if ( queue == (MXSRV_OUTBOUND_QUEUE *) NULL ) {
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate an outbound "
+			"queue for client socket %d.",
+				(int) mx_socket->socket_fd );
+		}
+
+		socket_handler->outbound_queue = queue;
+	}
+
+	if ( queue->disconnect_requested ) {
+		return mx_error( (MXE_NETWORK_CONNECTION_LOST | MXE_QUIET), fname,
+		"Client socket %d is being disconnected.",
+			(int) mx_socket->socket_fd );
+	}
+
+	total_length = segment_length[0] + segment_length[1];
+
+	callback_id = mxsrv_outbound_get_callback_id( segment_ptr[0],
+							segment_length[0] );
+	skip = 0;
+
+	if ( queue->first_message == NULL ) {
+
+		/* Nothing is waiting, so try to send the message now. */
+
+		mx_status = mxsrv_outbound_send_segments( mx_socket,
+					segment_ptr, segment_length, &skip );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		if ( skip >= total_length )
+			return MX_SUCCESSFUL_RESULT;
+
+		if ( skip > 0 ) {
+			callback_id = 0;
+		}
+	} else {
+		if ( callback_id != 0 ) {
+			if ( mxsrv_outbound_coalesce( queue, callback_id,
+					segment_ptr, segment_length ) )
+			{
+				return mxsrv_outbound_flush( socket_handler,
+								queue );
+			}
+		}
+
+		list_head = socket_handler->list_head;
+
+		over_limit = FALSE;
+
+		if ( ( list_head->max_client_queue_messages > 0 )
+		  && ( queue->num_messages
+				>= list_head->max_client_queue_messages ) )
+		{
+			over_limit = TRUE;
+		}
+
+		if ( ( list_head->max_client_queue_bytes > 0 )
+		  && ( ( queue->num_bytes + total_length )
+				> list_head->max_client_queue_bytes ) )
+		{
+			over_limit = TRUE;
+		}
+
+		if ( over_limit ) {
+			if ( list_head->client_queue_overflow_policy
+					== MXF_SRV_QUEUE_OVERFLOW_DISCONNECT )
+			{
+				mxsrv_outbound_request_disconnect(
+						socket_handler, queue );
+
+				mx_warning( "Client socket %d has %lu messages "
+				"(%lu bytes) waiting to be sent, so it "
+				"will be disconnected.",
+					(int) mx_socket->socket_fd,
+					queue->num_messages,
+					(unsigned long) queue->num_bytes );
+
+				return mx_error(
+				(MXE_NETWORK_CONNECTION_LOST | MXE_QUIET),
+				fname, "Client socket %d is too far behind.",
+					(int) mx_socket->socket_fd );
+			}
+
+			if ( callback_id != 0 ) {
+				if ( queue->num_deferred == 0 ) {
+					mx_warning( "Client socket %d has %lu "
+					"messages (%lu bytes) waiting to be "
+					"sent.  New callback messages for it "
+					"will be held back until it catches up.",
+						(int) mx_socket->socket_fd,
+						queue->num_messages,
+					    (unsigned long) queue->num_bytes );
+				}
+
+				message = mxsrv_outbound_new_message(
+						segment_ptr, segment_length,
+						0, callback_id );
+
+				if ( message == (MXSRV_OUTBOUND_MESSAGE *) NULL )
+				{
+					return mx_error( MXE_OUT_OF_MEMORY,
+					fname, "Ran out of memory trying to "
+					"hold back a callback message for "
+					"client socket %d.",
+						(int) mx_socket->socket_fd );
+				}
+
+				if ( queue->last_deferred == NULL ) {
+					queue->first_deferred = message;
+				} else {
+					queue->last_deferred->next_message
+								= message;
+				}
+
+				queue->last_deferred = message;
+
+				queue->num_deferred++;
+
+				return mxsrv_outbound_flush( socket_handler,
+								queue );
+			}
+		}
+	}
+
+	/* Queue whatever could not be sent. */
+
+	message = mxsrv_outbound_new_message( segment_ptr, segment_length,
+						skip, callback_id );
+
+	if ( message == (MXSRV_OUTBOUND_MESSAGE *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to queue a %lu byte message "
+		"for client socket %d.", (unsigned long) (total_length - skip),
+			(int) mx_socket->socket_fd );
+	}
+
+	was_pending = ( queue->first_message != NULL );
+
+	if ( queue->last_message == NULL ) {
+		queue->first_message = message;
+	} else {
+		queue->last_message->next_message = message;
+	}
+
+	queue->last_message = message;
+
+	queue->num_messages++;
+	queue->num_bytes += message->length;
+
+	mxsrv_outbound_update_pending( socket_handler, queue, was_pending );
+
+#if MS_OUTBOUND_DEBUG
+	MX_DEBUG(-2,("%s: socket %d, queued %lu bytes, queue = %lu messages, "
+		"%lu bytes", fname, (int) mx_socket->socket_fd,
+		(unsigned long) message->length, queue->num_messages,
+		(unsigned long) queue->num_bytes ));
+#endif
+
+	if ( skip > 0 ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	return mxsrv_outbound_flush( socket_handler, queue );
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* mxsrv_outbound_queue_is_pending() tells the socket multiplexers
+ * whether they should wait for this client's socket to be writeable.
+ */
+
+mx_bool_type
+mxsrv_outbound_queue_is_pending( MX_SOCKET_HANDLER *socket_handler )
+{
+	MXSRV_OUTBOUND_QUEUE *queue;
+
+	queue = (MXSRV_OUTBOUND_QUEUE *) socket_handler->outbound_queue;
+
+	if ( ( queue == (MXSRV_OUTBOUND_QUEUE *) NULL )
+	  || ( queue->first_message == NULL )
+	  || ( queue->disconnect_requested ) )
+	{
+		return FALSE;
+	} else {
+		return TRUE;
+	}
+}
+
+/* mxsrv_outbound_socket_writeable() is called by the socket multiplexers
+ * when the socket of a client with queued messages becomes writeable.
+ */
+
+void
+mxsrv_outbound_socket_writeable( MX_SOCKET_HANDLER *socket_handler )
+{
+	MXSRV_OUTBOUND_QUEUE *queue;
+	mx_status_type mx_status;
+
+	if ( mxsrv_outbound_queue_is_pending( socket_handler ) == FALSE )
+		return;
+
+	queue = (MXSRV_OUTBOUND_QUEUE *) socket_handler->outbound_queue;
+
+	mx_status = mxsrv_outbound_flush( socket_handler, queue );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mxsrv_outbound_request_disconnect( socket_handler, queue );
+	}
+}
+
+mx_bool_type
+mxsrv_outbound_disconnects_are_pending( void )
+{
+	if ( mxsrv_num_disconnect_requests > 0 ) {
+		return TRUE;
+	} else {
+		return FALSE;
+	}
+}
+
+/* mxsrv_process_outbound_queues() is called from the main event loop to
+ * close the connections of clients that have fallen too far behind or
+ * whose sockets have failed.
+ */
+
+void
+mxsrv_process_outbound_queues( MX_SOCKET_HANDLER_LIST *socket_handler_list )
+{
+	MX_SOCKET_HANDLER *socket_handler;
+	MXSRV_OUTBOUND_QUEUE *queue;
+	int i;
+
+	if ( mxsrv_num_disconnect_requests == 0 )
+		return;
+
+	for ( i = 0; i < socket_handler_list->handler_array_size; i++ ) {
+		socket_handler = socket_handler_list->array[i];
+
+		if ( socket_handler == (MX_SOCKET_HANDLER *) NULL )
+			continue;
+
+		queue = (MXSRV_OUTBOUND_QUEUE *) socket_handler->outbound_queue;
+
+		if ( ( queue == (MXSRV_OUTBOUND_QUEUE *) NULL )
+		  || ( queue->disconnect_requested == FALSE ) )
+		{
+			continue;
+		}
+
+		/* A worker thread may still be using the socket handler,
+		 * in which case we try again on the next pass.
+		 */
+
+		if ( socket_handler->worker_job_pending )
+			continue;
+
+		(void) mxsrv_free_client_socket_handler( socket_handler,
+							socket_handler_list );
+	}
+}
+
+void
+mxsrv_free_outbound_queue( MX_SOCKET_HANDLER *socket_handler )
+{
+	MXSRV_OUTBOUND_QUEUE *queue;
+	MXSRV_OUTBOUND_MESSAGE *message, *next_message;
+
+	queue = (MXSRV_OUTBOUND_QUEUE *) socket_handler->outbound_queue;
+
+	if ( queue == (MXSRV_OUTBOUND_QUEUE *) NULL )
+		return;
+
+	if ( queue->disconnect_requested ) {
+		mxsrv_num_disconnect_requests--;
+	}
+
+	mxsrv_outbound_release_deferred( queue );
+
+	message = queue->first_message;
+
+	while ( message != NULL ) {
+		next_message = message->next_message;
+
+		mx_free( message->data );
+		mx_free( message );
+
+		message = next_message;
+	}
+
+	if ( queue->num_deferred > 0 ) {
+		mx_info( "%lu callback messages for client socket %d were "
+		"held back and %lu were coalesced.", queue->num_deferred,
+			(int) socket_handler->mx_socket->socket_fd,
+			queue->num_coalesced );
+	}
+
+	mx_free( queue );
+
+	socket_handler->outbound_queue = NULL;
+}
+
@@ -3,6 +3,13 @@
  *
  * Purpose: Process incoming MX socket events with epoll().
  *
+ *          Unlike the select() version, the epoll() multiplexer keeps
+ *          a persistent kernel-side interest set and an array of socket
+ *          handler pointers indexed by file descriptor.  The wakeup
+ *          descriptor of the callback queue is added to the same interest
+ *          set, so the server main loop can block in epoll_wait() until
+ *          either a socket or a callback actually needs attention.
+ *
  * Author:  William Lavender
  *
  *--------------------------------------------------------------------------
@@ -14,15 +21,19 @@
  *
  */
 
-/* FIXME: This version of the code does not yet work (2019-03-29). */
+#define MS_SOCKET_EPOLL_DEBUG		FALSE
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
 
 #include "mx_util.h"
 #include "mx_record.h"
 #include "mx_stdint.h"
 #include "mx_socket.h"
+#include "mx_pipe.h"
+#include "mx_callback.h"
+#include "mx_virtual_timer.h"
 #include "mx_process.h"
 
 #include "ms_mxserver.h"
@@ -33,17 +44,134 @@
 
 /*-------------------------------------------------------------------------*/
 
+static void
+mxsrv_epoll_control_fd( MX_SOCKET_HANDLER_LIST *socket_handler_list,
+			int operation, int fd, uint32_t events )
+{
+	static const char fname[] = "mxsrv_epoll_control_fd()";
+
+	struct epoll_event event;
+	int ctl_status, saved_errno;
+
+	memset( &event, 0, sizeof(event) );
+
+	event.events = events;
+	event.data.fd = fd;
+
+	ctl_status = epoll_ctl( socket_handler_list->epoll_fd,
+				operation, fd, &event );
+
+	if ( ctl_status != 0 ) {
+		saved_errno = errno;
+
+		(void) mx_error( MXE_OPERATING_SYSTEM_ERROR, fname,
+		"The attempt to %s file descriptor %d "
+		"in epoll descriptor %d failed.  "
+		"Errno = %d, error message = '%s'.",
+			( operation == EPOLL_CTL_ADD ) ? "add" : "modify",
+			fd, socket_handler_list->epoll_fd,
+			saved_errno, strerror(saved_errno) );
+	}
+
+	return;
+}
+
+static void
+mxsrv_epoll_add_fd( MX_SOCKET_HANDLER_LIST *socket_handler_list, int fd )
+{
+	mxsrv_epoll_control_fd( socket_handler_list, EPOLL_CTL_ADD,
+							fd, EPOLLIN );
+}
+
+static void
+mxsrv_epoll_delete_fd( MX_SOCKET_HANDLER_LIST *socket_handler_list, int fd )
+{
+	static const char fname[] = "mxsrv_epoll_delete_fd()";
+
+	struct epoll_event event;
+	int ctl_status, saved_errno;
+
+	/* Linux kernels before 2.6.9 require a non-NULL event pointer
+	 * even for EPOLL_CTL_DEL.
+	 */
+
+	memset( &event, 0, sizeof(event) );
+
+	ctl_status = epoll_ctl( socket_handler_list->epoll_fd,
+				EPOLL_CTL_DEL, fd, &event );
+
+	if ( ctl_status != 0 ) {
+		saved_errno = errno;
+
+		/* If the descriptor has already been closed, then the
+		 * kernel will have already removed it from the epoll
+		 * set for us, so EBADF and ENOENT are not errors here.
+		 */
+
+		if ( ( saved_errno == EBADF ) || ( saved_errno == ENOENT ) ) {
+			return;
+		}
+
+		(void) mx_error( MXE_OPERATING_SYSTEM_ERROR, fname,
+		"The attempt to delete file descriptor %d "
+		"from epoll descriptor %d failed.  "
+		"Errno = %d, error message = '%s'.",
+			fd, socket_handler_list->epoll_fd,
+			saved_errno, strerror(saved_errno) );
+	}
+
+	return;
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* A client socket is watched for input unless a worker thread is handling
+ * a request from it, and for output while it has queued messages.
+ */
+
+static uint32_t
+mxsrv_epoll_get_events( MX_SOCKET_HANDLER_LIST *socket_handler_list,
+			MX_SOCKET_HANDLER *socket_handler )
+{
+	long n;
+	uint32_t events;
+
+	n = socket_handler->handler_array_index;
+
+	if ( ( n < 0 ) || ( n >= socket_handler_list->handler_array_size )
+	  || ( socket_handler_list->array[n] != socket_handler ) )
+	{
+		return 0;
+	}
+
+	events = 0;
+
+	if ( socket_handler->worker_job_pending == FALSE ) {
+		events |= EPOLLIN;
+	}
+
+	if ( mxsrv_outbound_queue_is_pending( socket_handler ) ) {
+		events |= EPOLLOUT;
+	}
+
+	return events;
+}
+
+/*-------------------------------------------------------------------------*/
+
 void
 mxsrv_update_epoll_fds( MX_LIST_HEAD *list_head,
 			MX_SOCKET_HANDLER_LIST *socket_handler_list )
 {
 	static const char fname[] = "mxsrv_update_epoll_fds()";
 
-	int i, handler_array_size;
-	int saved_errno, ctl_status;
+	int i, fd, handler_array_size, fd_array_size;
+	int saved_errno;
 	int highest_socket_in_use;
 	MX_SOCKET *current_socket;
-	struct epoll_event event;
+	MX_SOCKET_HANDLER *socket_handler;
+	MX_SOCKET_HANDLER **new_fd_array;
+	mx_status_type mx_status;
 
 	if ( socket_handler_list == (MX_SOCKET_HANDLER_LIST *) NULL ) {
 		mx_warning( "%s: socket_handler_list is NULL!", fname );
@@ -51,6 +179,8 @@ mxsrv_update_epoll_fds( MX_LIST_HEAD *list_head,
 		mx_stack_traceback();
 
 		mx_warning( "%s: continuing anyway.", fname );
+
+		return;
 	}
 
 	if ( socket_handler_list->epoll_fd < 0 ) {
@@ -73,51 +203,141 @@ mxsrv_update_epoll_fds( MX_LIST_HEAD *list_head,
 
 	handler_array_size = socket_handler_list->handler_array_size;
 
+	/* The server sizes the handler array using the maximum number of
+	 * file descriptors for the process, so every descriptor that we
+	 * can be given will fit in an fd array of the same size.
+	 */
+
+	if ( socket_handler_list->epoll_fd_array == NULL ) {
+		fd_array_size = handler_array_size;
+
+		socket_handler_list->epoll_fd_array = (MX_SOCKET_HANDLER **)
+			calloc( fd_array_size, sizeof(MX_SOCKET_HANDLER *) );
+
+		if ( socket_handler_list->epoll_fd_array == NULL ) {
+			(void) mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate a %d element "
+			"array of epoll socket handler pointers.",
+				fd_array_size );
+
+			mx_force_core_dump();
+
+			/* Should not return. */
+		}
+
+		socket_handler_list->epoll_fd_array_size = fd_array_size;
+	}
+
+	fd_array_size = socket_handler_list->epoll_fd_array_size;
+
+	/* Build a new fd-indexed map from the current contents
+	 * of the socket handler array.
+	 */
+
+	new_fd_array = (MX_SOCKET_HANDLER **)
+			calloc( fd_array_size, sizeof(MX_SOCKET_HANDLER *) );
+
+	if ( new_fd_array == (MX_SOCKET_HANDLER **) NULL ) {
+		(void) mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %d element "
+		"array of epoll socket handler pointers.", fd_array_size );
+
+		return;
+	}
+
 	highest_socket_in_use = -1;
 
 	for ( i = 0; i < handler_array_size; i++ ) {
-		if ( socket_handler_list->array[i] != NULL ) {
-			current_socket
-				= socket_handler_list->array[i]->mx_socket;
+		socket_handler = socket_handler_list->array[i];
+
+		if ( socket_handler == NULL )
+			continue;
+
+		if ( mxsrv_epoll_get_events( socket_handler_list,
+						socket_handler ) == 0 )
+		{
+			continue;
+		}
+
+		current_socket = socket_handler->mx_socket;
+
+		fd = (int) current_socket->socket_fd;
 
-			if ( current_socket->socket_fd < 0 ) {
-			    MX_DEBUG(0,
+		if ( ( fd < 0 ) || ( fd >= fd_array_size ) ) {
+			MX_DEBUG(0,
 ("main #1: socket_handler_list->array[%d] = %p, current_socket fd = %d",
-	i, socket_handler_list->array[i], (int) current_socket->socket_fd));
-			}
+				i, socket_handler, fd));
+
+			continue;
+		}
 
-			event.events = EPOLLIN;
-			event.data.fd = current_socket->socket_fd;
+		new_fd_array[fd] = socket_handler;
 
-			ctl_status = epoll_ctl( socket_handler_list->epoll_fd,
-					EPOLL_CTL_ADD,
-					current_socket->socket_fd,
-					&event );
+		if ( fd > highest_socket_in_use ) {
+			highest_socket_in_use = fd;
+		}
+	}
 
-			if ( ctl_status != 0 ) {
-				saved_errno = errno;
+	/* Only descriptors whose handler has changed need epoll_ctl()
+	 * calls, so connecting or disconnecting a single client costs
+	 * O(1) system calls no matter how many clients there are.
+	 */
 
-				(void) mx_error( MXE_OPERATING_SYSTEM_ERROR,
-				fname, "The attempt to add file descriptor %d "
-				"to epoll descriptor %d failed.  "
-				"Errno = %d, error message = '%s'.",
-					current_socket->socket_fd,
-					socket_handler_list->epoll_fd,
-					saved_errno, strerror(saved_errno) );
+	for ( fd = 0; fd < fd_array_size; fd++ ) {
+		socket_handler = socket_handler_list->epoll_fd_array[fd];
 
-				/* Continue on to the next fd. */
+		if ( socket_handler == new_fd_array[fd] )
+			continue;
 
-				continue;
-			}
+		if ( socket_handler != NULL ) {
+			mxsrv_epoll_delete_fd( socket_handler_list, fd );
+		}
+		if ( new_fd_array[fd] != NULL ) {
+			mxsrv_epoll_control_fd( socket_handler_list,
+				EPOLL_CTL_ADD, fd,
+				mxsrv_epoll_get_events( socket_handler_list,
+							new_fd_array[fd] ) );
+		}
+
+		socket_handler_list->epoll_fd_array[fd] = new_fd_array[fd];
+	}
 
-			if ( highest_socket_in_use < 0 ) {
-			    highest_socket_in_use = current_socket->socket_fd;
+	free( new_fd_array );
 
-			} else
-			if ( current_socket->socket_fd > highest_socket_in_use )
-			{
-			    highest_socket_in_use = current_socket->socket_fd;
-			}
+	/* If callbacks are enabled, add the wakeup descriptor of the
+	 * callback queue to the epoll set, so that we wake up as soon
+	 * as a callback message is sent to the queue.
+	 */
+
+	if ( ( socket_handler_list->epoll_callback_queue_fd < 0 )
+	  && ( list_head != (MX_LIST_HEAD *) NULL )
+	  && ( list_head->callback_queue != (MX_CALLBACK_QUEUE *) NULL ) )
+	{
+		mx_status = mx_callback_queue_get_fd( list_head->callback_queue,
+								&fd );
+
+		if ( mx_status.code == MXE_SUCCESS ) {
+			mxsrv_epoll_add_fd( socket_handler_list, fd );
+
+			socket_handler_list->epoll_callback_queue_fd = fd;
+		}
+	}
+
+	/* Likewise, if the virtual timers are driven by a file descriptor,
+	 * then they are run when that descriptor becomes readable.
+	 */
+
+	if ( ( socket_handler_list->epoll_master_timer_fd < 0 )
+	  && ( list_head != (MX_LIST_HEAD *) NULL )
+	  && ( list_head->master_timer != (MX_INTERVAL_TIMER *) NULL ) )
+	{
+		mx_status = mx_virtual_timer_get_master_fd(
+						list_head->master_timer, &fd );
+
+		if ( mx_status.code == MXE_SUCCESS ) {
+			mxsrv_epoll_add_fd( socket_handler_list, fd );
+
+			socket_handler_list->epoll_master_timer_fd = fd;
 		}
 	}
 
@@ -128,6 +348,108 @@ mxsrv_update_epoll_fds( MX_LIST_HEAD *list_head,
 
 /*-------------------------------------------------------------------------*/
 
+/* Connecting or disconnecting a client, handing a client to or back
+ * from a worker thread, and a client's outbound queue filling up or
+ * emptying only change the state of a single descriptor, so
+ * mxsrv_update_epoll_fd() makes at most two epoll_ctl() calls for
+ * that descriptor rather than rescanning the whole handler array.
+ */
+
+void
+mxsrv_update_epoll_fd( MX_LIST_HEAD *list_head,
+			MX_SOCKET_HANDLER_LIST *socket_handler_list,
+			MX_SOCKET_HANDLER *socket_handler )
+{
+	static const char fname[] = "mxsrv_update_epoll_fd()";
+
+	int fd, highest_socket_in_use;
+	uint32_t events;
+	MX_SOCKET_HANDLER *old_handler;
+	MX_SOCKET_HANDLER **fd_array;
+
+	if ( socket_handler_list == (MX_SOCKET_HANDLER_LIST *) NULL ) {
+		mx_warning( "%s: socket_handler_list is NULL!", fname );
+
+		mx_stack_traceback();
+
+		mx_warning( "%s: continuing anyway.", fname );
+
+		return;
+	}
+
+	/* If the epoll set has not been created yet, then build it. */
+
+	if ( ( socket_handler_list->epoll_fd < 0 )
+	  || ( socket_handler_list->epoll_fd_array == NULL ) )
+	{
+		mxsrv_update_epoll_fds( list_head, socket_handler_list );
+		return;
+	}
+
+	fd = (int) socket_handler->mx_socket->socket_fd;
+
+	if ( ( fd < 0 ) || ( fd >= socket_handler_list->epoll_fd_array_size ) )
+	{
+		MX_DEBUG(0,("%s: socket handler %p has socket fd = %d",
+			fname, socket_handler, fd));
+
+		return;
+	}
+
+	events = mxsrv_epoll_get_events( socket_handler_list, socket_handler );
+
+	fd_array = socket_handler_list->epoll_fd_array;
+
+	old_handler = fd_array[fd];
+
+	if ( events != 0 ) {
+		if ( old_handler == socket_handler ) {
+			mxsrv_epoll_control_fd( socket_handler_list,
+					EPOLL_CTL_MOD, fd, events );
+			return;
+		}
+
+		if ( old_handler != NULL ) {
+			mxsrv_epoll_delete_fd( socket_handler_list, fd );
+		}
+
+		mxsrv_epoll_control_fd( socket_handler_list,
+					EPOLL_CTL_ADD, fd, events );
+
+		fd_array[fd] = socket_handler;
+
+		if ( fd > socket_handler_list->highest_socket_in_use ) {
+			socket_handler_list->highest_socket_in_use = fd;
+		}
+
+		return;
+	}
+
+	if ( old_handler != socket_handler )
+		return;
+
+	mxsrv_epoll_delete_fd( socket_handler_list, fd );
+
+	fd_array[fd] = NULL;
+
+	if ( fd == socket_handler_list->highest_socket_in_use ) {
+		highest_socket_in_use = fd - 1;
+
+		while ( ( highest_socket_in_use >= 0 )
+		  && ( fd_array[highest_socket_in_use] == NULL ) )
+		{
+			highest_socket_in_use--;
+		}
+
+		socket_handler_list->highest_socket_in_use
+						= highest_socket_in_use;
+	}
+
+	return;
+}
+
+/*-------------------------------------------------------------------------*/
+
 #define MXU_MAX_EPOLL_EVENTS 100
 
 void
@@ -136,13 +458,12 @@ mxsrv_process_sockets_with_epoll( MX_RECORD *mx_record_list,
 {
 	static const char fname[] = "mxsrv_process_sockets_with_epoll()";
 
-	int i, handler_array_size;
-	int saved_errno;
-	MX_SOCKET *current_socket;
+	int i, saved_errno;
 	int current_socket_fd;
 	int num_epoll_events, timeout_milliseconds;
 	struct epoll_event epoll_events[MXU_MAX_EPOLL_EVENTS];
-	mx_bool_type socket_data_available;
+	MX_SOCKET_HANDLER *socket_handler;
+	MX_LIST_HEAD *list_head;
 
 	MX_EVENT_HANDLER *event_handler;
 
@@ -151,7 +472,10 @@ mxsrv_process_sockets_with_epoll( MX_RECORD *mx_record_list,
 					MX_SOCKET_HANDLER_LIST *,
 					MX_EVENT_HANDLER * );
 
-	if ( socket_handler_list->highest_socket_in_use < 0 ) {
+	if ( ( socket_handler_list->highest_socket_in_use < 0 )
+	  && ( socket_handler_list->epoll_callback_queue_fd < 0 )
+	  && ( socket_handler_list->epoll_master_timer_fd < 0 ) )
+	{
 		/* If no sockets are in use, then there is no point
 		 * to calling epoll().
 		 */
@@ -162,92 +486,182 @@ mxsrv_process_sockets_with_epoll( MX_RECORD *mx_record_list,
 		return;
 	}
 
-	handler_array_size = socket_handler_list->handler_array_size;
+	/* Use epoll_wait() to look for events.  A negative timeout
+	 * means that we block until at least one event arrives.
+	 */
 
-	/* Use epoll_wait() to look for events. */
+	if ( socket_handler_list->wait_timeout_ms < 0 ) {
+		timeout_milliseconds = -1;
+	} else {
+		timeout_milliseconds = socket_handler_list->wait_timeout_ms;
+	}
 
-	timeout_milliseconds = 1;
+	/* If a client that is waiting to be disconnected still has a
+	 * request in a worker thread, wake up periodically so that the
+	 * main loop can close it once the worker thread is done.
+	 */
+
+	if ( mxsrv_outbound_disconnects_are_pending() ) {
+		if ( ( timeout_milliseconds < 0 )
+		  || ( timeout_milliseconds > MXSRV_OUTBOUND_WAIT_MS ) )
+		{
+			timeout_milliseconds = MXSRV_OUTBOUND_WAIT_MS;
+		}
+	}
+
+	mxsrv_core_unlock();
 
 	num_epoll_events = epoll_wait( socket_handler_list->epoll_fd,
 				epoll_events, MXU_MAX_EPOLL_EVENTS,
 				timeout_milliseconds );
 
+	mxsrv_core_lock();
+
 	if ( num_epoll_events < 0 ) {
 		saved_errno = errno;
 
-		(void) mx_error( MXE_NETWORK_IO_ERROR, fname,
-		"Error in epoll() while waiting for events.  "
-		"Errno = %d.  Error string = '%s'.",
-		saved_errno, strerror( saved_errno ) );
+		/* Receiving an EINTR errno from epoll_wait() is normal.
+		 * It just means that a signal handler fired while we
+		 * were blocked in the system call.
+		 */
+
+		if ( saved_errno != EINTR ) {
+			(void) mx_error( MXE_NETWORK_IO_ERROR, fname,
+			"Error in epoll() while waiting for events.  "
+			"Errno = %d.  Error string = '%s'.",
+			saved_errno, strerror( saved_errno ) );
+		}
 
-		socket_data_available = FALSE;
+		return;
 
 	} else if ( num_epoll_events == 0 ) {
 
 		/* Didn't get any events, so do nothing here. */
 
-		socket_data_available = FALSE;
-	} else {
-		socket_data_available = TRUE;
+		return;
 	}
 
-	if ( socket_data_available ) {
-		MX_DEBUG(2,("%s: epoll() returned.  num_epoll_events = %d",
-						fname, num_epoll_events));
+#if MS_SOCKET_EPOLL_DEBUG
+	MX_DEBUG(-2,("%s: epoll() returned.  num_epoll_events = %d",
+					fname, num_epoll_events));
+#endif
 
-		/* Figure out which sockets had events and
-		 * then process the events.
-		 */
+	list_head = NULL;
 
-		for ( i = 0; i < num_epoll_events; i++ ) {
+	/* Figure out which sockets had events and
+	 * then process the events.
+	 */
 
-			current_socket_fd = epoll_events[i].data.fd;
+	for ( i = 0; i < num_epoll_events; i++ ) {
 
-			/* FIXME!!! FIXME!!! FIXME!!! */
+		current_socket_fd = epoll_events[i].data.fd;
 
-			/* The following _DOES_NOT_WORK_, since the contents
-			 * of socket_handler_list->array[i] _DOES_NOT_
-			 * correspond to socket descriptor i at this time.
-			 * We need to evaluate the possibility of having
-			 * the index of the array element match the file
-			 * descriptor value.
-			 */
+		if ( current_socket_fd
+			== socket_handler_list->epoll_callback_queue_fd )
+		{
+			if ( list_head == (MX_LIST_HEAD *) NULL ) {
+				list_head = mx_get_record_list_head_struct(
+							mx_record_list );
+			}
 
-			/* FIXME: Change things to make the following line
-			 * true!
-			 */
+			if ( ( list_head != (MX_LIST_HEAD *) NULL )
+			  && ( list_head->callback_queue
+					!= (MX_CALLBACK_QUEUE *) NULL ) )
+			{
+				(void) mx_process_callbacks( mx_record_list,
+						list_head->callback_queue );
+			}
 
-			current_socket =
-		socket_handler_list->array[ current_socket_fd ]->mx_socket;
+			continue;
+		}
 
-			event_handler =
-				socket_handler_list->array[i]->event_handler;
+		if ( current_socket_fd
+			== socket_handler_list->epoll_master_timer_fd )
+		{
+			if ( list_head == (MX_LIST_HEAD *) NULL ) {
+				list_head = mx_get_record_list_head_struct(
+							mx_record_list );
+			}
 
-			if ( event_handler == NULL ) {
-				(void) mx_error( MXE_NETWORK_IO_ERROR, fname,
-		"Event handler pointer for socket handler %d is NULL.", i);
+			if ( ( list_head != (MX_LIST_HEAD *) NULL )
+			  && ( list_head->master_timer != NULL ) )
+			{
+				/* The virtual timer handlers only queue
+				 * callback messages, so they do not need
+				 * to keep the workers away from the hardware.
+				 */
 
-				continue;
+				(void) mx_virtual_timer_handle_master_fd(
+						list_head->master_timer );
 			}
 
-			process_event_fn = event_handler->process_event;
+			continue;
+		}
+
+		if ( ( current_socket_fd < 0 ) || ( current_socket_fd
+				>= socket_handler_list->epoll_fd_array_size ) )
+		{
+			(void) mx_error( MXE_NETWORK_IO_ERROR, fname,
+			"epoll_wait() returned file descriptor %d which is "
+			"outside the allowed range of 0 to %d.",
+				current_socket_fd,
+				socket_handler_list->epoll_fd_array_size - 1 );
 
-			if ( process_event_fn == NULL ) {
-				(void) mx_error(
-				MXE_NETWORK_IO_ERROR, fname,
-	"process_event function pointer for socket handler %d is NULL.", i);
+			continue;
+		}
 
-				continue;
-			}
+		/* A handler processed earlier in this pass may have
+		 * closed the client that this event belongs to, in
+		 * which case its slot in the fd array is now NULL.
+		 */
+
+		socket_handler =
+			socket_handler_list->epoll_fd_array[ current_socket_fd ];
+
+		if ( socket_handler == (MX_SOCKET_HANDLER *) NULL )
+			continue;
 
-			/* Process the event. */
+		/* Send queued messages if the client can take them now. */
 
-			(void) ( *process_event_fn )
-				( mx_record_list,
-				  socket_handler_list->array[i],
-				  socket_handler_list,
-				  event_handler );
+		if ( epoll_events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP) )
+		{
+			mxsrv_outbound_socket_writeable( socket_handler );
 		}
+
+		if ( ( socket_handler->worker_job_pending )
+		  || ( ( epoll_events[i].events
+				& (EPOLLIN | EPOLLERR | EPOLLHUP) ) == 0 ) )
+		{
+			continue;
+		}
+
+		event_handler = socket_handler->event_handler;
+
+		if ( event_handler == NULL ) {
+			(void) mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"Event handler pointer for socket %d is NULL.",
+				current_socket_fd );
+
+			continue;
+		}
+
+		process_event_fn = event_handler->process_event;
+
+		if ( process_event_fn == NULL ) {
+			(void) mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"process_event function pointer for socket %d is NULL.",
+				current_socket_fd );
+
+			continue;
+		}
+
+		/* Process the event. */
+
+		(void) ( *process_event_fn )
+			( mx_record_list,
+			  socket_handler,
+			  socket_handler_list,
+			  event_handler );
 	}
 
 	return;
@@ -38,7 +38,8 @@ mxsrv_update_select_fds( MX_LIST_HEAD *list_head,
 	int i, handler_array_size;
 	int highest_socket_in_use;
 	MX_SOCKET *current_socket;
-	fd_set select_readfds;
+	fd_set select_readfds, select_writefds;
+	mx_bool_type watch_socket;
 
 	if ( socket_handler_list == (MX_SOCKET_HANDLER_LIST *) NULL ) {
 		mx_warning( "%s: socket_handler_list is NULL!", fname );
@@ -51,6 +52,7 @@ mxsrv_update_select_fds( MX_LIST_HEAD *list_head,
 	handler_array_size = socket_handler_list->handler_array_size;
 
 	FD_ZERO(&select_readfds);
+	FD_ZERO(&select_writefds);
 
 	highest_socket_in_use = -1;
 
@@ -65,7 +67,26 @@ mxsrv_update_select_fds( MX_LIST_HEAD *list_head,
 	i, socket_handler_list->array[i], (int) current_socket->socket_fd));
 			}
 
-			FD_SET( current_socket->socket_fd, &select_readfds );
+			watch_socket = FALSE;
+
+			if ( socket_handler_list->array[i]->worker_job_pending
+								== FALSE )
+			{
+			    FD_SET( current_socket->socket_fd, &select_readfds );
+
+			    watch_socket = TRUE;
+			}
+
+			if ( mxsrv_outbound_queue_is_pending(
+					socket_handler_list->array[i] ) )
+			{
+			    FD_SET( current_socket->socket_fd, &select_writefds );
+
+			    watch_socket = TRUE;
+			}
+
+			if ( watch_socket == FALSE )
+				continue;
 
 			if ( highest_socket_in_use < 0 ) {
 			    highest_socket_in_use = current_socket->socket_fd;
@@ -83,6 +104,133 @@ mxsrv_update_select_fds( MX_LIST_HEAD *list_head,
 	/* Note: The following is an ANSI C structure copy. */
 
 	socket_handler_list->select_readfds = select_readfds;
+	socket_handler_list->select_writefds = select_writefds;
+
+	return;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void
+mxsrv_update_select_fd( MX_LIST_HEAD *list_head,
+			MX_SOCKET_HANDLER_LIST *socket_handler_list,
+			MX_SOCKET_HANDLER *socket_handler )
+{
+	static const char fname[] = "mxsrv_update_select_fd()";
+
+	int i, n, handler_array_size;
+	int highest_socket_in_use;
+	MX_SOCKET_HANDLER *other_handler;
+	MX_SOCKET *current_socket;
+	mx_bool_type in_use, watch_read, watch_write;
+
+	if ( socket_handler_list == (MX_SOCKET_HANDLER_LIST *) NULL ) {
+		mx_warning( "%s: socket_handler_list is NULL!", fname );
+
+		mx_stack_traceback();
+
+		mx_warning( "%s: continuing anyway.", fname );
+
+		return;
+	}
+
+	current_socket = socket_handler->mx_socket;
+
+	if ( current_socket->socket_fd < 0 ) {
+		MX_DEBUG(0,("%s: socket handler %p has socket fd = %d",
+		    fname, socket_handler, (int) current_socket->socket_fd));
+
+		return;
+	}
+
+	handler_array_size = socket_handler_list->handler_array_size;
+
+	n = (int) socket_handler->handler_array_index;
+
+	if ( ( n >= 0 ) && ( n < handler_array_size )
+	  && ( socket_handler_list->array[n] == socket_handler ) )
+	{
+		in_use = TRUE;
+	} else {
+		in_use = FALSE;
+	}
+
+	watch_read = FALSE;
+	watch_write = FALSE;
+
+	if ( in_use ) {
+		if ( socket_handler->worker_job_pending == FALSE ) {
+			watch_read = TRUE;
+		}
+		if ( mxsrv_outbound_queue_is_pending( socket_handler ) ) {
+			watch_write = TRUE;
+		}
+	}
+
+	if ( watch_read ) {
+		FD_SET( current_socket->socket_fd,
+			&(socket_handler_list->select_readfds) );
+	} else {
+		FD_CLR( current_socket->socket_fd,
+			&(socket_handler_list->select_readfds) );
+	}
+
+	if ( watch_write ) {
+		FD_SET( current_socket->socket_fd,
+			&(socket_handler_list->select_writefds) );
+	} else {
+		FD_CLR( current_socket->socket_fd,
+			&(socket_handler_list->select_writefds) );
+	}
+
+	if ( watch_read || watch_write ) {
+		if ( (int) current_socket->socket_fd
+			> socket_handler_list->highest_socket_in_use )
+		{
+			socket_handler_list->highest_socket_in_use
+				= current_socket->socket_fd;
+		}
+
+		return;
+	}
+
+	if ( (int) current_socket->socket_fd
+		!= socket_handler_list->highest_socket_in_use )
+	{
+		return;
+	}
+
+	/* We just stopped watching the highest numbered socket, so find
+	 * the highest one that is still being watched.
+	 */
+
+	highest_socket_in_use = -1;
+
+	for ( i = 0; i < handler_array_size; i++ ) {
+		other_handler = socket_handler_list->array[i];
+
+		if ( ( other_handler == NULL )
+		  || ( other_handler == socket_handler ) )
+		{
+			continue;
+		}
+
+		if ( ( other_handler->worker_job_pending )
+		  && ( mxsrv_outbound_queue_is_pending( other_handler )
+								== FALSE ) )
+		{
+			continue;
+		}
+
+		if ( (int) other_handler->mx_socket->socket_fd
+					> highest_socket_in_use )
+		{
+			highest_socket_in_use
+				= other_handler->mx_socket->socket_fd;
+		}
+	}
+
+	socket_handler_list->highest_socket_in_use = highest_socket_in_use;
 
 	return;
 }
@@ -97,8 +245,9 @@ mxsrv_process_sockets_with_select( MX_RECORD *mx_record_list,
 
 	int i, handler_array_size;
 	int num_fds_to_check, num_fds_with_activity;
+	MX_SOCKET_HANDLER *socket_handler;
 	MX_SOCKET *current_socket;
-	fd_set select_readfds;
+	fd_set select_readfds, select_writefds;
 	mx_bool_type socket_data_available;
 
 	MX_EVENT_HANDLER *event_handler;
@@ -130,12 +279,13 @@ mxsrv_process_sockets_with_select( MX_RECORD *mx_record_list,
 
 	/* Note: The following is an ANSI C structure copy.
 	 * 
-	 * We work here using a _copy_ of the master version of
-	 * select_readfds, since select() actually changes the copy
-	 * of select_readfds that is passed to it.
+	 * We work here using _copies_ of the master versions of
+	 * select_readfds and select_writefds, since select() actually
+	 * changes the copies that are passed to it.
 	 */
 
 	select_readfds = socket_handler_list->select_readfds;
+	select_writefds = socket_handler_list->select_writefds;
 
 	/* Initialize the arguments to select(). */
 
@@ -146,14 +296,25 @@ mxsrv_process_sockets_with_select( MX_RECORD *mx_record_list,
 #endif
 
 	timeout.tv_sec = 0;
-	timeout.tv_usec = 1;     /* Wait 1 microsecond. */
+
+	if ( mxsrv_worker_pool_is_enabled() ) {
+		/* Give the worker threads a chance to get the core mutex. */
+
+		timeout.tv_usec = 1000;
+	} else {
+		timeout.tv_usec = 1;     /* Wait 1 microsecond. */
+	}
 
 	socket_data_available = FALSE;
 	
 	/* Use select() to look for events. */
 
+	mxsrv_core_unlock();
+
 	num_fds_with_activity = select( num_fds_to_check,
-					&select_readfds, NULL, NULL, &timeout );
+			&select_readfds, &select_writefds, NULL, &timeout );
+
+	mxsrv_core_lock();
 
 #if defined(OS_WIN32)
 
@@ -223,51 +384,64 @@ mxsrv_process_sockets_with_select( MX_RECORD *mx_record_list,
 		 */
 
 		for ( i = 0; i < handler_array_size; i++ ) {
-		    if ( socket_handler_list->array[i] != NULL ) {
+			socket_handler = socket_handler_list->array[i];
 
-			current_socket
-				= socket_handler_list->array[i]->mx_socket;
+			if ( socket_handler == NULL )
+				continue;
+
+			current_socket = socket_handler->mx_socket;
 
 			if ( current_socket->socket_fd < 0 ) {
 				MX_DEBUG(0,
 ("main #2: socket_handler_list->array[%d] = %p, current_socket fd = %d",
-	i, socket_handler_list->array[i], (int) current_socket->socket_fd));
+	i, socket_handler, (int) current_socket->socket_fd));
 			}
 
+			/* Send queued messages if the client
+			 * can take them now.
+			 */
+
 			if ( FD_ISSET(current_socket->socket_fd,
-						&select_readfds) )
+						&select_writefds) )
 			{
-				event_handler =
-			socket_handler_list->array[i]->event_handler;
+				mxsrv_outbound_socket_writeable(
+							socket_handler );
+			}
 
-				if ( event_handler == NULL ) {
-					(void) mx_error(
-					MXE_NETWORK_IO_ERROR, fname,
-	"Event handler pointer for socket handler %d is NULL.", i);
+			if ( socket_handler->worker_job_pending )
+				continue;
 
-					continue;
-				}
+			if ( FD_ISSET(current_socket->socket_fd,
+						&select_readfds) == 0 )
+			{
+				continue;
+			}
+
+			event_handler = socket_handler->event_handler;
 
-				process_event_fn
-				    = event_handler->process_event;
+			if ( event_handler == NULL ) {
+				(void) mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"Event handler pointer for socket handler %d is NULL.", i);
 
-				if ( process_event_fn == NULL ) {
-					(void) mx_error(
-					MXE_NETWORK_IO_ERROR, fname,
-"process_event function pointer for socket handler %d is NULL.", i);
+				continue;
+			}
 
-					continue;
-				}
+			process_event_fn = event_handler->process_event;
 
-				/* Process the event. */
+			if ( process_event_fn == NULL ) {
+				(void) mx_error( MXE_NETWORK_IO_ERROR, fname,
+	"process_event function pointer for socket handler %d is NULL.", i);
 
-				(void) ( *process_event_fn )
-					( mx_record_list,
-					  socket_handler_list->array[i],
-					  socket_handler_list,
-					  event_handler );
+				continue;
 			}
-		    }
+
+			/* Process the event. */
+
+			(void) ( *process_event_fn )
+				( mx_record_list,
+				  socket_handler,
+				  socket_handler_list,
+				  event_handler );
 		}
 	}
 
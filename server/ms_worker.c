@@ -0,0 +1,1337 @@
+/*
+ * Name: ms_worker.c
+ *
+ * Purpose: Optional pool of worker threads that execute get_array and
+ *          put_array requests on behalf of MX server clients.
+ *
+ *          The network thread still receives and decodes all client
+ *          messages.  Get and put requests are then handed over as
+ *          MX_QUEUED_EVENTs to a worker thread, which processes them
+ *          with mxsrv_mx_client_socket_proc_queued_event() and sends
+ *          the response back to the client.
+ *
+ *          Records are grouped into serialization domains, which are
+ *          the connected components of the record dependency graph.
+ *          For example, an RS-232 interface and all of the motors that
+ *          use it form a single domain.  Every domain is assigned to
+ *          exactly one worker, so requests for the same hardware are
+ *          always executed in order, while requests for unrelated
+ *          hardware can proceed in parallel.  The fields of a batch
+ *          request are split up among the workers that serve them,
+ *          and the value changed polls for callbacks are run by the
+ *          worker that serves the polled record.
+ *
+ *          When the network thread itself must touch a record, it
+ *          blocks only the domain of that record.  Callback messages
+ *          whose records are unknown still block all of the domains.
+ *
+ *          Everything other than the hardware access itself, such as
+ *          decoding, encoding, sending and callback bookkeeping, is
+ *          done while holding the server core mutex, so that the rest
+ *          of the server does not need to be thread safe.  A client
+ *          connection with a request in progress is removed from the
+ *          socket multiplexer until its response has been sent, so the
+ *          responses for each connection are sent in request order.
+ *
+ *--------------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#define MS_WORKER_DEBUG		FALSE
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_stdint.h"
+#include "mx_socket.h"
+#include "mx_process.h"
+#include "mx_thread.h"
+#include "mx_mutex.h"
+#include "mx_condition_variable.h"
+#include "mx_callback.h"
+
+#include "ms_mxserver.h"
+
+typedef struct {
+	long domain_index;
+} MXSRV_WORKER_RECORD_INFO;
+
+typedef struct {
+	long worker_index;
+	long num_active_requests;
+	long num_blockers;
+} MXSRV_WORKER_DOMAIN;
+
+typedef struct {
+	uint32_t callback_id;
+	mx_bool_type get_new_value;
+} MXSRV_WORKER_POLL;
+
+typedef struct mxsrv_worker_type {
+	long worker_index;
+	MX_THREAD *thread;
+	MX_CONDITION_VARIABLE *queue_cv;
+	MX_QUEUED_EVENT *first_event;
+	MX_QUEUED_EVENT *last_event;
+	struct mxsrv_worker_pool_type *pool;
+} MXSRV_WORKER;
+
+typedef struct mxsrv_worker_pool_type {
+	MX_RECORD *record_list;
+	MX_SOCKET_HANDLER_LIST *socket_handler_list;
+
+	MX_MUTEX *core_mutex;
+
+	long num_workers;
+	MXSRV_WORKER *worker_array;
+
+	long num_records;
+	MXSRV_WORKER_RECORD_INFO *record_info_array;
+
+	long num_domains;
+	MXSRV_WORKER_DOMAIN *domain_array;
+
+	/* The following implement mxsrv_worker_pool_quiesce(). */
+
+	MX_CONDITION_VARIABLE *hardware_cv;
+	long num_active_hardware_requests;
+	mx_bool_type hardware_blocked;
+} MXSRV_WORKER_POOL;
+
+static MXSRV_WORKER_POOL *mxsrv_worker_pool = NULL;
+
+/*-------------------------------------------------------------------------*/
+
+static long
+mxsrv_worker_record_index( MXSRV_WORKER_POOL *pool, MX_RECORD *record )
+{
+	MXSRV_WORKER_RECORD_INFO *info;
+	long i;
+
+	if ( record == (MX_RECORD *) NULL )
+		return -1;
+
+	info = (MXSRV_WORKER_RECORD_INFO *) record->application_ptr;
+
+	if ( info == (MXSRV_WORKER_RECORD_INFO *) NULL )
+		return -1;
+
+	i = info - pool->record_info_array;
+
+	if ( ( i < 0 ) || ( i >= pool->num_records ) )
+		return -1;
+
+	return i;
+}
+
+/* mxsrv_worker_assign_domains() groups the records into serialization
+ * domains and then assigns the domains to the workers round robin.
+ */
+
+static mx_status_type
+mxsrv_worker_assign_domains( MXSRV_WORKER_POOL *pool )
+{
+	static const char fname[] = "mxsrv_worker_assign_domains()";
+
+	MXSRV_WORKER_RECORD_INFO *info_array;
+	MX_RECORD *list_head_record, *current_record;
+	long i, j, k, root_i, num_records, num_domains;
+	long *domain_parent_array, *domain_index_array;
+	mx_status_type mx_status;
+
+	list_head_record = pool->record_list->list_head;
+
+	num_records = 0;
+
+	current_record = list_head_record->next_record;
+
+	while ( current_record != list_head_record ) {
+		num_records++;
+
+		current_record = current_record->next_record;
+	}
+
+	if ( num_records == 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	info_array = (MXSRV_WORKER_RECORD_INFO *)
+		malloc( num_records * sizeof(MXSRV_WORKER_RECORD_INFO) );
+
+	if ( info_array == (MXSRV_WORKER_RECORD_INFO *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate worker information "
+		"for %ld records.", num_records );
+	}
+
+	pool->record_info_array = info_array;
+	pool->num_records = num_records;
+
+	/* Attach the information structures to the records. */
+
+	i = 0;
+
+	current_record = list_head_record->next_record;
+
+	while ( current_record != list_head_record ) {
+		info_array[i].domain_index = -1;
+
+		mx_status = mx_set_record_application_ptr( current_record,
+							&info_array[i] );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			/* Records that we cannot attach information to
+			 * are run by worker 0 and are not part of any
+			 * domain.
+			 */
+
+			mx_warning( "Record '%s' will always be processed "
+			"by worker 0.", current_record->name );
+		}
+
+		i++;
+
+		current_record = current_record->next_record;
+	}
+
+	/* Merge each record with all of the records that it depends on. */
+
+	domain_parent_array = (long *) malloc( num_records * sizeof(long) );
+
+	domain_index_array = (long *) malloc( num_records * sizeof(long) );
+
+	if ( ( domain_parent_array == (long *) NULL )
+	  || ( domain_index_array == (long *) NULL ) )
+	{
+		mx_free( domain_parent_array );
+		mx_free( domain_index_array );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate %ld element "
+		"domain arrays.", num_records );
+	}
+
+	for ( i = 0; i < num_records; i++ ) {
+		domain_parent_array[i] = i;
+		domain_index_array[i] = -1;
+	}
+
+	current_record = list_head_record->next_record;
+
+	while ( current_record != list_head_record ) {
+		i = mxsrv_worker_record_index( pool, current_record );
+
+		if ( i >= 0 ) {
+		    for ( k = 0; k < current_record->num_parent_records; k++ ) {
+			j = mxsrv_worker_record_index( pool,
+				current_record->parent_record_array[k] );
+
+			if ( j >= 0 ) {
+				mx_record_domain_merge( domain_parent_array,
+								i, j );
+			}
+		    }
+		}
+
+		current_record = current_record->next_record;
+	}
+
+	/* Number the domains. */
+
+	num_domains = 0;
+
+	for ( i = 0; i < num_records; i++ ) {
+		root_i = mx_record_domain_find_root( domain_parent_array, i );
+
+		if ( domain_index_array[root_i] < 0 ) {
+			domain_index_array[root_i] = num_domains;
+
+			num_domains++;
+		}
+
+		info_array[i].domain_index = domain_index_array[root_i];
+	}
+
+	mx_free( domain_parent_array );
+	mx_free( domain_index_array );
+
+	/* Assign the domains to workers round robin. */
+
+	pool->domain_array = (MXSRV_WORKER_DOMAIN *)
+			calloc( num_domains, sizeof(MXSRV_WORKER_DOMAIN) );
+
+	if ( pool->domain_array == (MXSRV_WORKER_DOMAIN *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate %ld domains.",
+			num_domains );
+	}
+
+	pool->num_domains = num_domains;
+
+	for ( i = 0; i < num_domains; i++ ) {
+		pool->domain_array[i].worker_index = i % pool->num_workers;
+		pool->domain_array[i].num_active_requests = 0;
+		pool->domain_array[i].num_blockers = 0;
+	}
+
+	mx_info( "Assigned %ld records in %ld serialization domains "
+		"to %ld worker threads.",
+		num_records, num_domains, pool->num_workers );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* mxsrv_worker_find_domain() returns NULL for records that are not part
+ * of any domain.  Such records are run by worker 0.
+ */
+
+static MXSRV_WORKER_DOMAIN *
+mxsrv_worker_find_domain( MXSRV_WORKER_POOL *pool, MX_RECORD *record )
+{
+	long record_index, domain_index;
+
+	record_index = mxsrv_worker_record_index( pool, record );
+
+	if ( record_index < 0 )
+		return NULL;
+
+	domain_index = pool->record_info_array[record_index].domain_index;
+
+	if ( ( domain_index < 0 ) || ( domain_index >= pool->num_domains ) )
+		return NULL;
+
+	return &(pool->domain_array[domain_index]);
+}
+
+static long
+mxsrv_worker_find_worker( MXSRV_WORKER_POOL *pool, MX_RECORD *record )
+{
+	MXSRV_WORKER_DOMAIN *domain;
+
+	domain = mxsrv_worker_find_domain( pool, record );
+
+	if ( domain == (MXSRV_WORKER_DOMAIN *) NULL )
+		return 0;
+
+	return domain->worker_index;
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* mxsrv_worker_block_domain() keeps new hardware requests for a domain
+ * from starting and then waits for the ones in progress to finish.
+ * More than one thread may block the same domain at the same time.
+ */
+
+static void
+mxsrv_worker_block_domain( MXSRV_WORKER_POOL *pool,
+			MXSRV_WORKER_DOMAIN *domain )
+{
+	domain->num_blockers++;
+
+	while ( domain->num_active_requests > 0 ) {
+		(void) mx_condition_variable_wait( pool->hardware_cv,
+							pool->core_mutex );
+	}
+}
+
+static void
+mxsrv_worker_unblock_domain( MXSRV_WORKER_POOL *pool,
+			MXSRV_WORKER_DOMAIN *domain )
+{
+	domain->num_blockers--;
+
+	if ( domain->num_blockers == 0 ) {
+		(void) mx_condition_variable_broadcast( pool->hardware_cv );
+	}
+}
+
+/* mxsrv_worker_process_unlocked() is used by the workers to process
+ * a record field with the core mutex released.
+ */
+
+static mx_status_type
+mxsrv_worker_process_unlocked( MXSRV_WORKER_POOL *pool,
+				MX_RECORD *record,
+				MX_RECORD_FIELD *record_field,
+				MX_SOCKET_HANDLER *socket_handler,
+				int operation )
+{
+	MXSRV_WORKER_DOMAIN *domain;
+	mx_status_type mx_status;
+
+	domain = mxsrv_worker_find_domain( pool, record );
+
+	while ( pool->hardware_blocked
+	  || ( ( domain != (MXSRV_WORKER_DOMAIN *) NULL )
+	    && ( domain->num_blockers > 0 ) ) )
+	{
+		(void) mx_condition_variable_wait( pool->hardware_cv,
+							pool->core_mutex );
+	}
+
+	pool->num_active_hardware_requests++;
+
+	if ( domain != (MXSRV_WORKER_DOMAIN *) NULL ) {
+		domain->num_active_requests++;
+	}
+
+	mx_mutex_unlock( pool->core_mutex );
+
+	mx_status = mx_process_record_field_without_callbacks(
+				record, record_field,
+				socket_handler, operation );
+
+	mx_mutex_lock( pool->core_mutex );
+
+	pool->num_active_hardware_requests--;
+
+	if ( domain != (MXSRV_WORKER_DOMAIN *) NULL ) {
+		domain->num_active_requests--;
+	}
+
+	if ( ( pool->num_active_hardware_requests == 0 )
+	  || ( ( domain != (MXSRV_WORKER_DOMAIN *) NULL )
+	    && ( domain->num_active_requests == 0 ) ) )
+	{
+		(void) mx_condition_variable_broadcast( pool->hardware_cv );
+	}
+
+	return mx_status;
+}
+
+/* mxsrv_worker_get_spare_buffer() makes sure that the socket handler has
+ * a spare buffer to take the place of a request handed to a worker.
+ */
+
+static mx_status_type
+mxsrv_worker_get_spare_buffer( MX_SOCKET_HANDLER *socket_handler )
+{
+	mx_status_type mx_status;
+
+	if ( socket_handler->spare_buffer == (MX_NETWORK_MESSAGE_BUFFER *) NULL )
+	{
+		mx_status = mx_allocate_network_buffer(
+				&(socket_handler->spare_buffer),
+				NULL, socket_handler,
+				MXU_NETWORK_INITIAL_MESSAGE_BUFFER_LENGTH );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	socket_handler->spare_buffer->data_format = socket_handler->data_format;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+static mx_status_type
+mxsrv_worker_append_event( MXSRV_WORKER *worker,
+			MX_QUEUED_EVENT *queued_event )
+{
+	if ( worker->last_event == (MX_QUEUED_EVENT *) NULL ) {
+		worker->first_event = queued_event;
+	} else {
+		worker->last_event->next_event = queued_event;
+	}
+
+	worker->last_event = queued_event;
+
+	return mx_condition_variable_signal( worker->queue_cv );
+}
+
+/*-------------------------------------------------------------------------*/
+
+static void
+mxsrv_worker_finish_event( MXSRV_WORKER_POOL *pool,
+			MX_QUEUED_EVENT *queued_event )
+{
+	MX_SOCKET_HANDLER *socket_handler;
+	MX_LIST_HEAD *list_head;
+
+	socket_handler = queued_event->socket_handler;
+
+	/* If an event time manager is in use, compute the time
+	 * of the next allowed event.
+	 */
+
+	if ( ( queued_event->record != (MX_RECORD *) NULL )
+	  && ( queued_event->record->event_time_manager != NULL ) )
+	{
+		(void) mx_update_next_allowed_event_time( queued_event->record,
+						queued_event->record_field );
+	}
+
+	/* The request's buffer becomes the spare buffer for the next job. */
+
+	socket_handler->spare_buffer =
+		(MX_NETWORK_MESSAGE_BUFFER *) queued_event->event_data;
+
+	/* Let the multiplexer watch this client again. */
+
+	socket_handler->worker_job_pending = FALSE;
+
+	list_head = mx_get_record_list_head_struct( pool->record_list );
+
+	mxsrv_update_fd( list_head, pool->socket_handler_list, socket_handler );
+
+	mx_free( queued_event );
+}
+
+/* mxsrv_worker_process_batch_part() processes the fields of a batch that
+ * are served by this worker.  The last worker to finish sends the
+ * response.  Building the response looks at the values of all of the
+ * fields in the batch, so their domains are blocked while that is done.
+ */
+
+static void
+mxsrv_worker_process_batch_part( MXSRV_WORKER *worker,
+				MX_QUEUED_EVENT *queued_event )
+{
+	MXSRV_WORKER_POOL *pool;
+	MXSRV_BATCH *batch;
+	MXSRV_WORKER_DOMAIN *domain;
+	MX_SOCKET_HANDLER *socket_handler;
+	MX_NETWORK_MESSAGE_BUFFER *network_message;
+	unsigned long i;
+
+	pool = worker->pool;
+
+	batch = (MXSRV_BATCH *) queued_event->event_data;
+
+	mx_free( queued_event );
+
+	for ( i = 0; i < batch->num_fields; i++ ) {
+		if ( batch->status_array[i].code != MXE_SUCCESS )
+			continue;
+
+		if ( mxsrv_worker_find_worker( pool, batch->record_array[i] )
+						!= worker->worker_index )
+		{
+			continue;
+		}
+
+		mxsrv_batch_process_field( batch, i );
+	}
+
+	batch->num_parts_pending--;
+
+	if ( batch->num_parts_pending > 0 )
+		return;
+
+	socket_handler = batch->socket_handler;
+	network_message = batch->network_message;
+
+	for ( i = 0; i < batch->num_fields; i++ ) {
+		domain = mxsrv_worker_find_domain( pool,
+						batch->record_array[i] );
+
+		if ( domain != (MXSRV_WORKER_DOMAIN *) NULL ) {
+			mxsrv_worker_block_domain( pool, domain );
+		}
+	}
+
+	(void) mxsrv_batch_send_response( batch );
+
+	for ( i = 0; i < batch->num_fields; i++ ) {
+		domain = mxsrv_worker_find_domain( pool,
+						batch->record_array[i] );
+
+		if ( domain != (MXSRV_WORKER_DOMAIN *) NULL ) {
+			mxsrv_worker_unblock_domain( pool, domain );
+		}
+	}
+
+	mxsrv_batch_destroy( batch );
+
+	/* The request's buffer becomes the spare buffer for the next job. */
+
+	socket_handler->spare_buffer = network_message;
+
+	/* Let the multiplexer watch this client again. */
+
+	socket_handler->worker_job_pending = FALSE;
+
+	mxsrv_update_fd( socket_handler->list_head,
+				pool->socket_handler_list, socket_handler );
+}
+
+/* mxsrv_worker_process_poll() polls a record field for value changed
+ * callbacks.  The callback is looked up again by its id, since it may
+ * have been deleted while the poll was waiting in the queue.
+ */
+
+static void
+mxsrv_worker_process_poll( MXSRV_WORKER *worker,
+				MX_QUEUED_EVENT *queued_event )
+{
+	MXSRV_WORKER_POLL *poll;
+	MX_RECORD_FIELD *record_field;
+	MX_LIST *callback_list;
+	MX_LIST_ENTRY *list_start, *list_entry;
+	MX_CALLBACK *callback, *callback_ptr;
+	mx_bool_type value_changed;
+	mx_status_type mx_status;
+
+	poll = (MXSRV_WORKER_POLL *) queued_event->event_data;
+
+	record_field = queued_event->record_field;
+
+	callback_list = (MX_LIST *) record_field->callback_list;
+
+	callback = NULL;
+
+	if ( callback_list != (MX_LIST *) NULL ) {
+		list_start = callback_list->list_start;
+
+		list_entry = list_start;
+
+		while ( list_entry != (MX_LIST_ENTRY *) NULL ) {
+			callback_ptr = list_entry->list_entry_data;
+
+			if ( ( callback_ptr != (MX_CALLBACK *) NULL )
+			  && ( callback_ptr->callback_id == poll->callback_id ) )
+			{
+				callback = callback_ptr;
+				break;
+			}
+
+			list_entry = list_entry->next_list_entry;
+
+			if ( list_entry == list_start )
+				break;
+		}
+	}
+
+	if ( callback == (MX_CALLBACK *) NULL ) {
+		/* The callback is gone, so there is nothing to do. */
+	} else
+	if ( poll->get_new_value ) {
+		/* This does the same thing as mx_process_record_field(),
+		 * except that the core mutex is released while the driver
+		 * talks to the hardware.
+		 */
+
+		mx_status = mxsrv_worker_process_unlocked( worker->pool,
+					queued_event->record, record_field,
+					NULL, MX_PROCESS_GET );
+
+		if ( mx_status.code == MXE_SUCCESS ) {
+			mx_status = mx_test_for_value_changed( record_field,
+					MX_PROCESS_GET, &value_changed );
+
+			if ( ( mx_status.code == MXE_SUCCESS )
+			  && value_changed
+			  && ( record_field->callback_list != NULL ) )
+			{
+				(void) mx_local_field_invoke_callback_list(
+					record_field, MXCBT_VALUE_CHANGED );
+			}
+		}
+	} else {
+		(void) mx_poll_callback_field( callback, FALSE );
+	}
+
+	mx_free( poll );
+	mx_free( queued_event );
+}
+
+/*-------------------------------------------------------------------------*/
+
+static mx_status_type
+mxsrv_worker_thread_fn( MX_THREAD *thread, void *args )
+{
+	static const char fname[] = "mxsrv_worker_thread_fn()";
+
+	MXSRV_WORKER *worker;
+	MXSRV_WORKER_POOL *pool;
+	MX_QUEUED_EVENT *queued_event;
+	MX_EVENT_HANDLER *event_handler;
+	mx_status_type mx_status;
+
+	if ( args == NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MXSRV_WORKER pointer passed was NULL." );
+	}
+
+	worker = (MXSRV_WORKER *) args;
+
+	pool = worker->pool;
+
+	mx_mutex_lock( pool->core_mutex );
+
+	for (;;) {
+		while ( worker->first_event == (MX_QUEUED_EVENT *) NULL ) {
+			mx_status = mx_condition_variable_wait(
+					worker->queue_cv, pool->core_mutex );
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				mx_mutex_unlock( pool->core_mutex );
+
+				return mx_status;
+			}
+		}
+
+		queued_event = worker->first_event;
+
+		worker->first_event = queued_event->next_event;
+
+		if ( worker->first_event == (MX_QUEUED_EVENT *) NULL ) {
+			worker->last_event = NULL;
+		}
+
+		queued_event->next_event = NULL;
+
+#if MS_WORKER_DEBUG
+		MX_DEBUG(-2,("%s: worker %ld processing event type %ld",
+			fname, worker->worker_index,
+			queued_event->event_type));
+#endif
+		if ( queued_event->event_type == MXQ_BATCH_PART ) {
+			mxsrv_worker_process_batch_part( worker,
+							queued_event );
+			continue;
+		}
+
+		if ( queued_event->event_type == MXQ_POLL_CALLBACK ) {
+			mxsrv_worker_process_poll( worker, queued_event );
+			continue;
+		}
+
+		event_handler = queued_event->socket_handler->event_handler;
+
+		if ( ( event_handler == (MX_EVENT_HANDLER *) NULL )
+		  || ( event_handler->process_queued_event == NULL ) )
+		{
+			(void) mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+			"The socket handler for a queued event does not "
+			"have a process_queued_event function." );
+		} else {
+			(void) ( *event_handler->process_queued_event )
+					( pool->record_list, queued_event );
+		}
+
+		mxsrv_worker_finish_event( pool, queued_event );
+	}
+
+	MXW_NOT_REACHED( return MX_SUCCESSFUL_RESULT; )
+}
+
+/*-------------------------------------------------------------------------*/
+
+mx_status_type
+mxsrv_worker_pool_create( MX_RECORD *record_list,
+			MX_SOCKET_HANDLER_LIST *socket_handler_list,
+			long num_workers )
+{
+	static const char fname[] = "mxsrv_worker_pool_create()";
+
+	MXSRV_WORKER_POOL *pool;
+	MXSRV_WORKER *worker;
+	MX_LIST_HEAD *list_head;
+	char thread_name[40];
+	long i;
+	mx_status_type mx_status;
+
+	if ( record_list == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_RECORD pointer passed was NULL." );
+	}
+	if ( socket_handler_list == (MX_SOCKET_HANDLER_LIST *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_SOCKET_HANDLER_LIST pointer passed was NULL." );
+	}
+	if ( num_workers <= 0 ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The number of worker threads (%ld) must be positive.",
+			num_workers );
+	}
+	if ( mxsrv_worker_pool != (MXSRV_WORKER_POOL *) NULL ) {
+		return mx_error( MXE_ALREADY_EXISTS, fname,
+		"The worker pool has already been created." );
+	}
+
+	pool = (MXSRV_WORKER_POOL *) calloc( 1, sizeof(MXSRV_WORKER_POOL) );
+
+	if ( pool == (MXSRV_WORKER_POOL *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an "
+		"MXSRV_WORKER_POOL structure." );
+	}
+
+	pool->record_list = record_list;
+	pool->socket_handler_list = socket_handler_list;
+	pool->num_workers = num_workers;
+
+	mx_status = mx_mutex_create( &(pool->core_mutex) );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_condition_variable_create( &(pool->hardware_cv) );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mxsrv_worker_assign_domains( pool );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	pool->worker_array = (MXSRV_WORKER *)
+				calloc( num_workers, sizeof(MXSRV_WORKER) );
+
+	if ( pool->worker_array == (MXSRV_WORKER *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate %ld workers.",
+			num_workers );
+	}
+
+	/* The network thread owns the core mutex except when it is
+	 * waiting in the socket multiplexer.
+	 */
+
+	mx_mutex_lock( pool->core_mutex );
+
+	mxsrv_worker_pool = pool;
+
+	for ( i = 0; i < num_workers; i++ ) {
+		worker = &(pool->worker_array[i]);
+
+		worker->worker_index = i;
+		worker->pool = pool;
+		worker->first_event = NULL;
+		worker->last_event = NULL;
+
+		mx_status = mx_condition_variable_create( &(worker->queue_cv) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		snprintf( thread_name, sizeof(thread_name),
+				"MX server worker %ld", i );
+
+		mx_status = mx_thread_create( &(worker->thread),
+						thread_name,
+						mxsrv_worker_thread_fn,
+						worker );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	/* Callback messages and value changed polls are routed through
+	 * the worker pool from now on.
+	 */
+
+	list_head = mx_get_record_list_head_struct( record_list );
+
+	if ( list_head != (MX_LIST_HEAD *) NULL ) {
+		list_head->callback_message_handler =
+				mxsrv_worker_pool_handle_callback_message;
+
+		list_head->poll_callback_dispatcher =
+				mxsrv_worker_pool_dispatch_poll;
+	}
+
+	mx_mutex_unlock( pool->core_mutex );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+mx_bool_type
+mxsrv_worker_pool_is_enabled( void )
+{
+	if ( mxsrv_worker_pool == (MXSRV_WORKER_POOL *) NULL ) {
+		return FALSE;
+	} else {
+		return TRUE;
+	}
+}
+
+void
+mxsrv_core_lock( void )
+{
+	if ( mxsrv_worker_pool != (MXSRV_WORKER_POOL *) NULL ) {
+		mx_mutex_lock( mxsrv_worker_pool->core_mutex );
+	}
+}
+
+void
+mxsrv_core_unlock( void )
+{
+	if ( mxsrv_worker_pool != (MXSRV_WORKER_POOL *) NULL ) {
+		mx_mutex_unlock( mxsrv_worker_pool->core_mutex );
+	}
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* mxsrv_worker_pool_queue_event() must be called with the core mutex held.
+ * The message to be processed must be in socket_handler->message_buffer.
+ * That buffer is handed to the queued event and replaced by the socket
+ * handler's spare buffer, so callback messages that the network thread
+ * sends to this client while the job is in progress cannot overwrite
+ * the request or the response.
+ */
+
+mx_status_type
+mxsrv_worker_pool_queue_event( MX_SOCKET_HANDLER *socket_handler,
+				MX_RECORD *record,
+				MX_RECORD_FIELD *record_field )
+{
+	static const char fname[] = "mxsrv_worker_pool_queue_event()";
+
+	MXSRV_WORKER_POOL *pool;
+	MXSRV_WORKER *worker;
+	MX_QUEUED_EVENT *queued_event;
+	mx_status_type mx_status;
+
+	pool = mxsrv_worker_pool;
+
+	if ( pool == (MXSRV_WORKER_POOL *) NULL ) {
+		return mx_error( MXE_INITIALIZATION_ERROR, fname,
+		"The worker pool has not been created." );
+	}
+
+	queued_event = (MX_QUEUED_EVENT *) malloc( sizeof(MX_QUEUED_EVENT) );
+
+	if ( queued_event == (MX_QUEUED_EVENT *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an MX_QUEUED_EVENT." );
+	}
+
+	mx_status = mxsrv_worker_get_spare_buffer( socket_handler );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_free( queued_event );
+		return mx_status;
+	}
+
+	queued_event->socket_handler = socket_handler;
+	queued_event->record = record;
+	queued_event->record_field = record_field;
+	queued_event->event_type = MXQ_NETWORK_MESSAGE;
+	queued_event->event_data = socket_handler->message_buffer;
+	queued_event->next_event = NULL;
+
+	socket_handler->message_buffer = socket_handler->spare_buffer;
+	socket_handler->spare_buffer = NULL;
+
+	worker = &(pool->worker_array[ mxsrv_worker_find_worker( pool,
+								record ) ]);
+
+	/* Stop watching this client until the response has been sent. */
+
+	socket_handler->worker_job_pending = TRUE;
+
+	mxsrv_update_fd( socket_handler->list_head,
+				pool->socket_handler_list, socket_handler );
+
+	return mxsrv_worker_append_event( worker, queued_event );
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* mxsrv_worker_pool_queue_batch() must be called with the core mutex held
+ * and with the batch request in socket_handler->message_buffer.  Each
+ * worker that serves one of the fields in the batch is sent its part of
+ * the batch.  The batch belongs to the worker pool after this call.
+ */
+
+mx_status_type
+mxsrv_worker_pool_queue_batch( MXSRV_BATCH *batch )
+{
+	static const char fname[] = "mxsrv_worker_pool_queue_batch()";
+
+	MXSRV_WORKER_POOL *pool;
+	MX_SOCKET_HANDLER *socket_handler;
+	MX_QUEUED_EVENT **event_array;
+	MX_QUEUED_EVENT *queued_event;
+	unsigned long j;
+	long i, num_parts;
+	mx_status_type mx_status;
+
+	pool = mxsrv_worker_pool;
+
+	if ( pool == (MXSRV_WORKER_POOL *) NULL ) {
+		mxsrv_batch_destroy( batch );
+
+		return mx_error( MXE_INITIALIZATION_ERROR, fname,
+		"The worker pool has not been created." );
+	}
+
+	socket_handler = batch->socket_handler;
+
+	event_array = (MX_QUEUED_EVENT **)
+		calloc( pool->num_workers, sizeof(MX_QUEUED_EVENT *) );
+
+	if ( event_array == (MX_QUEUED_EVENT **) NULL ) {
+		mxsrv_batch_destroy( batch );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %ld element "
+		"array of MX_QUEUED_EVENT pointers.", pool->num_workers );
+	}
+
+	/* Make an event for each worker that has fields to process. */
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	num_parts = 0;
+
+	for ( j = 0; j < batch->num_fields; j++ ) {
+		if ( batch->status_array[j].code != MXE_SUCCESS )
+			continue;
+
+		i = mxsrv_worker_find_worker( pool, batch->record_array[j] );
+
+		if ( event_array[i] != (MX_QUEUED_EVENT *) NULL )
+			continue;
+
+		queued_event = (MX_QUEUED_EVENT *)
+				malloc( sizeof(MX_QUEUED_EVENT) );
+
+		if ( queued_event == (MX_QUEUED_EVENT *) NULL ) {
+			mx_status = mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an MX_QUEUED_EVENT." );
+			break;
+		}
+
+		queued_event->socket_handler = socket_handler;
+		queued_event->record = NULL;
+		queued_event->record_field = NULL;
+		queued_event->event_type = MXQ_BATCH_PART;
+		queued_event->event_data = batch;
+		queued_event->next_event = NULL;
+
+		event_array[i] = queued_event;
+
+		num_parts++;
+	}
+
+	if ( ( mx_status.code == MXE_SUCCESS ) && ( num_parts > 0 ) ) {
+		mx_status = mxsrv_worker_get_spare_buffer( socket_handler );
+	}
+
+	if ( ( mx_status.code != MXE_SUCCESS ) || ( num_parts == 0 ) ) {
+
+		/* Either none of the fields need to be processed or we
+		 * could not queue the batch, so respond right away.
+		 */
+
+		for ( i = 0; i < pool->num_workers; i++ ) {
+			mx_free( event_array[i] );
+		}
+
+		mx_free( event_array );
+
+		for ( j = 0; j < batch->num_fields; j++ ) {
+			if ( batch->status_array[j].code == MXE_SUCCESS ) {
+				batch->status_array[j] = mx_status;
+			}
+		}
+
+		mx_status = mxsrv_batch_send_response( batch );
+
+		mxsrv_batch_destroy( batch );
+
+		return mx_status;
+	}
+
+	/* The request buffer now belongs to the batch. */
+
+	socket_handler->message_buffer = socket_handler->spare_buffer;
+	socket_handler->spare_buffer = NULL;
+
+	/* Stop watching this client until the response has been sent. */
+
+	socket_handler->worker_job_pending = TRUE;
+
+	mxsrv_update_fd( socket_handler->list_head,
+				pool->socket_handler_list, socket_handler );
+
+	batch->num_parts_pending = num_parts;
+
+	for ( i = 0; i < pool->num_workers; i++ ) {
+		if ( event_array[i] != (MX_QUEUED_EVENT *) NULL ) {
+			(void) mxsrv_worker_append_event(
+				&(pool->worker_array[i]), event_array[i] );
+		}
+	}
+
+	mx_free( event_array );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* mxsrv_worker_pool_dispatch_poll() is installed as the record list's
+ * poll_callback_dispatcher.  It sends each value changed poll to the
+ * worker that serves the polled record, unless that poll is already
+ * waiting in the worker's queue.
+ */
+
+mx_status_type
+mxsrv_worker_pool_dispatch_poll( void *callback_ptr,
+				mx_bool_type get_new_value )
+{
+	static const char fname[] = "mxsrv_worker_pool_dispatch_poll()";
+
+	MXSRV_WORKER_POOL *pool;
+	MXSRV_WORKER *worker;
+	MXSRV_WORKER_POLL *poll;
+	MX_CALLBACK *callback;
+	MX_RECORD_FIELD *record_field;
+	MX_QUEUED_EVENT *queued_event;
+	mx_status_type mx_status;
+
+	pool = mxsrv_worker_pool;
+
+	callback = (MX_CALLBACK *) callback_ptr;
+
+	if ( callback == (MX_CALLBACK *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_CALLBACK pointer passed was NULL." );
+	}
+
+	record_field = callback->u.record_field;
+
+	if ( ( pool == (MXSRV_WORKER_POOL *) NULL )
+	  || ( record_field == (MX_RECORD_FIELD *) NULL )
+	  || ( mxsrv_worker_find_domain( pool, record_field->record ) == NULL ) )
+	{
+		mxsrv_worker_pool_quiesce();
+
+		mx_status = mx_poll_callback_field( callback, get_new_value );
+
+		mxsrv_worker_pool_resume();
+
+		return mx_status;
+	}
+
+	worker = &(pool->worker_array[
+			mxsrv_worker_find_worker( pool, record_field->record ) ]);
+
+	for ( queued_event = worker->first_event;
+	      queued_event != (MX_QUEUED_EVENT *) NULL;
+	      queued_event = queued_event->next_event )
+	{
+		if ( ( queued_event->event_type != MXQ_POLL_CALLBACK )
+		  || ( queued_event->record_field != record_field ) )
+		{
+			continue;
+		}
+
+		poll = (MXSRV_WORKER_POLL *) queued_event->event_data;
+
+		if ( poll->callback_id == callback->callback_id ) {
+			if ( get_new_value ) {
+				poll->get_new_value = TRUE;
+			}
+
+			return MX_SUCCESSFUL_RESULT;
+		}
+	}
+
+	queued_event = (MX_QUEUED_EVENT *) malloc( sizeof(MX_QUEUED_EVENT) );
+
+	poll = (MXSRV_WORKER_POLL *) malloc( sizeof(MXSRV_WORKER_POLL) );
+
+	if ( ( queued_event == (MX_QUEUED_EVENT *) NULL )
+	  || ( poll == (MXSRV_WORKER_POLL *) NULL ) )
+	{
+		mx_free( queued_event );
+		mx_free( poll );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to queue a poll of '%s.%s'.",
+			record_field->record->name, record_field->name );
+	}
+
+	poll->callback_id = callback->callback_id;
+	poll->get_new_value = get_new_value;
+
+	queued_event->socket_handler = NULL;
+	queued_event->record = record_field->record;
+	queued_event->record_field = record_field;
+	queued_event->event_type = MXQ_POLL_CALLBACK;
+	queued_event->event_data = poll;
+	queued_event->next_event = NULL;
+
+	return mxsrv_worker_append_event( worker, queued_event );
+}
+
+/* mxsrv_worker_pool_handle_callback_message() is installed as the record
+ * list's callback_message_handler.  Polls are sent on to the workers by
+ * mxsrv_worker_pool_dispatch_poll(), so they do not block anything here.
+ * A motor backlash correction blocks the domain of the motor.  For other
+ * callback messages, we do not know which records will be used, so all
+ * of the domains are blocked.
+ */
+
+mx_status_type
+mxsrv_worker_pool_handle_callback_message( void *callback_message_ptr )
+{
+	MX_CALLBACK_MESSAGE *callback_message;
+	MX_RECORD *motor_record;
+	mx_status_type mx_status;
+
+	callback_message = (MX_CALLBACK_MESSAGE *) callback_message_ptr;
+
+	switch( callback_message->callback_type ) {
+	case MXCBT_POLL:
+		mx_status = mx_process_callback_message( callback_message );
+		break;
+
+	case MXCBT_MOTOR_BACKLASH:
+		motor_record = callback_message->u.backlash.motor_record;
+
+		mxsrv_worker_pool_quiesce_record( motor_record );
+
+		mx_status = mx_process_callback_message( callback_message );
+
+		mxsrv_worker_pool_resume_record( motor_record );
+		break;
+
+	default:
+		mxsrv_worker_pool_quiesce();
+
+		mx_status = mx_process_callback_message( callback_message );
+
+		mxsrv_worker_pool_resume();
+		break;
+	}
+
+	return mx_status;
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* The network thread calls mxsrv_worker_pool_quiesce() before doing
+ * anything that may talk to hardware it does not know about, such as
+ * running a callback function.  It waits for all worker hardware requests
+ * in progress to finish and then keeps new ones from starting until
+ * mxsrv_worker_pool_resume() is called.  Both must be called with the
+ * core mutex held.
+ */
+
+void
+mxsrv_worker_pool_quiesce( void )
+{
+	MXSRV_WORKER_POOL *pool;
+
+	pool = mxsrv_worker_pool;
+
+	if ( pool == (MXSRV_WORKER_POOL *) NULL )
+		return;
+
+	pool->hardware_blocked = TRUE;
+
+	while ( pool->num_active_hardware_requests > 0 ) {
+		(void) mx_condition_variable_wait( pool->hardware_cv,
+							pool->core_mutex );
+	}
+}
+
+void
+mxsrv_worker_pool_resume( void )
+{
+	MXSRV_WORKER_POOL *pool;
+
+	pool = mxsrv_worker_pool;
+
+	if ( pool == (MXSRV_WORKER_POOL *) NULL )
+		return;
+
+	pool->hardware_blocked = FALSE;
+
+	(void) mx_condition_variable_broadcast( pool->hardware_cv );
+}
+
+/* mxsrv_worker_pool_quiesce_record() and mxsrv_worker_pool_resume_record()
+ * do the same for just the domain of the record passed.  For a record
+ * that is not part of any domain, all of the domains are blocked.
+ */
+
+void
+mxsrv_worker_pool_quiesce_record( MX_RECORD *record )
+{
+	MXSRV_WORKER_POOL *pool;
+	MXSRV_WORKER_DOMAIN *domain;
+
+	pool = mxsrv_worker_pool;
+
+	if ( pool == (MXSRV_WORKER_POOL *) NULL )
+		return;
+
+	domain = mxsrv_worker_find_domain( pool, record );
+
+	if ( domain == (MXSRV_WORKER_DOMAIN *) NULL ) {
+		mxsrv_worker_pool_quiesce();
+	} else {
+		mxsrv_worker_block_domain( pool, domain );
+	}
+}
+
+void
+mxsrv_worker_pool_resume_record( MX_RECORD *record )
+{
+	MXSRV_WORKER_POOL *pool;
+	MXSRV_WORKER_DOMAIN *domain;
+
+	pool = mxsrv_worker_pool;
+
+	if ( pool == (MXSRV_WORKER_POOL *) NULL )
+		return;
+
+	domain = mxsrv_worker_find_domain( pool, record );
+
+	if ( domain == (MXSRV_WORKER_DOMAIN *) NULL ) {
+		mxsrv_worker_pool_resume();
+	} else {
+		mxsrv_worker_unblock_domain( pool, domain );
+	}
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* mxsrv_process_record_field_for_client() is used by the get_array and
+ * put_array handlers in place of mx_process_record_field_without_callbacks().
+ * When called by a worker, it releases the core mutex while the driver
+ * talks to the hardware.
+ */
+
+mx_status_type
+mxsrv_process_record_field_for_client( MX_RECORD *record,
+					MX_RECORD_FIELD *record_field,
+					MX_SOCKET_HANDLER *socket_handler,
+					int operation )
+{
+	MXSRV_WORKER_POOL *pool;
+
+	pool = mxsrv_worker_pool;
+
+	if ( ( pool == (MXSRV_WORKER_POOL *) NULL )
+	  || ( socket_handler == (MX_SOCKET_HANDLER *) NULL )
+	  || ( socket_handler->worker_job_pending == FALSE ) )
+	{
+		/* We are running in the network thread. */
+
+		return mx_process_record_field_without_callbacks(
+				record, record_field,
+				socket_handler, operation );
+	}
+
+	return mxsrv_worker_process_unlocked( pool, record, record_field,
+						socket_handler, operation );
+}
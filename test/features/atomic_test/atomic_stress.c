@@ -0,0 +1,499 @@
+/*
+ * Name:    atomic_stress.c
+ *
+ * Purpose: Stress test for the MX atomic operations.
+ *
+ *          Several threads hammer on the same variables with the 32-bit,
+ *          64-bit and pointer atomic operations at the same time, using
+ *          a mix of memory orders.  At the end, the totals are checked
+ *          against the values that the threads should have produced.
+ *
+ *          Usage: atomic_stress [ num_threads [ num_iterations ] ]
+ *
+ *          The defaults are 8 threads and 200000 iterations per thread.
+ *
+ *--------------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mx_osdef.h"
+#include "mx_util.h"
+#include "mx_stdint.h"
+#include "mx_hrt.h"
+#include "mx_atomic.h"
+#include "mx_thread.h"
+
+/* Each 64-bit increment carries into the upper 32 bits. */
+
+#define INCREMENT64	( ( ( (int64_t) 1 ) << 32 ) + 1 )
+
+typedef struct stack_node_type {
+	struct stack_node_type *next;
+	int32_t times_popped;
+} STACK_NODE;
+
+typedef struct {
+	long thread_number;
+	int64_t exchanged_sum;
+	long num_popped;
+	long num_errors;
+} THREAD_INFO;
+
+static long num_threads;
+static long num_iterations;
+static long num_publish_rounds;
+
+static int32_t counter32;
+static int32_t cas_counter32;
+static int64_t counter64;
+static int64_t cas_counter64;
+static int64_t exchange_slot64;
+
+static void *exchange_slot_pointer;
+static int32_t *pointer_tokens;
+
+static STACK_NODE *stack_nodes;
+static void *stack_top;
+
+static int32_t start_flag;
+static int32_t ready_flag;
+static int64_t published_value;
+
+/*-------------------------------------------------------------------------*/
+
+static void
+wait_for_flag( int32_t *flag, int32_t wanted_value )
+{
+	long spins;
+
+	spins = 0;
+
+	while ( mx_atomic_load32( flag, MX_ATOMIC_ACQUIRE ) != wanted_value ) {
+
+		/* Let the other threads run if we are sharing a CPU. */
+
+		if ( ++spins >= 1000 ) {
+			mx_usleep(1);
+			spins = 0;
+		}
+	}
+}
+
+/*-------------------------------------------------------------------------*/
+
+static mx_status_type
+counter_thread( MX_THREAD *thread, void *args )
+{
+	THREAD_INFO *info;
+	int32_t expected32;
+	int64_t expected64, token;
+	void *expected_pointer, *old_pointer;
+	long i;
+
+	info = (THREAD_INFO *) args;
+
+	wait_for_flag( &start_flag, 1 );
+
+	info->exchanged_sum = 0;
+
+	for ( i = 0; i < num_iterations; i++ ) {
+
+		/* Plain counters with different memory orders. */
+
+		switch( i % 3 ) {
+		case 0:
+			(void) mx_atomic_fetch_add32( &counter32, 1,
+						MX_ATOMIC_RELAXED );
+			break;
+		case 1:
+			(void) mx_atomic_increment32( &counter32 );
+			break;
+		default:
+			(void) mx_atomic_fetch_add32( &counter32, 1,
+						MX_ATOMIC_ACQ_REL );
+			break;
+		}
+
+		if ( i % 2 ) {
+			(void) mx_atomic_fetch_add64( &counter64, INCREMENT64,
+						MX_ATOMIC_RELAXED );
+		} else {
+			(void) mx_atomic_add64( &counter64, INCREMENT64 );
+		}
+
+		/* Counters that are only updated by compare and swap. */
+
+		expected32 = mx_atomic_load32( &cas_counter32,
+						MX_ATOMIC_RELAXED );
+
+		while ( mx_atomic_compare_and_swap32( &cas_counter32,
+				&expected32, expected32 + 1,
+				MX_ATOMIC_ACQ_REL ) == FALSE )
+		{
+			continue;
+		}
+
+		expected64 = mx_atomic_load64( &cas_counter64,
+						MX_ATOMIC_ACQUIRE );
+
+		while ( mx_atomic_compare_and_swap64( &cas_counter64,
+				&expected64, expected64 + INCREMENT64,
+				MX_ATOMIC_SEQ_CST ) == FALSE )
+		{
+			continue;
+		}
+
+		/* Every token that is put into the exchange slot must
+		 * come back out exactly once.
+		 */
+
+		token = (int64_t) info->thread_number * num_iterations + i + 1;
+
+		info->exchanged_sum += mx_atomic_exchange64( &exchange_slot64,
+						token, MX_ATOMIC_ACQ_REL );
+
+		/* Some of the time, do the exchange with
+		 * a compare and swap loop instead.
+		 */
+
+		if ( ( i % 5 ) == 0 ) {
+			expected_pointer = mx_atomic_load_pointer(
+				&exchange_slot_pointer, MX_ATOMIC_RELAXED );
+
+			while ( mx_atomic_compare_and_swap_pointer(
+					&exchange_slot_pointer,
+					&expected_pointer,
+					&(pointer_tokens[ token - 1 ]),
+					MX_ATOMIC_ACQ_REL ) == FALSE )
+			{
+				continue;
+			}
+
+			old_pointer = expected_pointer;
+		} else {
+			old_pointer = mx_atomic_exchange_pointer(
+					&exchange_slot_pointer,
+					&(pointer_tokens[ token - 1 ]),
+					MX_ATOMIC_ACQ_REL );
+		}
+
+		if ( old_pointer != NULL ) {
+			(void) mx_atomic_fetch_add32( (int32_t *) old_pointer,
+						1, MX_ATOMIC_RELAXED );
+		}
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* The nodes are all pushed onto the stack in one phase and all popped
+ * off in another phase, so that a node never returns to the stack while
+ * some other thread may still be looking at it.
+ */
+
+static mx_status_type
+push_thread( MX_THREAD *thread, void *args )
+{
+	THREAD_INFO *info;
+	STACK_NODE *node;
+	void *expected;
+	long i;
+
+	info = (THREAD_INFO *) args;
+
+	wait_for_flag( &start_flag, 1 );
+
+	for ( i = 0; i < num_iterations; i++ ) {
+		node = &(stack_nodes[ info->thread_number * num_iterations + i ]);
+
+		expected = mx_atomic_load_pointer( &stack_top,
+						MX_ATOMIC_RELAXED );
+
+		do {
+			node->next = (STACK_NODE *) expected;
+
+		} while ( mx_atomic_compare_and_swap_pointer( &stack_top,
+				&expected, node, MX_ATOMIC_RELEASE ) == FALSE );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+static mx_status_type
+pop_thread( MX_THREAD *thread, void *args )
+{
+	THREAD_INFO *info;
+	STACK_NODE *node;
+	void *expected;
+
+	info = (THREAD_INFO *) args;
+
+	wait_for_flag( &start_flag, 1 );
+
+	info->num_popped = 0;
+
+	expected = mx_atomic_load_pointer( &stack_top, MX_ATOMIC_ACQUIRE );
+
+	while ( expected != NULL ) {
+		node = (STACK_NODE *) expected;
+
+		if ( mx_atomic_compare_and_swap_pointer( &stack_top,
+				&expected, node->next, MX_ATOMIC_ACQUIRE ) )
+		{
+			(void) mx_atomic_increment32( &(node->times_popped) );
+
+			info->num_popped++;
+
+			expected = mx_atomic_load_pointer( &stack_top,
+						MX_ATOMIC_ACQUIRE );
+		}
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* A value written before a release store must be visible after
+ * an acquire load that sees the store.  Thread 0 publishes values
+ * and thread 1 consumes them.
+ */
+
+static mx_status_type
+publish_thread( MX_THREAD *thread, void *args )
+{
+	THREAD_INFO *info;
+	long i;
+
+	info = (THREAD_INFO *) args;
+
+	wait_for_flag( &start_flag, 1 );
+
+	info->num_errors = 0;
+
+	for ( i = 1; i <= num_publish_rounds; i++ ) {
+		if ( info->thread_number == 0 ) {
+			wait_for_flag( &ready_flag, 0 );
+
+			published_value = i;
+
+			mx_atomic_store32( &ready_flag, 1, MX_ATOMIC_RELEASE );
+		} else {
+			wait_for_flag( &ready_flag, 1 );
+
+			if ( published_value != i ) {
+				info->num_errors++;
+			}
+
+			mx_atomic_store32( &ready_flag, 0, MX_ATOMIC_RELEASE );
+		}
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+static void
+run_phase( const char *label, MX_THREAD_FUNCTION *function,
+		long phase_threads, THREAD_INFO *info )
+{
+	MX_THREAD **threads;
+	long i, exit_status;
+	double start;
+	mx_status_type mx_status;
+
+	threads = (MX_THREAD **) calloc( phase_threads, sizeof(MX_THREAD *) );
+
+	if ( threads == (MX_THREAD **) NULL ) {
+		fprintf( stderr, "Out of memory.\n" );
+		exit(1);
+	}
+
+	mx_atomic_store32( &start_flag, 0, MX_ATOMIC_RELEASE );
+
+	start = mx_high_resolution_time_as_double();
+
+	for ( i = 0; i < phase_threads; i++ ) {
+		mx_status = mx_thread_create( &(threads[i]), label,
+						function, &(info[i]) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+	}
+
+	/* Start all of the threads at the same time. */
+
+	mx_atomic_store32( &start_flag, 1, MX_ATOMIC_RELEASE );
+
+	for ( i = 0; i < phase_threads; i++ ) {
+		mx_status = mx_thread_wait( threads[i], &exit_status,
+						MX_THREAD_INFINITE_WAIT );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+
+		(void) mx_thread_free_data_structures( threads[i] );
+	}
+
+	printf( "%-10s %ld threads  %.3f sec\n", label, phase_threads,
+			mx_high_resolution_time_as_double() - start );
+
+	free( threads );
+}
+
+static void
+check( const char *label, int64_t actual, int64_t expected )
+{
+	if ( actual != expected ) {
+		fprintf( stderr, "FAILED: %s is %lld, but should be %lld.\n",
+			label, (long long) actual, (long long) expected );
+		exit(1);
+	}
+}
+
+int
+main( int argc, char *argv[] )
+{
+	THREAD_INFO *info;
+	int64_t num_operations, token_sum, num_tokens_seen;
+	long i, num_popped;
+	mx_status_type mx_status;
+
+	num_threads = 8;
+	num_iterations = 200000L;
+
+	if ( argc > 1 ) {
+		num_threads = atol( argv[1] );
+	}
+	if ( argc > 2 ) {
+		num_iterations = atol( argv[2] );
+	}
+
+	if ( ( num_threads < 2 ) || ( num_iterations <= 0 ) ) {
+		fprintf( stderr, "Usage: atomic_stress [ num_threads "
+			"[ num_iterations ] ] with at least 2 threads.\n" );
+		exit(1);
+	}
+
+	num_operations = (int64_t) num_threads * num_iterations;
+
+	/* Each publish round needs two handoffs between threads. */
+
+	num_publish_rounds = num_iterations / 10 + 1;
+
+	/* On platforms without native atomic operations, this creates
+	 * the mutex that is used to emulate them.
+	 */
+
+	mx_status = mx_initialize_runtime();
+
+	if ( mx_status.code != MXE_SUCCESS )
+		exit( mx_status.code );
+
+	info = (THREAD_INFO *) calloc( num_threads, sizeof(THREAD_INFO) );
+
+	pointer_tokens = (int32_t *) calloc( num_operations, sizeof(int32_t) );
+
+	stack_nodes = (STACK_NODE *)
+			calloc( num_operations, sizeof(STACK_NODE) );
+
+	if ( ( info == (THREAD_INFO *) NULL )
+	  || ( pointer_tokens == (int32_t *) NULL )
+	  || ( stack_nodes == (STACK_NODE *) NULL ) )
+	{
+		fprintf( stderr, "Out of memory.\n" );
+		exit(1);
+	}
+
+	for ( i = 0; i < num_threads; i++ ) {
+		info[i].thread_number = i;
+	}
+
+	/* Counters, compare and swap and exchange. */
+
+	run_phase( "counters", counter_thread, num_threads, info );
+
+	check( "counter32", mx_atomic_read32( &counter32 ), num_operations );
+
+	check( "cas_counter32", mx_atomic_load32( &cas_counter32,
+				MX_ATOMIC_SEQ_CST ), num_operations );
+
+	check( "counter64", mx_atomic_read64( &counter64 ),
+				num_operations * INCREMENT64 );
+
+	check( "cas_counter64", mx_atomic_load64( &cas_counter64,
+				MX_ATOMIC_SEQ_CST ), num_operations * INCREMENT64 );
+
+	token_sum = mx_atomic_exchange64( &exchange_slot64, 0,
+						MX_ATOMIC_SEQ_CST );
+
+	for ( i = 0; i < num_threads; i++ ) {
+		token_sum += info[i].exchanged_sum;
+	}
+
+	check( "exchanged token sum", token_sum,
+			num_operations * ( num_operations + 1 ) / 2 );
+
+	(void) mx_atomic_fetch_add32( (int32_t *)
+		mx_atomic_exchange_pointer( &exchange_slot_pointer, NULL,
+					MX_ATOMIC_ACQUIRE ), 1, MX_ATOMIC_RELAXED );
+
+	num_tokens_seen = 0;
+
+	for ( i = 0; i < num_operations; i++ ) {
+		if ( pointer_tokens[i] != 1 ) {
+			fprintf( stderr, "FAILED: pointer token %ld was "
+				"seen %ld times.\n", i, (long) pointer_tokens[i] );
+			exit(1);
+		}
+
+		num_tokens_seen++;
+	}
+
+	check( "pointer tokens seen", num_tokens_seen, num_operations );
+
+	/* A lock-free stack built on pointer compare and swap. */
+
+	run_phase( "push", push_thread, num_threads, info );
+
+	run_phase( "pop", pop_thread, num_threads, info );
+
+	num_popped = 0;
+
+	for ( i = 0; i < num_threads; i++ ) {
+		num_popped += info[i].num_popped;
+	}
+
+	check( "nodes popped", num_popped, num_operations );
+
+	for ( i = 0; i < num_operations; i++ ) {
+		check( "times a node was popped",
+				stack_nodes[i].times_popped, 1 );
+	}
+
+	/* Release and acquire. */
+
+	run_phase( "publish", publish_thread, 2, info );
+
+	check( "values published out of order", info[1].num_errors, 0 );
+
+	free( stack_nodes );
+	free( pointer_tokens );
+	free( info );
+
+	printf( "All atomic tests passed.\n" );
+
+	exit(0);
+}
+
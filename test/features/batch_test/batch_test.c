@@ -0,0 +1,373 @@
+/*
+ * Name:    batch_test.c
+ *
+ * Purpose: Round trip test of mx_get_array_batch() and mx_put_array_batch()
+ *          against a running MX server.
+ *
+ *          The server must be running the database in 'batch_test.dat',
+ *          for example with "mxserver -f batch_test.dat -p 9727".
+ *          The program first writes new values with one batch and reads
+ *          them back one field at a time, then writes values one field
+ *          at a time and reads them back with one batch.  Each batch also
+ *          contains a request for a record that does not exist, which
+ *          must fail without affecting the other fields.  The errors
+ *          printed for 'bt_missing' are expected.
+ *
+ *          Usage: batch_test [ -f ] hostname port
+ *
+ *          -f  Send batch messages even if the server did not say that
+ *              it supports them.  With a server that does not support
+ *              them, this checks that the rejected batches are retried
+ *              one field at a time.
+ *
+ *--------------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_unistd.h"
+#include "mx_net.h"
+
+MX_API char *optarg;
+MX_API int optind;
+
+#define NUM_DOUBLES	6
+#define NUM_LONGS	3
+#define STRING_LENGTH	21
+
+/* The fields are laid out in the request array as the doubles, the longs,
+ * the string and then the record that does not exist.
+ */
+
+#define NUM_FIELDS	( NUM_DOUBLES + NUM_LONGS + 2 )
+
+#define STRING_INDEX	( NUM_DOUBLES + NUM_LONGS )
+#define MISSING_INDEX	( NUM_DOUBLES + NUM_LONGS + 1 )
+
+typedef struct {
+	double double_value[NUM_DOUBLES];
+	long long_value[NUM_LONGS];
+	char string_value[STRING_LENGTH];
+	double missing_value;
+} BATCH_TEST_VALUES;
+
+static MX_NETWORK_FIELD nf[NUM_FIELDS];
+
+static void
+fill_values( BATCH_TEST_VALUES *values, long pass )
+{
+	long i;
+
+	memset( values, 0, sizeof(BATCH_TEST_VALUES) );
+
+	for ( i = 0; i < NUM_DOUBLES; i++ ) {
+		values->double_value[i] = 1000.0 * pass + 0.25 * i;
+	}
+	for ( i = 0; i < NUM_LONGS; i++ ) {
+		values->long_value[i] = -1000 * pass - i;
+	}
+
+	snprintf( values->string_value, STRING_LENGTH, "pass_%ld", pass );
+}
+
+static long
+compare_values( BATCH_TEST_VALUES *expected, BATCH_TEST_VALUES *actual,
+		const char *label )
+{
+	long i, failures;
+
+	failures = 0;
+
+	for ( i = 0; i < NUM_DOUBLES; i++ ) {
+		if ( expected->double_value[i] != actual->double_value[i] ) {
+			printf( "%s: bt_d%ld is %g instead of %g.\n", label, i,
+				actual->double_value[i],
+				expected->double_value[i] );
+			failures++;
+		}
+	}
+	for ( i = 0; i < NUM_LONGS; i++ ) {
+		if ( expected->long_value[i] != actual->long_value[i] ) {
+			printf( "%s: bt_l%ld is %ld instead of %ld.\n", label, i,
+				actual->long_value[i],
+				expected->long_value[i] );
+			failures++;
+		}
+	}
+	if ( strcmp( expected->string_value, actual->string_value ) != 0 ) {
+		printf( "%s: bt_s is '%s' instead of '%s'.\n", label,
+			actual->string_value, expected->string_value );
+		failures++;
+	}
+
+	return failures;
+}
+
+/* setup_requests() prepares one request per field.  The request for the
+ * record that does not exist fails here already, since its handle cannot
+ * be found, and is left marked as complete.
+ */
+
+static void
+setup_requests( MX_NETWORK_ASYNC_REQUEST *request_array,
+		BATCH_TEST_VALUES *values )
+{
+	long i, string_dimension[1];
+
+	string_dimension[0] = STRING_LENGTH;
+
+	for ( i = 0; i < NUM_DOUBLES; i++ ) {
+		(void) mx_network_setup_request( &request_array[i], &nf[i],
+				MXFT_DOUBLE, 0, NULL,
+				&(values->double_value[i]) );
+	}
+	for ( i = 0; i < NUM_LONGS; i++ ) {
+		(void) mx_network_setup_request(
+				&request_array[ NUM_DOUBLES + i ],
+				&nf[ NUM_DOUBLES + i ],
+				MXFT_LONG, 0, NULL,
+				&(values->long_value[i]) );
+	}
+
+	(void) mx_network_setup_request( &request_array[STRING_INDEX],
+				&nf[STRING_INDEX],
+				MXFT_STRING, 1, string_dimension,
+				values->string_value );
+
+	(void) mx_network_setup_request( &request_array[MISSING_INDEX],
+				&nf[MISSING_INDEX],
+				MXFT_DOUBLE, 0, NULL,
+				&(values->missing_value) );
+}
+
+static long
+check_request_status( MX_NETWORK_ASYNC_REQUEST *request_array,
+		mx_status_type batch_status, const char *label )
+{
+	long i, failures;
+
+	failures = 0;
+
+	for ( i = 0; i < NUM_FIELDS; i++ ) {
+		if ( i == MISSING_INDEX ) {
+			if ( request_array[i].status.code == MXE_SUCCESS ) {
+				printf( "%s: the request for a missing record "
+					"did not fail.\n", label );
+				failures++;
+			}
+		} else
+		if ( request_array[i].status.code != MXE_SUCCESS ) {
+			printf( "%s: request %ld failed with status %ld.\n",
+				label, i, request_array[i].status.code );
+			failures++;
+		}
+	}
+
+	if ( batch_status.code == MXE_SUCCESS ) {
+		printf( "%s: the batch did not report the failed request.\n",
+			label );
+		failures++;
+	}
+
+	return failures;
+}
+
+static long
+get_one_at_a_time( BATCH_TEST_VALUES *values, const char *label )
+{
+	long i, failures, string_dimension[1];
+	mx_status_type mx_status;
+
+	failures = 0;
+
+	for ( i = 0; i < NUM_DOUBLES; i++ ) {
+		mx_status = mx_get( &nf[i], MXFT_DOUBLE,
+					&(values->double_value[i]) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			failures++;
+	}
+	for ( i = 0; i < NUM_LONGS; i++ ) {
+		mx_status = mx_get( &nf[ NUM_DOUBLES + i ], MXFT_LONG,
+					&(values->long_value[i]) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			failures++;
+	}
+
+	string_dimension[0] = STRING_LENGTH;
+
+	mx_status = mx_get_array( &nf[STRING_INDEX], MXFT_STRING,
+				1, string_dimension, values->string_value );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		failures++;
+
+	if ( failures > 0 ) {
+		printf( "%s: %ld single field gets failed.\n", label, failures );
+	}
+
+	return failures;
+}
+
+static long
+put_one_at_a_time( BATCH_TEST_VALUES *values, const char *label )
+{
+	long i, failures, string_dimension[1];
+	mx_status_type mx_status;
+
+	failures = 0;
+
+	for ( i = 0; i < NUM_DOUBLES; i++ ) {
+		mx_status = mx_put( &nf[i], MXFT_DOUBLE,
+					&(values->double_value[i]) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			failures++;
+	}
+	for ( i = 0; i < NUM_LONGS; i++ ) {
+		mx_status = mx_put( &nf[ NUM_DOUBLES + i ], MXFT_LONG,
+					&(values->long_value[i]) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			failures++;
+	}
+
+	string_dimension[0] = STRING_LENGTH;
+
+	mx_status = mx_put_array( &nf[STRING_INDEX], MXFT_STRING,
+				1, string_dimension, values->string_value );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		failures++;
+
+	if ( failures > 0 ) {
+		printf( "%s: %ld single field puts failed.\n", label, failures );
+	}
+
+	return failures;
+}
+
+int
+main( int argc, char *argv[] )
+{
+	MX_RECORD *server_record;
+	MX_NETWORK_SERVER *server;
+	MX_NETWORK_ASYNC_REQUEST request_array[NUM_FIELDS];
+	BATCH_TEST_VALUES expected, actual;
+	mx_bool_type force_batches;
+	mx_status_type mx_status, batch_status;
+	long i, pass, failures;
+	int c;
+
+	force_batches = FALSE;
+
+	while ( (c = getopt(argc, argv, "f")) != -1 ) {
+		switch (c) {
+		case 'f':
+			force_batches = TRUE;
+			break;
+		}
+	}
+
+	if ( argc - optind < 2 ) {
+		fprintf( stderr, "Usage: batch_test [ -f ] hostname port\n" );
+		exit(1);
+	}
+
+	mx_set_debug_level(0);
+
+	server_record = NULL;
+
+	mx_status = mx_connect_to_mx_server( &server_record,
+				argv[optind], atoi( argv[optind+1] ), 5.0, 0 );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		exit( mx_status.code );
+
+	server = (MX_NETWORK_SERVER *) server_record->record_class_struct;
+
+	printf( "Server '%s' %s batch messages.\n", argv[optind],
+		server->server_supports_batch_messages
+			? "supports" : "does not support" );
+
+	if ( force_batches ) {
+		server->server_supports_batch_messages = TRUE;
+	}
+
+	for ( i = 0; i < NUM_DOUBLES; i++ ) {
+		mx_network_field_init( &nf[i], server_record,
+						"bt_d%ld.value", i );
+	}
+	for ( i = 0; i < NUM_LONGS; i++ ) {
+		mx_network_field_init( &nf[ NUM_DOUBLES + i ], server_record,
+						"bt_l%ld.value", i );
+	}
+
+	mx_network_field_init( &nf[STRING_INDEX], server_record,
+						"bt_s.value" );
+	mx_network_field_init( &nf[MISSING_INDEX], server_record,
+						"bt_missing.value" );
+
+	failures = 0;
+
+	for ( pass = 1; pass <= 2; pass++ ) {
+
+		/* Put with a batch and get one field at a time. */
+
+		fill_values( &expected, pass );
+
+		setup_requests( request_array, &expected );
+
+		batch_status = mx_put_array_batch( NUM_FIELDS, request_array );
+
+		failures += check_request_status( request_array,
+						batch_status, "batch put" );
+
+		memset( &actual, 0, sizeof(actual) );
+
+		failures += get_one_at_a_time( &actual, "batch put" );
+
+		failures += compare_values( &expected, &actual, "batch put" );
+
+		/* Put one field at a time and get with a batch. */
+
+		fill_values( &expected, 10 + pass );
+
+		failures += put_one_at_a_time( &expected, "batch get" );
+
+		memset( &actual, 0, sizeof(actual) );
+
+		setup_requests( request_array, &actual );
+
+		batch_status = mx_get_array_batch( NUM_FIELDS, request_array );
+
+		failures += check_request_status( request_array,
+						batch_status, "batch get" );
+
+		failures += compare_values( &expected, &actual, "batch get" );
+	}
+
+	if ( force_batches && server->server_supports_batch_messages ) {
+		printf( "The server accepted batch messages.\n" );
+	}
+
+	if ( failures > 0 ) {
+		printf( "%ld checks FAILED.\n", failures );
+		exit(1);
+	}
+
+	printf( "All checks passed.\n" );
+
+	exit(0);
+}
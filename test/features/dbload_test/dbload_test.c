@@ -0,0 +1,239 @@
+/*
+ * Name:    dbload_test.c
+ *
+ * Purpose: Startup benchmark for the MX database loader.
+ *
+ *          This program writes a synthetic database file containing a
+ *          mix of soft device and variable records and then reports
+ *          how long it takes to initialize the drivers and to load and
+ *          initialize the database.  It also times repeated driver
+ *          lookups by name and by type.  The load and the lookups are
+ *          done twice in the same run, first walking the driver list
+ *          as MX used to and then using the driver indexes.
+ *
+ *          Usage: dbload_test [ num_records [ database_filename ] ]
+ *
+ *          The default is 10000 records written to 'dbload_test.dat'.
+ *
+ *--------------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_hrt.h"
+
+#define NUM_LOOKUPS	1000000L
+
+static char *driver_names[] = {
+	"soft_motor", "soft_scaler", "soft_timer", "soft_aoutput",
+	"soft_doutput", "double", "long", "string" };
+
+static int num_driver_names = sizeof(driver_names) / sizeof(driver_names[0]);
+
+static int
+write_database_file( const char *filename, long num_records )
+{
+	FILE *file;
+	long i;
+
+	file = fopen( filename, "w" );
+
+	if ( file == NULL ) {
+		fprintf( stderr, "Cannot create database file '%s'.\n",
+			filename );
+		return FALSE;
+	}
+
+	for ( i = 0; i < num_records; i++ ) {
+		switch( i % 8 ) {
+		case 0:
+			fprintf( file, "motor%ld device motor soft_motor "
+			"\"\" \"\" 0 0 -1000 1000 0 -1 -1 1 0 um 1000 0 500\n",
+				i );
+			break;
+		case 1:
+			fprintf( file, "scaler%ld device scaler soft_scaler "
+			"\"\" \"\" 0 0 0 \"\" motor%ld 1 ./none.dat 0\n",
+				i, i - 1 );
+			break;
+		case 2:
+			fprintf( file,
+			"timer%ld device timer soft_timer \"\" \"\"\n", i );
+			break;
+		case 3:
+			fprintf( file, "dac%ld device analog_output "
+			"soft_aoutput \"\" \"\" 0 1 0 V 0x0\n", i );
+			break;
+		case 4:
+			fprintf( file, "dout%ld device digital_output "
+			"soft_doutput \"\" \"\" 0\n", i );
+			break;
+		case 5:
+			fprintf( file, "dvar%ld variable inline double "
+			"\"\" \"\" 1 1 %ld.5\n", i, i );
+			break;
+		case 6:
+			fprintf( file, "lvar%ld variable inline long "
+			"\"\" \"\" 1 1 %ld\n", i, i );
+			break;
+		case 7:
+			fprintf( file, "svar%ld variable inline string "
+			"\"\" \"\" 1 21 name_of_%ld\n", i, i );
+			break;
+		}
+	}
+
+	fclose( file );
+
+	return TRUE;
+}
+
+#define NUM_TIMES	5
+
+/* time_database() loads the database into a new record list and times
+ * the driver lookups.  The record list is left in place when it returns.
+ * The times are returned in 'times' in the order that they are printed
+ * by main().
+ */
+
+static void
+time_database( const char *filename, mx_bool_type use_driver_index,
+						double *times )
+{
+	MX_RECORD *record_list;
+	MX_DRIVER *driver;
+	long i, mx_type_sum;
+	double start, database_done, load_done, init_done;
+	double by_name_done, by_type_done;
+	mx_status_type mx_status;
+
+	mx_set_driver_index( use_driver_index );
+
+	start = mx_high_resolution_time_as_double();
+
+	record_list = mx_initialize_database();
+
+	if ( record_list == (MX_RECORD *) NULL )
+		exit(1);
+
+	database_done = mx_high_resolution_time_as_double();
+
+	mx_status = mx_read_database_file( record_list, filename, 0 );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		exit( mx_status.code );
+
+	load_done = mx_high_resolution_time_as_double();
+
+	mx_status = mx_finish_database_initialization( record_list );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		exit( mx_status.code );
+
+	init_done = mx_high_resolution_time_as_double();
+
+	/* Time driver lookups by name and by type. */
+
+	mx_type_sum = 0;
+
+	for ( i = 0; i < NUM_LOOKUPS; i++ ) {
+		driver = mx_get_driver_by_name(
+			driver_names[ i % num_driver_names ] );
+
+		if ( driver == (MX_DRIVER *) NULL ) {
+			fprintf( stderr, "Driver '%s' was not found.\n",
+				driver_names[ i % num_driver_names ] );
+			exit(1);
+		}
+
+		mx_type_sum += driver->mx_type;
+	}
+
+	by_name_done = mx_high_resolution_time_as_double();
+
+	for ( i = 0; i < NUM_LOOKUPS; i++ ) {
+		driver = mx_get_driver_by_type(
+				record_list->next_record->mx_type );
+
+		if ( driver == (MX_DRIVER *) NULL ) {
+			fprintf( stderr, "Driver type %ld was not found.\n",
+				record_list->next_record->mx_type );
+			exit(1);
+		}
+	}
+
+	by_type_done = mx_high_resolution_time_as_double();
+
+	MXW_UNUSED( mx_type_sum );
+
+	times[0] = database_done - start;
+	times[1] = load_done - database_done;
+	times[2] = init_done - load_done;
+	times[3] = by_name_done - init_done;
+	times[4] = by_type_done - by_name_done;
+}
+
+int
+main( int argc, char *argv[] )
+{
+	const char *filename;
+	long num_records;
+	double start, drivers_done;
+	double list_times[NUM_TIMES], index_times[NUM_TIMES];
+	mx_status_type mx_status;
+
+	num_records = 10000L;
+	filename = "dbload_test.dat";
+
+	if ( argc > 1 ) {
+		num_records = atol( argv[1] );
+	}
+	if ( argc > 2 ) {
+		filename = argv[2];
+	}
+
+	if ( write_database_file( filename, num_records ) == FALSE )
+		exit(1);
+
+	start = mx_high_resolution_time_as_double();
+
+	mx_status = mx_initialize_drivers();
+
+	if ( mx_status.code != MXE_SUCCESS )
+		exit( mx_status.code );
+
+	drivers_done = mx_high_resolution_time_as_double();
+
+	time_database( filename, FALSE, list_times );
+
+	time_database( filename, TRUE, index_times );
+
+	mx_set_driver_index( TRUE );
+
+	printf( "Database of %ld records in '%s':\n", num_records, filename );
+	printf( "  mx_initialize_drivers()             = %.6f sec\n\n",
+		drivers_done - start );
+	printf( "  %-36s %12s %12s\n", "", "list walk", "index" );
+	printf( "  %-36s %8.6f sec %8.6f sec\n",
+		"mx_initialize_database()", list_times[0], index_times[0] );
+	printf( "  %-36s %8.6f sec %8.6f sec\n",
+		"mx_read_database_file()", list_times[1], index_times[1] );
+	printf( "  %-36s %8.6f sec %8.6f sec\n",
+		"mx_finish_database_initialization()",
+		list_times[2], index_times[2] );
+	printf( "  %ld %-28s %8.6f sec %8.6f sec\n", NUM_LOOKUPS,
+		"mx_get_driver_by_name()", list_times[3], index_times[3] );
+	printf( "  %ld %-28s %8.6f sec %8.6f sec\n", NUM_LOOKUPS,
+		"mx_get_driver_by_type()", list_times[4], index_times[4] );
+
+	exit(0);
+}
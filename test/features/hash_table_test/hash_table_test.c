@@ -0,0 +1,325 @@
+/*
+ * Name:    hash_table_test.c
+ *
+ * Purpose: Correctness check and benchmark for MX hash tables.
+ *
+ *          This program builds sets of key names that look like the
+ *          names found in real MX databases (motor names, record.field
+ *          names and beamline style names) and times inserting, finding,
+ *          failing to find and deleting them.  Each set is run twice,
+ *          once with the default hash function and once with the
+ *          character sum hash that MX hash tables used to use, and the
+ *          number of distinct slots used by each hash is reported.
+ *
+ *          Usage: hash_table_test [ num_keys ]
+ *
+ *          The default is 10000 keys per set.
+ *
+ *--------------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_hash_table.h"
+#include "mx_hrt.h"
+
+#define KEY_LENGTH		(MXU_RECORD_FIELD_NAME_LENGTH + 1)
+
+#define INITIAL_TABLE_SIZE	64
+
+#define DISTRIBUTION_SIZE	8192
+
+static const char *beamline_devices[] = {
+	"m1", "m2", "mono", "sl1", "sl2", "ki", "kt", "table", "det", "ion" };
+
+static const char *beamline_axes[] = {
+	"theta", "chi", "x", "y", "z", "top", "bottom", "left", "right",
+	"pitch", "roll", "yaw" };
+
+static const char *scaler_fields[] = {
+	"value", "raw_value", "dark_current", "mode", "overflow" };
+
+#define NUM_ELEMENTS(x)	( (long) ( sizeof(x) / sizeof((x)[0]) ) )
+
+/* This is the hash that mx_hash_table.c used before it was rewritten. */
+
+static long
+sum_hash_function( MX_HASH_TABLE *hash_table, const char *key )
+{
+	unsigned long sum;
+	long i;
+
+	sum = 0;
+
+	for ( i = 0; ( i < hash_table->key_length ) && ( key[i] != '\0' ); i++ )
+	{
+		sum += (unsigned char) key[i];
+	}
+
+	return (long) ( sum % hash_table->table_size );
+}
+
+static unsigned long
+fnv1a_hash( const char *key )
+{
+	const unsigned char *ptr;
+	uint32_t hash;
+
+	hash = 2166136261U;
+
+	for ( ptr = (const unsigned char *) key; *ptr != '\0'; ptr++ ) {
+		hash ^= *ptr;
+		hash *= 16777619U;
+	}
+
+	return (unsigned long) hash;
+}
+
+static void
+make_key( char *key, int key_set, long n )
+{
+	long i;
+
+	switch( key_set ) {
+	case 0:
+		snprintf( key, KEY_LENGTH, "mtr%ld", n );
+		break;
+	case 1:
+		i = n % NUM_ELEMENTS(scaler_fields);
+
+		snprintf( key, KEY_LENGTH, "scaler%ld.%s",
+			n / NUM_ELEMENTS(scaler_fields), scaler_fields[i] );
+		break;
+	case 2:
+		i = n / NUM_ELEMENTS(beamline_axes);
+
+		snprintf( key, KEY_LENGTH, "s%02ldid_%s_%s",
+			i / NUM_ELEMENTS(beamline_devices),
+			beamline_devices[ i % NUM_ELEMENTS(beamline_devices) ],
+			beamline_axes[ n % NUM_ELEMENTS(beamline_axes) ] );
+		break;
+	}
+}
+
+static void
+report_distribution( const char *label, char (*keys)[KEY_LENGTH],
+				long num_keys )
+{
+	MX_HASH_TABLE fake_table;
+	long *sum_counts, *fnv_counts;
+	long i, sum_used, fnv_used, sum_max, fnv_max;
+
+	sum_counts = (long *) calloc( DISTRIBUTION_SIZE, sizeof(long) );
+	fnv_counts = (long *) calloc( DISTRIBUTION_SIZE, sizeof(long) );
+
+	if ( ( sum_counts == NULL ) || ( fnv_counts == NULL ) ) {
+		fprintf( stderr, "Out of memory.\n" );
+		exit(1);
+	}
+
+	fake_table.key_length = KEY_LENGTH;
+	fake_table.table_size = DISTRIBUTION_SIZE;
+
+	for ( i = 0; i < num_keys; i++ ) {
+		sum_counts[ sum_hash_function( &fake_table, keys[i] ) ]++;
+
+		fnv_counts[ fnv1a_hash( keys[i] ) % DISTRIBUTION_SIZE ]++;
+	}
+
+	sum_used = fnv_used = sum_max = fnv_max = 0;
+
+	for ( i = 0; i < DISTRIBUTION_SIZE; i++ ) {
+		if ( sum_counts[i] > 0 )
+			sum_used++;
+		if ( fnv_counts[i] > 0 )
+			fnv_used++;
+		if ( sum_counts[i] > sum_max )
+			sum_max = sum_counts[i];
+		if ( fnv_counts[i] > fnv_max )
+			fnv_max = fnv_counts[i];
+	}
+
+	printf( "%s: %ld keys into %d slots\n",
+		label, num_keys, DISTRIBUTION_SIZE );
+	printf( "  sum hash:  %5ld slots used, at most %ld keys per slot\n",
+		sum_used, sum_max );
+	printf( "  FNV-1a:    %5ld slots used, at most %ld keys per slot\n",
+		fnv_used, fnv_max );
+
+	free( sum_counts );
+	free( fnv_counts );
+}
+
+static void
+run_benchmark( const char *label, char (*keys)[KEY_LENGTH], long num_keys,
+		long (*hash_function)( MX_HASH_TABLE *, const char * ) )
+{
+	MX_HASH_TABLE *hash_table;
+	char missing_key[KEY_LENGTH];
+	void *value;
+	long i;
+	double start, inserted, found, missed, deleted;
+	mx_status_type mx_status;
+
+	mx_status = mx_hash_table_create( &hash_table,
+				KEY_LENGTH, INITIAL_TABLE_SIZE, hash_function );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		exit( mx_status.code );
+
+	start = mx_high_resolution_time_as_double();
+
+	for ( i = 0; i < num_keys; i++ ) {
+		mx_status = mx_hash_table_insert_key( hash_table,
+						keys[i], &(keys[i]) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+	}
+
+	inserted = mx_high_resolution_time_as_double();
+
+	for ( i = 0; i < num_keys; i++ ) {
+		mx_status = mx_hash_table_lookup_key( hash_table,
+						keys[i], &value );
+
+		if ( ( mx_status.code != MXE_SUCCESS )
+		  || ( value != (void *) &(keys[i]) ) )
+		{
+			fprintf( stderr, "Key '%s' was not found correctly.\n",
+				keys[i] );
+			exit(1);
+		}
+	}
+
+	found = mx_high_resolution_time_as_double();
+
+	for ( i = 0; i < num_keys; i++ ) {
+		snprintf( missing_key, sizeof(missing_key),
+				"%s_x", keys[i] );
+
+		mx_status = mx_hash_table_lookup_key( hash_table,
+						missing_key, &value );
+
+		if ( mx_status.code != MXE_NOT_FOUND ) {
+			fprintf( stderr, "Key '%s' was unexpectedly found.\n",
+				missing_key );
+			exit(1);
+		}
+	}
+
+	missed = mx_high_resolution_time_as_double();
+
+	/* Delete every other key, check that the rest can still be found,
+	 * and then delete the rest.
+	 */
+
+	for ( i = 0; i < num_keys; i += 2 ) {
+		mx_status = mx_hash_table_delete_key( hash_table, keys[i] );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+	}
+
+	for ( i = 0; i < num_keys; i++ ) {
+		mx_status = mx_hash_table_lookup_key( hash_table,
+						keys[i], &value );
+
+		if ( ( i % 2 ) == 0 ) {
+			if ( mx_status.code != MXE_NOT_FOUND ) {
+				fprintf( stderr,
+				"Deleted key '%s' was still found.\n",
+					keys[i] );
+				exit(1);
+			}
+		} else {
+			if ( ( mx_status.code != MXE_SUCCESS )
+			  || ( value != (void *) &(keys[i]) ) )
+			{
+				fprintf( stderr,
+				"Key '%s' was lost after deletions.\n",
+					keys[i] );
+				exit(1);
+			}
+		}
+	}
+
+	for ( i = 1; i < num_keys; i += 2 ) {
+		mx_status = mx_hash_table_delete_key( hash_table, keys[i] );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+	}
+
+	deleted = mx_high_resolution_time_as_double();
+
+	if ( hash_table->num_keys != 0 ) {
+		fprintf( stderr, "%ld keys were left in the table.\n",
+			hash_table->num_keys );
+		exit(1);
+	}
+
+	printf( "  %-9s insert %.6f  hit %.6f  miss %.6f  "
+		"delete+check %.6f sec  (table size %ld)\n",
+		label, inserted - start, found - inserted,
+		missed - found, deleted - missed, hash_table->table_size );
+
+	mx_hash_table_destroy( hash_table );
+}
+
+int
+main( int argc, char *argv[] )
+{
+	static const char *set_names[] = {
+		"motor names", "record.field names", "beamline names" };
+
+	char (*keys)[KEY_LENGTH];
+	long i, num_keys;
+	int key_set;
+
+	num_keys = 10000L;
+
+	if ( argc > 1 ) {
+		num_keys = atol( argv[1] );
+	}
+
+	if ( num_keys <= 0 ) {
+		fprintf( stderr, "The number of keys must be positive.\n" );
+		exit(1);
+	}
+
+	keys = malloc( num_keys * sizeof(keys[0]) );
+
+	if ( keys == NULL ) {
+		fprintf( stderr, "Out of memory.\n" );
+		exit(1);
+	}
+
+	for ( key_set = 0; key_set < NUM_ELEMENTS(set_names); key_set++ ) {
+
+		for ( i = 0; i < num_keys; i++ ) {
+			make_key( keys[i], key_set, i );
+		}
+
+		report_distribution( set_names[key_set], keys, num_keys );
+
+		run_benchmark( "FNV-1a", keys, num_keys, NULL );
+
+		run_benchmark( "sum hash", keys, num_keys, sum_hash_function );
+	}
+
+	free( keys );
+
+	exit(0);
+}
+
@@ -0,0 +1,410 @@
+/*
+ * Name:    shm_bench.c
+ *
+ * Purpose: Compares the shared memory transport for MX network messages
+ *          with sending the same messages through a Unix domain socket.
+ *
+ *          A child process plays the part of the MX server.  For each
+ *          message size, the parent sends a short request and the child
+ *          answers with a message of that size, first through the socket
+ *          alone and then with a shared memory segment attached to the
+ *          socket.  In both cases, the parent copies the body into its
+ *          destination array the way mx_get_field_array_finish() would,
+ *          taking it from the shared memory slot when it was left there.
+ *
+ *          Usage: shm_bench [ num_passes ]
+ *
+ *          The default is 50 passes per message size.
+ *
+ *--------------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_stdint.h"
+#include "mx_hrt.h"
+#include "mx_socket.h"
+#include "mx_net.h"
+#include "mx_net_socket.h"
+#include "mx_net_shm.h"
+#include "mx_process.h"
+
+#define REQUEST_QUIT		0
+#define REQUEST_DATA		1
+#define REQUEST_SHM		2
+
+static unsigned long message_sizes[] = {
+	65536, 262144, 1048576, 4194304, 8388608 };
+
+static int num_message_sizes =
+		sizeof(message_sizes) / sizeof(message_sizes[0]);
+
+static void
+set_header( MX_NETWORK_MESSAGE_BUFFER *buffer, uint32_t message_length )
+{
+	uint32_t *header;
+
+	header = buffer->u.uint32_buffer;
+
+	memset( header, 0, MXU_NETWORK_HEADER_LENGTH );
+
+	header[ MX_NETWORK_MAGIC ]  = mx_htonl( MX_NETWORK_MAGIC_VALUE );
+	header[ MX_NETWORK_HEADER_LENGTH ]
+				= mx_htonl( MXU_NETWORK_HEADER_LENGTH );
+	header[ MX_NETWORK_MESSAGE_LENGTH ] = mx_htonl( message_length );
+	header[ MX_NETWORK_MESSAGE_TYPE ]
+			= mx_htonl( mx_server_response(MX_NETMSG_GET_ARRAY_BY_NAME) );
+	header[ MX_NETWORK_STATUS_CODE ] = mx_htonl( MXE_SUCCESS );
+}
+
+static uint32_t *
+message_body( MX_NETWORK_MESSAGE_BUFFER *buffer )
+{
+	return buffer->u.uint32_buffer
+			+ ( MXU_NETWORK_HEADER_LENGTH / sizeof(uint32_t) );
+}
+
+static void
+fill_body( MX_NETWORK_MESSAGE_BUFFER *buffer, unsigned long length )
+{
+	uint32_t *body;
+	unsigned long i;
+
+	body = message_body( buffer );
+
+	for ( i = 0; i < length / sizeof(uint32_t); i++ ) {
+		body[i] = (uint32_t) ( i * 2654435761UL );
+	}
+}
+
+/* run_server() answers requests from the parent until it is told to quit. */
+
+static int
+run_server( MX_SOCKET *mx_socket )
+{
+	MX_SOCKET_HANDLER socket_handler;
+	MX_NETWORK_MESSAGE_BUFFER *request, *response;
+	uint32_t command, length;
+	unsigned long filled_length;
+	mx_status_type mx_status;
+
+	memset( &socket_handler, 0, sizeof(socket_handler) );
+
+	socket_handler.mx_socket = mx_socket;
+
+	mx_status = mx_allocate_network_buffer( &request, NULL, &socket_handler,
+				MXU_NETWORK_MINIMUM_MESSAGE_BUFFER_LENGTH );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return 1;
+
+	mx_status = mx_allocate_network_buffer( &response,
+			NULL, &socket_handler,
+			MXU_NETWORK_HEADER_LENGTH + message_sizes[0] );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return 1;
+
+	filled_length = 0;
+
+	for (;;) {
+		mx_status = mx_network_socket_receive_message( mx_socket,
+							-1.0, request );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return 1;
+
+		command = mx_ntohl( message_body( request )[0] );
+		length  = mx_ntohl( message_body( request )[1] );
+
+		switch( command ) {
+		case REQUEST_QUIT:
+			return 0;
+
+		case REQUEST_SHM:
+			mx_status = mx_network_shm_create( mx_socket,
+					MX_NETWORK_SHM_DEFAULT_NUM_SLOTS,
+					MX_NETWORK_SHM_DEFAULT_SLOT_SIZE,
+					MX_NETWORK_SHM_DEFAULT_THRESHOLD );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return 1;
+
+			set_header( response, 0 );
+
+			mx_status = mx_network_shm_send_descriptor( mx_socket,
+								response );
+			break;
+
+		default:
+			if ( MXU_NETWORK_HEADER_LENGTH + length
+					> response->buffer_length )
+			{
+				mx_status = mx_reallocate_network_buffer(
+				    response, MXU_NETWORK_HEADER_LENGTH + length );
+
+				if ( mx_status.code != MXE_SUCCESS )
+					return 1;
+			}
+
+			if ( length > filled_length ) {
+				fill_body( response, length );
+
+				filled_length = length;
+			}
+
+			set_header( response, length );
+
+			mx_status = mx_network_socket_send_message( mx_socket,
+							-1.0, response );
+			break;
+		}
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return 1;
+	}
+}
+
+/*------------------------------------------------------------------------*/
+
+static mx_status_type
+send_request( MX_SOCKET *mx_socket,
+		MX_NETWORK_MESSAGE_BUFFER *request,
+		uint32_t command, uint32_t length )
+{
+	set_header( request, 2 * sizeof(uint32_t) );
+
+	message_body( request )[0] = mx_htonl( command );
+	message_body( request )[1] = mx_htonl( length );
+
+	return mx_network_socket_send_message( mx_socket, -1.0, request );
+}
+
+/* time_transfers() returns the average time in microseconds that it takes
+ * to request and receive a message body of 'length' bytes and to copy it
+ * into 'destination'.
+ */
+
+static double
+time_transfers( MX_SOCKET *mx_socket,
+		MX_NETWORK_MESSAGE_BUFFER *request,
+		MX_NETWORK_MESSAGE_BUFFER *response,
+		uint32_t *destination,
+		unsigned long length,
+		long num_passes )
+{
+	double start_time, end_time;
+	char *body;
+	uint32_t received_length;
+	unsigned long i;
+	long pass;
+	mx_status_type mx_status;
+
+	start_time = mx_high_resolution_time_as_double();
+
+	for ( pass = 0; pass < num_passes; pass++ ) {
+		mx_status = send_request( mx_socket, request,
+						REQUEST_DATA, length );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( 1 );
+
+		mx_status = mx_network_socket_receive_message( mx_socket,
+							-1.0, response );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( 1 );
+
+		body = (char *) message_body( response );
+
+		received_length = mx_ntohl(
+			response->u.uint32_buffer[ MX_NETWORK_MESSAGE_LENGTH ] );
+
+		if ( mx_ntohl( response->u.uint32_buffer[
+				MX_NETWORK_MESSAGE_TYPE ] )
+			& MX_NETMSG_SHARED_MEMORY_FLAG )
+		{
+			mx_status = mx_network_shm_get_body( response,
+						&body, &received_length );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				exit( 1 );
+		}
+
+		if ( received_length != length ) {
+			fprintf( stderr,
+			"Received %lu bytes when %lu bytes were expected.\n",
+				(unsigned long) received_length, length );
+			exit( 1 );
+		}
+
+		memcpy( destination, body, length );
+	}
+
+	end_time = mx_high_resolution_time_as_double();
+
+	for ( i = 0; i < length / sizeof(uint32_t); i++ ) {
+		if ( destination[i] != (uint32_t) ( i * 2654435761UL ) ) {
+			fprintf( stderr,
+			"The body of a %lu byte message was corrupted at "
+			"word %lu.\n", length, i );
+			exit( 1 );
+		}
+	}
+
+	return 1.0e6 * ( end_time - start_time ) / (double) num_passes;
+}
+
+int
+main( int argc, char *argv[] )
+{
+	MX_SOCKET client_socket, server_socket;
+	MX_NETWORK_SERVER network_server;
+	MX_NETWORK_MESSAGE_BUFFER *request, *response;
+	uint32_t *destination;
+	double socket_time[ sizeof(message_sizes) / sizeof(message_sizes[0]) ];
+	double shm_time;
+	long num_passes;
+	int i, fds[2], child_status;
+	pid_t child_pid;
+	mx_status_type mx_status;
+
+	num_passes = 50;
+
+	if ( argc > 1 ) {
+		num_passes = atol( argv[1] );
+	}
+
+	if ( num_passes < 1 ) {
+		fprintf( stderr, "Usage: shm_bench [ num_passes ]\n" );
+		exit( 1 );
+	}
+
+	mx_status = mx_initialize_runtime();
+
+	if ( mx_status.code != MXE_SUCCESS )
+		exit( 1 );
+
+	if ( socketpair( AF_UNIX, SOCK_STREAM, 0, fds ) != 0 ) {
+		perror( "socketpair" );
+		exit( 1 );
+	}
+
+	memset( &client_socket, 0, sizeof(client_socket) );
+	memset( &server_socket, 0, sizeof(server_socket) );
+
+	client_socket.socket_fd = fds[0];
+	server_socket.socket_fd = fds[1];
+
+	child_pid = fork();
+
+	if ( child_pid < 0 ) {
+		perror( "fork" );
+		exit( 1 );
+	}
+
+	if ( child_pid == 0 ) {
+		close( fds[0] );
+
+		exit( run_server( &server_socket ) );
+	}
+
+	close( fds[1] );
+
+	memset( &network_server, 0, sizeof(network_server) );
+
+	mx_status = mx_allocate_network_buffer( &request, &network_server, NULL,
+				MXU_NETWORK_MINIMUM_MESSAGE_BUFFER_LENGTH );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		exit( 1 );
+
+	mx_status = mx_allocate_network_buffer( &response,
+				&network_server, NULL,
+				MXU_NETWORK_MINIMUM_MESSAGE_BUFFER_LENGTH );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		exit( 1 );
+
+	destination = (uint32_t *)
+		malloc( message_sizes[ num_message_sizes - 1 ] );
+
+	if ( destination == (uint32_t *) NULL ) {
+		fprintf( stderr, "Out of memory.\n" );
+		exit( 1 );
+	}
+
+	/* First, time the socket alone. */
+
+	for ( i = 0; i < num_message_sizes; i++ ) {
+		socket_time[i] = time_transfers( &client_socket,
+				request, response, destination,
+				message_sizes[i], num_passes );
+	}
+
+	/* Then ask for a shared memory segment and do it again. */
+
+	mx_status = mx_network_shm_expect_descriptor( &client_socket );
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		mx_status = send_request( &client_socket, request,
+						REQUEST_SHM, 0 );
+	}
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		mx_status = mx_network_socket_receive_message( &client_socket,
+							-1.0, response );
+	}
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		mx_status = mx_network_shm_attach( &client_socket );
+	}
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		fprintf( stderr,
+		"Shared memory is not available on this platform.\n" );
+		exit( 1 );
+	}
+
+	printf( "%10s %14s %14s %8s\n",
+		"bytes", "socket (us)", "shm (us)", "ratio" );
+
+	for ( i = 0; i < num_message_sizes; i++ ) {
+		shm_time = time_transfers( &client_socket,
+				request, response, destination,
+				message_sizes[i], num_passes );
+
+		printf( "%10lu %14.1f %14.1f %8.2f\n",
+			message_sizes[i], socket_time[i], shm_time,
+			socket_time[i] / shm_time );
+	}
+
+	(void) send_request( &client_socket, request, REQUEST_QUIT, 0 );
+
+	(void) waitpid( child_pid, &child_status, 0 );
+
+	(void) mx_network_shm_detach( &client_socket );
+
+	close( fds[0] );
+
+	free( destination );
+
+	mx_free_network_buffer( request );
+	mx_free_network_buffer( response );
+
+	return 0;
+}
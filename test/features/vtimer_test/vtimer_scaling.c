@@ -0,0 +1,265 @@
+/*
+ * Name:    vtimer_scaling.c
+ *
+ * Purpose: Benchmark for large numbers of MX virtual timers.
+ *
+ *          This program creates a large number of one-shot virtual timers
+ *          with expiration times spread over one second, and times how
+ *          long it takes to start, stop and restart all of them.  It then
+ *          lets them all expire and reports how late the callbacks ran.
+ *          The test is run with a signal driven master timer and, where
+ *          it is supported, with a file descriptor master timer.
+ *
+ *          Usage: vtimer_scaling [ num_timers ]
+ *
+ *          The default is 10000 timers.
+ *
+ *--------------------------------------------------------------------------
+ *
+ * Copyright 2026 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mx_osdef.h"
+#include "mx_util.h"
+#include "mx_hrt.h"
+#include "mx_virtual_timer.h"
+
+#if defined(OS_LINUX)
+#  include <poll.h>
+#endif
+
+#define MASTER_TIMER_PERIOD	0.01	/* in seconds */
+
+#define SPREAD			1.0	/* in seconds */
+
+typedef struct {
+	MX_VIRTUAL_TIMER *vtimer;
+	double due_time;
+	double fire_time;
+} TIMER_INFO;
+
+static volatile long num_fired;
+
+static void
+scaling_callback( MX_VIRTUAL_TIMER *vtimer, void *args )
+{
+	TIMER_INFO *info;
+
+	info = (TIMER_INFO *) args;
+
+	info->fire_time = mx_high_resolution_time_as_double();
+
+	num_fired++;
+}
+
+static double
+timer_delay( long i, long num_timers )
+{
+	return 0.1 + ( SPREAD * (double) i ) / (double) num_timers;
+}
+
+static void
+wait_for_timers( MX_INTERVAL_TIMER *master_timer, int master_fd,
+			long num_timers, double deadline )
+{
+#if defined(OS_LINUX)
+	struct pollfd pfd;
+#endif
+
+	while ( num_fired < num_timers ) {
+		if ( mx_high_resolution_time_as_double() > deadline )
+			return;
+
+#if defined(OS_LINUX)
+		if ( master_fd >= 0 ) {
+			pfd.fd = master_fd;
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+
+			if ( poll( &pfd, 1, 100 ) > 0 ) {
+				(void) mx_virtual_timer_handle_master_fd(
+							master_timer );
+			}
+			continue;
+		}
+#endif
+		mx_msleep(10);
+	}
+}
+
+static void
+run_benchmark( const char *label, MX_INTERVAL_TIMER *master_timer,
+		int master_fd, TIMER_INFO *info, long num_timers )
+{
+	long i;
+	double start, started, stopped, restarted, finished;
+	double latency, max_latency, total_latency;
+	mx_bool_type busy;
+	mx_status_type mx_status;
+
+	for ( i = 0; i < num_timers; i++ ) {
+		mx_status = mx_virtual_timer_create( &(info[i].vtimer),
+				master_timer, MXIT_ONE_SHOT_TIMER,
+				scaling_callback, &(info[i]) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+	}
+
+	/* Start the timers in an order that does not match the order
+	 * in which they expire.
+	 */
+
+	start = mx_high_resolution_time_as_double();
+
+	for ( i = 0; i < num_timers; i++ ) {
+		mx_status = mx_virtual_timer_start( info[i].vtimer,
+				timer_delay( ( i * 7919 ) % num_timers,
+						num_timers ) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+	}
+
+	started = mx_high_resolution_time_as_double();
+
+	for ( i = 0; i < num_timers; i++ ) {
+		mx_status = mx_virtual_timer_stop( info[i].vtimer, NULL );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+	}
+
+	stopped = mx_high_resolution_time_as_double();
+
+	for ( i = 0; i < num_timers; i++ ) {
+		mx_status = mx_virtual_timer_is_busy( info[i].vtimer, &busy );
+
+		if ( ( mx_status.code != MXE_SUCCESS ) || busy ) {
+			fprintf( stderr,
+			"Timer %ld is still busy after being stopped.\n", i );
+			exit(1);
+		}
+	}
+
+	num_fired = 0;
+
+	restarted = mx_high_resolution_time_as_double();
+
+	for ( i = 0; i < num_timers; i++ ) {
+		info[i].fire_time = 0.0;
+
+		info[i].due_time = mx_high_resolution_time_as_double()
+					+ timer_delay( i, num_timers );
+
+		mx_status = mx_virtual_timer_start( info[i].vtimer,
+					timer_delay( i, num_timers ) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+	}
+
+	finished = mx_high_resolution_time_as_double();
+
+	wait_for_timers( master_timer, master_fd, num_timers,
+				finished + SPREAD + 5.0 );
+
+	if ( num_fired != num_timers ) {
+		fprintf( stderr, "Only %ld of %ld timers fired.\n",
+			num_fired, num_timers );
+		exit(1);
+	}
+
+	max_latency = total_latency = 0.0;
+
+	for ( i = 0; i < num_timers; i++ ) {
+		latency = info[i].fire_time - info[i].due_time;
+
+		if ( latency < -0.001 ) {
+			fprintf( stderr,
+			"Timer %ld fired %g seconds early.\n", i, -latency );
+			exit(1);
+		}
+
+		total_latency += latency;
+
+		if ( latency > max_latency )
+			max_latency = latency;
+	}
+
+	printf( "%s: %ld timers\n", label, num_timers );
+	printf( "  start %.6f  stop %.6f  restart %.6f sec\n",
+		started - start, stopped - started, finished - restarted );
+	printf( "  latency: mean %.6f  max %.6f sec\n",
+		total_latency / (double) num_timers, max_latency );
+
+	for ( i = 0; i < num_timers; i++ ) {
+		(void) mx_virtual_timer_destroy( info[i].vtimer );
+	}
+}
+
+int
+main( int argc, char *argv[] )
+{
+	MX_INTERVAL_TIMER *master_timer;
+	TIMER_INFO *info;
+	long num_timers;
+	int master_fd;
+	mx_status_type mx_status;
+
+	num_timers = 10000L;
+
+	if ( argc > 1 ) {
+		num_timers = atol( argv[1] );
+	}
+
+	if ( num_timers <= 0 ) {
+		fprintf( stderr, "The number of timers must be positive.\n" );
+		exit(1);
+	}
+
+	info = (TIMER_INFO *) calloc( num_timers, sizeof(TIMER_INFO) );
+
+	if ( info == (TIMER_INFO *) NULL ) {
+		fprintf( stderr, "Out of memory.\n" );
+		exit(1);
+	}
+
+	mx_status = mx_virtual_timer_create_master( &master_timer,
+						MASTER_TIMER_PERIOD );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		exit( mx_status.code );
+
+	run_benchmark( "signal master timer", master_timer, -1,
+					info, num_timers );
+
+	(void) mx_virtual_timer_destroy_master( master_timer );
+
+	mx_status = mx_virtual_timer_create_fd_master( &master_timer );
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		mx_status = mx_virtual_timer_get_master_fd( master_timer,
+							&master_fd );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+
+		run_benchmark( "fd master timer", master_timer, master_fd,
+					info, num_timers );
+
+		(void) mx_virtual_timer_destroy_master( master_timer );
+	}
+
+	free( info );
+
+	exit(0);
+}
+
@@ -0,0 +1,271 @@
+/*
+ * xdr_bench - Compares the bulk XDR array conversion in mx_xdr_data_transfer()
+ *             with the element by element xdr_array() conversion.
+ *
+ * For each datatype, an array is encoded and decoded using both paths.
+ * The program checks that both paths produce the same bytes and values
+ * and then reports the time per pass for each of them.
+ *
+ * Usage: xdr_bench [ num_elements [ num_passes ] ]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mx_osdef.h"
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_stdint.h"
+#include "mx_hrt.h"
+#include "mx_array.h"
+
+typedef struct {
+	const char *name;
+	long datatype;
+	size_t element_size;
+} XDR_BENCH_TYPE;
+
+static XDR_BENCH_TYPE bench_types[] = {
+	{ "char",   MXFT_CHAR,   sizeof(char) },
+	{ "ushort", MXFT_USHORT, sizeof(unsigned short) },
+	{ "int32",  MXFT_INT32,  sizeof(int32_t) },
+	{ "long",   MXFT_LONG,   sizeof(long) },
+	{ "ulong",  MXFT_ULONG,  sizeof(unsigned long) },
+	{ "int64",  MXFT_INT64,  sizeof(int64_t) },
+	{ "float",  MXFT_FLOAT,  sizeof(float) },
+	{ "double", MXFT_DOUBLE, sizeof(double) },
+};
+
+static long num_bench_types = sizeof(bench_types) / sizeof(bench_types[0]);
+
+static void
+fill_array( void *array, long datatype, long num_elements )
+{
+	long i;
+
+	for ( i = 0; i < num_elements; i++ ) {
+		switch( datatype ) {
+		case MXFT_CHAR:
+			((char *) array)[i] = (char) ( i - 64 );
+			break;
+		case MXFT_USHORT:
+			((unsigned short *) array)[i] =
+					(unsigned short) ( i * 7 );
+			break;
+		case MXFT_INT32:
+			((int32_t *) array)[i] = (int32_t) ( i * 1021 - 5000 );
+			break;
+		case MXFT_LONG:
+			((long *) array)[i] = i * 1021 - 5000;
+			break;
+		case MXFT_ULONG:
+			((unsigned long *) array)[i] = i * 40009UL;
+			break;
+		case MXFT_INT64:
+			((int64_t *) array)[i] = (int64_t) i * 1000000007 - 3;
+			break;
+		case MXFT_FLOAT:
+			((float *) array)[i] = (float) i * 0.25f - 17.0f;
+			break;
+		case MXFT_DOUBLE:
+			((double *) array)[i] = (double) i * 1.0e-3 + 0.1;
+			break;
+		}
+	}
+}
+
+static mx_status_type
+transfer( int direction, mx_bool_type use_bulk_transfer,
+		XDR_BENCH_TYPE *type, void *array, long num_elements,
+		void *xdr_buffer, size_t xdr_buffer_length )
+{
+	long dimension[1];
+	size_t element_size[1];
+
+	dimension[0] = num_elements;
+	element_size[0] = type->element_size;
+
+	mx_xdr_set_bulk_transfer( use_bulk_transfer );
+
+	return mx_xdr_data_transfer( direction, array, FALSE,
+				type->datatype, 1, dimension, element_size,
+				xdr_buffer, xdr_buffer_length, NULL );
+}
+
+static double
+time_transfer( int direction, mx_bool_type use_bulk_transfer,
+		XDR_BENCH_TYPE *type, void *array, long num_elements,
+		void *xdr_buffer, size_t xdr_buffer_length, long num_passes )
+{
+	double start_time;
+	long n;
+
+	start_time = mx_high_resolution_time_as_double();
+
+	for ( n = 0; n < num_passes; n++ ) {
+		(void) transfer( direction, use_bulk_transfer, type,
+				array, num_elements,
+				xdr_buffer, xdr_buffer_length );
+	}
+
+	return ( mx_high_resolution_time_as_double() - start_time )
+						/ (double) num_passes;
+}
+
+int
+main( int argc, char *argv[] )
+{
+	XDR_BENCH_TYPE *type;
+	long i, num_elements, num_passes, failures;
+	size_t native_length, xdr_buffer_length;
+	void *array, *decoded_array;
+	void *old_buffer, *new_buffer;
+	double old_encode, new_encode, old_decode, new_decode;
+	mx_status_type old_status, new_status;
+
+	num_elements = 100000;
+	num_passes = 100;
+
+	if ( argc > 1 ) {
+		num_elements = atol( argv[1] );
+	}
+	if ( argc > 2 ) {
+		num_passes = atol( argv[2] );
+	}
+
+	mx_set_debug_level(0);
+
+	/* Every XDR element is 4 or 8 bytes long. */
+
+	native_length = num_elements * sizeof(int64_t);
+
+	xdr_buffer_length = 4 + num_elements * 8;
+
+	array         = malloc( native_length );
+	decoded_array = malloc( native_length );
+	old_buffer    = malloc( xdr_buffer_length );
+	new_buffer    = malloc( xdr_buffer_length );
+
+	if ( ( array == NULL ) || ( decoded_array == NULL )
+	  || ( old_buffer == NULL ) || ( new_buffer == NULL ) )
+	{
+		fprintf( stderr, "Cannot allocate %ld element arrays.\n",
+			num_elements );
+		exit(1);
+	}
+
+	printf( "%ld elements, %ld passes, times in microseconds per pass\n\n",
+		num_elements, num_passes );
+
+	printf( "%-8s %12s %12s %12s %12s\n", "type",
+		"xdr_encode", "bulk_encode", "xdr_decode", "bulk_decode" );
+
+	failures = 0;
+
+	for ( i = 0; i < num_bench_types; i++ ) {
+		type = &bench_types[i];
+
+		fill_array( array, type->datatype, num_elements );
+
+		/* Both paths must produce the same bytes. */
+
+		memset( old_buffer, 0xA5, xdr_buffer_length );
+		memset( new_buffer, 0x5A, xdr_buffer_length );
+
+		old_status = transfer( MX_XDR_ENCODE, FALSE, type,
+			array, num_elements, old_buffer, xdr_buffer_length );
+
+		new_status = transfer( MX_XDR_ENCODE, TRUE, type,
+			array, num_elements, new_buffer, xdr_buffer_length );
+
+		if ( ( old_status.code != MXE_SUCCESS )
+		  || ( new_status.code != MXE_SUCCESS )
+		  || ( memcmp( old_buffer, new_buffer,
+			4 + num_elements * mx_xdr_get_scalar_element_size(
+						type->datatype ) ) != 0 ) )
+		{
+			printf( "%-8s: encoded bytes differ.\n", type->name );
+			failures++;
+			continue;
+		}
+
+		/* Decoding must give back the original values. */
+
+		memset( decoded_array, 0, native_length );
+
+		new_status = transfer( MX_XDR_DECODE, TRUE, type,
+			decoded_array, num_elements,
+			new_buffer, xdr_buffer_length );
+
+		if ( ( new_status.code != MXE_SUCCESS )
+		  || ( memcmp( array, decoded_array,
+			num_elements * type->element_size ) != 0 ) )
+		{
+			printf( "%-8s: decoded values differ.\n", type->name );
+			failures++;
+			continue;
+		}
+
+		old_encode = time_transfer( MX_XDR_ENCODE, FALSE, type,
+				array, num_elements,
+				old_buffer, xdr_buffer_length, num_passes );
+
+		new_encode = time_transfer( MX_XDR_ENCODE, TRUE, type,
+				array, num_elements,
+				new_buffer, xdr_buffer_length, num_passes );
+
+		old_decode = time_transfer( MX_XDR_DECODE, FALSE, type,
+				decoded_array, num_elements,
+				old_buffer, xdr_buffer_length, num_passes );
+
+		new_decode = time_transfer( MX_XDR_DECODE, TRUE, type,
+				decoded_array, num_elements,
+				new_buffer, xdr_buffer_length, num_passes );
+
+		printf( "%-8s %12.1f %12.1f %12.1f %12.1f\n", type->name,
+			1.0e6 * old_encode, 1.0e6 * new_encode,
+			1.0e6 * old_decode, 1.0e6 * new_decode );
+	}
+
+	/* A 64-bit long that does not fit into 32 bits is handed back to
+	 * xdr_array(), so both paths must give the same result for it.
+	 */
+
+	if ( sizeof(long) > sizeof(int32_t) ) {
+		type = &bench_types[3];
+
+		fill_array( array, type->datatype, num_elements );
+
+		((long *) array)[ num_elements / 2 ] = 0x7fffffffL + 1;
+
+		memset( old_buffer, 0xA5, xdr_buffer_length );
+		memset( new_buffer, 0x5A, xdr_buffer_length );
+
+		old_status = transfer( MX_XDR_ENCODE, FALSE, type,
+			array, num_elements, old_buffer, xdr_buffer_length );
+
+		new_status = transfer( MX_XDR_ENCODE, TRUE, type,
+			array, num_elements, new_buffer, xdr_buffer_length );
+
+		if ( ( new_status.code != old_status.code )
+		  || ( ( old_status.code == MXE_SUCCESS )
+		    && ( memcmp( old_buffer, new_buffer,
+					4 + num_elements * 4 ) != 0 ) ) )
+		{
+			printf( "%-8s: out of range values differ.\n",
+				type->name );
+			failures++;
+		}
+	}
+
+	mx_xdr_set_bulk_transfer( TRUE );
+
+	if ( failures > 0 ) {
+		printf( "\n%ld datatypes FAILED.\n", failures );
+		exit(1);
+	}
+
+	exit(0);
+}
+
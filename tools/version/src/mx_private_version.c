@@ -90,6 +90,11 @@ main( int argc, char **argv )
 
 	mxp_generate_macros( stdout );
 
+#if defined( MX_HAVE_ZLIB )
+	fprintf( stdout, "\n" );
+	fprintf( stdout, "#define MX_HAVE_ZLIB   1\n" );
+#endif
+
 	fprintf( stdout, "\n" );
 	fprintf( stdout, "#endif /* __MX_PRIVATE_VERSION_H__ */\n");
 	fprintf( stdout, "\n" );